@@ -7,6 +7,7 @@
 #include "Base/Debug/Console.h"
 #include "Base/Debug/Debugger.h"
 #include "Base/Debug/Log.h"
+#include "Base/Memory/EpochReclamation.h"
 #include "Base/Memory/WeakPtr.h"
 #include "Base/Process/CommandLine.h"
 #include "Base/System/CpuInfo.h"
@@ -31,10 +32,13 @@ void BaseApplicationPart::init() {
   InitLogging();
   TimeTicks::ClassInit();
   Thread::ClassInit();
+  EpochReclamation::classInit();
 }
 
 void BaseApplicationPart::fini() {
   Thread::ClassFini();
+  // After threads data is disposed, so the main thread is unregistered.
+  EpochReclamation::classFini();
   Console::classFini();
 }
 
@@ -14,6 +14,8 @@
 #define _STP_CPU_SIMD_LEVEL_SSE42    42
 #define _STP_CPU_SIMD_LEVEL_AVX      51
 #define _STP_CPU_SIMD_LEVEL_AVX2     52
+// AVX-512 subset of Skylake-X: F, CD, BW, DQ and VL.
+#define _STP_CPU_SIMD_LEVEL_AVX512   60
 
 #define _STP_CPU_SIMD_LEVEL_NEON     (1 << 8)
 
@@ -24,7 +26,10 @@
 // Are we in GCC?
 // These checks must be done in descending order to ensure we set the highest
 // available SSE level.
-#if defined(__AVX2__)
+#if defined(__AVX512F__) && defined(__AVX512CD__) && defined(__AVX512BW__) && \
+    defined(__AVX512DQ__) && defined(__AVX512VL__)
+# define _STP_CPU_SIMD_LEVEL _STP_CPU_SIMD_LEVEL_AVX512
+#elif defined(__AVX2__)
 # define _STP_CPU_SIMD_LEVEL _STP_CPU_SIMD_LEVEL_AVX2
 #elif defined(__AVX__)
 # define _STP_CPU_SIMD_LEVEL _STP_CPU_SIMD_LEVEL_AVX
@@ -0,0 +1,1048 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Compress/Deflate.h"
+
+#include "Base/Containers/Sorting.h"
+#include "Base/Error/BasicExceptions.h"
+#include "Base/Io/IoException.h"
+#include "Base/Io/Stream.h"
+#include "Base/Math/Bits.h"
+#include "Base/Memory/Allocate.h"
+
+#include <string.h>
+
+namespace stp {
+
+namespace {
+
+constexpr int MinMatch = 3;
+constexpr int MaxMatch = 258;
+// Matches of minimal length are not worth it if too far.
+constexpr int MaxMinMatchDistance = 4096;
+
+constexpr int EndOfBlock = 256;
+// Including two symbols of fixed literal/length code never used.
+constexpr int MaxSymbolCount = 288;
+constexpr int MaxCodeBits = 15;
+constexpr int CodeLengthCodeCount = 19;
+constexpr int MaxCodeLengthCodeBits = 7;
+constexpr int MaxStoredBlockSize = 65535;
+
+constexpr int HashBits = 15;
+constexpr int WindowMask = DeflateEncoder::WindowSize - 1;
+constexpr int BlockTokenCount = 16384;
+
+const uint16_t LengthBase[29] = {
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258,
+};
+const uint8_t LengthExtraBits[29] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+  3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0,
+};
+const uint16_t DistanceBase[30] = {
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+  257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577,
+};
+const uint8_t DistanceExtraBits[30] = {
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+  7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13,
+};
+// The order in which code length code lengths are stored.
+const uint8_t CodeLengthOrder[CodeLengthCodeCount] = {
+  16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15,
+};
+
+struct LevelConfig {
+  // Reduce the search when a match of this length is already found.
+  uint16_t good_length;
+  // Lazy levels: do not look for a better match if current is this long.
+  // Greedy levels: do not insert strings of matches longer than this.
+  uint16_t max_lazy;
+  // Stop the search when a match of this length is found.
+  uint16_t nice_length;
+  uint16_t max_chain;
+};
+
+// Same trade-offs as in zlib.
+const LevelConfig LevelConfigs[DeflateEncoder::MaxLevel + 1] = {
+  { 0, 0, 0, 0 },
+  { 4, 4, 8, 4 },
+  { 4, 5, 16, 8 },
+  { 4, 6, 32, 32 },
+  { 4, 4, 16, 16 },
+  { 8, 16, 32, 32 },
+  { 8, 16, 128, 128 },
+  { 8, 32, 128, 256 },
+  { 32, 128, 258, 1024 },
+  { 32, 258, 258, 4096 },
+};
+constexpr int FirstLazyLevel = 4;
+
+inline int getLengthCode(int length) {
+  ASSERT(MinMatch <= length && length <= MaxMatch);
+  if (length == MaxMatch)
+    return 28;
+  int x = length - MinMatch;
+  if (x < 8)
+    return x;
+  int bit = findLastOneBit(static_cast<uint32_t>(x));
+  return 4 * (bit - 1) + ((x >> (bit - 2)) & 3);
+}
+
+inline int getDistanceCode(int distance) {
+  ASSERT(1 <= distance && distance <= DeflateEncoder::WindowSize);
+  int x = distance - 1;
+  if (x < 4)
+    return x;
+  int bit = findLastOneBit(static_cast<uint32_t>(x));
+  return 2 * bit + ((x >> (bit - 1)) & 1);
+}
+
+inline uint32_t reverseCode(uint32_t code, int length) {
+  return reverseBits(code) >> (32 - length);
+}
+
+inline uint32_t hashString(const byte_t* p) {
+  uint32_t x = p[0] | (p[1] << 8) | (p[2] << 16);
+  return (x * 2654435761u) >> (32 - HashBits);
+}
+
+inline int countMatch(const byte_t* a, const byte_t* b, int max_length) {
+  int length = 0;
+  while (length + 8 <= max_length) {
+    uint64_t x, y;
+    ::memcpy(&x, a + length, 8);
+    ::memcpy(&y, b + length, 8);
+    if (x != y)
+      return length + countTrailingZeroBits(x ^ y) / 8;
+    length += 8;
+  }
+  while (length < max_length && a[length] == b[length])
+    ++length;
+  return length;
+}
+
+// Computes optimal code lengths from frequencies sorted in ascending order.
+// Uses in-place algorithm by Moffat and Katajainen.
+// On return A[i] holds the length of code for i-th symbol.
+void computeMinimumRedundancy(int* A, int n) {
+  ASSERT(n >= 2);
+  A[0] += A[1];
+  int root = 0;
+  int leaf = 2;
+  for (int next = 1; next < n - 1; ++next) {
+    if (leaf >= n || A[root] < A[leaf]) {
+      A[next] = A[root];
+      A[root++] = next;
+    } else {
+      A[next] = A[leaf++];
+    }
+    if (leaf >= n || (root < next && A[root] < A[leaf])) {
+      A[next] += A[root];
+      A[root++] = next;
+    } else {
+      A[next] += A[leaf++];
+    }
+  }
+
+  A[n - 2] = 0;
+  for (int next = n - 3; next >= 0; --next)
+    A[next] = A[A[next]] + 1;
+
+  int available = 1;
+  int used = 0;
+  int depth = 0;
+  root = n - 2;
+  int next = n - 1;
+  while (available > 0) {
+    while (root >= 0 && A[root] == depth) {
+      ++used;
+      --root;
+    }
+    while (available > used) {
+      A[next--] = depth;
+      --available;
+    }
+    available = 2 * used;
+    ++depth;
+    used = 0;
+  }
+}
+
+// Builds length-limited Huffman code lengths for given frequencies.
+void buildCodeLengths(const uint32_t* freqs, int count, int max_bits, uint8_t* lengths) {
+  constexpr int SymbolBits = 9;
+  uint32_t sorted[MaxSymbolCount];
+  int n = 0;
+  for (int symbol = 0; symbol < count; ++symbol) {
+    lengths[symbol] = 0;
+    if (freqs[symbol]) {
+      ASSERT(freqs[symbol] < (1u << (32 - SymbolBits)));
+      sorted[n++] = (freqs[symbol] << SymbolBits) | static_cast<uint32_t>(symbol);
+    }
+  }
+  // Some decoders reject codes with single symbol.
+  if (n < 2) {
+    int symbol = n == 1 ? static_cast<int>(sorted[0] & ((1 << SymbolBits) - 1)) : 0;
+    lengths[symbol] = 1;
+    lengths[symbol == 0 ? 1 : 0] = 1;
+    return;
+  }
+  sortSpan(MutableSpan<uint32_t>(sorted, n));
+
+  int A[MaxSymbolCount];
+  for (int i = 0; i < n; ++i)
+    A[i] = static_cast<int>(sorted[i] >> SymbolBits);
+  computeMinimumRedundancy(A, n);
+
+  // Limit code lengths to |max_bits|, then fix the Kraft inequality by
+  // making some of shorter codes longer.
+  int length_counts[MaxCodeBits + 1] = { 0 };
+  for (int i = 0; i < n; ++i)
+    ++length_counts[min(A[i], max_bits)];
+
+  uint32_t total = 0;
+  for (int i = max_bits; i > 0; --i)
+    total += static_cast<uint32_t>(length_counts[i]) << (max_bits - i);
+  while (total != (1u << max_bits)) {
+    --length_counts[max_bits];
+    for (int i = max_bits - 1; i > 0; --i) {
+      if (length_counts[i]) {
+        --length_counts[i];
+        length_counts[i + 1] += 2;
+        break;
+      }
+    }
+    --total;
+  }
+
+  // The least frequent symbols get the longest codes.
+  int i = 0;
+  for (int length = max_bits; length > 0; --length) {
+    for (int k = length_counts[length]; k > 0; --k)
+      lengths[sorted[i++] & ((1 << SymbolBits) - 1)] = static_cast<uint8_t>(length);
+  }
+}
+
+// Computes canonical codes, bit reversed since DEFLATE writes them
+// starting with most significant bit.
+void buildCodes(const uint8_t* lengths, int count, uint16_t* codes) {
+  int length_counts[MaxCodeBits + 1] = { 0 };
+  for (int symbol = 0; symbol < count; ++symbol)
+    ++length_counts[lengths[symbol]];
+  length_counts[0] = 0;
+
+  uint32_t next_codes[MaxCodeBits + 1];
+  uint32_t code = 0;
+  for (int length = 1; length <= MaxCodeBits; ++length) {
+    code = (code + length_counts[length - 1]) << 1;
+    next_codes[length] = code;
+  }
+  for (int symbol = 0; symbol < count; ++symbol) {
+    int length = lengths[symbol];
+    codes[symbol] = length ? static_cast<uint16_t>(reverseCode(next_codes[length]++, length)) : 0;
+  }
+}
+
+void buildFixedLengths(uint8_t* literal_length_lengths, uint8_t* distance_lengths) {
+  int symbol = 0;
+  for (; symbol < 144; ++symbol)
+    literal_length_lengths[symbol] = 8;
+  for (; symbol < 256; ++symbol)
+    literal_length_lengths[symbol] = 9;
+  for (; symbol < 280; ++symbol)
+    literal_length_lengths[symbol] = 7;
+  for (; symbol < 288; ++symbol)
+    literal_length_lengths[symbol] = 8;
+  for (symbol = 0; symbol < 32; ++symbol)
+    distance_lengths[symbol] = 5;
+}
+
+} // namespace
+
+DeflateEncoder::DeflateEncoder(int level)
+    : level_(level) {
+  ASSERT(MinLevel <= level && level <= MaxLevel);
+}
+
+DeflateEncoder::~DeflateEncoder() {}
+
+void DeflateEncoder::insertString(int pos) {
+  uint32_t hash = hashString(window_.data() + pos);
+  int previous = head_[hash];
+  int distance = pos - previous;
+  chain_[pos & WindowMask] = static_cast<uint16_t>(previous < 0 || distance > WindowSize ? 0 : distance);
+  head_[hash] = pos;
+}
+
+int DeflateEncoder::findLongestMatch(int pos, int prev_length, int& out_distance) {
+  const LevelConfig& config = LevelConfigs[level_];
+  const byte_t* data = window_.data();
+  const byte_t* current = data + pos;
+
+  int max_length = min(MaxMatch, window_.size() - pos);
+  if (prev_length >= max_length)
+    return 0;
+  int nice_length = min(static_cast<int>(config.nice_length), max_length);
+  int chain_length = config.max_chain;
+  if (prev_length >= config.good_length)
+    chain_length >>= 2;
+
+  int best_length = prev_length;
+  int candidate = head_[hashString(current)];
+  while (candidate >= 0 && pos - candidate <= WindowSize && chain_length-- > 0) {
+    const byte_t* match = data + candidate;
+    if (match[best_length] == current[best_length] && match[0] == current[0] && match[1] == current[1]) {
+      int length = countMatch(current, match, max_length);
+      if (length > best_length) {
+        best_length = length;
+        out_distance = pos - candidate;
+        if (length >= nice_length)
+          break;
+      }
+    }
+    int delta = chain_[candidate & WindowMask];
+    if (!delta)
+      break;
+    candidate -= delta;
+  }
+  if (best_length <= prev_length)
+    return 0;
+  if (best_length == MinMatch && out_distance > MaxMinMatchDistance)
+    return 0;
+  return best_length;
+}
+
+void DeflateEncoder::addLiteral(int pos) {
+  byte_t literal = window_[pos];
+  tokens_.add(Token { literal, 0 });
+  ++literal_length_freqs_[literal];
+  block_end_ = pos + 1;
+}
+
+void DeflateEncoder::addMatch(int pos, int length, int distance) {
+  tokens_.add(Token { static_cast<uint16_t>(length), static_cast<uint16_t>(distance) });
+  ++literal_length_freqs_[257 + getLengthCode(length)];
+  ++distance_freqs_[getDistanceCode(distance)];
+  block_end_ = pos + length;
+}
+
+bool DeflateEncoder::isBlockFull() const {
+  return tokens_.size() >= BlockTokenCount;
+}
+
+void DeflateEncoder::compressGreedy(int begin, int end) {
+  int max_insert = LevelConfigs[level_].max_lazy;
+  int pos = begin;
+  while (pos < end) {
+    int length = 0;
+    int distance = 0;
+    if (end - pos >= MinMatch) {
+      length = findLongestMatch(pos, MinMatch - 1, distance);
+      insertString(pos);
+    }
+    if (length) {
+      addMatch(pos, length, distance);
+      if (length <= max_insert) {
+        int insert_end = min(pos + length, end - MinMatch + 1);
+        for (int i = pos + 1; i < insert_end; ++i)
+          insertString(i);
+      }
+      pos += length;
+    } else {
+      addLiteral(pos);
+      ++pos;
+    }
+    if (isBlockFull())
+      flushBlock(false);
+  }
+}
+
+void DeflateEncoder::compressLazy(int begin, int end) {
+  int max_lazy = LevelConfigs[level_].max_lazy;
+  int prev_length = 0;
+  int prev_distance = 0;
+  // Whether the byte at |pos - 1| is yet to be emitted.
+  bool pending = false;
+
+  int pos = begin;
+  while (pos < end) {
+    int length = 0;
+    int distance = 0;
+    if (end - pos >= MinMatch) {
+      if (prev_length < max_lazy)
+        length = findLongestMatch(pos, max(prev_length, MinMatch - 1), distance);
+      insertString(pos);
+    }
+
+    if (prev_length >= MinMatch && length <= prev_length) {
+      // The match at previous position is better.
+      int match_pos = pos - 1;
+      addMatch(match_pos, prev_length, prev_distance);
+      int insert_end = min(match_pos + prev_length, end - MinMatch + 1);
+      for (int i = pos + 1; i < insert_end; ++i)
+        insertString(i);
+      pos = match_pos + prev_length;
+      prev_length = 0;
+      pending = false;
+    } else {
+      if (pending)
+        addLiteral(pos - 1);
+      pending = true;
+      prev_length = length;
+      prev_distance = distance;
+      ++pos;
+    }
+    if (isBlockFull())
+      flushBlock(false);
+  }
+  if (pending)
+    addLiteral(pos - 1);
+}
+
+void DeflateEncoder::compress(BufferSpan history, BufferSpan input, bool final, List<byte_t>& output) {
+  output_ = &output;
+  bit_buffer_ = 0;
+  bit_count_ = 0;
+
+  int history_size = min(history.size(), WindowSize);
+  window_.clear();
+  window_.append(Span<byte_t>(
+      static_cast<const byte_t*>(history.data()) + history.size() - history_size, history_size));
+  window_.append(Span<byte_t>(static_cast<const byte_t*>(input.data()), input.size()));
+
+  tokens_.clear();
+  ::memset(literal_length_freqs_, 0, sizeof(literal_length_freqs_));
+  ::memset(distance_freqs_, 0, sizeof(distance_freqs_));
+  block_begin_ = history_size;
+  block_end_ = history_size;
+
+  int end = window_.size();
+  if (level_ == 0) {
+    block_end_ = end;
+  } else {
+    if (head_.isEmpty()) {
+      head_.appendUninitialized(1 << HashBits);
+      chain_.appendUninitialized(WindowSize);
+      tokens_.willGrow(BlockTokenCount);
+    }
+    ::memset(head_.data(), 0xFF, toUnsigned(head_.size()) * sizeof(int32_t));
+    for (int pos = 0; pos + MinMatch <= history_size; ++pos)
+      insertString(pos);
+
+    if (level_ < FirstLazyLevel)
+      compressGreedy(history_size, end);
+    else
+      compressLazy(history_size, end);
+  }
+  flushBlock(final);
+
+  if (!final) {
+    // Empty stored block.
+    putBits(0, 3);
+    alignToByte();
+    putBits(0, 16);
+    putBits(0xFFFF, 16);
+  }
+  alignToByte();
+  output_ = nullptr;
+}
+
+void DeflateEncoder::flushBlock(bool final) {
+  // Block of non-final chunk with no data is not needed.
+  if (block_begin_ == block_end_ && !final)
+    return;
+
+  ++literal_length_freqs_[EndOfBlock];
+
+  uint8_t literal_length_lengths[LiteralLengthCodeCount];
+  uint8_t distance_lengths[DistanceCodeCount];
+  buildCodeLengths(literal_length_freqs_, LiteralLengthCodeCount, MaxCodeBits, literal_length_lengths);
+  buildCodeLengths(distance_freqs_, DistanceCodeCount, MaxCodeBits, distance_lengths);
+
+  int literal_length_count = LiteralLengthCodeCount;
+  while (literal_length_count > 257 && !literal_length_lengths[literal_length_count - 1])
+    --literal_length_count;
+  int distance_count = DistanceCodeCount;
+  while (distance_count > 1 && !distance_lengths[distance_count - 1])
+    --distance_count;
+
+  // Run-length encode code lengths of both codes.
+  uint8_t all_lengths[LiteralLengthCodeCount + DistanceCodeCount];
+  ::memcpy(all_lengths, literal_length_lengths, toUnsigned(literal_length_count));
+  ::memcpy(all_lengths + literal_length_count, distance_lengths, toUnsigned(distance_count));
+  int all_count = literal_length_count + distance_count;
+
+  struct CodeLengthToken {
+    uint8_t symbol;
+    uint8_t extra;
+  };
+  CodeLengthToken length_tokens[LiteralLengthCodeCount + DistanceCodeCount];
+  int length_token_count = 0;
+  uint32_t code_length_freqs[CodeLengthCodeCount] = { 0 };
+  auto add_length_token = [&](int symbol, int extra) {
+    length_tokens[length_token_count++] = CodeLengthToken {
+        static_cast<uint8_t>(symbol), static_cast<uint8_t>(extra) };
+    ++code_length_freqs[symbol];
+  };
+  for (int i = 0; i < all_count;) {
+    int length = all_lengths[i];
+    int run = 1;
+    while (i + run < all_count && all_lengths[i + run] == length)
+      ++run;
+    i += run;
+
+    if (length == 0) {
+      while (run >= 11) {
+        int count = min(run, 138);
+        add_length_token(18, count - 11);
+        run -= count;
+      }
+      if (run >= 3) {
+        add_length_token(17, run - 3);
+        run = 0;
+      }
+    } else {
+      add_length_token(length, 0);
+      --run;
+      while (run >= 3) {
+        int count = min(run, 6);
+        add_length_token(16, count - 3);
+        run -= count;
+      }
+    }
+    for (; run > 0; --run)
+      add_length_token(length, 0);
+  }
+
+  uint8_t code_length_lengths[CodeLengthCodeCount];
+  buildCodeLengths(code_length_freqs, CodeLengthCodeCount, MaxCodeLengthCodeBits, code_length_lengths);
+  int code_length_count = CodeLengthCodeCount;
+  while (code_length_count > 4 && !code_length_lengths[CodeLengthOrder[code_length_count - 1]])
+    --code_length_count;
+
+  // Compare sizes of all three block types.
+  uint8_t fixed_literal_length_lengths[288];
+  uint8_t fixed_distance_lengths[32];
+  buildFixedLengths(fixed_literal_length_lengths, fixed_distance_lengths);
+
+  uint64_t dynamic_bits = 5 + 5 + 4 + 3 * code_length_count;
+  for (int symbol = 0; symbol < CodeLengthCodeCount; ++symbol)
+    dynamic_bits += code_length_freqs[symbol] * code_length_lengths[symbol];
+  dynamic_bits += 2 * code_length_freqs[16] + 3 * code_length_freqs[17] + 7 * code_length_freqs[18];
+
+  uint64_t fixed_bits = 0;
+  uint64_t extra_bits = 0;
+  for (int symbol = 0; symbol < LiteralLengthCodeCount; ++symbol) {
+    uint32_t freq = literal_length_freqs_[symbol];
+    dynamic_bits += freq * literal_length_lengths[symbol];
+    fixed_bits += freq * fixed_literal_length_lengths[symbol];
+    if (symbol > EndOfBlock)
+      extra_bits += freq * LengthExtraBits[symbol - 257];
+  }
+  for (int symbol = 0; symbol < DistanceCodeCount; ++symbol) {
+    uint32_t freq = distance_freqs_[symbol];
+    dynamic_bits += freq * distance_lengths[symbol];
+    fixed_bits += freq * fixed_distance_lengths[symbol];
+    extra_bits += freq * DistanceExtraBits[symbol];
+  }
+  dynamic_bits += extra_bits;
+  fixed_bits += extra_bits;
+
+  int raw_size = block_end_ - block_begin_;
+  int stored_block_count = max((raw_size + MaxStoredBlockSize - 1) / MaxStoredBlockSize, 1);
+  uint64_t stored_bits = 8 * (static_cast<uint64_t>(raw_size) + 5 * stored_block_count);
+
+  if (level_ == 0 || stored_bits <= min(dynamic_bits, fixed_bits)) {
+    writeStoredBlocks(BufferSpan(window_.data() + block_begin_, raw_size), final);
+  } else if (fixed_bits <= dynamic_bits) {
+    putBits(final ? 1 : 0, 1);
+    putBits(1, 2);
+    uint16_t literal_length_codes[288];
+    uint16_t distance_codes[32];
+    buildCodes(fixed_literal_length_lengths, 288, literal_length_codes);
+    buildCodes(fixed_distance_lengths, 32, distance_codes);
+    writeTokens(literal_length_codes, fixed_literal_length_lengths, distance_codes, fixed_distance_lengths);
+  } else {
+    putBits(final ? 1 : 0, 1);
+    putBits(2, 2);
+    putBits(static_cast<uint32_t>(literal_length_count - 257), 5);
+    putBits(static_cast<uint32_t>(distance_count - 1), 5);
+    putBits(static_cast<uint32_t>(code_length_count - 4), 4);
+    for (int i = 0; i < code_length_count; ++i)
+      putBits(code_length_lengths[CodeLengthOrder[i]], 3);
+
+    uint16_t code_length_codes[CodeLengthCodeCount];
+    buildCodes(code_length_lengths, CodeLengthCodeCount, code_length_codes);
+    for (int i = 0; i < length_token_count; ++i) {
+      int symbol = length_tokens[i].symbol;
+      putBits(code_length_codes[symbol], code_length_lengths[symbol]);
+      if (symbol == 16)
+        putBits(length_tokens[i].extra, 2);
+      else if (symbol == 17)
+        putBits(length_tokens[i].extra, 3);
+      else if (symbol == 18)
+        putBits(length_tokens[i].extra, 7);
+    }
+
+    uint16_t literal_length_codes[LiteralLengthCodeCount];
+    uint16_t distance_codes[DistanceCodeCount];
+    buildCodes(literal_length_lengths, LiteralLengthCodeCount, literal_length_codes);
+    buildCodes(distance_lengths, DistanceCodeCount, distance_codes);
+    writeTokens(literal_length_codes, literal_length_lengths, distance_codes, distance_lengths);
+  }
+
+  tokens_.clear();
+  ::memset(literal_length_freqs_, 0, sizeof(literal_length_freqs_));
+  ::memset(distance_freqs_, 0, sizeof(distance_freqs_));
+  block_begin_ = block_end_;
+}
+
+void DeflateEncoder::writeTokens(
+    const uint16_t* literal_length_codes, const uint8_t* literal_length_code_lengths,
+    const uint16_t* distance_codes, const uint8_t* distance_code_lengths) {
+  for (const Token& token : tokens_) {
+    if (!token.distance) {
+      int literal = token.literal_or_length;
+      putBits(literal_length_codes[literal], literal_length_code_lengths[literal]);
+      continue;
+    }
+    int length = token.literal_or_length;
+    int length_code = getLengthCode(length);
+    int symbol = 257 + length_code;
+    putBits(literal_length_codes[symbol], literal_length_code_lengths[symbol]);
+    putBits(static_cast<uint32_t>(length - LengthBase[length_code]), LengthExtraBits[length_code]);
+
+    int distance = token.distance;
+    int distance_code = getDistanceCode(distance);
+    putBits(distance_codes[distance_code], distance_code_lengths[distance_code]);
+    putBits(static_cast<uint32_t>(distance - DistanceBase[distance_code]), DistanceExtraBits[distance_code]);
+  }
+  putBits(literal_length_codes[EndOfBlock], literal_length_code_lengths[EndOfBlock]);
+}
+
+void DeflateEncoder::writeStoredBlocks(BufferSpan data, bool final) {
+  auto* bytes = static_cast<const byte_t*>(data.data());
+  int remaining = data.size();
+  do {
+    int size = min(remaining, MaxStoredBlockSize);
+    remaining -= size;
+    putBits(final && remaining == 0 ? 1 : 0, 1);
+    putBits(0, 2);
+    alignToByte();
+    putBits(static_cast<uint32_t>(size), 16);
+    putBits(static_cast<uint32_t>(~size & 0xFFFF), 16);
+    alignToByte();
+    output_->append(Span<byte_t>(bytes, size));
+    bytes += size;
+  } while (remaining > 0);
+}
+
+void DeflateEncoder::putBits(uint32_t bits, int count) {
+  ASSERT(count <= 32 && (count == 32 || bits < (1u << count)));
+  bit_buffer_ |= static_cast<uint64_t>(bits) << bit_count_;
+  bit_count_ += count;
+  if (bit_count_ >= 32) {
+    uint32_t x = static_cast<uint32_t>(bit_buffer_);
+    ::memcpy(output_->appendUninitialized(4), &x, 4);
+    bit_buffer_ >>= 32;
+    bit_count_ -= 32;
+  }
+}
+
+void DeflateEncoder::alignToByte() {
+  while (bit_count_ > 0) {
+    output_->add(static_cast<byte_t>(bit_buffer_));
+    bit_buffer_ >>= 8;
+    bit_count_ -= 8;
+  }
+  bit_buffer_ = 0;
+  bit_count_ = 0;
+}
+
+namespace {
+
+constexpr int InputBufferSize = 64 * 1024;
+constexpr int DecodeWindowSize = DeflateEncoder::WindowSize;
+// Decoded data is accumulated after the window. Slack at the end allows
+// to copy matches in chunks of 8 bytes.
+constexpr int DecodeBufferSize = 4 * DecodeWindowSize;
+constexpr int DecodeBufferSlack = 8;
+
+constexpr int LiteralLengthTableBits = 10;
+constexpr int DistanceTableBits = 8;
+constexpr int CodeLengthTableBits = 7;
+
+// Table entry holds symbol (or offset of subtable) in upper 16 bits
+// and number of bits to consume (or index bits of subtable) in lower 8 bits.
+constexpr uint32_t SubtableFlag = 0x100;
+constexpr uint32_t InvalidFlag = 0x200;
+
+// Builds two-level decoding table. Codes no longer than |table_bits| are
+// decoded with single lookup. Returns false if lengths are over-subscribed.
+bool buildDecodeTable(const uint8_t* lengths, int count, int table_bits, List<uint32_t>& table) {
+  int length_counts[MaxCodeBits + 1] = { 0 };
+  for (int symbol = 0; symbol < count; ++symbol)
+    ++length_counts[lengths[symbol]];
+  length_counts[0] = 0;
+
+  int left = 1;
+  for (int length = 1; length <= MaxCodeBits; ++length) {
+    left <<= 1;
+    left -= length_counts[length];
+    if (left < 0)
+      return false;
+  }
+
+  uint32_t next_codes[MaxCodeBits + 1];
+  uint32_t code = 0;
+  for (int length = 1; length <= MaxCodeBits; ++length) {
+    code = (code + length_counts[length - 1]) << 1;
+    next_codes[length] = code;
+  }
+
+  int primary_size = 1 << table_bits;
+  uint32_t primary_mask = primary_size - 1;
+
+  uint16_t codes[MaxSymbolCount];
+  uint8_t subtable_bits[1 << LiteralLengthTableBits] = { 0 };
+  for (int symbol = 0; symbol < count; ++symbol) {
+    int length = lengths[symbol];
+    if (!length)
+      continue;
+    codes[symbol] = static_cast<uint16_t>(reverseCode(next_codes[length]++, length));
+    if (length > table_bits) {
+      uint8_t& bits = subtable_bits[codes[symbol] & primary_mask];
+      bits = max(bits, static_cast<uint8_t>(length - table_bits));
+    }
+  }
+
+  int size = primary_size;
+  for (int i = 0; i < primary_size; ++i) {
+    if (subtable_bits[i])
+      size += 1 << subtable_bits[i];
+  }
+  table.clear();
+  uint32_t* entries = table.appendUninitialized(size);
+  for (int i = 0; i < size; ++i)
+    entries[i] = InvalidFlag;
+
+  int offset = primary_size;
+  for (int i = 0; i < primary_size; ++i) {
+    if (subtable_bits[i]) {
+      entries[i] = (static_cast<uint32_t>(offset) << 16) | SubtableFlag | subtable_bits[i];
+      offset += 1 << subtable_bits[i];
+    }
+  }
+
+  for (int symbol = 0; symbol < count; ++symbol) {
+    int length = lengths[symbol];
+    if (!length)
+      continue;
+    uint32_t reversed = codes[symbol];
+    if (length <= table_bits) {
+      uint32_t entry = (static_cast<uint32_t>(symbol) << 16) | static_cast<uint32_t>(length);
+      for (int i = static_cast<int>(reversed); i < primary_size; i += 1 << length)
+        entries[i] = entry;
+    } else {
+      uint32_t link = entries[reversed & primary_mask];
+      uint32_t* subtable = entries + (link >> 16);
+      int subtable_size = 1 << (link & 0xFF);
+      int sublength = length - table_bits;
+      uint32_t entry = (static_cast<uint32_t>(symbol) << 16) | static_cast<uint32_t>(sublength);
+      for (int i = static_cast<int>(reversed >> table_bits); i < subtable_size; i += 1 << sublength)
+        subtable[i] = entry;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+DeflateDecoder::DeflateDecoder(Stream& input)
+    : input_(input) {
+  input_buffer_ = static_cast<byte_t*>(allocateMemory(InputBufferSize));
+  window_ = static_cast<byte_t*>(allocateMemory(DecodeBufferSize + DecodeBufferSlack));
+}
+
+DeflateDecoder::~DeflateDecoder() {
+  freeMemory(window_);
+  freeMemory(input_buffer_);
+}
+
+void DeflateDecoder::reset() {
+  ASSERT(isFinished());
+  state_ = State::BlockHeader;
+  final_block_ = false;
+  window_pos_ = 0;
+  output_pos_ = 0;
+}
+
+int DeflateDecoder::decompress(MutableBufferSpan output) {
+  if (output_pos_ == window_pos_) {
+    if (state_ == State::Finished)
+      return 0;
+    decodeSome();
+  }
+  int count = min(output.size(), window_pos_ - output_pos_);
+  ::memcpy(output.data(), window_ + output_pos_, toUnsigned(count));
+  output_pos_ += count;
+  return count;
+}
+
+void DeflateDecoder::decodeSome() {
+  ASSERT(output_pos_ == window_pos_);
+  if (window_pos_ > DecodeBufferSize - MaxMatch) {
+    ::memmove(window_, window_ + window_pos_ - DecodeWindowSize, DecodeWindowSize);
+    window_pos_ = DecodeWindowSize;
+    output_pos_ = DecodeWindowSize;
+  }
+
+  // Stored blocks may be empty, so loop until some data is produced.
+  while (window_pos_ == output_pos_ || window_pos_ <= DecodeBufferSize - MaxMatch) {
+    switch (state_) {
+      case State::BlockHeader:
+        readBlockHeader();
+        break;
+      case State::Stored:
+        copyStored();
+        break;
+      case State::Huffman:
+        decodeHuffman();
+        break;
+      case State::Finished:
+        return;
+    }
+  }
+}
+
+void DeflateDecoder::readBlockHeader() {
+  final_block_ = readBits(1) != 0;
+  uint32_t type = readBits(2);
+  switch (type) {
+    case 0: {
+      dropBits(bit_count_ & 7);
+      uint32_t length = readBits(16);
+      uint32_t inverted_length = readBits(16);
+      if (length != (~inverted_length & 0xFFFF))
+        throw FormatException("deflate");
+      stored_remaining_ = static_cast<int>(length);
+      state_ = State::Stored;
+      break;
+    }
+    case 1: {
+      uint8_t literal_length_lengths[288];
+      uint8_t distance_lengths[32];
+      buildFixedLengths(literal_length_lengths, distance_lengths);
+      buildDecodeTable(literal_length_lengths, 288, LiteralLengthTableBits, literal_length_table_);
+      buildDecodeTable(distance_lengths, 32, DistanceTableBits, distance_table_);
+      state_ = State::Huffman;
+      break;
+    }
+    case 2:
+      readDynamicTables();
+      state_ = State::Huffman;
+      break;
+    default:
+      throw FormatException("deflate");
+  }
+}
+
+void DeflateDecoder::readDynamicTables() {
+  int literal_length_count = static_cast<int>(readBits(5)) + 257;
+  int distance_count = static_cast<int>(readBits(5)) + 1;
+  int code_length_count = static_cast<int>(readBits(4)) + 4;
+  if (literal_length_count > 286 || distance_count > 30)
+    throw FormatException("deflate");
+
+  uint8_t code_length_lengths[CodeLengthCodeCount] = { 0 };
+  for (int i = 0; i < code_length_count; ++i)
+    code_length_lengths[CodeLengthOrder[i]] = static_cast<uint8_t>(readBits(3));
+  List<uint32_t>& code_length_table = distance_table_;
+  if (!buildDecodeTable(code_length_lengths, CodeLengthCodeCount, CodeLengthTableBits, code_length_table))
+    throw FormatException("deflate");
+
+  uint8_t lengths[286 + 30];
+  int total = literal_length_count + distance_count;
+  for (int i = 0; i < total;) {
+    uint32_t symbol = decodeSymbol(code_length_table.data(), CodeLengthTableBits);
+    if (symbol < 16) {
+      lengths[i++] = static_cast<uint8_t>(symbol);
+      continue;
+    }
+    int repeat;
+    uint8_t value = 0;
+    if (symbol == 16) {
+      if (i == 0)
+        throw FormatException("deflate");
+      value = lengths[i - 1];
+      repeat = 3 + static_cast<int>(readBits(2));
+    } else if (symbol == 17) {
+      repeat = 3 + static_cast<int>(readBits(3));
+    } else {
+      repeat = 11 + static_cast<int>(readBits(7));
+    }
+    if (repeat > total - i)
+      throw FormatException("deflate");
+    for (; repeat > 0; --repeat)
+      lengths[i++] = value;
+  }
+  if (!lengths[EndOfBlock])
+    throw FormatException("deflate");
+
+  if (!buildDecodeTable(lengths, literal_length_count, LiteralLengthTableBits, literal_length_table_) ||
+      !buildDecodeTable(lengths + literal_length_count, distance_count, DistanceTableBits, distance_table_))
+    throw FormatException("deflate");
+}
+
+void DeflateDecoder::copyStored() {
+  int count = min(stored_remaining_, DecodeBufferSize - window_pos_);
+  stored_remaining_ -= count;
+  readAligned(MutableBufferSpan(window_ + window_pos_, count));
+  window_pos_ += count;
+  if (stored_remaining_ == 0)
+    state_ = final_block_ ? State::Finished : State::BlockHeader;
+}
+
+void DeflateDecoder::decodeHuffman() {
+  const uint32_t* literal_length_table = literal_length_table_.data();
+  const uint32_t* distance_table = distance_table_.data();
+
+  byte_t* window = window_;
+  int pos = window_pos_;
+  while (pos <= DecodeBufferSize - MaxMatch) {
+    // Enough bits for the longest length/distance pair.
+    if (bit_count_ < 48)
+      fillBits();
+
+    uint32_t symbol = decodeSymbol(literal_length_table, LiteralLengthTableBits);
+    if (symbol < 256) {
+      window[pos++] = static_cast<byte_t>(symbol);
+      continue;
+    }
+    if (symbol == EndOfBlock) {
+      state_ = final_block_ ? State::Finished : State::BlockHeader;
+      if (final_block_)
+        dropBits(bit_count_ & 7);
+      break;
+    }
+    symbol -= 257;
+    if (symbol >= 29)
+      throw FormatException("deflate");
+    int length = LengthBase[symbol] + static_cast<int>(readBits(LengthExtraBits[symbol]));
+
+    uint32_t distance_symbol = decodeSymbol(distance_table, DistanceTableBits);
+    if (distance_symbol >= 30)
+      throw FormatException("deflate");
+    int distance = DistanceBase[distance_symbol] + static_cast<int>(readBits(DistanceExtraBits[distance_symbol]));
+    if (distance > pos)
+      throw FormatException("deflate");
+
+    const byte_t* match = window + pos - distance;
+    byte_t* out = window + pos;
+    if (distance >= 8) {
+      // May write up to 7 bytes past the match, into the slack if needed.
+      for (int i = 0; i < length; i += 8)
+        ::memcpy(out + i, match + i, 8);
+    } else {
+      for (int i = 0; i < length; ++i)
+        out[i] = match[i];
+    }
+    pos += length;
+  }
+  window_pos_ = pos;
+}
+
+uint32_t DeflateDecoder::decodeSymbol(const uint32_t* table, int table_bits) {
+  if (bit_count_ < MaxCodeBits)
+    fillBits();
+  uint32_t entry = table[bit_buffer_ & ((1u << table_bits) - 1)];
+  if (entry & SubtableFlag) {
+    dropBits(table_bits);
+    entry = table[(entry >> 16) + (bit_buffer_ & ((1u << (entry & 0xFF)) - 1))];
+  }
+  if (entry & InvalidFlag)
+    throw FormatException("deflate");
+  dropBits(entry & 0xFF);
+  return entry >> 16;
+}
+
+bool DeflateDecoder::refillInput() {
+  ASSERT(input_pos_ == input_end_);
+  input_pos_ = 0;
+  input_end_ = input_.readAtMost(MutableBufferSpan(input_buffer_, InputBufferSize));
+  return input_end_ > 0;
+}
+
+void DeflateDecoder::fillBits() {
+  if (input_end_ - input_pos_ >= 8) {
+    uint64_t x;
+    ::memcpy(&x, input_buffer_ + input_pos_, 8);
+    bit_buffer_ |= x << bit_count_;
+    input_pos_ += (63 - bit_count_) >> 3;
+    bit_count_ |= 56;
+    return;
+  }
+  while (bit_count_ <= 56) {
+    if (input_pos_ == input_end_ && !refillInput())
+      break;
+    bit_buffer_ |= static_cast<uint64_t>(input_buffer_[input_pos_++]) << bit_count_;
+    bit_count_ += 8;
+  }
+}
+
+uint32_t DeflateDecoder::readBits(int count) {
+  ASSERT(count <= 32);
+  if (bit_count_ < count)
+    fillBits();
+  uint32_t bits = static_cast<uint32_t>(bit_buffer_ & ((UINT64_C(1) << count) - 1));
+  dropBits(count);
+  return bits;
+}
+
+void DeflateDecoder::dropBits(int count) {
+  // Bits past the end of input are zeros, caught here.
+  if (count > bit_count_)
+    throw EndOfStreamException();
+  bit_buffer_ >>= count;
+  bit_count_ -= count;
+}
+
+int DeflateDecoder::tryReadAlignedByte() {
+  ASSERT(bit_count_ % 8 == 0);
+  if (bit_count_ > 0) {
+    int byte = static_cast<int>(bit_buffer_ & 0xFF);
+    dropBits(8);
+    return byte;
+  }
+  // Drop bits of partially loaded bytes, they are read directly below.
+  bit_buffer_ = 0;
+  if (input_pos_ == input_end_ && !refillInput())
+    return -1;
+  return input_buffer_[input_pos_++];
+}
+
+void DeflateDecoder::readAligned(MutableBufferSpan output) {
+  ASSERT(bit_count_ % 8 == 0);
+  auto* out = static_cast<byte_t*>(output.data());
+  int remaining = output.size();
+  for (; remaining > 0 && bit_count_ > 0; --remaining) {
+    *out++ = static_cast<byte_t>(bit_buffer_);
+    dropBits(8);
+  }
+  if (remaining > 0)
+    bit_buffer_ = 0;
+  while (remaining > 0) {
+    if (input_pos_ == input_end_ && !refillInput())
+      throw EndOfStreamException();
+    int count = min(remaining, input_end_ - input_pos_);
+    ::memcpy(out, input_buffer_ + input_pos_, toUnsigned(count));
+    input_pos_ += count;
+    out += count;
+    remaining -= count;
+  }
+}
+
+} // namespace stp
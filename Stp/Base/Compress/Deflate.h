@@ -0,0 +1,165 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#ifndef STP_BASE_COMPRESS_DEFLATE_H_
+#define STP_BASE_COMPRESS_DEFLATE_H_
+
+#include "Base/Containers/BufferSpan.h"
+#include "Base/Containers/List.h"
+
+namespace stp {
+
+class Stream;
+
+// Compresses data in raw DEFLATE format (RFC 1951).
+//
+// The input is given in chunks and each chunk is compressed on its own, so
+// chunks of a single stream may be compressed on different threads and
+// concatenated afterwards (the way pigz does it). Passing preceding data as
+// history lets matches cross chunk boundaries.
+class BASE_EXPORT DeflateEncoder {
+  DISALLOW_COPY_AND_ASSIGN(DeflateEncoder);
+ public:
+  // Level 0 stores data uncompressed. Levels 1 to 3 take the first match
+  // found, higher levels search longer and defer a match if the next one
+  // is longer (lazy matching).
+  static constexpr int MinLevel = 0;
+  static constexpr int MaxLevel = 9;
+  static constexpr int DefaultLevel = 6;
+
+  // Matches cannot refer further back than this.
+  static constexpr int WindowSize = 32768;
+
+  explicit DeflateEncoder(int level = DefaultLevel);
+  ~DeflateEncoder();
+
+  // Compresses |input| and appends resulting blocks to |output|.
+  // |history| is the data directly preceding |input| in the stream, only its
+  // last WindowSize bytes are used.
+  // Unless |final| is set, the output is terminated with an empty stored
+  // block (sync flush) so it ends at byte boundary and compressed data for
+  // the next chunk may be appended to it.
+  void compress(BufferSpan history, BufferSpan input, bool final, List<byte_t>& output);
+
+ private:
+  static constexpr int LiteralLengthCodeCount = 286;
+  static constexpr int DistanceCodeCount = 30;
+
+  struct Token {
+    // A literal if |distance| is zero, match length otherwise.
+    uint16_t literal_or_length;
+    uint16_t distance;
+  };
+
+  void insertString(int pos);
+  // Returns the length of the longest match at |pos| longer than
+  // |prev_length| or zero if there is none.
+  int findLongestMatch(int pos, int prev_length, int& out_distance);
+
+  void compressGreedy(int begin, int end);
+  void compressLazy(int begin, int end);
+
+  void addLiteral(int pos);
+  void addMatch(int pos, int length, int distance);
+  bool isBlockFull() const;
+  void flushBlock(bool final);
+
+  void writeStoredBlocks(BufferSpan data, bool final);
+  void writeTokens(
+      const uint16_t* literal_length_codes, const uint8_t* literal_length_code_lengths,
+      const uint16_t* distance_codes, const uint8_t* distance_code_lengths);
+
+  void putBits(uint32_t bits, int count);
+  void alignToByte();
+
+  int level_;
+
+  // History followed by input.
+  List<byte_t> window_;
+  // Hash chains. |head_| holds the most recent position for each hash,
+  // |chain_| the distance to previous position with the same hash.
+  List<int32_t> head_;
+  List<uint16_t> chain_;
+
+  List<Token> tokens_;
+  uint32_t literal_length_freqs_[LiteralLengthCodeCount];
+  uint32_t distance_freqs_[DistanceCodeCount];
+  // The range of |window_| covered by |tokens_|.
+  int block_begin_ = 0;
+  int block_end_ = 0;
+
+  List<byte_t>* output_ = nullptr;
+  uint64_t bit_buffer_ = 0;
+  int bit_count_ = 0;
+};
+
+// Decompresses raw DEFLATE (RFC 1951) data pulled from a stream.
+class BASE_EXPORT DeflateDecoder {
+  DISALLOW_COPY_AND_ASSIGN(DeflateDecoder);
+ public:
+  explicit DeflateDecoder(Stream& input);
+  ~DeflateDecoder();
+
+  // Returns the number of bytes decompressed, zero at the end of compressed
+  // data. Throws FormatException if input is malformed and
+  // EndOfStreamException if it ends prematurely.
+  int decompress(MutableBufferSpan output);
+
+  // True when the final block is decoded and all data is returned.
+  bool isFinished() const { return state_ == State::Finished && output_pos_ == window_pos_; }
+
+  // Starts decoding next DEFLATE stream which follows the current one.
+  void reset();
+
+  // Access to bytes before or after compressed data, i.e. gzip header
+  // and trailer. Valid only before first decompress() call or once finished.
+  // The decoder reads its input in large chunks, so these bytes must be
+  // read through the decoder and not from the underlying stream.
+  int tryReadAlignedByte();
+  void readAligned(MutableBufferSpan output);
+
+ private:
+  enum class State {
+    BlockHeader,
+    Stored,
+    Huffman,
+    Finished,
+  };
+
+  void decodeSome();
+  void readBlockHeader();
+  void readDynamicTables();
+  void copyStored();
+  void decodeHuffman();
+
+  uint32_t decodeSymbol(const uint32_t* table, int table_bits);
+
+  bool refillInput();
+  void fillBits();
+  uint32_t readBits(int count);
+  void dropBits(int count);
+
+  Stream& input_;
+  byte_t* input_buffer_;
+  int input_pos_ = 0;
+  int input_end_ = 0;
+  uint64_t bit_buffer_ = 0;
+  int bit_count_ = 0;
+
+  // Holds last WindowSize bytes of output for matches to refer to and
+  // newly decoded data from |output_pos_| to |window_pos_|.
+  byte_t* window_;
+  int window_pos_ = 0;
+  int output_pos_ = 0;
+
+  State state_ = State::BlockHeader;
+  bool final_block_ = false;
+  int stored_remaining_ = 0;
+
+  List<uint32_t> literal_length_table_;
+  List<uint32_t> distance_table_;
+};
+
+} // namespace stp
+
+#endif // STP_BASE_COMPRESS_DEFLATE_H_
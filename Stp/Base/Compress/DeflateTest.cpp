@@ -0,0 +1,146 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Compress/Deflate.h"
+
+#include "Base/Error/BasicExceptions.h"
+#include "Base/Io/IoException.h"
+#include "Base/Io/MemoryStream.h"
+#include "Base/Test/GTest.h"
+#include "Base/Util/Random.h"
+
+namespace stp {
+
+namespace {
+
+List<byte_t> makeText(int size) {
+  static const char* const Words[] = {
+    "{\"id\": ", "\"name\": ", "\"value\": ", "true, ", "null, ", "1234, ", "}\n", "\"tags\": [], ",
+  };
+  List<byte_t> text;
+  Random random;
+  while (text.size() < size) {
+    const char* word = Words[(random.NextUInt32() >> 16) % 8];
+    for (; *word && text.size() < size; ++word)
+      text.add(static_cast<byte_t>(*word));
+  }
+  return text;
+}
+
+List<byte_t> makeNoise(int size) {
+  List<byte_t> noise;
+  Random random(7);
+  for (int i = 0; i < size; ++i)
+    noise.add(static_cast<byte_t>(random.NextUInt32() >> 24));
+  return noise;
+}
+
+BufferSpan toBuffer(const List<byte_t>& list) {
+  return BufferSpan(list.data(), list.size());
+}
+
+List<byte_t> compress(const List<byte_t>& input, int level) {
+  DeflateEncoder encoder(level);
+  List<byte_t> output;
+  encoder.compress(BufferSpan(), toBuffer(input), true, output);
+  return output;
+}
+
+List<byte_t> decompress(const List<byte_t>& input) {
+  MemoryStream stream;
+  stream.open(toBuffer(input));
+  DeflateDecoder decoder(stream);
+
+  List<byte_t> output;
+  while (true) {
+    constexpr int ChunkSize = 10000;
+    byte_t* chunk = output.appendUninitialized(ChunkSize);
+    int count = decoder.decompress(MutableBufferSpan(chunk, ChunkSize));
+    output.truncate(output.size() - ChunkSize + count);
+    if (count == 0)
+      break;
+  }
+  EXPECT_TRUE(decoder.isFinished());
+  return output;
+}
+
+} // namespace
+
+TEST(DeflateTest, RoundTrip) {
+  auto text = makeText(300000);
+  int previous_size = text.size();
+  for (int level = DeflateEncoder::MinLevel; level <= DeflateEncoder::MaxLevel; ++level) {
+    auto compressed = compress(text, level);
+    EXPECT_EQ(toBuffer(text), toBuffer(decompress(compressed))) << "level " << level;
+    if (level == 1 || level == DeflateEncoder::MaxLevel) {
+      EXPECT_LT(compressed.size(), previous_size) << "level " << level;
+      previous_size = compressed.size();
+    }
+  }
+}
+
+TEST(DeflateTest, SmallAndIncompressible) {
+  for (int size : { 0, 1, 3, 100, 70000 }) {
+    auto noise = makeNoise(size);
+    for (int level : { 0, 1, 6, 9 }) {
+      auto compressed = compress(noise, level);
+      // Stored blocks cost 5 bytes each.
+      EXPECT_GE(size + 5 * (1 + size / 16384), compressed.size()) << "size " << size << " level " << level;
+      EXPECT_EQ(toBuffer(noise), toBuffer(decompress(compressed))) << "size " << size << " level " << level;
+    }
+  }
+}
+
+TEST(DeflateTest, Chunks) {
+  // Chunks compressed separately with preceding data as history
+  // concatenate into a single stream.
+  auto text = makeText(100000);
+  List<byte_t> whole;
+  DeflateEncoder(6).compress(BufferSpan(), toBuffer(text), true, whole);
+
+  List<byte_t> chunked;
+  DeflateEncoder encoder(6);
+  for (int pos = 0; pos < text.size(); pos += 10000) {
+    BufferSpan history(text.data(), pos);
+    BufferSpan chunk(text.data() + pos, 10000);
+    encoder.compress(history, chunk, pos + 10000 == text.size(), chunked);
+  }
+  EXPECT_EQ(toBuffer(text), toBuffer(decompress(chunked)));
+  // Matches cross chunk boundaries, so the cost is mostly in sync flushes.
+  EXPECT_LT(chunked.size(), whole.size() + whole.size() / 10);
+}
+
+TEST(DeflateTest, FixedHuffman) {
+  // "Hello" compressed by zlib with fixed Huffman codes.
+  const byte_t Input[] = { 0xF3, 0x48, 0xCD, 0xC9, 0xC9, 0x07, 0x00 };
+  MemoryStream stream;
+  stream.open(BufferSpan(Input, sizeof(Input)));
+  DeflateDecoder decoder(stream);
+  byte_t output[16];
+  int count = decoder.decompress(MutableBufferSpan(output, sizeof(output)));
+  EXPECT_EQ(BufferSpan("Hello"), BufferSpan(output, count));
+  EXPECT_EQ(0, decoder.decompress(MutableBufferSpan(output, sizeof(output))));
+}
+
+TEST(DeflateTest, Malformed) {
+  const byte_t ReservedBlockType[] = { 0x07 };
+  // Stored block with mismatched length complement.
+  const byte_t BadStoredLength[] = { 0x01, 0x05, 0x00, 0x00, 0x00 };
+  // Fixed block with literal and invalid distance code 30.
+  const byte_t BadDistance[] = { 0x4B, 0x04, 0x3E };
+  for (auto input : { BufferSpan(ReservedBlockType, 1), BufferSpan(BadStoredLength, 5), BufferSpan(BadDistance, 3) }) {
+    MemoryStream stream;
+    stream.open(input);
+    DeflateDecoder decoder(stream);
+    byte_t output[16];
+    EXPECT_THROW(decoder.decompress(MutableBufferSpan(output, sizeof(output))), FormatException);
+  }
+}
+
+TEST(DeflateTest, Truncated) {
+  auto compressed = compress(makeText(10000), 6);
+  compressed.truncate(compressed.size() / 2);
+  EXPECT_THROW(decompress(compressed), EndOfStreamException);
+}
+
+} // namespace stp
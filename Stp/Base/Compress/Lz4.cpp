@@ -0,0 +1,385 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Compress/Lz4.h"
+
+#include "Base/Error/BasicExceptions.h"
+#include "Base/Math/Bits.h"
+#include "Base/Memory/OwnPtr.h"
+
+#include <string.h>
+
+namespace stp {
+
+namespace {
+
+constexpr int MinMatch = 4;
+// The last 5 bytes of a block are always literals.
+constexpr int LastLiterals = 5;
+// The last match must start at least 12 bytes before the end of a block.
+constexpr int MatchFindLimit = 12;
+
+constexpr int FastHashBits = 13;
+constexpr int ChainHashBits = 16;
+constexpr int ChainSize = 1 << 16;
+// After this many misses in a row fast compressor starts skipping
+// more than one byte ahead.
+constexpr int SkipTrigger = 6;
+// From this level on compressor tries to find a longer match
+// at next position before accepting one.
+constexpr int LazyLevel = 6;
+
+inline uint16_t load16(const byte_t* p) {
+  uint16_t x;
+  ::memcpy(&x, p, sizeof(x));
+  return x;
+}
+
+inline uint32_t load32(const byte_t* p) {
+  uint32_t x;
+  ::memcpy(&x, p, sizeof(x));
+  return x;
+}
+
+inline uint64_t load64(const byte_t* p) {
+  uint64_t x;
+  ::memcpy(&x, p, sizeof(x));
+  return x;
+}
+
+inline void store16(byte_t* p, uint16_t x) {
+  ::memcpy(p, &x, sizeof(x));
+}
+
+template<int TBits>
+inline uint32_t hashSequence(const byte_t* p) {
+  return (load32(p) * 2654435761u) >> (32 - TBits);
+}
+
+// Returns the number of equal bytes at |a| and |b|, stops at |a_limit|.
+inline int countMatch(const byte_t* a, const byte_t* b, const byte_t* a_limit) {
+  const byte_t* start = a;
+  while (a + 8 <= a_limit) {
+    uint64_t diff = load64(a) ^ load64(b);
+    if (diff)
+      return static_cast<int>(a - start) + countTrailingZeroBits(diff) / 8;
+    a += 8;
+    b += 8;
+  }
+  while (a < a_limit && *a == *b) {
+    ++a;
+    ++b;
+  }
+  return static_cast<int>(a - start);
+}
+
+inline byte_t* writeLength(byte_t* out, int length) {
+  for (; length >= 255; length -= 255)
+    *out++ = 255;
+  *out++ = static_cast<byte_t>(length);
+  return out;
+}
+
+class Lz4Writer {
+ public:
+  explicit Lz4Writer(MutableBufferSpan output)
+      : out_(static_cast<byte_t*>(output.data())),
+        begin_(out_),
+        end_(out_ + output.size()) {}
+
+  // Returns false if |output| is too small.
+  bool writeSequence(const byte_t* literals, int literal_length, int offset, int match_length) {
+    ASSERT(0 < offset && offset <= Lz4::MaxDistance);
+    ASSERT(match_length >= MinMatch);
+    int bound = 1 + literal_length / 255 + 1 + literal_length + 2 + match_length / 255 + 1;
+    if (bound > end_ - out_)
+      return false;
+
+    byte_t* token = out_++;
+    *token = writeLiterals(literals, literal_length);
+
+    store16(out_, static_cast<uint16_t>(offset));
+    out_ += 2;
+
+    int length_code = match_length - MinMatch;
+    if (length_code >= 15) {
+      *token |= 15;
+      out_ = writeLength(out_, length_code - 15);
+    } else {
+      *token |= static_cast<byte_t>(length_code);
+    }
+    return true;
+  }
+
+  bool writeLastLiterals(const byte_t* literals, int literal_length) {
+    int bound = 1 + literal_length / 255 + 1 + literal_length;
+    if (bound > end_ - out_)
+      return false;
+    byte_t* token = out_++;
+    *token = writeLiterals(literals, literal_length);
+    return true;
+  }
+
+  int getSize() const { return static_cast<int>(out_ - begin_); }
+
+ private:
+  // Returns the token with literal length.
+  byte_t writeLiterals(const byte_t* literals, int length) {
+    byte_t token;
+    if (length >= 15) {
+      token = 15 << 4;
+      out_ = writeLength(out_, length - 15);
+    } else {
+      token = static_cast<byte_t>(length << 4);
+    }
+    if (length > 0)
+      ::memcpy(out_, literals, toUnsigned(length));
+    out_ += length;
+    return token;
+  }
+
+  byte_t* out_;
+  byte_t* begin_;
+  byte_t* end_;
+};
+
+int compressFast(const byte_t* begin, int size, Lz4Writer& writer) {
+  constexpr int HashSize = 1 << FastHashBits;
+  uint32_t table[HashSize];
+  ::memset(table, 0, sizeof(table));
+
+  const byte_t* end = begin + size;
+  const byte_t* match_limit = end - LastLiterals;
+  const byte_t* find_limit = end - MatchFindLimit;
+
+  const byte_t* anchor = begin;
+  const byte_t* ip = begin + 1;
+  int misses = 0;
+  while (ip <= find_limit) {
+    uint32_t hash = hashSequence<FastHashBits>(ip);
+    const byte_t* match = begin + table[hash];
+    table[hash] = static_cast<uint32_t>(ip - begin);
+
+    if (ip - match > Lz4::MaxDistance || load32(match) != load32(ip)) {
+      ip += 1 + (misses++ >> SkipTrigger);
+      continue;
+    }
+    misses = 0;
+
+    // Extend backwards.
+    while (ip > anchor && match > begin && ip[-1] == match[-1]) {
+      --ip;
+      --match;
+    }
+    int length = MinMatch + countMatch(ip + MinMatch, match + MinMatch, match_limit);
+    if (!writer.writeSequence(anchor, static_cast<int>(ip - anchor), static_cast<int>(ip - match), length))
+      return 0;
+
+    ip += length;
+    anchor = ip;
+    if (ip <= find_limit)
+      table[hashSequence<FastHashBits>(ip - 2)] = static_cast<uint32_t>(ip - 2 - begin);
+  }
+  if (!writer.writeLastLiterals(anchor, static_cast<int>(end - anchor)))
+    return 0;
+  return writer.getSize();
+}
+
+class ChainMatcher {
+ public:
+  ChainMatcher(const byte_t* begin, int max_attempts)
+      : begin_(begin), max_attempts_(max_attempts) {
+    ::memset(head_, 0xFF, sizeof(head_));
+  }
+
+  // Returns length of the longest match for |ip| longer than |min_length|,
+  // zero if none found.
+  int find(const byte_t* ip, const byte_t* match_limit, int min_length, const byte_t*& out_match) {
+    int pos = static_cast<int>(ip - begin_);
+    insertUpTo(pos);
+
+    int best_length = min_length;
+    int candidate = head_[hashSequence<ChainHashBits>(ip)];
+    int max_length = static_cast<int>(match_limit - ip);
+    for (int attempts = max_attempts_; candidate >= 0 && attempts > 0; --attempts) {
+      if (pos - candidate > Lz4::MaxDistance)
+        break;
+      const byte_t* match = begin_ + candidate;
+      if (best_length < max_length &&
+          match[best_length] == ip[best_length] &&
+          load32(match) == load32(ip)) {
+        int length = MinMatch + countMatch(ip + MinMatch, match + MinMatch, match_limit);
+        if (length > best_length) {
+          best_length = length;
+          out_match = match;
+        }
+      }
+      int delta = chain_[candidate & (ChainSize - 1)];
+      if (delta == 0xFFFF)
+        break;
+      candidate -= delta;
+    }
+    return best_length > min_length ? best_length : 0;
+  }
+
+ private:
+  void insertUpTo(int pos) {
+    for (; next_insert_ < pos; ++next_insert_) {
+      uint32_t hash = hashSequence<ChainHashBits>(begin_ + next_insert_);
+      int previous = head_[hash];
+      int delta = next_insert_ - previous;
+      chain_[next_insert_ & (ChainSize - 1)] =
+          static_cast<uint16_t>(previous < 0 || delta >= 0xFFFF ? 0xFFFF : delta);
+      head_[hash] = next_insert_;
+    }
+  }
+
+  const byte_t* begin_;
+  int max_attempts_;
+  int next_insert_ = 0;
+  int32_t head_[1 << ChainHashBits];
+  uint16_t chain_[ChainSize];
+};
+
+int compressChain(const byte_t* begin, int size, int level, Lz4Writer& writer) {
+  auto matcher = OwnPtr<ChainMatcher>::create(begin, 1 << (level - 1));
+
+  const byte_t* end = begin + size;
+  const byte_t* match_limit = end - LastLiterals;
+  const byte_t* find_limit = end - MatchFindLimit;
+
+  const byte_t* anchor = begin;
+  const byte_t* ip = begin;
+  while (ip <= find_limit) {
+    const byte_t* match = nullptr;
+    int length = matcher->find(ip, match_limit, MinMatch - 1, match);
+    if (!length) {
+      ++ip;
+      continue;
+    }
+
+    if (level >= LazyLevel) {
+      while (ip + 1 <= find_limit) {
+        const byte_t* next_match = nullptr;
+        int next_length = matcher->find(ip + 1, match_limit, length, next_match);
+        if (!next_length)
+          break;
+        ++ip;
+        match = next_match;
+        length = next_length;
+      }
+    }
+
+    while (ip > anchor && match > begin && ip[-1] == match[-1]) {
+      --ip;
+      --match;
+      ++length;
+    }
+    if (!writer.writeSequence(anchor, static_cast<int>(ip - anchor), static_cast<int>(ip - match), length))
+      return 0;
+
+    ip += length;
+    anchor = ip;
+  }
+  if (!writer.writeLastLiterals(anchor, static_cast<int>(end - anchor)))
+    return 0;
+  return writer.getSize();
+}
+
+} // namespace
+
+int Lz4::compress(BufferSpan input, MutableBufferSpan output, int level) {
+  ASSERT(MinLevel <= level && level <= MaxLevel);
+
+  auto* begin = static_cast<const byte_t*>(input.data());
+  int size = input.size();
+
+  Lz4Writer writer(output);
+  if (size < MatchFindLimit + 1) {
+    if (!writer.writeLastLiterals(begin, size))
+      return 0;
+    return writer.getSize();
+  }
+  if (level == MinLevel)
+    return compressFast(begin, size, writer);
+  return compressChain(begin, size, level, writer);
+}
+
+static inline int readLength(const byte_t*& ip, const byte_t* input_end, int length) {
+  while (true) {
+    if (ip == input_end)
+      throw FormatException("lz4");
+    byte_t x = *ip++;
+    length += x;
+    if (x != 255)
+      break;
+    if (length > (1 << 30))
+      throw FormatException("lz4");
+  }
+  return length;
+}
+
+int Lz4::decompress(BufferSpan input, MutableBufferSpan output, int history_size) {
+  ASSERT(0 <= history_size && history_size <= output.size());
+
+  auto* ip = static_cast<const byte_t*>(input.data());
+  const byte_t* input_end = ip + input.size();
+  auto* output_begin = static_cast<byte_t*>(output.data());
+  byte_t* output_end = output_begin + output.size();
+  byte_t* op = output_begin + history_size;
+  byte_t* block_begin = op;
+
+  if (ip == input_end)
+    throw FormatException("lz4");
+
+  while (true) {
+    byte_t token = *ip++;
+
+    int literal_length = token >> 4;
+    if (literal_length == 15)
+      literal_length = readLength(ip, input_end, literal_length);
+    if (literal_length > input_end - ip || literal_length > output_end - op)
+      throw FormatException("lz4");
+    if (literal_length > 0)
+      ::memcpy(op, ip, toUnsigned(literal_length));
+    ip += literal_length;
+    op += literal_length;
+
+    // The last sequence has no match.
+    if (ip == input_end)
+      break;
+
+    if (input_end - ip < 2)
+      throw FormatException("lz4");
+    int offset = load16(ip);
+    ip += 2;
+    if (offset == 0 || offset > op - output_begin)
+      throw FormatException("lz4");
+
+    int length = token & 15;
+    if (length == 15)
+      length = readLength(ip, input_end, length);
+    length += MinMatch;
+    if (length > output_end - op)
+      throw FormatException("lz4");
+
+    const byte_t* match = op - offset;
+    if (offset >= 8 && length <= output_end - op - 8) {
+      // May write up to 7 bytes past the match, they are overwritten later.
+      byte_t* copy_end = op + length;
+      do {
+        ::memcpy(op, match, 8);
+        op += 8;
+        match += 8;
+      } while (op < copy_end);
+      op = copy_end;
+    } else {
+      for (int i = 0; i < length; ++i)
+        op[i] = match[i];
+      op += length;
+    }
+  }
+  return static_cast<int>(op - block_begin);
+}
+
+} // namespace stp
@@ -0,0 +1,50 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#ifndef STP_BASE_COMPRESS_LZ4_H_
+#define STP_BASE_COMPRESS_LZ4_H_
+
+#include "Base/Containers/BufferSpan.h"
+
+namespace stp {
+
+// Fast LZ77 compression in LZ4 block format.
+//
+// Only the block format lives here. Framing (LZ4 frame format) is done by
+// CompressionStream and DecompressionStream.
+class BASE_EXPORT Lz4 {
+  STATIC_ONLY(Lz4);
+ public:
+  // Level 1 looks at single match candidate and skips faster over
+  // incompressible data. Higher levels search hash chains, deeper with
+  // every level, and from level 6 on try a lazy match.
+  static constexpr int MinLevel = 1;
+  static constexpr int MaxLevel = 9;
+  static constexpr int DefaultLevel = 1;
+
+  // Matches cannot refer further back than this.
+  static constexpr int MaxDistance = 65535;
+
+  // The size of output buffer enough to hold compressed |input_size| bytes
+  // in the worst case.
+  static constexpr int getMaxCompressedSize(int input_size) {
+    return input_size + input_size / 255 + 16;
+  }
+
+  // Compresses |input| into |output| which should be able to hold
+  // getMaxCompressedSize() bytes.
+  // Returns the size of compressed data or zero if it did not fit in |output|.
+  static int compress(BufferSpan input, MutableBufferSpan output, int level = DefaultLevel);
+
+  // Decompresses a block.
+  // The first |history_size| bytes of |output| hold data preceding the block
+  // (matches may refer to them). Decompressed data is written right after.
+  // Returns the number of bytes decompressed.
+  // Throws FormatException if |input| is malformed or decompressed data
+  // does not fit in |output|.
+  static int decompress(BufferSpan input, MutableBufferSpan output, int history_size = 0);
+};
+
+} // namespace stp
+
+#endif // STP_BASE_COMPRESS_LZ4_H_
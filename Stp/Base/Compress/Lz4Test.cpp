@@ -0,0 +1,126 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Compress/Lz4.h"
+
+#include "Base/Containers/List.h"
+#include "Base/Error/BasicExceptions.h"
+#include "Base/Test/GTest.h"
+#include "Base/Util/Random.h"
+
+namespace stp {
+
+namespace {
+
+// Text-like data with plenty of repetitions at various distances.
+List<byte_t> makeText(int size) {
+  static const char* const Words[] = {
+    "alpha ", "beta ", "gamma ", "delta ", "epsilon\n", "zeta ", "eta, ", "theta ",
+  };
+  List<byte_t> text;
+  Random random;
+  while (text.size() < size) {
+    const char* word = Words[(random.NextUInt32() >> 16) % 8];
+    for (; *word && text.size() < size; ++word)
+      text.add(static_cast<byte_t>(*word));
+  }
+  return text;
+}
+
+List<byte_t> makeNoise(int size) {
+  List<byte_t> noise;
+  Random random(7);
+  for (int i = 0; i < size; ++i)
+    noise.add(static_cast<byte_t>(random.NextUInt32() >> 24));
+  return noise;
+}
+
+BufferSpan toBuffer(const List<byte_t>& list) {
+  return BufferSpan(list.data(), list.size());
+}
+
+List<byte_t> roundTrip(const List<byte_t>& input, int level) {
+  List<byte_t> compressed;
+  int capacity = Lz4::getMaxCompressedSize(input.size());
+  int size = Lz4::compress(toBuffer(input), MutableBufferSpan(compressed.appendUninitialized(capacity), capacity), level);
+  EXPECT_LT(0, size);
+  compressed.truncate(size);
+
+  List<byte_t> output;
+  int decompressed = Lz4::decompress(
+      toBuffer(compressed),
+      MutableBufferSpan(output.appendUninitialized(input.size()), input.size()));
+  output.truncate(decompressed);
+  return output;
+}
+
+} // namespace
+
+TEST(Lz4Test, RoundTrip) {
+  auto text = makeText(200000);
+  for (int level = Lz4::MinLevel; level <= Lz4::MaxLevel; ++level) {
+    EXPECT_EQ(toBuffer(text), toBuffer(roundTrip(text, level))) << "level " << level;
+  }
+}
+
+TEST(Lz4Test, HigherLevelCompressesBetter) {
+  auto text = makeText(100000);
+  int sizes[2];
+  int levels[2] = { Lz4::MinLevel, Lz4::MaxLevel };
+  for (int i = 0; i < 2; ++i) {
+    List<byte_t> compressed;
+    int capacity = Lz4::getMaxCompressedSize(text.size());
+    sizes[i] = Lz4::compress(toBuffer(text), MutableBufferSpan(compressed.appendUninitialized(capacity), capacity), levels[i]);
+  }
+  EXPECT_LT(sizes[1], sizes[0]);
+  EXPECT_LT(sizes[0], text.size() / 2);
+}
+
+TEST(Lz4Test, SmallAndIncompressible) {
+  for (int size : { 0, 1, 5, 12, 13, 100, 70000 }) {
+    auto noise = makeNoise(size);
+    EXPECT_EQ(toBuffer(noise), toBuffer(roundTrip(noise, Lz4::MinLevel))) << "size " << size;
+    EXPECT_EQ(toBuffer(noise), toBuffer(roundTrip(noise, Lz4::MaxLevel))) << "size " << size;
+  }
+}
+
+TEST(Lz4Test, OutputTooSmall) {
+  auto text = makeText(1000);
+  byte_t output[16];
+  EXPECT_EQ(0, Lz4::compress(toBuffer(text), MutableBufferSpan(output, sizeof(output))));
+}
+
+TEST(Lz4Test, History) {
+  auto text = makeText(1000);
+  // Literal "beta " followed by a match 500 bytes back, into the history.
+  const byte_t Block[] = { 0x51, 'b', 'e', 't', 'a', ' ', 0xF4, 0x01, 0x10, 'x' };
+
+  List<byte_t> output;
+  output.append(text);
+  output.appendUninitialized(100);
+  int size = Lz4::decompress(BufferSpan(Block, sizeof(Block)), MutableBufferSpan(output.data(), output.size()), 1000);
+  ASSERT_EQ(5 + 5 + 1, size);
+  EXPECT_EQ(BufferSpan(text.data() + 505, 5), BufferSpan(output.data() + 1005, 5));
+  EXPECT_EQ('x', output[1010]);
+}
+
+TEST(Lz4Test, Malformed) {
+  byte_t output[64];
+  MutableBufferSpan output_span(output, sizeof(output));
+  // Empty input.
+  EXPECT_THROW(Lz4::decompress(BufferSpan(), output_span), FormatException);
+  // Literals past the end of input.
+  const byte_t Truncated[] = { 0x50, 'a', 'b' };
+  EXPECT_THROW(Lz4::decompress(BufferSpan(Truncated, sizeof(Truncated)), output_span), FormatException);
+  // Offset before the beginning of output.
+  const byte_t BadOffset[] = { 0x10, 'a', 0x02, 0x00, 0x00 };
+  EXPECT_THROW(Lz4::decompress(BufferSpan(BadOffset, sizeof(BadOffset)), output_span), FormatException);
+  // Zero offset.
+  const byte_t ZeroOffset[] = { 0x10, 'a', 0x00, 0x00, 0x00 };
+  EXPECT_THROW(Lz4::decompress(BufferSpan(ZeroOffset, sizeof(ZeroOffset)), output_span), FormatException);
+  // Match longer than output.
+  const byte_t TooLong[] = { 0x1F, 'a', 0x01, 0x00, 0xFF, 0x00 };
+  EXPECT_THROW(Lz4::decompress(BufferSpan(TooLong, sizeof(TooLong)), output_span), FormatException);
+}
+
+} // namespace stp
@@ -0,0 +1,143 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#ifndef STP_BASE_CONTAINERS_BIGBUFFERSPAN_H_
+#define STP_BASE_CONTAINERS_BIGBUFFERSPAN_H_
+
+#include "Base/Containers/BufferSpan.h"
+
+namespace stp {
+
+// Like BufferSpan, but size is 64-bit, so it can address memory mapped files
+// larger than 2 GiB. Most of code works on BufferSpan, use chunks() to pass
+// the data piece by piece:
+//
+//   for (BufferSpan chunk : big_span.chunks(1 << 20))
+//     hasher.update(chunk);
+class BigBufferSpan {
+ public:
+  // Large enough to amortize per-chunk overhead of any consumer.
+  static constexpr int DefaultChunkSize = 1 << 30;
+
+  class ChunkIterator {
+   public:
+    constexpr ChunkIterator(const byte_t* data, int64_t remaining, int chunk_size) noexcept
+        : data_(data), remaining_(remaining), chunk_size_(chunk_size) {}
+
+    BufferSpan operator*() const noexcept { return BufferSpan(data_, getChunkSize()); }
+
+    ChunkIterator& operator++() noexcept {
+      int chunk_size = getChunkSize();
+      data_ += chunk_size;
+      remaining_ -= chunk_size;
+      return *this;
+    }
+
+    bool operator==(const ChunkIterator& other) const noexcept { return remaining_ == other.remaining_; }
+    bool operator!=(const ChunkIterator& other) const noexcept { return remaining_ != other.remaining_; }
+
+   private:
+    const byte_t* data_;
+    int64_t remaining_;
+    int chunk_size_;
+
+    int getChunkSize() const noexcept {
+      return remaining_ < chunk_size_ ? static_cast<int>(remaining_) : chunk_size_;
+    }
+  };
+
+  class ChunkRange {
+   public:
+    constexpr ChunkRange(const byte_t* data, int64_t size, int chunk_size) noexcept
+        : data_(data), size_(size), chunk_size_(chunk_size) {}
+
+    friend constexpr ChunkIterator begin(const ChunkRange& x) noexcept {
+      return ChunkIterator(x.data_, x.size_, x.chunk_size_);
+    }
+    friend constexpr ChunkIterator end(const ChunkRange& x) noexcept {
+      return ChunkIterator(x.data_ + x.size_, 0, x.chunk_size_);
+    }
+
+   private:
+    const byte_t* data_;
+    int64_t size_;
+    int chunk_size_;
+  };
+
+  constexpr BigBufferSpan() noexcept
+      : data_(nullptr), size_(0) {}
+
+  template<typename T, TEnableIf<TIsVoid<T>>* = nullptr>
+  explicit constexpr BigBufferSpan(const T* data, int64_t size) noexcept
+      : data_(static_cast<const byte_t*>(data)), size_(size) {}
+
+  template<typename T, TEnableIf<TIsTrivial<T>>* = nullptr>
+  explicit constexpr BigBufferSpan(const T* data, int64_t size) noexcept
+      : data_(reinterpret_cast<const byte_t*>(data)), size_(size * isizeof(T)) {}
+
+  constexpr BigBufferSpan(BufferSpan span) noexcept
+      : data_(static_cast<const byte_t*>(span.data())), size_(span.size()) {}
+
+  ALWAYS_INLINE constexpr const void* data() const noexcept { return data_; }
+  ALWAYS_INLINE constexpr int64_t size() const noexcept { return size_; }
+
+  constexpr bool isEmpty() const noexcept { return size_ == 0; }
+
+  constexpr BigBufferSpan slice(int64_t at) const noexcept {
+    ASSERT(0 <= at && at <= size_);
+    return BigBufferSpan(data_ + at, size_ - at);
+  }
+  constexpr BigBufferSpan slice(int64_t at, int64_t n) const noexcept {
+    ASSERT(0 <= at && at <= size_);
+    ASSERT(0 <= n && n <= size_ - at);
+    return BigBufferSpan(data_ + at, n);
+  }
+
+  // Returns a regular span at |at| of at most |max_size| bytes.
+  BufferSpan getChunk(int64_t at, int max_size) const noexcept {
+    ASSERT(0 <= at && at <= size_);
+    ASSERT(max_size >= 0);
+    int64_t remaining = size_ - at;
+    return BufferSpan(data_ + at, remaining < max_size ? static_cast<int>(remaining) : max_size);
+  }
+
+  // Splits the span into consecutive chunks of |chunk_size| bytes.
+  // The last chunk may be shorter.
+  constexpr ChunkRange chunks(int chunk_size = DefaultChunkSize) const noexcept {
+    ASSERT(chunk_size > 0);
+    return ChunkRange(data_, size_, chunk_size);
+  }
+
+  constexpr void truncate(int64_t at) noexcept {
+    ASSERT(0 <= at && at <= size_);
+    size_ = at;
+  }
+
+  constexpr void removePrefix(int64_t n) noexcept {
+    ASSERT(0 <= n && n <= size_);
+    data_ += n;
+    size_ -= n;
+  }
+  constexpr void removeSuffix(int64_t n) noexcept { truncate(size_ - n); }
+
+  friend bool operator==(const BigBufferSpan& lhs, const BigBufferSpan& rhs) noexcept {
+    return lhs.size_ == rhs.size_ &&
+        (lhs.size_ == 0 || ::memcmp(lhs.data_, rhs.data_, static_cast<size_t>(lhs.size_)) == 0);
+  }
+  friend bool operator!=(const BigBufferSpan& lhs, const BigBufferSpan& rhs) noexcept {
+    return !operator==(lhs, rhs);
+  }
+
+  friend constexpr const void* begin(const BigBufferSpan& x) noexcept { return x.data_; }
+  friend constexpr const void* end(const BigBufferSpan& x) noexcept { return x.data_ + x.size_; }
+
+ private:
+  const byte_t* data_;
+  int64_t size_;
+};
+
+template<> struct TIsZeroConstructibleTmpl<BigBufferSpan> : TTrue {};
+
+} // namespace stp
+
+#endif // STP_BASE_CONTAINERS_BIGBUFFERSPAN_H_
@@ -0,0 +1,232 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#ifndef STP_BASE_CONTAINERS_CONCURRENTHASHMAP_H_
+#define STP_BASE_CONTAINERS_CONCURRENTHASHMAP_H_
+
+#include "Base/Containers/HashMap.h"
+#include "Base/Math/PowerOfTwo.h"
+#include "Base/System/CpuInfo.h"
+#include "Base/Thread/ReadWriteLock.h"
+
+namespace stp {
+
+// Hash map safe to be used from many threads at once.
+//
+// Entries are distributed over lock-striped shards by (scrambled) hash code.
+// Each shard is a HashMap guarded by its own ReadWriteLock, so readers never
+// block each other and writers block only users of the same shard.
+// A shard grows independently under its own lock - resizing never stops
+// the whole map.
+//
+// Since another thread may remove an entry at any time, values are never
+// exposed by reference - tryGet() copies the value out. Use compute() for
+// read-modify-write operations.
+template<typename K, typename T>
+class ConcurrentHashMap {
+ public:
+  // |shard_count| is rounded up to power of two.
+  // Zero selects a count based on number of cores.
+  explicit ConcurrentHashMap(int shard_count = 0);
+  ~ConcurrentHashMap() { delete[] shards_; }
+
+  // Returns number of entries.
+  // The value may be outdated when other threads modify the map.
+  int size() const;
+
+  bool isEmpty() const { return size() == 0; }
+
+  void clear();
+
+  // Reserves space for |n| new entries spread evenly over shards.
+  void willGrow(int n);
+
+  template<typename U>
+  bool tryGet(const U& key, T* out_value) const;
+
+  template<typename U>
+  bool containsKey(const U& key) const;
+
+  template<typename U>
+  void set(U&& key, T value);
+
+  // Returns false if the key was already present.
+  template<typename U>
+  bool tryAdd(U&& key, T value);
+
+  template<typename U>
+  bool tryRemove(const U& key);
+
+  // Atomically replaces the value for |key| with |updater(old)|, where |old|
+  // is a pointer to current value or null if the key is absent.
+  // Returns the new value.
+  // |updater| is called with shard lock held and must not access the map.
+  template<typename U, typename TUpdater>
+  T compute(U&& key, TUpdater&& updater);
+
+  // Returns value for |key|, adding |factory()| first if the key is absent.
+  template<typename U, typename TFactory>
+  T getOrAdd(U&& key, TFactory&& factory);
+
+  // Calls |visitor(key, value)| for every entry, one shard at a time.
+  // The map must not be modified from within |visitor|.
+  template<typename TVisitor>
+  void forEach(TVisitor&& visitor) const;
+
+  int getShardCount() const { return shard_mask_ + 1; }
+
+ private:
+  struct ALIGNAS(64) Shard {
+    // Power-of-two bucket counts make rehashing under lock cheaper.
+    Shard() { map.setUseBinaryBucketSizes(); }
+
+    mutable ReadWriteLock lock;
+    HashMap<K, T> map;
+  };
+
+  Shard* shards_;
+  unsigned shard_mask_;
+  int shard_shift_;
+
+  template<typename U>
+  Shard& getShard(const U& key) const {
+    // HashMap uses low bits to select bucket, use high ones of scrambled
+    // hash code to select shard to keep both distributions independent.
+    uint32_t hash = toUnderlying(finalizeHash(partialHash(key)));
+    uint32_t index = (hash * 0x9E3779B9u) >> shard_shift_;
+    return shards_[index & shard_mask_];
+  }
+
+  DISALLOW_COPY_AND_ASSIGN(ConcurrentHashMap);
+};
+
+template<typename K, typename T>
+inline ConcurrentHashMap<K, T>::ConcurrentHashMap(int shard_count) {
+  ASSERT(shard_count >= 0);
+  if (shard_count == 0)
+    shard_count = max(CpuInfo::NumberOfCores() * 4, 16);
+  shard_count = roundUpToPowerOfTwo(shard_count);
+
+  shards_ = new Shard[shard_count];
+  shard_mask_ = static_cast<unsigned>(shard_count - 1);
+  // Shift by 32 is undefined - keep at least one bit for single shard.
+  shard_shift_ = 32 - max(log2Floor(shard_count), 1);
+}
+
+template<typename K, typename T>
+inline int ConcurrentHashMap<K, T>::size() const {
+  int total = 0;
+  for (unsigned i = 0; i <= shard_mask_; ++i) {
+    AutoReadLock guard(shards_[i].lock);
+    total += shards_[i].map.size();
+  }
+  return total;
+}
+
+template<typename K, typename T>
+inline void ConcurrentHashMap<K, T>::clear() {
+  for (unsigned i = 0; i <= shard_mask_; ++i) {
+    AutoWriteLock guard(shards_[i].lock);
+    shards_[i].map.clear();
+  }
+}
+
+template<typename K, typename T>
+inline void ConcurrentHashMap<K, T>::willGrow(int n) {
+  ASSERT(n >= 0);
+  int per_shard = (n + shard_mask_) / (shard_mask_ + 1);
+  for (unsigned i = 0; i <= shard_mask_; ++i) {
+    AutoWriteLock guard(shards_[i].lock);
+    shards_[i].map.willGrow(per_shard);
+  }
+}
+
+template<typename K, typename T>
+template<typename U>
+inline bool ConcurrentHashMap<K, T>::tryGet(const U& key, T* out_value) const {
+  ASSERT(out_value);
+  Shard& shard = getShard(key);
+  AutoReadLock guard(shard.lock);
+  const T* value = shard.map.tryGet(key);
+  if (!value)
+    return false;
+  *out_value = *value;
+  return true;
+}
+
+template<typename K, typename T>
+template<typename U>
+inline bool ConcurrentHashMap<K, T>::containsKey(const U& key) const {
+  Shard& shard = getShard(key);
+  AutoReadLock guard(shard.lock);
+  return shard.map.containsKey(key);
+}
+
+template<typename K, typename T>
+template<typename U>
+inline void ConcurrentHashMap<K, T>::set(U&& key, T value) {
+  Shard& shard = getShard(key);
+  AutoWriteLock guard(shard.lock);
+  shard.map.set(forward<U>(key), move(value));
+}
+
+template<typename K, typename T>
+template<typename U>
+inline bool ConcurrentHashMap<K, T>::tryAdd(U&& key, T value) {
+  Shard& shard = getShard(key);
+  AutoWriteLock guard(shard.lock);
+  return shard.map.tryAdd(forward<U>(key), move(value)) != nullptr;
+}
+
+template<typename K, typename T>
+template<typename U>
+inline bool ConcurrentHashMap<K, T>::tryRemove(const U& key) {
+  Shard& shard = getShard(key);
+  AutoWriteLock guard(shard.lock);
+  return shard.map.tryRemove(key);
+}
+
+template<typename K, typename T>
+template<typename U, typename TUpdater>
+inline T ConcurrentHashMap<K, T>::compute(U&& key, TUpdater&& updater) {
+  Shard& shard = getShard(key);
+  AutoWriteLock guard(shard.lock);
+  T* value = shard.map.tryGet(key);
+  if (value) {
+    *value = updater(const_cast<const T*>(value));
+    return *value;
+  }
+  return *shard.map.tryAdd(forward<U>(key), updater(static_cast<const T*>(nullptr)));
+}
+
+template<typename K, typename T>
+template<typename U, typename TFactory>
+inline T ConcurrentHashMap<K, T>::getOrAdd(U&& key, TFactory&& factory) {
+  Shard& shard = getShard(key);
+  {
+    // Optimistic path - most calls are expected to hit.
+    AutoReadLock guard(shard.lock);
+    const T* value = shard.map.tryGet(key);
+    if (value)
+      return *value;
+  }
+  AutoWriteLock guard(shard.lock);
+  T* value = shard.map.tryGet(key);
+  if (value)
+    return *value;
+  return *shard.map.tryAdd(forward<U>(key), factory());
+}
+
+template<typename K, typename T>
+template<typename TVisitor>
+inline void ConcurrentHashMap<K, T>::forEach(TVisitor&& visitor) const {
+  for (unsigned i = 0; i <= shard_mask_; ++i) {
+    AutoReadLock guard(shards_[i].lock);
+    for (const auto& pair : shards_[i].map.enumerate())
+      visitor(pair.key, pair.value);
+  }
+}
+
+} // namespace stp
+
+#endif // STP_BASE_CONTAINERS_CONCURRENTHASHMAP_H_
@@ -0,0 +1,116 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Containers/ConcurrentHashMap.h"
+
+#include "Base/Memory/OwnPtr.h"
+#include "Base/Test/GTest.h"
+#include "Base/Test/PerfTest.h"
+#include "Base/Text/StringFormatMany.h"
+#include "Base/Thread/Lock.h"
+#include "Base/Thread/Thread.h"
+#include "Base/Time/TimeTicks.h"
+
+namespace stp {
+
+static const int OperationsPerThread = 200000;
+static const int KeyRange = 1 << 16;
+static const int ThreadCounts[] = { 1, 2, 4, 8, 16 };
+
+namespace {
+
+// Contender - what shared caches use today.
+class LockedHashMap {
+ public:
+  LockedHashMap() { map_.setUseBinaryBucketSizes(); }
+
+  bool tryGet(int key, int* out_value) {
+    AutoLock guard(borrow(lock_));
+    const int* value = map_.tryGet(key);
+    if (!value)
+      return false;
+    *out_value = *value;
+    return true;
+  }
+
+  void set(int key, int value) {
+    AutoLock guard(borrow(lock_));
+    map_.set(key, value);
+  }
+
+ private:
+  Lock lock_;
+  HashMap<int, int> map_;
+};
+
+template<typename TMap>
+class MapWorkerThread : public Thread {
+ public:
+  // Every |write_period|-th operation is a write.
+  MapWorkerThread(TMap* map, int seed, int write_period)
+      : map_(*map), state_(static_cast<uint32_t>(seed) * 2654435761u + 1),
+        write_period_(write_period) {}
+
+  int Main() override {
+    int hits = 0;
+    for (int i = 0; i < OperationsPerThread; ++i) {
+      // Xorshift - cheap and good enough to scatter keys.
+      state_ ^= state_ << 13;
+      state_ ^= state_ >> 17;
+      state_ ^= state_ << 5;
+      int key = static_cast<int>(state_ % KeyRange);
+      if (i % write_period_ == 0) {
+        map_.set(key, i);
+      } else {
+        int value;
+        if (map_.tryGet(key, &value))
+          ++hits;
+      }
+    }
+    return hits;
+  }
+
+ private:
+  TMap& map_;
+  uint32_t state_;
+  int write_period_;
+};
+
+template<typename TMap>
+void runMapBenchmark(const char* measurement, const String& trace_name, int write_period) {
+  for (int thread_count : ThreadCounts) {
+    TMap map;
+    for (int key = 0; key < KeyRange; key += 2)
+      map.set(key, key);
+
+    List<OwnPtr<MapWorkerThread<TMap>>> threads;
+    for (int i = 0; i < thread_count; ++i)
+      threads.add(OwnPtr<MapWorkerThread<TMap>>::create(&map, i, write_period));
+
+    TimeTicks start = TimeTicks::Now();
+    for (auto& thread : threads)
+      thread->Start();
+    for (auto& thread : threads)
+      thread->Join();
+    double total_time_milliseconds = (TimeTicks::Now() - start).InMillisecondsF();
+
+    perf_test::PrintResult(
+        measurement, stringFormatMany("_{}threads", thread_count), trace_name,
+        thread_count * OperationsPerThread / total_time_milliseconds,
+        "ops/ms", true);
+  }
+}
+
+} // namespace
+
+TEST(ConcurrentHashMapPerfTest, ReadHeavy) {
+  runMapBenchmark<LockedHashMap>("read_heavy", "locked_hash_map", 20);
+  runMapBenchmark<ConcurrentHashMap<int, int>>("read_heavy", "concurrent_hash_map", 20);
+}
+
+TEST(ConcurrentHashMapPerfTest, WriteHeavy) {
+  runMapBenchmark<LockedHashMap>("write_heavy", "locked_hash_map", 2);
+  runMapBenchmark<ConcurrentHashMap<int, int>>("write_heavy", "concurrent_hash_map", 2);
+}
+
+} // namespace stp
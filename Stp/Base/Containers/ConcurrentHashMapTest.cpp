@@ -0,0 +1,123 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Containers/ConcurrentHashMap.h"
+
+#include "Base/Containers/List.h"
+#include "Base/Memory/OwnPtr.h"
+#include "Base/Test/GTest.h"
+#include "Base/Thread/Thread.h"
+
+namespace stp {
+
+TEST(ConcurrentHashMapTest, Basic) {
+  ConcurrentHashMap<int, int> map(4);
+  EXPECT_EQ(4, map.getShardCount());
+  EXPECT_TRUE(map.isEmpty());
+
+  EXPECT_TRUE(map.tryAdd(1, 2));
+  EXPECT_TRUE(map.tryAdd(2, 3));
+  EXPECT_FALSE(map.tryAdd(1, 0));
+  EXPECT_EQ(2, map.size());
+
+  int value = 0;
+  EXPECT_TRUE(map.tryGet(1, &value));
+  EXPECT_EQ(2, value);
+  EXPECT_FALSE(map.tryGet(3, &value));
+  EXPECT_TRUE(map.containsKey(2));
+
+  map.set(2, 7);
+  EXPECT_TRUE(map.tryGet(2, &value));
+  EXPECT_EQ(7, value);
+
+  EXPECT_TRUE(map.tryRemove(1));
+  EXPECT_FALSE(map.tryRemove(1));
+  EXPECT_FALSE(map.containsKey(1));
+
+  map.clear();
+  EXPECT_TRUE(map.isEmpty());
+}
+
+TEST(ConcurrentHashMapTest, Compute) {
+  ConcurrentHashMap<int, int> map;
+  auto increment = [](const int* old) { return old ? *old + 1 : 1; };
+
+  EXPECT_EQ(1, map.compute(5, increment));
+  EXPECT_EQ(2, map.compute(5, increment));
+
+  EXPECT_EQ(2, map.getOrAdd(5, [] { return 100; }));
+  EXPECT_EQ(100, map.getOrAdd(6, [] { return 100; }));
+}
+
+TEST(ConcurrentHashMapTest, ForEach) {
+  ConcurrentHashMap<int, int> map;
+  for (int i = 0; i < 100; ++i)
+    map.tryAdd(i, i * 2);
+
+  int count = 0;
+  int sum = 0;
+  map.forEach([&](int key, int value) {
+    EXPECT_EQ(key * 2, value);
+    ++count;
+    sum += key;
+  });
+  EXPECT_EQ(100, count);
+  EXPECT_EQ(4950, sum);
+}
+
+namespace {
+
+const int KeysPerThread = 10000;
+
+class ConcurrentHashMapTestThread : public Thread {
+ public:
+  ConcurrentHashMapTestThread(ConcurrentHashMap<int, int>* map, int index)
+      : map_(*map), index_(index) {}
+
+  int Main() override {
+    int failures = 0;
+    int base = index_ * KeysPerThread;
+    for (int i = 0; i < KeysPerThread; ++i) {
+      if (!map_.tryAdd(base + i, i))
+        ++failures;
+      // Shared counter updated by all threads.
+      map_.compute(-1, [](const int* old) { return old ? *old + 1 : 1; });
+    }
+    for (int i = 0; i < KeysPerThread; i += 2) {
+      if (!map_.tryRemove(base + i))
+        ++failures;
+    }
+    return failures;
+  }
+
+ private:
+  ConcurrentHashMap<int, int>& map_;
+  int index_;
+};
+
+} // namespace
+
+// Shards are resized concurrently while other threads insert.
+TEST(ConcurrentHashMapTest, ManyThreads) {
+  const int ThreadCount = 8;
+  ConcurrentHashMap<int, int> map(4);
+
+  List<OwnPtr<ConcurrentHashMapTestThread>> threads;
+  for (int i = 0; i < ThreadCount; ++i)
+    threads.add(OwnPtr<ConcurrentHashMapTestThread>::create(&map, i));
+  for (auto& thread : threads)
+    thread->Start();
+  for (auto& thread : threads)
+    EXPECT_EQ(0, thread->Join());
+
+  EXPECT_EQ(ThreadCount * KeysPerThread / 2 + 1, map.size());
+
+  int counter = 0;
+  EXPECT_TRUE(map.tryGet(-1, &counter));
+  EXPECT_EQ(ThreadCount * KeysPerThread, counter);
+
+  for (int i = 0; i < ThreadCount * KeysPerThread; ++i)
+    EXPECT_EQ(i % 2 != 0, map.containsKey(i));
+}
+
+} // namespace stp
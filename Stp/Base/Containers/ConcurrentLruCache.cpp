@@ -0,0 +1,88 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Containers/ConcurrentLruCache.h"
+
+#include "Base/Memory/Allocate.h"
+
+namespace stp {
+namespace detail {
+
+// Each row of Count-Min sketch uses different odd multiplier.
+static const uint32_t SketchSeeds[4] = {
+  0x97CB3127u, 0xB492B66Fu, 0x9AE16A3Bu, 0xCBF29CE5u,
+};
+
+static const int MaxCounterValue = 15;
+
+static inline uint32_t indexHash(HashCode hash, uint32_t seed) {
+  // Adding the seed first keeps zero hash away from the same counter in every row.
+  uint32_t h = (toUnderlying(hash) + seed) * seed;
+  return h ^ (h >> 17);
+}
+
+FrequencySketch::~FrequencySketch() {
+  if (table_)
+    freeMemory(table_);
+}
+
+void FrequencySketch::init(int max_entries) {
+  ASSERT(max_entries >= 0);
+  ASSERT(!table_);
+  // One word (eight counters) per expected entry keeps error rate low.
+  int word_count = roundUpToPowerOfTwo(max(max_entries, 8));
+  table_ = static_cast<subtle::Atomic32*>(allocateMemory(word_count * isizeof(subtle::Atomic32)));
+  for (int i = 0; i < word_count; ++i)
+    table_[i] = 0;
+  table_mask_ = static_cast<unsigned>(word_count - 1);
+  sample_size_ = 10 * max(max_entries, 8);
+}
+
+void FrequencySketch::increment(HashCode hash) {
+  bool incremented = false;
+  for (uint32_t seed : SketchSeeds) {
+    uint32_t h = indexHash(hash, seed);
+    subtle::Atomic32* word = &table_[(h >> 3) & table_mask_];
+    int shift = (h & 7) << 2;
+
+    uint32_t value = static_cast<uint32_t>(subtle::NoBarrier_Load(word));
+    if (((value >> shift) & MaxCounterValue) != MaxCounterValue) {
+      subtle::NoBarrier_Store(word, static_cast<subtle::Atomic32>(value + (1u << shift)));
+      incremented = true;
+    }
+  }
+  if (!incremented)
+    return;
+
+  subtle::Atomic32 additions = subtle::NoBarrier_AtomicIncrement(&additions_, 1);
+  if (additions >= sample_size_) {
+    // Only one thread wins the right to age the sketch.
+    if (subtle::NoBarrier_CompareAndSwap(&additions_, additions, 0) == additions)
+      age();
+  }
+}
+
+int FrequencySketch::frequency(HashCode hash) const {
+  int result = MaxCounterValue;
+  for (uint32_t seed : SketchSeeds) {
+    uint32_t h = indexHash(hash, seed);
+    const subtle::Atomic32* word = &table_[(h >> 3) & table_mask_];
+    int shift = (h & 7) << 2;
+
+    uint32_t value = static_cast<uint32_t>(subtle::NoBarrier_Load(word));
+    result = min(result, static_cast<int>((value >> shift) & MaxCounterValue));
+  }
+  return result;
+}
+
+void FrequencySketch::age() {
+  for (unsigned i = 0; i <= table_mask_; ++i) {
+    uint32_t value = static_cast<uint32_t>(subtle::NoBarrier_Load(&table_[i]));
+    // Halve all eight counters at once.
+    value = (value >> 1) & 0x77777777u;
+    subtle::NoBarrier_Store(&table_[i], static_cast<subtle::Atomic32>(value));
+  }
+}
+
+} // namespace detail
+} // namespace stp
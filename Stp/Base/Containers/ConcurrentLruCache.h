@@ -0,0 +1,359 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#ifndef STP_BASE_CONTAINERS_CONCURRENTLRUCACHE_H_
+#define STP_BASE_CONTAINERS_CONCURRENTLRUCACHE_H_
+
+#include "Base/Containers/HashMap.h"
+#include "Base/Containers/List.h"
+#include "Base/Math/PowerOfTwo.h"
+#include "Base/System/CpuInfo.h"
+#include "Base/Thread/AtomicOps.h"
+#include "Base/Thread/ReadWriteLock.h"
+#include "Base/Util/Function.h"
+
+namespace stp {
+
+namespace detail {
+
+// Approximates access frequency of keys with Count-Min sketch
+// of 4-bit counters. Counters are halved periodically, so the estimate
+// reflects recent history (TinyLFU).
+class BASE_EXPORT FrequencySketch {
+ public:
+  FrequencySketch() {}
+  ~FrequencySketch();
+
+  // Must be called once, before any other function.
+  // Resizing would discard the history, so size it for a full cache.
+  void init(int max_entries);
+
+  // May be called concurrently with other increments.
+  // Lost updates are possible and tolerated.
+  void increment(HashCode hash);
+
+  int frequency(HashCode hash) const;
+
+ private:
+  // Every word holds eight 4-bit counters.
+  subtle::Atomic32* table_ = nullptr;
+  unsigned table_mask_ = 0;
+  subtle::Atomic32 additions_ = 0;
+  int sample_size_ = 0;
+
+  void age();
+
+  DISALLOW_COPY_AND_ASSIGN(FrequencySketch);
+};
+
+} // namespace detail
+
+enum class CacheAdmissionPolicy {
+  // Every new entry is admitted.
+  Always,
+  // New entry is admitted only if it was accessed more frequently than
+  // the entry it would replace. Protects the cache from one-hit wonders
+  // polluting it during scans.
+  TinyLfu,
+};
+
+// Thread-safe cache with capacity expressed in bytes.
+//
+// Entries are distributed over shards, each guarded by its own lock.
+// Each entry is charged with weight given by the user when it is set.
+// When a shard goes over its budget, entries are evicted with CLOCK policy:
+// a hit only sets a reference bit (under shared lock), no list is touched.
+// The clock hand gives referenced entries a second chance.
+//
+// Since another thread may evict an entry at any time, tryGet() copies the
+// value out. Use small values or pointers with shared ownership.
+template<typename K, typename T>
+class ConcurrentLruCache {
+ public:
+  // Called for every entry evicted to make space for others.
+  // Invoked after the shard lock is released, possibly from many threads
+  // at once.
+  typedef Function<void(const K& key, T& value)> EvictionCallback;
+
+  // |capacity_bytes| is split evenly between shards.
+  // Zero |shard_count| selects a count based on number of cores.
+  explicit ConcurrentLruCache(int64_t capacity_bytes, int shard_count = 0);
+  ~ConcurrentLruCache();
+
+  // These must be set before the cache is shared with other threads.
+  void setEvictionCallback(EvictionCallback callback) { eviction_callback_ = move(callback); }
+  void setAdmissionPolicy(CacheAdmissionPolicy policy) { admission_policy_ = policy; }
+
+  template<typename U>
+  bool tryGet(const U& key, T* out_value);
+
+  // Inserts or replaces the value for |key| charging |weight| bytes.
+  // Returns false if the entry was not admitted to the cache.
+  bool set(K key, T value, int64_t weight);
+
+  bool tryRemove(const K& key);
+
+  void clear();
+
+  // These may be outdated when other threads modify the cache.
+  int size() const;
+  int64_t getUsedBytes() const;
+
+  int64_t getCapacityBytes() const { return shard_capacity_ * (shard_mask_ + 1); }
+  int getShardCount() const { return shard_mask_ + 1; }
+
+ private:
+  struct Entry {
+    Entry(K key, T value, int64_t weight, HashCode hash)
+        : key(move(key)), value(move(value)), weight(weight), hash(hash) {}
+
+    K key;
+    T value;
+    int64_t weight;
+    HashCode hash;
+    // Index of entry in the clock ring.
+    int position = 0;
+    subtle::Atomic32 referenced = 0;
+  };
+
+  struct ALIGNAS(64) Shard {
+    Shard() { index.setUseBinaryBucketSizes(); }
+
+    mutable ReadWriteLock lock;
+    HashMap<K, Entry*> index;
+    List<Entry*> ring;
+    int clock_hand = 0;
+    int64_t used_bytes = 0;
+    detail::FrequencySketch sketch;
+  };
+
+  // Weights are arbitrary, assume entries are not smaller than this
+  // to estimate how many of them fit in a shard.
+  static constexpr int64_t ExpectedMinWeight = 16;
+  static constexpr int64_t MinSketchEntries = 64;
+  static constexpr int64_t MaxSketchEntries = 1 << 14;
+
+  Shard* shards_;
+  unsigned shard_mask_;
+  int shard_shift_;
+  int64_t shard_capacity_;
+  EvictionCallback eviction_callback_;
+  CacheAdmissionPolicy admission_policy_ = CacheAdmissionPolicy::TinyLfu;
+
+  template<typename U>
+  static HashCode hashKey(const U& key) { return finalizeHash(partialHash(key)); }
+
+  Shard& getShard(HashCode hash) const {
+    uint32_t index = (toUnderlying(hash) * 0x9E3779B9u) >> shard_shift_;
+    return shards_[index & shard_mask_];
+  }
+
+  static Entry* selectVictim(Shard& shard);
+  static void unlinkEntry(Shard& shard, Entry* entry);
+  void releaseEvicted(List<Entry*>& evicted);
+
+  DISALLOW_COPY_AND_ASSIGN(ConcurrentLruCache);
+};
+
+template<typename K, typename T>
+inline ConcurrentLruCache<K, T>::ConcurrentLruCache(int64_t capacity_bytes, int shard_count) {
+  ASSERT(capacity_bytes > 0);
+  ASSERT(shard_count >= 0);
+  if (shard_count == 0)
+    shard_count = min(CpuInfo::NumberOfCores() * 4, 64);
+  shard_count = roundUpToPowerOfTwo(shard_count);
+
+  shards_ = new Shard[shard_count];
+  shard_mask_ = static_cast<unsigned>(shard_count - 1);
+  shard_shift_ = 32 - max(log2Floor(shard_count), 1);
+  shard_capacity_ = max(capacity_bytes / shard_count, static_cast<int64_t>(1));
+
+  int64_t max_entries = max(shard_capacity_ / ExpectedMinWeight, MinSketchEntries);
+  max_entries = min(max_entries, MaxSketchEntries);
+  for (int i = 0; i < shard_count; ++i)
+    shards_[i].sketch.init(static_cast<int>(max_entries));
+}
+
+template<typename K, typename T>
+inline ConcurrentLruCache<K, T>::~ConcurrentLruCache() {
+  for (unsigned i = 0; i <= shard_mask_; ++i) {
+    for (Entry* entry : shards_[i].ring)
+      delete entry;
+  }
+  delete[] shards_;
+}
+
+template<typename K, typename T>
+template<typename U>
+inline bool ConcurrentLruCache<K, T>::tryGet(const U& key, T* out_value) {
+  ASSERT(out_value);
+  HashCode hash = hashKey(key);
+  Shard& shard = getShard(hash);
+  AutoReadLock guard(shard.lock);
+  // Misses are recorded as well - frequency of absent keys drives admission.
+  shard.sketch.increment(hash);
+
+  Entry* const* entry = shard.index.tryGet(key);
+  if (!entry)
+    return false;
+
+  if (subtle::NoBarrier_Load(&(*entry)->referenced) == 0)
+    subtle::NoBarrier_Store(&(*entry)->referenced, 1);
+  *out_value = (*entry)->value;
+  return true;
+}
+
+template<typename K, typename T>
+inline bool ConcurrentLruCache<K, T>::set(K key, T value, int64_t weight) {
+  ASSERT(weight >= 0);
+  if (weight > shard_capacity_) {
+    // Does not fit even alone. Do not leave the stale value behind.
+    tryRemove(key);
+    return false;
+  }
+
+  HashCode hash = hashKey(key);
+  Shard& shard = getShard(hash);
+  List<Entry*> evicted;
+  bool admitted = true;
+  {
+    AutoWriteLock guard(shard.lock);
+    shard.sketch.increment(hash);
+
+    Entry* current = nullptr;
+    Entry** existing = shard.index.tryGet(key);
+    if (existing) {
+      Entry* entry = *existing;
+      current = entry;
+      entry->value = move(value);
+      shard.used_bytes += weight - entry->weight;
+      entry->weight = weight;
+      subtle::NoBarrier_Store(&entry->referenced, 1);
+    } else if (shard.used_bytes + weight > shard_capacity_ &&
+               admission_policy_ == CacheAdmissionPolicy::TinyLfu) {
+      // Compare with the first victim only - the candidate would be
+      // likely rejected by next ones anyway.
+      Entry* victim = selectVictim(shard);
+      admitted = shard.sketch.frequency(hash) > shard.sketch.frequency(victim->hash);
+    }
+
+    if (admitted && !existing) {
+      Entry* entry = new Entry(move(key), move(value), weight, hash);
+      entry->position = shard.ring.size();
+      shard.ring.add(entry);
+      shard.index.tryAdd(entry->key, entry);
+      shard.used_bytes += weight;
+      current = entry;
+    }
+
+    while (shard.used_bytes > shard_capacity_) {
+      Entry* victim = selectVictim(shard);
+      // The entry being set fits the shard alone, evict others.
+      // The second round finds one since the first cleared reference bits.
+      while (victim == current) {
+        ++shard.clock_hand;
+        victim = selectVictim(shard);
+      }
+      unlinkEntry(shard, victim);
+      evicted.add(victim);
+    }
+  }
+  releaseEvicted(evicted);
+  return admitted;
+}
+
+template<typename K, typename T>
+inline bool ConcurrentLruCache<K, T>::tryRemove(const K& key) {
+  Shard& shard = getShard(hashKey(key));
+  Entry* entry;
+  {
+    AutoWriteLock guard(shard.lock);
+    Entry** found = shard.index.tryGet(key);
+    if (!found)
+      return false;
+    entry = *found;
+    unlinkEntry(shard, entry);
+  }
+  delete entry;
+  return true;
+}
+
+template<typename K, typename T>
+inline void ConcurrentLruCache<K, T>::clear() {
+  for (unsigned i = 0; i <= shard_mask_; ++i) {
+    Shard& shard = shards_[i];
+    List<Entry*> entries;
+    {
+      AutoWriteLock guard(shard.lock);
+      swap(entries, shard.ring);
+      shard.index.clear();
+      shard.clock_hand = 0;
+      shard.used_bytes = 0;
+    }
+    for (Entry* entry : entries)
+      delete entry;
+  }
+}
+
+template<typename K, typename T>
+inline int ConcurrentLruCache<K, T>::size() const {
+  int total = 0;
+  for (unsigned i = 0; i <= shard_mask_; ++i) {
+    AutoReadLock guard(shards_[i].lock);
+    total += shards_[i].ring.size();
+  }
+  return total;
+}
+
+template<typename K, typename T>
+inline int64_t ConcurrentLruCache<K, T>::getUsedBytes() const {
+  int64_t total = 0;
+  for (unsigned i = 0; i <= shard_mask_; ++i) {
+    AutoReadLock guard(shards_[i].lock);
+    total += shards_[i].used_bytes;
+  }
+  return total;
+}
+
+template<typename K, typename T>
+inline typename ConcurrentLruCache<K, T>::Entry*
+ConcurrentLruCache<K, T>::selectVictim(Shard& shard) {
+  ASSERT(!shard.ring.isEmpty());
+  // Terminates after at most two rounds - the first one clears all bits.
+  while (true) {
+    if (shard.clock_hand >= shard.ring.size())
+      shard.clock_hand = 0;
+    Entry* entry = shard.ring[shard.clock_hand];
+    if (subtle::NoBarrier_Load(&entry->referenced) == 0)
+      return entry;
+    subtle::NoBarrier_Store(&entry->referenced, 0);
+    ++shard.clock_hand;
+  }
+}
+
+template<typename K, typename T>
+inline void ConcurrentLruCache<K, T>::unlinkEntry(Shard& shard, Entry* entry) {
+  // Move last entry into the hole to keep the ring dense.
+  Entry* last = shard.ring.last();
+  last->position = entry->position;
+  shard.ring[entry->position] = last;
+  shard.ring.removeLast();
+
+  shard.used_bytes -= entry->weight;
+  bool removed = shard.index.tryRemove(entry->key);
+  ASSERT(removed);
+  ALLOW_UNUSED_LOCAL(removed);
+}
+
+template<typename K, typename T>
+inline void ConcurrentLruCache<K, T>::releaseEvicted(List<Entry*>& evicted) {
+  for (Entry* entry : evicted) {
+    if (eviction_callback_)
+      eviction_callback_(entry->key, entry->value);
+    delete entry;
+  }
+}
+
+} // namespace stp
+
+#endif // STP_BASE_CONTAINERS_CONCURRENTLRUCACHE_H_
@@ -0,0 +1,150 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Containers/ConcurrentLruCache.h"
+
+#include "Base/Math/Math.h"
+#include "Base/Memory/OwnPtr.h"
+#include "Base/Test/GTest.h"
+#include "Base/Test/PerfTest.h"
+#include "Base/Text/StringFormatMany.h"
+#include "Base/Thread/Thread.h"
+#include "Base/Time/TimeTicks.h"
+
+namespace stp {
+
+static const int KeyCount = 100000;
+static const int TraceLength = 1000000;
+static const int64_t CacheCapacity = 5000;
+static const int ThreadCounts[] = { 1, 2, 4, 8, 16 };
+
+namespace {
+
+// Generates keys with Zipfian distribution - typical for cache workloads.
+class ZipfianTrace {
+ public:
+  ZipfianTrace(double skew, uint32_t seed) {
+    cdf_.ensureCapacity(KeyCount);
+    double sum = 0;
+    for (int rank = 1; rank <= KeyCount; ++rank) {
+      sum += 1 / mathPow(static_cast<double>(rank), skew);
+      cdf_.add(sum);
+    }
+    for (double& x : cdf_)
+      x /= sum;
+
+    uint32_t state = seed * 2654435761u + 1;
+    keys_.ensureCapacity(TraceLength);
+    for (int i = 0; i < TraceLength; ++i) {
+      state ^= state << 13;
+      state ^= state >> 17;
+      state ^= state << 5;
+      double u = static_cast<double>(state) / 4294967296.0;
+      int rank = findRank(u);
+      // Scatter ranks so popular keys are not clustered in one shard.
+      keys_.add(static_cast<int>((rank * 2654435761u) % KeyCount));
+    }
+  }
+
+  const List<int>& keys() const { return keys_; }
+
+ private:
+  List<double> cdf_;
+  List<int> keys_;
+
+  int findRank(double u) const {
+    int lo = 0;
+    int hi = cdf_.size() - 1;
+    while (lo < hi) {
+      int mid = lo + (hi - lo) / 2;
+      if (cdf_[mid] < u)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    return lo;
+  }
+};
+
+// Read-through access: on miss the value is "loaded" and inserted.
+inline bool accessCache(ConcurrentLruCache<int, int>& cache, int key) {
+  int value;
+  if (cache.tryGet(key, &value))
+    return true;
+  cache.set(key, key, 1);
+  return false;
+}
+
+class CacheWorkerThread : public Thread {
+ public:
+  CacheWorkerThread(ConcurrentLruCache<int, int>* cache, const ZipfianTrace* trace, int offset)
+      : cache_(*cache), trace_(*trace), offset_(offset) {}
+
+  int Main() override {
+    const List<int>& keys = trace_.keys();
+    int hits = 0;
+    for (int i = 0; i < keys.size(); ++i) {
+      if (accessCache(cache_, keys[(i + offset_) % keys.size()]))
+        ++hits;
+    }
+    return hits;
+  }
+
+ private:
+  ConcurrentLruCache<int, int>& cache_;
+  const ZipfianTrace& trace_;
+  int offset_;
+};
+
+const char* getPolicyName(CacheAdmissionPolicy policy) {
+  return policy == CacheAdmissionPolicy::TinyLfu ? "tiny_lfu" : "clock";
+}
+
+} // namespace
+
+TEST(ConcurrentLruCachePerfTest, HitRatio) {
+  const int SkewPercents[] = { 70, 90, 99 };
+  for (int skew_percent : SkewPercents) {
+    ZipfianTrace trace(skew_percent / 100.0, 1);
+    for (auto policy : { CacheAdmissionPolicy::Always, CacheAdmissionPolicy::TinyLfu }) {
+      ConcurrentLruCache<int, int> cache(CacheCapacity);
+      cache.setAdmissionPolicy(policy);
+
+      int hits = 0;
+      for (int key : trace.keys()) {
+        if (accessCache(cache, key))
+          ++hits;
+      }
+      perf_test::PrintResult(
+          "hit_ratio", stringFormatMany("_skew{}", skew_percent), getPolicyName(policy),
+          100.0 * hits / TraceLength, "%", true);
+    }
+  }
+}
+
+TEST(ConcurrentLruCachePerfTest, Throughput) {
+  ZipfianTrace trace(0.99, 2);
+  for (auto policy : { CacheAdmissionPolicy::Always, CacheAdmissionPolicy::TinyLfu }) {
+    for (int thread_count : ThreadCounts) {
+      ConcurrentLruCache<int, int> cache(CacheCapacity);
+      cache.setAdmissionPolicy(policy);
+
+      List<OwnPtr<CacheWorkerThread>> threads;
+      for (int i = 0; i < thread_count; ++i)
+        threads.add(OwnPtr<CacheWorkerThread>::create(&cache, &trace, i * (TraceLength / 16)));
+
+      TimeTicks start = TimeTicks::Now();
+      for (auto& thread : threads)
+        thread->Start();
+      for (auto& thread : threads)
+        thread->Join();
+      double total_time_milliseconds = (TimeTicks::Now() - start).InMillisecondsF();
+
+      perf_test::PrintResult(
+          "throughput", stringFormatMany("_{}threads", thread_count), getPolicyName(policy),
+          thread_count * TraceLength / total_time_milliseconds, "ops/ms", true);
+    }
+  }
+}
+
+} // namespace stp
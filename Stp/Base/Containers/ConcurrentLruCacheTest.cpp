@@ -0,0 +1,180 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Containers/ConcurrentLruCache.h"
+
+#include "Base/Memory/OwnPtr.h"
+#include "Base/Test/GTest.h"
+#include "Base/Thread/Thread.h"
+
+namespace stp {
+
+TEST(ConcurrentLruCacheTest, Basic) {
+  ConcurrentLruCache<int, int> cache(100, 1);
+  EXPECT_EQ(1, cache.getShardCount());
+  EXPECT_EQ(100, cache.getCapacityBytes());
+
+  EXPECT_TRUE(cache.set(1, 10, 30));
+  EXPECT_TRUE(cache.set(2, 20, 30));
+  EXPECT_EQ(2, cache.size());
+  EXPECT_EQ(60, cache.getUsedBytes());
+
+  int value = 0;
+  EXPECT_TRUE(cache.tryGet(1, &value));
+  EXPECT_EQ(10, value);
+  EXPECT_FALSE(cache.tryGet(3, &value));
+
+  EXPECT_TRUE(cache.set(1, 11, 40));
+  EXPECT_TRUE(cache.tryGet(1, &value));
+  EXPECT_EQ(11, value);
+  EXPECT_EQ(70, cache.getUsedBytes());
+
+  EXPECT_TRUE(cache.tryRemove(2));
+  EXPECT_FALSE(cache.tryRemove(2));
+  EXPECT_EQ(40, cache.getUsedBytes());
+
+  // Larger than whole budget.
+  EXPECT_FALSE(cache.set(5, 50, 101));
+
+  // The old value must not survive rejected update.
+  EXPECT_FALSE(cache.set(1, 12, 101));
+  EXPECT_FALSE(cache.tryGet(1, &value));
+  EXPECT_EQ(0, cache.getUsedBytes());
+
+  cache.clear();
+  EXPECT_EQ(0, cache.size());
+  EXPECT_EQ(0, cache.getUsedBytes());
+}
+
+TEST(ConcurrentLruCacheTest, EvictsUnreferenced) {
+  ConcurrentLruCache<int, int> cache(3, 1);
+  cache.setAdmissionPolicy(CacheAdmissionPolicy::Always);
+
+  int evicted_key = -1;
+  int eviction_count = 0;
+  cache.setEvictionCallback([&](const int& key, int& value) {
+    evicted_key = key;
+    ++eviction_count;
+  });
+
+  cache.set(1, 1, 1);
+  cache.set(2, 2, 1);
+  cache.set(3, 3, 1);
+
+  int value;
+  // Second chance for entries 1 and 3.
+  EXPECT_TRUE(cache.tryGet(1, &value));
+  EXPECT_TRUE(cache.tryGet(3, &value));
+
+  EXPECT_TRUE(cache.set(4, 4, 1));
+  EXPECT_EQ(1, eviction_count);
+  EXPECT_EQ(2, evicted_key);
+  EXPECT_FALSE(cache.tryGet(2, &value));
+  EXPECT_TRUE(cache.tryGet(1, &value));
+  EXPECT_TRUE(cache.tryGet(4, &value));
+  EXPECT_EQ(3, cache.getUsedBytes());
+}
+
+TEST(ConcurrentLruCacheTest, AdmittedEntryIsNotEvicted) {
+  ConcurrentLruCache<int, int> cache(3, 1);
+  cache.setAdmissionPolicy(CacheAdmissionPolicy::Always);
+
+  int value;
+  for (int key = 1; key <= 3; ++key) {
+    cache.set(key, key, 1);
+    cache.tryGet(key, &value);
+  }
+
+  // Needs the whole budget, all referenced entries must go instead.
+  EXPECT_TRUE(cache.set(4, 4, 3));
+  EXPECT_TRUE(cache.tryGet(4, &value));
+  EXPECT_EQ(1, cache.size());
+  EXPECT_EQ(3, cache.getUsedBytes());
+}
+
+TEST(ConcurrentLruCacheTest, TinyLfuKeepsHistoryWhileFilling) {
+  ConcurrentLruCache<int, int> cache(1600, 1);
+
+  int value;
+  for (int i = 0; i < 10; ++i)
+    cache.tryGet(500, &value);
+
+  // Fill the cache with entries used a few times.
+  for (int key = 0; key < 100; ++key)
+    EXPECT_TRUE(cache.set(key, key, 16));
+  for (int key = 0; key < 100; ++key) {
+    for (int i = 0; i < 2; ++i)
+      cache.tryGet(key, &value);
+  }
+
+  // Frequency gathered before the cache filled up is still known.
+  EXPECT_TRUE(cache.set(500, 500, 16));
+}
+
+TEST(ConcurrentLruCacheTest, TinyLfuRejectsColdEntries) {
+  ConcurrentLruCache<int, int> cache(4, 1);
+
+  int value;
+  for (int key = 0; key < 4; ++key) {
+    EXPECT_TRUE(cache.set(key, key, 1));
+    for (int i = 0; i < 5; ++i)
+      cache.tryGet(key, &value);
+  }
+
+  // Scan over keys seen once must not flush frequently used ones.
+  for (int key = 100; key < 200; ++key)
+    cache.set(key, key, 1);
+
+  for (int key = 0; key < 4; ++key)
+    EXPECT_TRUE(cache.tryGet(key, &value));
+
+  // Key accessed frequently enough is admitted.
+  for (int i = 0; i < 10; ++i)
+    cache.tryGet(500, &value);
+  EXPECT_TRUE(cache.set(500, 500, 1));
+}
+
+namespace {
+
+class CacheTestThread : public Thread {
+ public:
+  CacheTestThread(ConcurrentLruCache<int, int>* cache, int index)
+      : cache_(*cache), index_(index) {}
+
+  int Main() override {
+    int failures = 0;
+    for (int i = 0; i < 20000; ++i) {
+      int key = (i * 7 + index_) % 1000;
+      int value;
+      if (cache_.tryGet(key, &value)) {
+        if (value != key * 2)
+          ++failures;
+      } else {
+        cache_.set(key, key * 2, 1 + key % 3);
+      }
+    }
+    return failures;
+  }
+
+ private:
+  ConcurrentLruCache<int, int>& cache_;
+  int index_;
+};
+
+} // namespace
+
+TEST(ConcurrentLruCacheTest, ManyThreads) {
+  ConcurrentLruCache<int, int> cache(512, 4);
+
+  List<OwnPtr<CacheTestThread>> threads;
+  for (int i = 0; i < 8; ++i)
+    threads.add(OwnPtr<CacheTestThread>::create(&cache, i));
+  for (auto& thread : threads)
+    thread->Start();
+  for (auto& thread : threads)
+    EXPECT_EQ(0, thread->Join());
+
+  EXPECT_LE(cache.getUsedBytes(), cache.getCapacityBytes());
+}
+
+} // namespace stp
@@ -393,9 +393,9 @@ inline void HashMap<K, T>::set(U&& key, T value) {
   HashCode hash;
   Entry* entry = findEntry(key, &hash);
   if (*entry != sentinel_) {
-    T& value = RealNode::Cast(*entry)->value;
-    value.~T();
-    new(&value) T(move(value));
+    T& existing = RealNode::Cast(*entry)->value;
+    existing.~T();
+    new(&existing) T(move(value));
   } else {
     if (willGrow(1))
       entry = findEntry(key, hash);
@@ -457,6 +457,7 @@ class HashMap<K, T>::KeysEnumerator {
     explicit Iterator(const RealNode* node) : node_(node) {}
     const K& operator*() const { return node_->key; }
     void operator++() { node_ = HashMap::findNextNode(node_); }
+    bool operator!=(const Iterator& other) const { return node_ != other.node_; }
    private:
     const RealNode* node_;
   };
@@ -484,6 +485,7 @@ class HashMap<K, T>::ValuesEnumerator {
     explicit Iterator(const RealNode* node) : node_(node) {}
     const T& operator*() const { return node_->value; }
     void operator++() { node_ = HashMap::findNextNode(node_); }
+    bool operator!=(const Iterator& other) const { return node_ != other.node_; }
    private:
     const RealNode* node_;
   };
@@ -511,6 +513,7 @@ class HashMap<K, T>::PairsEnumerator {
     explicit Iterator(const RealNode* node) : node_(node) {}
     const RealNode& operator*() const { return *node_; }
     void operator++() { node_ = HashMap::findNextNode(node_); }
+    bool operator!=(const Iterator& other) const { return node_ != other.node_; }
    private:
     const RealNode* node_;
   };
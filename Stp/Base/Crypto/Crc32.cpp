@@ -125,10 +125,21 @@ void Crc32Algorithm::update(BufferSpan input) noexcept {
   residue_ = c;
 }
 
+void Crc32Algorithm::update(BigBufferSpan input) noexcept {
+  for (BufferSpan chunk : input.chunks())
+    update(chunk);
+}
+
 Crc32Value computeCrc32(BufferSpan input) noexcept {
   Crc32Algorithm algorithm;
   algorithm.update(input);
   return algorithm.getChecksum();
 }
 
+Crc32Value computeCrc32(BigBufferSpan input) noexcept {
+  Crc32Algorithm algorithm;
+  algorithm.update(input);
+  return algorithm.getChecksum();
+}
+
 } // namespace stp
@@ -4,13 +4,14 @@
 #ifndef STP_BASE_CRYPTO_CRC32_H_
 #define STP_BASE_CRYPTO_CRC32_H_
 
-#include "Base/Containers/BufferSpan.h"
+#include "Base/Containers/BigBufferSpan.h"
 
 namespace stp {
 
 enum class Crc32Value : uint32_t {};
 
 BASE_EXPORT Crc32Value computeCrc32(BufferSpan input) noexcept;
+BASE_EXPORT Crc32Value computeCrc32(BigBufferSpan input) noexcept;
 
 BASE_EXPORT bool tryParse(StringSpan s, Crc32Value& out_checksum) noexcept;
 
@@ -24,6 +25,7 @@ class Crc32Algorithm {
 
   void reset() { residue_ = InitialResidue; }
   BASE_EXPORT void update(BufferSpan input) noexcept;
+  BASE_EXPORT void update(BigBufferSpan input) noexcept;
   Crc32Value getChecksum() const { return static_cast<Crc32Value>(~residue_); }
 
  private:
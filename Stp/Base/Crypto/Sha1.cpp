@@ -96,6 +96,11 @@ void Sha1Hasher::update(BufferSpan buffer) noexcept {
   }
 }
 
+void Sha1Hasher::update(BigBufferSpan buffer) noexcept {
+  for (BufferSpan chunk : buffer.chunks())
+    update(chunk);
+}
+
 void Sha1Hasher::pad() noexcept {
   m_[cursor_++] = 0x80;
 
@@ -194,4 +199,12 @@ Sha1Digest computeSha1Digest(BufferSpan input) noexcept {
   return digest;
 }
 
+Sha1Digest computeSha1Digest(BigBufferSpan input) noexcept {
+  Sha1Digest digest(Sha1Digest::NoInit);
+  Sha1Hasher hasher;
+  hasher.update(input);
+  hasher.finish(digest);
+  return digest;
+}
+
 } // namespace stp
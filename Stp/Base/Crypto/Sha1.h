@@ -4,6 +4,7 @@
 #ifndef STP_BASE_CRYPTO_SHA1_H_
 #define STP_BASE_CRYPTO_SHA1_H_
 
+#include "Base/Containers/BigBufferSpan.h"
 #include "Base/Containers/Span.h"
 
 namespace stp {
@@ -41,6 +42,7 @@ class Sha1Digest {
 };
 
 BASE_EXPORT Sha1Digest computeSha1Digest(BufferSpan input) noexcept;
+BASE_EXPORT Sha1Digest computeSha1Digest(BigBufferSpan input) noexcept;
 BASE_EXPORT bool tryParse(StringSpan s, Sha1Digest& out_digest) noexcept;
 
 BASE_EXPORT void format(TextWriter& out, const Sha1Digest& digest, const StringSpan& opts);
@@ -52,6 +54,7 @@ class Sha1Hasher {
 
   BASE_EXPORT void reset() noexcept;
   BASE_EXPORT void update(BufferSpan input) noexcept;
+  BASE_EXPORT void update(BigBufferSpan input) noexcept;
   BASE_EXPORT void finish(Sha1Digest& out_digest) noexcept;
 
  private:
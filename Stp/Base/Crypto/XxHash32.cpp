@@ -0,0 +1,112 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Crypto/XxHash32.h"
+
+#include "Base/Math/Bits.h"
+
+#include <string.h>
+
+namespace stp {
+
+static constexpr uint32_t Prime1 = 2654435761u;
+static constexpr uint32_t Prime2 = 2246822519u;
+static constexpr uint32_t Prime3 = 3266489917u;
+static constexpr uint32_t Prime4 = 668265263u;
+static constexpr uint32_t Prime5 = 374761393u;
+
+static inline uint32_t load32(const byte_t* p) {
+  uint32_t x;
+  ::memcpy(&x, p, sizeof(x));
+  return x;
+}
+
+static inline uint32_t mixLane(uint32_t lane, uint32_t input) {
+  lane += input * Prime2;
+  lane = rotateBitsLeft(lane, 13);
+  return lane * Prime1;
+}
+
+void XxHash32Algorithm::reset(uint32_t seed) {
+  seed_ = seed;
+  lanes_[0] = seed + Prime1 + Prime2;
+  lanes_[1] = seed + Prime2;
+  lanes_[2] = seed;
+  lanes_[3] = seed - Prime1;
+  total_size_ = 0;
+  buffer_size_ = 0;
+}
+
+void XxHash32Algorithm::update(BufferSpan input) noexcept {
+  auto* p = static_cast<const byte_t*>(input.data());
+  int size = input.size();
+  total_size_ += static_cast<uint64_t>(size);
+
+  if (buffer_size_ > 0) {
+    int count = min(size, StripeSize - buffer_size_);
+    ::memcpy(buffer_ + buffer_size_, p, toUnsigned(count));
+    buffer_size_ += count;
+    p += count;
+    size -= count;
+    if (buffer_size_ < StripeSize)
+      return;
+    for (int i = 0; i < 4; ++i)
+      lanes_[i] = mixLane(lanes_[i], load32(buffer_ + 4 * i));
+    buffer_size_ = 0;
+  }
+
+  uint32_t v0 = lanes_[0];
+  uint32_t v1 = lanes_[1];
+  uint32_t v2 = lanes_[2];
+  uint32_t v3 = lanes_[3];
+  for (; size >= StripeSize; p += StripeSize, size -= StripeSize) {
+    v0 = mixLane(v0, load32(p));
+    v1 = mixLane(v1, load32(p + 4));
+    v2 = mixLane(v2, load32(p + 8));
+    v3 = mixLane(v3, load32(p + 12));
+  }
+  lanes_[0] = v0;
+  lanes_[1] = v1;
+  lanes_[2] = v2;
+  lanes_[3] = v3;
+
+  ::memcpy(buffer_, p, toUnsigned(size));
+  buffer_size_ = size;
+}
+
+uint32_t XxHash32Algorithm::getChecksum() const noexcept {
+  uint32_t h;
+  if (total_size_ >= StripeSize) {
+    h = rotateBitsLeft(lanes_[0], 1) + rotateBitsLeft(lanes_[1], 7) +
+        rotateBitsLeft(lanes_[2], 12) + rotateBitsLeft(lanes_[3], 18);
+  } else {
+    h = seed_ + Prime5;
+  }
+  h += static_cast<uint32_t>(total_size_);
+
+  const byte_t* p = buffer_;
+  const byte_t* end = buffer_ + buffer_size_;
+  for (; p + 4 <= end; p += 4) {
+    h += load32(p) * Prime3;
+    h = rotateBitsLeft(h, 17) * Prime4;
+  }
+  for (; p < end; ++p) {
+    h += *p * Prime5;
+    h = rotateBitsLeft(h, 11) * Prime1;
+  }
+
+  h ^= h >> 15;
+  h *= Prime2;
+  h ^= h >> 13;
+  h *= Prime3;
+  h ^= h >> 16;
+  return h;
+}
+
+uint32_t computeXxHash32(BufferSpan input, uint32_t seed) noexcept {
+  XxHash32Algorithm algorithm(seed);
+  algorithm.update(input);
+  return algorithm.getChecksum();
+}
+
+} // namespace stp
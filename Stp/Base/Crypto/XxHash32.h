@@ -0,0 +1,36 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#ifndef STP_BASE_CRYPTO_XXHASH32_H_
+#define STP_BASE_CRYPTO_XXHASH32_H_
+
+#include "Base/Containers/BufferSpan.h"
+
+namespace stp {
+
+// xxHash (32-bit variant) - fast non-cryptographic checksum.
+// Used by LZ4 frame format.
+BASE_EXPORT uint32_t computeXxHash32(BufferSpan input, uint32_t seed = 0) noexcept;
+
+class BASE_EXPORT XxHash32Algorithm {
+ public:
+  explicit XxHash32Algorithm(uint32_t seed = 0) { reset(seed); }
+
+  void reset(uint32_t seed = 0);
+  void update(BufferSpan input) noexcept;
+  uint32_t getChecksum() const noexcept;
+
+ private:
+  static constexpr int StripeSize = 16;
+
+  uint32_t lanes_[4];
+  uint32_t seed_;
+  uint64_t total_size_;
+  // Bytes of incomplete stripe.
+  byte_t buffer_[StripeSize];
+  int buffer_size_;
+};
+
+} // namespace stp
+
+#endif // STP_BASE_CRYPTO_XXHASH32_H_
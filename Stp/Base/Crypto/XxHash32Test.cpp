@@ -0,0 +1,38 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Crypto/XxHash32.h"
+
+#include "Base/Test/GTest.h"
+
+namespace stp {
+
+TEST(XxHash32Test, Basic) {
+  struct {
+    BufferSpan bytes;
+    uint32_t output;
+  } cases[] = {
+    {BufferSpan(""), UINT32_C(0x02CC5D05)},
+    {BufferSpan("a"), UINT32_C(0x550D7456)},
+    {BufferSpan("abc"), UINT32_C(0x32D153FF)},
+  };
+
+  for (const auto& item : cases) {
+    EXPECT_EQ(item.output, computeXxHash32(item.bytes));
+  }
+}
+
+TEST(XxHash32Test, Incremental) {
+  const char Text[] = "The quick brown fox jumps over the lazy dog, twice or more.";
+  BufferSpan input(Text, sizeof(Text) - 1);
+  uint32_t expected = computeXxHash32(input, 7);
+
+  for (int split = 0; split <= input.size(); ++split) {
+    XxHash32Algorithm algorithm(7);
+    algorithm.update(input.slice(0, split));
+    algorithm.update(input.slice(split));
+    EXPECT_EQ(expected, algorithm.getChecksum());
+  }
+}
+
+} // namespace stp
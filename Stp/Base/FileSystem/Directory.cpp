@@ -5,10 +5,13 @@
 
 #include "Base/Containers/InlineList.h"
 #include "Base/FileSystem/File.h"
-#include "Base/FileSystem/FileInfo.h"
 #include "Base/FileSystem/FileSystemException.h"
 #include "Base/FileSystem/RecursiveDirectoryEnumerator.h"
 
+#if OS(POSIX)
+#include "Base/FileSystem/ParallelDirectoryWalker.h"
+#endif
+
 namespace stp {
 
 void Directory::create(const FilePath& path) {
@@ -95,24 +98,17 @@ void Directory::removeRecursively(const FilePath& path) {
 }
 
 uint64_t Directory::computeSize(const FilePath& path) {
-  uint64_t result = 0;
-
   #if OS(POSIX)
-  FileInfo file_info;
-  #endif
-
+  return ParallelDirectoryWalker::computeSize(path);
+  #elif OS(WIN)
+  uint64_t result = 0;
   RecursiveDirectoryEnumerator enumerator;
   enumerator.open(path);
-  while (enumerator.moveNext()) {
-    #if OS(WIN)
+  while (enumerator.moveNext())
     result += enumerator.getSize();
-    #elif OS(POSIX)
-    File::getInfo(enumerator.getEntryFullPath(), file_info);
-    result += file_info.getSize();
-    #endif
-  }
   enumerator.close();
   return result;
+  #endif
 }
 
 Directory::DriveSpaceInfo Directory::getDriveSpaceInfo(const FilePath& path) {
@@ -0,0 +1,142 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#ifndef STP_BASE_FS_DIRECTORYWATCHER_H_
+#define STP_BASE_FS_DIRECTORYWATCHER_H_
+
+#include "Base/Containers/HashMap.h"
+#include "Base/Containers/List.h"
+#include "Base/FileSystem/FilePath.h"
+#include "Base/Time/TimeDelta.h"
+#include "Base/Util/Flags.h"
+#include "Base/Util/Function.h"
+
+struct inotify_event;
+
+namespace stp {
+
+enum class FileChange : unsigned {
+  Created = 1u << 0,
+  Removed = 1u << 1,
+  // Content was written.
+  Modified = 1u << 2,
+  // Permissions, owner, timestamps, etc.
+  Attributes = 1u << 3,
+  // Renamed within or out of watched tree.
+  MovedFrom = 1u << 4,
+  // Renamed within or into watched tree.
+  MovedTo = 1u << 5,
+  // The kernel dropped some events. The state of the watched tree is unknown
+  // and should be scanned again. Reported for the root path.
+  Overflow = 1u << 6,
+};
+
+template<> struct TIsFlagsEnumTmpl<FileChange> : TTrue {};
+typedef Flags<FileChange> FileChanges;
+
+// Watches a directory for changes (Linux and Android only).
+//
+// Built on inotify. Changes to entries of the directory are reported,
+// optionally for the whole tree below it. Subdirectories created in
+// recursive mode are watched automatically, and their content (which may
+// have been created before the watch was added) is reported as created.
+//
+// Events are coalesced: after the first event is read the watcher waits for
+// Options::coalescing_delay collecting more, and changes to the same path are
+// merged into one Change. A burst of writes to a file is delivered as
+// a single Modified change.
+//
+// The watcher does not own a thread. Either call waitAndDispatch() in a loop
+// on a dedicated thread, or poll getNativeHandle() for readability in an
+// existing event loop and call dispatch() when it becomes readable:
+//
+//   DirectoryWatcher watcher;
+//   watcher.open(path, [](Span<DirectoryWatcher::Change> changes) { ... });
+//   while (running)
+//     watcher.waitAndDispatch(TimeDelta::FromSeconds(1));
+class BASE_EXPORT DirectoryWatcher {
+ public:
+  struct Change {
+    FilePath path;
+    FileChanges changes;
+    bool is_directory;
+  };
+
+  // Changes are ordered by first occurrence.
+  typedef Function<void(Span<Change> changes)> Callback;
+
+  struct Options {
+    Options() : recursive(false), coalescing_delay(TimeDelta::FromMilliseconds(10)) {}
+
+    // Watches all subdirectories too.
+    bool recursive;
+
+    // How long to wait for more events before callback is invoked.
+    // Zero delivers events as soon as they are read.
+    TimeDelta coalescing_delay;
+  };
+
+  DirectoryWatcher();
+  ~DirectoryWatcher();
+
+  // Throws FileSystemException if |path| is not a directory or cannot be
+  // watched. In recursive mode, subdirectories which cannot be watched
+  // (removed meanwhile, out of inotify watches) are skipped.
+  void open(const FilePath& path, Callback callback, const Options& options = Options());
+  void close();
+
+  bool isOpen() const { return fd_ >= 0; }
+
+  const FilePath& getPath() const { return root_path_; }
+
+  // Returns descriptor which becomes readable when changes are pending.
+  // Meant for poll()/epoll() in event loops.
+  int getNativeHandle() const { return fd_; }
+
+  // Reads pending events without blocking (besides coalescing delay)
+  // and invokes callback if there are any.
+  // Returns the number of changes delivered.
+  int dispatch();
+
+  // Waits up to |timeout| for first event and dispatches.
+  // Negative |timeout| waits infinitely.
+  int waitAndDispatch(TimeDelta timeout);
+
+  // Returns the number of inotify watches in use (one per directory).
+  int getWatchCount() const { return watches_.size(); }
+
+ private:
+  struct Watch {
+    FilePath path;
+    // Watch of parent directory, -1 for the root.
+    int parent_wd;
+  };
+
+  int fd_ = -1;
+  FilePath root_path_;
+  Callback callback_;
+  Options options_;
+
+  HashMap<int, Watch> watches_;
+  List<byte_t> buffer_;
+
+  List<Change> changes_;
+  // Index of pending change for given path.
+  HashMap<FilePath, int> change_indices_;
+
+  int addWatch(const FilePath& path, int parent_wd);
+  void addWatchesBelow(const FilePath& path, int wd, bool report_created);
+  void removeWatchesBelow(int wd);
+  bool isBelow(int wd, int ancestor_wd) const;
+  bool waitReadable(TimeDelta timeout);
+  bool readEvents();
+  void handleEvent(const ::inotify_event& event);
+  void addChange(FilePath path, FileChanges changes, bool is_directory);
+  int deliverChanges();
+
+  DISALLOW_COPY_AND_ASSIGN(DirectoryWatcher);
+};
+
+} // namespace stp
+
+#endif // STP_BASE_FS_DIRECTORYWATCHER_H_
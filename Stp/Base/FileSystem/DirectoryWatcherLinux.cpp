@@ -0,0 +1,298 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/FileSystem/DirectoryWatcher.h"
+
+#include "Base/FileSystem/FileSystemException.h"
+#include "Base/FileSystem/ParallelDirectoryWalker.h"
+#include "Base/Posix/EintrWrapper.h"
+#include "Base/Time/TimeTicks.h"
+#include "Base/Type/Limits.h"
+
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace stp {
+
+static constexpr uint32_t WatchMask =
+    IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO |
+    IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR | IN_EXCL_UNLINK;
+
+// Holds a few thousand events with short names, so a burst is drained
+// with a handful of read() calls.
+static constexpr int ReadBufferSize = 64 << 10;
+
+DirectoryWatcher::DirectoryWatcher() {}
+
+DirectoryWatcher::~DirectoryWatcher() {
+  if (isOpen())
+    close();
+}
+
+void DirectoryWatcher::open(const FilePath& path, Callback callback, const Options& options) {
+  ASSERT(!isOpen());
+  fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (fd_ < 0)
+    throw FileSystemException(getLastPosixErrorCode(), path);
+
+  root_path_ = path;
+  callback_ = move(callback);
+  options_ = options;
+
+  int wd = addWatch(path, -1);
+  if (wd < 0) {
+    auto error_code = getLastPosixErrorCode();
+    close();
+    throw FileSystemException(error_code, path);
+  }
+  if (options_.recursive)
+    addWatchesBelow(path, wd, false);
+}
+
+void DirectoryWatcher::close() {
+  ASSERT(isOpen());
+  // Closing the descriptor releases all watches at once.
+  IGNORE_EINTR(::close(fd_));
+  fd_ = -1;
+  watches_.clear();
+  changes_.clear();
+  change_indices_.clear();
+}
+
+int DirectoryWatcher::dispatch() {
+  ASSERT(isOpen());
+  if (!readEvents())
+    return 0;
+
+  if (options_.coalescing_delay > TimeDelta()) {
+    // The delay is counted from the first event, so a steady stream of events
+    // does not hold back the delivery forever.
+    TimeTicks deadline = TimeTicks::Now() + options_.coalescing_delay;
+    while (true) {
+      TimeDelta remaining = deadline - TimeTicks::Now();
+      if (remaining <= TimeDelta() || !waitReadable(remaining))
+        break;
+      readEvents();
+    }
+  }
+  return deliverChanges();
+}
+
+int DirectoryWatcher::waitAndDispatch(TimeDelta timeout) {
+  ASSERT(isOpen());
+  if (!waitReadable(timeout))
+    return 0;
+  return dispatch();
+}
+
+bool DirectoryWatcher::waitReadable(TimeDelta timeout) {
+  int timeout_ms = -1;
+  if (timeout >= TimeDelta())
+    timeout_ms = static_cast<int>(min(timeout.InMillisecondsRoundedUp(), static_cast<int64_t>(Limits<int>::Max)));
+
+  struct pollfd poll_fd = { fd_, POLLIN, 0 };
+  int rv = HANDLE_EINTR(::poll(&poll_fd, 1, timeout_ms));
+  if (rv < 0)
+    throw FileSystemException(getLastPosixErrorCode(), root_path_);
+  return rv > 0;
+}
+
+int DirectoryWatcher::addWatch(const FilePath& path, int parent_wd) {
+  uint32_t mask = WatchMask;
+  // Symbolic links to directories are not followed below the root.
+  if (parent_wd >= 0)
+    mask |= IN_DONT_FOLLOW;
+
+  int wd = ::inotify_add_watch(fd_, toNullTerminated(path), mask);
+  if (wd >= 0)
+    watches_.set(wd, Watch { path, parent_wd });
+  return wd;
+}
+
+void DirectoryWatcher::addWatchesBelow(const FilePath& path, int wd, bool report_created) {
+  class ScanVisitor : public ParallelDirectoryWalker::Visitor {
+   public:
+    ScanVisitor(DirectoryWatcher& watcher, bool report_created)
+        : watcher_(watcher), report_created_(report_created) {}
+
+    bool onEntry(const ParallelDirectoryWalker::Entry& entry) override {
+      FilePath full_path = entry.getFullPath();
+      bool descend = false;
+      if (entry.isDirectory()) {
+        // Watch is added before the directory is read, so entries created
+        // meanwhile are either seen here or reported by inotify.
+        int* parent_wd = dir_wds_.tryGet(entry.getDirPath());
+        int wd = parent_wd ? watcher_.addWatch(full_path, *parent_wd) : -1;
+        if (wd >= 0) {
+          dir_wds_.set(full_path, wd);
+          descend = true;
+        }
+      }
+      if (report_created_)
+        watcher_.addChange(move(full_path), FileChange::Created, entry.isDirectory());
+      return descend;
+    }
+
+    HashMap<FilePath, int> dir_wds_;
+
+   private:
+    DirectoryWatcher& watcher_;
+    bool report_created_;
+  };
+
+  ScanVisitor visitor(*this, report_created);
+  visitor.dir_wds_.set(path, wd);
+
+  // Single thread, the visitor is not synchronized.
+  ParallelDirectoryWalker::Options walk_options;
+  walk_options.thread_count = 1;
+  try {
+    ParallelDirectoryWalker::walk(path, visitor, walk_options);
+  } catch (FileSystemException&) {
+    // Removed before it was scanned. The removal is reported by the parent.
+  }
+}
+
+void DirectoryWatcher::removeWatchesBelow(int wd) {
+  List<int> removed_wds;
+  removed_wds.add(wd);
+  for (const auto& pair : watches_.enumerate()) {
+    if (isBelow(pair.key, wd))
+      removed_wds.add(pair.key);
+  }
+  // Events already queued for these watches are dropped since watches are
+  // forgotten here and not when IN_IGNORED arrives.
+  for (int removed_wd : removed_wds) {
+    ::inotify_rm_watch(fd_, removed_wd);
+    watches_.tryRemove(removed_wd);
+  }
+}
+
+bool DirectoryWatcher::isBelow(int wd, int ancestor_wd) const {
+  while (wd >= 0) {
+    const Watch* watch = watches_.tryGet(wd);
+    if (!watch)
+      return false;
+    if (watch->parent_wd == ancestor_wd)
+      return true;
+    wd = watch->parent_wd;
+  }
+  return false;
+}
+
+bool DirectoryWatcher::readEvents() {
+  if (buffer_.isEmpty())
+    buffer_.appendUninitialized(ReadBufferSize);
+
+  bool read_any = false;
+  while (true) {
+    ssize_t rv = HANDLE_EINTR(::read(fd_, buffer_.data(), buffer_.size()));
+    if (rv < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+        break;
+      throw FileSystemException(getLastPosixErrorCode(), root_path_);
+    }
+    if (rv == 0)
+      break;
+
+    read_any = true;
+    for (ssize_t offset = 0; offset < rv;) {
+      auto* event = reinterpret_cast<const inotify_event*>(buffer_.data() + offset);
+      offset += isizeof(inotify_event) + event->len;
+      handleEvent(*event);
+    }
+  }
+  return read_any;
+}
+
+void DirectoryWatcher::handleEvent(const inotify_event& event) {
+  if (event.mask & IN_Q_OVERFLOW) {
+    addChange(root_path_, FileChange::Overflow, true);
+    return;
+  }
+
+  const Watch* watch = watches_.tryGet(event.wd);
+  if (!watch) {
+    // Removed already, but some events were still queued.
+    return;
+  }
+  if (event.mask & IN_IGNORED) {
+    watches_.tryRemove(event.wd);
+    return;
+  }
+
+  FileChanges changes;
+  if (event.mask & IN_CREATE)
+    changes |= FileChange::Created;
+  if (event.mask & (IN_DELETE | IN_DELETE_SELF))
+    changes |= FileChange::Removed;
+  if (event.mask & IN_MODIFY)
+    changes |= FileChange::Modified;
+  if (event.mask & IN_ATTRIB)
+    changes |= FileChange::Attributes;
+  if (event.mask & (IN_MOVED_FROM | IN_MOVE_SELF))
+    changes |= FileChange::MovedFrom;
+  if (event.mask & IN_MOVED_TO)
+    changes |= FileChange::MovedTo;
+
+  if (event.len == 0) {
+    // Event for watched directory itself. Subdirectories are reported by
+    // their parents already.
+    if (watch->parent_wd < 0)
+      addChange(root_path_, changes, true);
+    return;
+  }
+
+  bool is_directory = (event.mask & IN_ISDIR) != 0;
+  int parent_wd = event.wd;
+  FilePath path = combineFilePaths(watch->path, makeFilePathSpanFromNullTerminated(event.name));
+
+  if (!options_.recursive || !is_directory) {
+    addChange(move(path), changes, is_directory);
+    return;
+  }
+
+  if (event.mask & IN_MOVED_FROM) {
+    // The watch follows the directory to its new place, possibly out of
+    // the tree. Forget it, it is added again if moved within the tree.
+    for (const auto& pair : watches_.enumerate()) {
+      if (pair.value.parent_wd == parent_wd && pair.value.path == path) {
+        removeWatchesBelow(pair.key);
+        break;
+      }
+    }
+  }
+  addChange(path, changes, true);
+
+  if (event.mask & (IN_CREATE | IN_MOVED_TO)) {
+    int wd = addWatch(path, parent_wd);
+    // Content of moved directory is reported only as the move of
+    // the directory itself.
+    if (wd >= 0)
+      addWatchesBelow(path, wd, (event.mask & IN_CREATE) != 0);
+  }
+}
+
+void DirectoryWatcher::addChange(FilePath path, FileChanges changes, bool is_directory) {
+  int* index = change_indices_.tryGet(path);
+  if (index) {
+    changes_[*index].changes |= changes;
+    return;
+  }
+  change_indices_.set(path, changes_.size());
+  changes_.add(Change { move(path), changes, is_directory });
+}
+
+int DirectoryWatcher::deliverChanges() {
+  if (changes_.isEmpty())
+    return 0;
+
+  // Callback is free to close the watcher.
+  List<Change> changes = move(changes_);
+  change_indices_.clear();
+  callback_(changes);
+  return changes.size();
+}
+
+} // namespace stp
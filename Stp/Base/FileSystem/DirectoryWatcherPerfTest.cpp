@@ -0,0 +1,173 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/FileSystem/DirectoryWatcher.h"
+
+#include "Base/FileSystem/TemporaryDirectory.h"
+#include "Base/Io/FileStream.h"
+#include "Base/Test/GTest.h"
+#include "Base/Test/PerfTest.h"
+#include "Base/Thread/AtomicOps.h"
+#include "Base/Thread/ConditionVariable.h"
+#include "Base/Thread/Lock.h"
+#include "Base/Thread/Thread.h"
+#include "Base/Time/TimeTicks.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace stp {
+
+static const int IterationCount = 200;
+
+// Interval of stat() polling the watcher is compared to.
+static const int PollIntervalMilliseconds = 1;
+
+namespace {
+
+class DirectoryWatcherPerfTest : public testing::Test {
+ protected:
+  enum class Method {
+    // Callback invoked as soon as event is read.
+    Inotify,
+    // Default coalescing delay.
+    InotifyCoalesced,
+    // stat() called in a loop until file size changes.
+    Polling,
+  };
+
+  static const char* getMethodName(Method method) {
+    switch (method) {
+      case Method::Inotify: return "inotify";
+      case Method::InotifyCoalesced: return "inotify_coalesced";
+      case Method::Polling: return "polling";
+    }
+    return nullptr;
+  }
+
+  DirectoryWatcherPerfTest() : notified_(&lock_) {}
+
+  void SetUp() override {
+    temp_dir_.create();
+    path_ = combineFilePaths(temp_dir_.path(), FilePath::fromString("file"));
+  }
+
+  class ObserverThread : public Thread {
+   public:
+    ObserverThread(DirectoryWatcherPerfTest& test, Method method)
+        : test_(test), method_(method) {}
+
+    void stop() { subtle::Release_Store(&stopped_, 1); }
+
+   protected:
+    int Main() override {
+      if (method_ == Method::Polling)
+        poll();
+      else
+        watch();
+      return 0;
+    }
+
+   private:
+    bool isStopped() const { return subtle::Acquire_Load(&stopped_) != 0; }
+
+    void watch() {
+      DirectoryWatcher::Options options;
+      if (method_ == Method::Inotify)
+        options.coalescing_delay = TimeDelta();
+
+      DirectoryWatcher watcher;
+      watcher.open(test_.temp_dir_.path(), [this](Span<DirectoryWatcher::Change> changes) {
+        test_.notify();
+      }, options);
+      test_.notify();
+      while (!isStopped())
+        watcher.waitAndDispatch(TimeDelta::FromMilliseconds(10));
+    }
+
+    void poll() {
+      test_.notify();
+      off_t last_size = 0;
+      while (!isStopped()) {
+        struct stat file_stat;
+        if (::stat(toNullTerminated(test_.path_), &file_stat) == 0 && file_stat.st_size != last_size) {
+          last_size = file_stat.st_size;
+          test_.notify();
+        }
+        ::usleep(PollIntervalMilliseconds * 1000);
+      }
+    }
+
+    DirectoryWatcherPerfTest& test_;
+    Method method_;
+    subtle::Atomic32 stopped_ = 0;
+  };
+
+  void notify() {
+    AutoLock guard(borrow(lock_));
+    notified_at_ = TimeTicks::Now();
+    ++notification_count_;
+    notified_.Signal();
+  }
+
+  TimeTicks waitForNotification(int count) {
+    AutoLock guard(borrow(lock_));
+    while (notification_count_ < count)
+      notified_.Wait();
+    return notified_at_;
+  }
+
+  void runLatency(Method method);
+
+  TemporaryDirectory temp_dir_;
+  FilePath path_;
+
+  Lock lock_;
+  ConditionVariable notified_;
+  TimeTicks notified_at_;
+  int notification_count_ = 0;
+};
+
+void DirectoryWatcherPerfTest::runLatency(Method method) {
+  notification_count_ = 0;
+  FileStream file;
+  file.create(path_);
+
+  ObserverThread observer(*this, method);
+  observer.Start();
+  // Ready to observe.
+  waitForNotification(1);
+
+  TimeDelta total_latency;
+  TimeDelta max_latency;
+  for (int i = 0; i < IterationCount; ++i) {
+    TimeTicks start = TimeTicks::Now();
+    // A single write generates a single event.
+    file.write(BufferSpan("x", 1));
+    TimeDelta latency = waitForNotification(i + 2) - start;
+    total_latency += latency;
+    if (latency > max_latency)
+      max_latency = latency;
+  }
+
+  observer.stop();
+  observer.Join();
+  file.close();
+
+  perf_test::PrintResult(
+      "write_to_notification", "_mean", getMethodName(method),
+      total_latency.InMillisecondsF() / IterationCount, "ms", true);
+  perf_test::PrintResult(
+      "write_to_notification", "_max", getMethodName(method),
+      max_latency.InMillisecondsF(), "ms", true);
+}
+
+} // namespace
+
+TEST_F(DirectoryWatcherPerfTest, Latency) {
+  runLatency(Method::Inotify);
+  runLatency(Method::InotifyCoalesced);
+  runLatency(Method::Polling);
+}
+
+} // namespace stp
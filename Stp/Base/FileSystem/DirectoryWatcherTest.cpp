@@ -0,0 +1,232 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/FileSystem/DirectoryWatcher.h"
+
+#include "Base/FileSystem/Directory.h"
+#include "Base/FileSystem/FileSystemException.h"
+#include "Base/FileSystem/TemporaryDirectory.h"
+#include "Base/Io/FileStream.h"
+#include "Base/Test/GTest.h"
+
+#include <poll.h>
+#include <stdio.h>
+#include <unistd.h>
+
+namespace stp {
+
+namespace {
+
+const int MaxWaitIterations = 50;
+
+class DirectoryWatcherTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    temp_dir_.create();
+  }
+
+  void open(bool recursive) {
+    DirectoryWatcher::Options options;
+    options.recursive = recursive;
+    watcher_.open(temp_dir_.path(), [this](Span<DirectoryWatcher::Change> changes) {
+      ++batch_count_;
+      for (const auto& change : changes) {
+        received_.add(change);
+      }
+    }, options);
+  }
+
+  FilePath makePath(StringSpan name) {
+    return combineFilePaths(temp_dir_.path(), FilePath::fromString(name));
+  }
+
+  FilePath makePath(StringSpan dir_name, StringSpan name) {
+    return combineFilePaths(temp_dir_.path(), FilePath::fromString(dir_name), FilePath::fromString(name));
+  }
+
+  static void writeFile(const FilePath& path, StringSpan text) {
+    FileStream file;
+    file.create(path);
+    file.write(BufferSpan(text.data(), text.length()));
+  }
+
+  // Returns merged changes reported for |path|. Dispatches until all of
+  // |expected| are seen or time is out.
+  FileChanges waitFor(const FilePath& path, FileChanges expected) {
+    FileChanges seen;
+    for (int i = 0; i < MaxWaitIterations; ++i) {
+      seen = getReceived(path);
+      if (seen.HaveAllOf(expected))
+        break;
+      watcher_.waitAndDispatch(TimeDelta::FromMilliseconds(100));
+    }
+    return seen;
+  }
+
+  FileChanges getReceived(const FilePath& path) const {
+    FileChanges seen;
+    for (const auto& change : received_) {
+      if (change.path == path)
+        seen |= change.changes;
+    }
+    return seen;
+  }
+
+  TemporaryDirectory temp_dir_;
+  DirectoryWatcher watcher_;
+  List<DirectoryWatcher::Change> received_;
+  int batch_count_ = 0;
+};
+
+} // namespace
+
+TEST_F(DirectoryWatcherTest, CreateModifyRemove) {
+  open(false);
+  EXPECT_EQ(1, watcher_.getWatchCount());
+
+  FilePath path = makePath("file");
+  {
+    FileStream file;
+    file.create(path);
+  }
+  EXPECT_TRUE(waitFor(path, FileChange::Created).Have(FileChange::Created));
+
+  writeFile(path, "content");
+  EXPECT_TRUE(waitFor(path, FileChange::Modified).Have(FileChange::Modified));
+
+  ASSERT_EQ(0, ::unlink(toNullTerminated(path)));
+  EXPECT_TRUE(waitFor(path, FileChange::Removed).Have(FileChange::Removed));
+
+  for (const auto& change : received_)
+    EXPECT_FALSE(change.is_directory);
+}
+
+TEST_F(DirectoryWatcherTest, Coalescing) {
+  open(false);
+
+  FilePath path = makePath("file");
+  {
+    FileStream file;
+    file.create(path);
+    for (int i = 0; i < 100; ++i)
+      file.write(BufferSpan("x", 1));
+  }
+  FileChanges seen = waitFor(path, FileChange::Created | FileChange::Modified);
+  EXPECT_TRUE(seen.HaveAllOf(FileChange::Created | FileChange::Modified));
+
+  // Hundred writes in one batch and merged into a single change.
+  EXPECT_EQ(1, batch_count_);
+  EXPECT_EQ(1, received_.size());
+}
+
+TEST_F(DirectoryWatcherTest, Rename) {
+  FilePath from_path = makePath("from");
+  FilePath to_path = makePath("to");
+  writeFile(from_path, "content");
+
+  open(false);
+  ASSERT_EQ(0, ::rename(toNullTerminated(from_path), toNullTerminated(to_path)));
+  EXPECT_TRUE(waitFor(to_path, FileChange::MovedTo).Have(FileChange::MovedTo));
+  EXPECT_TRUE(getReceived(from_path).Have(FileChange::MovedFrom));
+}
+
+TEST_F(DirectoryWatcherTest, NonRecursive) {
+  FilePath dir_path = makePath("dir");
+  Directory::create(dir_path);
+
+  open(false);
+  writeFile(makePath("dir", "nested"), "content");
+  writeFile(makePath("file"), "content");
+
+  EXPECT_TRUE(waitFor(makePath("file"), FileChange::Created).Have(FileChange::Created));
+  EXPECT_TRUE(getReceived(makePath("dir", "nested")).IsZero());
+}
+
+TEST_F(DirectoryWatcherTest, Recursive) {
+  FilePath existing_path = makePath("existing");
+  Directory::create(existing_path);
+
+  open(true);
+  EXPECT_EQ(2, watcher_.getWatchCount());
+
+  // Existing subdirectory is watched.
+  FilePath nested_path = makePath("existing", "nested");
+  writeFile(nested_path, "content");
+  EXPECT_TRUE(waitFor(nested_path, FileChange::Created).Have(FileChange::Created));
+
+  // New subdirectory is watched as soon as it is reported.
+  FilePath new_dir_path = makePath("new");
+  Directory::create(new_dir_path);
+  FileChanges seen = waitFor(new_dir_path, FileChange::Created);
+  EXPECT_TRUE(seen.Have(FileChange::Created));
+  EXPECT_EQ(3, watcher_.getWatchCount());
+
+  FilePath new_file_path = makePath("new", "file");
+  writeFile(new_file_path, "content");
+  EXPECT_TRUE(waitFor(new_file_path, FileChange::Created).Have(FileChange::Created));
+}
+
+TEST_F(DirectoryWatcherTest, RecursiveReportsContentOfNewDirectory) {
+  open(true);
+
+  // Directory is filled before the watcher gets to add a watch for it.
+  FilePath dir_path = makePath("dir");
+  Directory::create(dir_path);
+  Directory::create(makePath("dir", "subdir"));
+  writeFile(makePath("dir", "file"), "content");
+
+  EXPECT_TRUE(waitFor(makePath("dir", "file"), FileChange::Created).Have(FileChange::Created));
+  EXPECT_TRUE(getReceived(makePath("dir", "subdir")).Have(FileChange::Created));
+  EXPECT_EQ(3, watcher_.getWatchCount());
+}
+
+TEST_F(DirectoryWatcherTest, RecursiveMovedDirectory) {
+  Directory::create(makePath("from"));
+
+  open(true);
+  ASSERT_EQ(0, ::rename(toNullTerminated(makePath("from")), toNullTerminated(makePath("to"))));
+  EXPECT_TRUE(waitFor(makePath("to"), FileChange::MovedTo).Have(FileChange::MovedTo));
+
+  // Changes are reported with the new path.
+  writeFile(makePath("to", "file"), "content");
+  EXPECT_TRUE(waitFor(makePath("to", "file"), FileChange::Created).Have(FileChange::Created));
+  EXPECT_TRUE(getReceived(makePath("from", "file")).IsZero());
+  EXPECT_EQ(2, watcher_.getWatchCount());
+}
+
+TEST_F(DirectoryWatcherTest, NativeHandle) {
+  open(false);
+  writeFile(makePath("file"), "content");
+
+  struct pollfd poll_fd = { watcher_.getNativeHandle(), POLLIN, 0 };
+  ASSERT_EQ(1, ::poll(&poll_fd, 1, 5000));
+  EXPECT_LT(0, watcher_.dispatch());
+  EXPECT_TRUE(getReceived(makePath("file")).Have(FileChange::Created));
+
+  // Nothing more to dispatch.
+  EXPECT_EQ(0, watcher_.dispatch());
+}
+
+TEST_F(DirectoryWatcherTest, RootRemoved) {
+  FilePath dir_path = makePath("dir");
+  Directory::create(dir_path);
+
+  DirectoryWatcher watcher;
+  FileChanges seen;
+  watcher.open(dir_path, [&seen](Span<DirectoryWatcher::Change> changes) {
+    for (const auto& change : changes)
+      seen |= change.changes;
+  });
+  ASSERT_EQ(0, ::rmdir(toNullTerminated(dir_path)));
+  for (int i = 0; i < MaxWaitIterations && !seen.Have(FileChange::Removed); ++i)
+    watcher.waitAndDispatch(TimeDelta::FromMilliseconds(100));
+  EXPECT_TRUE(seen.Have(FileChange::Removed));
+}
+
+TEST_F(DirectoryWatcherTest, MissingPath) {
+  DirectoryWatcher watcher;
+  EXPECT_THROW(watcher.open(makePath("missing"), [](Span<DirectoryWatcher::Change>) {}), FileSystemException);
+  EXPECT_FALSE(watcher.isOpen());
+}
+
+} // namespace stp
@@ -36,6 +36,17 @@ void File::replace(const FilePath& from, const FilePath& to) {
     throw FileSystemException(error_code, from, to);
 }
 
+void File::copy(const FilePath& from, const FilePath& to) {
+  FileStream source;
+  source.open(from, FileMode::OpenExisting, FileAccess::ReadOnly);
+
+  FileStream target;
+  target.create(to, FileMode::Create, FileAccess::WriteOnly);
+  source.transferTo(target);
+  target.close();
+  source.close();
+}
+
 Buffer File::readAll(const FilePath& path) {
   FileStream file;
   file.open(path, FileMode::OpenExisting, FileAccess::ReadOnly);
@@ -76,6 +76,10 @@ class BASE_EXPORT File {
   static void replace(const FilePath& from, const FilePath& to);
   static SystemErrorCode tryReplace(const FilePath& from, const FilePath& to) WARN_UNUSED_RESULT;
 
+  // Copies contents of file |from| to |to|. Destination file is created or
+  // truncated. Data does not pass through user space where system supports it.
+  static void copy(const FilePath& from, const FilePath& to);
+
   static Buffer readAll(const FilePath& path);
   static void writeAll(const FilePath& path, BufferSpan input);
 
@@ -0,0 +1,50 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/FileSystem/FileWatcher.h"
+
+namespace stp {
+
+FileWatcher::FileWatcher() {}
+FileWatcher::~FileWatcher() {}
+
+void FileWatcher::open(const FilePath& path, Callback callback, TimeDelta coalescing_delay) {
+  ASSERT(!isOpen());
+  FilePath dir_path(path.getDirectoryName());
+  if (dir_path.isEmpty())
+    dir_path = FilePath::fromString(".");
+
+  DirectoryWatcher::Options options;
+  options.coalescing_delay = coalescing_delay;
+  watcher_.open(dir_path, [this](Span<DirectoryWatcher::Change> changes) {
+    onDirectoryChanges(changes);
+  }, options);
+
+  path_ = path;
+  callback_ = move(callback);
+}
+
+void FileWatcher::close() {
+  watcher_.close();
+  pending_changes_.clear();
+}
+
+void FileWatcher::onDirectoryChanges(Span<DirectoryWatcher::Change> changes) {
+  FilePathSpan file_name = path_.getFileName();
+  for (const auto& change : changes) {
+    // On overflow it is not known whether the file was affected, assume it was.
+    if (change.changes.Have(FileChange::Overflow) || change.path.getFileName() == file_name)
+      pending_changes_ |= change.changes;
+  }
+}
+
+int FileWatcher::dispatchChanges() {
+  if (pending_changes_.IsZero())
+    return 0;
+  FileChanges changes = pending_changes_;
+  pending_changes_.clear();
+  callback_(changes);
+  return 1;
+}
+
+} // namespace stp
@@ -0,0 +1,60 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#ifndef STP_BASE_FS_FILEWATCHER_H_
+#define STP_BASE_FS_FILEWATCHER_H_
+
+#include "Base/FileSystem/DirectoryWatcher.h"
+
+namespace stp {
+
+// Watches a single file for changes (Linux and Android only).
+//
+// The directory containing the file is watched rather than the file itself,
+// so the file does not need to exist when watching starts, and replacing it
+// with rename() (as editors and atomic writers do) is reported as MovedTo
+// instead of silently losing the watch.
+//
+// Dispatching works the same as in DirectoryWatcher.
+class BASE_EXPORT FileWatcher {
+ public:
+  typedef Function<void(FileChanges changes)> Callback;
+
+  FileWatcher();
+  ~FileWatcher();
+
+  // Throws FileSystemException if the directory containing |path|
+  // cannot be watched.
+  void open(
+      const FilePath& path, Callback callback,
+      TimeDelta coalescing_delay = DirectoryWatcher::Options().coalescing_delay);
+  void close();
+
+  bool isOpen() const { return watcher_.isOpen(); }
+
+  const FilePath& getPath() const { return path_; }
+
+  int getNativeHandle() const { return watcher_.getNativeHandle(); }
+
+  // Returns 1 if callback was invoked, 0 otherwise.
+  int dispatch() { return watcher_.dispatch() > 0 ? dispatchChanges() : 0; }
+  int waitAndDispatch(TimeDelta timeout) {
+    return watcher_.waitAndDispatch(timeout) > 0 ? dispatchChanges() : 0;
+  }
+
+ private:
+  DirectoryWatcher watcher_;
+  FilePath path_;
+  Callback callback_;
+  // Changes of the file found in last batch from |watcher_|.
+  FileChanges pending_changes_;
+
+  void onDirectoryChanges(Span<DirectoryWatcher::Change> changes);
+  int dispatchChanges();
+
+  DISALLOW_COPY_AND_ASSIGN(FileWatcher);
+};
+
+} // namespace stp
+
+#endif // STP_BASE_FS_FILEWATCHER_H_
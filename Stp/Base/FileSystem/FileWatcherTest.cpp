@@ -0,0 +1,96 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/FileSystem/FileWatcher.h"
+
+#include "Base/FileSystem/TemporaryDirectory.h"
+#include "Base/Io/FileStream.h"
+#include "Base/Test/GTest.h"
+
+#include <stdio.h>
+#include <unistd.h>
+
+namespace stp {
+
+namespace {
+
+const int MaxWaitIterations = 50;
+
+class FileWatcherTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    temp_dir_.create();
+    path_ = makePath("watched");
+    watcher_.open(path_, [this](FileChanges changes) {
+      ++callback_count_;
+      received_ |= changes;
+    });
+  }
+
+  FilePath makePath(StringSpan name) {
+    return combineFilePaths(temp_dir_.path(), FilePath::fromString(name));
+  }
+
+  static void writeFile(const FilePath& path, StringSpan text) {
+    FileStream file;
+    file.create(path);
+    file.write(BufferSpan(text.data(), text.length()));
+  }
+
+  // Dispatches until all of |expected| are received or time is out.
+  FileChanges waitFor(FileChanges expected) {
+    for (int i = 0; i < MaxWaitIterations && !received_.HaveAllOf(expected); ++i)
+      watcher_.waitAndDispatch(TimeDelta::FromMilliseconds(100));
+    FileChanges result = received_;
+    received_.clear();
+    return result;
+  }
+
+  TemporaryDirectory temp_dir_;
+  FilePath path_;
+  FileWatcher watcher_;
+  FileChanges received_;
+  int callback_count_ = 0;
+};
+
+} // namespace
+
+TEST_F(FileWatcherTest, Lifecycle) {
+  // The file does not exist yet.
+  writeFile(path_, "content");
+  EXPECT_TRUE(waitFor(FileChange::Created).Have(FileChange::Created));
+
+  writeFile(path_, "more");
+  EXPECT_TRUE(waitFor(FileChange::Modified).Have(FileChange::Modified));
+
+  ASSERT_EQ(0, ::unlink(toNullTerminated(path_)));
+  EXPECT_TRUE(waitFor(FileChange::Removed).Have(FileChange::Removed));
+}
+
+TEST_F(FileWatcherTest, AtomicReplace) {
+  writeFile(path_, "content");
+  waitFor(FileChange::Created);
+
+  FilePath temp_path = makePath("watched.tmp");
+  writeFile(temp_path, "new content");
+  ASSERT_EQ(0, ::rename(toNullTerminated(temp_path), toNullTerminated(path_)));
+  EXPECT_TRUE(waitFor(FileChange::MovedTo).Have(FileChange::MovedTo));
+
+  // Still watched after replacement.
+  writeFile(path_, "more");
+  EXPECT_TRUE(waitFor(FileChange::Modified).Have(FileChange::Modified));
+}
+
+TEST_F(FileWatcherTest, IgnoresOtherFiles) {
+  writeFile(makePath("other"), "content");
+  writeFile(path_, "content");
+  waitFor(FileChange::Created);
+  int callback_count = callback_count_;
+
+  writeFile(makePath("other"), "more");
+  EXPECT_EQ(0, watcher_.waitAndDispatch(TimeDelta::FromMilliseconds(200)));
+  EXPECT_EQ(callback_count, callback_count_);
+  EXPECT_TRUE(received_.IsZero());
+}
+
+} // namespace stp
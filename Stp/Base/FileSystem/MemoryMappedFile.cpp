@@ -5,9 +5,7 @@
 
 #include "Base/FileSystem/MemoryMappedFile.h"
 
-#include "Base/Debug/Log.h"
 #include "Base/FileSystem/FilePath.h"
-#include "Base/System/SysInfo.h"
 
 namespace stp {
 
@@ -17,88 +15,86 @@ MemoryMappedFile::MemoryMappedFile() {
 }
 
 MemoryMappedFile::~MemoryMappedFile() {
-  CloseHandles();
+  // The file is closed by its own destructor.
+  unmap();
 }
 
-bool MemoryMappedFile::Initialize(const FilePath& file_name, Access access) {
-  if (IsValid())
-    return false;
-
-  FileMode file_mode = FileMode::OpenExisting;
-  FileAccess file_access;
-  switch (access) {
-    case ReadOnly:
-      file_access = FileAccess::ReadOnly;
-      break;
-    case ReadWrite:
-      file_access = FileAccess::ReadWrite;
-      break;
-    default:
-      // Can't open with "extend" because no maximum size is known.
-      file_access = FileAccess::ReadOnly;
-      ASSERT(false);
-  }
-  if (!file_.tryOpen(file_name, file_mode, file_access)) {
-    LOG(ERROR, "couldn't open {}", file_name);
-    return false;
-  }
+void MemoryMappedFile::open(const FilePath& path, Access access, const Options& options) {
+  // Can't open with "extend" because no maximum size is known.
+  ASSERT(access != ReadWriteExtend);
 
-  if (!MapFileRegionToMemory(Region::WholeFile, access)) {
-    CloseHandles();
-    return false;
-  }
-  return true;
+  FileStream file;
+  file.open(path, FileMode::OpenExisting,
+            access == ReadOnly ? FileAccess::ReadOnly : FileAccess::ReadWrite);
+  open(move(file), Region::WholeFile, access, options);
 }
 
-bool MemoryMappedFile::Initialize(FileStream&& file, Access access) {
-  ASSERT(access != ReadWriteExtend);
-  return Initialize(move(file), Region::WholeFile, access);
-}
+void MemoryMappedFile::open(
+    FileStream&& file, const Region& region, Access access, const Options& options) {
+  ASSERT(!isOpen());
+  ASSERT(file.isOpen());
+  if (region != Region::WholeFile) {
+    ASSERT(region.offset >= 0);
+    ASSERT(region.size >= 0);
+  } else {
+    ASSERT(access != ReadWriteExtend);
+  }
 
-bool MemoryMappedFile::Initialize(FileStream&& file, const Region& region, Access access) {
-  switch (access) {
-    case ReadWriteExtend:
-      // Ensure that the extended size is within limits of File.
-      if (region.size > Limits<int64_t>::Max - region.offset) {
-        LOG(ERROR, "region bounds exceed maximum for File");
-        return false;
-      }
-      // no break
-    case ReadOnly:
-    case ReadWrite:
-      // Ensure that the region values are valid.
-      if (region.offset < 0 || region.size < 0) {
-        LOG(ERROR, "region bounds are not valid");
-        return false;
-      }
-      break;
+  file_.openNative(
+      file.releaseNativeFile(),
+      access == ReadOnly ? FileAccess::ReadOnly : FileAccess::ReadWrite);
+  access_ = access;
+  options_ = options;
+
+  try {
+    mapRegion(region);
+  } catch (...) {
+    file_.close();
+    throw;
   }
+}
 
-  if (IsValid())
-    return false;
+void MemoryMappedFile::close() {
+  ASSERT(isOpen());
+  unmap();
+  file_.close();
+}
 
-  if (region != Region::WholeFile) {
-    ASSERT(region.offset >= 0);
-    ASSERT(region.size > 0);
-  }
+void MemoryMappedFile::remap(const Region& region) {
+  ASSERT(isOpen());
+  unmap();
+  mapRegion(region);
+}
 
-  file_ = move(file);
+void MemoryMappedFile::advise(AccessPattern pattern) {
+  ASSERT(isOpen());
+  options_.pattern = pattern;
+  if (mapping_)
+    adviseRange(mapping_, mapping_size_, pattern, false);
+}
 
-  if (!MapFileRegionToMemory(region, access)) {
-    CloseHandles();
-    return false;
-  }
-  return true;
+void MemoryMappedFile::prefetch(int64_t offset, int64_t size) {
+  ASSERT(0 <= offset && offset <= length_);
+  ASSERT(0 <= size && size <= length_ - offset);
+  if (size == 0)
+    return;
+
+  // Hints are accepted for aligned ranges only.
+  auto* mapping_bytes = static_cast<byte_t*>(mapping_);
+  auto aligned = computeVmAlignedBoundaries((data_ - mapping_bytes) + offset, size);
+  size_t aligned_size = min(
+      static_cast<size_t>(aligned.size), mapping_size_ - static_cast<size_t>(aligned.start));
+  adviseRange(mapping_bytes + aligned.start, aligned_size, options_.pattern, true);
 }
 
-MemoryMappedFile::VmAlignedBoundaries MemoryMappedFile::ComputeVmAlignedBoundaries(
-    int64_t start, int size) {
+MemoryMappedFile::VmAlignedBoundaries MemoryMappedFile::computeVmAlignedBoundaries(
+    int64_t start, int64_t size) {
   // Sadly, on Windows, the mmap alignment is not just equal to the page size.
-  const int64_t mask = static_cast<int64_t>(SysInfo::VmAllocationGranularity()) - 1;
+  const int64_t mask = static_cast<int64_t>(getVmAllocationGranularity()) - 1;
   ASSERT(mask < INT32_MAX);
 
   VmAlignedBoundaries rv;
-  rv.offset = start & mask;
+  rv.offset = static_cast<int>(start & mask);
   rv.start = start & ~mask;
   rv.size = (size + rv.offset + mask) & ~mask;
   return rv;
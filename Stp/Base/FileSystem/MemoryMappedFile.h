@@ -6,6 +6,7 @@
 #ifndef STP_BASE_FS_MEMORYMAPPEDFILE_H_
 #define STP_BASE_FS_MEMORYMAPPEDFILE_H_
 
+#include "Base/Containers/BigBufferSpan.h"
 #include "Base/Io/FileStream.h"
 
 namespace stp {
@@ -37,15 +38,41 @@ class BASE_EXPORT MemoryMappedFile {
     ReadWriteExtend,
   };
 
-  // The default constructor sets all members to invalid/null values.
-  MemoryMappedFile();
-  ~MemoryMappedFile();
+  // Tells the kernel how the mapping is going to be accessed, so it can
+  // tune read-ahead. Ignored where not supported.
+  enum class AccessPattern {
+    Normal,
+    // Aggressive read-ahead, pages behind may be dropped early.
+    Sequential,
+    // No read-ahead.
+    Random,
+  };
+
+  struct Options {
+    Options()
+        : pattern(AccessPattern::Normal),
+          will_need(false), populate(false), huge_pages(false) {}
+
+    AccessPattern pattern;
+
+    // Starts reading whole mapping into page cache in background.
+    bool will_need;
+
+    // Faults all pages in before the mapping is returned. Slower start,
+    // but no page faults later. Linux only.
+    bool populate;
+
+    // Asks for transparent huge pages to reduce TLB pressure. Only files
+    // on filesystems supporting them benefit (tmpfs or with
+    // CONFIG_READ_ONLY_THP_FOR_FS). Linux only.
+    bool huge_pages;
+  };
 
   // Used to hold information about a region [offset + size] of a file.
   struct BASE_EXPORT Region {
     static const Region WholeFile;
 
-    bool operator ==(const Region& other) const {
+    bool operator==(const Region& other) const {
       return other.offset == offset && other.size == size;
     }
     bool operator!=(const Region& other) const {
@@ -56,35 +83,54 @@ class BASE_EXPORT MemoryMappedFile {
     int64_t offset;
 
     // Length of the region in bytes.
-    int size;
+    // May exceed 4 GiB in 64-bit processes.
+    int64_t size;
   };
 
+  // The default constructor sets all members to invalid/null values.
+  MemoryMappedFile();
+  ~MemoryMappedFile();
+
   // Opens an existing file and maps it into memory. |access| can be read-only
-  // or read/write but not read/write+extend. If this object already points
-  // to a valid memory mapped file then this method will fail and return
-  // false. If it cannot open the file, the file does not exist, or the
-  // memory mapping fails, it will return false.
-  bool Initialize(const FilePath& file_name, Access access = ReadOnly);
-
-  // As above, but works with an already-opened file. |access| can be read-only
-  // or read/write but not read/write+extend. MemoryMappedFile takes ownership
-  // of |file| and closes it when done. |file| must have been opened with
-  // permissions suitable for |access|. If the memory mapping fails, it will
-  // return false.
-  bool Initialize(FileStream&& file, Access access = ReadOnly);
-
-  // As above, but works with a region of an already-opened file. All forms of
-  // |access| are allowed. If ReadWriteExtend is specified then |region|
-  // provides the maximum size of the file. If the memory mapping fails, it
-  // return false.
-  bool Initialize(FileStream&& file, const Region& region, Access access = ReadOnly);
-
-  ALWAYS_INLINE const char* data() const { return data_; }
-  ALWAYS_INLINE char* data() { return data_; }
-  ALWAYS_INLINE int length() const { return length_; }
-
-  // Is file_ a valid file handle that points to an open, memory mapped file?
-  ALWAYS_INLINE bool IsValid() const { return data_ != nullptr; }
+  // or read/write but not read/write+extend.
+  void open(const FilePath& path, Access access = ReadOnly, const Options& options = Options());
+
+  // As above, but works with a region of an already-opened file.
+  // MemoryMappedFile takes ownership of |file| and closes it when done.
+  // |file| must have been opened with permissions suitable for |access|.
+  // All forms of |access| are allowed. If ReadWriteExtend is specified then
+  // |region| provides the maximum size of the file.
+  void open(
+      FileStream&& file, const Region& region = Region::WholeFile,
+      Access access = ReadOnly, const Options& options = Options());
+
+  void close();
+
+  ALWAYS_INLINE bool isOpen() const { return file_.isOpen(); }
+
+  // Replaces the mapping with other region of the same file.
+  // Cheaper than reopening - the file is not opened again and the options
+  // are reused. Pointers to old mapping become invalid.
+  void remap(const Region& region);
+
+  // Applies |pattern| to whole mapping.
+  void advise(AccessPattern pattern);
+
+  // Starts reading given part of the mapping into page cache in background.
+  void prefetch(int64_t offset, int64_t size);
+
+  ALWAYS_INLINE const byte_t* data() const { return data_; }
+  ALWAYS_INLINE byte_t* data() { return data_; }
+  ALWAYS_INLINE int64_t length() const { return length_; }
+
+  // Whole mapping as a span. Use BigBufferSpan::chunks() to feed it to APIs
+  // accepting regular spans.
+  BigBufferSpan getSpan() const { return BigBufferSpan(data_, length_); }
+
+  // Returns offset of the mapped region within the file.
+  ALWAYS_INLINE int64_t getOffset() const { return offset_; }
+
+  int64_t getFileLength() { return file_.getLength(); }
 
  private:
   // Given the arbitrarily aligned memory region [start, size], returns the
@@ -95,21 +141,29 @@ class BASE_EXPORT MemoryMappedFile {
   // - |offset| is the displacement of |start| w.r.t |aligned_start|.
   struct VmAlignedBoundaries {
     int64_t start;
-    int size;
+    int64_t size;
     int offset;
   };
-  static VmAlignedBoundaries ComputeVmAlignedBoundaries(int64_t start, int size);
+  static VmAlignedBoundaries computeVmAlignedBoundaries(int64_t start, int64_t size);
 
-  // Map the file to memory, set data_ to that memory address. Return true on
-  // success, false on any kind of failure. This is a helper for Initialize().
-  bool MapFileRegionToMemory(const Region& region, Access access);
+  static int getVmAllocationGranularity();
 
-  // Closes all open handles.
-  void CloseHandles();
+  // Maps the region of |file_| to memory.
+  void mapRegion(const Region& region);
+  void unmap();
+  void adviseRange(void* address, size_t size, AccessPattern pattern, bool will_need);
 
   FileStream file_;
-  char* data_ = nullptr;
-  int length_ = 0;
+  Access access_ = ReadOnly;
+  Options options_;
+
+  // Start of the mapping which is aligned to VM granularity.
+  void* mapping_ = nullptr;
+  size_t mapping_size_ = 0;
+
+  byte_t* data_ = nullptr;
+  int64_t length_ = 0;
+  int64_t offset_ = 0;
 
   #if OS(WIN)
   win::ScopedHandle file_mapping_;
@@ -0,0 +1,174 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/FileSystem/MemoryMappedFile.h"
+
+#include "Base/Containers/List.h"
+#include "Base/Crypto/Crc32.h"
+#include "Base/FileSystem/TemporaryDirectory.h"
+#include "Base/Io/MappedStream.h"
+#include "Base/Test/GTest.h"
+#include "Base/Test/PerfTest.h"
+#include "Base/Time/TimeTicks.h"
+
+namespace stp {
+
+// Needs 4 GiB of free space in temporary directory.
+static const int64_t FileSize = INT64_C(4) << 30;
+static const int WriteChunkSize = 1 << 20;
+static const int ScanChunkSize = 1 << 20;
+static const int WindowSize = 256 << 20;
+
+namespace {
+
+class MemoryMappedFilePerfTest : public testing::Test {
+ protected:
+  enum class Method {
+    // Whole file mapped at once and split with BigBufferSpan::chunks().
+    WholeMapping,
+    // MemoryMappedFile::remap() moved over the file window by window,
+    // as 32-bit processes have to do.
+    RemapWindows,
+    MappedStreamReadSpan,
+  };
+
+  enum class Kernel {
+    Sum,
+    Crc32,
+  };
+
+  static const char* getMethodName(Method method) {
+    switch (method) {
+      case Method::WholeMapping: return "whole_mapping";
+      case Method::RemapWindows: return "remap_windows";
+      case Method::MappedStreamReadSpan: return "mapped_stream_read_span";
+    }
+    return nullptr;
+  }
+
+  static const char* getKernelName(Kernel kernel) {
+    switch (kernel) {
+      case Kernel::Sum: return "_sum";
+      case Kernel::Crc32: return "_crc32";
+    }
+    return nullptr;
+  }
+
+  void SetUp() override {
+    if (sizeof(void*) < 8)
+      return;
+
+    temp_dir_.create();
+    path_ = combineFilePaths(temp_dir_.path(), FilePath::fromString("large_file"));
+
+    List<byte_t> chunk;
+    byte_t* chunk_data = chunk.appendUninitialized(WriteChunkSize);
+    FileStream file;
+    file.create(path_, FileMode::Create, FileAccess::WriteOnly);
+    for (int64_t written = 0; written < FileSize; written += WriteChunkSize) {
+      for (int i = 0; i < WriteChunkSize; i += 8)
+        *reinterpret_cast<int64_t*>(chunk_data + i) = written + i;
+      file.write(BufferSpan(chunk_data, WriteChunkSize));
+    }
+    file.close();
+  }
+
+  class Consumer {
+   public:
+    explicit Consumer(Kernel kernel) : kernel_(kernel) {}
+
+    void consume(BufferSpan chunk) {
+      if (kernel_ == Kernel::Crc32) {
+        crc_.update(chunk);
+        return;
+      }
+      auto* words = static_cast<const uint64_t*>(chunk.data());
+      int word_count = chunk.size() / isizeof(uint64_t);
+      for (int i = 0; i < word_count; ++i)
+        sum_ += words[i];
+    }
+
+    uint64_t getResult() const {
+      return kernel_ == Kernel::Crc32 ? toUnderlying(crc_.getChecksum()) : sum_;
+    }
+
+   private:
+    Kernel kernel_;
+    uint64_t sum_ = 0;
+    Crc32Algorithm crc_;
+  };
+
+  void runScan(Method method, Kernel kernel);
+
+  TemporaryDirectory temp_dir_;
+  FilePath path_;
+};
+
+void MemoryMappedFilePerfTest::runScan(Method method, Kernel kernel) {
+  Consumer consumer(kernel);
+
+  TimeTicks start = TimeTicks::Now();
+  switch (method) {
+    case Method::WholeMapping: {
+      MemoryMappedFile mapped;
+      mapped.open(path_);
+      for (BufferSpan chunk : mapped.getSpan().chunks(ScanChunkSize))
+        consumer.consume(chunk);
+      break;
+    }
+    case Method::RemapWindows: {
+      FileStream file;
+      file.open(path_, FileMode::OpenExisting, FileAccess::ReadOnly);
+      MemoryMappedFile mapped;
+      mapped.open(move(file), { 0, WindowSize });
+      for (int64_t offset = 0; offset < FileSize; offset += WindowSize) {
+        if (offset != 0)
+          mapped.remap({ offset, min(FileSize - offset, static_cast<int64_t>(WindowSize)) });
+        for (BufferSpan chunk : mapped.getSpan().chunks(ScanChunkSize))
+          consumer.consume(chunk);
+      }
+      break;
+    }
+    case Method::MappedStreamReadSpan: {
+      MappedStream stream;
+      stream.setWindowSize(WindowSize);
+      stream.open(path_);
+      while (true) {
+        BufferSpan chunk = stream.readSpan(ScanChunkSize);
+        if (chunk.isEmpty())
+          break;
+        consumer.consume(chunk);
+      }
+      break;
+    }
+  }
+  double total_time_milliseconds = (TimeTicks::Now() - start).InMillisecondsF();
+
+  // Keeps the compiler from dropping the scan.
+  EXPECT_NE(0u, consumer.getResult());
+
+  perf_test::PrintResult(
+      "large_file_scan", getKernelName(kernel), getMethodName(method),
+      static_cast<double>(FileSize) / 1024 / total_time_milliseconds,
+      "KiB/ms", true);
+}
+
+} // namespace
+
+// Writes and maps 4 GiB file, run explicitly.
+TEST_F(MemoryMappedFilePerfTest, DISABLED_Scan) {
+  if (sizeof(void*) < 8)
+    return;
+
+  const Method Methods[] = {
+    Method::WholeMapping,
+    Method::RemapWindows,
+    Method::MappedStreamReadSpan,
+  };
+  for (Method method : Methods) {
+    runScan(method, Kernel::Sum);
+    runScan(method, Kernel::Crc32);
+  }
+}
+
+} // namespace stp
@@ -5,84 +5,131 @@
 
 #include "Base/FileSystem/MemoryMappedFile.h"
 
-#include "Base/Debug/Log.h"
+#include "Base/Error/SystemException.h"
+#include "Base/Posix/PosixErrorCode.h"
 
 #include <sys/mman.h>
-#include <sys/stat.h>
 #include <unistd.h>
 
 namespace stp {
 
-bool MemoryMappedFile::MapFileRegionToMemory(
-    const MemoryMappedFile::Region& region, Access access) {
+int MemoryMappedFile::getVmAllocationGranularity() {
+  static int g_page_size = static_cast<int>(::sysconf(_SC_PAGESIZE));
+  return g_page_size;
+}
+
+void MemoryMappedFile::mapRegion(const Region& region) {
+  ASSERT(!mapping_);
+
   off_t map_start = 0;
   size_t map_size = 0;
   int data_offset = 0;
 
-  if (region == MemoryMappedFile::Region::WholeFile) {
-    int64_t file_len = file_.getLength();
-    if (file_len < 0) {
-      LOG(ERROR, "fstat failed, fd={}", file_.getNativeFile());
-      return false;
-    }
-    map_size = static_cast<size_t>(file_len);
-    length_ = map_size;
+  if (region == Region::WholeFile) {
+    int64_t file_length = file_.getLength();
+    // Only a 32-bit process can fail here.
+    if (static_cast<uint64_t>(file_length) > Limits<size_t>::Max)
+      throw SystemException(static_cast<PosixErrorCode>(EFBIG));
+    map_size = static_cast<size_t>(file_length);
+    length_ = file_length;
+    offset_ = 0;
   } else {
     ASSERT(region.size >= 0);
     // The region can be arbitrarily aligned. mmap, instead, requires both the
     // start and size to be page-aligned. Hence, we map here the page-aligned
     // outer region [|aligned.start|, |aligned.start| + |size|] which contains
     // |region| and then add up the |data_offset| displacement.
-    auto aligned = ComputeVmAlignedBoundaries(region.offset, region.size);
+    auto aligned = computeVmAlignedBoundaries(region.offset, region.size);
     data_offset = aligned.offset;
 
     // Ensure that the casts in the mmap call below are sane.
     if (aligned.start < 0 || aligned.size < 0 ||
         aligned.start > Limits<off_t>::Max ||
-        static_cast<uint64_t>(aligned.size) > Limits<size_t>::Max ||
-        static_cast<uint64_t>(region.size) > Limits<size_t>::Max) {
-      LOG(ERROR, "region bounds are not valid for mmap");
-      return false;
+        static_cast<uint64_t>(aligned.size) > Limits<size_t>::Max) {
+      throw SystemException(static_cast<PosixErrorCode>(EINVAL));
     }
 
     map_start = static_cast<off_t>(aligned.start);
     map_size = static_cast<size_t>(aligned.size);
-    length_ = static_cast<size_t>(region.size);
+    length_ = region.size;
+    offset_ = region.offset;
   }
 
-  int flags = 0;
-  switch (access) {
+  int protection = 0;
+  switch (access_) {
     case ReadOnly:
-      flags |= PROT_READ;
+      protection = PROT_READ;
       break;
     case ReadWrite:
-      flags |= PROT_READ | PROT_WRITE;
+      protection = PROT_READ | PROT_WRITE;
       break;
     case ReadWriteExtend:
       // POSIX won't auto-extend the file when it is written so it must first
       // be explicitly extended to the maximum size. Zeros will fill the new
       // space.
       file_.setLength(max(file_.getLength(), region.offset + region.size));
-      flags |= PROT_READ | PROT_WRITE;
+      protection = PROT_READ | PROT_WRITE;
       break;
   }
-  data_ = static_cast<char*>(mmap(
-      NULL, map_size, flags, MAP_SHARED, file_.getNativeFile(), map_start));
-  if (data_ == MAP_FAILED) {
-    LOG(ERROR, "mmap failed, fd={}", file_.getNativeFile());
-    return false;
+
+  if (map_size == 0) {
+    // mmap() refuses empty mappings.
+    return;
+  }
+
+  int flags = MAP_SHARED;
+  #if defined(MAP_POPULATE)
+  if (options_.populate)
+    flags |= MAP_POPULATE;
+  #endif
+
+  void* mapping = ::mmap(nullptr, map_size, protection, flags, file_.getNativeFile(), map_start);
+  if (mapping == MAP_FAILED) {
+    length_ = 0;
+    offset_ = 0;
+    throw SystemException(getLastPosixErrorCode());
   }
-  data_ += data_offset;
-  return true;
+  mapping_ = mapping;
+  mapping_size_ = map_size;
+  data_ = static_cast<byte_t*>(mapping) + data_offset;
+
+  #if defined(MADV_HUGEPAGE)
+  // Fails if the kernel has no support for transparent huge pages.
+  if (options_.huge_pages)
+    ignoreResult(::madvise(mapping_, mapping_size_, MADV_HUGEPAGE));
+  #endif
+  if (options_.pattern != AccessPattern::Normal || options_.will_need)
+    adviseRange(mapping_, mapping_size_, options_.pattern, options_.will_need);
 }
 
-void MemoryMappedFile::CloseHandles() {
-  if (data_)
-    munmap(data_, length_);
-  file_.close();
+void MemoryMappedFile::unmap() {
+  if (mapping_)
+    ::munmap(mapping_, mapping_size_);
 
+  mapping_ = nullptr;
+  mapping_size_ = 0;
   data_ = nullptr;
   length_ = 0;
+  offset_ = 0;
+}
+
+void MemoryMappedFile::adviseRange(void* address, size_t size, AccessPattern pattern, bool will_need) {
+  // These are hints only, failures are not reported.
+  int advice = MADV_NORMAL;
+  switch (pattern) {
+    case AccessPattern::Normal:
+      advice = MADV_NORMAL;
+      break;
+    case AccessPattern::Sequential:
+      advice = MADV_SEQUENTIAL;
+      break;
+    case AccessPattern::Random:
+      advice = MADV_RANDOM;
+      break;
+  }
+  ignoreResult(::madvise(address, size, advice));
+  if (will_need)
+    ignoreResult(::madvise(address, size, MADV_WILLNEED));
 }
 
 } // namespace stp
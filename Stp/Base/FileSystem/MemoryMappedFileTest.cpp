@@ -0,0 +1,140 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/FileSystem/MemoryMappedFile.h"
+
+#include "Base/Crypto/Crc32.h"
+#include "Base/FileSystem/TemporaryDirectory.h"
+#include "Base/Test/GTest.h"
+
+namespace stp {
+
+namespace {
+
+// Sparse, so it takes no disk space. Only pages around markers are touched.
+const int64_t LargeFileSize = (INT64_C(5) << 30) + 123;
+
+struct Marker {
+  int64_t offset;
+  byte_t value;
+};
+
+// Placed around offsets that overflow 32-bit sizes.
+const Marker Markers[] = {
+  { 0, 0x11 },
+  { (INT64_C(1) << 31) - 1, 0x22 },
+  { INT64_C(1) << 31, 0x33 },
+  { (INT64_C(1) << 32) + 7, 0x44 },
+  { LargeFileSize - 1, 0x55 },
+};
+
+class MemoryMappedFileTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    temp_dir_.create();
+    path_ = combineFilePaths(temp_dir_.path(), FilePath::fromString("mapped_file"));
+  }
+
+  void createLargeFile() {
+    FileStream file;
+    file.create(path_);
+    file.setLength(LargeFileSize);
+    for (const Marker& marker : Markers)
+      file.positionalWrite(marker.offset, BufferSpan(&marker.value, 1));
+    file.close();
+  }
+
+  TemporaryDirectory temp_dir_;
+  FilePath path_;
+};
+
+} // namespace
+
+TEST_F(MemoryMappedFileTest, Basic) {
+  const byte_t Data[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+  FileStream file;
+  file.create(path_);
+  file.write(BufferSpan(Data));
+
+  MemoryMappedFile mapped;
+  mapped.open(move(file), { 2, 5 });
+  EXPECT_EQ(5, mapped.length());
+  EXPECT_EQ(2, mapped.getOffset());
+  EXPECT_EQ(BufferSpan(Data + 2, 5), mapped.getSpan().getChunk(0, 5));
+
+  mapped.remap({ 6, 2 });
+  EXPECT_EQ(BigBufferSpan(Data + 6, 2), mapped.getSpan());
+}
+
+TEST_F(MemoryMappedFileTest, LargeSparseFile) {
+  if (sizeof(void*) < 8)
+    return;
+
+  createLargeFile();
+
+  MemoryMappedFile mapped;
+  mapped.open(path_);
+  ASSERT_EQ(LargeFileSize, mapped.length());
+
+  BigBufferSpan span = mapped.getSpan();
+  auto* data = static_cast<const byte_t*>(span.data());
+  for (const Marker& marker : Markers)
+    EXPECT_EQ(marker.value, data[marker.offset]);
+
+  // Chunks cover the whole mapping; the data is not touched.
+  const int ChunkSize = 1 << 30;
+  int chunk_count = 0;
+  int64_t total_size = 0;
+  const byte_t* expected_data = data;
+  for (BufferSpan chunk : span.chunks(ChunkSize)) {
+    EXPECT_EQ(expected_data, chunk.data());
+    expected_data += chunk.size();
+    total_size += chunk.size();
+    ++chunk_count;
+  }
+  EXPECT_EQ(6, chunk_count);
+  EXPECT_EQ(LargeFileSize, total_size);
+  EXPECT_EQ(123, span.getChunk(LargeFileSize - 123, ChunkSize).size());
+}
+
+TEST_F(MemoryMappedFileTest, LargeRegion) {
+  if (sizeof(void*) < 8)
+    return;
+
+  createLargeFile();
+
+  // Unaligned region larger than 2 GiB, starting above 2 GiB.
+  const int64_t Offset = (INT64_C(1) << 31) - 1;
+  const int64_t Size = (INT64_C(3) << 30) + 1000;
+
+  MemoryMappedFile mapped;
+  FileStream file;
+  file.open(path_);
+  mapped.open(move(file), { Offset, Size });
+  ASSERT_EQ(Size, mapped.length());
+  EXPECT_EQ(Offset, mapped.getOffset());
+
+  auto* data = static_cast<const byte_t*>(mapped.getSpan().data());
+  EXPECT_EQ(0x22, data[0]);
+  EXPECT_EQ(0x33, data[1]);
+  EXPECT_EQ(0x44, data[(INT64_C(1) << 32) + 7 - Offset]);
+}
+
+TEST_F(MemoryMappedFileTest, HashAcrossChunks) {
+  if (sizeof(void*) < 8)
+    return;
+
+  createLargeFile();
+
+  MemoryMappedFile mapped;
+  mapped.open(path_);
+
+  // Over 2 GiB, crossing the 4 GiB boundary, so it is hashed in several
+  // default chunks. Checksum was computed with zlib over the same bytes.
+  BigBufferSpan range = mapped.getSpan().slice(
+      (INT64_C(1) << 31) - 1000, (INT64_C(1) << 31) + 10000);
+  ASSERT_GT(range.size(), BigBufferSpan::DefaultChunkSize * INT64_C(2));
+  EXPECT_EQ(UINT32_C(0xA0597FEE), toUnderlying(computeCrc32(range)));
+}
+
+} // namespace stp
@@ -5,19 +5,23 @@
 
 #include "Base/FileSystem/MemoryMappedFile.h"
 
-#include "Base/Debug/Log.h"
-#include "Base/FileSystem/FilePath.h"
+#include "Base/Error/SystemException.h"
+#include "Base/Win/WinErrorCode.h"
 
 namespace stp {
 
-bool MemoryMappedFile::MapFileRegionToMemory(
-    const MemoryMappedFile::Region& region, Access access) {
-  if (!file_.isOpen())
-    return false;
+int MemoryMappedFile::getVmAllocationGranularity() {
+  SYSTEM_INFO system_info = {};
+  ::GetNativeSystemInfo(&system_info);
+  return static_cast<int>(system_info.dwAllocationGranularity);
+}
+
+void MemoryMappedFile::mapRegion(const Region& region) {
+  ASSERT(!mapping_);
 
   int flags = 0;
-  uint32_t size_low = 0;
-  switch (access) {
+  uint64_t max_size = 0;
+  switch (access_) {
     case ReadOnly:
       flags |= PAGE_READONLY;
       break;
@@ -26,26 +30,22 @@ bool MemoryMappedFile::MapFileRegionToMemory(
       break;
     case ReadWriteExtend:
       flags |= PAGE_READWRITE;
-      size_low = region.size;
+      max_size = static_cast<uint64_t>(region.offset + region.size);
       break;
   }
 
-  const uint32_t size_high = 0;
-  file_mapping_.Reset(::CreateFileMapping(
-      file_.getNativeFile(), NULL, flags, size_high, size_low, NULL));
-  if (!file_mapping_.IsValid())
-    return false;
-
   LARGE_INTEGER map_start = {};
   SIZE_T map_size = 0;
   int32_t data_offset = 0;
 
-  if (region == MemoryMappedFile::Region::WholeFile) {
-    ASSERT(access != ReadWriteExtend);
-    int64_t file_len = file_.getLength();
-    if (file_len <= 0 || file_len > Limits<int32_t>::Max)
-      return false;
-    length_ = static_cast<int>(file_len);
+  if (region == Region::WholeFile) {
+    ASSERT(access_ != ReadWriteExtend);
+    int64_t file_length = file_.getLength();
+    // Only a 32-bit process can fail here.
+    if (static_cast<uint64_t>(file_length) > Limits<SIZE_T>::Max)
+      throw SystemException(static_cast<WinErrorCode>(ERROR_FILE_TOO_LARGE));
+    length_ = file_length;
+    offset_ = 0;
   } else {
     // The region can be arbitrarily aligned. MapViewOfFile, instead, requires
     // that the start address is aligned to the VM granularity (which is
@@ -54,42 +54,66 @@ bool MemoryMappedFile::MapFileRegionToMemory(
     // aligned and must be less than or equal the mapped file size.
     // We map here the outer region [|aligned.start|, |aligned.start+size|]
     // which contains |region| and then add up the |data_offset| displacement.
-    auto aligned = ComputeVmAlignedBoundaries(region.offset, region.size);
+    auto aligned = computeVmAlignedBoundaries(region.offset, region.size);
     data_offset = aligned.offset;
     int64_t size = region.size + data_offset;
 
     // Ensure that the casts below in the MapViewOfFile call are sane.
     if (aligned.start < 0 || size < 0 ||
         static_cast<uint64_t>(size) > Limits<SIZE_T>::Max) {
-      LOG(ERROR, "region bounds are not valid for MapViewOfFile");
-      return false;
+      throw SystemException(static_cast<WinErrorCode>(ERROR_INVALID_PARAMETER));
     }
     map_start.QuadPart = aligned.start;
     map_size = static_cast<SIZE_T>(size);
     length_ = region.size;
+    offset_ = region.offset;
+  }
+
+  if (length_ == 0 && access_ != ReadWriteExtend) {
+    // Empty files cannot be mapped.
+    offset_ = 0;
+    return;
+  }
+
+  file_mapping_.Reset(::CreateFileMapping(
+      file_.getNativeFile(), NULL, flags,
+      static_cast<DWORD>(max_size >> 32), static_cast<DWORD>(max_size), NULL));
+  if (!file_mapping_.IsValid()) {
+    length_ = 0;
+    offset_ = 0;
+    throw SystemException(getLastWinErrorCode());
   }
 
-  data_ = static_cast<char*>(::MapViewOfFile(
+  void* mapping = ::MapViewOfFile(
       file_mapping_.get(),
       (flags & PAGE_READONLY) ? FILE_MAP_READ : FILE_MAP_WRITE,
-      map_start.HighPart, map_start.LowPart, map_size));
-  if (data_ == nullptr)
-    return false;
-
-  data_ += data_offset;
-  return true;
+      map_start.HighPart, map_start.LowPart, map_size);
+  if (!mapping) {
+    file_mapping_.Reset();
+    length_ = 0;
+    offset_ = 0;
+    throw SystemException(getLastWinErrorCode());
+  }
+  mapping_ = mapping;
+  mapping_size_ = map_size ? map_size : static_cast<size_t>(length_);
+  data_ = static_cast<byte_t*>(mapping) + data_offset;
 }
 
-void MemoryMappedFile::CloseHandles() {
-  if (data_)
-    ::UnmapViewOfFile(data_);
+void MemoryMappedFile::unmap() {
+  if (mapping_)
+    ::UnmapViewOfFile(mapping_);
   if (file_mapping_.IsValid())
     file_mapping_.Reset();
-  if (file_.isOpen())
-    file_.close();
 
+  mapping_ = nullptr;
+  mapping_size_ = 0;
   data_ = nullptr;
   length_ = 0;
+  offset_ = 0;
+}
+
+void MemoryMappedFile::adviseRange(void* address, size_t size, AccessPattern pattern, bool will_need) {
+  // Windows has no read-ahead hints for mapped views.
 }
 
 } // namespace stp
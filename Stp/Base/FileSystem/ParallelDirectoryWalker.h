@@ -0,0 +1,104 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#ifndef STP_BASE_FS_PARALLELDIRECTORYWALKER_H_
+#define STP_BASE_FS_PARALLELDIRECTORYWALKER_H_
+
+#include "Base/Error/SystemErrorCode.h"
+#include "Base/FileSystem/FilePath.h"
+
+namespace stp {
+
+// Walks a directory tree on several threads (POSIX only).
+//
+// Meant for large trees (millions of files) where RecursiveDirectoryEnumerator
+// is too slow. Directories are read in big batches (getdents64() on Linux),
+// entry type is taken from directory listing instead of stat() where
+// possible, and all file system calls are made relative to directory
+// descriptors (openat()/fstatat()), so the kernel does not resolve full paths
+// over and over again. Subdirectories are fanned out to worker threads.
+//
+// Symbolic links are reported but never followed.
+// The order of the entries is not specified.
+class BASE_EXPORT ParallelDirectoryWalker {
+  STATIC_ONLY(ParallelDirectoryWalker);
+ public:
+  enum class EntryType {
+    RegularFile,
+    Directory,
+    SymbolicLink,
+    // Device, socket, pipe, etc.
+    Other,
+  };
+
+  class Entry {
+   public:
+    const FilePath& getDirPath() const { return dir_path_; }
+    FilePathSpan getFileName() const { return file_name_; }
+    FilePath getFullPath() const { return combineFilePaths(dir_path_, file_name_); }
+
+    EntryType getType() const { return type_; }
+    bool isDirectory() const { return type_ == EntryType::Directory; }
+    bool isRegularFile() const { return type_ == EntryType::RegularFile; }
+    bool isSymbolicLink() const { return type_ == EntryType::SymbolicLink; }
+
+    // Available only when Options::want_sizes is set, -1 otherwise.
+    int64_t getSize() const { return size_; }
+
+    // The descriptor of directory being read. Use it with *at() system calls
+    // to get more information about the entry. Valid only during the call
+    // to Visitor::onEntry().
+    int getNativeDir() const { return dir_fd_; }
+
+   private:
+    friend class ParallelDirectoryWalkerImpl;
+
+    Entry(const FilePath& dir_path, int dir_fd)
+        : dir_path_(dir_path), dir_fd_(dir_fd) {}
+
+    const FilePath& dir_path_;
+    FilePathSpan file_name_;
+    EntryType type_ = EntryType::Other;
+    int64_t size_ = -1;
+    int dir_fd_;
+  };
+
+  // All methods may be called concurrently from multiple threads.
+  // If a method throws, the walk stops and walk() rethrows the exception
+  // once all threads are done.
+  class Visitor {
+   public:
+    // Returns false to skip descending into the directory described by |entry|.
+    // Ignored for other entries.
+    virtual bool onEntry(const Entry& entry) = 0;
+
+    // Called when a directory below the root could not be read.
+    // The walk continues with other directories.
+    virtual void onError(const FilePath& path, SystemErrorCode error_code) {}
+
+   protected:
+    ~Visitor() {}
+  };
+
+  struct Options {
+    Options() : thread_count(0), want_sizes(false) {}
+
+    // Number of threads to walk with, including the calling thread.
+    // Zero selects number of cores.
+    int thread_count;
+
+    // Calls fstatat() for every entry to fill Entry::getSize().
+    bool want_sizes;
+  };
+
+  // Blocks until the whole tree is visited. Throws FileSystemException if
+  // |root_path| cannot be opened, or the exception thrown by |visitor|.
+  static void walk(const FilePath& root_path, Visitor& visitor, const Options& options = Options());
+
+  // Returns the total number of bytes used by all the files under |root_path|.
+  static uint64_t computeSize(const FilePath& root_path, int thread_count = 0);
+};
+
+} // namespace stp
+
+#endif // STP_BASE_FS_PARALLELDIRECTORYWALKER_H_
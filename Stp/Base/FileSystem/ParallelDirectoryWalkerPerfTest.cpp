@@ -0,0 +1,160 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/FileSystem/ParallelDirectoryWalker.h"
+
+#include "Base/FileSystem/Directory.h"
+#include "Base/FileSystem/File.h"
+#include "Base/FileSystem/FileInfo.h"
+#include "Base/FileSystem/RecursiveDirectoryEnumerator.h"
+#include "Base/FileSystem/TemporaryDirectory.h"
+#include "Base/Io/FileStream.h"
+#include "Base/System/CpuInfo.h"
+#include "Base/Test/GTest.h"
+#include "Base/Test/PerfTest.h"
+#include "Base/Text/StringFormatMany.h"
+#include "Base/Thread/AtomicOps.h"
+#include "Base/Time/TimeTicks.h"
+
+namespace stp {
+
+namespace {
+
+struct TreeShape {
+  StringSpan name;
+  int depth;
+  int fan_out;
+  int files_per_dir;
+};
+
+// About 100k files each.
+const TreeShape TreeShapes[] = {
+  // Like a cache with two-level hash prefix directories.
+  { "hashed", 2, 64, 24 },
+  { "deep", 5, 6, 12 },
+  { "flat", 0, 0, 100000 },
+};
+
+class CountingVisitor : public ParallelDirectoryWalker::Visitor {
+ public:
+  bool onEntry(const ParallelDirectoryWalker::Entry& entry) override {
+    subtle::NoBarrier_AtomicIncrement(&count_, 1);
+    return true;
+  }
+
+  int getCount() const { return subtle::NoBarrier_Load(&count_); }
+
+ private:
+  subtle::Atomic32 count_ = 0;
+};
+
+class ParallelDirectoryWalkerPerfTest : public testing::Test {
+ protected:
+  enum class Method {
+    RecursiveEnumerator,
+    RecursiveEnumeratorWithStat,
+    Walker,
+    WalkerWithSizes,
+  };
+
+  static const char* getMethodName(Method method) {
+    switch (method) {
+      case Method::RecursiveEnumerator: return "recursive_enumerator";
+      case Method::RecursiveEnumeratorWithStat: return "recursive_enumerator_stat";
+      case Method::Walker: return "walker";
+      case Method::WalkerWithSizes: return "walker_sizes";
+    }
+    return nullptr;
+  }
+
+  void SetUp() override {
+    temp_dir_.create();
+  }
+
+  // Generates a tree of empty files. Returns number of entries created.
+  static int generateTree(const FilePath& path, const TreeShape& shape, int depth) {
+    int count = 0;
+    for (int i = 0; i < shape.files_per_dir; ++i) {
+      FileStream file;
+      file.create(combineFilePaths(path, FilePath::fromString(stringFormatMany("file{}", i))));
+      ++count;
+    }
+    if (depth == 0)
+      return count;
+    for (int i = 0; i < shape.fan_out; ++i) {
+      FilePath subdir_path = combineFilePaths(path, FilePath::fromString(stringFormatMany("dir{}", i)));
+      Directory::create(subdir_path);
+      count += 1 + generateTree(subdir_path, shape, depth - 1);
+    }
+    return count;
+  }
+
+  void runWalk(const FilePath& root_path, const TreeShape& shape, int entry_count, Method method, int thread_count);
+
+  TemporaryDirectory temp_dir_;
+};
+
+void ParallelDirectoryWalkerPerfTest::runWalk(
+    const FilePath& root_path, const TreeShape& shape, int entry_count,
+    Method method, int thread_count) {
+  int visited_count = 0;
+
+  TimeTicks start = TimeTicks::Now();
+  switch (method) {
+    case Method::RecursiveEnumerator:
+    case Method::RecursiveEnumeratorWithStat: {
+      FileInfo file_info;
+      RecursiveDirectoryEnumerator enumerator;
+      enumerator.open(root_path);
+      while (enumerator.moveNext()) {
+        if (method == Method::RecursiveEnumeratorWithStat)
+          File::getInfo(enumerator.getEntryFullPath(), file_info);
+        ++visited_count;
+      }
+      enumerator.close();
+      break;
+    }
+    case Method::Walker:
+    case Method::WalkerWithSizes: {
+      ParallelDirectoryWalker::Options options;
+      options.thread_count = thread_count;
+      options.want_sizes = method == Method::WalkerWithSizes;
+      CountingVisitor visitor;
+      ParallelDirectoryWalker::walk(root_path, visitor, options);
+      visited_count = visitor.getCount();
+      break;
+    }
+  }
+  double total_time_milliseconds = (TimeTicks::Now() - start).InMillisecondsF();
+
+  EXPECT_EQ(entry_count, visited_count);
+
+  perf_test::PrintResult(
+      "directory_walk", stringFormatMany("_{}_{}threads", shape.name, thread_count),
+      getMethodName(method),
+      static_cast<double>(entry_count) / total_time_milliseconds,
+      "entries/ms", true);
+}
+
+} // namespace
+
+// Directory entries are cached by the kernel after first walk,
+// so this measures the warm case typical for repeated cache cleanups.
+TEST_F(ParallelDirectoryWalkerPerfTest, Walk) {
+  const int ThreadCounts[] = { 1, 2, 4, CpuInfo::NumberOfCores() };
+
+  for (const TreeShape& shape : TreeShapes) {
+    FilePath root_path = combineFilePaths(temp_dir_.path(), FilePath::fromString(shape.name));
+    Directory::create(root_path);
+    int entry_count = generateTree(root_path, shape, shape.depth);
+
+    runWalk(root_path, shape, entry_count, Method::RecursiveEnumerator, 1);
+    runWalk(root_path, shape, entry_count, Method::RecursiveEnumeratorWithStat, 1);
+    for (int thread_count : ThreadCounts) {
+      runWalk(root_path, shape, entry_count, Method::Walker, thread_count);
+      runWalk(root_path, shape, entry_count, Method::WalkerWithSizes, thread_count);
+    }
+  }
+}
+
+} // namespace stp
@@ -0,0 +1,330 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/FileSystem/ParallelDirectoryWalker.h"
+
+#include "Base/Containers/List.h"
+#include "Base/Error/ExceptionPtr.h"
+#include "Base/FileSystem/FileSystemException.h"
+#include "Base/Memory/OwnPtr.h"
+#include "Base/Posix/EintrWrapper.h"
+#include "Base/Posix/FileDescriptor.h"
+#include "Base/Posix/StatWrapper.h"
+#include "Base/System/CpuInfo.h"
+#include "Base/Thread/ConditionVariable.h"
+#include "Base/Thread/Lock.h"
+#include "Base/Thread/Thread.h"
+#include "Base/Util/Finally.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+
+#if OS(LINUX)
+#include <sys/syscall.h>
+#endif
+
+namespace stp {
+
+// Much larger than buffer used by readdir() (32 KiB in glibc),
+// so huge directories are read with fewer system calls.
+static constexpr int ReadBufferSize = 256 << 10;
+
+// Pending directories keep their descriptors open, so they are not looked up
+// by path again. Above this limit (checked approximately) they are reopened
+// by path when their turn comes.
+static constexpr int MaxOpenPendingDirs = 256;
+
+static constexpr int OpenDirFlags = O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC;
+
+static bool isDotEntry(const char* name) {
+  if (name[0] != '.')
+    return false;
+  if (name[1] == '\0')
+    return true;
+  return name[1] == '.' && name[2] == '\0';
+}
+
+#if OS(LINUX)
+// Not exposed by glibc.
+struct LinuxDirent64 {
+  uint64_t d_ino;
+  int64_t d_off;
+  unsigned short d_reclen;
+  unsigned char d_type;
+  char d_name[1];
+};
+
+// Calls |callback| with name and d_type of every entry in directory |fd|.
+template<typename TCallback>
+static SystemErrorCode readDirectory(int fd, List<byte_t>& buffer, TCallback&& callback) {
+  if (buffer.isEmpty())
+    buffer.appendUninitialized(ReadBufferSize);
+
+  while (true) {
+    long rv = HANDLE_EINTR(::syscall(SYS_getdents64, fd, buffer.data(), buffer.size()));
+    if (rv < 0)
+      return getLastPosixErrorCode();
+    if (rv == 0)
+      return PosixErrorCode::Ok;
+
+    for (long offset = 0; offset < rv;) {
+      auto* dent = reinterpret_cast<const LinuxDirent64*>(buffer.data() + offset);
+      offset += dent->d_reclen;
+      if (!isDotEntry(dent->d_name))
+        callback(dent->d_name, dent->d_type);
+    }
+  }
+}
+#else
+template<typename TCallback>
+static SystemErrorCode readDirectory(int fd, List<byte_t>& buffer, TCallback&& callback) {
+  // fdopendir() takes ownership of the descriptor, but caller needs it
+  // for *at() calls.
+  int dup_fd = ::dup(fd);
+  if (dup_fd < 0)
+    return getLastPosixErrorCode();
+  DIR* dir = ::fdopendir(dup_fd);
+  if (!dir) {
+    auto error_code = getLastPosixErrorCode();
+    ::close(dup_fd);
+    return error_code;
+  }
+
+  SystemErrorCode error_code = PosixErrorCode::Ok;
+  while (true) {
+    errno = 0;
+    struct dirent* dent = ::readdir(dir);
+    if (!dent) {
+      if (errno != 0)
+        error_code = getLastPosixErrorCode();
+      break;
+    }
+    if (!isDotEntry(dent->d_name))
+      callback(dent->d_name, dent->d_type);
+  }
+  ::closedir(dir);
+  return error_code;
+}
+#endif // OS(*)
+
+static ParallelDirectoryWalker::EntryType entryTypeFromMode(mode_t mode) {
+  if (S_ISREG(mode))
+    return ParallelDirectoryWalker::EntryType::RegularFile;
+  if (S_ISDIR(mode))
+    return ParallelDirectoryWalker::EntryType::Directory;
+  if (S_ISLNK(mode))
+    return ParallelDirectoryWalker::EntryType::SymbolicLink;
+  return ParallelDirectoryWalker::EntryType::Other;
+}
+
+class ParallelDirectoryWalkerImpl {
+ public:
+  typedef ParallelDirectoryWalker::Entry Entry;
+  typedef ParallelDirectoryWalker::EntryType EntryType;
+  typedef ParallelDirectoryWalker::Options Options;
+  typedef ParallelDirectoryWalker::Visitor Visitor;
+
+  ParallelDirectoryWalkerImpl(Visitor& visitor, const Options& options)
+      : visitor_(visitor), options_(options),
+        work_available_(&lock_) {}
+
+  void run(FilePath root_path, posix::FileDescriptor root_dir);
+
+  uint64_t getTotalSize() const { return total_size_; }
+
+ private:
+  struct PendingDir {
+    FilePath path;
+    // Invalid if directory needs to be opened by path.
+    posix::FileDescriptor fd;
+  };
+
+  class Worker : public Thread {
+   public:
+    explicit Worker(ParallelDirectoryWalkerImpl* walker) : walker_(*walker) {}
+
+   protected:
+    int Main() override { walker_.workLoop(); return 0; }
+
+   private:
+    ParallelDirectoryWalkerImpl& walker_;
+  };
+
+  void workLoop();
+  uint64_t processDir(PendingDir& dir, int fd_budget, List<byte_t>& buffer, List<PendingDir>& out_subdirs);
+
+  Visitor& visitor_;
+  Options options_;
+
+  Lock lock_;
+  // Signaled when a directory is queued or the walk is finished or aborted.
+  ConditionVariable work_available_;
+  // Used as a stack. Depth-first order keeps number of pending directories low.
+  List<PendingDir> pending_;
+  // Number of threads processing a directory right now. Each of them may
+  // queue more work, so the walk is finished only when this drops to zero
+  // with no pending directories.
+  int busy_count_ = 0;
+  int open_pending_count_ = 0;
+  uint64_t total_size_ = 0;
+  // Set when the visitor throws. The other threads stop taking work and
+  // the first exception is rethrown on the calling thread.
+  bool aborted_ = false;
+  ExceptionPtr exception_;
+};
+
+void ParallelDirectoryWalkerImpl::run(FilePath root_path, posix::FileDescriptor root_dir) {
+  pending_.add(PendingDir { move(root_path), move(root_dir) });
+  open_pending_count_ = 1;
+
+  int thread_count = options_.thread_count > 0 ? options_.thread_count : CpuInfo::NumberOfCores();
+  List<OwnPtr<Worker>> workers;
+  for (int i = 1; i < thread_count; ++i) {
+    workers.add(OwnPtr<Worker>::create(this));
+    workers.last()->Start();
+  }
+
+  // The calling thread works too.
+  workLoop();
+
+  for (auto& worker : workers)
+    worker->Join();
+
+  if (exception_)
+    exception_.rethrow();
+}
+
+void ParallelDirectoryWalkerImpl::workLoop() {
+  List<byte_t> buffer;
+  List<PendingDir> subdirs;
+  uint64_t total_size = 0;
+
+  AutoLock guard(borrow(lock_));
+  while (true) {
+    while (pending_.isEmpty() && busy_count_ > 0 && !aborted_)
+      work_available_.Wait();
+    if (pending_.isEmpty() || aborted_)
+      break;
+
+    PendingDir dir = move(pending_.last());
+    pending_.removeLast();
+    if (dir.fd.isValid())
+      --open_pending_count_;
+    int fd_budget = MaxOpenPendingDirs - open_pending_count_;
+    try {
+      ++busy_count_;
+      auto busy_guard = makeScopeFinally([this] { --busy_count_; });
+      AutoUnlock unguard(&lock_);
+      total_size += processDir(dir, fd_budget, buffer, subdirs);
+    } catch (...) {
+      if (!aborted_) {
+        aborted_ = true;
+        exception_ = ExceptionPtr::current();
+      }
+      work_available_.Broadcast();
+      break;
+    }
+
+    for (auto& subdir : subdirs) {
+      if (subdir.fd.isValid())
+        ++open_pending_count_;
+      pending_.add(move(subdir));
+    }
+    if (subdirs.size() > 1 || (pending_.isEmpty() && busy_count_ == 0))
+      work_available_.Broadcast();
+    else if (subdirs.size() == 1)
+      work_available_.Signal();
+    subdirs.clear();
+  }
+  total_size_ += total_size;
+}
+
+uint64_t ParallelDirectoryWalkerImpl::processDir(
+    PendingDir& dir, int fd_budget, List<byte_t>& buffer, List<PendingDir>& out_subdirs) {
+  if (!dir.fd.isValid()) {
+    dir.fd.reset(HANDLE_EINTR(::open(toNullTerminated(dir.path), OpenDirFlags)));
+    if (!dir.fd.isValid()) {
+      visitor_.onError(dir.path, getLastPosixErrorCode());
+      return 0;
+    }
+  }
+  int dir_fd = dir.fd.get();
+
+  uint64_t total_size = 0;
+  Entry entry(dir.path, dir_fd);
+  auto error_code = readDirectory(dir_fd, buffer, [&](const char* name, unsigned char d_type) {
+    entry.file_name_ = makeFilePathSpanFromNullTerminated(name);
+
+    switch (d_type) {
+      case DT_REG: entry.type_ = EntryType::RegularFile; break;
+      case DT_DIR: entry.type_ = EntryType::Directory; break;
+      case DT_LNK: entry.type_ = EntryType::SymbolicLink; break;
+      default: entry.type_ = EntryType::Other; break;
+    }
+
+    // Some file systems do not fill d_type, ask for it then.
+    if (options_.want_sizes || d_type == DT_UNKNOWN) {
+      stat_wrapper_t stat;
+      if (posix::callFstatAt(dir_fd, name, &stat, AT_SYMLINK_NOFOLLOW) != 0) {
+        // Removed while walking.
+        return;
+      }
+      entry.type_ = entryTypeFromMode(stat.st_mode);
+      if (options_.want_sizes) {
+        entry.size_ = stat.st_size;
+        total_size += static_cast<uint64_t>(stat.st_size);
+      }
+    }
+
+    if (!visitor_.onEntry(entry) || !entry.isDirectory())
+      return;
+
+    PendingDir subdir { entry.getFullPath(), posix::FileDescriptor() };
+    if (fd_budget > 0) {
+      subdir.fd.reset(HANDLE_EINTR(::openat(dir_fd, name, OpenDirFlags)));
+      if (!subdir.fd.isValid()) {
+        visitor_.onError(subdir.path, getLastPosixErrorCode());
+        return;
+      }
+      --fd_budget;
+    }
+    out_subdirs.add(move(subdir));
+  });
+
+  if (!isOk(error_code))
+    visitor_.onError(dir.path, error_code);
+  return total_size;
+}
+
+void ParallelDirectoryWalker::walk(const FilePath& root_path, Visitor& visitor, const Options& options) {
+  posix::FileDescriptor root_dir(HANDLE_EINTR(::open(toNullTerminated(root_path), OpenDirFlags)));
+  if (!root_dir.isValid())
+    throw FileSystemException(getLastPosixErrorCode(), root_path);
+
+  ParallelDirectoryWalkerImpl impl(visitor, options);
+  impl.run(root_path, move(root_dir));
+}
+
+uint64_t ParallelDirectoryWalker::computeSize(const FilePath& root_path, int thread_count) {
+  class NullVisitor : public Visitor {
+   public:
+    bool onEntry(const Entry& entry) override { return true; }
+  };
+
+  posix::FileDescriptor root_dir(HANDLE_EINTR(::open(toNullTerminated(root_path), OpenDirFlags)));
+  if (!root_dir.isValid())
+    throw FileSystemException(getLastPosixErrorCode(), root_path);
+
+  NullVisitor visitor;
+  Options options;
+  options.thread_count = thread_count;
+  options.want_sizes = true;
+
+  // Sizes are summed per thread instead of in the visitor, which would
+  // need an atomic shared by all threads.
+  ParallelDirectoryWalkerImpl impl(visitor, options);
+  impl.run(root_path, move(root_dir));
+  return impl.getTotalSize();
+}
+
+} // namespace stp
@@ -0,0 +1,197 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/FileSystem/ParallelDirectoryWalker.h"
+
+#include "Base/Error/BasicExceptions.h"
+#include "Base/FileSystem/Directory.h"
+#include "Base/FileSystem/FileSystemException.h"
+#include "Base/FileSystem/TemporaryDirectory.h"
+#include "Base/Io/FileStream.h"
+#include "Base/Test/GTest.h"
+#include "Base/Thread/Lock.h"
+
+#include <unistd.h>
+
+namespace stp {
+
+namespace {
+
+const int FanOut = 3;
+const int Depth = 3;
+const int FilesPerDir = 4;
+
+class CountingVisitor : public ParallelDirectoryWalker::Visitor {
+ public:
+  bool onEntry(const ParallelDirectoryWalker::Entry& entry) override {
+    AutoLock guard(borrow(lock_));
+    switch (entry.getType()) {
+      case ParallelDirectoryWalker::EntryType::RegularFile:
+        ++file_count;
+        if (entry.getSize() >= 0)
+          file_size += entry.getSize();
+        break;
+      case ParallelDirectoryWalker::EntryType::Directory:
+        ++dir_count;
+        break;
+      case ParallelDirectoryWalker::EntryType::SymbolicLink:
+        ++symlink_count;
+        break;
+      case ParallelDirectoryWalker::EntryType::Other:
+        break;
+    }
+    if (entry.getSize() >= 0)
+      total_size += entry.getSize();
+    return !(entry.isDirectory() && entry.getFileName() == skip_name);
+  }
+
+  void onError(const FilePath& path, SystemErrorCode error_code) override {
+    AutoLock guard(borrow(lock_));
+    ++error_count;
+  }
+
+  FilePath skip_name;
+
+  int file_count = 0;
+  int dir_count = 0;
+  int symlink_count = 0;
+  int error_count = 0;
+  int64_t file_size = 0;
+  int64_t total_size = 0;
+
+ private:
+  Lock lock_;
+};
+
+// Throws when it sees a directory named |throw_name|.
+class ThrowingVisitor : public ParallelDirectoryWalker::Visitor {
+ public:
+  bool onEntry(const ParallelDirectoryWalker::Entry& entry) override {
+    if (entry.isDirectory() && entry.getFileName() == throw_name)
+      throw NotSupportedException();
+    return true;
+  }
+
+  FilePath throw_name;
+};
+
+class ParallelDirectoryWalkerTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    temp_dir_.create();
+    createTree(temp_dir_.path(), Depth);
+  }
+
+  // Every directory holds FilesPerDir files of sizes 0, 10, 20, ...
+  // and FanOut subdirectories, down to |depth| levels.
+  void createTree(const FilePath& path, int depth) {
+    byte_t data[FilesPerDir * 10] = {};
+    for (int i = 0; i < FilesPerDir; ++i) {
+      char name[] = "file0";
+      name[4] = static_cast<char>('0' + i);
+      FileStream file;
+      file.create(combineFilePaths(path, FilePath::fromString(name)));
+      file.write(BufferSpan(data, i * 10));
+      expected_file_size_ += i * 10;
+    }
+    if (depth == 0)
+      return;
+    for (int i = 0; i < FanOut; ++i) {
+      char name[] = "dir0";
+      name[3] = static_cast<char>('0' + i);
+      FilePath subdir_path = combineFilePaths(path, FilePath::fromString(name));
+      Directory::create(subdir_path);
+      createTree(subdir_path, depth - 1);
+    }
+  }
+
+  static int countDirs(int depth) {
+    int count = 0;
+    int level_count = 1;
+    for (int i = 0; i < depth; ++i) {
+      level_count *= FanOut;
+      count += level_count;
+    }
+    return count;
+  }
+
+  TemporaryDirectory temp_dir_;
+  int64_t expected_file_size_ = 0;
+};
+
+} // namespace
+
+TEST_F(ParallelDirectoryWalkerTest, VisitsAllEntries) {
+  const int ThreadCounts[] = { 1, 2, 8 };
+  for (int thread_count : ThreadCounts) {
+    ParallelDirectoryWalker::Options options;
+    options.thread_count = thread_count;
+
+    CountingVisitor visitor;
+    ParallelDirectoryWalker::walk(temp_dir_.path(), visitor, options);
+    EXPECT_EQ(countDirs(Depth), visitor.dir_count);
+    EXPECT_EQ((countDirs(Depth) + 1) * FilesPerDir, visitor.file_count);
+    EXPECT_EQ(0, visitor.error_count);
+    // Not requested.
+    EXPECT_EQ(0, visitor.file_size);
+  }
+}
+
+TEST_F(ParallelDirectoryWalkerTest, Sizes) {
+  ParallelDirectoryWalker::Options options;
+  options.want_sizes = true;
+
+  CountingVisitor visitor;
+  ParallelDirectoryWalker::walk(temp_dir_.path(), visitor, options);
+  EXPECT_EQ(expected_file_size_, visitor.file_size);
+
+  // Directories count too.
+  EXPECT_EQ(static_cast<uint64_t>(visitor.total_size), ParallelDirectoryWalker::computeSize(temp_dir_.path()));
+  EXPECT_EQ(static_cast<uint64_t>(visitor.total_size), ParallelDirectoryWalker::computeSize(temp_dir_.path(), 1));
+}
+
+TEST_F(ParallelDirectoryWalkerTest, SkipDirectory) {
+  FilePath skipped_path = combineFilePaths(temp_dir_.path(), FilePath::fromString("skipped"));
+  Directory::create(skipped_path);
+  createTree(skipped_path, 1);
+
+  CountingVisitor visitor;
+  visitor.skip_name = FilePath::fromString("skipped");
+  ParallelDirectoryWalker::walk(temp_dir_.path(), visitor);
+
+  // Skipped directory is reported, but not its content.
+  EXPECT_EQ(countDirs(Depth) + 1, visitor.dir_count);
+  EXPECT_EQ((countDirs(Depth) + 1) * FilesPerDir, visitor.file_count);
+}
+
+TEST_F(ParallelDirectoryWalkerTest, SymbolicLinksAreNotFollowed) {
+  FilePath link_path = combineFilePaths(temp_dir_.path(), FilePath::fromString("dir0"), FilePath::fromString("loop"));
+  ASSERT_EQ(0, ::symlink(toNullTerminated(temp_dir_.path()), toNullTerminated(link_path)));
+
+  CountingVisitor visitor;
+  ParallelDirectoryWalker::walk(temp_dir_.path(), visitor);
+  EXPECT_EQ(1, visitor.symlink_count);
+  EXPECT_EQ(countDirs(Depth), visitor.dir_count);
+}
+
+TEST_F(ParallelDirectoryWalkerTest, MissingRoot) {
+  CountingVisitor visitor;
+  FilePath missing_path = combineFilePaths(temp_dir_.path(), FilePath::fromString("missing"));
+  EXPECT_THROW(ParallelDirectoryWalker::walk(missing_path, visitor), FileSystemException);
+}
+
+TEST_F(ParallelDirectoryWalkerTest, VisitorThrows) {
+  const int ThreadCounts[] = { 1, 2, 8 };
+  for (int thread_count : ThreadCounts) {
+    ParallelDirectoryWalker::Options options;
+    options.thread_count = thread_count;
+
+    // Every directory above the last level has a subdirectory with this
+    // name, so several threads may throw at once.
+    ThrowingVisitor visitor;
+    visitor.throw_name = FilePath::fromString("dir1");
+    EXPECT_THROW(ParallelDirectoryWalker::walk(temp_dir_.path(), visitor, options), NotSupportedException);
+  }
+}
+
+} // namespace stp
@@ -9,12 +9,13 @@
 #include "Base/FileSystem/FilePathWriter.h"
 #include "Base/FileSystem/FileSystemException.h"
 #include "Base/FileSystem/KnownPaths.h"
-#include "Base/Io/StringWriter.h"
-#include "Base/Process/NativeProcess.h"
-#include "Base/Crypto/CryptoRandom.h"
 
-#if OS(POSIX)
-#include "Base/Posix/EintrWrapper.h"
+#if OS(WIN)
+#include "Base/Crypto/CryptoRandom.h"
+#include "Base/Process/NativeProcess.h"
+#include "Base/Win/WinErrorCode.h"
+#elif OS(POSIX)
+#include "Base/Posix/PosixErrorCode.h"
 #endif
 
 namespace stp {
@@ -38,7 +39,7 @@ TemporaryDirectory::~TemporaryDirectory() {
   if (isValid()) {
     try {
       remove();
-    } catch (IoException& exception) {
+    } catch (FileSystemException&) {
       LOG(ERROR, "could not delete temp dir in dtor");
     }
   }
@@ -101,7 +102,7 @@ void TemporaryDirectory::remove() {
 
 #if OS(WIN)
 void TemporaryDirectory::createInternal(FilePathSpan base_dir, StringSpan prefix) {
-  FilePath sub_dir = base_dir;
+  FilePath sub_dir(base_dir);
 
   CryptoRandom rng;
   for (int count = 0; count < 50; ++count) {
@@ -111,39 +112,39 @@ void TemporaryDirectory::createInternal(FilePathSpan base_dir, StringSpan prefix
 
     writer.ensureSeparator();
     writer << prefix;
-    writer << NativeProcess::GetCurrentId();
+    writer << NativeProcess::getCurrentId();
     writer << '_';
-    writer << rng.NextUInt32();
+    writer << rng.nextUint32();
 
     if (::CreateDirectoryW(toNullTerminated(sub_dir), NULL)) {
       path_ = move(sub_dir);
       return;
     }
 
-    if (::GetLastError() != ERROR_ALREADY_EXISTS)
-      throw FileSystemException(getLastWinErrorCode();
+    auto error_code = getLastWinErrorCode();
+    if (error_code != WinErrorCode::AlreadyExists)
+      throw FileSystemException(error_code, sub_dir);
 
-    sub_dir.TruncateCharacters(base_dir.size());
+    sub_dir.truncate(base_dir.size());
   }
-  throw FileException() << "unable to create temporary directory with unique name" << base_dir;
+  // Unable to create temporary directory with unique name.
+  throw FileSystemException(WinErrorCode::AlreadyExists, base_dir);
 }
 #elif OS(POSIX)
 void TemporaryDirectory::createInternal(FilePathSpan base_dir, StringSpan prefix) {
-  String tmpl = String::ConcatArgs(".stp.", prefix, ".XXXXXX");
-
-  FilePath sub_dir;
-  sub_dir.ensureCapacity(base_dir.size() + tmpl.size() + 1);
-  sub_dir = base_dir;
+  FilePath sub_dir(base_dir);
 
   FilePathWriter writer(sub_dir);
   writer.ensureSeparator();
-  writer << tmpl;
+  writer << ".stp.";
+  writer << prefix;
+  writer << ".XXXXXX";
 
   // this should be OK since mkdtemp just replaces characters in place
   char* buffer = const_cast<char*>(toNullTerminated(sub_dir));
   char* dtemp = ::mkdtemp(buffer);
   if (!dtemp)
-    throw FileSystemException(getLastPosixErrorCode());
+    throw FileSystemException(getLastPosixErrorCode(), base_dir);
   ASSERT(dtemp == buffer);
 
   path_ = move(sub_dir);
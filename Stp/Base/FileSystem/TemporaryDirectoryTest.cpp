@@ -5,42 +5,44 @@
 
 #include "Base/FileSystem/TemporaryDirectory.h"
 
-#include "Base/FileSystem/File.h"
+#include "Base/FileSystem/Directory.h"
+#include "Base/FileSystem/KnownPaths.h"
 #include "Base/Test/GTest.h"
 
 namespace stp {
 
 TEST(TemporaryDirectory, FullPath) {
-  FilePath test_path;
-  CreateNewTempDirectory(FILE_PATH_LITERAL("scoped_temp_dir"), &test_path);
+  TemporaryDirectory base_dir;
+  base_dir.create();
+  FilePath test_path = combineFilePaths(base_dir.path(), FilePath::fromString("scoped_temp_dir"));
 
-  // Against an existing dir, it should get destroyed when leaving scope.
-  EXPECT_TRUE(DirectoryExists(test_path));
+  // The directory does not exist, so ensure that it gets created and then
+  // destroyed when leaving scope.
+  EXPECT_FALSE(Directory::exists(test_path));
   {
     TemporaryDirectory dir;
-    EXPECT_TRUE(dir.set(test_path));
+    dir.create(test_path);
     EXPECT_TRUE(dir.isValid());
+    EXPECT_TRUE(Directory::exists(test_path));
   }
-  EXPECT_FALSE(DirectoryExists(test_path));
+  EXPECT_FALSE(Directory::exists(test_path));
 
   {
     TemporaryDirectory dir;
-    EXPECT_TRUE(dir.set(test_path));
-    // Now the dir doesn't exist, so ensure that it gets created.
-    EXPECT_TRUE(DirectoryExists(test_path));
-    // When we call release(), it shouldn't get destroyed when leaving scope.
+    dir.create(test_path);
+    // When we call take(), it shouldn't get destroyed when leaving scope.
     FilePath path = dir.take();
-    EXPECT_EQ(path.chars, test_path.chars);
+    EXPECT_TRUE(path == test_path);
     EXPECT_FALSE(dir.isValid());
   }
-  EXPECT_TRUE(DirectoryExists(test_path));
+  EXPECT_TRUE(Directory::exists(test_path));
 
-  // Clean up.
+  // Against an existing directory, it should get destroyed when leaving scope.
   {
     TemporaryDirectory dir;
-    EXPECT_TRUE(dir.set(test_path));
+    dir.create(test_path);
   }
-  EXPECT_FALSE(DirectoryExists(test_path));
+  EXPECT_FALSE(Directory::exists(test_path));
 }
 
 TEST(TemporaryDirectory, TempDir) {
@@ -49,63 +51,49 @@ TEST(TemporaryDirectory, TempDir) {
   FilePath test_path;
   {
     TemporaryDirectory dir;
-    EXPECT_TRUE(dir.create());
+    dir.create();
     test_path = dir.path();
-    EXPECT_TRUE(DirectoryExists(test_path));
-    FilePath tmp_dir;
-    EXPECT_TRUE(GetTempDir(&tmp_dir));
-    EXPECT_TRUE(test_path.chars.find(tmp_dir.chars) != std::string::npos);
+    EXPECT_TRUE(Directory::exists(test_path));
+    FilePath temp_dir = getTempDirPath();
+    ASSERT_LT(temp_dir.size(), test_path.size());
+    EXPECT_TRUE(test_path.slice(0, temp_dir.size()) == temp_dir.toSpan());
   }
-  EXPECT_FALSE(DirectoryExists(test_path));
+  EXPECT_FALSE(Directory::exists(test_path));
 }
 
 TEST(TemporaryDirectory, UniqueTempDirUnderPath) {
   // Create a path which will contain a unique temp path.
-  FilePath base_path;
-  ASSERT_TRUE(CreateNewTempDirectory(FILE_PATH_LITERAL("base_dir"),
-                                           &base_path));
+  TemporaryDirectory base_dir;
+  base_dir.create();
+  FilePath base_path = combineFilePaths(base_dir.path(), FilePath::fromString("base_dir"));
 
   FilePath test_path;
   {
     TemporaryDirectory dir;
-    EXPECT_TRUE(dir.createUnder(base_path));
+    dir.createUnder(base_path);
     test_path = dir.path();
-    EXPECT_TRUE(DirectoryExists(test_path));
-    EXPECT_TRUE(base_path.IsParent(test_path));
-    EXPECT_TRUE(test_path.chars.find(base_path.chars) != std::string::npos);
+    EXPECT_TRUE(Directory::exists(test_path));
+    EXPECT_TRUE(test_path.getDirectoryName() == base_path.toSpan());
   }
-  EXPECT_FALSE(DirectoryExists(test_path));
-  DeleteFile(base_path, true);
+  EXPECT_FALSE(Directory::exists(test_path));
+  EXPECT_TRUE(Directory::exists(base_path));
 }
 
 TEST(TemporaryDirectory, MultipleInvocations) {
   TemporaryDirectory dir;
-  EXPECT_TRUE(dir.create());
-  EXPECT_FALSE(dir.create());
-  EXPECT_TRUE(dir.remove());
-  EXPECT_TRUE(dir.create());
-  EXPECT_FALSE(dir.create());
-  TemporaryDirectory other_dir;
-  EXPECT_TRUE(other_dir.set(dir.take()));
-  EXPECT_TRUE(dir.create());
-  EXPECT_FALSE(dir.create());
-  EXPECT_FALSE(other_dir.create());
-}
+  dir.create();
+  FilePath first_path = dir.path();
+  dir.remove();
+  EXPECT_FALSE(dir.isValid());
+  EXPECT_FALSE(Directory::exists(first_path));
 
-#if OS(WIN)
-TEST(TemporaryDirectory, LockedTempDir) {
-  TemporaryDirectory dir;
-  EXPECT_TRUE(dir.create());
-  File file(dir.path().append(FILE_PATH_LITERAL("temp")),
-                  File::FLAG_CREATE_ALWAYS | File::FLAG_WRITE);
-  EXPECT_TRUE(file.isValid());
-  EXPECT_EQ(File::FILE_OK, file.error_details());
-  EXPECT_FALSE(dir.remove());  // We should not be able to delete.
-  EXPECT_FALSE(dir.path().empty());  // We should still have a valid path.
-  file.Close();
-  // Now, we should be able to delete.
-  EXPECT_TRUE(dir.remove());
+  dir.create();
+  TemporaryDirectory other_dir;
+  other_dir.create(dir.take());
+  dir.create();
+  EXPECT_TRUE(dir.path() != other_dir.path().toSpan());
+  EXPECT_TRUE(Directory::exists(dir.path()));
+  EXPECT_TRUE(Directory::exists(other_dir.path()));
 }
-#endif // OS(WIN)
 
 } // namespace stp
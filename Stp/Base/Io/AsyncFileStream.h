@@ -0,0 +1,45 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#ifndef STP_BASE_IO_ASYNCFILESTREAM_H_
+#define STP_BASE_IO_ASYNCFILESTREAM_H_
+
+#include "Base/Io/FileStream.h"
+#include "Base/Io/IoRing.h"
+
+namespace stp {
+
+// Issues positional reads and writes on an open FileStream through IoRing.
+// Neither the stream nor the ring is owned; both must outlive all operations
+// queued through this object.
+class AsyncFileStream {
+ public:
+  AsyncFileStream(IoRing& ring, FileStream& stream)
+      : ring_(ring), stream_(stream) {
+    ASSERT(stream.isOpen());
+  }
+
+  // Operation starts with next IoRing::submit().
+  void positionalReadAsync(int64_t offset, MutableBufferSpan output, IoRing::Callback callback) {
+    ASSERT(stream_.canRead());
+    ring_.queueRead(stream_.getNativeFile(), offset, output, move(callback));
+  }
+
+  void positionalWriteAsync(int64_t offset, BufferSpan input, IoRing::Callback callback) {
+    ASSERT(stream_.canWrite());
+    ring_.queueWrite(stream_.getNativeFile(), offset, input, move(callback));
+  }
+
+  IoRing& getRing() { return ring_; }
+  FileStream& getStream() { return stream_; }
+
+ private:
+  IoRing& ring_;
+  FileStream& stream_;
+
+  DISALLOW_COPY_AND_ASSIGN(AsyncFileStream);
+};
+
+} // namespace stp
+
+#endif // STP_BASE_IO_ASYNCFILESTREAM_H_
@@ -6,6 +6,7 @@
 #include "Base/Io/Base64.h"
 
 #include "Base/Io/Base64Data.h"
+#include "Base/Io/TextWriter.h"
 
 namespace stp {
 
@@ -18,6 +19,17 @@ String Base64::encode(BufferSpan input) {
   return out;
 }
 
+void Base64::encode(TextWriter& out, BigBufferSpan input) {
+  // Multiple of 3, so padding is emitted for the last chunk only.
+  constexpr int ChunkSize = 3 * 1024;
+  char text[ChunkSize / 3 * 4 + 1];
+
+  for (BufferSpan chunk : input.chunks(ChunkSize)) {
+    int length = encode(MutableStringSpan(text, isizeof(text)), chunk);
+    out << StringSpan(text, length);
+  }
+}
+
 int Base64::encode(MutableStringSpan output, BufferSpan input) {
   char* p = output.data();
 
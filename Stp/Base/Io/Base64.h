@@ -4,6 +4,7 @@
 #ifndef STP_BASE_IO_BASE64_H_
 #define STP_BASE_IO_BASE64_H_
 
+#include "Base/Containers/BigBufferSpan.h"
 #include "Base/Containers/Buffer.h"
 #include "Base/Containers/List.h"
 
@@ -15,6 +16,10 @@ class BASE_EXPORT Base64 {
   // Encodes the input bytes in base64.
   static String encode(BufferSpan input);
 
+  // Encodes the input bytes in base64 and writes them to |out|.
+  // Input is processed in pieces, so it can be larger than a String can hold.
+  static void encode(TextWriter& out, BigBufferSpan input);
+
   // Decodes the base64 input string.
   [[nodiscard]] static bool tryDecode(StringSpan input, Buffer& output);
 
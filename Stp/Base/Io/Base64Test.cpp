@@ -3,6 +3,7 @@
 
 #include "Base/Io/Base64.h"
 
+#include "Base/Io/StringWriter.h"
 #include "Base/Test/GTest.h"
 
 namespace stp {
@@ -19,4 +20,19 @@ TEST(Base64Test, Basic) {
   EXPECT_EQ(input, decoded);
 }
 
+TEST(Base64Test, EncodeInChunks) {
+  // Spans several internal chunks and needs padding at the end.
+  const int InputSize = 10000;
+  List<byte_t> input;
+  byte_t* input_data = input.appendUninitialized(InputSize);
+  for (int i = 0; i < InputSize; ++i)
+    input_data[i] = static_cast<byte_t>(i * 13);
+  BufferSpan input_span(input.data(), input.size());
+
+  String encoded;
+  StringWriter writer(&encoded);
+  Base64::encode(writer, BigBufferSpan(input_span));
+  EXPECT_EQ(Base64::encode(input_span), encoded);
+}
+
 } // namespace stp
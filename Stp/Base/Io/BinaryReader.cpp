@@ -0,0 +1,144 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Io/BinaryReader.h"
+
+#include "Base/Error/BasicExceptions.h"
+#include "Base/Io/IoException.h"
+#include "Base/Io/Stream.h"
+#include "Base/Memory/Allocate.h"
+
+namespace stp {
+
+BinaryReader::BinaryReader(Stream* stream, Endianness endianness, int buffer_capacity)
+    : stream_(*stream),
+      buffer_capacity_(max(buffer_capacity, MinBufferCapacity)),
+      endianness_(endianness) {
+  buffer_ = static_cast<byte_t*>(allocateMemory(buffer_capacity_));
+}
+
+BinaryReader::~BinaryReader() {
+  freeMemory(buffer_);
+}
+
+uint32_t BinaryReader::readVarUInt32() {
+  uint64_t x = readVarUInt64();
+  if (UNLIKELY(x > Limits<uint32_t>::Max))
+    throw FormatException("varint");
+  return static_cast<uint32_t>(x);
+}
+
+uint64_t BinaryReader::readVarUInt64() {
+  // Decode directly from the buffer if longest encoding fits in.
+  if (UNLIKELY(getBufferedSize() < MaxVarInt64Length))
+    return readVarUInt64Slow();
+
+  const byte_t* input = buffer_ + read_pos_;
+  uint64_t x = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    byte_t b = *input++;
+    x |= static_cast<uint64_t>(b & 0x7F) << shift;
+    if (b < 0x80) {
+      // Last byte may hold only a single bit.
+      if (shift == 63 && b > 1)
+        break;
+      read_pos_ = static_cast<int>(input - buffer_);
+      return x;
+    }
+  }
+  throw FormatException("varint");
+}
+
+uint64_t BinaryReader::readVarUInt64Slow() {
+  uint64_t x = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    byte_t b = readUInt8();
+    x |= static_cast<uint64_t>(b & 0x7F) << shift;
+    if (b < 0x80) {
+      if (shift == 63 && b > 1)
+        break;
+      return x;
+    }
+  }
+  throw FormatException("varint");
+}
+
+String BinaryReader::readString(int max_length) {
+  uint32_t length = readVarUInt32();
+  if (length > static_cast<uint32_t>(max_length))
+    throw FormatException("string");
+
+  char* data;
+  String result = String::createUninitialized(static_cast<int>(length), data);
+  readBytes(MutableBufferSpan(data, static_cast<int>(length)));
+  return result;
+}
+
+Buffer BinaryReader::readBuffer(int max_size) {
+  uint32_t size = readVarUInt32();
+  if (size > static_cast<uint32_t>(max_size))
+    throw FormatException("buffer");
+
+  Buffer result;
+  void* data = result.appendUninitialized(static_cast<int>(size));
+  readBytes(MutableBufferSpan(data, static_cast<int>(size)));
+  return result;
+}
+
+void BinaryReader::readBytes(MutableBufferSpan output) {
+  auto* output_data = static_cast<byte_t*>(output.data());
+  int size = output.size();
+
+  int buffered_size = min(getBufferedSize(), size);
+  ::memcpy(output_data, buffer_ + read_pos_, toUnsigned(buffered_size));
+  read_pos_ += buffered_size;
+  output_data += buffered_size;
+  size -= buffered_size;
+  if (size == 0)
+    return;
+
+  if (size >= buffer_capacity_) {
+    // Large blocks are not copied through the buffer.
+    stream_.read(MutableBufferSpan(output_data, size));
+    return;
+  }
+  fillBuffer(size);
+  ::memcpy(output_data, buffer_ + read_pos_, toUnsigned(size));
+  read_pos_ += size;
+}
+
+bool BinaryReader::isAtEnd() {
+  return getBufferedSize() == 0 && !tryFillBuffer(1);
+}
+
+void BinaryReader::fillBuffer(int size) {
+  if (!tryFillBuffer(size))
+    throw EndOfStreamException();
+}
+
+bool BinaryReader::tryFillBuffer(int size) {
+  ASSERT(size <= buffer_capacity_);
+  int buffered_size = getBufferedSize();
+  if (read_pos_ > 0) {
+    ::memmove(buffer_, buffer_ + read_pos_, toUnsigned(buffered_size));
+    read_pos_ = 0;
+    read_end_ = buffered_size;
+  }
+  while (read_end_ < size) {
+    int rv = stream_.readAtMost(MutableBufferSpan(buffer_ + read_end_, buffer_capacity_ - read_end_));
+    if (rv <= 0)
+      return false;
+    read_end_ += rv;
+  }
+  return true;
+}
+
+void BinaryReader::swapItems(void* data, int item_size, int count) {
+  auto* item = static_cast<byte_t*>(data);
+  for (int i = 0; i < count; ++i, item += item_size) {
+    for (int j = 0; j < item_size / 2; ++j)
+      swap(item[j], item[item_size - 1 - j]);
+  }
+}
+
+} // namespace stp
@@ -0,0 +1,136 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#ifndef STP_BASE_IO_BINARYREADER_H_
+#define STP_BASE_IO_BINARYREADER_H_
+
+#include "Base/Compiler/Endianness.h"
+#include "Base/Containers/Buffer.h"
+#include "Base/Containers/Span.h"
+#include "Base/String/String.h"
+#include "Base/Type/Limits.h"
+#include "Base/Type/Variable.h"
+#include "Base/Util/SwapBytes.h"
+
+#include <string.h>
+
+namespace stp {
+
+class Stream;
+
+// Reads values written by BinaryWriter.
+//
+// Input is buffered, so the reader may consume more from the stream than
+// it returns. Throws EndOfStreamException when stream ends in the middle of
+// a value and FormatException for malformed varint or too long string.
+class BASE_EXPORT BinaryReader {
+  DISALLOW_COPY_AND_ASSIGN(BinaryReader);
+ public:
+  static constexpr int DefaultBufferCapacity = 4096;
+
+  // Smaller capacity given to constructor is rounded up.
+  static constexpr int MinBufferCapacity = 64;
+
+  explicit BinaryReader(
+      Stream* stream, Endianness endianness = Endianness::Little,
+      int buffer_capacity = DefaultBufferCapacity);
+  ~BinaryReader();
+
+  Stream& getStream() const { return stream_; }
+  Endianness getEndianness() const { return endianness_; }
+
+  uint8_t readUInt8();
+  int8_t readInt8() { return static_cast<int8_t>(readUInt8()); }
+  bool readBool() { return readUInt8() != 0; }
+
+  uint16_t readUInt16() { return readFixed<uint16_t>(); }
+  int16_t readInt16() { return readFixed<int16_t>(); }
+  uint32_t readUInt32() { return readFixed<uint32_t>(); }
+  int32_t readInt32() { return readFixed<int32_t>(); }
+  uint64_t readUInt64() { return readFixed<uint64_t>(); }
+  int64_t readInt64() { return readFixed<int64_t>(); }
+  float readFloat() { return bitCast<float>(readFixed<uint32_t>()); }
+  double readDouble() { return bitCast<double>(readFixed<uint64_t>()); }
+
+  uint32_t readVarUInt32();
+  uint64_t readVarUInt64();
+  int32_t readVarInt32() { return zigZagDecode(readVarUInt32()); }
+  int64_t readVarInt64() { return zigZagDecode(readVarUInt64()); }
+
+  // Reads length-prefixed data. Length above |max_length| is treated as
+  // malformed input, so corrupted data does not make the reader allocate
+  // huge amount of memory.
+  String readString(int max_length = Limits<int>::Max);
+  Buffer readBuffer(int max_size = Limits<int>::Max);
+
+  // Fills |output| completely.
+  void readBytes(MutableBufferSpan output);
+
+  // Counterpart of BinaryWriter::writeSpan().
+  template<typename T>
+  void readSpan(MutableSpan<T> items);
+
+  // Returns true if all data was consumed. May block to find out.
+  bool isAtEnd();
+
+  static int32_t zigZagDecode(uint32_t x) {
+    return static_cast<int32_t>((x >> 1) ^ (0u - (x & 1)));
+  }
+  static int64_t zigZagDecode(uint64_t x) {
+    return static_cast<int64_t>((x >> 1) ^ (UINT64_C(0) - (x & 1)));
+  }
+
+ private:
+  static constexpr int MaxVarInt64Length = 10;
+
+  Stream& stream_;
+  byte_t* buffer_;
+  int buffer_capacity_;
+  // Unread data is |buffer_[read_pos_, read_end_)|.
+  int read_pos_ = 0;
+  int read_end_ = 0;
+  Endianness endianness_;
+
+  int getBufferedSize() const { return read_end_ - read_pos_; }
+
+  // Reads from stream until at least |size| bytes are buffered.
+  void fillBuffer(int size);
+  // Returns false if stream ended before |size| bytes were buffered.
+  bool tryFillBuffer(int size);
+
+  uint64_t readVarUInt64Slow();
+  void swapItems(void* data, int item_size, int count);
+
+  template<typename T>
+  T readFixed();
+};
+
+template<typename T>
+inline T BinaryReader::readFixed() {
+  if (UNLIKELY(getBufferedSize() < isizeof(T)))
+    fillBuffer(isizeof(T));
+  T x;
+  ::memcpy(&x, buffer_ + read_pos_, sizeof(T));
+  read_pos_ += isizeof(T);
+  if (endianness_ != Endianness::Native)
+    x = swapBytes(x);
+  return x;
+}
+
+inline uint8_t BinaryReader::readUInt8() {
+  if (UNLIKELY(getBufferedSize() < 1))
+    fillBuffer(1);
+  return buffer_[read_pos_++];
+}
+
+template<typename T>
+inline void BinaryReader::readSpan(MutableSpan<T> items) {
+  static_assert(TIsTriviallyCopyable<T>, "!");
+  readBytes(MutableBufferSpan(static_cast<void*>(items.data()), items.size() * isizeof(T)));
+  if (TIsArithmetic<T> && sizeof(T) > 1 && endianness_ != Endianness::Native)
+    swapItems(items.data(), isizeof(T), items.size());
+}
+
+} // namespace stp
+
+#endif // STP_BASE_IO_BINARYREADER_H_
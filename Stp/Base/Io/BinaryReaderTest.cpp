@@ -0,0 +1,177 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Io/BinaryReader.h"
+
+#include "Base/Error/BasicExceptions.h"
+#include "Base/Io/BinaryWriter.h"
+#include "Base/Io/IoException.h"
+#include "Base/Io/MemoryStream.h"
+#include "Base/Test/GTest.h"
+
+namespace stp {
+
+namespace {
+
+struct Record {
+  int32_t id;
+  float weight;
+  uint8_t flags;
+};
+
+class BinaryReaderTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    stream_.openNewBytes();
+  }
+
+  void openBytes(std::initializer_list<byte_t> bytes) {
+    for (byte_t b : bytes)
+      stream_.writeByte(b);
+    stream_.setPosition(0);
+  }
+
+  MemoryStream stream_;
+};
+
+} // namespace
+
+TEST_F(BinaryReaderTest, RoundTrip) {
+  const Endianness Endiannesses[] = { Endianness::Little, Endianness::Big };
+  for (Endianness endianness : Endiannesses) {
+    stream_.setLength(0);
+    stream_.setPosition(0);
+
+    BinaryWriter writer(&stream_, endianness);
+    writer.writeBool(true);
+    writer.writeInt8(-5);
+    writer.writeUInt16(0xBEEF);
+    writer.writeInt32(-123456789);
+    writer.writeUInt64(UINT64_C(0x0123456789ABCDEF));
+    writer.writeFloat(3.5f);
+    writer.writeDouble(-0.25);
+    writer.writeVarUInt32(Limits<uint32_t>::Max);
+    writer.writeVarInt32(Limits<int32_t>::Min);
+    writer.writeVarInt64(-1);
+    writer.writeVarUInt64(Limits<uint64_t>::Max);
+    writer.writeString("text");
+    writer.flush();
+
+    stream_.setPosition(0);
+    BinaryReader reader(&stream_, endianness);
+    EXPECT_TRUE(reader.readBool());
+    EXPECT_EQ(-5, reader.readInt8());
+    EXPECT_EQ(0xBEEF, reader.readUInt16());
+    EXPECT_EQ(-123456789, reader.readInt32());
+    EXPECT_EQ(UINT64_C(0x0123456789ABCDEF), reader.readUInt64());
+    EXPECT_EQ(3.5f, reader.readFloat());
+    EXPECT_EQ(-0.25, reader.readDouble());
+    EXPECT_EQ(Limits<uint32_t>::Max, reader.readVarUInt32());
+    EXPECT_EQ(Limits<int32_t>::Min, reader.readVarInt32());
+    EXPECT_EQ(-1, reader.readVarInt64());
+    EXPECT_EQ(Limits<uint64_t>::Max, reader.readVarUInt64());
+    EXPECT_EQ(StringSpan("text"), reader.readString());
+    EXPECT_TRUE(reader.isAtEnd());
+  }
+}
+
+TEST_F(BinaryReaderTest, SmallBuffer) {
+  // Values straddle buffer boundary.
+  BinaryWriter writer(&stream_, Endianness::Little, BinaryWriter::MinBufferCapacity);
+  for (int i = 0; i < 1000; ++i) {
+    writer.writeVarInt64(static_cast<int64_t>(i) * i * i * i * i * (i % 2 ? -1 : 1));
+    writer.writeUInt32(static_cast<uint32_t>(i));
+  }
+  writer.flush();
+
+  stream_.setPosition(0);
+  BinaryReader reader(&stream_, Endianness::Little, BinaryReader::MinBufferCapacity);
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_EQ(static_cast<int64_t>(i) * i * i * i * i * (i % 2 ? -1 : 1), reader.readVarInt64());
+    ASSERT_EQ(static_cast<uint32_t>(i), reader.readUInt32());
+  }
+  EXPECT_TRUE(reader.isAtEnd());
+}
+
+TEST_F(BinaryReaderTest, Span) {
+  int32_t numbers[300];
+  Record records[100];
+  for (int i = 0; i < 300; ++i)
+    numbers[i] = i * 1000 - 7;
+  for (int i = 0; i < 100; ++i)
+    records[i] = Record { i, i * 0.5f, static_cast<uint8_t>(i) };
+
+  BinaryWriter writer(&stream_, Endianness::Big, BinaryWriter::MinBufferCapacity);
+  writer.writeSpan(makeSpan(numbers));
+  writer.writeSpan(makeSpan(records));
+  writer.flush();
+
+  int32_t read_numbers[300];
+  Record read_records[100];
+  stream_.setPosition(0);
+  BinaryReader reader(&stream_, Endianness::Big, BinaryReader::MinBufferCapacity);
+  reader.readSpan(makeSpan(read_numbers));
+  reader.readSpan(makeSpan(read_records));
+  for (int i = 0; i < 300; ++i)
+    ASSERT_EQ(numbers[i], read_numbers[i]);
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ(records[i].id, read_records[i].id);
+    ASSERT_EQ(records[i].weight, read_records[i].weight);
+    ASSERT_EQ(records[i].flags, read_records[i].flags);
+  }
+}
+
+TEST_F(BinaryReaderTest, Buffer) {
+  const byte_t Data[] = { 1, 2, 3 };
+  BinaryWriter writer(&stream_);
+  writer.writeBuffer(BufferSpan(Data));
+  writer.flush();
+
+  stream_.setPosition(0);
+  BinaryReader reader(&stream_);
+  Buffer buffer = reader.readBuffer();
+  EXPECT_EQ(BufferSpan(Data), BufferSpan(buffer));
+}
+
+TEST_F(BinaryReaderTest, EndOfStream) {
+  openBytes({ 0x01, 0x02, 0x03 });
+  BinaryReader reader(&stream_);
+  EXPECT_EQ(0x0201, reader.readUInt16());
+  EXPECT_FALSE(reader.isAtEnd());
+  EXPECT_THROW(reader.readUInt32(), EndOfStreamException);
+}
+
+TEST_F(BinaryReaderTest, TruncatedString) {
+  openBytes({ 0x05, 'a', 'b' });
+  BinaryReader reader(&stream_);
+  EXPECT_THROW(reader.readString(), EndOfStreamException);
+}
+
+TEST_F(BinaryReaderTest, MalformedVarInt) {
+  // Eleven bytes with continuation bit.
+  openBytes({ 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01 });
+  BinaryReader reader(&stream_);
+  EXPECT_THROW(reader.readVarUInt64(), FormatException);
+}
+
+TEST_F(BinaryReaderTest, VarIntOverflow) {
+  // Too large for 64 bits.
+  openBytes({ 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x02 });
+  BinaryReader reader(&stream_);
+  EXPECT_THROW(reader.readVarUInt64(), FormatException);
+}
+
+TEST_F(BinaryReaderTest, VarInt32Overflow) {
+  // 2^32
+  openBytes({ 0x80, 0x80, 0x80, 0x80, 0x10 });
+  BinaryReader reader(&stream_);
+  EXPECT_THROW(reader.readVarUInt32(), FormatException);
+}
+
+TEST_F(BinaryReaderTest, StringTooLong) {
+  openBytes({ 0x05, 'a', 'b', 'c', 'd', 'e' });
+  BinaryReader reader(&stream_);
+  EXPECT_THROW(reader.readString(4), FormatException);
+}
+
+} // namespace stp
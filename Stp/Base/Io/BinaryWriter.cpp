@@ -0,0 +1,80 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Io/BinaryWriter.h"
+
+#include "Base/Io/Stream.h"
+#include "Base/Memory/Allocate.h"
+
+namespace stp {
+
+BinaryWriter::BinaryWriter(Stream* stream, Endianness endianness, int buffer_capacity)
+    : stream_(*stream),
+      buffer_capacity_(max(buffer_capacity, MinBufferCapacity)),
+      endianness_(endianness) {
+  buffer_ = static_cast<byte_t*>(allocateMemory(buffer_capacity_));
+}
+
+BinaryWriter::~BinaryWriter() {
+  freeMemory(buffer_);
+}
+
+void BinaryWriter::writeVarUInt64(uint64_t x) {
+  if (UNLIKELY(!hasRoomFor(MaxVarInt64Length)))
+    flushBuffer();
+
+  byte_t* out = buffer_ + buffer_size_;
+  while (x >= 0x80) {
+    *out++ = static_cast<byte_t>(x | 0x80);
+    x >>= 7;
+  }
+  *out++ = static_cast<byte_t>(x);
+  buffer_size_ = static_cast<int>(out - buffer_);
+}
+
+void BinaryWriter::writeBuffer(BufferSpan data) {
+  writeVarUInt32(static_cast<uint32_t>(data.size()));
+  writeBytes(data);
+}
+
+void BinaryWriter::writeBytes(BufferSpan data) {
+  if (hasRoomFor(data.size())) {
+    ::memcpy(buffer_ + buffer_size_, data.data(), toUnsigned(data.size()));
+    buffer_size_ += data.size();
+    return;
+  }
+  flushBuffer();
+  if (data.size() >= buffer_capacity_) {
+    // Large blocks are not copied through the buffer.
+    stream_.write(data);
+  } else {
+    ::memcpy(buffer_, data.data(), toUnsigned(data.size()));
+    buffer_size_ = data.size();
+  }
+}
+
+void BinaryWriter::writeSwapped(const void* data, int item_size, int count) {
+  auto* input = static_cast<const byte_t*>(data);
+  for (int i = 0; i < count; ++i, input += item_size) {
+    if (UNLIKELY(!hasRoomFor(item_size)))
+      flushBuffer();
+    byte_t* output = buffer_ + buffer_size_;
+    for (int j = 0; j < item_size; ++j)
+      output[j] = input[item_size - 1 - j];
+    buffer_size_ += item_size;
+  }
+}
+
+void BinaryWriter::flush() {
+  flushBuffer();
+  stream_.flush();
+}
+
+void BinaryWriter::flushBuffer() {
+  if (buffer_size_ == 0)
+    return;
+  stream_.write(BufferSpan(buffer_, buffer_size_));
+  buffer_size_ = 0;
+}
+
+} // namespace stp
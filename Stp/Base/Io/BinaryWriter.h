@@ -0,0 +1,136 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#ifndef STP_BASE_IO_BINARYWRITER_H_
+#define STP_BASE_IO_BINARYWRITER_H_
+
+#include "Base/Compiler/Endianness.h"
+#include "Base/Containers/BufferSpan.h"
+#include "Base/Containers/Span.h"
+#include "Base/String/StringSpan.h"
+#include "Base/Type/Variable.h"
+#include "Base/Util/SwapBytes.h"
+
+#include <string.h>
+
+namespace stp {
+
+class Stream;
+
+// Writes values in binary form to a stream.
+//
+// Fixed-width numbers are written in endianness given at construction.
+// Variable-length integers are LEB128 encoded, signed ones are zigzag encoded
+// first, so numbers close to zero take a single byte regardless of sign.
+// Strings and buffers are prefixed with their length written as varint.
+//
+// Output is buffered. Call flush() when done, data left in the buffer is
+// discarded on destruction.
+//
+// Use BinaryReader to read the data back.
+class BASE_EXPORT BinaryWriter {
+  DISALLOW_COPY_AND_ASSIGN(BinaryWriter);
+ public:
+  static constexpr int DefaultBufferCapacity = 4096;
+
+  // Longest LEB128 encoding of 64-bit integer.
+  static constexpr int MaxVarInt64Length = 10;
+
+  // Smaller capacity given to constructor is rounded up.
+  static constexpr int MinBufferCapacity = 64;
+
+  explicit BinaryWriter(
+      Stream* stream, Endianness endianness = Endianness::Little,
+      int buffer_capacity = DefaultBufferCapacity);
+  ~BinaryWriter();
+
+  Stream& getStream() const { return stream_; }
+  Endianness getEndianness() const { return endianness_; }
+
+  void writeUInt8(uint8_t x);
+  void writeInt8(int8_t x) { writeUInt8(static_cast<uint8_t>(x)); }
+  void writeBool(bool x) { writeUInt8(x ? 1 : 0); }
+
+  void writeUInt16(uint16_t x) { writeFixed(x); }
+  void writeInt16(int16_t x) { writeFixed(x); }
+  void writeUInt32(uint32_t x) { writeFixed(x); }
+  void writeInt32(int32_t x) { writeFixed(x); }
+  void writeUInt64(uint64_t x) { writeFixed(x); }
+  void writeInt64(int64_t x) { writeFixed(x); }
+  void writeFloat(float x) { writeFixed(bitCast<uint32_t>(x)); }
+  void writeDouble(double x) { writeFixed(bitCast<uint64_t>(x)); }
+
+  void writeVarUInt32(uint32_t x) { writeVarUInt64(x); }
+  void writeVarUInt64(uint64_t x);
+  void writeVarInt32(int32_t x) { writeVarUInt32(zigZagEncode(x)); }
+  void writeVarInt64(int64_t x) { writeVarUInt64(zigZagEncode(x)); }
+
+  // Length-prefixed.
+  void writeString(StringSpan text) { writeBuffer(BufferSpan(text.data(), text.length())); }
+  void writeBuffer(BufferSpan data);
+
+  // Writes bytes as they are, without length.
+  void writeBytes(BufferSpan data);
+
+  // Writes all items at once, without length.
+  // Arithmetic types are converted to writer's endianness (which costs
+  // nothing for native one). Other trivially copyable types are copied as
+  // laid out in memory, so they are portable only between compatible ABIs.
+  template<typename T>
+  void writeSpan(Span<T> items);
+  template<typename T>
+  void writeSpan(MutableSpan<T> items) { writeSpan(Span<T>(items)); }
+
+  void flush();
+
+  static uint32_t zigZagEncode(int32_t x) {
+    return (static_cast<uint32_t>(x) << 1) ^ static_cast<uint32_t>(x >> 31);
+  }
+  static uint64_t zigZagEncode(int64_t x) {
+    return (static_cast<uint64_t>(x) << 1) ^ static_cast<uint64_t>(x >> 63);
+  }
+
+ private:
+  Stream& stream_;
+  byte_t* buffer_;
+  int buffer_capacity_;
+  // Number of bytes in |buffer_|.
+  int buffer_size_ = 0;
+  Endianness endianness_;
+
+  bool hasRoomFor(int size) const { return buffer_capacity_ - buffer_size_ >= size; }
+  void flushBuffer();
+  void writeSwapped(const void* data, int item_size, int count);
+
+  template<typename T>
+  void writeFixed(T x);
+};
+
+template<typename T>
+inline void BinaryWriter::writeFixed(T x) {
+  if (endianness_ != Endianness::Native)
+    x = swapBytes(x);
+  if (UNLIKELY(!hasRoomFor(isizeof(T))))
+    flushBuffer();
+  ::memcpy(buffer_ + buffer_size_, &x, sizeof(T));
+  buffer_size_ += isizeof(T);
+}
+
+inline void BinaryWriter::writeUInt8(uint8_t x) {
+  if (UNLIKELY(!hasRoomFor(1)))
+    flushBuffer();
+  buffer_[buffer_size_++] = x;
+}
+
+template<typename T>
+inline void BinaryWriter::writeSpan(Span<T> items) {
+  static_assert(TIsTriviallyCopyable<T>, "!");
+  if (TIsArithmetic<T> && sizeof(T) > 1 && endianness_ != Endianness::Native)
+    writeSwapped(items.data(), isizeof(T), items.size());
+  else
+    writeBytes(BufferSpan(static_cast<const void*>(items.data()), items.size() * isizeof(T)));
+}
+
+} // namespace stp
+
+#endif // STP_BASE_IO_BINARYWRITER_H_
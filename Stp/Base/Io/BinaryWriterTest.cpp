@@ -0,0 +1,127 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Io/BinaryWriter.h"
+
+#include "Base/Containers/List.h"
+#include "Base/Io/MemoryStream.h"
+#include "Base/Test/GTest.h"
+
+namespace stp {
+
+namespace {
+
+class BinaryWriterTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    stream_.openNewBytes();
+  }
+
+  // Returns everything written so far.
+  List<byte_t> getOutput() {
+    int64_t size = stream_.getLength();
+    List<byte_t> output;
+    stream_.positionalRead(0, MutableBufferSpan(output.appendUninitialized(static_cast<int>(size)), static_cast<int>(size)));
+    return output;
+  }
+
+  void expectOutput(std::initializer_list<byte_t> expected) {
+    List<byte_t> output = getOutput();
+    ASSERT_EQ(static_cast<int>(expected.size()), output.size());
+    int i = 0;
+    for (byte_t b : expected)
+      EXPECT_EQ(b, output[i++]) << "at " << i - 1;
+  }
+
+  MemoryStream stream_;
+};
+
+} // namespace
+
+TEST_F(BinaryWriterTest, FixedLittleEndian) {
+  BinaryWriter writer(&stream_);
+  writer.writeUInt8(0x01);
+  writer.writeUInt16(0x0302);
+  writer.writeUInt32(0x07060504);
+  writer.writeInt64(-2);
+  writer.flush();
+  expectOutput({
+    0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+    0xFE, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+  });
+}
+
+TEST_F(BinaryWriterTest, FixedBigEndian) {
+  BinaryWriter writer(&stream_, Endianness::Big);
+  writer.writeUInt16(0x0102);
+  writer.writeUInt32(0x03040506);
+  writer.writeFloat(1.0f);
+  writer.flush();
+  expectOutput({ 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x3F, 0x80, 0x00, 0x00 });
+}
+
+TEST_F(BinaryWriterTest, VarInt) {
+  BinaryWriter writer(&stream_);
+  writer.writeVarUInt32(0);
+  writer.writeVarUInt32(127);
+  writer.writeVarUInt32(128);
+  writer.writeVarUInt32(300);
+  writer.writeVarInt32(-1);
+  writer.writeVarInt32(1);
+  writer.writeVarInt64(-65);
+  writer.flush();
+  expectOutput({ 0x00, 0x7F, 0x80, 0x01, 0xAC, 0x02, 0x01, 0x02, 0x81, 0x01 });
+}
+
+TEST_F(BinaryWriterTest, VarIntMax) {
+  BinaryWriter writer(&stream_);
+  writer.writeVarUInt64(Limits<uint64_t>::Max);
+  writer.flush();
+  expectOutput({ 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01 });
+}
+
+TEST_F(BinaryWriterTest, ZigZag) {
+  EXPECT_EQ(0u, BinaryWriter::zigZagEncode(0));
+  EXPECT_EQ(1u, BinaryWriter::zigZagEncode(-1));
+  EXPECT_EQ(2u, BinaryWriter::zigZagEncode(1));
+  EXPECT_EQ(Limits<uint32_t>::Max, BinaryWriter::zigZagEncode(Limits<int32_t>::Min));
+  EXPECT_EQ(Limits<uint64_t>::Max - 1, BinaryWriter::zigZagEncode(Limits<int64_t>::Max));
+}
+
+TEST_F(BinaryWriterTest, String) {
+  BinaryWriter writer(&stream_);
+  writer.writeString("abc");
+  writer.writeString(StringSpan());
+  writer.flush();
+  expectOutput({ 0x03, 'a', 'b', 'c', 0x00 });
+}
+
+TEST_F(BinaryWriterTest, SpanBigEndian) {
+  const uint16_t Items[] = { 0x0102, 0x0304 };
+  BinaryWriter writer(&stream_, Endianness::Big);
+  writer.writeSpan(makeSpan(Items));
+  writer.flush();
+  expectOutput({ 0x01, 0x02, 0x03, 0x04 });
+}
+
+TEST_F(BinaryWriterTest, LargerThanBuffer) {
+  List<byte_t> data;
+  byte_t* data_ptr = data.appendUninitialized(1000);
+  for (int i = 0; i < data.size(); ++i)
+    data_ptr[i] = static_cast<byte_t>(i);
+
+  BinaryWriter writer(&stream_, Endianness::Little, BinaryWriter::MinBufferCapacity);
+  for (int i = 0; i < 100; ++i)
+    writer.writeUInt32(static_cast<uint32_t>(i));
+  writer.writeBytes(BufferSpan(data.data(), data.size()));
+  writer.writeUInt8(0xAA);
+  writer.flush();
+
+  List<byte_t> output = getOutput();
+  ASSERT_EQ(100 * 4 + 1000 + 1, output.size());
+  EXPECT_EQ(99, output[99 * 4]);
+  EXPECT_EQ(BufferSpan(data.data(), data.size()), BufferSpan(output.data() + 400, 1000));
+  EXPECT_EQ(0xAA, output.last());
+}
+
+} // namespace stp
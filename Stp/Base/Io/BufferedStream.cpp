@@ -4,6 +4,7 @@
 #include "Base/Io/BufferedStream.h"
 
 #include "Base/Containers/ArrayOps.h"
+#include "Base/Containers/InlineList.h"
 #include "Base/Memory/Allocate.h"
 
 namespace stp {
@@ -189,11 +190,89 @@ void BufferedStream::write(BufferSpan input) {
     }
     ASSERT(wrote == input.size());
   } else {
-    flushWriteBuffer();
+    if (hasPendingWrite())
+      flushWriteBuffer();
     underlying_->write(input);
   }
 }
 
+int BufferedStream::readV(Span<MutableBufferSpan> outputs) {
+  ASSERT(canRead());
+
+  int total_count = 0;
+  for (const MutableBufferSpan& output : outputs)
+    total_count += output.size();
+  if (total_count < buffer_size_)
+    return Stream::readV(outputs);
+
+  // Drain the buffer into leading outputs, read the rest directly.
+  InlineList<MutableBufferSpan, 16> direct;
+  int from_buffer = 0;
+  for (MutableBufferSpan output : outputs) {
+    int count = readFromBuffer(output);
+    from_buffer += count;
+    if (count != output.size())
+      direct.add(output.slice(count));
+  }
+  if (direct.isEmpty())
+    return from_buffer;
+
+  if (hasPendingWrite()) {
+    flushWriteBuffer();
+  } else {
+    read_pos_ = 0;
+    read_len_ = 0;
+  }
+  return from_buffer + underlying_->readV(direct);
+}
+
+void BufferedStream::writeV(Span<BufferSpan> inputs) {
+  ASSERT(canWrite());
+
+  // Same heuristic as in write().
+  int total_count = write_pos_;
+  for (const BufferSpan& input : inputs)
+    total_count += input.size();
+  if (total_count <= buffer_size_ * 2) {
+    for (const BufferSpan& input : inputs)
+      write(input);
+    return;
+  }
+
+  if (write_pos_ == 0)
+    clearReadBufferBeforeWrite();
+
+  // Pending data goes first in the same system call.
+  InlineList<BufferSpan, 16> vectors;
+  vectors.ensureCapacity(inputs.size() + 1);
+  if (hasPendingWrite())
+    vectors.add(BufferSpan(buffer_, write_pos_));
+  vectors.append(inputs);
+
+  underlying_->writeV(vectors);
+  write_pos_ = 0;
+}
+
+int64_t BufferedStream::transferTo(Stream& target, int64_t max_count) {
+  ASSERT(canRead());
+  ASSERT(max_count >= 0);
+
+  int64_t transferred = 0;
+  if (hasPendingRead()) {
+    int count = static_cast<int>(min(static_cast<int64_t>(read_len_ - read_pos_), max_count));
+    target.write(BufferSpan(buffer_ + read_pos_, count));
+    read_pos_ += count;
+    transferred = count;
+    if (hasPendingRead())
+      return transferred;
+  } else if (hasPendingWrite()) {
+    flushWriteBuffer();
+  }
+  read_pos_ = 0;
+  read_len_ = 0;
+  return transferred + underlying_->transferTo(target, max_count - transferred);
+}
+
 void BufferedStream::writeByte(byte_t byte) {
   if (write_pos_ == 0) {
     ASSERT(canWrite());
@@ -36,6 +36,14 @@ class BASE_EXPORT BufferedStream final : public Stream {
   bool isOpen() const noexcept override;
   int readAtMost(MutableBufferSpan output) override;
   void write(BufferSpan input) override;
+  // Small requests go through the buffer. Large ones bypass it and are
+  // passed to underlying stream as a single vectored call, together with
+  // pending buffered data.
+  int readV(Span<MutableBufferSpan> outputs) override;
+  void writeV(Span<BufferSpan> inputs) override;
+  // Buffered data is written out first, the rest is transferred
+  // by underlying stream.
+  int64_t transferTo(Stream& target, int64_t max_count = Limits<int64_t>::Max) override;
   void writeByte(byte_t byte) override;
   int tryReadByte() override;
   int64_t seek(int64_t offset, SeekOrigin origin) override;
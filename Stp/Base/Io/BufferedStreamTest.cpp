@@ -0,0 +1,111 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Io/BufferedStream.h"
+
+#include "Base/Containers/List.h"
+#include "Base/Io/MemoryStream.h"
+#include "Base/Test/GTest.h"
+
+namespace stp {
+
+namespace {
+
+const int BufferSize = 64;
+
+List<byte_t> makePattern(int size, int seed) {
+  List<byte_t> pattern;
+  byte_t* data = pattern.appendUninitialized(size);
+  for (int i = 0; i < size; ++i)
+    data[i] = static_cast<byte_t>(i * 13 + seed);
+  return pattern;
+}
+
+BufferSpan toBuffer(const List<byte_t>& list) {
+  return BufferSpan(list.data(), list.size());
+}
+
+} // namespace
+
+TEST(BufferedStreamTest, WriteVSmall) {
+  MemoryStream memory;
+  memory.openNewBytes();
+
+  BufferedStream stream;
+  stream.setBufferSize(BufferSize);
+  stream.open(&memory);
+
+  auto header = makePattern(5, 1);
+  auto payload = makePattern(20, 2);
+  stream.writeV({ toBuffer(header), BufferSpan(), toBuffer(payload) });
+  // Everything fits in the buffer.
+  EXPECT_EQ(0, memory.getLength());
+
+  stream.flush();
+  ASSERT_EQ(25, memory.getLength());
+
+  List<byte_t> output;
+  memory.positionalRead(0, MutableBufferSpan(output.appendUninitialized(25), 25));
+  EXPECT_EQ(toBuffer(header), BufferSpan(output.data(), 5));
+  EXPECT_EQ(toBuffer(payload), BufferSpan(output.data() + 5, 20));
+}
+
+TEST(BufferedStreamTest, WriteVLarge) {
+  MemoryStream memory;
+  memory.openNewBytes();
+
+  BufferedStream stream;
+  stream.setBufferSize(BufferSize);
+  stream.open(&memory);
+
+  auto pending = makePattern(10, 3);
+  stream.write(toBuffer(pending));
+
+  auto first = makePattern(100, 4);
+  auto second = makePattern(200, 5);
+  stream.writeV({ toBuffer(first), toBuffer(second) });
+  // Pending data and both inputs are written through.
+  EXPECT_EQ(310, memory.getLength());
+  EXPECT_EQ(310, stream.getPosition());
+
+  List<byte_t> output;
+  memory.positionalRead(0, MutableBufferSpan(output.appendUninitialized(310), 310));
+  EXPECT_EQ(toBuffer(pending), BufferSpan(output.data(), 10));
+  EXPECT_EQ(toBuffer(first), BufferSpan(output.data() + 10, 100));
+  EXPECT_EQ(toBuffer(second), BufferSpan(output.data() + 110, 200));
+}
+
+TEST(BufferedStreamTest, ReadV) {
+  auto data = makePattern(500, 6);
+  MemoryStream memory;
+  memory.open(toBuffer(data));
+
+  BufferedStream stream;
+  stream.setBufferSize(BufferSize);
+  stream.open(&memory);
+
+  // Small read fills the buffer.
+  byte_t small[3];
+  byte_t other[7];
+  EXPECT_EQ(10, stream.readV({ MutableBufferSpan(small, 3), MutableBufferSpan(other, 7) }));
+  EXPECT_EQ(BufferSpan(data.data(), 3), BufferSpan(small, 3));
+  EXPECT_EQ(BufferSpan(data.data() + 3, 7), BufferSpan(other, 7));
+
+  // Large read drains the buffer first and then bypasses it.
+  List<byte_t> first;
+  List<byte_t> second;
+  MutableBufferSpan outputs[] = {
+    MutableBufferSpan(first.appendUninitialized(100), 100),
+    MutableBufferSpan(second.appendUninitialized(300), 300),
+  };
+  EXPECT_EQ(400, stream.readV(outputs));
+  EXPECT_EQ(BufferSpan(data.data() + 10, 100), toBuffer(first));
+  EXPECT_EQ(BufferSpan(data.data() + 110, 300), toBuffer(second));
+
+  // Only 90 bytes left.
+  EXPECT_EQ(90, stream.readV(outputs));
+  EXPECT_EQ(BufferSpan(data.data() + 410, 90), BufferSpan(first.data(), 90));
+  EXPECT_EQ(0, stream.readV(outputs));
+}
+
+} // namespace stp
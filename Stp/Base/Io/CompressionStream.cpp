@@ -0,0 +1,714 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Io/CompressionStream.h"
+
+#include "Base/Compress/Lz4.h"
+#include "Base/Error/BasicExceptions.h"
+#include "Base/Io/IoException.h"
+#include "Base/System/CpuInfo.h"
+#include "Base/Thread/Thread.h"
+
+#include <string.h>
+
+namespace stp {
+
+namespace {
+
+constexpr uint32_t Lz4Magic = 0x184D2204u;
+constexpr uint32_t Lz4SkippableMagic = 0x184D2A50u;
+constexpr uint32_t Lz4SkippableMagicMask = 0xFFFFFFF0u;
+constexpr uint32_t Lz4UncompressedBit = 0x80000000u;
+constexpr int Lz4MinBlockSizeId = 4;
+constexpr int Lz4MaxBlockSizeId = 7;
+// Linked blocks may refer to this much of preceding data.
+constexpr int Lz4HistorySize = 64 * 1024;
+
+// LZ4 frame descriptor flags.
+constexpr byte_t Lz4Version = 0x40;
+constexpr byte_t Lz4VersionMask = 0xC0;
+constexpr byte_t Lz4BlockIndependence = 0x20;
+constexpr byte_t Lz4BlockChecksum = 0x10;
+constexpr byte_t Lz4ContentSize = 0x08;
+constexpr byte_t Lz4ContentChecksum = 0x04;
+constexpr byte_t Lz4Reserved = 0x02;
+constexpr byte_t Lz4DictionaryId = 0x01;
+
+constexpr byte_t GzipId1 = 0x1F;
+constexpr byte_t GzipId2 = 0x8B;
+constexpr byte_t GzipDeflateMethod = 8;
+constexpr byte_t GzipUnknownOs = 0xFF;
+
+// gzip header flags.
+constexpr byte_t GzipHeaderCrc = 0x02;
+constexpr byte_t GzipExtra = 0x04;
+constexpr byte_t GzipName = 0x08;
+constexpr byte_t GzipComment = 0x10;
+constexpr byte_t GzipReserved = 0xE0;
+
+inline uint32_t loadLe32(const byte_t* p) {
+  uint32_t x;
+  ::memcpy(&x, p, sizeof(x));
+  return x;
+}
+
+inline void storeLe32(byte_t* p, uint32_t x) {
+  ::memcpy(p, &x, sizeof(x));
+}
+
+inline int getLz4BlockSize(int id) {
+  return 1 << (8 + 2 * id);
+}
+
+int getLz4BlockSizeId(int block_size) {
+  for (int id = Lz4MinBlockSizeId; id < Lz4MaxBlockSizeId; ++id) {
+    if (block_size <= getLz4BlockSize(id))
+      return id;
+  }
+  return Lz4MaxBlockSizeId;
+}
+
+inline byte_t getLz4HeaderChecksum(const byte_t* descriptor, int size) {
+  return static_cast<byte_t>(computeXxHash32(BufferSpan(descriptor, size)) >> 8);
+}
+
+} // namespace
+
+struct CompressionStream::Job {
+  List<byte_t> input;
+  List<byte_t> history;
+  List<byte_t> output;
+  bool final = false;
+  bool done = false;
+};
+
+class CompressionStream::Worker : public Thread {
+ public:
+  explicit Worker(CompressionStream* stream) : stream_(*stream) {
+    if (stream->format_ != CompressionFormat::Lz4)
+      encoder_ = OwnPtr<DeflateEncoder>::create(stream->level_);
+  }
+
+ protected:
+  int Main() override { stream_.workLoop(encoder_.get()); return 0; }
+
+ private:
+  CompressionStream& stream_;
+  OwnPtr<DeflateEncoder> encoder_;
+};
+
+CompressionStream::CompressionStream(CompressionFormat format, const Options& options)
+    : format_(format),
+      level_(options.level),
+      block_size_(options.block_size),
+      thread_count_(options.thread_count),
+      work_available_(&lock_),
+      job_done_(&lock_) {
+  ASSERT(block_size_ > 0);
+  if (thread_count_ <= 0)
+    thread_count_ = CpuInfo::NumberOfCores();
+
+  if (format_ == CompressionFormat::Lz4) {
+    if (level_ == DefaultLevel)
+      level_ = Lz4::DefaultLevel;
+    ASSERT(Lz4::MinLevel <= level_ && level_ <= Lz4::MaxLevel);
+    block_size_ = getLz4BlockSize(getLz4BlockSizeId(block_size_));
+  } else {
+    if (level_ == DefaultLevel)
+      level_ = DeflateEncoder::DefaultLevel;
+    ASSERT(DeflateEncoder::MinLevel <= level_ && level_ <= DeflateEncoder::MaxLevel);
+  }
+}
+
+CompressionStream::~CompressionStream() {
+  stopWorkers();
+  if (owned_ && underlying_)
+    delete underlying_;
+}
+
+void CompressionStream::openInternal(Stream* underlying, bool owned) {
+  ASSERT(underlying->isOpen(), "given underlying stream must be open");
+  ASSERT(!isOpen());
+  underlying_ = underlying;
+  owned_ = owned;
+
+  block_.willGrow(block_size_);
+  total_size_ = 0;
+  crc_.reset();
+  xxhash_.reset();
+  history_.clear();
+
+  if (thread_count_ == 1) {
+    if (format_ != CompressionFormat::Lz4 && !encoder_)
+      encoder_ = OwnPtr<DeflateEncoder>::create(level_);
+  } else {
+    for (int i = 0; i < thread_count_; ++i) {
+      workers_.add(OwnPtr<Worker>::create(this));
+      workers_.last()->Start();
+    }
+  }
+  writeHeader();
+}
+
+void CompressionStream::close() {
+  ASSERT(isOpen());
+
+  // DEFLATE stream is terminated by a block with final flag, even if empty.
+  if (format_ != CompressionFormat::Lz4 || !block_.isEmpty())
+    submitBlock(true);
+  writeCompleted(0);
+  stopWorkers();
+  writeTrailer();
+
+  Stream* underlying = exchange(underlying_, nullptr);
+  if (owned_) {
+    OwnPtr<Stream> guard(underlying);
+    underlying->close();
+  }
+}
+
+bool CompressionStream::isOpen() const noexcept {
+  return underlying_ != nullptr;
+}
+
+void CompressionStream::writeHeader() {
+  if (format_ == CompressionFormat::Lz4) {
+    byte_t header[7];
+    storeLe32(header, Lz4Magic);
+    header[4] = Lz4Version | Lz4BlockIndependence | Lz4ContentChecksum;
+    header[5] = static_cast<byte_t>(getLz4BlockSizeId(block_size_) << 4);
+    header[6] = getLz4HeaderChecksum(header + 4, 2);
+    underlying_->write(BufferSpan(header, sizeof(header)));
+  } else if (format_ == CompressionFormat::Gzip) {
+    byte_t extra_flags = 0;
+    if (level_ == DeflateEncoder::MaxLevel)
+      extra_flags = 2;
+    else if (level_ == 1)
+      extra_flags = 4;
+    const byte_t header[10] = {
+      GzipId1, GzipId2, GzipDeflateMethod, 0,
+      // No modification time.
+      0, 0, 0, 0,
+      extra_flags, GzipUnknownOs,
+    };
+    underlying_->write(BufferSpan(header, sizeof(header)));
+  }
+}
+
+void CompressionStream::writeTrailer() {
+  byte_t trailer[8];
+  if (format_ == CompressionFormat::Lz4) {
+    storeLe32(trailer, 0);
+    storeLe32(trailer + 4, xxhash_.getChecksum());
+    underlying_->write(BufferSpan(trailer, 8));
+  } else if (format_ == CompressionFormat::Gzip) {
+    storeLe32(trailer, toUnderlying(crc_.getChecksum()));
+    storeLe32(trailer + 4, static_cast<uint32_t>(total_size_));
+    underlying_->write(BufferSpan(trailer, 8));
+  }
+}
+
+void CompressionStream::write(BufferSpan input) {
+  ASSERT(canWrite());
+
+  auto* bytes = static_cast<const byte_t*>(input.data());
+  int remaining = input.size();
+  while (remaining > 0) {
+    int count = min(remaining, block_size_ - block_.size());
+    block_.append(Span<byte_t>(bytes, count));
+    bytes += count;
+    remaining -= count;
+    if (block_.size() == block_size_)
+      submitBlock(false);
+  }
+}
+
+void CompressionStream::submitBlock(bool final) {
+  auto job = OwnPtr<Job>::create();
+  job->input = move(block_);
+  job->final = final;
+  block_.willGrow(block_size_);
+
+  BufferSpan input(job->input.data(), job->input.size());
+  total_size_ += input.size();
+  if (format_ == CompressionFormat::Lz4) {
+    xxhash_.update(input);
+  } else {
+    if (format_ == CompressionFormat::Gzip)
+      crc_.update(input);
+
+    job->history = history_;
+    if (input.size() >= DeflateEncoder::WindowSize) {
+      history_.clear();
+      history_.append(Span<byte_t>(job->input.data() + input.size() - DeflateEncoder::WindowSize, DeflateEncoder::WindowSize));
+    } else {
+      history_.append(Span<byte_t>(job->input.data(), input.size()));
+      if (history_.size() > DeflateEncoder::WindowSize)
+        history_.removePrefix(history_.size() - DeflateEncoder::WindowSize);
+    }
+  }
+
+  if (workers_.isEmpty()) {
+    compressJob(*job, encoder_.get());
+    underlying_->write(BufferSpan(job->output.data(), job->output.size()));
+    return;
+  }
+
+  {
+    AutoLock guard(borrow(lock_));
+    queue_.add(job.get());
+    in_flight_.add(move(job));
+    work_available_.Signal();
+  }
+  // Keep all workers busy, but limit memory used by blocks in flight.
+  writeCompleted(2 * thread_count_);
+}
+
+void CompressionStream::compressJob(Job& job, DeflateEncoder* encoder) {
+  BufferSpan input(job.input.data(), job.input.size());
+  if (format_ != CompressionFormat::Lz4) {
+    encoder->compress(BufferSpan(job.history.data(), job.history.size()), input, job.final, job.output);
+    return;
+  }
+
+  int capacity = Lz4::getMaxCompressedSize(input.size());
+  byte_t* out = job.output.appendUninitialized(4 + capacity);
+  int compressed_size = Lz4::compress(input, MutableBufferSpan(out + 4, capacity), level_);
+  if (compressed_size == 0 || compressed_size >= input.size()) {
+    // Incompressible, store as is.
+    storeLe32(out, static_cast<uint32_t>(input.size()) | Lz4UncompressedBit);
+    ::memcpy(out + 4, input.data(), toUnsigned(input.size()));
+    job.output.truncate(4 + input.size());
+  } else {
+    storeLe32(out, static_cast<uint32_t>(compressed_size));
+    job.output.truncate(4 + compressed_size);
+  }
+}
+
+void CompressionStream::writeCompleted(int max_in_flight) {
+  AutoLock guard(borrow(lock_));
+  while (!in_flight_.isEmpty()) {
+    if (!in_flight_.first()->done) {
+      if (in_flight_.size() <= max_in_flight)
+        break;
+      job_done_.Wait();
+      continue;
+    }
+    OwnPtr<Job> job = move(in_flight_.first());
+    in_flight_.removeAt(0);
+
+    AutoUnlock unguard(&lock_);
+    underlying_->write(BufferSpan(job->output.data(), job->output.size()));
+  }
+}
+
+void CompressionStream::workLoop(DeflateEncoder* encoder) {
+  AutoLock guard(borrow(lock_));
+  while (true) {
+    while (queue_.isEmpty() && !quit_)
+      work_available_.Wait();
+    if (queue_.isEmpty())
+      break;
+
+    Job* job = queue_.first();
+    queue_.removeAt(0);
+    {
+      AutoUnlock unguard(&lock_);
+      compressJob(*job, encoder);
+    }
+    job->done = true;
+    job_done_.Signal();
+  }
+}
+
+void CompressionStream::stopWorkers() {
+  if (workers_.isEmpty())
+    return;
+  {
+    AutoLock guard(borrow(lock_));
+    quit_ = true;
+    work_available_.Broadcast();
+  }
+  for (auto& worker : workers_)
+    worker->Join();
+  workers_.clear();
+  quit_ = false;
+}
+
+void CompressionStream::flush() {
+  ASSERT(isOpen());
+  if (!block_.isEmpty())
+    submitBlock(false);
+  writeCompleted(0);
+  underlying_->flush();
+}
+
+int CompressionStream::readAtMost(MutableBufferSpan output) {
+  ASSERT(canRead());
+  throw NotSupportedException();
+}
+
+int64_t CompressionStream::seek(int64_t offset, SeekOrigin origin) {
+  ASSERT(canSeek());
+  throw NotSupportedException();
+}
+
+bool CompressionStream::canRead() {
+  return false;
+}
+
+bool CompressionStream::canWrite() {
+  return underlying_ && underlying_->canWrite();
+}
+
+bool CompressionStream::canSeek() {
+  return false;
+}
+
+void CompressionStream::setLength(int64_t length) {
+  ASSERT(canSeek());
+  throw NotSupportedException();
+}
+
+int64_t CompressionStream::getLength() {
+  ASSERT(canSeek());
+  throw NotSupportedException();
+}
+
+void CompressionStream::setPosition(int64_t position) {
+  ASSERT(canSeek());
+  throw NotSupportedException();
+}
+
+int64_t CompressionStream::getPosition() {
+  return total_size_ + block_.size();
+}
+
+DecompressionStream::DecompressionStream(CompressionFormat format)
+    : format_(format) {}
+
+DecompressionStream::~DecompressionStream() {
+  deflate_.reset();
+  if (owned_ && underlying_)
+    delete underlying_;
+}
+
+void DecompressionStream::openInternal(Stream* underlying, bool owned) {
+  ASSERT(underlying->isOpen(), "given underlying stream must be open");
+  ASSERT(!isOpen());
+  underlying_ = underlying;
+  owned_ = owned;
+  finished_ = false;
+  position_ = 0;
+
+  if (format_ == CompressionFormat::Lz4) {
+    in_frame_ = false;
+    decoded_.clear();
+    decoded_pos_ = 0;
+    return;
+  }
+  deflate_ = OwnPtr<DeflateDecoder>::create(*underlying_);
+  if (format_ == CompressionFormat::Gzip) {
+    crc_.reset();
+    member_size_ = 0;
+    int first_byte = deflate_->tryReadAlignedByte();
+    if (first_byte < 0)
+      throw EndOfStreamException();
+    readGzipHeader(first_byte);
+  }
+}
+
+void DecompressionStream::close() {
+  ASSERT(isOpen());
+  deflate_.reset();
+
+  Stream* underlying = exchange(underlying_, nullptr);
+  if (owned_) {
+    OwnPtr<Stream> guard(underlying);
+    underlying->close();
+  }
+}
+
+bool DecompressionStream::isOpen() const noexcept {
+  return underlying_ != nullptr;
+}
+
+int DecompressionStream::readAtMost(MutableBufferSpan output) {
+  ASSERT(canRead());
+  // Fill whole |output| unless at the end, read() relies on it.
+  int total = 0;
+  while (total < output.size()) {
+    MutableBufferSpan rest = output.slice(total);
+    int count = format_ == CompressionFormat::Lz4 ? readLz4(rest) : readDeflate(rest);
+    if (count == 0)
+      break;
+    total += count;
+  }
+  position_ += total;
+  return total;
+}
+
+int DecompressionStream::readUnderlying(MutableBufferSpan output) {
+  int total = 0;
+  while (total < output.size()) {
+    int count = underlying_->readAtMost(output.slice(total));
+    if (count == 0)
+      break;
+    total += count;
+  }
+  return total;
+}
+
+int DecompressionStream::readDeflate(MutableBufferSpan output) {
+  while (!finished_) {
+    int count = deflate_->decompress(output);
+    if (count > 0) {
+      if (format_ == CompressionFormat::Gzip) {
+        crc_.update(BufferSpan(output.data(), count));
+        member_size_ += static_cast<uint32_t>(count);
+      }
+      return count;
+    }
+    if (format_ == CompressionFormat::Deflate) {
+      finished_ = true;
+      break;
+    }
+    readGzipTrailer();
+
+    // Another member may follow.
+    int first_byte = deflate_->tryReadAlignedByte();
+    if (first_byte < 0) {
+      finished_ = true;
+      break;
+    }
+    readGzipHeader(first_byte);
+    deflate_->reset();
+    crc_.reset();
+    member_size_ = 0;
+  }
+  return 0;
+}
+
+void DecompressionStream::readGzipHeader(int first_byte) {
+  byte_t header[10];
+  header[0] = static_cast<byte_t>(first_byte);
+  deflate_->readAligned(MutableBufferSpan(header + 1, 9));
+  if (header[0] != GzipId1 || header[1] != GzipId2 || header[2] != GzipDeflateMethod)
+    throw FormatException("gzip");
+  byte_t flags = header[3];
+  if (flags & GzipReserved)
+    throw FormatException("gzip");
+
+  if (flags & GzipExtra) {
+    byte_t size_bytes[2];
+    deflate_->readAligned(MutableBufferSpan(size_bytes, 2));
+    for (int size = size_bytes[0] | (size_bytes[1] << 8); size > 0; --size) {
+      if (deflate_->tryReadAlignedByte() < 0)
+        throw EndOfStreamException();
+    }
+  }
+  // Zero-terminated file name and comment.
+  for (byte_t flag : { GzipName, GzipComment }) {
+    if (!(flags & flag))
+      continue;
+    int c;
+    do {
+      c = deflate_->tryReadAlignedByte();
+      if (c < 0)
+        throw EndOfStreamException();
+    } while (c != 0);
+  }
+  if (flags & GzipHeaderCrc) {
+    byte_t crc[2];
+    deflate_->readAligned(MutableBufferSpan(crc, 2));
+  }
+}
+
+void DecompressionStream::readGzipTrailer() {
+  byte_t trailer[8];
+  deflate_->readAligned(MutableBufferSpan(trailer, 8));
+  if (loadLe32(trailer) != toUnderlying(crc_.getChecksum()) || loadLe32(trailer + 4) != member_size_)
+    throw FormatException("gzip");
+}
+
+int DecompressionStream::readLz4(MutableBufferSpan output) {
+  while (decoded_pos_ == decoded_.size()) {
+    if (finished_)
+      return 0;
+    if (in_frame_) {
+      readLz4Block();
+    } else if (!readLz4FrameHeader()) {
+      finished_ = true;
+      return 0;
+    }
+  }
+  int count = min(output.size(), decoded_.size() - decoded_pos_);
+  ::memcpy(output.data(), decoded_.data() + decoded_pos_, toUnsigned(count));
+  decoded_pos_ += count;
+  return count;
+}
+
+bool DecompressionStream::readLz4FrameHeader() {
+  while (true) {
+    byte_t magic_bytes[4];
+    int count = readUnderlying(MutableBufferSpan(magic_bytes, 4));
+    if (count == 0)
+      return false;
+    if (count < 4)
+      throw EndOfStreamException();
+
+    uint32_t magic = loadLe32(magic_bytes);
+    if ((magic & Lz4SkippableMagicMask) == Lz4SkippableMagic) {
+      byte_t size_bytes[4];
+      underlying_->read(MutableBufferSpan(size_bytes, 4));
+      int64_t size = loadLe32(size_bytes);
+      while (size > 0) {
+        compressed_.clear();
+        int chunk = static_cast<int>(min(size, static_cast<int64_t>(Lz4HistorySize)));
+        underlying_->read(MutableBufferSpan(compressed_.appendUninitialized(chunk), chunk));
+        size -= chunk;
+      }
+      continue;
+    }
+    if (magic != Lz4Magic)
+      throw FormatException("lz4");
+
+    // Flags, block descriptor, optional content size and header checksum.
+    byte_t descriptor[2 + 8 + 1];
+    underlying_->read(MutableBufferSpan(descriptor, 3));
+    byte_t flags = descriptor[0];
+    byte_t block_descriptor = descriptor[1];
+    if ((flags & Lz4VersionMask) != Lz4Version || (flags & Lz4Reserved) || (block_descriptor & 0x8F))
+      throw FormatException("lz4");
+    // Frames compressed with external dictionary cannot be decoded.
+    if (flags & Lz4DictionaryId)
+      throw FormatException("lz4");
+
+    int descriptor_size = 2;
+    if (flags & Lz4ContentSize) {
+      underlying_->read(MutableBufferSpan(descriptor + 3, 8));
+      descriptor_size += 8;
+    }
+    if (descriptor[descriptor_size] != getLz4HeaderChecksum(descriptor, descriptor_size))
+      throw FormatException("lz4");
+
+    int block_size_id = block_descriptor >> 4;
+    if (block_size_id < Lz4MinBlockSizeId)
+      throw FormatException("lz4");
+    max_block_size_ = getLz4BlockSize(block_size_id);
+    linked_blocks_ = !(flags & Lz4BlockIndependence);
+    block_checksums_ = (flags & Lz4BlockChecksum) != 0;
+    content_checksum_ = (flags & Lz4ContentChecksum) != 0;
+
+    xxhash_.reset();
+    decoded_.clear();
+    decoded_pos_ = 0;
+    in_frame_ = true;
+    return true;
+  }
+}
+
+void DecompressionStream::readLz4Block() {
+  byte_t block_header[4];
+  underlying_->read(MutableBufferSpan(block_header, 4));
+  uint32_t block_word = loadLe32(block_header);
+
+  if (block_word == 0) {
+    // End mark.
+    if (content_checksum_) {
+      byte_t checksum[4];
+      underlying_->read(MutableBufferSpan(checksum, 4));
+      if (loadLe32(checksum) != xxhash_.getChecksum())
+        throw FormatException("lz4");
+    }
+    in_frame_ = false;
+    return;
+  }
+
+  bool uncompressed = (block_word & Lz4UncompressedBit) != 0;
+  int size = static_cast<int>(block_word & ~Lz4UncompressedBit);
+  if (size > max_block_size_)
+    throw FormatException("lz4");
+
+  compressed_.clear();
+  byte_t* data = compressed_.appendUninitialized(size);
+  underlying_->read(MutableBufferSpan(data, size));
+  if (block_checksums_) {
+    byte_t checksum[4];
+    underlying_->read(MutableBufferSpan(checksum, 4));
+    if (loadLe32(checksum) != computeXxHash32(BufferSpan(data, size)))
+      throw FormatException("lz4");
+  }
+
+  // Keep the tail of previous blocks for linked blocks to refer to.
+  int history_size = 0;
+  if (linked_blocks_) {
+    history_size = min(decoded_.size(), Lz4HistorySize);
+    decoded_.removePrefix(decoded_.size() - history_size);
+  } else {
+    decoded_.clear();
+  }
+
+  byte_t* out = decoded_.appendUninitialized(max_block_size_);
+  int decoded_size;
+  if (uncompressed) {
+    ::memcpy(out, data, toUnsigned(size));
+    decoded_size = size;
+  } else {
+    decoded_size = Lz4::decompress(
+        BufferSpan(data, size),
+        MutableBufferSpan(decoded_.data(), history_size + max_block_size_),
+        history_size);
+  }
+  decoded_.truncate(history_size + decoded_size);
+  decoded_pos_ = history_size;
+
+  if (content_checksum_)
+    xxhash_.update(BufferSpan(decoded_.data() + history_size, decoded_size));
+}
+
+void DecompressionStream::write(BufferSpan input) {
+  ASSERT(canWrite());
+  throw NotSupportedException();
+}
+
+int64_t DecompressionStream::seek(int64_t offset, SeekOrigin origin) {
+  ASSERT(canSeek());
+  throw NotSupportedException();
+}
+
+void DecompressionStream::flush() {
+}
+
+bool DecompressionStream::canRead() {
+  return underlying_ && underlying_->canRead();
+}
+
+bool DecompressionStream::canWrite() {
+  return false;
+}
+
+bool DecompressionStream::canSeek() {
+  return false;
+}
+
+void DecompressionStream::setLength(int64_t length) {
+  ASSERT(canSeek());
+  throw NotSupportedException();
+}
+
+int64_t DecompressionStream::getLength() {
+  ASSERT(canSeek());
+  throw NotSupportedException();
+}
+
+void DecompressionStream::setPosition(int64_t position) {
+  ASSERT(canSeek());
+  throw NotSupportedException();
+}
+
+int64_t DecompressionStream::getPosition() {
+  return position_;
+}
+
+} // namespace stp
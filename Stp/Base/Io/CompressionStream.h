@@ -0,0 +1,207 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#ifndef STP_BASE_IO_COMPRESSIONSTREAM_H_
+#define STP_BASE_IO_COMPRESSIONSTREAM_H_
+
+#include "Base/Compress/Deflate.h"
+#include "Base/Crypto/Crc32.h"
+#include "Base/Crypto/XxHash32.h"
+#include "Base/Io/Stream.h"
+#include "Base/Memory/OwnPtr.h"
+#include "Base/Thread/ConditionVariable.h"
+#include "Base/Thread/Lock.h"
+
+namespace stp {
+
+enum class CompressionFormat {
+  // LZ4 frame format. Very fast, moderate ratio.
+  Lz4,
+  // Raw DEFLATE (RFC 1951).
+  Deflate,
+  // DEFLATE with gzip header and trailer (RFC 1952).
+  Gzip,
+};
+
+// Compresses data written to it into underlying stream.
+//
+// The input is split into blocks compressed independently of each other,
+// so blocks can be compressed on several threads at once. The output is
+// a regular stream of given format (readable by lz4, gzip, etc.).
+// Nothing is read back, so the underlying stream is not required to be
+// seekable.
+//
+// Call close() to write the end of compressed stream. Destroying an open
+// stream loses the tail of data.
+class BASE_EXPORT CompressionStream final : public Stream {
+  DISALLOW_COPY_AND_ASSIGN(CompressionStream);
+ public:
+  static constexpr int DefaultLevel = -1;
+  static constexpr int DefaultBlockSize = 256 * 1024;
+
+  struct Options {
+    Options() : level(DefaultLevel), block_size(DefaultBlockSize), thread_count(1) {}
+
+    // See Lz4 and DeflateEncoder for valid levels.
+    int level;
+    // Amount of input compressed at once. Rounded up to one of 64 KiB,
+    // 256 KiB, 1 MiB and 4 MiB for LZ4.
+    int block_size;
+    // Number of threads compressing blocks. With single thread blocks are
+    // compressed on the calling thread. Zero selects number of cores.
+    int thread_count;
+  };
+
+  explicit CompressionStream(CompressionFormat format, const Options& options = Options());
+  ~CompressionStream() override;
+
+  void open(OwnPtr<Stream> underlying) { openInternal(underlying.leakPtr(), true); }
+  void open(Stream* underlying) { openInternal(underlying, false); }
+
+  ALWAYS_INLINE Stream* getUnderlying() const { return underlying_; }
+
+  // Finishes the compressed stream.
+  void close() override;
+  bool isOpen() const noexcept override;
+  int readAtMost(MutableBufferSpan output) override;
+  void write(BufferSpan input) override;
+  int64_t seek(int64_t offset, SeekOrigin origin) override;
+  // Compresses buffered data, so everything written so far can be
+  // decompressed on the other side. Makes compression ratio worse.
+  void flush() override;
+  bool canRead() override;
+  bool canWrite() override;
+  bool canSeek() override;
+  void setLength(int64_t length) override;
+  int64_t getLength() override;
+  void setPosition(int64_t position) override;
+  // Returns number of uncompressed bytes written so far.
+  int64_t getPosition() override;
+
+ private:
+  struct Job;
+  class Worker;
+
+  void openInternal(Stream* underlying, bool owned);
+
+  void writeHeader();
+  void writeTrailer();
+
+  // Queues compression of |block_|.
+  void submitBlock(bool final);
+  void compressJob(Job& job, DeflateEncoder* encoder);
+  // Writes out compressed blocks, waits until number of blocks
+  // in flight is no more than |max_in_flight|.
+  void writeCompleted(int max_in_flight);
+
+  void workLoop(DeflateEncoder* encoder);
+  void stopWorkers();
+
+  CompressionFormat format_;
+  int level_;
+  int block_size_;
+  int thread_count_;
+
+  Stream* underlying_ = nullptr;
+  bool owned_ = false;
+
+  // Input collected for next block.
+  List<byte_t> block_;
+  // Last bytes of input preceding |block_| (DEFLATE only).
+  List<byte_t> history_;
+  int64_t total_size_ = 0;
+  Crc32Algorithm crc_;
+  XxHash32Algorithm xxhash_;
+
+  // Used when compressing on calling thread.
+  OwnPtr<DeflateEncoder> encoder_;
+
+  Lock lock_;
+  // Signaled when a job is queued or workers should quit.
+  ConditionVariable work_available_;
+  // Signaled when a job is done.
+  ConditionVariable job_done_;
+  // Jobs in order of input.
+  List<OwnPtr<Job>> in_flight_;
+  // Jobs not taken by any worker yet, in order.
+  List<Job*> queue_;
+  bool quit_ = false;
+  List<OwnPtr<Worker>> workers_;
+};
+
+// Decompresses data read from underlying stream.
+//
+// Concatenated streams (i.e. multi-member gzip files) are decompressed
+// as one. Throws FormatException on malformed or corrupted input
+// (checksums are verified) and EndOfStreamException on truncated input.
+class BASE_EXPORT DecompressionStream final : public Stream {
+  DISALLOW_COPY_AND_ASSIGN(DecompressionStream);
+ public:
+  explicit DecompressionStream(CompressionFormat format);
+  ~DecompressionStream() override;
+
+  void open(OwnPtr<Stream> underlying) { openInternal(underlying.leakPtr(), true); }
+  void open(Stream* underlying) { openInternal(underlying, false); }
+
+  ALWAYS_INLINE Stream* getUnderlying() const { return underlying_; }
+
+  void close() override;
+  bool isOpen() const noexcept override;
+  // Returns less than requested only at the end of compressed data.
+  int readAtMost(MutableBufferSpan output) override;
+  void write(BufferSpan input) override;
+  int64_t seek(int64_t offset, SeekOrigin origin) override;
+  void flush() override;
+  bool canRead() override;
+  bool canWrite() override;
+  bool canSeek() override;
+  void setLength(int64_t length) override;
+  int64_t getLength() override;
+  void setPosition(int64_t position) override;
+  // Returns number of decompressed bytes read so far.
+  int64_t getPosition() override;
+
+ private:
+  void openInternal(Stream* underlying, bool owned);
+
+  int readLz4(MutableBufferSpan output);
+  // Returns false at the end of underlying stream.
+  bool readLz4FrameHeader();
+  void readLz4Block();
+
+  int readDeflate(MutableBufferSpan output);
+  // |first_byte| is already read.
+  void readGzipHeader(int first_byte);
+  void readGzipTrailer();
+
+  // Reads up to |output| size bytes, fewer only at the end of stream.
+  int readUnderlying(MutableBufferSpan output);
+
+  CompressionFormat format_;
+
+  Stream* underlying_ = nullptr;
+  bool owned_ = false;
+  bool finished_ = false;
+  int64_t position_ = 0;
+
+  // DEFLATE and gzip.
+  OwnPtr<DeflateDecoder> deflate_;
+  Crc32Algorithm crc_;
+  uint32_t member_size_ = 0;
+
+  // LZ4.
+  bool in_frame_ = false;
+  bool linked_blocks_ = false;
+  bool block_checksums_ = false;
+  bool content_checksum_ = false;
+  int max_block_size_ = 0;
+  List<byte_t> compressed_;
+  // Decoded blocks, preceded with up to 64 KiB of history for linked blocks.
+  List<byte_t> decoded_;
+  int decoded_pos_ = 0;
+  XxHash32Algorithm xxhash_;
+};
+
+} // namespace stp
+
+#endif // STP_BASE_IO_COMPRESSIONSTREAM_H_
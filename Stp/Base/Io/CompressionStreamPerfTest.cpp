@@ -0,0 +1,204 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Io/CompressionStream.h"
+
+#include "Base/Io/MemoryStream.h"
+#include "Base/Test/GTest.h"
+#include "Base/Test/PerfTest.h"
+#include "Base/Text/StringFormatMany.h"
+#include "Base/Time/TimeTicks.h"
+#include "Base/Util/Random.h"
+
+namespace stp {
+
+static const int CorpusSize = 16 * 1024 * 1024;
+
+namespace {
+
+// Generates deterministic pseudo-random text resembling real data.
+class CorpusGenerator {
+ public:
+  explicit CorpusGenerator(List<byte_t>& output) : output_(output) {}
+
+  int next(int bound) { return static_cast<int>(random_.NextUInt32() % toUnsigned(bound)); }
+
+  void put(const char* text) {
+    for (; *text; ++text)
+      output_.add(static_cast<byte_t>(*text));
+  }
+
+  void putNumber(int value) {
+    char digits[12];
+    int count = 0;
+    do {
+      digits[count++] = static_cast<char>('0' + value % 10);
+      value /= 10;
+    } while (value);
+    while (count)
+      output_.add(static_cast<byte_t>(digits[--count]));
+  }
+
+  void putHex(int digit_count) {
+    for (int i = 0; i < digit_count; ++i)
+      output_.add(static_cast<byte_t>("0123456789abcdef"[next(16)]));
+  }
+
+ private:
+  List<byte_t>& output_;
+  Random random_;
+};
+
+List<byte_t> makeLogCorpus() {
+  static const char* const Levels[] = { "INFO ", "INFO ", "INFO ", "DEBUG", "WARN ", "ERROR" };
+  static const char* const Sources[] = { "http.server", "db.pool", "cache", "auth", "scheduler" };
+  static const char* const Messages[] = {
+    "request completed status=200 path=/api/v1/items",
+    "request completed status=404 path=/static/favicon.ico",
+    "connection acquired from pool",
+    "cache miss for key",
+    "token refreshed for session",
+    "job finished without errors",
+  };
+  List<byte_t> corpus;
+  corpus.willGrow(CorpusSize);
+  CorpusGenerator gen(corpus);
+  int seconds = 0;
+  while (corpus.size() < CorpusSize) {
+    seconds += gen.next(3);
+    gen.put("2017-06-01T");
+    gen.putNumber(10 + seconds / 3600 % 14);
+    gen.put(":");
+    gen.putNumber(10 + seconds / 60 % 50);
+    gen.put(":");
+    gen.putNumber(10 + seconds % 50);
+    gen.put(".");
+    gen.putNumber(100 + gen.next(900));
+    gen.put(" ");
+    gen.put(Levels[gen.next(6)]);
+    gen.put(" [");
+    gen.put(Sources[gen.next(5)]);
+    gen.put("] ");
+    gen.put(Messages[gen.next(6)]);
+    gen.put(" id=");
+    gen.putHex(16);
+    gen.put(" took=");
+    gen.putNumber(gen.next(5000));
+    gen.put("us\n");
+  }
+  corpus.truncate(CorpusSize);
+  return corpus;
+}
+
+List<byte_t> makeJsonCorpus() {
+  static const char* const Names[] = { "Alice", "Bob", "Carol", "Dave", "Eve", "Mallory", "Trent" };
+  static const char* const Tags[] = { "\"new\"", "\"sale\"", "\"popular\"", "\"limited\"" };
+  List<byte_t> corpus;
+  corpus.willGrow(CorpusSize);
+  CorpusGenerator gen(corpus);
+  gen.put("[\n");
+  for (int id = 0; corpus.size() < CorpusSize; ++id) {
+    gen.put("  {\"id\": ");
+    gen.putNumber(id);
+    gen.put(", \"owner\": \"");
+    gen.put(Names[gen.next(7)]);
+    gen.put("\", \"price\": ");
+    gen.putNumber(gen.next(100000));
+    gen.put(".");
+    gen.putNumber(gen.next(100));
+    gen.put(", \"active\": ");
+    gen.put(gen.next(4) ? "true" : "false");
+    gen.put(", \"tags\": [");
+    for (int i = gen.next(4); i > 0; --i) {
+      gen.put(Tags[gen.next(4)]);
+      if (i > 1)
+        gen.put(", ");
+    }
+    gen.put("], \"checksum\": \"");
+    gen.putHex(8);
+    gen.put("\"},\n");
+  }
+  corpus.truncate(CorpusSize);
+  return corpus;
+}
+
+const char* getFormatName(CompressionFormat format) {
+  switch (format) {
+    case CompressionFormat::Lz4: return "lz4";
+    case CompressionFormat::Deflate: return "deflate";
+    case CompressionFormat::Gzip: return "gzip";
+  }
+  return nullptr;
+}
+
+class CompressionStreamPerfTest : public testing::Test {
+ protected:
+  void run(const char* corpus_name, const List<byte_t>& corpus,
+           CompressionFormat format, int level, int thread_count);
+};
+
+void CompressionStreamPerfTest::run(
+    const char* corpus_name, const List<byte_t>& corpus,
+    CompressionFormat format, int level, int thread_count) {
+  MemoryStream compressed;
+  compressed.openNewBytes();
+
+  CompressionStream::Options options;
+  options.level = level;
+  options.thread_count = thread_count;
+  CompressionStream compressor(format, options);
+  compressor.open(&compressed);
+
+  TimeTicks start = TimeTicks::Now();
+  compressor.write(BufferSpan(corpus.data(), corpus.size()));
+  compressor.close();
+  double compress_milliseconds = (TimeTicks::Now() - start).InMillisecondsF();
+  int64_t compressed_size = compressed.getLength();
+
+  compressed.setPosition(0);
+  DecompressionStream decompressor(format);
+  decompressor.open(&compressed);
+  List<byte_t> output;
+  byte_t* output_data = output.appendUninitialized(corpus.size());
+
+  start = TimeTicks::Now();
+  decompressor.read(MutableBufferSpan(output_data, corpus.size()));
+  double decompress_milliseconds = (TimeTicks::Now() - start).InMillisecondsF();
+  decompressor.close();
+  ASSERT_EQ(BufferSpan(corpus.data(), corpus.size()), BufferSpan(output.data(), output.size()));
+
+  double megabytes = static_cast<double>(corpus.size()) / (1024 * 1024);
+  auto modifier = stringFormatMany("_{}_l{}_t{}", corpus_name, level, thread_count);
+  perf_test::PrintResult(
+      getFormatName(format), modifier, "ratio",
+      static_cast<double>(corpus.size()) / compressed_size, "x", true);
+  perf_test::PrintResult(
+      getFormatName(format), modifier, "compress",
+      megabytes * 1000 / compress_milliseconds, "MiB/s", true);
+  perf_test::PrintResult(
+      getFormatName(format), modifier, "decompress",
+      megabytes * 1000 / decompress_milliseconds, "MiB/s", true);
+}
+
+} // namespace
+
+TEST_F(CompressionStreamPerfTest, Levels) {
+  auto log = makeLogCorpus();
+  auto json = makeJsonCorpus();
+  for (auto format : { CompressionFormat::Lz4, CompressionFormat::Gzip }) {
+    for (int level : { 1, 3, 6, 9 }) {
+      run("log", log, format, level, 1);
+      run("json", json, format, level, 1);
+    }
+  }
+}
+
+TEST_F(CompressionStreamPerfTest, Threads) {
+  auto log = makeLogCorpus();
+  for (auto format : { CompressionFormat::Lz4, CompressionFormat::Gzip }) {
+    for (int thread_count : { 1, 2, 4, 0 })
+      run("log", log, format, 6, thread_count);
+  }
+}
+
+} // namespace stp
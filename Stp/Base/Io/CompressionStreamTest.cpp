@@ -0,0 +1,184 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Io/CompressionStream.h"
+
+#include "Base/Error/BasicExceptions.h"
+#include "Base/Io/IoException.h"
+#include "Base/Io/MemoryStream.h"
+#include "Base/Test/GTest.h"
+#include "Base/Util/Random.h"
+
+namespace stp {
+
+namespace {
+
+const CompressionFormat Formats[] = {
+  CompressionFormat::Lz4,
+  CompressionFormat::Deflate,
+  CompressionFormat::Gzip,
+};
+
+List<byte_t> makeLog(int size) {
+  static const char* const Words[] = {
+    "2017-06-01 12:00:00 ", "INFO ", "WARN ", "request ", "handled ", "in 12 ms", "user=42 ", "\n",
+  };
+  List<byte_t> text;
+  Random random;
+  while (text.size() < size) {
+    const char* word = Words[(random.NextUInt32() >> 16) % 8];
+    for (; *word && text.size() < size; ++word)
+      text.add(static_cast<byte_t>(*word));
+  }
+  return text;
+}
+
+BufferSpan toBuffer(const List<byte_t>& list) {
+  return BufferSpan(list.data(), list.size());
+}
+
+List<byte_t> compress(
+    CompressionFormat format, const List<byte_t>& input,
+    const CompressionStream::Options& options = CompressionStream::Options()) {
+  MemoryStream memory;
+  memory.openNewBytes();
+  CompressionStream stream(format, options);
+  stream.open(&memory);
+  stream.write(toBuffer(input));
+  EXPECT_EQ(input.size(), stream.getPosition());
+  stream.close();
+
+  List<byte_t> output;
+  int size = static_cast<int>(memory.getLength());
+  memory.positionalRead(0, MutableBufferSpan(output.appendUninitialized(size), size));
+  return output;
+}
+
+List<byte_t> decompress(CompressionFormat format, const List<byte_t>& input) {
+  MemoryStream memory;
+  memory.open(toBuffer(input));
+  DecompressionStream stream(format);
+  stream.open(&memory);
+
+  List<byte_t> output;
+  while (true) {
+    constexpr int ChunkSize = 7000;
+    byte_t* chunk = output.appendUninitialized(ChunkSize);
+    int count = stream.readAtMost(MutableBufferSpan(chunk, ChunkSize));
+    output.truncate(output.size() - ChunkSize + count);
+    if (count == 0)
+      break;
+  }
+  EXPECT_EQ(output.size(), stream.getPosition());
+  stream.close();
+  return output;
+}
+
+} // namespace
+
+TEST(CompressionStreamTest, RoundTrip) {
+  auto text = makeLog(1000000);
+  for (auto format : Formats) {
+    for (int level : { 1, 5, 9 }) {
+      CompressionStream::Options options;
+      options.level = level;
+      options.block_size = 64 * 1024;
+      auto compressed = compress(format, text, options);
+      EXPECT_LT(compressed.size(), text.size() / 3);
+      EXPECT_EQ(toBuffer(text), toBuffer(decompress(format, compressed)))
+          << "format " << static_cast<int>(format) << " level " << level;
+    }
+  }
+}
+
+TEST(CompressionStreamTest, Empty) {
+  for (auto format : Formats) {
+    auto compressed = compress(format, List<byte_t>());
+    EXPECT_FALSE(compressed.isEmpty());
+    EXPECT_TRUE(decompress(format, compressed).isEmpty());
+  }
+}
+
+TEST(CompressionStreamTest, MultipleThreads) {
+  auto text = makeLog(3000000);
+  for (auto format : Formats) {
+    CompressionStream::Options options;
+    options.block_size = 100000;
+    auto single = compress(format, text, options);
+
+    options.thread_count = 4;
+    auto multiple = compress(format, text, options);
+    // Blocks are compressed the same way regardless of the thread.
+    EXPECT_EQ(toBuffer(single), toBuffer(multiple));
+    EXPECT_EQ(toBuffer(text), toBuffer(decompress(format, multiple)));
+  }
+}
+
+TEST(CompressionStreamTest, SmallWritesAndFlush) {
+  auto text = makeLog(50000);
+  for (auto format : Formats) {
+    MemoryStream memory;
+    memory.openNewBytes();
+    CompressionStream stream(format);
+    stream.open(&memory);
+    for (int pos = 0; pos < text.size(); pos += 100)
+      stream.write(BufferSpan(text.data() + pos, min(100, text.size() - pos)));
+
+    // Everything written so far becomes readable after flush.
+    stream.flush();
+    int64_t flushed_size = memory.getLength();
+    EXPECT_LT(0, flushed_size);
+
+    stream.write(toBuffer(text));
+    stream.close();
+
+    List<byte_t> compressed;
+    int size = static_cast<int>(memory.getLength());
+    memory.positionalRead(0, MutableBufferSpan(compressed.appendUninitialized(size), size));
+    auto output = decompress(format, compressed);
+    ASSERT_EQ(2 * text.size(), output.size());
+    EXPECT_EQ(toBuffer(text), BufferSpan(output.data(), text.size()));
+    EXPECT_EQ(toBuffer(text), BufferSpan(output.data() + text.size(), text.size()));
+  }
+}
+
+TEST(CompressionStreamTest, Concatenated) {
+  auto text = makeLog(10000);
+  for (auto format : { CompressionFormat::Lz4, CompressionFormat::Gzip }) {
+    auto compressed = compress(format, text);
+    auto second = compress(format, text);
+    compressed.append(second);
+    auto output = decompress(format, compressed);
+    ASSERT_EQ(2 * text.size(), output.size());
+    EXPECT_EQ(toBuffer(text), BufferSpan(output.data() + text.size(), text.size()));
+  }
+}
+
+TEST(CompressionStreamTest, GzipHeaderFields) {
+  // A member with file name and comment in the header.
+  const byte_t Input[] = {
+    0x1F, 0x8B, 0x08, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03,
+    'a', '.', 't', 'x', 't', 0x00, 'h', 'i', 0x00,
+    0xF3, 0x48, 0xCD, 0xC9, 0xC9, 0x07, 0x00,
+    0x82, 0x89, 0xD1, 0xF7, 0x05, 0x00, 0x00, 0x00,
+  };
+  List<byte_t> compressed;
+  compressed.append(Span<byte_t>(Input, sizeof(Input)));
+  EXPECT_EQ(BufferSpan("Hello"), toBuffer(decompress(CompressionFormat::Gzip, compressed)));
+}
+
+TEST(CompressionStreamTest, Corrupted) {
+  auto text = makeLog(10000);
+  for (auto format : { CompressionFormat::Lz4, CompressionFormat::Gzip }) {
+    auto compressed = compress(format, text);
+    // Break the trailer.
+    compressed[compressed.size() - 1] ^= 1;
+    EXPECT_THROW(decompress(format, compressed), FormatException);
+
+    compressed = compress(format, text);
+    compressed.truncate(compressed.size() - 3);
+    EXPECT_THROW(decompress(format, compressed), EndOfStreamException);
+  }
+}
+
+} // namespace stp
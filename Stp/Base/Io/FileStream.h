@@ -6,6 +6,7 @@
 
 #include "Base/FileSystem/File.h"
 #include "Base/Io/Stream.h"
+#include "Base/Type/ObjectCast.h"
 
 #if OS(POSIX)
 #include "Base/Posix/FileDescriptor.h"
@@ -57,6 +58,19 @@ class BASE_EXPORT FileStream final : public Stream {
   void positionalRead(int64_t offset, MutableBufferSpan output) override;
   // Positional write cannot be used with append mode.
   void positionalWrite(int64_t offset, BufferSpan input) override;
+  #if OS(POSIX)
+  // Implemented with readv()/writev() family, batching up to 64 buffers
+  // per system call.
+  int readV(Span<MutableBufferSpan> outputs) override;
+  void writeV(Span<BufferSpan> inputs) override;
+  void positionalReadV(int64_t offset, Span<MutableBufferSpan> outputs) override;
+  void positionalWriteV(int64_t offset, Span<BufferSpan> inputs) override;
+  // When |target| is FileStream too, the data is copied by the kernel
+  // (copy_file_range(), sendfile() or splice() on Linux).
+  // Wrap FileDescriptor with openNative(..., DontClose) to use this path.
+  int64_t transferTo(Stream& target, int64_t max_count = Limits<int64_t>::Max) override;
+  #endif
+  bool isFileStream() const final { return true; }
   int64_t seek(int64_t offset, SeekOrigin origin) override;
   void flush() override;
 
@@ -113,6 +127,11 @@ class BASE_EXPORT FileStream final : public Stream {
   void closeInternal(NativeFile native_file);
 };
 
+template<typename T>
+struct TIsInstanceOf<FileStream, T> {
+  static bool check(const T& x) { return x.isFileStream(); }
+};
+
 } // namespace stp
 
 #endif // STP_BASE_IO_FILESTREAM_H_
@@ -0,0 +1,140 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Io/FileStream.h"
+
+#include "Base/FileSystem/TemporaryDirectory.h"
+#include "Base/Io/BufferedStream.h"
+#include "Base/Test/GTest.h"
+#include "Base/Test/PerfTest.h"
+#include "Base/Text/StringFormatMany.h"
+#include "Base/Time/TimeTicks.h"
+
+namespace stp {
+
+// Every record is written as three segments: header, payload and trailer,
+// like a serializer emitting framing around user data.
+static const int HeaderSize = 16;
+static const int TrailerSize = 4;
+static const int PayloadSizes[] = { 16, 64, 256, 1024 };
+static const int MaxPayloadSize = 1024;
+static const int RecordCount = 65536;
+static const int RecordsPerBatch = 32;
+
+namespace {
+
+class FileStreamPerfTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    temp_dir_.create();
+    path_ = combineFilePaths(temp_dir_.path(), FilePath::fromString("file_stream_perf"));
+
+    header_.appendUninitialized(HeaderSize);
+    trailer_.appendUninitialized(TrailerSize);
+    payload_.appendUninitialized(MaxPayloadSize);
+    for (int i = 0; i < payload_.size(); ++i)
+      payload_[i] = static_cast<byte_t>(i);
+  }
+
+  enum class Method {
+    WritePerSegment,
+    CopyThenWrite,
+    WriteV,
+    BatchedWriteV,
+  };
+
+  static const char* getMethodName(Method method) {
+    switch (method) {
+      case Method::WritePerSegment: return "write_per_segment";
+      case Method::CopyThenWrite: return "copy_then_write";
+      case Method::WriteV: return "writev";
+      case Method::BatchedWriteV: return "batched_writev";
+    }
+    return nullptr;
+  }
+
+  void runWrites(Method method, int payload_size, bool buffered);
+
+  TemporaryDirectory temp_dir_;
+  FilePath path_;
+  List<byte_t> header_;
+  List<byte_t> payload_;
+  List<byte_t> trailer_;
+};
+
+void FileStreamPerfTest::runWrites(Method method, int payload_size, bool buffered) {
+  FileStream file;
+  file.create(path_, FileMode::Create, FileAccess::WriteOnly);
+  BufferedStream buffered_stream;
+  if (buffered)
+    buffered_stream.open(&file);
+  Stream& stream = buffered ? static_cast<Stream&>(buffered_stream) : file;
+
+  BufferSpan segments[] = {
+    BufferSpan(header_.data(), HeaderSize),
+    BufferSpan(payload_.data(), payload_size),
+    BufferSpan(trailer_.data(), TrailerSize),
+  };
+  List<BufferSpan> batch;
+  for (int i = 0; i < RecordsPerBatch; ++i)
+    batch.append(segments);
+  List<byte_t> record;
+
+  TimeTicks start = TimeTicks::Now();
+  switch (method) {
+    case Method::WritePerSegment:
+      for (int i = 0; i < RecordCount; ++i) {
+        for (BufferSpan segment : segments)
+          stream.write(segment);
+      }
+      break;
+    case Method::CopyThenWrite:
+      for (int i = 0; i < RecordCount; ++i) {
+        record.clear();
+        for (BufferSpan segment : segments)
+          record.append(makeSpan(static_cast<const byte_t*>(segment.data()), segment.size()));
+        stream.write(BufferSpan(record.data(), record.size()));
+      }
+      break;
+    case Method::WriteV:
+      for (int i = 0; i < RecordCount; ++i)
+        stream.writeV(segments);
+      break;
+    case Method::BatchedWriteV:
+      for (int i = 0; i < RecordCount; i += RecordsPerBatch)
+        stream.writeV(batch);
+      break;
+  }
+  stream.flush();
+  double total_time_milliseconds = (TimeTicks::Now() - start).InMillisecondsF();
+
+  int64_t total_bytes = static_cast<int64_t>(RecordCount) * (HeaderSize + payload_size + TrailerSize);
+  ASSERT_EQ(total_bytes, file.getLength());
+  if (buffered)
+    buffered_stream.close();
+
+  perf_test::PrintResult(
+      buffered ? "buffered_stream" : "file_stream",
+      stringFormatMany("_{}b", payload_size), getMethodName(method),
+      static_cast<double>(total_bytes) / 1024 / total_time_milliseconds,
+      "KiB/ms", true);
+}
+
+} // namespace
+
+TEST_F(FileStreamPerfTest, SmallSegmentWrites) {
+  const Method Methods[] = {
+    Method::WritePerSegment,
+    Method::CopyThenWrite,
+    Method::WriteV,
+    Method::BatchedWriteV,
+  };
+  for (int payload_size : PayloadSizes) {
+    for (Method method : Methods) {
+      runWrites(method, payload_size, false);
+      runWrites(method, payload_size, true);
+    }
+  }
+}
+
+} // namespace stp
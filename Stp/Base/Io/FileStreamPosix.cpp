@@ -10,10 +10,17 @@
 #include "Base/Posix/EintrWrapper.h"
 #include "Base/Posix/PosixErrorCode.h"
 #include "Base/Posix/StatWrapper.h"
+#include "Base/Type/Limits.h"
 
 #include <fcntl.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
+#if OS(LINUX) || OS(ANDROID)
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#endif
+
 namespace stp {
 
 static_assert(static_cast<int>(SeekOrigin::Begin) == SEEK_SET &&
@@ -128,6 +135,8 @@ void FileStream::write(BufferSpan input) {
 #define pwrite pwrite64
 #define lseek lseek64
 #define ftruncate ftruncate64
+#define preadv preadv64
+#define pwritev pwritev64
 #endif
 
 void FileStream::positionalRead(int64_t offset, MutableBufferSpan output) {
@@ -174,6 +183,236 @@ void FileStream::positionalWrite(int64_t offset, BufferSpan input) {
   } while (!input.isEmpty());
 }
 
+namespace {
+
+// Well below IOV_MAX on every supported system.
+constexpr int MaxIoVectors = 64;
+
+// Converts a list of buffers into batches of iovec and consumes them
+// as the data is transferred by the kernel.
+template<typename TBuffer>
+class IoVectorCursor {
+ public:
+  explicit IoVectorCursor(Span<TBuffer> buffers) : buffers_(buffers) { advance(0); }
+
+  bool isDone() const { return index_ == buffers_.size(); }
+
+  // Returns number of vectors filled.
+  int fill(iovec* vectors) const {
+    int count = 0;
+    // Total size must fit in the return value of the system call.
+    int remaining = Limits<int>::Max;
+    for (int i = index_; i < buffers_.size() && count < MaxIoVectors && remaining > 0; ++i) {
+      int offset = i == index_ ? offset_ : 0;
+      int size = min(buffers_[i].size() - offset, remaining);
+      const byte_t* data = static_cast<const byte_t*>(buffers_[i].data()) + offset;
+      vectors[count].iov_base = const_cast<byte_t*>(data);
+      vectors[count].iov_len = toUnsigned(size);
+      remaining -= size;
+      ++count;
+    }
+    return count;
+  }
+
+  // Skips |bytes| and all empty buffers following them.
+  void advance(int bytes) {
+    offset_ += bytes;
+    while (index_ < buffers_.size() && offset_ >= buffers_[index_].size()) {
+      offset_ -= buffers_[index_].size();
+      ++index_;
+    }
+  }
+
+ private:
+  Span<TBuffer> buffers_;
+  int index_ = 0;
+  int offset_ = 0;
+};
+
+} // namespace
+
+int FileStream::readV(Span<MutableBufferSpan> outputs) {
+  ASSERT(canRead());
+  int bytes_read = 0;
+  int fd = native_.get();
+  IoVectorCursor<MutableBufferSpan> cursor(outputs);
+  iovec vectors[MaxIoVectors];
+  while (!cursor.isDone()) {
+    int count = cursor.fill(vectors);
+    int rv = static_cast<int>(::readv(fd, vectors, count));
+    if (rv > 0) {
+      cursor.advance(rv);
+      bytes_read += rv;
+    } else {
+      if (rv == 0)
+        break;
+      if (errno != EINTR)
+        throw SystemException(getLastPosixErrorCode());
+    }
+  }
+  return bytes_read;
+}
+
+void FileStream::writeV(Span<BufferSpan> inputs) {
+  ASSERT(canWrite());
+  int fd = native_.get();
+  IoVectorCursor<BufferSpan> cursor(inputs);
+  iovec vectors[MaxIoVectors];
+  while (!cursor.isDone()) {
+    int count = cursor.fill(vectors);
+    int rv = static_cast<int>(::writev(fd, vectors, count));
+    if (rv >= 0) {
+      ASSERT(rv != 0);
+      cursor.advance(rv);
+    } else {
+      if (errno != EINTR)
+        throw SystemException(getLastPosixErrorCode());
+    }
+  }
+}
+
+void FileStream::positionalReadV(int64_t offset, Span<MutableBufferSpan> outputs) {
+  ASSERT(canRead() && canSeek());
+  ASSERT(offset >= 0);
+  int fd = native_.get();
+  IoVectorCursor<MutableBufferSpan> cursor(outputs);
+  iovec vectors[MaxIoVectors];
+  while (!cursor.isDone()) {
+    int count = cursor.fill(vectors);
+    int rv = static_cast<int>(::preadv(fd, vectors, count, offset));
+    if (rv > 0) {
+      offset += rv;
+      cursor.advance(rv);
+    } else {
+      if (rv == 0)
+        throw EndOfStreamException();
+      if (errno != EINTR)
+        throw SystemException(getLastPosixErrorCode());
+    }
+  }
+}
+
+void FileStream::positionalWriteV(int64_t offset, Span<BufferSpan> inputs) {
+  ASSERT(canWrite() && canSeek());
+  ASSERT(!append_);
+  int fd = native_.get();
+  IoVectorCursor<BufferSpan> cursor(inputs);
+  iovec vectors[MaxIoVectors];
+  while (!cursor.isDone()) {
+    int count = cursor.fill(vectors);
+    int rv = static_cast<int>(::pwritev(fd, vectors, count, offset));
+    if (rv >= 0) {
+      ASSERT(rv != 0);
+      offset += rv;
+      cursor.advance(rv);
+    } else {
+      if (errno != EINTR)
+        throw SystemException(getLastPosixErrorCode());
+    }
+  }
+}
+
+#if OS(LINUX) || OS(ANDROID)
+namespace {
+
+// Ways to move data between descriptors within the kernel, most capable
+// first. copy_file_range() works between regular files only (and may share
+// extents on copy-on-write filesystems), sendfile() needs input to be
+// a regular file, splice() needs either end to be a pipe.
+enum class KernelTransfer {
+  CopyFileRange,
+  SendFile,
+  Splice,
+  None,
+};
+
+ssize_t transferChunk(KernelTransfer method, int in_fd, int out_fd, size_t count) {
+  switch (method) {
+    case KernelTransfer::CopyFileRange:
+      #if defined(__NR_copy_file_range)
+      return ::syscall(__NR_copy_file_range, in_fd, nullptr, out_fd, nullptr, count, 0);
+      #else
+      errno = ENOSYS;
+      return -1;
+      #endif
+    case KernelTransfer::SendFile:
+      return ::sendfile(out_fd, in_fd, nullptr, count);
+    case KernelTransfer::Splice:
+      return ::splice(in_fd, nullptr, out_fd, nullptr, count, SPLICE_F_MOVE);
+    case KernelTransfer::None:
+      break;
+  }
+  ASSERT(false);
+  return -1;
+}
+
+// Returns true if |error| means the method cannot be used for given pair
+// of descriptors (as opposite to I/O error).
+bool isTransferUnsupported(KernelTransfer method, int error) {
+  switch (error) {
+    case EINVAL:
+    case ENOSYS:
+    case EXDEV:
+    case EOPNOTSUPP:
+    #if ENOTSUP != EOPNOTSUPP
+    case ENOTSUP:
+    #endif
+      return true;
+    case EBADF:
+      // copy_file_range() refuses output opened in append mode.
+      return method == KernelTransfer::CopyFileRange;
+  }
+  return false;
+}
+
+} // namespace
+#endif // OS(LINUX) || OS(ANDROID)
+
+int64_t FileStream::transferTo(Stream& target, int64_t max_count) {
+  ASSERT(canRead());
+  ASSERT(max_count >= 0);
+  int64_t transferred = 0;
+
+  #if OS(LINUX) || OS(ANDROID)
+  FileStream* target_file = tryObjectCast<FileStream>(target);
+  if (target_file) {
+    ASSERT(target_file->canWrite());
+    // Keep chunks within ssize_t on 32-bit systems.
+    const int64_t MaxChunkSize = 1 << 30;
+    int in_fd = native_.get();
+    int out_fd = target_file->native_.get();
+
+    // Descriptors are used with their file offsets, so falling back to
+    // other method in the middle of transfer is safe.
+    KernelTransfer method = KernelTransfer::CopyFileRange;
+    while (method != KernelTransfer::None && transferred < max_count) {
+      size_t count = static_cast<size_t>(min(max_count - transferred, MaxChunkSize));
+      ssize_t rv = transferChunk(method, in_fd, out_fd, count);
+      if (rv > 0) {
+        transferred += rv;
+      } else if (rv == 0) {
+        // End of input, unless nothing was transferred yet. Files which report
+        // zero size (like those in /proc) look empty to copy_file_range()
+        // and need to be read by other method.
+        if (transferred != 0)
+          return transferred;
+        method = static_cast<KernelTransfer>(static_cast<int>(method) + 1);
+      } else if (errno == EINTR) {
+        continue;
+      } else if (isTransferUnsupported(method, errno)) {
+        method = static_cast<KernelTransfer>(static_cast<int>(method) + 1);
+      } else {
+        throw SystemException(getLastPosixErrorCode());
+      }
+    }
+    if (transferred == max_count)
+      return transferred;
+  }
+  #endif // OS(LINUX) || OS(ANDROID)
+
+  return transferred + Stream::transferTo(target, max_count - transferred);
+}
+
 int64_t FileStream::seek(int64_t offset, SeekOrigin origin) {
   ASSERT(canSeek());
   int64_t rv = ::lseek(native_.get(), offset, static_cast<int>(origin));
@@ -0,0 +1,147 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Io/IoRing.h"
+
+namespace stp {
+
+IoRing::IoRing(int queue_depth, BackendType backend)
+    : queue_depth_(queue_depth) {
+  ASSERT(queue_depth > 0);
+  if (backend == BackendType::Auto)
+    backend_ = tryCreateNativeBackend(queue_depth);
+  if (!backend_)
+    backend_ = createThreadBackend(queue_depth);
+}
+
+IoRing::~IoRing() {
+  // Operations which were never started are dropped without callback.
+  for (Operation* operation : queued_)
+    delete operation;
+  queued_.clear();
+
+  // Kernel or workers may still write to buffers of in-flight operations.
+  while (in_flight_ > 0)
+    wait(in_flight_);
+  while (free_operations_) {
+    Operation* next = free_operations_->next_free;
+    delete free_operations_;
+    free_operations_ = next;
+  }
+}
+
+bool IoRing::isNative() const {
+  return backend_->isNative();
+}
+
+void IoRing::registerBuffers(Span<MutableBufferSpan> buffers) {
+  ASSERT(in_flight_ == 0);
+  backend_->registerBuffers(buffers);
+}
+
+void IoRing::unregisterBuffers() {
+  ASSERT(in_flight_ == 0);
+  backend_->unregisterBuffers();
+}
+
+void IoRing::queueRead(NativeFile file, int64_t offset, MutableBufferSpan output, Callback callback) {
+  queue(Operation::Read, file, offset, output.data(), output.size(), -1, move(callback));
+}
+
+void IoRing::queueWrite(NativeFile file, int64_t offset, BufferSpan input, Callback callback) {
+  queue(Operation::Write, file, offset, const_cast<void*>(input.data()), input.size(), -1, move(callback));
+}
+
+void IoRing::queueReadFixed(
+    NativeFile file, int64_t offset, int buffer_index,
+    MutableBufferSpan output, Callback callback) {
+  ASSERT(buffer_index >= 0);
+  queue(Operation::Read, file, offset, output.data(), output.size(), buffer_index, move(callback));
+}
+
+void IoRing::queueWriteFixed(
+    NativeFile file, int64_t offset, int buffer_index,
+    BufferSpan input, Callback callback) {
+  ASSERT(buffer_index >= 0);
+  queue(Operation::Write, file, offset, const_cast<void*>(input.data()), input.size(),
+        buffer_index, move(callback));
+}
+
+void IoRing::queue(
+    Operation::Type type, NativeFile file, int64_t offset,
+    void* data, int size, int buffer_index, Callback callback) {
+  ASSERT(offset >= 0);
+  ASSERT(size >= 0);
+
+  Operation* operation = free_operations_;
+  if (operation)
+    free_operations_ = operation->next_free;
+  else
+    operation = new Operation();
+
+  operation->type = type;
+  operation->file = file;
+  operation->offset = offset;
+  operation->data = data;
+  operation->size = size;
+  operation->buffer_index = buffer_index;
+  operation->callback = move(callback);
+  operation->next_free = nullptr;
+  queued_.add(operation);
+}
+
+int IoRing::submit() {
+  int count = min(queued_.size(), queue_depth_ - in_flight_);
+  if (count <= 0)
+    return 0;
+
+  backend_->submit(queued_.slice(0, count));
+  queued_.removePrefix(count);
+  in_flight_ += count;
+  return count;
+}
+
+int IoRing::wait(int min_completions) {
+  ASSERT(min_completions >= 0);
+  min_completions = min(min_completions, in_flight_);
+
+  ASSERT(completions_.isEmpty());
+  backend_->reap(min_completions, completions_);
+
+  int count = completions_.size();
+  in_flight_ -= count;
+  // Callbacks may queue new operations and call submit() but not wait().
+  for (const Completion& completion : completions_) {
+    Operation* operation = completion.operation;
+    Callback callback = move(operation->callback);
+    operation->next_free = free_operations_;
+    free_operations_ = operation;
+
+    if (completion.result >= 0)
+      callback(SystemErrorCode::Ok, completion.result);
+    else
+      callback(static_cast<SystemErrorCode>(-completion.result), 0);
+  }
+  completions_.clear();
+
+  // Freed slots let operations queued beyond queue depth start.
+  if (!queued_.isEmpty())
+    submit();
+  return count;
+}
+
+void IoRing::drain() {
+  submit();
+  while (getPendingCount() > 0) {
+    wait(in_flight_);
+    submit();
+  }
+}
+
+#if !OS(LINUX)
+OwnPtr<IoRing::Backend> IoRing::tryCreateNativeBackend(int queue_depth) {
+  return nullptr;
+}
+#endif
+
+} // namespace stp
@@ -0,0 +1,141 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#ifndef STP_BASE_IO_IORING_H_
+#define STP_BASE_IO_IORING_H_
+
+#include "Base/Containers/BufferSpan.h"
+#include "Base/Containers/List.h"
+#include "Base/Error/SystemErrorCode.h"
+#include "Base/FileSystem/File.h"
+#include "Base/Memory/OwnPtr.h"
+#include "Base/Util/Function.h"
+
+namespace stp {
+
+// Batched asynchronous positional I/O on files (POSIX only).
+//
+// Operations are queued first and then started together with submit().
+// On Linux io_uring is used, which needs a single system call for whole
+// batch. Elsewhere, or when io_uring is not available (old kernel, seccomp
+// sandbox), the operations are executed by a small pool of worker threads.
+//
+// Completion callbacks are always invoked on the thread which calls wait()
+// or poll(), never concurrently. A ring must be used from one thread only.
+//
+//   IoRing ring;
+//   ring.queueRead(file, 0, buffer, [](SystemErrorCode error, int bytes) { ... });
+//   ring.submit();
+//   ring.wait();
+class BASE_EXPORT IoRing {
+ public:
+  // |bytes| is the number of bytes transferred. It may be less than
+  // requested when end of file is reached (like readAtMost()).
+  typedef Function<void(SystemErrorCode error, int bytes)> Callback;
+
+  enum class BackendType {
+    Auto,
+    // Worker threads performing blocking system calls.
+    Threads,
+  };
+
+  // |queue_depth| limits number of operations in flight.
+  explicit IoRing(int queue_depth = 64, BackendType backend = BackendType::Auto);
+  ~IoRing();
+
+  // Returns true if operations are performed by the kernel asynchronously.
+  bool isNative() const;
+
+  int getQueueDepth() const { return queue_depth_; }
+
+  // Registers buffers with the kernel so they are not mapped for every
+  // operation. Use queueReadFixed()/queueWriteFixed() to refer to them.
+  // Must be called when no operation is in flight.
+  void registerBuffers(Span<MutableBufferSpan> buffers);
+  void unregisterBuffers();
+
+  void queueRead(NativeFile file, int64_t offset, MutableBufferSpan output, Callback callback);
+  void queueWrite(NativeFile file, int64_t offset, BufferSpan input, Callback callback);
+
+  // |output|/|input| must lie within buffer registered at |buffer_index|.
+  void queueReadFixed(
+      NativeFile file, int64_t offset, int buffer_index,
+      MutableBufferSpan output, Callback callback);
+  void queueWriteFixed(
+      NativeFile file, int64_t offset, int buffer_index,
+      BufferSpan input, Callback callback);
+
+  // Starts all queued operations. Operations beyond queue depth stay queued
+  // until some in-flight operation completes.
+  // Returns the number of operations started.
+  int submit();
+
+  // Waits for at least |min_completions| operations to complete
+  // (or all in-flight ones if fewer) and invokes their callbacks.
+  // Returns number of callbacks invoked.
+  int wait(int min_completions = 1);
+
+  // Invokes callbacks of already completed operations without blocking.
+  int poll() { return wait(0); }
+
+  // Submits and waits for all operations.
+  void drain();
+
+  // Returns number of queued and in-flight operations.
+  int getPendingCount() const { return queued_.size() + in_flight_; }
+
+  // Implementation details shared with backends.
+
+  struct Operation {
+    enum Type : uint8_t { Read, Write };
+
+    Type type;
+    NativeFile file;
+    int64_t offset;
+    void* data;
+    int size;
+    // -1 for not registered buffer.
+    int buffer_index;
+    Callback callback;
+    Operation* next_free;
+  };
+
+  struct Completion {
+    Operation* operation;
+    // Number of bytes transferred or negative error code.
+    int result;
+  };
+
+  class Backend {
+   public:
+    virtual ~Backend() {}
+    virtual bool isNative() const = 0;
+    virtual void registerBuffers(Span<MutableBufferSpan> buffers) = 0;
+    virtual void unregisterBuffers() = 0;
+    // Starts given operations, all or none.
+    virtual void submit(Span<Operation*> operations) = 0;
+    // Appends at least |min_completions| completions to |out|.
+    virtual void reap(int min_completions, List<Completion>& out) = 0;
+  };
+
+ private:
+  OwnPtr<Backend> backend_;
+  int queue_depth_;
+  int in_flight_ = 0;
+  List<Operation*> queued_;
+  List<Completion> completions_;
+  Operation* free_operations_ = nullptr;
+
+  void queue(
+      Operation::Type type, NativeFile file, int64_t offset,
+      void* data, int size, int buffer_index, Callback callback);
+
+  static OwnPtr<Backend> tryCreateNativeBackend(int queue_depth);
+  static OwnPtr<Backend> createThreadBackend(int queue_depth);
+
+  DISALLOW_COPY_AND_ASSIGN(IoRing);
+};
+
+} // namespace stp
+
+#endif // STP_BASE_IO_IORING_H_
@@ -0,0 +1,264 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Io/IoRing.h"
+
+#include "Base/Error/SystemException.h"
+#include "Base/Posix/EintrWrapper.h"
+#include "Base/Posix/PosixErrorCode.h"
+#include "Base/Thread/AtomicOps.h"
+
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace stp {
+
+namespace {
+
+// There is no io_uring wrapper in libc - talk to the kernel directly.
+
+int ioUringSetup(unsigned entries, io_uring_params* params) {
+  return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ioUringEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+  return static_cast<int>(::syscall(
+      __NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int ioUringRegister(int fd, unsigned opcode, const void* arg, unsigned nr_args) {
+  return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+// Ring indices are shared with the kernel.
+inline uint32_t loadAcquire(const uint32_t* ptr) {
+  return static_cast<uint32_t>(subtle::Acquire_Load(reinterpret_cast<const volatile subtle::Atomic32*>(ptr)));
+}
+
+inline void storeRelease(uint32_t* ptr, uint32_t value) {
+  subtle::Release_Store(reinterpret_cast<volatile subtle::Atomic32*>(ptr), static_cast<subtle::Atomic32>(value));
+}
+
+class UringIoRingBackend final : public IoRing::Backend {
+ public:
+  UringIoRingBackend() {}
+  ~UringIoRingBackend() override;
+
+  bool init(int queue_depth);
+
+  bool isNative() const override { return true; }
+  void registerBuffers(Span<MutableBufferSpan> buffers) override;
+  void unregisterBuffers() override;
+  void submit(Span<IoRing::Operation*> operations) override;
+  void reap(int min_completions, List<IoRing::Completion>& out) override;
+
+ private:
+  int ring_fd_ = -1;
+
+  void* sq_ring_ = nullptr;
+  size_t sq_ring_size_ = 0;
+  void* cq_ring_ = nullptr;
+  size_t cq_ring_size_ = 0;
+  io_uring_sqe* sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+
+  uint32_t* sq_head_ = nullptr;
+  uint32_t* sq_tail_ = nullptr;
+  uint32_t sq_mask_ = 0;
+  uint32_t sq_entries_ = 0;
+  uint32_t* sq_array_ = nullptr;
+
+  uint32_t* cq_head_ = nullptr;
+  uint32_t* cq_tail_ = nullptr;
+  uint32_t cq_mask_ = 0;
+  io_uring_cqe* cqes_ = nullptr;
+
+  bool buffers_registered_ = false;
+
+  bool isSupported();
+  void enter(unsigned to_submit, unsigned min_complete, unsigned flags);
+};
+
+UringIoRingBackend::~UringIoRingBackend() {
+  if (sqes_)
+    ::munmap(sqes_, sqes_size_);
+  if (cq_ring_ && cq_ring_ != sq_ring_)
+    ::munmap(cq_ring_, cq_ring_size_);
+  if (sq_ring_)
+    ::munmap(sq_ring_, sq_ring_size_);
+  if (ring_fd_ >= 0)
+    IGNORE_EINTR(::close(ring_fd_));
+}
+
+bool UringIoRingBackend::init(int queue_depth) {
+  io_uring_params params = {};
+  ring_fd_ = ioUringSetup(static_cast<unsigned>(queue_depth), &params);
+  if (ring_fd_ < 0)
+    return false;
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap)
+    sq_ring_size_ = cq_ring_size_ = max(sq_ring_size_, cq_ring_size_);
+
+  void* sq_ring = ::mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+  if (sq_ring == MAP_FAILED)
+    return false;
+  sq_ring_ = sq_ring;
+
+  if (single_mmap) {
+    cq_ring_ = sq_ring_;
+  } else {
+    void* cq_ring = ::mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+    if (cq_ring == MAP_FAILED)
+      return false;
+    cq_ring_ = cq_ring;
+  }
+
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  void* sqes = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED)
+    return false;
+  sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+  byte_t* sq = static_cast<byte_t*>(sq_ring_);
+  sq_head_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+  sq_mask_ = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+  sq_entries_ = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_entries);
+  sq_array_ = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+
+  byte_t* cq = static_cast<byte_t*>(cq_ring_);
+  cq_head_ = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+  cq_mask_ = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+  return isSupported();
+}
+
+// Plain IORING_OP_READ/WRITE appeared later than io_uring itself.
+bool UringIoRingBackend::isSupported() {
+  const int OpCount = 64;
+  byte_t storage[sizeof(io_uring_probe) + OpCount * sizeof(io_uring_probe_op)] = {};
+  auto* probe = reinterpret_cast<io_uring_probe*>(storage);
+  if (ioUringRegister(ring_fd_, IORING_REGISTER_PROBE, probe, OpCount) < 0)
+    return false;
+
+  const int RequiredOps[] = {
+    IORING_OP_READ, IORING_OP_WRITE, IORING_OP_READ_FIXED, IORING_OP_WRITE_FIXED,
+  };
+  for (int op : RequiredOps) {
+    if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED))
+      return false;
+  }
+  return true;
+}
+
+void UringIoRingBackend::registerBuffers(Span<MutableBufferSpan> buffers) {
+  ASSERT(!buffers_registered_);
+  List<iovec> vectors;
+  vectors.ensureCapacity(buffers.size());
+  for (MutableBufferSpan buffer : buffers)
+    vectors.add(iovec { buffer.data(), toUnsigned(buffer.size()) });
+
+  if (ioUringRegister(ring_fd_, IORING_REGISTER_BUFFERS, vectors.data(), toUnsigned(vectors.size())) < 0)
+    throw SystemException(getLastPosixErrorCode());
+  buffers_registered_ = true;
+}
+
+void UringIoRingBackend::unregisterBuffers() {
+  if (!buffers_registered_)
+    return;
+  if (ioUringRegister(ring_fd_, IORING_UNREGISTER_BUFFERS, nullptr, 0) < 0)
+    throw SystemException(getLastPosixErrorCode());
+  buffers_registered_ = false;
+}
+
+void UringIoRingBackend::enter(unsigned to_submit, unsigned min_complete, unsigned flags) {
+  while (to_submit > 0 || min_complete > 0) {
+    int rv = ioUringEnter(ring_fd_, to_submit, min_complete, flags);
+    if (rv < 0) {
+      if (errno == EINTR)
+        continue;
+      throw SystemException(getLastPosixErrorCode());
+    }
+    // All entries are consumed unless the kernel runs out of memory.
+    ASSERT(static_cast<unsigned>(rv) <= to_submit);
+    to_submit -= static_cast<unsigned>(rv);
+    if (min_complete > 0)
+      break;
+  }
+}
+
+void UringIoRingBackend::submit(Span<IoRing::Operation*> operations) {
+  // IoRing never puts more operations in flight than queue depth,
+  // and completion ring is twice as large as submission ring.
+  ASSERT(static_cast<unsigned>(operations.size()) <= sq_entries_);
+
+  uint32_t tail = *sq_tail_;
+  for (IoRing::Operation* operation : operations) {
+    uint32_t index = tail & sq_mask_;
+    io_uring_sqe& sqe = sqes_[index];
+    sqe = io_uring_sqe();
+
+    bool fixed = operation->buffer_index >= 0;
+    if (operation->type == IoRing::Operation::Read)
+      sqe.opcode = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    else
+      sqe.opcode = fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    sqe.fd = operation->file;
+    sqe.off = static_cast<uint64_t>(operation->offset);
+    sqe.addr = reinterpret_cast<uint64_t>(operation->data);
+    sqe.len = static_cast<uint32_t>(operation->size);
+    if (fixed)
+      sqe.buf_index = static_cast<uint16_t>(operation->buffer_index);
+    sqe.user_data = reinterpret_cast<uint64_t>(operation);
+
+    sq_array_[index] = index;
+    ++tail;
+  }
+  // Publish entries before the kernel sees new tail.
+  storeRelease(sq_tail_, tail);
+
+  enter(static_cast<unsigned>(operations.size()), 0, 0);
+}
+
+void UringIoRingBackend::reap(int min_completions, List<IoRing::Completion>& out) {
+  int reaped = 0;
+  while (true) {
+    uint32_t head = *cq_head_;
+    uint32_t tail = loadAcquire(cq_tail_);
+    for (; head != tail; ++head) {
+      const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+      out.add(IoRing::Completion {
+        reinterpret_cast<IoRing::Operation*>(cqe.user_data), cqe.res });
+      ++reaped;
+    }
+    // Let the kernel reuse the entries.
+    storeRelease(cq_head_, head);
+
+    if (reaped >= min_completions)
+      break;
+    enter(0, static_cast<unsigned>(min_completions - reaped), IORING_ENTER_GETEVENTS);
+  }
+}
+
+} // namespace
+
+OwnPtr<IoRing::Backend> IoRing::tryCreateNativeBackend(int queue_depth) {
+  auto backend = OwnPtr<UringIoRingBackend>::create();
+  if (!backend->init(queue_depth))
+    return nullptr;
+  return move(backend);
+}
+
+} // namespace stp
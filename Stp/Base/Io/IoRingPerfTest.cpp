@@ -0,0 +1,134 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Io/IoRing.h"
+
+#include "Base/FileSystem/TemporaryDirectory.h"
+#include "Base/Io/FileStream.h"
+#include "Base/Test/GTest.h"
+#include "Base/Test/PerfTest.h"
+#include "Base/Text/StringFormatMany.h"
+#include "Base/Time/TimeTicks.h"
+
+namespace stp {
+
+// The file stays in page cache, so the numbers show system call and
+// dispatch overhead rather than device latency.
+static const int64_t FileSize = 64 << 20;
+static const int SmallBlockSize = 4 << 10;
+static const int LargeBlockSize = 1 << 20;
+static const int RandomReadCount = 32768;
+static const int QueueDepths[] = { 1, 2, 4, 8, 16, 32, 64, 128 };
+
+namespace {
+
+class IoRingPerfTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    temp_dir_.create();
+    stream_.create(combineFilePaths(temp_dir_.path(), FilePath::fromString("io_ring_perf")));
+
+    List<byte_t> chunk;
+    byte_t* chunk_data = chunk.appendUninitialized(LargeBlockSize);
+    for (int i = 0; i < chunk.size(); ++i)
+      chunk_data[i] = static_cast<byte_t>(i);
+    for (int64_t written = 0; written < FileSize; written += chunk.size())
+      stream_.write(BufferSpan(chunk_data, chunk.size()));
+  }
+
+  // Returns offset of |index|-th block to read.
+  static int64_t getOffset(int index, int block_size, bool random) {
+    int64_t block_count = FileSize / block_size;
+    if (!random)
+      return (index % block_count) * block_size;
+    uint32_t hash = static_cast<uint32_t>(index) * 2654435761u;
+    return (hash % block_count) * block_size;
+  }
+
+  void runSyncReads(const char* measurement, int block_size, int count, bool random);
+  void runRingReads(
+      const char* measurement, IoRing::BackendType backend,
+      int queue_depth, int block_size, int count, bool random);
+
+  TemporaryDirectory temp_dir_;
+  FileStream stream_;
+};
+
+void IoRingPerfTest::runSyncReads(const char* measurement, int block_size, int count, bool random) {
+  List<byte_t> buffer;
+  byte_t* buffer_data = buffer.appendUninitialized(block_size);
+
+  TimeTicks start = TimeTicks::Now();
+  for (int i = 0; i < count; ++i)
+    stream_.positionalRead(getOffset(i, block_size, random), MutableBufferSpan(buffer_data, block_size));
+  double total_time_milliseconds = (TimeTicks::Now() - start).InMillisecondsF();
+
+  perf_test::PrintResult(
+      measurement, "", "positional_read",
+      static_cast<double>(count) * block_size / 1024 / total_time_milliseconds,
+      "KiB/ms", true);
+}
+
+void IoRingPerfTest::runRingReads(
+    const char* measurement, IoRing::BackendType backend,
+    int queue_depth, int block_size, int count, bool random) {
+  IoRing ring(queue_depth, backend);
+
+  List<byte_t> buffers;
+  byte_t* buffers_data = buffers.appendUninitialized(queue_depth * block_size);
+  List<int> free_slots;
+  for (int i = 0; i < queue_depth; ++i)
+    free_slots.add(i);
+
+  TimeTicks start = TimeTicks::Now();
+  int issued = 0;
+  while (issued < count || ring.getPendingCount() > 0) {
+    // Keep the queue full.
+    while (issued < count && !free_slots.isEmpty()) {
+      int slot = free_slots.last();
+      free_slots.removeLast();
+      ring.queueRead(
+          stream_.getNativeFile(), getOffset(issued, block_size, random),
+          MutableBufferSpan(buffers_data + slot * block_size, block_size),
+          [&free_slots, slot](SystemErrorCode error, int bytes) {
+        ASSERT(isOk(error));
+        free_slots.add(slot);
+      });
+      ++issued;
+    }
+    ring.submit();
+    ring.wait(1);
+  }
+  double total_time_milliseconds = (TimeTicks::Now() - start).InMillisecondsF();
+
+  perf_test::PrintResult(
+      measurement, stringFormatMany("_qd{}", queue_depth),
+      ring.isNative() ? "io_uring" : "threads",
+      static_cast<double>(count) * block_size / 1024 / total_time_milliseconds,
+      "KiB/ms", true);
+}
+
+} // namespace
+
+TEST_F(IoRingPerfTest, RandomSmallReads) {
+  runSyncReads("random_4k", SmallBlockSize, RandomReadCount, true);
+  for (int queue_depth : QueueDepths) {
+    runRingReads("random_4k", IoRing::BackendType::Auto,
+                 queue_depth, SmallBlockSize, RandomReadCount, true);
+    runRingReads("random_4k", IoRing::BackendType::Threads,
+                 queue_depth, SmallBlockSize, RandomReadCount, true);
+  }
+}
+
+TEST_F(IoRingPerfTest, SequentialLargeReads) {
+  const int ReadCount = static_cast<int>(4 * FileSize / LargeBlockSize);
+  runSyncReads("sequential_1m", LargeBlockSize, ReadCount, false);
+  for (int queue_depth : QueueDepths) {
+    runRingReads("sequential_1m", IoRing::BackendType::Auto,
+                 queue_depth, LargeBlockSize, ReadCount, false);
+    runRingReads("sequential_1m", IoRing::BackendType::Threads,
+                 queue_depth, LargeBlockSize, ReadCount, false);
+  }
+}
+
+} // namespace stp
@@ -0,0 +1,133 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Io/IoRing.h"
+
+#include "Base/Posix/EintrWrapper.h"
+#include "Base/Thread/ConditionVariable.h"
+#include "Base/Thread/Lock.h"
+#include "Base/Thread/Thread.h"
+
+#include <errno.h>
+#include <unistd.h>
+
+namespace stp {
+
+namespace {
+
+// Executes operations with blocking pread()/pwrite() on worker threads.
+class ThreadIoRingBackend final : public IoRing::Backend {
+ public:
+  explicit ThreadIoRingBackend(int queue_depth);
+  ~ThreadIoRingBackend() override;
+
+  bool isNative() const override { return false; }
+  void registerBuffers(Span<MutableBufferSpan> buffers) override {}
+  void unregisterBuffers() override {}
+  void submit(Span<IoRing::Operation*> operations) override;
+  void reap(int min_completions, List<IoRing::Completion>& out) override;
+
+ private:
+  class Worker : public Thread {
+   public:
+    explicit Worker(ThreadIoRingBackend* backend) : backend_(*backend) {}
+
+   protected:
+    int Main() override;
+
+   private:
+    ThreadIoRingBackend& backend_;
+  };
+
+  Lock lock_;
+  // Signaled when new operation is submitted or backend is shutting down.
+  ConditionVariable submitted_;
+  // Signaled when an operation completes.
+  ConditionVariable completed_;
+  List<IoRing::Operation*> submitted_operations_;
+  List<IoRing::Completion> completions_;
+  List<OwnPtr<Worker>> workers_;
+  bool shutting_down_ = false;
+
+  static int perform(const IoRing::Operation& operation);
+};
+
+ThreadIoRingBackend::ThreadIoRingBackend(int queue_depth)
+    : submitted_(&lock_),
+      completed_(&lock_) {
+  // More threads help to keep device queue full with high queue depth,
+  // but each costs a stack.
+  int worker_count = min(queue_depth, 8);
+  for (int i = 0; i < worker_count; ++i) {
+    workers_.add(OwnPtr<Worker>::create(this));
+    workers_.last()->Start();
+  }
+}
+
+ThreadIoRingBackend::~ThreadIoRingBackend() {
+  {
+    AutoLock guard(borrow(lock_));
+    shutting_down_ = true;
+    submitted_.Broadcast();
+  }
+  for (auto& worker : workers_)
+    worker->Join();
+}
+
+void ThreadIoRingBackend::submit(Span<IoRing::Operation*> operations) {
+  AutoLock guard(borrow(lock_));
+  submitted_operations_.append(operations);
+  if (operations.size() == 1)
+    submitted_.Signal();
+  else
+    submitted_.Broadcast();
+}
+
+void ThreadIoRingBackend::reap(int min_completions, List<IoRing::Completion>& out) {
+  AutoLock guard(borrow(lock_));
+  while (completions_.size() < min_completions)
+    completed_.Wait();
+  out.append(completions_);
+  completions_.clear();
+}
+
+int ThreadIoRingBackend::Worker::Main() {
+  AutoLock guard(borrow(backend_.lock_));
+  while (true) {
+    while (backend_.submitted_operations_.isEmpty() && !backend_.shutting_down_)
+      backend_.submitted_.Wait();
+    if (backend_.shutting_down_)
+      break;
+
+    IoRing::Operation* operation = backend_.submitted_operations_.first();
+    backend_.submitted_operations_.removeAt(0);
+
+    int result;
+    {
+      AutoUnlock unguard(&backend_.lock_);
+      result = perform(*operation);
+    }
+    backend_.completions_.add(IoRing::Completion { operation, result });
+    backend_.completed_.Signal();
+  }
+  return 0;
+}
+
+int ThreadIoRingBackend::perform(const IoRing::Operation& operation) {
+  // Single attempt only - short transfer is reported to the user like
+  // io_uring does.
+  ssize_t rv;
+  if (operation.type == IoRing::Operation::Read)
+    rv = HANDLE_EINTR(::pread(operation.file, operation.data, toUnsigned(operation.size), operation.offset));
+  else
+    rv = HANDLE_EINTR(::pwrite(operation.file, operation.data, toUnsigned(operation.size), operation.offset));
+  return rv >= 0 ? static_cast<int>(rv) : -errno;
+}
+
+} // namespace
+
+OwnPtr<IoRing::Backend> IoRing::createThreadBackend(int queue_depth) {
+  return OwnPtr<ThreadIoRingBackend>::create(queue_depth);
+}
+
+} // namespace stp
@@ -0,0 +1,156 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Io/IoRing.h"
+
+#include "Base/FileSystem/TemporaryDirectory.h"
+#include "Base/Io/AsyncFileStream.h"
+#include "Base/Test/GTest.h"
+
+namespace stp {
+
+namespace {
+
+const int BlockSize = 4096;
+const int BlockCount = 64;
+
+const IoRing::BackendType AllBackends[] = {
+  IoRing::BackendType::Auto,
+  IoRing::BackendType::Threads,
+};
+
+class IoRingTestFile {
+ public:
+  IoRingTestFile() {
+    temp_dir_.create();
+    stream_.create(combineFilePaths(temp_dir_.path(), FilePath::fromString("io_ring_file")));
+
+    byte_t* data = data_.appendUninitialized(BlockSize * BlockCount);
+    for (int i = 0; i < data_.size(); ++i)
+      data[i] = static_cast<byte_t>(i * 7 + i / BlockSize);
+    stream_.write(BufferSpan(data_.data(), data_.size()));
+  }
+
+  FileStream& stream() { return stream_; }
+  const List<byte_t>& data() const { return data_; }
+
+ private:
+  TemporaryDirectory temp_dir_;
+  FileStream stream_;
+  List<byte_t> data_;
+};
+
+} // namespace
+
+TEST(IoRingTest, BatchedReads) {
+  IoRingTestFile file;
+  for (auto backend : AllBackends) {
+    IoRing ring(8, backend);
+    AsyncFileStream async_stream(ring, file.stream());
+
+    List<byte_t> output;
+    byte_t* output_data = output.appendUninitialized(file.data().size());
+
+    int completed = 0;
+    // More blocks than queue depth - the rest is started as slots free up.
+    for (int i = BlockCount - 1; i >= 0; --i) {
+      async_stream.positionalReadAsync(
+          i * BlockSize, MutableBufferSpan(output_data + i * BlockSize, BlockSize),
+          [&completed](SystemErrorCode error, int bytes) {
+        EXPECT_TRUE(isOk(error));
+        EXPECT_EQ(BlockSize, bytes);
+        ++completed;
+      });
+    }
+    EXPECT_EQ(BlockCount, ring.getPendingCount());
+    ring.drain();
+
+    EXPECT_EQ(BlockCount, completed);
+    EXPECT_EQ(0, ring.getPendingCount());
+    EXPECT_TRUE(output == file.data().toSpan());
+  }
+}
+
+TEST(IoRingTest, WriteThenRead) {
+  IoRingTestFile file;
+  for (auto backend : AllBackends) {
+    IoRing ring(4, backend);
+    AsyncFileStream async_stream(ring, file.stream());
+
+    const byte_t pattern[] = { 1, 2, 3, 4, 5 };
+    bool written = false;
+    async_stream.positionalWriteAsync(
+        100, BufferSpan(pattern, isizeof(pattern)),
+        [&written](SystemErrorCode error, int bytes) {
+      EXPECT_TRUE(isOk(error));
+      EXPECT_EQ(5, bytes);
+      written = true;
+    });
+    ring.drain();
+    ASSERT_TRUE(written);
+
+    byte_t output[5] = {};
+    file.stream().positionalRead(100, MutableBufferSpan(output, isizeof(output)));
+    for (int i = 0; i < 5; ++i)
+      EXPECT_EQ(pattern[i], output[i]);
+  }
+}
+
+TEST(IoRingTest, ShortReadAndError) {
+  IoRingTestFile file;
+  for (auto backend : AllBackends) {
+    IoRing ring(4, backend);
+
+    byte_t output[100];
+    int short_bytes = -1;
+    ring.queueRead(
+        file.stream().getNativeFile(), file.data().size() - 10, MutableBufferSpan(output, 100),
+        [&short_bytes](SystemErrorCode error, int bytes) {
+      EXPECT_TRUE(isOk(error));
+      short_bytes = bytes;
+    });
+
+    bool failed = false;
+    ring.queueRead(
+        InvalidNativeFile, 0, MutableBufferSpan(output, 100),
+        [&failed](SystemErrorCode error, int bytes) {
+      failed = !isOk(error);
+    });
+    ring.drain();
+
+    EXPECT_EQ(10, short_bytes);
+    EXPECT_TRUE(failed);
+  }
+}
+
+TEST(IoRingTest, RegisteredBuffers) {
+  IoRingTestFile file;
+  for (auto backend : AllBackends) {
+    IoRing ring(4, backend);
+
+    List<byte_t> buffer;
+    byte_t* buffer_data = buffer.appendUninitialized(BlockSize * 2);
+    MutableBufferSpan registered(buffer_data, buffer.size());
+    ring.registerBuffers(Span<MutableBufferSpan>(&registered, 1));
+
+    int completed = 0;
+    for (int i = 0; i < 2; ++i) {
+      ring.queueReadFixed(
+          file.stream().getNativeFile(), (i + 3) * BlockSize, 0,
+          MutableBufferSpan(buffer_data + i * BlockSize, BlockSize),
+          [&completed](SystemErrorCode error, int bytes) {
+        EXPECT_TRUE(isOk(error));
+        EXPECT_EQ(BlockSize, bytes);
+        ++completed;
+      });
+    }
+    ring.drain();
+    ring.unregisterBuffers();
+
+    EXPECT_EQ(2, completed);
+    for (int i = 0; i < buffer.size(); ++i)
+      ASSERT_EQ(file.data()[3 * BlockSize + i], buffer[i]);
+  }
+}
+
+} // namespace stp
@@ -0,0 +1,198 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Io/MappedStream.h"
+
+#include "Base/Containers/ArrayOps.h"
+#include "Base/Error/BasicExceptions.h"
+#include "Base/Io/IoException.h"
+#include "Base/Math/PowerOfTwo.h"
+
+namespace stp {
+
+MappedStream::MappedStream() {}
+
+MappedStream::~MappedStream() {}
+
+void MappedStream::setWindowSize(int window_size) {
+  ASSERT(!isOpen());
+  // 64 KiB is the coarsest VM granularity among supported systems.
+  ASSERT(window_size > 0);
+  window_size_ = roundUpToPowerOfTwo(max(window_size, 64 << 10));
+}
+
+void MappedStream::open(const FilePath& path, const MemoryMappedFile::Options& options) {
+  FileStream file;
+  file.open(path, FileMode::OpenExisting, FileAccess::ReadOnly);
+  open(move(file), options);
+}
+
+void MappedStream::open(FileStream&& file, const MemoryMappedFile::Options& options) {
+  ASSERT(!isOpen());
+  int64_t length = file.getLength();
+
+  MemoryMappedFile::Region first_window = MemoryMappedFile::Region::WholeFile;
+  if (length > window_size_)
+    first_window = { 0, window_size_ };
+  file_.open(move(file), first_window, MemoryMappedFile::ReadOnly, options);
+
+  length_ = length;
+  position_ = 0;
+}
+
+void MappedStream::close() {
+  ASSERT(isOpen());
+  file_.close();
+  length_ = 0;
+  position_ = 0;
+}
+
+bool MappedStream::isOpen() const noexcept {
+  return file_.isOpen();
+}
+
+BufferSpan MappedStream::getMappedAt(int64_t position) {
+  if (position >= length_)
+    return BufferSpan();
+
+  int64_t window_offset = file_.getOffset();
+  if (position < window_offset || position >= window_offset + file_.length()) {
+    window_offset = position & ~static_cast<int64_t>(window_size_ - 1);
+    int size = static_cast<int>(min(length_ - window_offset, static_cast<int64_t>(window_size_)));
+    file_.remap({ window_offset, size });
+  }
+  int in_window = static_cast<int>(position - window_offset);
+  // Window never exceeds |window_size_|, so fits in int.
+  return BufferSpan(file_.data() + in_window, static_cast<int>(file_.length()) - in_window);
+}
+
+BufferSpan MappedStream::readSpan(int max_size) {
+  ASSERT(canRead());
+  ASSERT(max_size >= 0);
+  BufferSpan mapped = getMappedAt(position_);
+  if (mapped.size() > max_size)
+    mapped.truncate(max_size);
+  position_ += mapped.size();
+  return mapped;
+}
+
+int MappedStream::readAtMost(MutableBufferSpan output) {
+  int bytes_read = 0;
+  while (!output.isEmpty()) {
+    BufferSpan mapped = readSpan(output.size());
+    if (mapped.isEmpty())
+      break;
+    uninitializedCopy(
+        static_cast<byte_t*>(output.data()),
+        static_cast<const byte_t*>(mapped.data()),
+        mapped.size());
+    output.removePrefix(mapped.size());
+    bytes_read += mapped.size();
+  }
+  return bytes_read;
+}
+
+void MappedStream::write(BufferSpan input) {
+  ASSERT(canWrite());
+  throw NotSupportedException();
+}
+
+void MappedStream::positionalRead(int64_t offset, MutableBufferSpan output) {
+  ASSERT(canRead());
+  ASSERT(offset >= 0);
+  while (!output.isEmpty()) {
+    BufferSpan mapped = getMappedAt(offset);
+    if (mapped.isEmpty())
+      throw EndOfStreamException();
+    int count = min(mapped.size(), output.size());
+    uninitializedCopy(
+        static_cast<byte_t*>(output.data()),
+        static_cast<const byte_t*>(mapped.data()),
+        count);
+    output.removePrefix(count);
+    offset += count;
+  }
+}
+
+int MappedStream::tryReadByte() {
+  BufferSpan mapped = readSpan(1);
+  if (mapped.isEmpty())
+    return -1;
+  return *static_cast<const byte_t*>(mapped.data());
+}
+
+int64_t MappedStream::transferTo(Stream& target, int64_t max_count) {
+  ASSERT(max_count >= 0);
+  // Write directly from the mapping, no intermediate buffer is needed.
+  int64_t transferred = 0;
+  while (transferred < max_count) {
+    BufferSpan mapped = readSpan(static_cast<int>(min(max_count - transferred, static_cast<int64_t>(window_size_))));
+    if (mapped.isEmpty())
+      break;
+    target.write(mapped);
+    transferred += mapped.size();
+  }
+  return transferred;
+}
+
+int64_t MappedStream::seek(int64_t offset, SeekOrigin origin) {
+  ASSERT(canSeek());
+
+  int64_t new_position = 0;
+  switch (origin) {
+    case SeekOrigin::Begin:
+      new_position = offset;
+      break;
+    case SeekOrigin::Current:
+      new_position = position_ + offset;
+      break;
+    case SeekOrigin::End:
+      new_position = length_ + offset;
+      break;
+  }
+  if (new_position < 0)
+    throw IoException();
+
+  position_ = new_position;
+  return new_position;
+}
+
+void MappedStream::flush() {
+  ASSERT(isOpen());
+  // Nothing to do, the stream is read-only.
+}
+
+bool MappedStream::canRead() {
+  return isOpen();
+}
+
+bool MappedStream::canWrite() {
+  return false;
+}
+
+bool MappedStream::canSeek() {
+  return isOpen();
+}
+
+void MappedStream::setLength(int64_t length) {
+  ASSERT(canWrite());
+  throw NotSupportedException();
+}
+
+int64_t MappedStream::getLength() {
+  ASSERT(isOpen());
+  return length_;
+}
+
+void MappedStream::setPosition(int64_t position) {
+  ASSERT(canSeek());
+  ASSERT(position >= 0);
+  position_ = position;
+}
+
+int64_t MappedStream::getPosition() {
+  ASSERT(isOpen());
+  return position_;
+}
+
+} // namespace stp
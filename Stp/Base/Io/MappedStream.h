@@ -0,0 +1,74 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#ifndef STP_BASE_IO_MAPPEDSTREAM_H_
+#define STP_BASE_IO_MAPPEDSTREAM_H_
+
+#include "Base/FileSystem/MemoryMappedFile.h"
+
+namespace stp {
+
+// Read-only stream over memory-mapped file.
+//
+// Reads are served from the mapping, without a system call per read.
+// Files larger than the window are mapped piece by piece, so any file size
+// is supported and address space use stays bounded.
+// The length of the stream is fixed when the file is opened.
+class BASE_EXPORT MappedStream final : public Stream {
+ public:
+  static constexpr int DefaultWindowSize = 64 << 20;
+
+  MappedStream();
+  ~MappedStream() override;
+
+  // Must be called before open(). Rounded up to power of two, so windows
+  // are aligned to VM granularity.
+  void setWindowSize(int window_size);
+  int getWindowSize() const { return window_size_; }
+
+  void open(
+      const FilePath& path,
+      const MemoryMappedFile::Options& options = MemoryMappedFile::Options());
+  void open(
+      FileStream&& file,
+      const MemoryMappedFile::Options& options = MemoryMappedFile::Options());
+
+  // Returns up to |max_size| bytes at current position without copying
+  // and advances the position. Returned span may be shorter at the end of
+  // window; it is empty at the end of stream.
+  // The span is valid until next call to this stream.
+  BufferSpan readSpan(int max_size);
+
+  void close() override;
+  bool isOpen() const noexcept override;
+  int readAtMost(MutableBufferSpan output) override;
+  void write(BufferSpan input) override;
+  void positionalRead(int64_t offset, MutableBufferSpan output) override;
+  int tryReadByte() override;
+  int64_t transferTo(Stream& target, int64_t max_count = Limits<int64_t>::Max) override;
+  int64_t seek(int64_t offset, SeekOrigin origin) override;
+  void flush() override;
+  bool canRead() override;
+  bool canWrite() override;
+  bool canSeek() override;
+  void setLength(int64_t length) override;
+  int64_t getLength() override;
+  void setPosition(int64_t position) override;
+  int64_t getPosition() override;
+
+ private:
+  MemoryMappedFile file_;
+  int64_t length_ = 0;
+  int64_t position_ = 0;
+  int window_size_ = DefaultWindowSize;
+
+  // Returns bytes mapped at |position|, up to the end of window.
+  // Maps a window containing |position| if needed.
+  BufferSpan getMappedAt(int64_t position);
+
+  DISALLOW_COPY_AND_ASSIGN(MappedStream);
+};
+
+} // namespace stp
+
+#endif // STP_BASE_IO_MAPPEDSTREAM_H_
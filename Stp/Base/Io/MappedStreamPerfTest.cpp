@@ -0,0 +1,169 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Io/MappedStream.h"
+
+#include "Base/Containers/List.h"
+#include "Base/FileSystem/TemporaryDirectory.h"
+#include "Base/Test/GTest.h"
+#include "Base/Test/PerfTest.h"
+#include "Base/Time/TimeTicks.h"
+
+#if OS(POSIX)
+#include <fcntl.h>
+#endif
+
+namespace stp {
+
+static const int64_t FileSize = 256 << 20;
+static const int ChunkSize = 1 << 20;
+static const int ReadBufferSize = 64 << 10;
+
+namespace {
+
+class MappedStreamPerfTest : public testing::Test {
+ protected:
+  enum class Method {
+    FileStreamRead,
+    MappedRead,
+    MappedReadSpan,
+    MappedReadSpanSequential,
+    MappedReadSpanPopulate,
+  };
+
+  static const char* getMethodName(Method method) {
+    switch (method) {
+      case Method::FileStreamRead: return "file_stream_read";
+      case Method::MappedRead: return "mapped_read";
+      case Method::MappedReadSpan: return "mapped_read_span";
+      case Method::MappedReadSpanSequential: return "mapped_read_span_sequential";
+      case Method::MappedReadSpanPopulate: return "mapped_read_span_populate";
+    }
+    return nullptr;
+  }
+
+  void SetUp() override {
+    temp_dir_.create();
+    path_ = combineFilePaths(temp_dir_.path(), FilePath::fromString("mapped_stream_perf"));
+
+    List<byte_t> chunk;
+    byte_t* chunk_data = chunk.appendUninitialized(ChunkSize);
+    FileStream file;
+    file.create(path_, FileMode::Create, FileAccess::WriteOnly);
+    for (int64_t written = 0; written < FileSize; written += ChunkSize) {
+      for (int i = 0; i < ChunkSize; i += 8)
+        *reinterpret_cast<int64_t*>(chunk_data + i) = written + i;
+      file.write(BufferSpan(chunk_data, ChunkSize));
+    }
+    file.syncToDisk();
+    file.close();
+  }
+
+  // Drops the file from page cache, so next scan hits the disk.
+  // Only supported on POSIX, elsewhere cold and warm scans are the same.
+  void evictFromCache() {
+    #if OS(POSIX)
+    FileStream file;
+    file.open(path_, FileMode::OpenExisting, FileAccess::ReadOnly);
+    file.syncToDisk();
+    ignoreResult(::posix_fadvise(file.getNativeFile(), 0, 0, POSIX_FADV_DONTNEED));
+    #endif
+  }
+
+  static uint64_t checksum(BufferSpan span) {
+    const byte_t* data = static_cast<const byte_t*>(span.data());
+    uint64_t sum = 0;
+    for (int i = 0; i < span.size(); ++i)
+      sum += data[i];
+    return sum;
+  }
+
+  uint64_t scan(Method method);
+  void runScan(Method method, bool cold);
+
+  TemporaryDirectory temp_dir_;
+  FilePath path_;
+};
+
+uint64_t MappedStreamPerfTest::scan(Method method) {
+  uint64_t sum = 0;
+  if (method == Method::FileStreamRead) {
+    List<byte_t> buffer;
+    byte_t* buffer_data = buffer.appendUninitialized(ReadBufferSize);
+    FileStream file;
+    file.open(path_, FileMode::OpenExisting, FileAccess::ReadOnly);
+    while (true) {
+      int rv = file.readAtMost(MutableBufferSpan(buffer_data, ReadBufferSize));
+      if (rv == 0)
+        break;
+      sum += checksum(BufferSpan(buffer_data, rv));
+    }
+    return sum;
+  }
+
+  MemoryMappedFile::Options options;
+  if (method == Method::MappedReadSpanSequential) {
+    options.pattern = MemoryMappedFile::AccessPattern::Sequential;
+    options.will_need = true;
+  } else if (method == Method::MappedReadSpanPopulate) {
+    options.populate = true;
+  }
+
+  MappedStream stream;
+  stream.open(path_, options);
+  if (method == Method::MappedRead) {
+    List<byte_t> buffer;
+    byte_t* buffer_data = buffer.appendUninitialized(ReadBufferSize);
+    while (true) {
+      int rv = stream.readAtMost(MutableBufferSpan(buffer_data, ReadBufferSize));
+      if (rv == 0)
+        break;
+      sum += checksum(BufferSpan(buffer_data, rv));
+    }
+  } else {
+    while (true) {
+      BufferSpan span = stream.readSpan(ReadBufferSize);
+      if (span.isEmpty())
+        break;
+      sum += checksum(span);
+    }
+  }
+  return sum;
+}
+
+void MappedStreamPerfTest::runScan(Method method, bool cold) {
+  if (cold)
+    evictFromCache();
+  else
+    scan(method);
+
+  TimeTicks start = TimeTicks::Now();
+  uint64_t sum = scan(method);
+  double total_time_milliseconds = (TimeTicks::Now() - start).InMillisecondsF();
+
+  // Keeps the compiler from dropping the scan.
+  EXPECT_NE(0u, sum);
+
+  perf_test::PrintResult(
+      "file_scan", cold ? "_cold" : "_warm", getMethodName(method),
+      static_cast<double>(FileSize) / 1024 / total_time_milliseconds,
+      "KiB/ms", true);
+}
+
+} // namespace
+
+TEST_F(MappedStreamPerfTest, Scan) {
+  const Method Methods[] = {
+    Method::FileStreamRead,
+    Method::MappedRead,
+    Method::MappedReadSpan,
+    Method::MappedReadSpanSequential,
+    Method::MappedReadSpanPopulate,
+  };
+  for (Method method : Methods) {
+    runScan(method, true);
+    runScan(method, false);
+  }
+}
+
+} // namespace stp
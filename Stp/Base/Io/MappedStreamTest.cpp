@@ -0,0 +1,145 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Io/MappedStream.h"
+
+#include "Base/FileSystem/TemporaryDirectory.h"
+#include "Base/Io/IoException.h"
+#include "Base/Io/MemoryStream.h"
+#include "Base/Test/GTest.h"
+
+namespace stp {
+
+namespace {
+
+const int WindowSize = 64 << 10;
+// Spans several windows and ends in the middle of one.
+const int DataSize = WindowSize * 3 + 1234;
+
+class MappedStreamTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    temp_dir_.create();
+    path_ = combineFilePaths(temp_dir_.path(), FilePath::fromString("mapped_file"));
+
+    byte_t* data = data_.appendUninitialized(DataSize);
+    for (int i = 0; i < DataSize; ++i)
+      data[i] = static_cast<byte_t>(i * 7 + i / WindowSize);
+
+    FileStream file;
+    file.create(path_);
+    file.write(BufferSpan(data_.data(), data_.size()));
+    file.close();
+  }
+
+  void openStream(MappedStream& stream, const MemoryMappedFile::Options& options = MemoryMappedFile::Options()) {
+    stream.setWindowSize(WindowSize);
+    stream.open(path_, options);
+  }
+
+  BufferSpan getData(int offset, int size) const {
+    return BufferSpan(data_.data() + offset, size);
+  }
+
+  TemporaryDirectory temp_dir_;
+  FilePath path_;
+  List<byte_t> data_;
+};
+
+} // namespace
+
+TEST_F(MappedStreamTest, ReadAcrossWindows) {
+  MappedStream stream;
+  openStream(stream);
+  EXPECT_FALSE(stream.canWrite());
+  EXPECT_EQ(DataSize, stream.getLength());
+
+  // Odd chunk size, so reads cross window boundaries.
+  const int ChunkSize = 10000;
+  List<byte_t> output;
+  byte_t chunk[ChunkSize];
+  while (true) {
+    int rv = stream.readAtMost(MutableBufferSpan(chunk, ChunkSize));
+    if (rv == 0)
+      break;
+    output.append(makeSpan(chunk, rv));
+  }
+  EXPECT_EQ(DataSize, stream.getPosition());
+  EXPECT_EQ(getData(0, DataSize), BufferSpan(output.data(), output.size()));
+  EXPECT_EQ(-1, stream.tryReadByte());
+}
+
+TEST_F(MappedStreamTest, SeekAndPositionalRead) {
+  MemoryMappedFile::Options options;
+  options.pattern = MemoryMappedFile::AccessPattern::Random;
+  MappedStream stream;
+  openStream(stream, options);
+
+  byte_t output[100];
+  stream.positionalRead(WindowSize * 2 - 50, MutableBufferSpan(output, 100));
+  EXPECT_EQ(getData(WindowSize * 2 - 50, 100), BufferSpan(output, 100));
+  // Positional read leaves current position intact.
+  EXPECT_EQ(0, stream.getPosition());
+  EXPECT_EQ(data_[0], stream.readByte());
+
+  EXPECT_EQ(DataSize - 10, stream.seek(-10, SeekOrigin::End));
+  EXPECT_EQ(10, stream.readAtMost(MutableBufferSpan(output, 100)));
+  EXPECT_EQ(getData(DataSize - 10, 10), BufferSpan(output, 10));
+
+  stream.setPosition(WindowSize + 1);
+  EXPECT_EQ(data_[WindowSize + 1], stream.readByte());
+  EXPECT_EQ(WindowSize - 8, stream.seek(-10, SeekOrigin::Current));
+  EXPECT_EQ(data_[WindowSize - 8], stream.readByte());
+
+  EXPECT_THROW(stream.positionalRead(DataSize - 10, MutableBufferSpan(output, 100)), EndOfStreamException);
+}
+
+TEST_F(MappedStreamTest, ReadSpan) {
+  MemoryMappedFile::Options options;
+  options.pattern = MemoryMappedFile::AccessPattern::Sequential;
+  options.will_need = true;
+  MappedStream stream;
+  openStream(stream, options);
+
+  BufferSpan span = stream.readSpan(100);
+  EXPECT_EQ(getData(0, 100), span);
+
+  // Stops at the end of window.
+  stream.setPosition(WindowSize - 30);
+  span = stream.readSpan(100);
+  EXPECT_EQ(getData(WindowSize - 30, 30), span);
+  span = stream.readSpan(100);
+  EXPECT_EQ(getData(WindowSize, 100), span);
+
+  stream.setPosition(DataSize);
+  EXPECT_TRUE(stream.readSpan(100).isEmpty());
+}
+
+TEST_F(MappedStreamTest, TransferTo) {
+  MappedStream stream;
+  openStream(stream);
+  stream.setPosition(5);
+
+  MemoryStream memory;
+  memory.openNewBytes();
+  EXPECT_EQ(DataSize - 5, stream.transferTo(memory));
+
+  List<byte_t> output;
+  memory.positionalRead(0, MutableBufferSpan(output.appendUninitialized(DataSize - 5), DataSize - 5));
+  EXPECT_EQ(getData(5, DataSize - 5), BufferSpan(output.data(), output.size()));
+}
+
+TEST_F(MappedStreamTest, EmptyFile) {
+  FileStream file;
+  file.create(path_);
+  file.close();
+
+  MappedStream stream;
+  openStream(stream);
+  EXPECT_EQ(0, stream.getLength());
+  EXPECT_EQ(-1, stream.tryReadByte());
+  byte_t output[10];
+  EXPECT_EQ(0, stream.readAtMost(MutableBufferSpan(output, 10)));
+}
+
+} // namespace stp
@@ -4,6 +4,7 @@
 #include "Base/Io/Stream.h"
 
 #include "Base/Containers/ArrayOps.h"
+#include "Base/Containers/List.h"
 #include "Base/Debug/Assert.h"
 #include "Base/Io/IoException.h"
 
@@ -38,6 +39,56 @@ void Stream::positionalWrite(int64_t offset, BufferSpan input) {
   write(input);
 }
 
+int Stream::readV(Span<MutableBufferSpan> outputs) {
+  int bytes_read = 0;
+  for (MutableBufferSpan output : outputs) {
+    int rv = readAtMost(output);
+    bytes_read += rv;
+    if (rv != output.size())
+      break;
+  }
+  return bytes_read;
+}
+
+void Stream::writeV(Span<BufferSpan> inputs) {
+  for (BufferSpan input : inputs)
+    write(input);
+}
+
+void Stream::positionalReadV(int64_t offset, Span<MutableBufferSpan> outputs) {
+  for (MutableBufferSpan output : outputs) {
+    positionalRead(offset, output);
+    offset += output.size();
+  }
+}
+
+void Stream::positionalWriteV(int64_t offset, Span<BufferSpan> inputs) {
+  for (BufferSpan input : inputs) {
+    positionalWrite(offset, input);
+    offset += input.size();
+  }
+}
+
+int64_t Stream::transferTo(Stream& target, int64_t max_count) {
+  ASSERT(max_count >= 0);
+  const int64_t TransferBufferSize = 64 << 10;
+
+  List<byte_t> buffer;
+  int buffer_size = static_cast<int>(min(max_count, TransferBufferSize));
+  byte_t* buffer_data = buffer.appendUninitialized(buffer_size);
+
+  int64_t transferred = 0;
+  while (transferred < max_count) {
+    int count = static_cast<int>(min(max_count - transferred, static_cast<int64_t>(buffer_size)));
+    int rv = readAtMost(MutableBufferSpan(buffer_data, count));
+    if (rv == 0)
+      break;
+    target.write(BufferSpan(buffer_data, rv));
+    transferred += rv;
+  }
+  return transferred;
+}
+
 void Stream::read(MutableBufferSpan buffer) {
   int rv = readAtMost(buffer);
   if (rv != buffer.size())
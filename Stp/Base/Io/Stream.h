@@ -5,6 +5,8 @@
 #define STP_BASE_IO_STREAM_H_
 
 #include "Base/Containers/BufferSpan.h"
+#include "Base/Containers/Span.h"
+#include "Base/Type/Limits.h"
 
 namespace stp {
 
@@ -35,6 +37,24 @@ class BASE_EXPORT Stream {
   virtual void positionalRead(int64_t offset, MutableBufferSpan output);
   virtual void positionalWrite(int64_t offset, BufferSpan input);
 
+  // Vectored (scatter/gather) variants of above.
+  // Buffers are filled/consumed in order, as if they were concatenated.
+  // Default implementations issue one call per buffer, streams backed by
+  // system handles override them with single system call.
+  virtual int readV(Span<MutableBufferSpan> outputs);
+  virtual void writeV(Span<BufferSpan> inputs);
+  virtual void positionalReadV(int64_t offset, Span<MutableBufferSpan> outputs);
+  virtual void positionalWriteV(int64_t offset, Span<BufferSpan> inputs);
+
+  // Copies data from current position to the end of this stream into
+  // |target|, but no more than |max_count| bytes.
+  // Returns number of bytes copied.
+  // The default implementation copies through intermediate buffer.
+  // FileStream avoids copying through user space when possible.
+  virtual int64_t transferTo(Stream& target, int64_t max_count = Limits<int64_t>::Max);
+
+  virtual bool isFileStream() const { return false; }
+
   virtual void writeByte(byte_t byte);
   virtual int tryReadByte();
   byte_t readByte();
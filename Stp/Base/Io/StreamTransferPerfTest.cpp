@@ -0,0 +1,145 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Io/FileStream.h"
+
+#include "Base/FileSystem/TemporaryDirectory.h"
+#include "Base/Io/BufferedStream.h"
+#include "Base/Test/GTest.h"
+#include "Base/Test/PerfTest.h"
+#include "Base/Text/StringFormatMany.h"
+#include "Base/Time/TimeTicks.h"
+
+namespace stp {
+
+static const int ChunkSize = 1 << 20;
+static const int LoopBufferSize = 64 << 10;
+
+namespace {
+
+class StreamTransferPerfTest : public testing::Test {
+ protected:
+  enum class Method {
+    // Copy loop as written before transferTo() was introduced.
+    ReadWriteLoop,
+    BufferedStream,
+    TransferTo,
+  };
+
+  static const char* getMethodName(Method method) {
+    switch (method) {
+      case Method::ReadWriteLoop: return "read_write_loop";
+      case Method::BufferedStream: return "buffered_stream";
+      case Method::TransferTo: return "transfer_to";
+    }
+    return nullptr;
+  }
+
+  void SetUp() override {
+    temp_dir_.create();
+    source_path_ = combineFilePaths(temp_dir_.path(), FilePath::fromString("source"));
+    target_path_ = combineFilePaths(temp_dir_.path(), FilePath::fromString("target"));
+  }
+
+  void createSource(int64_t size) {
+    List<byte_t> chunk;
+    byte_t* chunk_data = chunk.appendUninitialized(ChunkSize);
+    FileStream source;
+    source.create(source_path_, FileMode::Create, FileAccess::WriteOnly);
+    for (int64_t written = 0; written < size; written += ChunkSize) {
+      // Vary the content so no layer can deduplicate it.
+      for (int i = 0; i < ChunkSize; i += 8)
+        *reinterpret_cast<int64_t*>(chunk_data + i) = written + i;
+      source.write(BufferSpan(chunk_data, ChunkSize));
+    }
+    source.close();
+  }
+
+  void runCopy(Method method, int64_t size_in_mib);
+  void runAllMethods(int64_t size_in_mib);
+
+  TemporaryDirectory temp_dir_;
+  FilePath source_path_;
+  FilePath target_path_;
+};
+
+void StreamTransferPerfTest::runCopy(Method method, int64_t size_in_mib) {
+  FileStream source;
+  source.open(source_path_, FileMode::OpenExisting, FileAccess::ReadOnly);
+  FileStream target;
+  target.create(target_path_, FileMode::Create, FileAccess::WriteOnly);
+
+  TimeTicks start = TimeTicks::Now();
+  switch (method) {
+    case Method::ReadWriteLoop: {
+      List<byte_t> buffer;
+      byte_t* buffer_data = buffer.appendUninitialized(LoopBufferSize);
+      while (true) {
+        int rv = source.readAtMost(MutableBufferSpan(buffer_data, LoopBufferSize));
+        if (rv == 0)
+          break;
+        target.write(BufferSpan(buffer_data, rv));
+      }
+      break;
+    }
+    case Method::BufferedStream: {
+      BufferedStream input;
+      input.open(&source);
+      BufferedStream output;
+      output.open(&target);
+      byte_t chunk[512];
+      while (true) {
+        int rv = input.readAtMost(MutableBufferSpan(chunk, isizeof(chunk)));
+        if (rv == 0)
+          break;
+        output.write(BufferSpan(chunk, rv));
+      }
+      output.flush();
+      break;
+    }
+    case Method::TransferTo:
+      source.transferTo(target);
+      break;
+  }
+  double total_time_milliseconds = (TimeTicks::Now() - start).InMillisecondsF();
+
+  ASSERT_EQ(source.getLength(), target.getLength());
+
+  perf_test::PrintResult(
+      "file_copy", stringFormatMany("_{}mib", size_in_mib), getMethodName(method),
+      static_cast<double>(size_in_mib << 10) / total_time_milliseconds,
+      "KiB/ms", true);
+}
+
+void StreamTransferPerfTest::runAllMethods(int64_t size_in_mib) {
+  const Method Methods[] = {
+    Method::ReadWriteLoop,
+    Method::BufferedStream,
+    Method::TransferTo,
+  };
+  createSource(size_in_mib << 20);
+  for (Method method : Methods)
+    runCopy(method, size_in_mib);
+}
+
+} // namespace
+
+TEST_F(StreamTransferPerfTest, FileCopy256M) {
+  runAllMethods(256);
+}
+
+// Following need twice the file size of free space in temporary directory,
+// run explicitly.
+TEST_F(StreamTransferPerfTest, DISABLED_FileCopy1G) {
+  runAllMethods(1024);
+}
+
+TEST_F(StreamTransferPerfTest, DISABLED_FileCopy4G) {
+  runAllMethods(4 * 1024);
+}
+
+TEST_F(StreamTransferPerfTest, DISABLED_FileCopy10G) {
+  runAllMethods(10 * 1024);
+}
+
+} // namespace stp
@@ -0,0 +1,129 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Io/FileStream.h"
+
+#include "Base/FileSystem/TemporaryDirectory.h"
+#include "Base/Io/BufferedStream.h"
+#include "Base/Io/MemoryStream.h"
+#include "Base/Test/GTest.h"
+
+#if OS(POSIX)
+#include <unistd.h>
+#endif
+
+namespace stp {
+
+namespace {
+
+// Not a multiple of page size nor of any buffer size.
+const int DataSize = (1 << 20) + 123;
+
+class StreamTransferTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    temp_dir_.create();
+
+    byte_t* data = data_.appendUninitialized(DataSize);
+    for (int i = 0; i < DataSize; ++i)
+      data[i] = static_cast<byte_t>(i * 31 + i / 4096);
+
+    source_.create(makePath("source"));
+    source_.write(BufferSpan(data_.data(), data_.size()));
+    source_.setPosition(0);
+
+    target_.create(makePath("target"));
+  }
+
+  FilePath makePath(StringSpan name) {
+    return combineFilePaths(temp_dir_.path(), FilePath::fromString(name));
+  }
+
+  void expectTargetEquals(int offset, int size) {
+    ASSERT_EQ(size, target_.getLength());
+    List<byte_t> output;
+    target_.positionalRead(0, MutableBufferSpan(output.appendUninitialized(size), size));
+    EXPECT_EQ(BufferSpan(data_.data() + offset, size), BufferSpan(output.data(), size));
+  }
+
+  TemporaryDirectory temp_dir_;
+  List<byte_t> data_;
+  FileStream source_;
+  FileStream target_;
+};
+
+} // namespace
+
+TEST_F(StreamTransferTest, FileToFile) {
+  EXPECT_EQ(DataSize, source_.transferTo(target_));
+  EXPECT_EQ(DataSize, source_.getPosition());
+  EXPECT_EQ(DataSize, target_.getPosition());
+  expectTargetEquals(0, DataSize);
+
+  // At end of file.
+  EXPECT_EQ(0, source_.transferTo(target_));
+}
+
+TEST_F(StreamTransferTest, MaxCount) {
+  source_.setPosition(1000);
+  EXPECT_EQ(5000, source_.transferTo(target_, 5000));
+  EXPECT_EQ(6000, source_.getPosition());
+  expectTargetEquals(1000, 5000);
+}
+
+TEST_F(StreamTransferTest, FromBufferedStream) {
+  BufferedStream buffered;
+  buffered.open(&source_);
+
+  byte_t first[10];
+  buffered.read(MutableBufferSpan(first, 10));
+  target_.write(BufferSpan(first, 10));
+
+  // Rest of the buffer is written first.
+  EXPECT_EQ(DataSize - 10, buffered.transferTo(target_));
+  expectTargetEquals(0, DataSize);
+}
+
+TEST_F(StreamTransferTest, FromMemoryStream) {
+  MemoryStream memory;
+  memory.open(BufferSpan(data_.data(), data_.size()));
+  EXPECT_EQ(DataSize, memory.transferTo(target_));
+  expectTargetEquals(0, DataSize);
+}
+
+#if OS(POSIX)
+TEST_F(StreamTransferTest, FileToPipe) {
+  int fds[2];
+  ASSERT_EQ(0, ::pipe(fds));
+
+  FileStream pipe_input;
+  pipe_input.openNative(fds[0], FileAccess::ReadOnly);
+  FileStream pipe_output;
+  pipe_output.openNative(fds[1], FileAccess::WriteOnly);
+
+  // Stay within pipe capacity so nothing blocks.
+  const int Count = 8192;
+  source_.setPosition(100);
+  EXPECT_EQ(Count, source_.transferTo(pipe_output, Count));
+  pipe_output.close();
+
+  byte_t output[Count];
+  pipe_input.read(MutableBufferSpan(output, Count));
+  EXPECT_EQ(BufferSpan(data_.data() + 100, Count), BufferSpan(output, Count));
+  EXPECT_EQ(-1, pipe_input.tryReadByte());
+}
+#endif // OS(POSIX)
+
+#if OS(LINUX)
+TEST_F(StreamTransferTest, FromProcFile) {
+  // Reports zero size, but is not empty.
+  FileStream proc_file;
+  proc_file.open(FilePath::fromString("/proc/self/maps"), FileMode::OpenExisting, FileAccess::ReadOnly);
+
+  int64_t count = proc_file.transferTo(target_);
+  EXPECT_LT(0, count);
+  EXPECT_EQ(count, target_.getLength());
+}
+#endif // OS(LINUX)
+
+} // namespace stp
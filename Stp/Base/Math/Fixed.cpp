@@ -5,6 +5,7 @@
 
 #include "Base/Error/BasicExceptions.h"
 #include "Base/Math/Bits.h"
+#include "Base/Simd/Vnx.h"
 #include "Base/Text/AsciiChar.h"
 #include "Base/Text/FormatMany.h"
 
@@ -111,6 +112,35 @@ int32_t fixedRsqrt16(int32_t xs) {
   return static_cast<int32_t>(r);
 }
 
+void fixedMulEach(const int32_t* lhs, const int32_t* rhs, int32_t* out, int count, int point) {
+  ASSERT(count >= 0 && 0 < point && point < 31);
+
+  // Low 32 bits of 64-bit product shifted right by |point| are composed
+  // from both halves of the product.
+  Vec4i low_mask(static_cast<int32_t>((1u << (32 - point)) - 1));
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    Vec4i l = Vec4i::load(lhs + i);
+    Vec4i r = Vec4i::load(rhs + i);
+    Vec4i lo = ((l * r) >> point) & low_mask;
+    Vec4i hi = Vec4i::mulHi(l, r) << (32 - point);
+    (lo | hi).store(out + i);
+  }
+  for (; i < count; ++i)
+    out[i] = static_cast<int32_t>((static_cast<int64_t>(lhs[i]) * rhs[i]) >> point);
+}
+
+void fixedDivEach(const int32_t* lhs, const int32_t* rhs, int32_t* out, int count, int point) {
+  ASSERT(count >= 0 && 0 < point && point < 31);
+
+  // Neither SSE nor NEON has integer division, and 64-bit dividend does not
+  // fit into double exactly - do it one by one.
+  for (int i = 0; i < count; ++i) {
+    ASSERT(rhs[i] != 0);
+    out[i] = static_cast<int32_t>((static_cast<int64_t>(lhs[i]) << point) / rhs[i]);
+  }
+}
+
 
 void fixedFormat(TextWriter& out, int32_t value, int point) {
   out << (static_cast<double>(value) / (1 << point));
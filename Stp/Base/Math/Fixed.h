@@ -4,6 +4,7 @@
 #ifndef STP_BASE_MATH_FIXED_H_
 #define STP_BASE_MATH_FIXED_H_
 
+#include "Base/Containers/Span.h"
 #include "Base/Math/Safe.h"
 
 namespace stp {
@@ -15,6 +16,9 @@ BASE_EXPORT int64_t longFixedSqrt(int64_t value, int count);
 
 BASE_EXPORT int32_t fixedRsqrt16(int32_t x);
 
+BASE_EXPORT void fixedMulEach(const int32_t* lhs, const int32_t* rhs, int32_t* out, int count, int point);
+BASE_EXPORT void fixedDivEach(const int32_t* lhs, const int32_t* rhs, int32_t* out, int count, int point);
+
 BASE_EXPORT void fixedFormat(TextWriter& writer, int32_t value, int point);
 BASE_EXPORT void fixedFormat(TextWriter& writer, const StringSpan& opts, int32_t value, int point);
 
@@ -118,6 +122,11 @@ class Fixed {
   template<typename T, TEnableIf<TIsArithmetic<T>>* = nullptr>
   friend constexpr Fixed operator/(T lhs, Fixed rhs) { return Fixed(lhs) / rhs; }
 
+  // Multiplies/divides |lhs| by |rhs| for each item and stores results in |out|.
+  // Results match scalar operators, but overflow is not checked.
+  static void mulEach(Span<Fixed> lhs, Span<Fixed> rhs, MutableSpan<Fixed> out);
+  static void divEach(Span<Fixed> lhs, Span<Fixed> rhs, MutableSpan<Fixed> out);
+
   friend constexpr bool operator==(Fixed l, Fixed r) { return l.bits_ == r.bits_; }
   friend constexpr bool operator!=(Fixed l, Fixed r) { return l.bits_ != r.bits_; }
   friend constexpr bool operator<=(Fixed l, Fixed r) { return l.bits_ <= r.bits_; }
@@ -204,6 +213,26 @@ class Fixed {
   BitsType bits_;
 };
 
+template<int P>
+inline void Fixed<P>::mulEach(Span<Fixed> lhs, Span<Fixed> rhs, MutableSpan<Fixed> out) {
+  static_assert(sizeof(Fixed) == sizeof(BitsType), "!");
+  ASSERT(lhs.size() == rhs.size() && lhs.size() == out.size());
+  detail::fixedMulEach(
+      reinterpret_cast<const BitsType*>(lhs.data()),
+      reinterpret_cast<const BitsType*>(rhs.data()),
+      reinterpret_cast<BitsType*>(out.data()), out.size(), P);
+}
+
+template<int P>
+inline void Fixed<P>::divEach(Span<Fixed> lhs, Span<Fixed> rhs, MutableSpan<Fixed> out) {
+  static_assert(sizeof(Fixed) == sizeof(BitsType), "!");
+  ASSERT(lhs.size() == rhs.size() && lhs.size() == out.size());
+  detail::fixedDivEach(
+      reinterpret_cast<const BitsType*>(lhs.data()),
+      reinterpret_cast<const BitsType*>(rhs.data()),
+      reinterpret_cast<BitsType*>(out.data()), out.size(), P);
+}
+
 template<int N>
 struct Limits<Fixed<N>> {
   static constexpr Fixed<N> Epsilon = Fixed<N>::fromBits(1);
@@ -0,0 +1,79 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Math/Fixed.h"
+
+#include "Base/Containers/List.h"
+#include "Base/Test/GTest.h"
+#include "Base/Test/PerfTest.h"
+#include "Base/Text/FormatMany.h"
+#include "Base/Time/TimeTicks.h"
+#include "Base/Util/Random.h"
+
+namespace stp {
+
+namespace {
+
+// Each measurement processes this many values in total, regardless of span size.
+constexpr int TotalCount = 16 * 1024 * 1024;
+
+class FixedPerfTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    // Operands are chosen to never overflow, divisors are at least 1/16 in magnitude.
+    for (int i = 0; i < 1024 * 1024; ++i) {
+      lhs_.add(Fixed16::fromBits(nextBits() >> 8));
+      int32_t rhs = nextBits() >> 14;
+      rhs_.add(Fixed16::fromBits(rhs >= 0 ? rhs + 0x1000 : rhs - 0x1000));
+    }
+    out_.appendUninitialized(lhs_.size());
+  }
+
+  int32_t nextBits() { return static_cast<int32_t>(random_.NextUInt32()); }
+
+  template<typename TBody>
+  void run(const char* operation, const char* trace, TBody body) {
+    for (int size = 64; size <= lhs_.size(); size *= 4) {
+      int iterations = TotalCount / size;
+      Span<Fixed16> lhs = lhs_.slice(0, size);
+      Span<Fixed16> rhs = rhs_.slice(0, size);
+      MutableSpan<Fixed16> out = out_.slice(0, size);
+
+      TimeTicks start = TimeTicks::Now();
+      for (int n = 0; n < iterations; ++n)
+        body(lhs, rhs, out);
+      perf_test::PrintThroughput(
+          operation, stringFormatMany("_{}", size), trace,
+          TotalCount, TimeTicks::Now() - start, "Mvalues/s", true);
+    }
+  }
+
+  List<Fixed16> lhs_;
+  List<Fixed16> rhs_;
+  List<Fixed16> out_;
+  Random random_;
+};
+
+} // namespace
+
+TEST_F(FixedPerfTest, Mul) {
+  run("mul", "scalar", [](Span<Fixed16> lhs, Span<Fixed16> rhs, MutableSpan<Fixed16> out) {
+    for (int i = 0; i < out.size(); ++i)
+      out[i] = lhs[i] * rhs[i];
+  });
+  run("mul", "each", [](Span<Fixed16> lhs, Span<Fixed16> rhs, MutableSpan<Fixed16> out) {
+    Fixed16::mulEach(lhs, rhs, out);
+  });
+}
+
+TEST_F(FixedPerfTest, Div) {
+  run("div", "scalar", [](Span<Fixed16> lhs, Span<Fixed16> rhs, MutableSpan<Fixed16> out) {
+    for (int i = 0; i < out.size(); ++i)
+      out[i] = lhs[i] / rhs[i];
+  });
+  run("div", "each", [](Span<Fixed16> lhs, Span<Fixed16> rhs, MutableSpan<Fixed16> out) {
+    Fixed16::divEach(lhs, rhs, out);
+  });
+}
+
+} // namespace stp
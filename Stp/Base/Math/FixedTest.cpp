@@ -5,6 +5,7 @@
 
 #include "Base/Math/Math.h"
 #include "Base/Test/GTest.h"
+#include "Base/Util/Random.h"
 
 namespace stp {
 
@@ -151,4 +152,39 @@ TEST(FixedTest, Conversion) {
   EXPECT_EQ(Fixed26_6(5.25f), f6);
 }
 
+TEST(FixedTest, MulEach) {
+  // Odd count to exercise the tail.
+  constexpr int Count = 103;
+  Fixed16 lhs[Count], rhs[Count], out[Count];
+  Random random;
+  for (int i = 0; i < Count; ++i) {
+    lhs[i] = Fixed16::fromBits(static_cast<int32_t>(random.NextUInt32()) >> 8);
+    rhs[i] = Fixed16::fromBits(static_cast<int32_t>(random.NextUInt32()) >> 12);
+  }
+  lhs[0] = Fixed16(-3);
+  rhs[0] = Fixed16(0.5f);
+
+  Fixed16::mulEach(lhs, rhs, out);
+  EXPECT_EQ(Fixed16(-1.5f), out[0]);
+  for (int i = 0; i < Count; ++i)
+    EXPECT_EQ(lhs[i] * rhs[i], out[i]);
+
+  Fixed26_6 a[] = { Fixed26_6(2), Fixed26_6(-1.5f), Fixed26_6(1000), Fixed26_6(0.25f), Fixed26_6(-7) };
+  Fixed26_6 b[] = { Fixed26_6(3), Fixed26_6(2), Fixed26_6(-0.5f), Fixed26_6(0.25f), Fixed26_6(-7) };
+  Fixed26_6 c[5];
+  Fixed26_6::mulEach(a, b, c);
+  for (int i = 0; i < 5; ++i)
+    EXPECT_EQ(a[i] * b[i], c[i]);
+}
+
+TEST(FixedTest, DivEach) {
+  Fixed16 lhs[] = { Fixed16(3), Fixed16(-1), Fixed16(100), Fixed16(0.5f), Fixed16(-7) };
+  Fixed16 rhs[] = { Fixed16(2), Fixed16(3), Fixed16(-0.25f), Fixed16(8), Fixed16(-7) };
+  Fixed16 out[5];
+  Fixed16::divEach(lhs, rhs, out);
+  for (int i = 0; i < 5; ++i)
+    EXPECT_EQ(lhs[i] / rhs[i], out[i]);
+  EXPECT_EQ(Fixed16(1.5f), out[0]);
+}
+
 } // namespace stp
@@ -3,13 +3,20 @@
 
 #include "Base/Math/Half.h"
 
+#include "Base/Math/HalfImpl.h"
 #include "Base/Math/RawFloat.h"
+#include "Base/System/CpuInfo.h"
 #include "Base/Type/Formattable.h"
 
+#if CPU(ARM64)
+#include <arm_neon.h>
+#endif
+
 namespace stp {
 
-// based on Fabien Giesen's float_to_half_fast3()
+// based on Fabien Giesen's float_to_half_fast3_rtne()
 // see https://gist.github.com/rygorous/2156668
+// Rounds to nearest with ties to even, like F16C and NEON conversions do.
 Half::Half(float x) {
   RawFloat f(x);
   uint32_t fbits = f.toBits();
@@ -21,28 +28,27 @@ Half::Half(float x) {
   // 0x80000000. Important if you want fast straight SSE2 code
   // (since there's no unsigned PCMPGTD).
 
+  constexpr RawFloat Max16 = RawFloat::fromBits((127u + 16) << 23);
+
   uint16_t result;
-  // Inf or NaN (all exponent bits set)
-  if (fbits >= RawFloat::ExponentBitMask) {
+  // Result is Inf or NaN (all exponent bits set)
+  if (fbits >= Max16.toBits()) {
     // NaN->qNaN and Inf->Inf
     result = (fbits > RawFloat::ExponentBitMask) ? 0x7E00u : 0x7C00;
-    // (De)normalized number or zero
-  } else {
-    constexpr uint32_t RoundMask = ~0xFFFu;
-    constexpr RawFloat Magic = RawFloat::fromBits(15u << 23);
-
-    fbits &= RoundMask;
-
+  } else if (fbits < (113u << 23)) {
+    // Resulting half is subnormal or zero.
+    // Use a magic value to align 10 mantissa bits at the bottom of the float.
+    // As long as float addition rounds to nearest even this just works.
+    constexpr RawFloat DenormMagic = RawFloat::fromBits(((127u - 15) + (23 - 10) + 1) << 23);
     auto tmp = RawFloat::fromBits(fbits);
-    fbits = RawFloat(static_cast<float>(tmp) * static_cast<float>(Magic)).toBits();
-    fbits -= RoundMask;
-
-    constexpr RawFloat Infinity16 = RawFloat::fromBits(31u << 23);
-    // Clamp to signed infinity if overflowed
-    if (fbits > Infinity16.toBits())
-      fbits = Infinity16.toBits();
-
-    result = fbits >> 13; // Take the bits!
+    fbits = RawFloat(static_cast<float>(tmp) + static_cast<float>(DenormMagic)).toBits();
+    result = static_cast<uint16_t>(fbits - DenormMagic.toBits());
+  } else {
+    uint32_t mantissa_odd = (fbits >> 13) & 1;
+    // Update exponent and add rounding bias. Overflow ends up as Inf.
+    fbits += ((15u - 127) << 23) + 0xFFF;
+    fbits += mantissa_odd;
+    result = static_cast<uint16_t>(fbits >> 13); // Take the bits!
   }
 
   result |= sign >> 16;
@@ -64,11 +70,12 @@ Half::operator float() const {
     // Set mantissa
     obits = getMantissaBits() << 13;
     // Set exponent
-    if (getExponentBits() == 0x1F) {
+    uint32_t exponent = getExponentBits() >> MantissaBitCount;
+    if (exponent == 0x1F) {
       // Inf/NaN
       obits |= RawFloat::ExponentBitMask;
     } else {
-      obits |= (127 - 15 + getExponentBits()) << 23;
+      obits |= (127 - 15 + exponent) << 23;
     }
   }
 
@@ -77,6 +84,85 @@ Half::operator float() const {
   return static_cast<float>(RawFloat::fromBits(obits));
 }
 
+static_assert(sizeof(Half) == sizeof(uint16_t), "!");
+
+#if CPU(ARM64)
+static void convertFloatToHalfNeon(const float* src, uint16_t* dst, int count) {
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    float32x4_t f = vld1q_f32(src + i);
+    uint16x4_t h = vreinterpret_u16_f16(vcvt_f16_f32(f));
+    // Hardware keeps upper bits of NaN payload, scalar conversion produces
+    // quiet NaN with no payload.
+    uint16x4_t nan = vmovn_u32(vmvnq_u32(vceqq_f32(f, f)));
+    uint16x4_t quiet = vorr_u16(vand_u16(h, vdup_n_u16(0x8000)), vdup_n_u16(0x7E00));
+    vst1_u16(dst + i, vbsl_u16(nan, quiet, h));
+  }
+  for (; i < count; ++i)
+    dst[i] = Half(src[i]).toBits();
+}
+
+static void convertHalfToFloatNeon(const uint16_t* src, float* dst, int count) {
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    uint16x4_t h = vld1_u16(src + i);
+    uint32x4_t f = vreinterpretq_u32_f32(vcvt_f32_f16(vreinterpret_f16_u16(h)));
+    // Hardware quiets signaling NaNs, scalar conversion keeps them as is.
+    uint16x4_t nan = vcgt_u16(vand_u16(h, vdup_n_u16(0x7FFF)), vdup_n_u16(0x7C00));
+    uint32x4_t h32 = vmovl_u16(h);
+    uint32x4_t expected = vorrq_u32(
+        vorrq_u32(vshlq_n_u32(vandq_u32(h32, vdupq_n_u32(0x8000)), 16),
+                  vshlq_n_u32(vandq_u32(h32, vdupq_n_u32(0x3FF)), 13)),
+        vdupq_n_u32(0x7F800000));
+    uint32x4_t nan32 = vreinterpretq_u32_s32(vmovl_s16(vreinterpret_s16_u16(nan)));
+    f = vbslq_u32(nan32, expected, f);
+    vst1q_f32(dst + i, vreinterpretq_f32_u32(f));
+  }
+  for (; i < count; ++i)
+    dst[i] = static_cast<float>(Half::fromBits(src[i]));
+}
+#endif // CPU(ARM64)
+
+void convertFloatToHalf(Span<float> src, MutableSpan<Half> dst) {
+  ASSERT(src.size() == dst.size());
+  auto* dst_bits = reinterpret_cast<uint16_t*>(dst.data());
+
+  #if CPU(X86_FAMILY)
+  if (CpuInfo::Supports(CpuFeature::Cvt16)) {
+    detail::convertFloatToHalfF16c(src.data(), dst_bits, src.size());
+    return;
+  }
+  #elif CPU(ARM64)
+  if (CpuInfo::Supports(CpuFeature::Fp16)) {
+    convertFloatToHalfNeon(src.data(), dst_bits, src.size());
+    return;
+  }
+  #endif
+
+  for (int i = 0; i < src.size(); ++i)
+    dst[i] = Half(src[i]);
+}
+
+void convertHalfToFloat(Span<Half> src, MutableSpan<float> dst) {
+  ASSERT(src.size() == dst.size());
+  auto* src_bits = reinterpret_cast<const uint16_t*>(src.data());
+
+  #if CPU(X86_FAMILY)
+  if (CpuInfo::Supports(CpuFeature::Cvt16)) {
+    detail::convertHalfToFloatF16c(src_bits, dst.data(), src.size());
+    return;
+  }
+  #elif CPU(ARM64)
+  if (CpuInfo::Supports(CpuFeature::Fp16)) {
+    convertHalfToFloatNeon(src_bits, dst.data(), src.size());
+    return;
+  }
+  #endif
+
+  for (int i = 0; i < src.size(); ++i)
+    dst[i] = static_cast<float>(src[i]);
+}
+
 void Half::formatImpl(TextWriter& out, float x, const StringSpan& opts) {
   format(out, x, opts);
 }
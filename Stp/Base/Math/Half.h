@@ -4,6 +4,7 @@
 #ifndef STP_BASE_MATH_HALF_H_
 #define STP_BASE_MATH_HALF_H_
 
+#include "Base/Containers/Span.h"
 #include "Base/Debug/Assert.h"
 #include "Base/Type/Limits.h"
 
@@ -140,6 +141,13 @@ HALF_COMPARISON(>=)
 
 #undef HALF_COMPARISON
 
+// Converts all values of |src| into |dst| of the same size.
+// Uses F16C on x86 and NEON on ARM64 when running CPU supports them.
+// Results are bit-exact with conversions of single values, including
+// rounding (to nearest even) and NaN handling.
+BASE_EXPORT void convertFloatToHalf(Span<float> src, MutableSpan<Half> dst);
+BASE_EXPORT void convertHalfToFloat(Span<Half> src, MutableSpan<float> dst);
+
 namespace detail {
 
 template<typename T>
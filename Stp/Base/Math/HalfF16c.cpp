@@ -0,0 +1,102 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+// This file is compiled with F16C enabled. Only reached after CpuInfo
+// reported F16C support, so nothing here may be called from elsewhere.
+// Do not use inline functions from headers here: the linker might pick
+// their F16C instances for use in the rest of program.
+
+#include "Base/Math/HalfImpl.h"
+
+#include <immintrin.h>
+#include <string.h>
+
+namespace stp {
+namespace detail {
+
+namespace {
+
+constexpr int BatchSize = 8;
+
+void convertFloatToHalfBatch(const float* src, uint16_t* dst) {
+  __m256 f = _mm256_loadu_ps(src);
+  __m128i h = _mm256_cvtps_ph(f, _MM_FROUND_TO_NEAREST_INT);
+
+  __m256 nan = _mm256_cmp_ps(f, f, _CMP_UNORD_Q);
+  if (_mm256_movemask_ps(nan)) {
+    // Hardware keeps upper bits of NaN payload, scalar conversion produces
+    // quiet NaN with no payload.
+    __m256i nan32 = _mm256_castps_si256(nan);
+    __m128i nan16 = _mm_packs_epi32(
+        _mm256_castsi256_si128(nan32), _mm256_extractf128_si256(nan32, 1));
+    __m128i quiet = _mm_or_si128(
+        _mm_and_si128(h, _mm_set1_epi16(static_cast<short>(0x8000))),
+        _mm_set1_epi16(0x7E00));
+    h = _mm_or_si128(_mm_andnot_si128(nan16, h), _mm_and_si128(nan16, quiet));
+  }
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), h);
+}
+
+// Returns bits of NaN float scalar conversion produces for 4 halves
+// in low 16 bits of |h|.
+__m128i expandHalfNaN(__m128i h) {
+  __m128i sign = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16);
+  __m128i mantissa = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x3FF)), 13);
+  return _mm_or_si128(_mm_or_si128(sign, mantissa), _mm_set1_epi32(0x7F800000));
+}
+
+void convertHalfToFloatBatch(const uint16_t* src, float* dst) {
+  __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+  __m256 f = _mm256_cvtph_ps(h);
+
+  __m128i nan16 = _mm_cmpgt_epi16(
+      _mm_and_si128(h, _mm_set1_epi16(0x7FFF)), _mm_set1_epi16(0x7C00));
+  if (_mm_movemask_epi8(nan16)) {
+    // Hardware quiets signaling NaNs, scalar conversion keeps them as is.
+    __m128i zero = _mm_setzero_si128();
+    __m128i lo = expandHalfNaN(_mm_unpacklo_epi16(h, zero));
+    __m128i hi = expandHalfNaN(_mm_unpackhi_epi16(h, zero));
+    __m256 expected = _mm256_castsi256_ps(
+        _mm256_insertf128_si256(_mm256_castsi128_si256(lo), hi, 1));
+    __m256i nan32 = _mm256_insertf128_si256(
+        _mm256_castsi128_si256(_mm_unpacklo_epi16(nan16, nan16)),
+        _mm_unpackhi_epi16(nan16, nan16), 1);
+    f = _mm256_blendv_ps(f, expected, _mm256_castsi256_ps(nan32));
+  }
+  _mm256_storeu_ps(dst, f);
+}
+
+} // namespace
+
+void convertFloatToHalfF16c(const float* src, uint16_t* dst, int count) {
+  int i = 0;
+  for (; i + BatchSize <= count; i += BatchSize)
+    convertFloatToHalfBatch(src + i, dst + i);
+
+  if (i < count) {
+    int tail = count - i;
+    float padded_src[BatchSize] = {};
+    uint16_t padded_dst[BatchSize];
+    ::memcpy(padded_src, src + i, tail * sizeof(float));
+    convertFloatToHalfBatch(padded_src, padded_dst);
+    ::memcpy(dst + i, padded_dst, tail * sizeof(uint16_t));
+  }
+}
+
+void convertHalfToFloatF16c(const uint16_t* src, float* dst, int count) {
+  int i = 0;
+  for (; i + BatchSize <= count; i += BatchSize)
+    convertHalfToFloatBatch(src + i, dst + i);
+
+  if (i < count) {
+    int tail = count - i;
+    uint16_t padded_src[BatchSize] = {};
+    float padded_dst[BatchSize];
+    ::memcpy(padded_src, src + i, tail * sizeof(uint16_t));
+    convertHalfToFloatBatch(padded_src, padded_dst);
+    ::memcpy(dst + i, padded_dst, tail * sizeof(float));
+  }
+}
+
+} // namespace detail
+} // namespace stp
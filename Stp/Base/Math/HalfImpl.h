@@ -0,0 +1,22 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#ifndef STP_BASE_MATH_HALFIMPL_H_
+#define STP_BASE_MATH_HALFIMPL_H_
+
+#include "Base/Compiler/Cpu.h"
+#include "Base/Type/Basic.h"
+
+namespace stp {
+namespace detail {
+
+#if CPU(X86_FAMILY)
+// Defined in translation unit built with F16C enabled.
+void convertFloatToHalfF16c(const float* src, uint16_t* dst, int count);
+void convertHalfToFloatF16c(const uint16_t* src, float* dst, int count);
+#endif
+
+} // namespace detail
+} // namespace stp
+
+#endif // STP_BASE_MATH_HALFIMPL_H_
@@ -0,0 +1,80 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Math/Half.h"
+
+#include "Base/Containers/List.h"
+#include "Base/Test/GTest.h"
+#include "Base/Test/PerfTest.h"
+#include "Base/Time/TimeTicks.h"
+#include "Base/Util/Random.h"
+#include "Base/Util/RandomUtil.h"
+
+namespace stp {
+
+namespace {
+
+// Size of a typical vertex buffer, fits in L2 cache as halfs.
+constexpr int ValueCount = 1 << 16;
+constexpr int Iterations = 500;
+constexpr double TotalValueCount = static_cast<double>(ValueCount) * Iterations;
+
+class HalfPerfTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    Random random;
+    for (int i = 0; i < ValueCount; ++i)
+      floats_.add((RandomUtil::NextUnitFloat(random) - 0.5f) * 1000);
+    halfs_.appendUninitialized(ValueCount);
+    convertFloatToHalf(floats_, halfs_);
+  }
+
+  List<float> floats_;
+  List<Half> halfs_;
+};
+
+} // namespace
+
+TEST_F(HalfPerfTest, FloatToHalf) {
+  List<Half> output;
+  output.appendUninitialized(ValueCount);
+
+  TimeTicks start = TimeTicks::Now();
+  for (int j = 0; j < Iterations; ++j) {
+    for (int i = 0; i < ValueCount; ++i)
+      output[i] = Half(floats_[i]);
+  }
+  perf_test::PrintThroughput(
+      "float_to_half", "", "scalar", TotalValueCount, TimeTicks::Now() - start, "Mvalues/s", true);
+
+  start = TimeTicks::Now();
+  for (int j = 0; j < Iterations; ++j)
+    convertFloatToHalf(floats_, output);
+  perf_test::PrintThroughput(
+      "float_to_half", "", "bulk", TotalValueCount, TimeTicks::Now() - start, "Mvalues/s", true);
+
+  EXPECT_EQ(halfs_, output);
+}
+
+TEST_F(HalfPerfTest, HalfToFloat) {
+  List<float> output;
+  output.appendUninitialized(ValueCount);
+
+  TimeTicks start = TimeTicks::Now();
+  for (int j = 0; j < Iterations; ++j) {
+    for (int i = 0; i < ValueCount; ++i)
+      output[i] = static_cast<float>(halfs_[i]);
+  }
+  perf_test::PrintThroughput(
+      "half_to_float", "", "scalar", TotalValueCount, TimeTicks::Now() - start, "Mvalues/s", true);
+
+  start = TimeTicks::Now();
+  for (int j = 0; j < Iterations; ++j)
+    convertHalfToFloat(halfs_, output);
+  perf_test::PrintThroughput(
+      "half_to_float", "", "bulk", TotalValueCount, TimeTicks::Now() - start, "Mvalues/s", true);
+
+  EXPECT_EQ(ValueCount, output.size());
+}
+
+} // namespace stp
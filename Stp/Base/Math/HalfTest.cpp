@@ -3,8 +3,10 @@
 
 #include "Base/Math/Half.h"
 
+#include "Base/Containers/List.h"
 #include "Base/Test/GTest.h"
 #include "Base/Type/Limits.h"
+#include "Base/Type/Variable.h"
 
 namespace stp {
 
@@ -35,6 +37,12 @@ TEST(HalfTest, Conversion) {
   EXPECT_EQ(Limits<Half>::Infinity, static_cast<Half>(Limits<float>::Infinity));
   EXPECT_EQ(-Limits<Half>::Infinity, static_cast<Half>(-Limits<float>::Infinity));
   EXPECT_NE(static_cast<Half>(0.f).toBits(), static_cast<Half>(-0.f).toBits());
+
+  EXPECT_EQ(1.f, static_cast<float>(static_cast<Half>(1.f)));
+  EXPECT_EQ(-4.f, static_cast<float>(static_cast<Half>(-4.f)));
+  EXPECT_EQ(65504.f, static_cast<float>(Limits<Half>::Max));
+  EXPECT_EQ(0x1p-24f, static_cast<float>(Limits<Half>::SmallestSubnormal));
+  EXPECT_EQ(Limits<float>::Infinity, static_cast<float>(Limits<Half>::Infinity));
 }
 
 TEST(HalfTest, Finite) {
@@ -63,4 +71,69 @@ TEST(HalfTest, Finite) {
   EXPECT_TRUE(isNormal(eps));
 }
 
+TEST(HalfTest, Rounding) {
+  // Ties round to even.
+  EXPECT_EQ(0x3C00u, Half(1.f + 0x1p-11f).toBits());
+  EXPECT_EQ(0x3C02u, Half(1.f + 0x3p-11f).toBits());
+  EXPECT_EQ(0xBC00u, Half(-1.f - 0x1p-11f).toBits());
+  EXPECT_EQ(0x0000u, Half(0x1p-25f).toBits());
+  EXPECT_EQ(0x0002u, Half(0x3p-25f).toBits());
+  EXPECT_EQ(0x0001u, Half(0x1.01p-25f).toBits());
+
+  EXPECT_EQ(0x7BFFu, Half(65519.f).toBits());
+  EXPECT_EQ(0x7C00u, Half(65520.f).toBits());
+  EXPECT_EQ(0x7C00u, Half(1e10f).toBits());
+}
+
+TEST(HalfTest, NaNConversion) {
+  // Payload is dropped.
+  EXPECT_EQ(0x7E00u, Half(bitCast<float>(0x7F800001u)).toBits());
+  EXPECT_EQ(0x7E00u, Half(bitCast<float>(0x7FFFFFFFu)).toBits());
+  EXPECT_EQ(0xFE00u, Half(bitCast<float>(0xFFC00000u)).toBits());
+
+  // Signaling NaN is kept as is.
+  EXPECT_EQ(0x7F802000u, bitCast<uint32_t>(static_cast<float>(Half::fromBits(0x7C01))));
+  EXPECT_EQ(0xFFC00000u, bitCast<uint32_t>(static_cast<float>(Half::fromBits(0xFE00))));
+}
+
+TEST(HalfTest, BulkHalfToFloat) {
+  // Every half value, and sizes leaving tails after vector loops.
+  List<Half> halves;
+  for (int i = 0; i < 0x10000; ++i)
+    halves.add(Half::fromBits(static_cast<uint16_t>(i)));
+
+  for (int size : { 0x10000, 0x10000 - 1, 7, 3 }) {
+    List<float> floats;
+    floats.appendUninitialized(size);
+    convertHalfToFloat(halves.slice(0x10000 - size), floats);
+    for (int i = 0; i < size; ++i) {
+      Half h = halves[0x10000 - size + i];
+      ASSERT_EQ(bitCast<uint32_t>(static_cast<float>(h)), bitCast<uint32_t>(floats[i]))
+          << "half=" << h.toBits();
+    }
+  }
+}
+
+TEST(HalfTest, BulkFloatToHalf) {
+  // Sample all float ranges, including subnormals, ties, Inf and NaNs.
+  List<float> floats;
+  for (uint64_t bits = 0; bits <= 0xFFFFFFFFu; bits += 0x1001)
+    floats.add(bitCast<float>(static_cast<uint32_t>(bits)));
+  for (uint32_t bits = 0x33000000; bits < 0x33000010; ++bits)
+    floats.add(bitCast<float>(bits));
+  floats.add(1.f + 0x1p-11f);
+  floats.add(65520.f);
+  floats.add(Limits<float>::Infinity);
+  floats.add(-Limits<float>::Infinity);
+  floats.add(bitCast<float>(0xFF800001u));
+
+  List<Half> halves;
+  halves.appendUninitialized(floats.size());
+  convertFloatToHalf(floats, halves);
+  for (int i = 0; i < floats.size(); ++i) {
+    ASSERT_EQ(Half(floats[i]).toBits(), halves[i].toBits())
+        << "float=" << bitCast<uint32_t>(floats[i]);
+  }
+}
+
 } // namespace stp
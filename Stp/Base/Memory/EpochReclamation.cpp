@@ -0,0 +1,292 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Memory/EpochReclamation.h"
+
+#include "Base/Containers/List.h"
+#include "Base/Thread/Lock.h"
+#include "Base/Thread/NativeThreadLocal.h"
+#include "Base/Thread/Thread.h"
+
+// Implementation follows the classic scheme by Keir Fraser.
+//
+// There is a global epoch counter. A thread entering critical section
+// announces the current global epoch in its record. The global epoch may be
+// advanced only when all threads in critical sections announced it.
+// Consequently, when the global epoch equals E, every thread in critical
+// section runs in epoch E or E-1.
+//
+// An object retired when global epoch equals E is unreachable for threads
+// which entered later. Threads which might have seen it announced E or E-1.
+// When global epoch reaches E+2, all of them have left their critical sections.
+// Note the retiring thread itself may still run in E-1 (when nested guard
+// outlived an advance), so the tag must come from the global epoch.
+//
+// Each thread keeps retired objects in three bags, indexed by epoch modulo 3.
+// Bags are private to the thread, so retirement needs no synchronization.
+
+namespace stp {
+
+namespace {
+
+struct RetiredObject {
+  void* ptr;
+  void (*deleter)(void*);
+};
+
+struct LimboBag {
+  subtle::AtomicWord epoch = 0;
+  List<RetiredObject> objects;
+};
+
+constexpr subtle::AtomicWord ActiveBit = 1;
+constexpr subtle::AtomicWord InactiveState = 0;
+
+// Number of retirements after which thread tries to collect garbage.
+constexpr int CollectThreshold = 64;
+
+constexpr int BagCount = 3;
+
+} // namespace
+
+struct alignas(64) EpochReclamation::ThreadRecord {
+  // Announced epoch shifted left by one, ORed with ActiveBit when the thread
+  // is in critical section. Written by owning thread only.
+  subtle::AtomicWord state = InactiveState;
+
+  // Non-zero when the record is owned by a live thread.
+  subtle::Atomic32 in_use = 0;
+
+  // Following fields are accessed by owning thread only.
+  int nesting = 0;
+  int retired_since_collect = 0;
+  LimboBag bags[BagCount];
+
+  // Records are never removed from the list (until classFini), only reused.
+  ThreadRecord* next = nullptr;
+};
+
+static subtle::AtomicWord g_global_epoch = 0;
+static subtle::AtomicWord g_records = 0;
+static NativeThreadLocal::Slot g_tls_record;
+
+// Bags left over by exited threads.
+static BasicLock g_orphans_lock = BASIC_LOCK_INITIALIZER;
+static List<LimboBag>* g_orphans = nullptr;
+
+static inline EpochReclamation::ThreadRecord* loadRecordList() {
+  return reinterpret_cast<EpochReclamation::ThreadRecord*>(subtle::Acquire_Load(&g_records));
+}
+
+static void freeObjects(List<RetiredObject>& objects) {
+  // Deleters may retire more objects. Do not let them modify the list
+  // we are iterating over.
+  List<RetiredObject> dying = move(objects);
+  for (const RetiredObject& object : dying)
+    object.deleter(object.ptr);
+}
+
+static inline bool isBagExpired(const LimboBag& bag, subtle::AtomicWord global_epoch) {
+  return bag.epoch + 2 <= global_epoch;
+}
+
+static EpochReclamation::ThreadRecord* acquireRecord() {
+  using ThreadRecord = EpochReclamation::ThreadRecord;
+
+  for (ThreadRecord* record = loadRecordList(); record; record = record->next) {
+    if (subtle::NoBarrier_Load(&record->in_use) == 0 &&
+        subtle::Acquire_CompareAndSwap(&record->in_use, 0, 1) == 0) {
+      return record;
+    }
+  }
+
+  auto* record = new ThreadRecord();
+  record->in_use = 1;
+
+  subtle::AtomicWord head = subtle::NoBarrier_Load(&g_records);
+  for (;;) {
+    record->next = reinterpret_cast<ThreadRecord*>(head);
+    subtle::AtomicWord previous = subtle::Release_CompareAndSwap(
+        &g_records, head, reinterpret_cast<subtle::AtomicWord>(record));
+    if (previous == head)
+      break;
+    head = previous;
+  }
+  return record;
+}
+
+static void unregisterThread(EpochReclamation::ThreadRecord* record) {
+  ASSERT(record->nesting == 0, "thread exits within critical section");
+
+  {
+    AutoLock guard(borrow(g_orphans_lock));
+    for (LimboBag& bag : record->bags) {
+      if (!bag.objects.isEmpty())
+        g_orphans->add(move(bag));
+      bag = LimboBag();
+    }
+  }
+  record->retired_since_collect = 0;
+  NativeThreadLocal::setValue(g_tls_record, nullptr);
+  subtle::Release_Store(&record->in_use, 0);
+}
+
+EpochReclamation::ThreadRecord* EpochReclamation::currentRecord() {
+  auto* record = static_cast<ThreadRecord*>(NativeThreadLocal::getValue(g_tls_record));
+  if (LIKELY(record))
+    return record;
+
+  ASSERT(g_orphans, "EpochReclamation used before initialization");
+
+  record = acquireRecord();
+  NativeThreadLocal::setValue(g_tls_record, record);
+
+  ThisThread::Adopt();
+  ThisThread::AtExit([record] { unregisterThread(record); });
+  return record;
+}
+
+void EpochReclamation::enter(ThreadRecord* record) {
+  if (record->nesting++ != 0)
+    return;
+
+  for (;;) {
+    subtle::AtomicWord epoch = subtle::NoBarrier_Load(&g_global_epoch);
+    subtle::NoBarrier_Store(&record->state, (epoch << 1) | ActiveBit);
+    // Pairs with the barrier in tryAdvance(). Either the collector sees us
+    // active or we see the epoch it advanced to.
+    subtle::MemoryBarrier();
+    // Announced epoch must not lag behind - recheck it.
+    if (LIKELY(subtle::NoBarrier_Load(&g_global_epoch) == epoch))
+      break;
+  }
+}
+
+void EpochReclamation::leave(ThreadRecord* record) {
+  ASSERT(record->nesting > 0);
+  if (--record->nesting != 0)
+    return;
+
+  subtle::Release_Store(&record->state, InactiveState);
+}
+
+// Returns true if global epoch was advanced (by us or someone else).
+static bool tryAdvance() {
+  subtle::AtomicWord epoch = subtle::NoBarrier_Load(&g_global_epoch);
+  subtle::MemoryBarrier();
+
+  for (auto* record = loadRecordList(); record; record = record->next) {
+    subtle::AtomicWord state = subtle::Acquire_Load(&record->state);
+    if ((state & ActiveBit) && (state >> 1) != epoch)
+      return false;
+  }
+  subtle::NoBarrier_CompareAndSwap(&g_global_epoch, epoch, epoch + 1);
+  subtle::MemoryBarrier();
+  return true;
+}
+
+static void collectOrphans(subtle::AtomicWord global_epoch, bool wait) {
+  List<RetiredObject> expired;
+
+  if (wait)
+    g_orphans_lock.acquire();
+  else if (!g_orphans_lock.tryAcquire())
+    return;
+
+  for (int i = g_orphans->size() - 1; i >= 0; --i) {
+    LimboBag& bag = (*g_orphans)[i];
+    if (isBagExpired(bag, global_epoch)) {
+      expired.append(bag.objects);
+      g_orphans->removeAt(i);
+    }
+  }
+  g_orphans_lock.release();
+
+  freeObjects(expired);
+}
+
+static void collectForRecord(EpochReclamation::ThreadRecord* record, bool wait) {
+  record->retired_since_collect = 0;
+
+  tryAdvance();
+
+  subtle::AtomicWord global_epoch = subtle::Acquire_Load(&g_global_epoch);
+  for (LimboBag& bag : record->bags) {
+    if (!bag.objects.isEmpty() && isBagExpired(bag, global_epoch))
+      freeObjects(bag.objects);
+  }
+  collectOrphans(global_epoch, wait);
+}
+
+void EpochReclamation::retire(void* ptr, void (*deleter)(void*)) {
+  ASSERT(ptr && deleter);
+  ThreadRecord* record = currentRecord();
+
+  {
+    // Being in critical section keeps global epoch within one of ours.
+    EpochGuard guard(record);
+
+    // Order unlinking of the object before reading the epoch. A reader which
+    // announced a later epoch cannot reach the object.
+    subtle::MemoryBarrier();
+    subtle::AtomicWord epoch = subtle::Acquire_Load(&g_global_epoch);
+    LimboBag& bag = record->bags[epoch % BagCount];
+    if (bag.epoch != epoch) {
+      // The bag holds objects from at least three epochs ago.
+      if (!bag.objects.isEmpty())
+        freeObjects(bag.objects);
+      bag.epoch = epoch;
+    }
+    bag.objects.add(RetiredObject { ptr, deleter });
+  }
+
+  if (++record->retired_since_collect >= CollectThreshold && record->nesting == 0)
+    collectForRecord(record, false);
+}
+
+void EpochReclamation::collect() {
+  ThreadRecord* record = currentRecord();
+  if (record->nesting == 0)
+    collectForRecord(record, false);
+}
+
+void EpochReclamation::synchronize() {
+  ThreadRecord* record = currentRecord();
+  ASSERT(record->nesting == 0, "synchronize() called within critical section");
+
+  subtle::AtomicWord target = subtle::Acquire_Load(&g_global_epoch) + 2;
+  while (subtle::Acquire_Load(&g_global_epoch) < target) {
+    if (!tryAdvance())
+      ThisThread::Yield();
+  }
+  collectForRecord(record, true);
+}
+
+void EpochReclamation::classInit() {
+  g_tls_record = NativeThreadLocal::allocate();
+  g_orphans = new List<LimboBag>();
+}
+
+void EpochReclamation::classFini() {
+  // All threads using reclamation must have exited by now, including
+  // the main thread (see Thread::ClassFini), so everything can be freed.
+  for (LimboBag& bag : *g_orphans)
+    freeObjects(bag.objects);
+  delete g_orphans;
+  g_orphans = nullptr;
+
+  auto* record = loadRecordList();
+  while (record) {
+    ASSERT(record->in_use == 0, "thread still registered");
+    auto* next = record->next;
+    for (LimboBag& bag : record->bags)
+      freeObjects(bag.objects);
+    delete record;
+    record = next;
+  }
+  subtle::NoBarrier_Store(&g_records, 0);
+
+  NativeThreadLocal::deallocate(g_tls_record);
+}
+
+} // namespace stp
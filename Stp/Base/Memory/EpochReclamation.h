@@ -0,0 +1,97 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#ifndef STP_BASE_MEMORY_EPOCHRECLAMATION_H_
+#define STP_BASE_MEMORY_EPOCHRECLAMATION_H_
+
+#include "Base/Debug/Assert.h"
+#include "Base/Thread/AtomicOps.h"
+
+namespace stp {
+
+class EpochGuard;
+
+// Epoch-based memory reclamation for lock-free data structures.
+//
+// A node removed from a lock-free structure cannot be freed immediately since
+// other threads may still be reading it. Instead it is retired and freed once
+// every thread which could have seen it has left its critical section.
+//
+// Readers bracket accesses to shared nodes with a guard:
+//
+//   {
+//     EpochGuard guard = EpochReclamation::guard();
+//     Node* node = head.load();
+//     ... // |node| is safe to dereference here
+//   }
+//
+// Writers unlink the node first and then retire it:
+//
+//   EpochReclamation::retire(node);
+//
+// Guards are cheap (no shared cache line is written), but a thread must not
+// block while holding one - it would prevent reclamation process-wide.
+//
+// Threads are registered on first use. Spawned threads and adopted threads
+// (see ThisThread::Adopt) are unregistered automatically when they exit,
+// their pending retired objects are passed to other threads.
+class BASE_EXPORT EpochReclamation {
+  STATIC_ONLY(EpochReclamation);
+ public:
+  // Enters critical section. Guards may be nested.
+  static EpochGuard guard();
+
+  // Schedules |ptr| to be destroyed with |deleter| once no thread can reference it.
+  // The object must already be unreachable for threads entering critical section.
+  static void retire(void* ptr, void (*deleter)(void*));
+
+  template<typename T>
+  static void retire(T* ptr) {
+    retire(ptr, [](void* opaque) { delete static_cast<T*>(opaque); });
+  }
+
+  // Tries to advance global epoch and frees objects retired by calling thread
+  // which became safe to free. Called implicitly every few retirements.
+  static void collect();
+
+  // Waits until everything retired so far by any thread is freed.
+  // Must not be called from within critical section.
+  static void synchronize();
+
+  static void classInit();
+  static void classFini();
+
+  struct ThreadRecord;
+
+ private:
+  friend class EpochGuard;
+
+  static ThreadRecord* currentRecord();
+  static void enter(ThreadRecord* record);
+  static void leave(ThreadRecord* record);
+};
+
+class EpochGuard {
+ public:
+  EpochGuard(EpochGuard&& other) : record_(other.record_) { other.record_ = nullptr; }
+  ~EpochGuard() { if (record_) EpochReclamation::leave(record_); }
+
+ private:
+  friend class EpochReclamation;
+
+  explicit EpochGuard(EpochReclamation::ThreadRecord* record) : record_(record) {
+    EpochReclamation::enter(record_);
+  }
+
+  EpochReclamation::ThreadRecord* record_;
+
+  DISALLOW_COPY_AND_ASSIGN(EpochGuard);
+};
+
+inline EpochGuard EpochReclamation::guard() {
+  return EpochGuard(currentRecord());
+}
+
+} // namespace stp
+
+#endif // STP_BASE_MEMORY_EPOCHRECLAMATION_H_
@@ -0,0 +1,82 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Memory/EpochReclamation.h"
+
+#include "Base/Memory/OwnPtr.h"
+#include "Base/Test/GTest.h"
+#include "Base/Test/PerfTest.h"
+#include "Base/Text/StringFormatMany.h"
+#include "Base/Thread/Thread.h"
+#include "Base/Time/TimeTicks.h"
+
+namespace stp {
+
+static const int OperationsPerThread = 200000;
+static const int ThreadCounts[] = { 1, 2, 4, 8, 16 };
+
+namespace {
+
+struct RetiredNode {
+  int64_t payload[4];
+};
+
+class RetireThread : public Thread {
+ public:
+  int Main() override {
+    for (int i = 0; i < OperationsPerThread; ++i)
+      EpochReclamation::retire(new RetiredNode());
+    return 0;
+  }
+};
+
+class GuardThread : public Thread {
+ public:
+  int Main() override {
+    int sum = 0;
+    for (int i = 0; i < OperationsPerThread; ++i) {
+      EpochGuard guard = EpochReclamation::guard();
+      sum += i;
+    }
+    return sum;
+  }
+};
+
+template<typename TThread>
+double runThreads(int thread_count) {
+  List<OwnPtr<TThread>> threads;
+  for (int i = 0; i < thread_count; ++i)
+    threads.add(OwnPtr<TThread>::create());
+
+  TimeTicks start = TimeTicks::Now();
+  for (auto& thread : threads)
+    thread->Start();
+  for (auto& thread : threads)
+    thread->Join();
+  EpochReclamation::synchronize();
+  return (TimeTicks::Now() - start).InMillisecondsF();
+}
+
+} // namespace
+
+TEST(EpochReclamationPerfTest, RetireThroughput) {
+  for (int thread_count : ThreadCounts) {
+    double total_time_milliseconds = runThreads<RetireThread>(thread_count);
+    perf_test::PrintResult(
+        "retire", stringFormatMany("_{}threads", thread_count), "epoch",
+        thread_count * OperationsPerThread / total_time_milliseconds,
+        "retires/ms", true);
+  }
+}
+
+TEST(EpochReclamationPerfTest, GuardOverhead) {
+  for (int thread_count : ThreadCounts) {
+    double total_time_milliseconds = runThreads<GuardThread>(thread_count);
+    perf_test::PrintResult(
+        "guard", stringFormatMany("_{}threads", thread_count), "epoch",
+        thread_count * OperationsPerThread / total_time_milliseconds,
+        "guards/ms", true);
+  }
+}
+
+} // namespace stp
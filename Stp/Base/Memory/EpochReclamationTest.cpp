@@ -0,0 +1,199 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Memory/EpochReclamation.h"
+
+#include "Base/Memory/OwnPtr.h"
+#include "Base/Test/GTest.h"
+#include "Base/Thread/Thread.h"
+#include "Base/Thread/WaitableEvent.h"
+
+namespace stp {
+
+namespace {
+
+struct TrackedNode {
+  explicit TrackedNode(int value) : value(value) {
+    subtle::Barrier_AtomicIncrement(&LiveCount, 1);
+  }
+  ~TrackedNode() {
+    value = -1;
+    subtle::Barrier_AtomicIncrement(&LiveCount, -1);
+  }
+
+  int value;
+
+  static subtle::Atomic32 LiveCount;
+};
+
+subtle::Atomic32 TrackedNode::LiveCount = 0;
+
+} // namespace
+
+TEST(EpochReclamationTest, RetireAndSynchronize) {
+  ASSERT_EQ(0, subtle::Acquire_Load(&TrackedNode::LiveCount));
+
+  for (int i = 0; i < 10; ++i)
+    EpochReclamation::retire(new TrackedNode(i));
+
+  EpochReclamation::synchronize();
+  EXPECT_EQ(0, subtle::Acquire_Load(&TrackedNode::LiveCount));
+}
+
+TEST(EpochReclamationTest, GuardDefersReclamation) {
+  TrackedNode* node = new TrackedNode(1);
+  {
+    EpochGuard guard = EpochReclamation::guard();
+    EpochGuard nested = EpochReclamation::guard();
+    EpochReclamation::retire(node);
+    for (int i = 0; i < 10; ++i)
+      EpochReclamation::collect();
+
+    // Still inside critical section, the node must survive.
+    EXPECT_EQ(1, node->value);
+  }
+  EpochReclamation::synchronize();
+  EXPECT_EQ(0, subtle::Acquire_Load(&TrackedNode::LiveCount));
+}
+
+namespace {
+
+class EpochAdvancerThread : public Thread {
+ public:
+  int Main() override {
+    EpochReclamation::collect();
+    return 0;
+  }
+};
+
+class EpochHolderThread : public Thread {
+ public:
+  explicit EpochHolderThread(subtle::AtomicWord* shared)
+      : shared_(shared),
+        entered_(WaitableEvent::ResetPolicy::Manual, WaitableEvent::InitialState::NotSignaled),
+        release_(WaitableEvent::ResetPolicy::Manual, WaitableEvent::InitialState::NotSignaled) {}
+
+  int Main() override {
+    EpochGuard guard = EpochReclamation::guard();
+    auto* node = reinterpret_cast<TrackedNode*>(subtle::Acquire_Load(shared_));
+    entered_.Signal();
+    release_.Wait();
+    return node->value;
+  }
+
+  WaitableEvent& entered() { return entered_; }
+  WaitableEvent& release() { return release_; }
+
+ private:
+  subtle::AtomicWord* shared_;
+  WaitableEvent entered_;
+  WaitableEvent release_;
+};
+
+} // namespace
+
+// The retiring thread lags one epoch behind a reader holding the node.
+TEST(EpochReclamationTest, RetireWithinLaggingGuard) {
+  auto* node = new TrackedNode(7);
+  subtle::AtomicWord shared = reinterpret_cast<subtle::AtomicWord>(node);
+  EpochHolderThread holder(&shared);
+  {
+    EpochGuard guard = EpochReclamation::guard();
+
+    // Other thread advances global epoch past the one we announced.
+    EpochAdvancerThread advancer;
+    advancer.Start();
+    advancer.Join();
+
+    // Reader enters in the newer epoch and holds the node.
+    holder.Start();
+    holder.entered().Wait();
+
+    subtle::NoBarrier_Store(&shared, 0);
+    EpochGuard nested = EpochReclamation::guard();
+    EpochReclamation::retire(node);
+  }
+  // Only the holder remains in critical section, the epoch may advance,
+  // but not far enough to free the node.
+  for (int i = 0; i < 10; ++i)
+    EpochReclamation::collect();
+
+  holder.release().Signal();
+  EXPECT_EQ(7, holder.Join());
+
+  EpochReclamation::synchronize();
+  EXPECT_EQ(0, subtle::Acquire_Load(&TrackedNode::LiveCount));
+}
+
+namespace {
+
+const int StressIterations = 20000;
+
+class EpochWriterThread : public Thread {
+ public:
+  explicit EpochWriterThread(subtle::AtomicWord* shared) : shared_(shared) {}
+
+  int Main() override {
+    for (int i = 0; i < StressIterations; ++i) {
+      auto* node = new TrackedNode(i + 1);
+      auto* old = reinterpret_cast<TrackedNode*>(
+          subtle::NoBarrier_AtomicExchange(shared_, reinterpret_cast<subtle::AtomicWord>(node)));
+      subtle::MemoryBarrier();
+      EpochReclamation::retire(old);
+    }
+    return 0;
+  }
+
+ private:
+  subtle::AtomicWord* shared_;
+};
+
+class EpochReaderThread : public Thread {
+ public:
+  explicit EpochReaderThread(subtle::AtomicWord* shared) : shared_(shared) {}
+
+  int Main() override {
+    int failures = 0;
+    for (int i = 0; i < StressIterations; ++i) {
+      EpochGuard guard = EpochReclamation::guard();
+      auto* node = reinterpret_cast<TrackedNode*>(subtle::Acquire_Load(shared_));
+      if (node->value <= 0)
+        ++failures;
+    }
+    return failures;
+  }
+
+ private:
+  subtle::AtomicWord* shared_;
+};
+
+} // namespace
+
+// Readers must never observe a node freed by concurrent writers.
+TEST(EpochReclamationTest, Stress) {
+  subtle::AtomicWord shared = reinterpret_cast<subtle::AtomicWord>(new TrackedNode(1));
+
+  List<OwnPtr<EpochWriterThread>> writers;
+  List<OwnPtr<EpochReaderThread>> readers;
+  for (int i = 0; i < 2; ++i)
+    writers.add(OwnPtr<EpochWriterThread>::create(&shared));
+  for (int i = 0; i < 6; ++i)
+    readers.add(OwnPtr<EpochReaderThread>::create(&shared));
+
+  for (auto& reader : readers)
+    reader->Start();
+  for (auto& writer : writers)
+    writer->Start();
+
+  for (auto& writer : writers)
+    EXPECT_EQ(0, writer->Join());
+  for (auto& reader : readers)
+    EXPECT_EQ(0, reader->Join());
+
+  EpochReclamation::synchronize();
+  EXPECT_EQ(1, subtle::Acquire_Load(&TrackedNode::LiveCount));
+
+  delete reinterpret_cast<TrackedNode*>(shared);
+}
+
+} // namespace stp
@@ -33,6 +33,9 @@ inline int callLstat(const char* path, stat_wrapper_t* sb) {
 inline int callFstat(int fd, stat_wrapper_t* file_info) {
   return WRAP_CALL(fstat)(fd, file_info);
 }
+inline int callFstatAt(int dir_fd, const char* path, stat_wrapper_t* sb, int flags) {
+  return WRAP_CALL(fstatat)(dir_fd, path, sb, flags);
+}
 
 #undef WRAP_CALL
 
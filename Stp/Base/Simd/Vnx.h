@@ -16,10 +16,25 @@
 
 #include <string.h>
 
-namespace stp {
-
 // #define DISABLE_VNX_SIMD 1
 
+// VecNx is specialized differently for each instruction set. Some translation
+// units are built with more instruction sets enabled than the rest of program
+// (and called only after checking CpuInfo). Everything lives in a namespace
+// specific to the instruction set, so the linker never picks an instance
+// compiled for one set to use in code built for the other.
+#define _STP_VNX_CONCAT(a, b) a ## b
+#define _STP_VNX_EXPAND(a, b) _STP_VNX_CONCAT(a, b)
+
+#if defined(DISABLE_VNX_SIMD) || !defined(_STP_CPU_SIMD_LEVEL)
+# define STP_VNX_NAMESPACE VnxScalar
+#else
+# define STP_VNX_NAMESPACE _STP_VNX_EXPAND(VnxLevel, _STP_CPU_SIMD_LEVEL)
+#endif
+
+namespace stp {
+inline namespace STP_VNX_NAMESPACE {
+
 // The default implementations just fall back on a pair of size N/2.
 template<unsigned N, typename T>
 struct VecNx {
@@ -50,6 +65,46 @@ struct VecNx {
     hi_.store(ptr + N/2);
   }
 
+  // Loads first |count| components from memory, the rest is zeroed.
+  // Memory past |count| elements is never accessed, so this is safe for
+  // processing tails of arrays.
+  static VecNx loadMasked(const T* ptr, int count) {
+    ASSERT(0 <= count && count <= static_cast<int>(N));
+    if (count <= static_cast<int>(N/2))
+      return { Half::loadMasked(ptr, count), Half(0) };
+    return { Half::load(ptr), Half::loadMasked(ptr + N/2, count - N/2) };
+  }
+
+  // Stores first |count| components to memory (inverse of loadMasked()).
+  void storeMasked(T* ptr, int count) const {
+    ASSERT(0 <= count && count <= static_cast<int>(N));
+    if (count <= static_cast<int>(N/2)) {
+      lo_.storeMasked(ptr, count);
+    } else {
+      lo_.store(ptr);
+      hi_.storeMasked(ptr + N/2, count - N/2);
+    }
+  }
+
+  // Loads components from arbitrary locations, i.e. v[k] = base[indices[k]].
+  static VecNx gather(const T* base, const VecNx<N,int32_t>& indices) {
+    VecNx<N/2,int32_t> lo, hi;
+    indices.split(&lo, &hi);
+    return { Half::gather(base, lo), Half::gather(base, hi) };
+  }
+
+  // Loads 4 vectors from interleaved memory, i.e. a[k] = ptr[4*k], b[k] = ptr[4*k+1], etc.
+  static void load4(const T* ptr, VecNx* a, VecNx* b, VecNx* c, VecNx* d) {
+    Half::load4(ptr, &a->lo_, &b->lo_, &c->lo_, &d->lo_);
+    Half::load4(ptr + 4*N/2, &a->hi_, &b->hi_, &c->hi_, &d->hi_);
+  }
+
+  // Stores 4 vectors to memory interleaving their components (inverse of load4()).
+  static void store4(T* ptr, const VecNx& a, const VecNx& b, const VecNx& c, const VecNx& d) {
+    Half::store4(ptr, a.lo_, b.lo_, c.lo_, d.lo_);
+    Half::store4(ptr + 4*N/2, a.hi_, b.hi_, c.hi_, d.hi_);
+  }
+
   // Returns true if all components are != 0.
   bool allTrue() const { return lo_.allTrue() && hi_.allTrue(); }
 
@@ -85,6 +140,11 @@ struct VecNx {
              Half::ternary(c.hi_, t.hi_, e.hi_) };
   }
 
+  // Returns upper half of double-width product for each component (integers only).
+  static VecNx mulHi(const VecNx& l, const VecNx& r) {
+    return { Half::mulHi(l.lo_, r.lo_), Half::mulHi(l.hi_, r.hi_) };
+  }
+
   // Saturated addition.
   static VecNx saturatedAdd(const VecNx& l, const VecNx& r) {
     return { Half::saturatedAdd(l.lo_, r.lo_), Half::saturatedAdd(l.hi_, r.hi_) };
@@ -118,6 +178,11 @@ struct VecNx {
     return k < N/2 ? lo_[k] : hi_[k-N/2];
   }
 
+  void split(Half* lo, Half* hi) const {
+    *lo = lo_;
+    *hi = hi_;
+  }
+
   Half lo_;
   Half hi_;
 };
@@ -135,6 +200,29 @@ struct VecNx<1,T> {
   static VecNx load(const T* ptr) { return *ptr; }
   void store(T* ptr) const { *ptr = val_; }
 
+  static VecNx loadMasked(const T* ptr, int count) { return count > 0 ? *ptr : T(0); }
+  void storeMasked(T* ptr, int count) const {
+    if (count > 0)
+      *ptr = val_;
+  }
+
+  static VecNx gather(const T* base, const VecNx<1,int32_t>& index) {
+    return base[index.val_];
+  }
+
+  static void load4(const T* ptr, VecNx* a, VecNx* b, VecNx* c, VecNx* d) {
+    *a = ptr[0];
+    *b = ptr[1];
+    *c = ptr[2];
+    *d = ptr[3];
+  }
+  static void store4(T* ptr, const VecNx& a, const VecNx& b, const VecNx& c, const VecNx& d) {
+    ptr[0] = a.val_;
+    ptr[1] = b.val_;
+    ptr[2] = c.val_;
+    ptr[3] = d.val_;
+  }
+
   bool allTrue() const { return val_ != 0; }
   bool anyTrue() const { return val_ != 0; }
 
@@ -153,6 +241,11 @@ struct VecNx<1,T> {
   static VecNx ternary(const VecNx& c, const VecNx& t, const VecNx& e) {
     return c.val_ != 0 ? t : e;
   }
+  static VecNx mulHi(const VecNx& l, const VecNx& r) {
+    static_assert(TIsInteger<T> && sizeof(T) <= 4, "!");
+    typedef TMakeInteger<TIsSigned<T>, sizeof(T) * 2> WideType;
+    return static_cast<T>((static_cast<WideType>(l.val_) * r.val_) >> (sizeof(T) * 8));
+  }
   static VecNx saturatedAdd(const VecNx& x, const VecNx& y) {
     static_assert(TIsUnsigned<T>, "!");
     T sum = x.val_ + y.val_;
@@ -203,9 +296,29 @@ struct VecNx<1,T> {
   static T fromBits(Bits bits) { return bitCast<T>(bits); }
 };
 
+// Fallbacks for backends without native masked loads and stores. They go
+// through a temporary buffer, so memory past |count| elements is never touched.
+template<typename TVec, typename T>
+inline TVec vnxLoadMasked(const T* ptr, int count) {
+  ASSERT(0 <= count && count <= TVec::Size);
+  T buffer[TVec::Size] = {};
+  memcpy(buffer, ptr, count * sizeof(T));
+  return TVec::load(buffer);
+}
+
+template<typename TVec, typename T>
+inline void vnxStoreMasked(const TVec& v, T* ptr, int count) {
+  ASSERT(0 <= count && count <= TVec::Size);
+  T buffer[TVec::Size];
+  v.store(buffer);
+  memcpy(ptr, buffer, count * sizeof(T));
+}
+
 template<typename D, typename S, unsigned N>
 inline VecNx<N,D> vnxCast(const VecNx<N,S>& x) {
-  return { vnxCast<D>(x.lo_), vnxCast<D>(x.hi_) };
+  VecNx<N/2,S> lo, hi;
+  x.split(&lo, &hi);
+  return { vnxCast<D>(lo), vnxCast<D>(hi) };
 }
 
 template<typename D, typename S>
@@ -270,8 +383,7 @@ class VnxMath {
   // VecNx<N,T> ~~> VecNx<N/2,T> + VecNx<N/2,T>
   template<unsigned N, typename T>
   static void split(const VecNx<N,T>& v, VecNx<N/2,T>* lo, VecNx<N/2,T>* hi) {
-    *lo = v.lo_;
-    *hi = v.hi_;
+    v.split(lo, hi);
   }
 
   // VecNx<N/2,T> + VecNx<N/2,T> ~~> VecNx<N,T>
@@ -293,22 +405,33 @@ typedef VecNx< 8, double> Vec8d;
 typedef VecNx< 4, uint16_t> Vec4h;
 typedef VecNx< 8, uint16_t> Vec8h;
 typedef VecNx<16, uint16_t> Vec16h;
+typedef VecNx<32, uint16_t> Vec32h;
 
 typedef VecNx< 4, uint8_t> Vec4b;
 typedef VecNx< 8, uint8_t> Vec8b;
 typedef VecNx<16, uint8_t> Vec16b;
+typedef VecNx<32, uint8_t> Vec32b;
+typedef VecNx<64, uint8_t> Vec64b;
 
 typedef VecNx< 4,  int32_t> Vec4i;
 typedef VecNx< 8,  int32_t> Vec8i;
+typedef VecNx<16,  int32_t> Vec16i;
 
 typedef VecNx<4, uint32_t> Vec4u;
 
+} // inline namespace STP_VNX_NAMESPACE
 } // namespace stp
 
 // Include platform specific specializations if available.
 #if !defined(DISABLE_VNX_SIMD)
 # if CPU_SIMD(SSE2)
 #  include "Base/Simd/VnxSse.h"
+#  if CPU_SIMD(AVX2)
+#   include "Base/Simd/VnxAvx.h"
+#  endif
+#  if CPU_SIMD(AVX512)
+#   include "Base/Simd/VnxAvx512.h"
+#  endif
 # elif CPU_SIMD(NEON)
 #  include "Base/Simd/VnxNeon.h"
 # endif
@@ -0,0 +1,392 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#ifndef STP_BASE_SIMD_VNXAVX_H_
+#define STP_BASE_SIMD_VNXAVX_H_
+
+// This file may assume AVX2, it is included after VnxSse.h only.
+// 256-bit vectors split into (and join from) pairs of 128-bit ones from VnxSse.h.
+
+#include "Base/Debug/Assert.h"
+
+#include <immintrin.h>
+
+namespace stp {
+inline namespace STP_VNX_NAMESPACE {
+
+template<>
+struct VecNx<8, float> {
+  static constexpr int Size = 8;
+
+  VecNx(const __m256& vec) : vec_(vec) {}
+
+  VecNx() = default;
+  VecNx(float val) : vec_(_mm256_set1_ps(val)) {}
+  VecNx(float a, float b, float c, float d, float e, float f, float g, float h)
+      : vec_(_mm256_setr_ps(a,b,c,d,e,f,g,h)) {}
+  VecNx(const Vec4f& lo, const Vec4f& hi)
+      : vec_(_mm256_insertf128_ps(_mm256_castps128_ps256(lo.vec_), hi.vec_, 1)) {}
+
+  static VecNx load(const float* ptr) { return _mm256_loadu_ps(ptr); }
+  void store(float* ptr) const { _mm256_storeu_ps(ptr, vec_); }
+
+  static VecNx loadMasked(const float* ptr, int count) {
+    return _mm256_maskload_ps(ptr, laneMask(count));
+  }
+  void storeMasked(float* ptr, int count) const {
+    _mm256_maskstore_ps(ptr, laneMask(count), vec_);
+  }
+
+  static VecNx gather(const float* base, const VecNx<8, int32_t>& indices);
+
+  void split(Vec4f* lo, Vec4f* hi) const {
+    *lo = _mm256_castps256_ps128(vec_);
+    *hi = _mm256_extractf128_ps(vec_, 1);
+  }
+
+  bool allTrue() const { return _mm256_movemask_ps(vec_) == 0xFF; }
+  bool anyTrue() const { return _mm256_movemask_ps(vec_) != 0x00; }
+
+  VecNx mathAbs() const { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), vec_); }
+  VecNx mathSqrt() const { return _mm256_sqrt_ps(vec_); }
+  VecNx mathRsqrt() const { return _mm256_rsqrt_ps(vec_); }
+  VecNx reciprocal() const { return _mm256_rcp_ps(vec_); }
+  VecNx mathFloor() const { return _mm256_floor_ps(vec_); }
+
+  static VecNx min(const VecNx& l, const VecNx& r) {
+    return _mm256_min_ps(l.vec_, r.vec_);
+  }
+  static VecNx max(const VecNx& l, const VecNx& r) {
+    return _mm256_max_ps(l.vec_, r.vec_);
+  }
+
+  static VecNx ternary(const VecNx& c, const VecNx& t, const VecNx& e) {
+    return _mm256_blendv_ps(e.vec_, t.vec_, c.vec_);
+  }
+
+  VecNx operator+(const VecNx& o) const { return _mm256_add_ps(vec_, o.vec_); }
+  VecNx operator-(const VecNx& o) const { return _mm256_sub_ps(vec_, o.vec_); }
+  VecNx operator*(const VecNx& o) const { return _mm256_mul_ps(vec_, o.vec_); }
+  VecNx operator/(const VecNx& o) const { return _mm256_div_ps(vec_, o.vec_); }
+
+  VecNx operator==(const VecNx& o) const { return _mm256_cmp_ps(vec_, o.vec_, _CMP_EQ_OQ); }
+  VecNx operator!=(const VecNx& o) const { return _mm256_cmp_ps(vec_, o.vec_, _CMP_NEQ_UQ); }
+  VecNx operator<(const VecNx& o) const { return _mm256_cmp_ps(vec_, o.vec_, _CMP_LT_OQ); }
+  VecNx operator>(const VecNx& o) const { return _mm256_cmp_ps(vec_, o.vec_, _CMP_GT_OQ); }
+  VecNx operator<=(const VecNx& o) const { return _mm256_cmp_ps(vec_, o.vec_, _CMP_LE_OQ); }
+  VecNx operator>=(const VecNx& o) const { return _mm256_cmp_ps(vec_, o.vec_, _CMP_GE_OQ); }
+
+  VecNx operator&(const VecNx& o) const { return _mm256_and_ps(vec_, o.vec_); }
+  VecNx operator|(const VecNx& o) const { return _mm256_or_ps(vec_, o.vec_); }
+  VecNx operator^(const VecNx& o) const { return _mm256_xor_ps(vec_, o.vec_); }
+
+  float operator[](int k) const {
+    ASSERT(0 <= k && k < Size);
+    union { __m256 v; float fs[8]; } pun = {vec_};
+    return pun.fs[k];
+  }
+
+  __m256 vec_;
+
+ private:
+  // Returns mask with all bits set in first |count| lanes.
+  static __m256i laneMask(int count) {
+    ASSERT(0 <= count && count <= Size);
+    return _mm256_cmpgt_epi32(_mm256_set1_epi32(count), _mm256_setr_epi32(0,1,2,3,4,5,6,7));
+  }
+};
+
+template<>
+struct VecNx<8, int32_t> {
+  static constexpr int Size = 8;
+
+  VecNx(const __m256i& vec) : vec_(vec) {}
+
+  VecNx() = default;
+  VecNx(int32_t val) : vec_(_mm256_set1_epi32(val)) {}
+  VecNx(int32_t a, int32_t b, int32_t c, int32_t d, int32_t e, int32_t f, int32_t g, int32_t h)
+      : vec_(_mm256_setr_epi32(a,b,c,d,e,f,g,h)) {}
+  VecNx(const Vec4i& lo, const Vec4i& hi)
+      : vec_(_mm256_inserti128_si256(_mm256_castsi128_si256(lo.vec_), hi.vec_, 1)) {}
+
+  static VecNx load(const int32_t* ptr) {
+    return _mm256_loadu_si256((const __m256i*)ptr);
+  }
+  void store(int32_t* ptr) const { _mm256_storeu_si256((__m256i*)ptr, vec_); }
+
+  static VecNx loadMasked(const int32_t* ptr, int count) {
+    return _mm256_maskload_epi32((const int*)ptr, laneMask(count));
+  }
+  void storeMasked(int32_t* ptr, int count) const {
+    _mm256_maskstore_epi32((int*)ptr, laneMask(count), vec_);
+  }
+
+  static VecNx gather(const int32_t* base, const VecNx& indices) {
+    return _mm256_i32gather_epi32((const int*)base, indices.vec_, 4);
+  }
+
+  static void load4(const int32_t* ptr, VecNx* a, VecNx* b, VecNx* c, VecNx* d) {
+    __m256i v0 = _mm256_loadu_si256((const __m256i*)(ptr + 0)),
+            v1 = _mm256_loadu_si256((const __m256i*)(ptr + 8)),
+            v2 = _mm256_loadu_si256((const __m256i*)(ptr + 16)),
+            v3 = _mm256_loadu_si256((const __m256i*)(ptr + 24));
+    // Move elements k and k+4 into the same 128-bit lane, then transpose
+    // each lane like VnxSse.h does.
+    transpose(
+        _mm256_permute2x128_si256(v0, v2, 0x20),
+        _mm256_permute2x128_si256(v0, v2, 0x31),
+        _mm256_permute2x128_si256(v1, v3, 0x20),
+        _mm256_permute2x128_si256(v1, v3, 0x31),
+        a, b, c, d);
+  }
+  static void store4(int32_t* ptr, const VecNx& a, const VecNx& b, const VecNx& c, const VecNx& d) {
+    VecNx w0, w1, w2, w3;
+    transpose(a.vec_, b.vec_, c.vec_, d.vec_, &w0, &w1, &w2, &w3);
+    _mm256_storeu_si256((__m256i*)(ptr + 0), _mm256_permute2x128_si256(w0.vec_, w1.vec_, 0x20));
+    _mm256_storeu_si256((__m256i*)(ptr + 8), _mm256_permute2x128_si256(w2.vec_, w3.vec_, 0x20));
+    _mm256_storeu_si256((__m256i*)(ptr + 16), _mm256_permute2x128_si256(w0.vec_, w1.vec_, 0x31));
+    _mm256_storeu_si256((__m256i*)(ptr + 24), _mm256_permute2x128_si256(w2.vec_, w3.vec_, 0x31));
+  }
+
+  void split(Vec4i* lo, Vec4i* hi) const {
+    *lo = _mm256_castsi256_si128(vec_);
+    *hi = _mm256_extracti128_si256(vec_, 1);
+  }
+
+  bool allTrue() const { return _mm256_movemask_epi8(vec_) == -1; }
+  bool anyTrue() const { return _mm256_movemask_epi8(vec_) != 0; }
+
+  static VecNx min(const VecNx& l, const VecNx& r) {
+    return _mm256_min_epi32(l.vec_, r.vec_);
+  }
+  static VecNx max(const VecNx& l, const VecNx& r) {
+    return _mm256_max_epi32(l.vec_, r.vec_);
+  }
+
+  static VecNx ternary(const VecNx& c, const VecNx& t, const VecNx& e) {
+    return _mm256_blendv_epi8(e.vec_, t.vec_, c.vec_);
+  }
+
+  static VecNx mulHi(const VecNx& l, const VecNx& r) {
+    // High halves of even products are shifted down into place,
+    // the ones of odd products are already there.
+    __m256i mul_even = _mm256_mul_epi32(l.vec_, r.vec_),
+            mul_odd = _mm256_mul_epi32(_mm256_srli_epi64(l.vec_, 32), _mm256_srli_epi64(r.vec_, 32));
+    return _mm256_blend_epi32(_mm256_srli_epi64(mul_even, 32), mul_odd, 0xAA);
+  }
+
+  VecNx operator&(const VecNx& o) const { return _mm256_and_si256(vec_, o.vec_); }
+  VecNx operator|(const VecNx& o) const { return _mm256_or_si256(vec_, o.vec_); }
+  VecNx operator^(const VecNx& o) const { return _mm256_xor_si256(vec_, o.vec_); }
+
+  VecNx operator<<(int amount) const { return _mm256_slli_epi32(vec_, amount); }
+  VecNx operator>>(int amount) const { return _mm256_srai_epi32(vec_, amount); }
+
+  VecNx operator+(const VecNx& o) const { return _mm256_add_epi32(vec_, o.vec_); }
+  VecNx operator-(const VecNx& o) const { return _mm256_sub_epi32(vec_, o.vec_); }
+  VecNx operator*(const VecNx& o) const { return _mm256_mullo_epi32(vec_, o.vec_); }
+
+  VecNx operator==(const VecNx& o) const { return _mm256_cmpeq_epi32(vec_, o.vec_); }
+  VecNx operator <(const VecNx& o) const { return _mm256_cmpgt_epi32(o.vec_, vec_); }
+  VecNx operator >(const VecNx& o) const { return _mm256_cmpgt_epi32(vec_, o.vec_); }
+
+  int32_t operator[](int k) const {
+    ASSERT(0 <= k && k < Size);
+    union { __m256i v; int32_t is[8]; } pun = {vec_};
+    return pun.is[k];
+  }
+
+  __m256i vec_;
+
+ private:
+  static __m256i laneMask(int count) {
+    ASSERT(0 <= count && count <= Size);
+    return _mm256_cmpgt_epi32(_mm256_set1_epi32(count), _mm256_setr_epi32(0,1,2,3,4,5,6,7));
+  }
+
+  // Transposes 4x4 blocks in each 128-bit lane independently.
+  static void transpose(
+      __m256i v0, __m256i v1, __m256i v2, __m256i v3,
+      VecNx* a, VecNx* b, VecNx* c, VecNx* d) {
+    __m256i t0 = _mm256_unpacklo_epi32(v0, v1),
+            t1 = _mm256_unpackhi_epi32(v0, v1),
+            t2 = _mm256_unpacklo_epi32(v2, v3),
+            t3 = _mm256_unpackhi_epi32(v2, v3);
+    *a = _mm256_unpacklo_epi64(t0, t2);
+    *b = _mm256_unpackhi_epi64(t0, t2);
+    *c = _mm256_unpacklo_epi64(t1, t3);
+    *d = _mm256_unpackhi_epi64(t1, t3);
+  }
+};
+
+inline Vec8f Vec8f::gather(const float* base, const Vec8i& indices) {
+  return _mm256_i32gather_ps(base, indices.vec_, 4);
+}
+
+template<>
+struct VecNx<16, uint16_t> {
+  static constexpr int Size = 16;
+
+  VecNx(const __m256i& vec) : vec_(vec) {}
+
+  VecNx() = default;
+  VecNx(uint16_t val) : vec_(_mm256_set1_epi16(val)) {}
+  VecNx(uint16_t a, uint16_t b, uint16_t c, uint16_t d,
+        uint16_t e, uint16_t f, uint16_t g, uint16_t h,
+        uint16_t i, uint16_t j, uint16_t k, uint16_t l,
+        uint16_t m, uint16_t n, uint16_t o, uint16_t p)
+      : vec_(_mm256_setr_epi16(a,b,c,d, e,f,g,h, i,j,k,l, m,n,o,p)) {}
+  VecNx(const Vec8h& lo, const Vec8h& hi)
+      : vec_(_mm256_inserti128_si256(_mm256_castsi128_si256(lo.vec_), hi.vec_, 1)) {}
+
+  static VecNx load(const uint16_t* ptr) {
+    return _mm256_loadu_si256((const __m256i*)ptr);
+  }
+  void store(uint16_t* ptr) const { _mm256_storeu_si256((__m256i*)ptr, vec_); }
+
+  // AVX2 masks only 32-bit and 64-bit lanes.
+  static VecNx loadMasked(const uint16_t* ptr, int count) {
+    return vnxLoadMasked<VecNx>(ptr, count);
+  }
+  void storeMasked(uint16_t* ptr, int count) const {
+    vnxStoreMasked(*this, ptr, count);
+  }
+
+  void split(Vec8h* lo, Vec8h* hi) const {
+    *lo = _mm256_castsi256_si128(vec_);
+    *hi = _mm256_extracti128_si256(vec_, 1);
+  }
+
+  bool allTrue() const { return _mm256_movemask_epi8(vec_) == -1; }
+  bool anyTrue() const { return _mm256_movemask_epi8(vec_) != 0; }
+
+  static VecNx min(const VecNx& l, const VecNx& r) {
+    return _mm256_min_epu16(l.vec_, r.vec_);
+  }
+  static VecNx max(const VecNx& l, const VecNx& r) {
+    return _mm256_max_epu16(l.vec_, r.vec_);
+  }
+
+  static VecNx saturatedAdd(const VecNx& l, const VecNx& r) {
+    return _mm256_adds_epu16(l.vec_, r.vec_);
+  }
+
+  static VecNx ternary(const VecNx& c, const VecNx& t, const VecNx& e) {
+    return _mm256_blendv_epi8(e.vec_, t.vec_, c.vec_);
+  }
+
+  VecNx operator+(const VecNx& o) const { return _mm256_add_epi16(vec_, o.vec_); }
+  VecNx operator-(const VecNx& o) const { return _mm256_sub_epi16(vec_, o.vec_); }
+  VecNx operator*(const VecNx& o) const { return _mm256_mullo_epi16(vec_, o.vec_); }
+
+  VecNx operator<<(int amount) const { return _mm256_slli_epi16(vec_, amount); }
+  VecNx operator>>(int amount) const { return _mm256_srli_epi16(vec_, amount); }
+
+  VecNx operator==(const VecNx& o) const { return _mm256_cmpeq_epi16(vec_, o.vec_); }
+
+  uint16_t operator[](int k) const {
+    ASSERT(0 <= k && k < Size);
+    union { __m256i v; uint16_t us[16]; } pun = {vec_};
+    return pun.us[k];
+  }
+
+  __m256i vec_;
+};
+
+template<>
+struct VecNx<32, uint8_t> {
+  static constexpr int Size = 32;
+
+  VecNx(const __m256i& vec) : vec_(vec) {}
+
+  VecNx() = default;
+  VecNx(uint8_t val) : vec_(_mm256_set1_epi8(val)) {}
+  VecNx(const Vec16b& lo, const Vec16b& hi)
+      : vec_(_mm256_inserti128_si256(_mm256_castsi128_si256(lo.vec_), hi.vec_, 1)) {}
+
+  static VecNx load(const uint8_t* ptr) {
+    return _mm256_loadu_si256((const __m256i*)ptr);
+  }
+  void store(uint8_t* ptr) const { _mm256_storeu_si256((__m256i*)ptr, vec_); }
+
+  static VecNx loadMasked(const uint8_t* ptr, int count) {
+    return vnxLoadMasked<VecNx>(ptr, count);
+  }
+  void storeMasked(uint8_t* ptr, int count) const {
+    vnxStoreMasked(*this, ptr, count);
+  }
+
+  void split(Vec16b* lo, Vec16b* hi) const {
+    *lo = _mm256_castsi256_si128(vec_);
+    *hi = _mm256_extracti128_si256(vec_, 1);
+  }
+
+  bool allTrue() const { return _mm256_movemask_epi8(vec_) == -1; }
+  bool anyTrue() const { return _mm256_movemask_epi8(vec_) != 0; }
+
+  static VecNx min(const VecNx& l, const VecNx& r) {
+    return _mm256_min_epu8(l.vec_, r.vec_);
+  }
+  static VecNx max(const VecNx& l, const VecNx& r) {
+    return _mm256_max_epu8(l.vec_, r.vec_);
+  }
+
+  static VecNx saturatedAdd(const VecNx& l, const VecNx& r) {
+    return _mm256_adds_epu8(l.vec_, r.vec_);
+  }
+
+  static VecNx ternary(const VecNx& c, const VecNx& t, const VecNx& e) {
+    return _mm256_blendv_epi8(e.vec_, t.vec_, c.vec_);
+  }
+
+  VecNx operator+(const VecNx& o) const { return _mm256_add_epi8(vec_, o.vec_); }
+  VecNx operator-(const VecNx& o) const { return _mm256_sub_epi8(vec_, o.vec_); }
+
+  VecNx operator==(const VecNx& o) const { return _mm256_cmpeq_epi8(vec_, o.vec_); }
+  VecNx operator<(const VecNx& o) const {
+    // Flip the sign bits to compare unsigned with signed compare, see Vec16b.
+    auto flip = _mm256_set1_epi8(static_cast<char>(static_cast<uint8_t>(0x80)));
+    return _mm256_cmpgt_epi8(_mm256_xor_si256(flip, o.vec_),
+                             _mm256_xor_si256(flip, vec_));
+  }
+
+  uint8_t operator[](int k) const {
+    ASSERT(0 <= k && k < Size);
+    union { __m256i v; uint8_t us[32]; } pun = {vec_};
+    return pun.us[k];
+  }
+
+  __m256i vec_;
+};
+
+template<>
+inline Vec8f vnxCast<float, int32_t>(const Vec8i& src) {
+  return _mm256_cvtepi32_ps(src.vec_);
+}
+
+template<>
+inline Vec8i vnxCast<int32_t, float, 8>(const Vec8f& src) {
+  return _mm256_cvttps_epi32(src.vec_);
+}
+
+// With AVX-512 Vec16f is specialized too, VnxAvx512.h provides a variant for it.
+#if !CPU_SIMD(AVX512)
+template<>
+inline Vec16b vnxCast<uint8_t, float>(const Vec16f& src) {
+  Vec8f lo, hi;
+  VnxMath::split(src, &lo, &hi);
+
+  // Packing works within 128-bit lanes, reorder 64-bit quarters before
+  // the final pack.
+  __m256i _16 = _mm256_packus_epi32(_mm256_cvttps_epi32(lo.vec_),
+                                    _mm256_cvttps_epi32(hi.vec_));
+  _16 = _mm256_permute4x64_epi64(_16, _MM_SHUFFLE(3,1,2,0));
+  return _mm_packus_epi16(_mm256_castsi256_si128(_16),
+                          _mm256_extracti128_si256(_16, 1));
+}
+#endif // !CPU_SIMD(AVX512)
+
+} // inline namespace STP_VNX_NAMESPACE
+} // namespace stp
+
+#endif // STP_BASE_SIMD_VNXAVX_H_
@@ -0,0 +1,375 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#ifndef STP_BASE_SIMD_VNXAVX512_H_
+#define STP_BASE_SIMD_VNXAVX512_H_
+
+// This file may assume AVX-512 F, CD, BW, DQ and VL; it is included after
+// VnxAvx.h only. 512-bit vectors split into (and join from) pairs of 256-bit
+// ones from VnxAvx.h.
+//
+// AVX-512 compares produce bit masks, while VecNx represents conditions as
+// vectors with all bits set in true lanes. Conversions between these are
+// single instructions (VPMOVM2* and VPMOV*2M).
+
+#include "Base/Debug/Assert.h"
+
+#include <immintrin.h>
+
+namespace stp {
+inline namespace STP_VNX_NAMESPACE {
+
+template<>
+struct VecNx<16, float> {
+  static constexpr int Size = 16;
+
+  VecNx(const __m512& vec) : vec_(vec) {}
+
+  VecNx() = default;
+  VecNx(float val) : vec_(_mm512_set1_ps(val)) {}
+  VecNx(float a, float b, float c, float d, float e, float f, float g, float h,
+        float i, float j, float k, float l, float m, float n, float o, float p)
+      : vec_(_mm512_setr_ps(a,b,c,d, e,f,g,h, i,j,k,l, m,n,o,p)) {}
+  VecNx(const Vec8f& lo, const Vec8f& hi)
+      : vec_(_mm512_insertf32x8(_mm512_castps256_ps512(lo.vec_), hi.vec_, 1)) {}
+
+  static VecNx load(const float* ptr) { return _mm512_loadu_ps(ptr); }
+  void store(float* ptr) const { _mm512_storeu_ps(ptr, vec_); }
+
+  static VecNx loadMasked(const float* ptr, int count) {
+    return _mm512_maskz_loadu_ps(laneMask(count), ptr);
+  }
+  void storeMasked(float* ptr, int count) const {
+    _mm512_mask_storeu_ps(ptr, laneMask(count), vec_);
+  }
+
+  static VecNx gather(const float* base, const VecNx<16, int32_t>& indices);
+
+  void split(Vec8f* lo, Vec8f* hi) const {
+    *lo = _mm512_castps512_ps256(vec_);
+    *hi = _mm512_extractf32x8_ps(vec_, 1);
+  }
+
+  bool allTrue() const { return toMask() == 0xFFFF; }
+  bool anyTrue() const { return toMask() != 0; }
+
+  VecNx mathAbs() const { return _mm512_abs_ps(vec_); }
+  VecNx mathSqrt() const { return _mm512_sqrt_ps(vec_); }
+  VecNx mathRsqrt() const { return _mm512_rsqrt14_ps(vec_); }
+  VecNx reciprocal() const { return _mm512_rcp14_ps(vec_); }
+  VecNx mathFloor() const { return _mm512_roundscale_ps(vec_, _MM_FROUND_TO_NEG_INF); }
+
+  static VecNx min(const VecNx& l, const VecNx& r) {
+    return _mm512_min_ps(l.vec_, r.vec_);
+  }
+  static VecNx max(const VecNx& l, const VecNx& r) {
+    return _mm512_max_ps(l.vec_, r.vec_);
+  }
+
+  static VecNx ternary(const VecNx& c, const VecNx& t, const VecNx& e) {
+    return _mm512_mask_blend_ps(c.toMask(), e.vec_, t.vec_);
+  }
+
+  VecNx operator+(const VecNx& o) const { return _mm512_add_ps(vec_, o.vec_); }
+  VecNx operator-(const VecNx& o) const { return _mm512_sub_ps(vec_, o.vec_); }
+  VecNx operator*(const VecNx& o) const { return _mm512_mul_ps(vec_, o.vec_); }
+  VecNx operator/(const VecNx& o) const { return _mm512_div_ps(vec_, o.vec_); }
+
+  VecNx operator==(const VecNx& o) const { return fromMask(_mm512_cmp_ps_mask(vec_, o.vec_, _CMP_EQ_OQ)); }
+  VecNx operator!=(const VecNx& o) const { return fromMask(_mm512_cmp_ps_mask(vec_, o.vec_, _CMP_NEQ_UQ)); }
+  VecNx operator<(const VecNx& o) const { return fromMask(_mm512_cmp_ps_mask(vec_, o.vec_, _CMP_LT_OQ)); }
+  VecNx operator>(const VecNx& o) const { return fromMask(_mm512_cmp_ps_mask(vec_, o.vec_, _CMP_GT_OQ)); }
+  VecNx operator<=(const VecNx& o) const { return fromMask(_mm512_cmp_ps_mask(vec_, o.vec_, _CMP_LE_OQ)); }
+  VecNx operator>=(const VecNx& o) const { return fromMask(_mm512_cmp_ps_mask(vec_, o.vec_, _CMP_GE_OQ)); }
+
+  VecNx operator&(const VecNx& o) const { return _mm512_and_ps(vec_, o.vec_); }
+  VecNx operator|(const VecNx& o) const { return _mm512_or_ps(vec_, o.vec_); }
+  VecNx operator^(const VecNx& o) const { return _mm512_xor_ps(vec_, o.vec_); }
+
+  float operator[](int k) const {
+    ASSERT(0 <= k && k < Size);
+    union { __m512 v; float fs[16]; } pun = {vec_};
+    return pun.fs[k];
+  }
+
+  __m512 vec_;
+
+ private:
+  static __mmask16 laneMask(int count) {
+    ASSERT(0 <= count && count <= Size);
+    return static_cast<__mmask16>((1u << count) - 1);
+  }
+
+  __mmask16 toMask() const { return _mm512_movepi32_mask(_mm512_castps_si512(vec_)); }
+  static VecNx fromMask(__mmask16 mask) { return _mm512_castsi512_ps(_mm512_movm_epi32(mask)); }
+};
+
+template<>
+struct VecNx<16, int32_t> {
+  static constexpr int Size = 16;
+
+  VecNx(const __m512i& vec) : vec_(vec) {}
+
+  VecNx() = default;
+  VecNx(int32_t val) : vec_(_mm512_set1_epi32(val)) {}
+  VecNx(int32_t a, int32_t b, int32_t c, int32_t d, int32_t e, int32_t f, int32_t g, int32_t h,
+        int32_t i, int32_t j, int32_t k, int32_t l, int32_t m, int32_t n, int32_t o, int32_t p)
+      : vec_(_mm512_setr_epi32(a,b,c,d, e,f,g,h, i,j,k,l, m,n,o,p)) {}
+  VecNx(const Vec8i& lo, const Vec8i& hi)
+      : vec_(_mm512_inserti64x4(_mm512_castsi256_si512(lo.vec_), hi.vec_, 1)) {}
+
+  static VecNx load(const int32_t* ptr) { return _mm512_loadu_si512(ptr); }
+  void store(int32_t* ptr) const { _mm512_storeu_si512(ptr, vec_); }
+
+  static VecNx loadMasked(const int32_t* ptr, int count) {
+    return _mm512_maskz_loadu_epi32(laneMask(count), ptr);
+  }
+  void storeMasked(int32_t* ptr, int count) const {
+    _mm512_mask_storeu_epi32(ptr, laneMask(count), vec_);
+  }
+
+  static VecNx gather(const int32_t* base, const VecNx& indices) {
+    return _mm512_i32gather_epi32(indices.vec_, base, 4);
+  }
+
+  static void load4(const int32_t* ptr, VecNx* a, VecNx* b, VecNx* c, VecNx* d) {
+    Vec8i a0, b0, c0, d0, a1, b1, c1, d1;
+    Vec8i::load4(ptr, &a0, &b0, &c0, &d0);
+    Vec8i::load4(ptr + 32, &a1, &b1, &c1, &d1);
+    *a = VecNx(a0, a1);
+    *b = VecNx(b0, b1);
+    *c = VecNx(c0, c1);
+    *d = VecNx(d0, d1);
+  }
+  static void store4(int32_t* ptr, const VecNx& a, const VecNx& b, const VecNx& c, const VecNx& d) {
+    Vec8i a0, b0, c0, d0, a1, b1, c1, d1;
+    a.split(&a0, &a1);
+    b.split(&b0, &b1);
+    c.split(&c0, &c1);
+    d.split(&d0, &d1);
+    Vec8i::store4(ptr, a0, b0, c0, d0);
+    Vec8i::store4(ptr + 32, a1, b1, c1, d1);
+  }
+
+  void split(Vec8i* lo, Vec8i* hi) const {
+    *lo = _mm512_castsi512_si256(vec_);
+    *hi = _mm512_extracti64x4_epi64(vec_, 1);
+  }
+
+  bool allTrue() const { return toMask() == 0xFFFF; }
+  bool anyTrue() const { return toMask() != 0; }
+
+  static VecNx min(const VecNx& l, const VecNx& r) {
+    return _mm512_min_epi32(l.vec_, r.vec_);
+  }
+  static VecNx max(const VecNx& l, const VecNx& r) {
+    return _mm512_max_epi32(l.vec_, r.vec_);
+  }
+
+  static VecNx ternary(const VecNx& c, const VecNx& t, const VecNx& e) {
+    return _mm512_mask_blend_epi32(c.toMask(), e.vec_, t.vec_);
+  }
+
+  static VecNx mulHi(const VecNx& l, const VecNx& r) {
+    // Same as Vec8i::mulHi().
+    __m512i mul_even = _mm512_mul_epi32(l.vec_, r.vec_),
+            mul_odd = _mm512_mul_epi32(_mm512_srli_epi64(l.vec_, 32), _mm512_srli_epi64(r.vec_, 32));
+    return _mm512_mask_blend_epi32(0xAAAA, _mm512_srli_epi64(mul_even, 32), mul_odd);
+  }
+
+  VecNx operator&(const VecNx& o) const { return _mm512_and_si512(vec_, o.vec_); }
+  VecNx operator|(const VecNx& o) const { return _mm512_or_si512(vec_, o.vec_); }
+  VecNx operator^(const VecNx& o) const { return _mm512_xor_si512(vec_, o.vec_); }
+
+  VecNx operator<<(int amount) const { return _mm512_slli_epi32(vec_, amount); }
+  VecNx operator>>(int amount) const { return _mm512_srai_epi32(vec_, amount); }
+
+  VecNx operator+(const VecNx& o) const { return _mm512_add_epi32(vec_, o.vec_); }
+  VecNx operator-(const VecNx& o) const { return _mm512_sub_epi32(vec_, o.vec_); }
+  VecNx operator*(const VecNx& o) const { return _mm512_mullo_epi32(vec_, o.vec_); }
+
+  VecNx operator==(const VecNx& o) const { return fromMask(_mm512_cmpeq_epi32_mask(vec_, o.vec_)); }
+  VecNx operator <(const VecNx& o) const { return fromMask(_mm512_cmplt_epi32_mask(vec_, o.vec_)); }
+  VecNx operator >(const VecNx& o) const { return fromMask(_mm512_cmpgt_epi32_mask(vec_, o.vec_)); }
+
+  int32_t operator[](int k) const {
+    ASSERT(0 <= k && k < Size);
+    union { __m512i v; int32_t is[16]; } pun = {vec_};
+    return pun.is[k];
+  }
+
+  __m512i vec_;
+
+ private:
+  static __mmask16 laneMask(int count) {
+    ASSERT(0 <= count && count <= Size);
+    return static_cast<__mmask16>((1u << count) - 1);
+  }
+
+  __mmask16 toMask() const { return _mm512_movepi32_mask(vec_); }
+  static VecNx fromMask(__mmask16 mask) { return _mm512_movm_epi32(mask); }
+};
+
+inline Vec16f Vec16f::gather(const float* base, const Vec16i& indices) {
+  return _mm512_i32gather_ps(indices.vec_, base, 4);
+}
+
+template<>
+struct VecNx<32, uint16_t> {
+  static constexpr int Size = 32;
+
+  VecNx(const __m512i& vec) : vec_(vec) {}
+
+  VecNx() = default;
+  VecNx(uint16_t val) : vec_(_mm512_set1_epi16(val)) {}
+  VecNx(const Vec16h& lo, const Vec16h& hi)
+      : vec_(_mm512_inserti64x4(_mm512_castsi256_si512(lo.vec_), hi.vec_, 1)) {}
+
+  static VecNx load(const uint16_t* ptr) { return _mm512_loadu_si512(ptr); }
+  void store(uint16_t* ptr) const { _mm512_storeu_si512(ptr, vec_); }
+
+  static VecNx loadMasked(const uint16_t* ptr, int count) {
+    return _mm512_maskz_loadu_epi16(laneMask(count), ptr);
+  }
+  void storeMasked(uint16_t* ptr, int count) const {
+    _mm512_mask_storeu_epi16(ptr, laneMask(count), vec_);
+  }
+
+  void split(Vec16h* lo, Vec16h* hi) const {
+    *lo = _mm512_castsi512_si256(vec_);
+    *hi = _mm512_extracti64x4_epi64(vec_, 1);
+  }
+
+  bool allTrue() const { return toMask() == 0xFFFFFFFFu; }
+  bool anyTrue() const { return toMask() != 0; }
+
+  static VecNx min(const VecNx& l, const VecNx& r) {
+    return _mm512_min_epu16(l.vec_, r.vec_);
+  }
+  static VecNx max(const VecNx& l, const VecNx& r) {
+    return _mm512_max_epu16(l.vec_, r.vec_);
+  }
+
+  static VecNx saturatedAdd(const VecNx& l, const VecNx& r) {
+    return _mm512_adds_epu16(l.vec_, r.vec_);
+  }
+
+  static VecNx ternary(const VecNx& c, const VecNx& t, const VecNx& e) {
+    return _mm512_mask_blend_epi16(c.toMask(), e.vec_, t.vec_);
+  }
+
+  VecNx operator+(const VecNx& o) const { return _mm512_add_epi16(vec_, o.vec_); }
+  VecNx operator-(const VecNx& o) const { return _mm512_sub_epi16(vec_, o.vec_); }
+  VecNx operator*(const VecNx& o) const { return _mm512_mullo_epi16(vec_, o.vec_); }
+
+  VecNx operator<<(int amount) const { return _mm512_slli_epi16(vec_, amount); }
+  VecNx operator>>(int amount) const { return _mm512_srli_epi16(vec_, amount); }
+
+  VecNx operator==(const VecNx& o) const { return fromMask(_mm512_cmpeq_epi16_mask(vec_, o.vec_)); }
+
+  uint16_t operator[](int k) const {
+    ASSERT(0 <= k && k < Size);
+    union { __m512i v; uint16_t us[32]; } pun = {vec_};
+    return pun.us[k];
+  }
+
+  __m512i vec_;
+
+ private:
+  static __mmask32 laneMask(int count) {
+    ASSERT(0 <= count && count <= Size);
+    return count == Size ? ~0u : (1u << count) - 1;
+  }
+
+  __mmask32 toMask() const { return _mm512_movepi16_mask(vec_); }
+  static VecNx fromMask(__mmask32 mask) { return _mm512_movm_epi16(mask); }
+};
+
+template<>
+struct VecNx<64, uint8_t> {
+  static constexpr int Size = 64;
+
+  VecNx(const __m512i& vec) : vec_(vec) {}
+
+  VecNx() = default;
+  VecNx(uint8_t val) : vec_(_mm512_set1_epi8(val)) {}
+  VecNx(const Vec32b& lo, const Vec32b& hi)
+      : vec_(_mm512_inserti64x4(_mm512_castsi256_si512(lo.vec_), hi.vec_, 1)) {}
+
+  static VecNx load(const uint8_t* ptr) { return _mm512_loadu_si512(ptr); }
+  void store(uint8_t* ptr) const { _mm512_storeu_si512(ptr, vec_); }
+
+  static VecNx loadMasked(const uint8_t* ptr, int count) {
+    return _mm512_maskz_loadu_epi8(laneMask(count), ptr);
+  }
+  void storeMasked(uint8_t* ptr, int count) const {
+    _mm512_mask_storeu_epi8(ptr, laneMask(count), vec_);
+  }
+
+  void split(Vec32b* lo, Vec32b* hi) const {
+    *lo = _mm512_castsi512_si256(vec_);
+    *hi = _mm512_extracti64x4_epi64(vec_, 1);
+  }
+
+  bool allTrue() const { return toMask() == ~0ull; }
+  bool anyTrue() const { return toMask() != 0; }
+
+  static VecNx min(const VecNx& l, const VecNx& r) {
+    return _mm512_min_epu8(l.vec_, r.vec_);
+  }
+  static VecNx max(const VecNx& l, const VecNx& r) {
+    return _mm512_max_epu8(l.vec_, r.vec_);
+  }
+
+  static VecNx saturatedAdd(const VecNx& l, const VecNx& r) {
+    return _mm512_adds_epu8(l.vec_, r.vec_);
+  }
+
+  static VecNx ternary(const VecNx& c, const VecNx& t, const VecNx& e) {
+    return _mm512_mask_blend_epi8(c.toMask(), e.vec_, t.vec_);
+  }
+
+  VecNx operator+(const VecNx& o) const { return _mm512_add_epi8(vec_, o.vec_); }
+  VecNx operator-(const VecNx& o) const { return _mm512_sub_epi8(vec_, o.vec_); }
+
+  VecNx operator==(const VecNx& o) const { return fromMask(_mm512_cmpeq_epi8_mask(vec_, o.vec_)); }
+  VecNx operator<(const VecNx& o) const { return fromMask(_mm512_cmplt_epu8_mask(vec_, o.vec_)); }
+
+  uint8_t operator[](int k) const {
+    ASSERT(0 <= k && k < Size);
+    union { __m512i v; uint8_t us[64]; } pun = {vec_};
+    return pun.us[k];
+  }
+
+  __m512i vec_;
+
+ private:
+  static __mmask64 laneMask(int count) {
+    ASSERT(0 <= count && count <= Size);
+    return count == Size ? ~0ull : (1ull << count) - 1;
+  }
+
+  __mmask64 toMask() const { return _mm512_movepi8_mask(vec_); }
+  static VecNx fromMask(__mmask64 mask) { return _mm512_movm_epi8(mask); }
+};
+
+template<>
+inline Vec16f vnxCast<float, int32_t>(const Vec16i& src) {
+  return _mm512_cvtepi32_ps(src.vec_);
+}
+
+template<>
+inline Vec16i vnxCast<int32_t, float, 16>(const Vec16f& src) {
+  return _mm512_cvttps_epi32(src.vec_);
+}
+
+template<>
+inline Vec16b vnxCast<uint8_t, float>(const Vec16f& src) {
+  __m512i _32 = _mm512_max_epi32(_mm512_cvttps_epi32(src.vec_), _mm512_setzero_si512());
+  return _mm512_cvtusepi32_epi8(_32);
+}
+
+} // inline namespace STP_VNX_NAMESPACE
+} // namespace stp
+
+#endif // STP_BASE_SIMD_VNXAVX512_H_
@@ -13,6 +13,7 @@
 #include <arm_neon.h>
 
 namespace stp {
+inline namespace STP_VNX_NAMESPACE {
 
 #if !CPU(ARM64)
 // ARMv8 has vrndmq_f32 to floor 4 floats.  Here we emulate it:
@@ -100,6 +101,13 @@ struct VecNx<2, float> {
   VecNx operator>=(const VecNx& o) const { return vreinterpret_f32_u32(vcge_f32(vec_, o.vec_)); }
   VecNx operator!=(const VecNx& o) const { return vreinterpret_f32_u32(vmvn_u32(vceq_f32(vec_, o.vec_))); }
 
+  VecNx operator&(const VecNx& o) const {
+    return vreinterpret_f32_u32(vand_u32(vreinterpret_u32_f32(vec_), vreinterpret_u32_f32(o.vec_)));
+  }
+  VecNx operator|(const VecNx& o) const {
+    return vreinterpret_f32_u32(vorr_u32(vreinterpret_u32_f32(vec_), vreinterpret_u32_f32(o.vec_)));
+  }
+
   float operator[](int k) const {
     ASSERT(0 <= k && k < Size);
     union { float32x2_t v; float fs[2]; } pun = {vec_};
@@ -122,6 +130,16 @@ struct VecNx<4, float> {
   static VecNx load(const float* ptr) { return vld1q_f32(ptr); }
   void store(float* ptr) const { vst1q_f32(ptr, vec_); }
 
+  // NEON has neither masked loads nor gathers.
+  static VecNx loadMasked(const float* ptr, int count) {
+    return vnxLoadMasked<VecNx>(ptr, count);
+  }
+  void storeMasked(float* ptr, int count) const {
+    vnxStoreMasked(*this, ptr, count);
+  }
+
+  static VecNx gather(const float* base, const VecNx<4, int32_t>& indices);
+
   bool allTrue() const {
     auto v = vreinterpretq_u32_f32(vec_);
     return vgetq_lane_u32(v,0) && vgetq_lane_u32(v,1) && vgetq_lane_u32(v,2) && vgetq_lane_u32(v,3);
@@ -196,6 +214,13 @@ struct VecNx<4, float> {
   VecNx operator>=(const VecNx& o) const { return vreinterpretq_f32_u32(vcgeq_f32(vec_, o.vec_)); }
   VecNx operator!=(const VecNx& o) const { return vreinterpretq_f32_u32(vmvnq_u32(vceqq_f32(vec_, o.vec_))); }
 
+  VecNx operator&(const VecNx& o) const {
+    return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(vec_), vreinterpretq_u32_f32(o.vec_)));
+  }
+  VecNx operator|(const VecNx& o) const {
+    return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(vec_), vreinterpretq_u32_f32(o.vec_)));
+  }
+
   float operator[](int k) const {
     ASSERT(0 <= k && k < Size);
     union { float32x4_t v; float fs[4]; } pun = {vec_};
@@ -220,9 +245,41 @@ struct VecNx<4, int32_t> {
   static VecNx load(const int32_t* ptr) { return vld1q_s32(ptr); }
   void store(int32_t* ptr) const { vst1q_s32(ptr, vec_); }
 
+  static VecNx loadMasked(const int32_t* ptr, int count) {
+    return vnxLoadMasked<VecNx>(ptr, count);
+  }
+  void storeMasked(int32_t* ptr, int count) const {
+    vnxStoreMasked(*this, ptr, count);
+  }
+
+  static VecNx gather(const int32_t* base, const VecNx& indices) {
+    return VecNx(base[indices[0]], base[indices[1]], base[indices[2]], base[indices[3]]);
+  }
+
+  static void load4(const int32_t* ptr, VecNx* a, VecNx* b, VecNx* c, VecNx* d) {
+    int32x4x4_t v = vld4q_s32(ptr);
+    *a = v.val[0];
+    *b = v.val[1];
+    *c = v.val[2];
+    *d = v.val[3];
+  }
+  static void store4(int32_t* ptr, const VecNx& a, const VecNx& b, const VecNx& c, const VecNx& d) {
+    int32x4x4_t v = {{ a.vec_, b.vec_, c.vec_, d.vec_ }};
+    vst4q_s32(ptr, v);
+  }
+
   static VecNx min(const VecNx& l, const VecNx& r) {
     return vminq_s32(l.vec_, r.vec_);
   }
+  static VecNx max(const VecNx& l, const VecNx& r) {
+    return vmaxq_s32(l.vec_, r.vec_);
+  }
+
+  static VecNx mulHi(const VecNx& l, const VecNx& r) {
+    int64x2_t lo = vmull_s32(vget_low_s32(l.vec_), vget_low_s32(r.vec_)),
+              hi = vmull_s32(vget_high_s32(l.vec_), vget_high_s32(r.vec_));
+    return vcombine_s32(vshrn_n_s64(lo, 32), vshrn_n_s64(hi, 32));
+  }
 
   static VecNx ternary(const VecNx& c, const VecNx& t, const VecNx& e) {
     return vbslq_f32(vreinterpretq_u32_s32(c.vec_), t.vec_, e.vec_);
@@ -258,6 +315,10 @@ struct VecNx<4, int32_t> {
   int32x4_t vec_;
 };
 
+inline Vec4f Vec4f::gather(const float* base, const Vec4i& indices) {
+  return Vec4f(base[indices[0]], base[indices[1]], base[indices[2]], base[indices[3]]);
+}
+
 template<>
 struct VecNx<4, uint32_t> {
   static constexpr int Size = 4;
@@ -360,9 +421,22 @@ struct VecNx<8, uint16_t> {
   static VecNx load(const uint16_t* ptr) { return vld1q_u16(ptr); }
   void store(uint16_t* ptr) const { vst1q_u16(ptr, vec_); }
 
+  static VecNx loadMasked(const uint16_t* ptr, int count) {
+    return vnxLoadMasked<VecNx>(ptr, count);
+  }
+  void storeMasked(uint16_t* ptr, int count) const {
+    vnxStoreMasked(*this, ptr, count);
+  }
+
   static VecNx min(const VecNx& l, const VecNx& r) {
     return vminq_u16(l.vec_, r.vec_);
   }
+  static VecNx max(const VecNx& l, const VecNx& r) {
+    return vmaxq_u16(l.vec_, r.vec_);
+  }
+  static VecNx saturatedAdd(const VecNx& l, const VecNx& r) {
+    return vqaddq_u16(l.vec_, r.vec_);
+  }
   static VecNx ternary(const VecNx& c, const VecNx& t, const VecNx& e) {
     return vbslq_u16(c.vec_, t.vec_, e.vec_);
   }
@@ -374,6 +448,8 @@ struct VecNx<8, uint16_t> {
   VecNx operator<<(int amount) const { return vec_ << VecNx(amount).vec_; }
   VecNx operator>>(int amount) const { return vec_ >> VecNx(amount).vec_; }
 
+  VecNx operator==(const VecNx& o) const { return vceqq_u16(vec_, o.vec_); }
+
   uint16_t operator[](int k) const {
     ASSERT(0 <= k && k < Size);
     union { uint16x8_t v; uint16_t us[8]; } pun = {vec_};
@@ -432,9 +508,19 @@ struct VecNx<16, uint8_t> {
   static VecNx load(const uint8_t* ptr) { return vld1q_u8(ptr); }
   void store(uint8_t* ptr) const { vst1q_u8(ptr, vec_); }
 
+  static VecNx loadMasked(const uint8_t* ptr, int count) {
+    return vnxLoadMasked<VecNx>(ptr, count);
+  }
+  void storeMasked(uint8_t* ptr, int count) const {
+    vnxStoreMasked(*this, ptr, count);
+  }
+
   static VecNx min(const VecNx& l, const VecNx& r) {
     return vminq_u8(l.vec_, r.vec_);
   }
+  static VecNx max(const VecNx& l, const VecNx& r) {
+    return vmaxq_u8(l.vec_, r.vec_);
+  }
 
   static VecNx saturatedAdd(const VecNx& l, const VecNx& r) {
     return vqaddq_u8(l.vec_, r.vec_);
@@ -447,6 +533,7 @@ struct VecNx<16, uint8_t> {
   VecNx operator+(const VecNx& o) const { return vaddq_u8(vec_, o.vec_); }
   VecNx operator-(const VecNx& o) const { return vsubq_u8(vec_, o.vec_); }
 
+  VecNx operator==(const VecNx& o) const { return vceqq_u8(vec_, o.vec_); }
   VecNx operator<(const VecNx& o) const { return vcltq_u8(vec_, o.vec_); }
 
   uint8_t operator[](int k) const {
@@ -495,11 +582,11 @@ inline Vec4f vnxCast<float, uint8_t>(const Vec4b& src) {
 template<>
 inline Vec16b vnxCast<uint8_t, float>(const Vec16f& src) {
   Vec8f ab, cd;
-  VnxMath::Split(src, &ab, &cd);
+  VnxMath::split(src, &ab, &cd);
 
   Vec4f a,b,c,d;
-  VnxMath::Split(ab, &a, &b);
-  VnxMath::Split(cd, &c, &d);
+  VnxMath::split(ab, &a, &b);
+  VnxMath::split(cd, &c, &d);
   return vuzpq_u8(vuzpq_u8((uint8x16_t)vcvtq_u32_f32(a.vec_),
                            (uint8x16_t)vcvtq_u32_f32(b.vec_)).val[0],
                   vuzpq_u8((uint8x16_t)vcvtq_u32_f32(c.vec_),
@@ -537,6 +624,7 @@ inline Vec4i vnxCast<int32_t, uint32_t>(const Vec4u& src) {
   return vreinterpretq_s32_u32(src.vec_);
 }
 
+} // inline namespace STP_VNX_NAMESPACE
 } // namespace stp
 
 #endif // STP_BASE_SIMD_VNXNEON_H_
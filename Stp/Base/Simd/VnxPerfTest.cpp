@@ -0,0 +1,204 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Simd/Vnx.h"
+
+#include "Base/Containers/List.h"
+#include "Base/Test/GTest.h"
+#include "Base/Test/PerfTest.h"
+#include "Base/Time/TimeTicks.h"
+#include "Base/Util/Random.h"
+
+namespace stp {
+
+namespace {
+
+// Representative kernels run with 128, 256 and 512-bit vectors. Whether these
+// map to single registers depends on instruction sets enabled at build time,
+// wider vectors fall back on pairs of narrower ones otherwise.
+
+// Odd count, so masked loads and stores handle a tail.
+constexpr int ValueCount = (1 << 16) + 7;
+constexpr int Iterations = 500;
+constexpr int TableSize = 256;
+
+template<unsigned N>
+void axpy(float a, const float* x, float* y, int count) {
+  typedef VecNx<N, float> Vec;
+  Vec va(a);
+  int i = 0;
+  for (; i + static_cast<int>(N) <= count; i += N)
+    (va * Vec::load(x + i) + Vec::load(y + i)).store(y + i);
+  int tail = count - i;
+  (va * Vec::loadMasked(x + i, tail) + Vec::loadMasked(y + i, tail)).storeMasked(y + i, tail);
+}
+
+template<unsigned N>
+int32_t findRange(const int32_t* values, int count) {
+  typedef VecNx<N, int32_t> Vec;
+  Vec vmin(values[0]), vmax(values[0]);
+  int i = 0;
+  for (; i + static_cast<int>(N) <= count; i += N) {
+    Vec v = Vec::load(values + i);
+    vmin = min(vmin, v);
+    vmax = max(vmax, v);
+  }
+  int32_t lanes_min[N], lanes_max[N];
+  vmin.store(lanes_min);
+  vmax.store(lanes_max);
+  int32_t range_min = lanes_min[0], range_max = lanes_max[0];
+  for (unsigned k = 1; k < N; ++k) {
+    range_min = lanes_min[k] < range_min ? lanes_min[k] : range_min;
+    range_max = lanes_max[k] > range_max ? lanes_max[k] : range_max;
+  }
+  for (; i < count; ++i) {
+    range_min = values[i] < range_min ? values[i] : range_min;
+    range_max = values[i] > range_max ? values[i] : range_max;
+  }
+  return range_max - range_min;
+}
+
+template<unsigned N>
+void addSaturated(const uint8_t* a, const uint8_t* b, uint8_t* out, int count) {
+  typedef VecNx<N, uint8_t> Vec;
+  int i = 0;
+  for (; i + static_cast<int>(N) <= count; i += N)
+    VnxMath::saturatedAdd(Vec::load(a + i), Vec::load(b + i)).store(out + i);
+  int tail = count - i;
+  VnxMath::saturatedAdd(Vec::loadMasked(a + i, tail), Vec::loadMasked(b + i, tail))
+      .storeMasked(out + i, tail);
+}
+
+template<unsigned N>
+void lookUp(const float* table, const int32_t* indices, float* out, int count) {
+  typedef VecNx<N, float> Vec;
+  typedef VecNx<N, int32_t> IndexVec;
+  int i = 0;
+  for (; i + static_cast<int>(N) <= count; i += N)
+    Vec::gather(table, IndexVec::load(indices + i)).store(out + i);
+  // Masked out indices are zero, so they still point into the table.
+  int tail = count - i;
+  Vec::gather(table, IndexVec::loadMasked(indices + i, tail)).storeMasked(out + i, tail);
+}
+
+class VnxPerfTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    for (int i = 0; i < ValueCount; ++i) {
+      uint32_t bits = random_.NextUInt32();
+      floats_.add(static_cast<float>(bits >> 8) / (1 << 24));
+      ints_.add(static_cast<int32_t>(bits));
+      bytes_.add(static_cast<uint8_t>(bits >> 24));
+      indices_.add(static_cast<int32_t>((bits >> 8) % TableSize));
+    }
+  }
+
+  template<typename TBody>
+  static void run(const char* measurement, const char* trace, TBody body) {
+    TimeTicks start = TimeTicks::Now();
+    for (int j = 0; j < Iterations; ++j)
+      body();
+    perf_test::PrintThroughput(
+        measurement, "", trace, static_cast<double>(ValueCount) * Iterations,
+        TimeTicks::Now() - start, "Mvalues/s", true);
+  }
+
+  List<float> floats_;
+  List<int32_t> ints_;
+  List<uint8_t> bytes_;
+  List<int32_t> indices_;
+  Random random_;
+};
+
+} // namespace
+
+TEST_F(VnxPerfTest, Axpy) {
+  const float* x = floats_.data();
+  List<float> expected;
+  expected = floats_;
+  run("axpy", "scalar", [&]() {
+    for (int i = 0; i < ValueCount; ++i)
+      expected[i] = 0.5f * x[i] + expected[i];
+  });
+
+  List<float> y;
+  y = floats_;
+  run("axpy", "vec4f", [&]() { axpy<4>(0.5f, x, y.data(), ValueCount); });
+  y = floats_;
+  run("axpy", "vec8f", [&]() { axpy<8>(0.5f, x, y.data(), ValueCount); });
+  y = floats_;
+  run("axpy", "vec16f", [&]() { axpy<16>(0.5f, x, y.data(), ValueCount); });
+
+  for (int i = 0; i < ValueCount; ++i)
+    EXPECT_NEAR(expected[i], y[i], 1E-3f);
+}
+
+TEST_F(VnxPerfTest, FindRange) {
+  int32_t expected = 0;
+  run("find_range", "scalar", [&]() {
+    int32_t range_min = ints_[0], range_max = ints_[0];
+    for (int32_t value : ints_) {
+      range_min = value < range_min ? value : range_min;
+      range_max = value > range_max ? value : range_max;
+    }
+    expected = range_max - range_min;
+  });
+
+  int32_t range = 0;
+  run("find_range", "vec4i", [&]() { range = findRange<4>(ints_.data(), ValueCount); });
+  EXPECT_EQ(expected, range);
+  run("find_range", "vec8i", [&]() { range = findRange<8>(ints_.data(), ValueCount); });
+  EXPECT_EQ(expected, range);
+  run("find_range", "vec16i", [&]() { range = findRange<16>(ints_.data(), ValueCount); });
+  EXPECT_EQ(expected, range);
+}
+
+TEST_F(VnxPerfTest, SaturatedAdd) {
+  // Adds values to their reversed sequence.
+  List<uint8_t> reversed;
+  for (int i = ValueCount - 1; i >= 0; --i)
+    reversed.add(bytes_[i]);
+  const uint8_t* a = bytes_.data();
+  const uint8_t* b = reversed.data();
+
+  List<uint8_t> expected;
+  expected.appendUninitialized(ValueCount);
+  run("saturated_add", "scalar", [&]() {
+    for (int i = 0; i < ValueCount; ++i) {
+      int sum = a[i] + b[i];
+      expected[i] = static_cast<uint8_t>(sum > 255 ? 255 : sum);
+    }
+  });
+
+  List<uint8_t> output;
+  output.appendUninitialized(ValueCount);
+  run("saturated_add", "vec16b", [&]() { addSaturated<16>(a, b, output.data(), ValueCount); });
+  EXPECT_EQ(expected, output);
+  run("saturated_add", "vec32b", [&]() { addSaturated<32>(a, b, output.data(), ValueCount); });
+  EXPECT_EQ(expected, output);
+  run("saturated_add", "vec64b", [&]() { addSaturated<64>(a, b, output.data(), ValueCount); });
+  EXPECT_EQ(expected, output);
+}
+
+TEST_F(VnxPerfTest, Gather) {
+  const float* table = floats_.data();
+  const int32_t* indices = indices_.data();
+
+  List<float> expected;
+  expected.appendUninitialized(ValueCount);
+  run("gather", "scalar", [&]() {
+    for (int i = 0; i < ValueCount; ++i)
+      expected[i] = table[indices[i]];
+  });
+
+  List<float> output;
+  output.appendUninitialized(ValueCount);
+  run("gather", "vec4f", [&]() { lookUp<4>(table, indices, output.data(), ValueCount); });
+  EXPECT_EQ(expected, output);
+  run("gather", "vec8f", [&]() { lookUp<8>(table, indices, output.data(), ValueCount); });
+  EXPECT_EQ(expected, output);
+  run("gather", "vec16f", [&]() { lookUp<16>(table, indices, output.data(), ValueCount); });
+  EXPECT_EQ(expected, output);
+}
+
+} // namespace stp
@@ -14,6 +14,7 @@
 #include <emmintrin.h>
 
 namespace stp {
+inline namespace STP_VNX_NAMESPACE {
 
 template<>
 struct VecNx<2, float> {
@@ -61,6 +62,9 @@ struct VecNx<2, float> {
   VecNx operator<=(const VecNx& o) const { return _mm_cmple_ps(vec_, o.vec_); }
   VecNx operator>=(const VecNx& o) const { return _mm_cmpge_ps(vec_, o.vec_); }
 
+  VecNx operator&(const VecNx& o) const { return _mm_and_ps(vec_, o.vec_); }
+  VecNx operator|(const VecNx& o) const { return _mm_or_ps(vec_, o.vec_); }
+
   float operator[](int k) const {
     ASSERT(0 <= k && k < Size);
     union { __m128 v; float fs[4]; } pun = {vec_};
@@ -83,6 +87,23 @@ struct VecNx<4, float> {
   static VecNx load(const float* ptr) { return _mm_loadu_ps(ptr); }
   void store(float* ptr) const { _mm_storeu_ps(ptr, vec_); }
 
+  static VecNx loadMasked(const float* ptr, int count) {
+    #if CPU_SIMD(AVX)
+    return _mm_maskload_ps(ptr, laneMask(count));
+    #else
+    return vnxLoadMasked<VecNx>(ptr, count);
+    #endif
+  }
+  void storeMasked(float* ptr, int count) const {
+    #if CPU_SIMD(AVX)
+    _mm_maskstore_ps(ptr, laneMask(count), vec_);
+    #else
+    vnxStoreMasked(*this, ptr, count);
+    #endif
+  }
+
+  static VecNx gather(const float* base, const VecNx<4, int32_t>& indices);
+
   bool allTrue() const {
     return _mm_movemask_epi8(_mm_castps_si128(vec_)) == 0xFFFF;
   }
@@ -97,7 +118,7 @@ struct VecNx<4, float> {
 
   VecNx mathFloor() const {
     #if CPU_SIMD(SSE41)
-    return _mm_floor_ps(x.vec_);
+    return _mm_floor_ps(vec_);
     #else
     // Emulate _mm_floor_ps() with SSE2:
     //   - roundtrip through integers via truncation
@@ -138,6 +159,9 @@ struct VecNx<4, float> {
   VecNx operator<=(const VecNx& o) const { return _mm_cmple_ps(vec_, o.vec_); }
   VecNx operator>=(const VecNx& o) const { return _mm_cmpge_ps(vec_, o.vec_); }
 
+  VecNx operator&(const VecNx& o) const { return _mm_and_ps(vec_, o.vec_); }
+  VecNx operator|(const VecNx& o) const { return _mm_or_ps(vec_, o.vec_); }
+
   float operator[](int k) const {
     ASSERT(0 <= k && k < Size);
     union { __m128 v; float fs[4]; } pun = {vec_};
@@ -145,6 +169,13 @@ struct VecNx<4, float> {
   }
 
   __m128 vec_;
+
+ private:
+  // Returns mask with all bits set in first |count| lanes.
+  static __m128i laneMask(int count) {
+    ASSERT(0 <= count && count <= Size);
+    return _mm_cmpgt_epi32(_mm_set1_epi32(count), _mm_setr_epi32(0, 1, 2, 3));
+  }
 };
 
 template<>
@@ -162,6 +193,61 @@ struct VecNx<4, int32_t> {
   }
   void store(int32_t* ptr) const { _mm_storeu_si128((__m128i*)ptr, vec_); }
 
+  static VecNx loadMasked(const int32_t* ptr, int count) {
+    #if CPU_SIMD(AVX2)
+    return _mm_maskload_epi32(ptr, laneMask(count));
+    #else
+    return vnxLoadMasked<VecNx>(ptr, count);
+    #endif
+  }
+  void storeMasked(int32_t* ptr, int count) const {
+    #if CPU_SIMD(AVX2)
+    _mm_maskstore_epi32(ptr, laneMask(count), vec_);
+    #else
+    vnxStoreMasked(*this, ptr, count);
+    #endif
+  }
+
+  static VecNx gather(const int32_t* base, const VecNx& indices) {
+    #if CPU_SIMD(AVX2)
+    return _mm_i32gather_epi32(base, indices.vec_, 4);
+    #else
+    return VecNx(base[indices[0]], base[indices[1]], base[indices[2]], base[indices[3]]);
+    #endif
+  }
+
+  static void load4(const int32_t* ptr, VecNx* a, VecNx* b, VecNx* c, VecNx* d) {
+    transpose(
+        _mm_loadu_si128((const __m128i*)(ptr + 0)),
+        _mm_loadu_si128((const __m128i*)(ptr + 4)),
+        _mm_loadu_si128((const __m128i*)(ptr + 8)),
+        _mm_loadu_si128((const __m128i*)(ptr + 12)),
+        a, b, c, d);
+  }
+  static void store4(int32_t* ptr, const VecNx& a, const VecNx& b, const VecNx& c, const VecNx& d) {
+    VecNx v0, v1, v2, v3;
+    transpose(a.vec_, b.vec_, c.vec_, d.vec_, &v0, &v1, &v2, &v3);
+    _mm_storeu_si128((__m128i*)(ptr + 0), v0.vec_);
+    _mm_storeu_si128((__m128i*)(ptr + 4), v1.vec_);
+    _mm_storeu_si128((__m128i*)(ptr + 8), v2.vec_);
+    _mm_storeu_si128((__m128i*)(ptr + 12), v3.vec_);
+  }
+
+  static VecNx min(const VecNx& l, const VecNx& r) {
+    #if CPU_SIMD(SSE41)
+    return _mm_min_epi32(l.vec_, r.vec_);
+    #else
+    return ternary(l < r, l, r);
+    #endif
+  }
+  static VecNx max(const VecNx& l, const VecNx& r) {
+    #if CPU_SIMD(SSE41)
+    return _mm_max_epi32(l.vec_, r.vec_);
+    #else
+    return ternary(l > r, l, r);
+    #endif
+  }
+
   static VecNx ternary(const VecNx& c, const VecNx& t, const VecNx& e) {
     #if CPU_SIMD(SSE41)
     return _mm_blendv_epi8(e.vec_, t.vec_, c.vec_);
@@ -171,6 +257,23 @@ struct VecNx<4, int32_t> {
     #endif
   }
 
+  static VecNx mulHi(const VecNx& l, const VecNx& r) {
+    #if CPU_SIMD(SSE41)
+    __m128i mul20 = _mm_mul_epi32(l.vec_, r.vec_),
+            mul31 = _mm_mul_epi32(_mm_srli_epi64(l.vec_, 32), _mm_srli_epi64(r.vec_, 32));
+    #else
+    __m128i mul20 = _mm_mul_epu32(l.vec_, r.vec_),
+            mul31 = _mm_mul_epu32(_mm_srli_epi64(l.vec_, 32), _mm_srli_epi64(r.vec_, 32));
+    #endif
+    VecNx hi = _mm_unpacklo_epi32(_mm_shuffle_epi32(mul20, _MM_SHUFFLE(0,0,3,1)),
+                                  _mm_shuffle_epi32(mul31, _MM_SHUFFLE(0,0,3,1)));
+    #if !CPU_SIMD(SSE41)
+    // Turn unsigned product into signed one.
+    hi = hi - ((l >> 31) & r) - ((r >> 31) & l);
+    #endif
+    return hi;
+  }
+
   VecNx operator&(const VecNx& o) const { return _mm_and_si128(vec_, o.vec_); }
   VecNx operator|(const VecNx& o) const { return _mm_or_si128(vec_, o.vec_); }
   VecNx operator^(const VecNx& o) const { return _mm_xor_si128(vec_, o.vec_); }
@@ -199,8 +302,35 @@ struct VecNx<4, int32_t> {
   }
 
   __m128i vec_;
+
+ private:
+  static __m128i laneMask(int count) {
+    ASSERT(0 <= count && count <= Size);
+    return _mm_cmpgt_epi32(_mm_set1_epi32(count), _mm_setr_epi32(0, 1, 2, 3));
+  }
+
+  static void transpose(
+      __m128i v0, __m128i v1, __m128i v2, __m128i v3,
+      VecNx* a, VecNx* b, VecNx* c, VecNx* d) {
+    __m128i t0 = _mm_unpacklo_epi32(v0, v1),
+            t1 = _mm_unpackhi_epi32(v0, v1),
+            t2 = _mm_unpacklo_epi32(v2, v3),
+            t3 = _mm_unpackhi_epi32(v2, v3);
+    *a = _mm_unpacklo_epi64(t0, t2);
+    *b = _mm_unpackhi_epi64(t0, t2);
+    *c = _mm_unpacklo_epi64(t1, t3);
+    *d = _mm_unpackhi_epi64(t1, t3);
+  }
 };
 
+inline Vec4f Vec4f::gather(const float* base, const Vec4i& indices) {
+  #if CPU_SIMD(AVX2)
+  return _mm_i32gather_ps(base, indices.vec_, 4);
+  #else
+  return Vec4f(base[indices[0]], base[indices[1]], base[indices[2]], base[indices[3]]);
+  #endif
+}
+
 template<>
 struct VecNx<4, uint32_t> {
   static constexpr int Size = 4;
@@ -295,7 +425,17 @@ struct VecNx<8, uint16_t> {
   }
   void store(uint16_t* ptr) const { _mm_storeu_si128((__m128i*)ptr, vec_); }
 
+  static VecNx loadMasked(const uint16_t* ptr, int count) {
+    return vnxLoadMasked<VecNx>(ptr, count);
+  }
+  void storeMasked(uint16_t* ptr, int count) const {
+    vnxStoreMasked(*this, ptr, count);
+  }
+
   static VecNx min(const VecNx& a, const VecNx& b) {
+    #if CPU_SIMD(SSE41)
+    return _mm_min_epu16(a.vec_, b.vec_);
+    #else
     // No unsigned _mm_min_epu16, so we'll shift into a space where we can use
     // the signed version, _mm_min_epi16, then shift back.
     const uint16_t top = 0x8000;
@@ -303,6 +443,22 @@ struct VecNx<8, uint16_t> {
     const __m128i top_8x = _mm_set1_epi16(top);
     return _mm_add_epi8(top_8x, _mm_min_epi16(_mm_sub_epi8(a.vec_, top_8x),
                                               _mm_sub_epi8(b.vec_, top_8x)));
+    #endif
+  }
+  static VecNx max(const VecNx& a, const VecNx& b) {
+    #if CPU_SIMD(SSE41)
+    return _mm_max_epu16(a.vec_, b.vec_);
+    #else
+    // Same trick as in min().
+    const uint16_t top = 0x8000;
+    const __m128i top_8x = _mm_set1_epi16(top);
+    return _mm_add_epi8(top_8x, _mm_max_epi16(_mm_sub_epi8(a.vec_, top_8x),
+                                              _mm_sub_epi8(b.vec_, top_8x)));
+    #endif
+  }
+
+  static VecNx saturatedAdd(const VecNx& l, const VecNx& r) {
+    return _mm_adds_epu16(l.vec_, r.vec_);
   }
 
   static VecNx ternary(const VecNx& c, const VecNx& t, const VecNx& e) {
@@ -321,6 +477,8 @@ struct VecNx<8, uint16_t> {
   VecNx operator<<(int amount) const { return _mm_slli_epi16(vec_, amount); }
   VecNx operator>>(int amount) const { return _mm_srli_epi16(vec_, amount); }
 
+  VecNx operator==(const VecNx& o) const { return _mm_cmpeq_epi16(vec_, o.vec_); }
+
   uint16_t operator[](int k) const {
     ASSERT(0 <= k && k < Size);
     union { __m128i v; uint16_t us[8]; } pun = {vec_};
@@ -368,9 +526,19 @@ struct VecNx<16, uint8_t> {
   }
   void store(uint8_t* ptr) const { _mm_storeu_si128((__m128i*)ptr, vec_); }
 
+  static VecNx loadMasked(const uint8_t* ptr, int count) {
+    return vnxLoadMasked<VecNx>(ptr, count);
+  }
+  void storeMasked(uint8_t* ptr, int count) const {
+    vnxStoreMasked(*this, ptr, count);
+  }
+
   static VecNx min(const VecNx& l, const VecNx& r) {
     return _mm_min_epu8(l.vec_, r.vec_);
   }
+  static VecNx max(const VecNx& l, const VecNx& r) {
+    return _mm_max_epu8(l.vec_, r.vec_);
+  }
 
   static VecNx saturatedAdd(const VecNx& l, const VecNx& r) {
     return _mm_adds_epu8(l.vec_, r.vec_);
@@ -384,6 +552,7 @@ struct VecNx<16, uint8_t> {
   VecNx operator+(const VecNx& o) const { return _mm_add_epi8(vec_, o.vec_); }
   VecNx operator-(const VecNx& o) const { return _mm_sub_epi8(vec_, o.vec_); }
 
+  VecNx operator==(const VecNx& o) const { return _mm_cmpeq_epi8(vec_, o.vec_); }
   VecNx operator<(const VecNx& o) const {
     // There's no unsigned _mm_cmplt_epu8, so we flip the sign bits then use
     // a signed compare.
@@ -459,6 +628,8 @@ inline Vec4f vnxCast<float, uint16_t>(const Vec4h& src) {
   return _mm_cvtepi32_ps(_32);
 }
 
+// Wider backends specialize Vec8f and Vec16f, so they provide their own variant.
+#if !CPU_SIMD(AVX2)
 template<>
 inline Vec16b vnxCast<uint8_t, float>(const Vec16f& src) {
   Vec8f ab, cd;
@@ -473,6 +644,7 @@ inline Vec16b vnxCast<uint8_t, float>(const Vec16f& src) {
                           _mm_packus_epi16(_mm_cvttps_epi32(c.vec_),
                                            _mm_cvttps_epi32(d.vec_)));
 }
+#endif // !CPU_SIMD(AVX2)
 
 template<>
 inline Vec4h vnxCast<uint16_t, uint8_t>(const Vec4b& src) {
@@ -499,6 +671,7 @@ inline Vec4i vnxCast<int32_t, uint32_t>(const Vec4u& src) {
   return src.vec_;
 }
 
+} // inline namespace STP_VNX_NAMESPACE
 } // namespace stp
 
 #endif // STP_BASE_SIMD_VNXSSE_H_
@@ -70,6 +70,11 @@ static void testTemplateVecNf() {
   EXPECT_TRUE((a <= fours).anyTrue());
   EXPECT_FALSE((a > fours).allTrue());
   EXPECT_FALSE((a >= fours).allTrue());
+
+  // Comparison masks can be combined.
+  EXPECT_FALSE(((a < fours) & (a > fours)).anyTrue());
+  EXPECT_TRUE(((a <= fours) | (a > fours)).allTrue());
+  EXPECT_TRUE(((a <= fours) & (b < fours)).anyTrue());
 }
 
 TEST(VnxTest, Vecf) {
@@ -264,4 +269,254 @@ TEST(VnxTest, Int32UInt16Conversion) {
   }
 }
 
+TEST(VnxTest, Int32MinMax) {
+  Vec4i a(-5, 3, INT32_MIN, 7), b(2, -8, 0, INT32_MAX);
+  Vec4i lo = min(a, b), hi = max(a, b);
+  EXPECT_EQ(-5, lo[0]);
+  EXPECT_EQ(-8, lo[1]);
+  EXPECT_EQ(INT32_MIN, lo[2]);
+  EXPECT_EQ(7, lo[3]);
+  EXPECT_EQ(2, hi[0]);
+  EXPECT_EQ(3, hi[1]);
+  EXPECT_EQ(0, hi[2]);
+  EXPECT_EQ(INT32_MAX, hi[3]);
+}
+
+TEST(VnxTest, Int32MulHi) {
+  Random rand;
+  for (int i = 0; i < 10000; ++i) {
+    int32_t l[8], r[8];
+    for (int j = 0; j < 8; ++j) {
+      l[j] = static_cast<int32_t>(rand.NextUInt32());
+      r[j] = static_cast<int32_t>(rand.NextUInt32());
+    }
+    Vec4i hi4 = Vec4i::mulHi(Vec4i::load(l), Vec4i::load(r));
+    Vec8i hi8 = Vec8i::mulHi(Vec8i::load(l), Vec8i::load(r));
+    for (int j = 0; j < 8; ++j) {
+      int32_t expected = static_cast<int32_t>((static_cast<int64_t>(l[j]) * r[j]) >> 32);
+      if (j < 4) {
+        EXPECT_EQ(expected, hi4[j]);
+      }
+      EXPECT_EQ(expected, hi8[j]);
+    }
+  }
+}
+
+TEST(VnxTest, Int32Load4Store4) {
+  int32_t src[32];
+  for (int i = 0; i < 32; ++i)
+    src[i] = i;
+
+  Vec4i a, b, c, d;
+  Vec4i::load4(src, &a, &b, &c, &d);
+  for (int k = 0; k < 4; ++k) {
+    EXPECT_EQ(4 * k + 0, a[k]);
+    EXPECT_EQ(4 * k + 1, b[k]);
+    EXPECT_EQ(4 * k + 2, c[k]);
+    EXPECT_EQ(4 * k + 3, d[k]);
+  }
+
+  Vec8i a8, b8, c8, d8;
+  Vec8i::load4(src, &a8, &b8, &c8, &d8);
+  for (int k = 0; k < 8; ++k) {
+    EXPECT_EQ(4 * k + 0, a8[k]);
+    EXPECT_EQ(4 * k + 3, d8[k]);
+  }
+
+  int32_t dst[32] = {};
+  Vec4i::store4(dst, a, b, c, d);
+  EXPECT_TRUE(memcmp(src, dst, 16 * sizeof(int32_t)) == 0);
+  EXPECT_EQ(0, dst[16]);
+
+  Vec8i::store4(dst, a8, b8, c8, d8);
+  EXPECT_TRUE(memcmp(src, dst, sizeof(src)) == 0);
+}
+
+// Following tests run on types wide enough to use AVX2 and AVX-512
+// specializations when built with these enabled.
+
+template<int N, typename T>
+static void testMaskedLoadStore() {
+  T src[N], dst[N + 1];
+  for (int k = 0; k < N; ++k)
+    src[k] = static_cast<T>(k + 1);
+
+  for (int count = 0; count <= N; ++count) {
+    VecNx<N,T> v = VecNx<N,T>::loadMasked(src, count);
+    for (int k = 0; k < N; ++k)
+      EXPECT_EQ(k < count ? src[k] : T(0), v[k]);
+
+    for (int k = 0; k <= N; ++k)
+      dst[k] = T(99);
+    VecNx<N,T>::load(src).storeMasked(dst, count);
+    for (int k = 0; k <= N; ++k)
+      EXPECT_EQ(k < count ? src[k] : T(99), dst[k]);
+  }
+}
+
+TEST(VnxTest, MaskedLoadStore) {
+  testMaskedLoadStore<4, float>();
+  testMaskedLoadStore<8, float>();
+  testMaskedLoadStore<16, float>();
+
+  testMaskedLoadStore<4, int32_t>();
+  testMaskedLoadStore<8, int32_t>();
+  testMaskedLoadStore<16, int32_t>();
+
+  testMaskedLoadStore<8, uint16_t>();
+  testMaskedLoadStore<16, uint16_t>();
+  testMaskedLoadStore<32, uint16_t>();
+
+  testMaskedLoadStore<16, uint8_t>();
+  testMaskedLoadStore<32, uint8_t>();
+  testMaskedLoadStore<64, uint8_t>();
+}
+
+template<int N, typename T>
+static void testGather() {
+  T table[100];
+  for (int k = 0; k < 100; ++k)
+    table[k] = static_cast<T>(k * 3 - 50);
+
+  int32_t indices[N];
+  for (int k = 0; k < N; ++k)
+    indices[k] = (k * 37 + 11) % 100;
+
+  VecNx<N,T> v = VecNx<N,T>::gather(table, VecNx<N,int32_t>::load(indices));
+  for (int k = 0; k < N; ++k)
+    EXPECT_EQ(table[indices[k]], v[k]);
+}
+
+TEST(VnxTest, Gather) {
+  testGather<4, float>();
+  testGather<8, float>();
+  testGather<16, float>();
+
+  testGather<4, int32_t>();
+  testGather<8, int32_t>();
+  testGather<16, int32_t>();
+}
+
+template<typename T>
+static T makeTestValue(uint32_t bits) { return static_cast<T>(bits); }
+
+template<>
+float makeTestValue<float>(uint32_t bits) {
+  return static_cast<float>(static_cast<int32_t>(bits) >> 12);
+}
+
+template<int N, typename T>
+static void testMinMaxTernary() {
+  Random rand;
+  for (int i = 0; i < 100; ++i) {
+    T a[N], b[N];
+    for (int k = 0; k < N; ++k) {
+      a[k] = makeTestValue<T>(rand.NextUInt32());
+      b[k] = k % 3 ? makeTestValue<T>(rand.NextUInt32()) : a[k];
+    }
+    VecNx<N,T> va = VecNx<N,T>::load(a), vb = VecNx<N,T>::load(b);
+    VecNx<N,T> lo = min(va, vb), hi = max(va, vb);
+    VecNx<N,T> selected = VnxMath::ternary(va == vb, VecNx<N,T>(T(1)), lo);
+    for (int k = 0; k < N; ++k) {
+      EXPECT_EQ(a[k] < b[k] ? a[k] : b[k], lo[k]);
+      EXPECT_EQ(a[k] > b[k] ? a[k] : b[k], hi[k]);
+      EXPECT_EQ(a[k] == b[k] ? T(1) : lo[k], selected[k]);
+    }
+  }
+}
+
+TEST(VnxTest, MinMaxTernary) {
+  testMinMaxTernary<4, float>();
+  testMinMaxTernary<8, float>();
+  testMinMaxTernary<16, float>();
+
+  testMinMaxTernary<4, int32_t>();
+  testMinMaxTernary<8, int32_t>();
+  testMinMaxTernary<16, int32_t>();
+
+  testMinMaxTernary<8, uint16_t>();
+  testMinMaxTernary<16, uint16_t>();
+  testMinMaxTernary<32, uint16_t>();
+
+  testMinMaxTernary<16, uint8_t>();
+  testMinMaxTernary<32, uint8_t>();
+  testMinMaxTernary<64, uint8_t>();
+}
+
+template<int N, typename T>
+static void testSaturatedAdd() {
+  Random rand;
+  for (int i = 0; i < 100; ++i) {
+    T a[N], b[N];
+    for (int k = 0; k < N; ++k) {
+      a[k] = static_cast<T>(rand.NextUInt32());
+      b[k] = static_cast<T>(rand.NextUInt32());
+    }
+    VecNx<N,T> sum = VnxMath::saturatedAdd(VecNx<N,T>::load(a), VecNx<N,T>::load(b));
+    for (int k = 0; k < N; ++k) {
+      uint32_t exact = static_cast<uint32_t>(a[k]) + b[k];
+      EXPECT_EQ(exact > Limits<T>::Max ? Limits<T>::Max : exact, sum[k]);
+    }
+  }
+}
+
+TEST(VnxTest, SaturatedAddWide) {
+  testSaturatedAdd<8, uint16_t>();
+  testSaturatedAdd<16, uint16_t>();
+  testSaturatedAdd<32, uint16_t>();
+
+  testSaturatedAdd<32, uint8_t>();
+  testSaturatedAdd<64, uint8_t>();
+}
+
+TEST(VnxTest, SplitJoin) {
+  float fs[16];
+  uint8_t bs[64];
+  for (int k = 0; k < 64; ++k) {
+    if (k < 16)
+      fs[k] = k * 0.5f;
+    bs[k] = static_cast<uint8_t>(k * 3);
+  }
+
+  Vec8f flo, fhi;
+  VnxMath::split(Vec16f::load(fs), &flo, &fhi);
+  Vec16f fjoined = VnxMath::join(flo, fhi);
+  for (int k = 0; k < 8; ++k) {
+    EXPECT_EQ(fs[k], flo[k]);
+    EXPECT_EQ(fs[k + 8], fhi[k]);
+  }
+  for (int k = 0; k < 16; ++k)
+    EXPECT_EQ(fs[k], fjoined[k]);
+
+  Vec32b blo, bhi;
+  VnxMath::split(Vec64b::load(bs), &blo, &bhi);
+  Vec64b bjoined = VnxMath::join(blo, bhi);
+  for (int k = 0; k < 32; ++k) {
+    EXPECT_EQ(bs[k], blo[k]);
+    EXPECT_EQ(bs[k + 32], bhi[k]);
+  }
+  for (int k = 0; k < 64; ++k)
+    EXPECT_EQ(bs[k], bjoined[k]);
+}
+
+TEST(VnxTest, WideConversion) {
+  float fs[16];
+  for (int k = 0; k < 16; ++k)
+    fs[k] = k * 16.25f;
+
+  Vec8i i8 = vnxCast<int32_t>(Vec8f::load(fs));
+  Vec8f f8 = vnxCast<float>(i8);
+  for (int k = 0; k < 8; ++k) {
+    EXPECT_EQ(static_cast<int32_t>(fs[k]), i8[k]);
+    EXPECT_EQ(static_cast<float>(static_cast<int32_t>(fs[k])), f8[k]);
+  }
+
+  Vec16i i16 = vnxCast<int32_t>(Vec16f::load(fs));
+  Vec16b b16 = vnxCast<uint8_t>(Vec16f::load(fs));
+  for (int k = 0; k < 16; ++k) {
+    EXPECT_EQ(static_cast<int32_t>(fs[k]), i16[k]);
+    EXPECT_EQ(static_cast<uint8_t>(fs[k]), b16[k]);
+  }
+}
+
 } // namespace stp
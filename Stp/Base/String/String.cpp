@@ -86,6 +86,7 @@ String String::createUninitialized(int length, char*& out_data) {
   }
   char* data = static_cast<char*>(allocateMemory(length + 1));
   *(data + length) = '\0';
+  out_data = data;
   return String(data, length, length);
 }
 
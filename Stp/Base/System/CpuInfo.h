@@ -94,6 +94,9 @@ constexpr CpuInfo::Features CpuInfo::CompilerFeatures() {
   #if CPU_SIMD(AVX2)
   features |= static_cast<Features>(CpuFeature::Avx2);
   #endif
+  #if CPU_SIMD(AVX512)
+  features |= static_cast<Features>(CpuFeature::Skylake);
+  #endif
 
   #elif CPU(ARM_FAMILY)
   #if CPU_SIMD(NEON)
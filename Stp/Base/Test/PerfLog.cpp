@@ -7,30 +7,42 @@
 
 #include "Base/Io/FileStream.h"
 #include "Base/Io/StreamWriter.h"
+#include "Base/Text/FormatMany.h"
 
 namespace stp {
 
 static FileStream* g_perf_log_stream = nullptr;
+static StreamWriter* g_perf_log_writer = nullptr;
 
 bool InitPerfLog(const FilePath& log_file) {
   ASSERT(!g_perf_log_stream);
   g_perf_log_stream = new FileStream();
-  return !!g_perf_log_stream->tryCreate(log_file);
+  if (!isOk(g_perf_log_stream->tryCreate(log_file, FileMode::Create, FileAccess::WriteOnly))) {
+    delete g_perf_log_stream;
+    g_perf_log_stream = nullptr;
+    return false;
+  }
+  g_perf_log_writer = new StreamWriter(g_perf_log_stream);
+  return true;
 }
 
 void FinalizePerfLog() {
   ASSERT(g_perf_log_stream);
+  delete g_perf_log_writer;
+  g_perf_log_writer = nullptr;
   delete g_perf_log_stream;
   g_perf_log_stream = nullptr;
 }
 
+bool IsPerfLogInitialized() {
+  return g_perf_log_stream != nullptr;
+}
+
 void LogPerfResult(StringSpan test_name, double value, StringSpan units) {
-  ASSERT(g_perf_log_stream);
+  ASSERT(g_perf_log_writer);
 
-  // FIXME
-//  StreamWriter out(g_perf_log_stream);
-//  out.format("{}\t{}\t{}\n", test_name, value, units);
-//  out.Flush();
+  formatMany(*g_perf_log_writer, "{}\t{}\t{}\n", test_name, value, units);
+  g_perf_log_writer->flush();
 }
 
 } // namespace stp
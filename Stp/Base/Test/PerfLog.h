@@ -17,8 +17,12 @@ class FilePath;
 bool InitPerfLog(const FilePath& log_path);
 void FinalizePerfLog();
 
+// Returns true between successful InitPerfLog() and FinalizePerfLog().
+bool IsPerfLogInitialized();
+
 // Writes to the perf result log the given 'value' resulting from the
 // named 'test'. The units are to aid in reading the log by people.
+// Each result is a single line with tab separated name, value and units.
 void LogPerfResult(StringSpan test_name, double value, StringSpan units);
 
 } // namespace stp
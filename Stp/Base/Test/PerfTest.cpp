@@ -4,6 +4,8 @@
 
 #include "Base/Test/PerfTest.h"
 
+#include "Base/Test/GTest.h"
+#include "Base/Test/PerfLog.h"
 #include "Base/Text/FormatMany.h"
 
 #include <stdio.h>
@@ -39,6 +41,25 @@ void PrintResultsImpl(
   fflush(stdout);
 }
 
+// Numeric results are also written to the perf log for tracking trends
+// across builds, named <test case>.<test>/<measurement><modifier>/<trace>.
+void LogResult(
+    const String& measurement, const String& modifier, const String& trace,
+    double value, const String& units) {
+  if (!IsPerfLogInitialized())
+    return;
+
+  const testing::TestInfo* test_info =
+      testing::UnitTest::GetInstance()->current_test_info();
+  LogPerfResult(
+      stringFormatMany(
+          "{}.{}/{}{}/{}",
+          test_info ? test_info->test_case_name() : "",
+          test_info ? test_info->name() : "",
+          measurement, modifier, trace),
+      value, units);
+}
+
 } // namespace
 
 void PrintResult(
@@ -49,6 +70,7 @@ void PrintResult(
       measurement, modifier, trace,
       formattableToString(static_cast<unsigned int>(value), "d"),
       String(), String(), units, important);
+  LogResult(measurement, modifier, trace, static_cast<double>(value), units);
 }
 
 void PrintResult(
@@ -58,6 +80,7 @@ void PrintResult(
       measurement, modifier, trace,
       formattableToString(value), String(), String(), units,
       important);
+  LogResult(measurement, modifier, trace, value, units);
 }
 
 void appendResult(
@@ -92,6 +115,15 @@ void appendResult(
       important);
 }
 
+void PrintThroughput(
+    const String& measurement, const String& modifier, const String& trace,
+    double count, TimeDelta time, const String& units,
+    bool important) {
+  PrintResult(
+      measurement, modifier, trace,
+      count / (time.InMillisecondsF() * 1000), units, important);
+}
+
 void PrintResultMeanAndError(
     const String& measurement, const String& modifier, const String& trace,
     const String& mean_and_error, const String& units,
@@ -6,6 +6,7 @@
 #define STP_BASE_TEST_PERFTEST_H_
 
 #include "Base/Containers/List.h"
+#include "Base/Time/TimeDelta.h"
 
 namespace stp {
 namespace perf_test {
@@ -51,6 +52,13 @@ void appendResult(
     const String& value, const String& units,
     bool important);
 
+// Like PrintResult(), but prints |count| items processed in |time| as
+// millions per second. |units| should say what is counted, e.g. "Mops/s".
+void PrintThroughput(
+    const String& measurement, const String& modifier, const String& trace,
+    double count, TimeDelta time, const String& units,
+    bool important);
+
 // Like PrintResult(), but prints a (mean, standard deviation) result pair.
 // The |<values>| should be two comma-separated numbers, the mean and
 // standard deviation (or other error metric) of the measurement.
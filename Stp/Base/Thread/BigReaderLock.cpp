@@ -0,0 +1,90 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Thread/BigReaderLock.h"
+
+#include "Base/Thread/YieldProcessor.h"
+
+namespace stp {
+
+// Number of busy-wait iterations before a waiting thread gives up its time slice.
+static constexpr int SpinTries = 64;
+
+BigReaderLock::BigReaderLock(Preference preference)
+    : preference_(preference) {
+  for (int i = 0; i < SlotCount; ++i)
+    slots_[i].readers = 0;
+}
+
+BigReaderLock::~BigReaderLock() {
+  ASSERT(!hasReaders());
+  ASSERT(writer_state_ == NoWriter);
+}
+
+void BigReaderLock::writeAcquire() {
+  writer_lock_.acquire();
+
+  if (preference_ == Preference::Writer) {
+    // Stop new readers from entering and wait for current ones to leave.
+    subtle::NoBarrier_Store(&writer_state_, WriterActive);
+    subtle::MemoryBarrier();
+    waitForReaders();
+    return;
+  }
+
+  // Reader preference - enter only when there is nobody inside.
+  // A reader may slip in between the check and announcing ourselves,
+  // hence the check is repeated after the announcement.
+  for (;;) {
+    waitForReaders();
+    subtle::NoBarrier_Store(&writer_state_, WriterActive);
+    subtle::MemoryBarrier();
+    if (!hasReaders())
+      return;
+    subtle::Release_Store(&writer_state_, NoWriter);
+  }
+}
+
+void BigReaderLock::writeRelease() {
+  subtle::Release_Store(&writer_state_, NoWriter);
+  writer_lock_.release();
+}
+
+bool BigReaderLock::hasReaders() const {
+  for (int i = 0; i < SlotCount; ++i) {
+    if (subtle::Acquire_Load(&slots_[i].readers) != 0)
+      return true;
+  }
+  return false;
+}
+
+void BigReaderLock::waitForReaders() const {
+  // Slots which were found empty need not be rescanned in writer preference
+  // mode since no reader is able to enter. In reader preference mode we
+  // rescan anyway in writeAcquire().
+  for (int i = 0; i < SlotCount; ++i) {
+    int tries = 0;
+    while (subtle::Acquire_Load(&slots_[i].readers) != 0) {
+      if (++tries < SpinTries) {
+        YIELD_PROCESSOR;
+      } else {
+        tries = 0;
+        NativeThread::Yield();
+      }
+    }
+  }
+}
+
+void BigReaderLock::waitForWriter() const {
+  int tries = 0;
+  while (subtle::Acquire_Load(&writer_state_) != NoWriter) {
+    if (++tries < SpinTries) {
+      YIELD_PROCESSOR;
+    } else {
+      tries = 0;
+      NativeThread::Yield();
+    }
+  }
+}
+
+} // namespace stp
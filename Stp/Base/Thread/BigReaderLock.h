@@ -0,0 +1,132 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#ifndef STP_BASE_THREAD_BIGREADERLOCK_H_
+#define STP_BASE_THREAD_BIGREADERLOCK_H_
+
+#include "Base/Thread/AtomicOps.h"
+#include "Base/Thread/Lock.h"
+#include "Base/Thread/NativeThread.h"
+#include "Base/Type/Hashable.h"
+
+namespace stp {
+
+// A reader-writer lock optimized for read-mostly data ("big-reader" lock).
+//
+// Reader count is distributed over several cache lines. A thread always
+// uses the same slot, so readers running on different cores do not bounce
+// a shared counter between caches. The price is paid by writers which must
+// scan all slots and wait for them to drain.
+//
+// Use this lock only when writes are rare and reads are frequent and short.
+// Otherwise use ReadWriteLock or Lock.
+class BASE_EXPORT BigReaderLock {
+ public:
+  enum class Preference {
+    // Pending writer blocks new readers. Writers never starve.
+    Writer,
+    // Writer waits until there are no readers at all. Readers never wait
+    // for a pending writer, only for an active one.
+    Reader,
+  };
+
+  explicit BigReaderLock(Preference preference = Preference::Writer);
+  ~BigReaderLock();
+
+  void readAcquire();
+  void readRelease();
+
+  void writeAcquire();
+  void writeRelease();
+
+  Preference getPreference() const { return preference_; }
+
+ private:
+  static constexpr int SlotBits = 5;
+  static constexpr int SlotCount = 1 << SlotBits;
+
+  enum WriterState : subtle::Atomic32 {
+    NoWriter = 0,
+    WriterActive = 1,
+  };
+
+  struct alignas(64) Slot {
+    subtle::Atomic32 readers;
+  };
+
+  Slot slots_[SlotCount];
+
+  subtle::Atomic32 writer_state_ = NoWriter;
+  const Preference preference_;
+
+  // Serializes writers.
+  Lock writer_lock_;
+
+  static int selectSlot();
+  Slot& currentSlot() { return slots_[selectSlot()]; }
+
+  bool hasReaders() const;
+  void waitForReaders() const;
+  void waitForWriter() const;
+
+  DISALLOW_COPY_AND_ASSIGN(BigReaderLock);
+};
+
+class AutoBigReadLock {
+ public:
+  explicit AutoBigReadLock(BigReaderLock& lock) : lock_(lock) {
+    lock_.readAcquire();
+  }
+  ~AutoBigReadLock() {
+    lock_.readRelease();
+  }
+  DISALLOW_COPY_AND_ASSIGN(AutoBigReadLock);
+
+ private:
+  BigReaderLock& lock_;
+};
+
+class AutoBigWriteLock {
+ public:
+  explicit AutoBigWriteLock(BigReaderLock& lock) : lock_(lock) {
+    lock_.writeAcquire();
+  }
+  ~AutoBigWriteLock() {
+    lock_.writeRelease();
+  }
+  DISALLOW_COPY_AND_ASSIGN(AutoBigWriteLock);
+
+ private:
+  BigReaderLock& lock_;
+};
+
+inline int BigReaderLock::selectSlot() {
+  // Fibonacci hashing of thread handle. Handles are pointers or small
+  // integers, so low bits alone would be poorly distributed.
+  uint64_t h = static_cast<uint32_t>(partialHash(NativeThread::currentHandle()));
+  h *= UINT64_C(0x9E3779B97F4A7C15);
+  return static_cast<int>(h >> (64 - SlotBits));
+}
+
+inline void BigReaderLock::readAcquire() {
+  Slot& slot = currentSlot();
+  for (;;) {
+    subtle::NoBarrier_AtomicIncrement(&slot.readers, 1);
+    // Pairs with the barrier in writeAcquire(). Either the writer sees our
+    // increment or we see the writer.
+    subtle::MemoryBarrier();
+    if (LIKELY(subtle::Acquire_Load(&writer_state_) == NoWriter))
+      return;
+
+    subtle::Barrier_AtomicIncrement(&slot.readers, -1);
+    waitForWriter();
+  }
+}
+
+inline void BigReaderLock::readRelease() {
+  subtle::Barrier_AtomicIncrement(&currentSlot().readers, -1);
+}
+
+} // namespace stp
+
+#endif // STP_BASE_THREAD_BIGREADERLOCK_H_
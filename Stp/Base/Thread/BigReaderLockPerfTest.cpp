@@ -0,0 +1,147 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Thread/BigReaderLock.h"
+
+#include "Base/Memory/OwnPtr.h"
+#include "Base/Test/GTest.h"
+#include "Base/Test/PerfTest.h"
+#include "Base/Text/StringFormatMany.h"
+#include "Base/Thread/AtomicFlag.h"
+#include "Base/Thread/ReadMostly.h"
+#include "Base/Thread/ReadWriteLock.h"
+#include "Base/Thread/Thread.h"
+#include "Base/Time/TimeTicks.h"
+
+namespace stp {
+
+static const int ReadsPerThread = 1000000;
+static const int ReaderCounts[] = { 1, 2, 4, 8, 16 };
+
+// Typical read-mostly configuration entry.
+struct ConfigData {
+  int64_t version;
+  int32_t values[6];
+};
+
+// Adapters giving all contenders the same interface.
+
+class ReadWriteLockConfig {
+ public:
+  int32_t read() {
+    AutoReadLock guard(lock_);
+    return data_.values[0] + data_.values[5];
+  }
+  void write() {
+    AutoWriteLock guard(lock_);
+    data_.version++;
+  }
+
+ private:
+  ReadWriteLock lock_;
+  ConfigData data_ = {};
+};
+
+class BigReaderLockConfig {
+ public:
+  int32_t read() {
+    AutoBigReadLock guard(lock_);
+    return data_.values[0] + data_.values[5];
+  }
+  void write() {
+    AutoBigWriteLock guard(lock_);
+    data_.version++;
+  }
+
+ private:
+  BigReaderLock lock_;
+  ConfigData data_ = {};
+};
+
+class ReadMostlyConfig {
+ public:
+  int32_t read() {
+    ConfigData copy = data_.snapshot();
+    return copy.values[0] + copy.values[5];
+  }
+  void write() {
+    data_.update([](ConfigData& data) { data.version++; });
+  }
+
+ private:
+  ReadMostly<ConfigData> data_;
+};
+
+template<typename TConfig>
+class ConfigReaderThread : public Thread {
+ public:
+  explicit ConfigReaderThread(TConfig* config) : config_(*config) {}
+
+  int Main() override {
+    int32_t sum = 0;
+    for (int i = 0; i < ReadsPerThread; ++i)
+      sum += config_.read();
+    return sum;
+  }
+
+ private:
+  TConfig& config_;
+};
+
+// Writes occasionally until told to stop.
+template<typename TConfig>
+class ConfigWriterThread : public Thread {
+ public:
+  ConfigWriterThread(TConfig* config, AtomicFlag* stop)
+      : config_(*config), stop_(*stop) {}
+
+  int Main() override {
+    int writes = 0;
+    while (!stop_.IsSet()) {
+      config_.write();
+      ++writes;
+      ThisThread::SleepFor(TimeDelta::FromMilliseconds(1));
+    }
+    return writes;
+  }
+
+ private:
+  TConfig& config_;
+  AtomicFlag& stop_;
+};
+
+template<typename TConfig>
+static void runReadMostlyBenchmark(const String& trace_name) {
+  for (int reader_count : ReaderCounts) {
+    TConfig config;
+    AtomicFlag stop;
+
+    List<OwnPtr<ConfigReaderThread<TConfig>>> readers;
+    for (int i = 0; i < reader_count; ++i)
+      readers.add(OwnPtr<ConfigReaderThread<TConfig>>::create(&config));
+    ConfigWriterThread<TConfig> writer(&config, &stop);
+
+    writer.Start();
+    TimeTicks start = TimeTicks::Now();
+    for (auto& reader : readers)
+      reader->Start();
+    for (auto& reader : readers)
+      reader->Join();
+    double total_time_milliseconds = (TimeTicks::Now() - start).InMillisecondsF();
+    stop.Set();
+    writer.Join();
+
+    perf_test::PrintResult(
+        "read_mostly", stringFormatMany("_{}readers", reader_count), trace_name,
+        reader_count * ReadsPerThread / total_time_milliseconds,
+        "reads/ms", true);
+  }
+}
+
+TEST(BigReaderLockPerfTest, ReadThroughput) {
+  runReadMostlyBenchmark<ReadWriteLockConfig>("read_write_lock");
+  runReadMostlyBenchmark<BigReaderLockConfig>("big_reader_lock");
+  runReadMostlyBenchmark<ReadMostlyConfig>("read_mostly");
+}
+
+} // namespace stp
@@ -0,0 +1,154 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Thread/BigReaderLock.h"
+
+#include "Base/Test/GTest.h"
+#include "Base/Thread/Thread.h"
+#include "Base/Thread/WaitableEvent.h"
+
+namespace stp {
+
+class ReaderBigReaderLockTestThread : public Thread {
+ public:
+  explicit ReaderBigReaderLockTestThread(BigReaderLock* lock) : lock_(lock) {}
+
+  int Main() override {
+    AutoBigReadLock locker(*lock_);
+    did_acquire_ = true;
+    return 0;
+  }
+
+  bool didAcquire() const { return did_acquire_; }
+
+ private:
+  BigReaderLock* lock_;
+  bool did_acquire_ = false;
+};
+
+// Tests that reader locks allow multiple simultaneous reader acquisitions.
+TEST(BigReaderLockTest, ReaderTwoThreads) {
+  BigReaderLock lock;
+
+  AutoBigReadLock auto_lock(lock);
+
+  ReaderBigReaderLockTestThread thread(&lock);
+  thread.Start();
+  thread.Join();
+  EXPECT_TRUE(thread.didAcquire());
+}
+
+class WriterBigReaderLockTestThread : public Thread {
+ public:
+  WriterBigReaderLockTestThread(BigReaderLock* lock, int* value)
+      : lock_(lock),
+        value_(value),
+        event_(WaitableEvent::ResetPolicy::Manual,
+               WaitableEvent::InitialState::NotSignaled) {}
+
+  int Main() override {
+    AutoBigWriteLock locker(*lock_);
+    (*value_)++;
+    event_.Signal();
+    return 0;
+  }
+
+  void wait() { event_.Wait(); }
+
+ private:
+  BigReaderLock* lock_;
+  int* value_;
+  WaitableEvent event_;
+};
+
+static void testWriterExcludesReaders(BigReaderLock::Preference preference) {
+  BigReaderLock lock(preference);
+  int value = 0;
+
+  WriterBigReaderLockTestThread thread(&lock, &value);
+  {
+    AutoBigReadLock read_locker(lock);
+    thread.Start();
+
+    ThisThread::SleepFor(TimeDelta::FromMilliseconds(10));
+
+    // |value| should be unchanged since we hold a reader lock.
+    EXPECT_EQ(0, value);
+  }
+
+  thread.wait();
+  EXPECT_EQ(1, value);
+  thread.Join();
+}
+
+// Tests that writer locks exclude reader locks.
+TEST(BigReaderLockTest, ReadAndWriteThreads) {
+  testWriterExcludesReaders(BigReaderLock::Preference::Writer);
+  testWriterExcludesReaders(BigReaderLock::Preference::Reader);
+}
+
+// Readers verify an invariant which writers break temporarily.
+struct BigReaderLockTestData {
+  int a = 0;
+  int b = 0;
+};
+
+class MixedBigReaderLockTestThread : public Thread {
+ public:
+  MixedBigReaderLockTestThread(BigReaderLock* lock, BigReaderLockTestData* data, bool writer)
+      : lock_(lock), data_(data), writer_(writer) {}
+
+  int Main() override {
+    for (int i = 0; i < 2000; ++i) {
+      if (writer_ && i % 16 == 0) {
+        AutoBigWriteLock locker(*lock_);
+        data_->a++;
+        ThisThread::Yield();
+        data_->b++;
+      } else {
+        AutoBigReadLock locker(*lock_);
+        EXPECT_EQ(data_->a, data_->b);
+      }
+    }
+    return 0;
+  }
+
+ private:
+  BigReaderLock* lock_;
+  BigReaderLockTestData* data_;
+  bool writer_;
+
+  DISALLOW_COPY_AND_ASSIGN(MixedBigReaderLockTestThread);
+};
+
+static void testManyThreads(BigReaderLock::Preference preference) {
+  BigReaderLock lock(preference);
+  BigReaderLockTestData data;
+
+  MixedBigReaderLockTestThread reader1(&lock, &data, false);
+  MixedBigReaderLockTestThread reader2(&lock, &data, false);
+  MixedBigReaderLockTestThread reader3(&lock, &data, false);
+  MixedBigReaderLockTestThread writer1(&lock, &data, true);
+  MixedBigReaderLockTestThread writer2(&lock, &data, true);
+  reader1.Start();
+  reader2.Start();
+  reader3.Start();
+  writer1.Start();
+  writer2.Start();
+
+  reader1.Join();
+  reader2.Join();
+  reader3.Join();
+  writer1.Join();
+  writer2.Join();
+
+  EXPECT_EQ(2 * 2000 / 16, data.a);
+  EXPECT_EQ(data.a, data.b);
+}
+
+TEST(BigReaderLockTest, ManyThreads) {
+  testManyThreads(BigReaderLock::Preference::Writer);
+  testManyThreads(BigReaderLock::Preference::Reader);
+}
+
+} // namespace stp
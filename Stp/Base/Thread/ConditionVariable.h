@@ -64,6 +64,8 @@
 
 #if OS(WIN)
 #include "Base/Win/WindowsHeader.h"
+#elif OS(LINUX)
+#include "Base/Thread/AtomicOps.h"
 #elif OS(POSIX)
 #include <pthread.h>
 #endif
@@ -96,6 +98,10 @@ class BASE_EXPORT ConditionVariable {
   #if OS(WIN)
   CONDITION_VARIABLE cv_;
   SRWLOCK* const srwlock_;
+  #elif OS(LINUX)
+  // Futex word bumped on every Signal() and Broadcast().
+  subtle::Atomic32 sequence_;
+  NativeLockObject* user_mutex_;
   #elif OS(POSIX)
   pthread_cond_t condition_;
   pthread_mutex_t* user_mutex_;
@@ -0,0 +1,81 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Thread/ConditionVariable.h"
+
+#include "Base/Thread/Futex.h"
+#include "Base/Time/TimeDelta.h"
+
+// Futex-based condition variable.
+//
+// Waiters sample the sequence number while still holding the user lock and
+// sleep on it after the lock is released. Any Signal() or Broadcast() issued
+// after the lock was released bumps the sequence, so the kernel refuses to put
+// the waiter to sleep (or wakes it up). Thus no signal can be lost.
+//
+// Broadcast() wakes up all waiters which then compete for the user lock.
+// Requeuing them onto the lock futex would save some wake-ups, but requires
+// the lock to be marked as contended in advance, which we do not want to
+// impose on the fast path of the lock. See usage note 2 in the header.
+
+namespace stp {
+
+ConditionVariable::ConditionVariable(BasicLock* user_lock)
+    : sequence_(0),
+      user_mutex_(&user_lock->native_object_)
+    #if ASSERT_IS_ON
+    , user_lock_(user_lock)
+    #endif
+{
+}
+
+ConditionVariable::~ConditionVariable() {
+}
+
+void ConditionVariable::Wait() {
+  subtle::Atomic32 sequence = subtle::NoBarrier_Load(&sequence_);
+
+  #if ASSERT_IS_ON
+  user_lock_->checkHeldAndUnmark();
+  #endif
+  NativeLock::release(user_mutex_);
+
+  Futex::wait(&sequence_, sequence);
+
+  NativeLock::acquire(user_mutex_);
+  #if ASSERT_IS_ON
+  user_lock_->checkUnheldAndMark();
+  #endif
+}
+
+void ConditionVariable::TimedWait(TimeDelta max_time) {
+  // Futex timeout is relative and measured against CLOCK_MONOTONIC.
+  struct timespec relative_time = max_time.toTimespec();
+
+  subtle::Atomic32 sequence = subtle::NoBarrier_Load(&sequence_);
+
+  #if ASSERT_IS_ON
+  user_lock_->checkHeldAndUnmark();
+  #endif
+  NativeLock::release(user_mutex_);
+
+  if (TimeDelta() < max_time)
+    Futex::wait(&sequence_, sequence, &relative_time);
+
+  NativeLock::acquire(user_mutex_);
+  #if ASSERT_IS_ON
+  user_lock_->checkUnheldAndMark();
+  #endif
+}
+
+void ConditionVariable::Broadcast() {
+  subtle::Barrier_AtomicIncrement(&sequence_, 1);
+  Futex::wakeAll(&sequence_);
+}
+
+void ConditionVariable::Signal() {
+  subtle::Barrier_AtomicIncrement(&sequence_, 1);
+  Futex::wakeOne(&sequence_);
+}
+
+} // namespace stp
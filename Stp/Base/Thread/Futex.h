@@ -0,0 +1,64 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#ifndef STP_BASE_THREAD_FUTEX_H_
+#define STP_BASE_THREAD_FUTEX_H_
+
+#include "Base/Compiler/Os.h"
+#include "Base/Debug/Assert.h"
+#include "Base/Thread/AtomicOps.h"
+
+#if !OS(LINUX)
+#error "futexes are available on Linux only"
+#endif
+
+#include <errno.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace stp {
+
+// Thin wrappers around futex(2) system call.
+// Private (process local) variants are used since all our primitives live
+// within single address space - this avoids a lookup of the backing page in kernel.
+class Futex {
+  STATIC_ONLY(Futex);
+ public:
+  // Sleeps while |*address| equals |expected|.
+  // |relative_timeout| is measured against CLOCK_MONOTONIC; nullptr means no timeout.
+  // Returns false on timeout, true otherwise (woken, value mismatch or interrupted).
+  // Callers must always recheck the condition they wait for.
+  static bool wait(
+      volatile subtle::Atomic32* address, subtle::Atomic32 expected,
+      const struct timespec* relative_timeout = nullptr);
+
+  // Wakes at most |count| threads sleeping on |address|.
+  // Returns the number of woken threads.
+  static int wake(volatile subtle::Atomic32* address, int count);
+
+  static int wakeOne(volatile subtle::Atomic32* address) { return wake(address, 1); }
+  static int wakeAll(volatile subtle::Atomic32* address) { return wake(address, INT_MAX); }
+};
+
+inline bool Futex::wait(
+    volatile subtle::Atomic32* address, subtle::Atomic32 expected,
+    const struct timespec* relative_timeout) {
+  long rv = syscall(
+      SYS_futex, address, FUTEX_WAIT_PRIVATE, expected, relative_timeout, nullptr, 0);
+  ASSERT(rv == 0 || errno == EAGAIN || errno == EINTR || errno == ETIMEDOUT);
+  return rv == 0 || errno != ETIMEDOUT;
+}
+
+inline int Futex::wake(volatile subtle::Atomic32* address, int count) {
+  // Waking may race with destruction of the object holding the futex word
+  // (after the store which released it). Kernel handles that gracefully.
+  long rv = syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+  return rv > 0 ? static_cast<int>(rv) : 0;
+}
+
+} // namespace stp
+
+#endif // STP_BASE_THREAD_FUTEX_H_
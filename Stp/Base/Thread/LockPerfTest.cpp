@@ -0,0 +1,207 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Thread/Lock.h"
+
+#include "Base/Memory/OwnPtr.h"
+#include "Base/Test/GTest.h"
+#include "Base/Test/PerfTest.h"
+#include "Base/Text/StringFormatMany.h"
+#include "Base/Thread/ConditionVariable.h"
+#include "Base/Thread/Thread.h"
+#include "Base/Time/TimeTicks.h"
+
+#if OS(POSIX)
+#include <pthread.h>
+#endif
+
+namespace stp {
+
+static const int LockIterationsPerThread = 200000;
+static const int ThreadCounts[] = { 2, 4, 8, 16, 32, 64 };
+
+#if OS(POSIX)
+// Plain pthread mutex, the reference the native lock is compared against.
+class PthreadMutex {
+ public:
+  PthreadMutex() { pthread_mutex_init(&mutex_, nullptr); }
+  ~PthreadMutex() { pthread_mutex_destroy(&mutex_); }
+
+  void acquire() { pthread_mutex_lock(&mutex_); }
+  void release() { pthread_mutex_unlock(&mutex_); }
+
+ private:
+  pthread_mutex_t mutex_;
+};
+#endif
+
+template<typename TLock>
+class LockContentionThread : public Thread {
+ public:
+  LockContentionThread(TLock* lock, int64_t* counter)
+      : lock_(*lock), counter_(*counter) {}
+
+  int Main() override {
+    for (int i = 0; i < LockIterationsPerThread; ++i) {
+      lock_.acquire();
+      // Some work within critical section to make it realistic.
+      for (int j = 0; j < 8; ++j)
+        ++counter_;
+      lock_.release();
+    }
+    return 0;
+  }
+
+ private:
+  TLock& lock_;
+  int64_t& counter_;
+};
+
+template<typename TLock>
+static void runLockContentionBenchmark(const String& trace_name) {
+  for (int thread_count : ThreadCounts) {
+    TLock lock;
+    int64_t counter = 0;
+
+    List<OwnPtr<LockContentionThread<TLock>>> threads;
+    for (int i = 0; i < thread_count; ++i)
+      threads.add(OwnPtr<LockContentionThread<TLock>>::create(&lock, &counter));
+
+    TimeTicks start = TimeTicks::Now();
+    for (auto& thread : threads)
+      thread->Start();
+    for (auto& thread : threads)
+      thread->Join();
+    double total_time_milliseconds = (TimeTicks::Now() - start).InMillisecondsF();
+
+    EXPECT_EQ(int64_t(8) * thread_count * LockIterationsPerThread, counter);
+
+    perf_test::PrintResult(
+        "lock_contention", stringFormatMany("_{}threads", thread_count), trace_name,
+        thread_count * LockIterationsPerThread / total_time_milliseconds,
+        "acquisitions/ms", true);
+  }
+}
+
+TEST(LockPerfTest, Contention) {
+  #if OS(LINUX)
+  NativeLock::resetContentionStats();
+  #endif
+
+  runLockContentionBenchmark<Lock>("lock");
+
+  #if OS(LINUX)
+  auto stats = NativeLock::getContentionStats();
+  perf_test::PrintResult(
+      "lock_contention", "_stats", "slow_acquisitions",
+      static_cast<size_t>(stats.slow_acquisitions), "count", false);
+  perf_test::PrintResult(
+      "lock_contention", "_stats", "spin_acquisitions",
+      static_cast<size_t>(stats.spin_acquisitions), "count", false);
+  perf_test::PrintResult(
+      "lock_contention", "_stats", "parks",
+      static_cast<size_t>(stats.parks), "count", false);
+  #endif
+
+  #if OS(POSIX)
+  runLockContentionBenchmark<PthreadMutex>("pthread_mutex");
+  #endif
+}
+
+// Two threads handing a token back and forth through a condition variable.
+static const int PingPongRounds = 100000;
+
+// Lock and ConditionVariable behind the interface the ping-pong uses.
+class LockCondition {
+ public:
+  LockCondition() : cv_(&lock_) {}
+
+  void acquire() { lock_.acquire(); }
+  void release() { lock_.release(); }
+  void wait() { cv_.Wait(); }
+  void signal() { cv_.Signal(); }
+
+ private:
+  Lock lock_;
+  ConditionVariable cv_;
+};
+
+#if OS(POSIX)
+// Plain pthread mutex and condition variable, the reference the native
+// condition variable is compared against.
+class PthreadCondition {
+ public:
+  PthreadCondition() {
+    pthread_mutex_init(&mutex_, nullptr);
+    pthread_cond_init(&cond_, nullptr);
+  }
+  ~PthreadCondition() {
+    pthread_cond_destroy(&cond_);
+    pthread_mutex_destroy(&mutex_);
+  }
+
+  void acquire() { pthread_mutex_lock(&mutex_); }
+  void release() { pthread_mutex_unlock(&mutex_); }
+  void wait() { pthread_cond_wait(&cond_, &mutex_); }
+  void signal() { pthread_cond_signal(&cond_); }
+
+ private:
+  pthread_mutex_t mutex_;
+  pthread_cond_t cond_;
+};
+#endif
+
+template<typename TCondition>
+class PingPongThread : public Thread {
+ public:
+  PingPongThread(TCondition* condition, int* turn, int self)
+      : condition_(*condition), turn_(*turn), self_(self) {}
+
+  int Main() override {
+    for (int i = 0; i < PingPongRounds; ++i) {
+      condition_.acquire();
+      while (turn_ != self_)
+        condition_.wait();
+      turn_ = 1 - self_;
+      condition_.signal();
+      condition_.release();
+    }
+    return 0;
+  }
+
+ private:
+  TCondition& condition_;
+  int& turn_;
+  int self_;
+};
+
+template<typename TCondition>
+static void runPingPongBenchmark(const String& trace_name) {
+  TCondition condition;
+  int turn = 0;
+
+  PingPongThread<TCondition> ping(&condition, &turn, 0);
+  PingPongThread<TCondition> pong(&condition, &turn, 1);
+
+  TimeTicks start = TimeTicks::Now();
+  ping.Start();
+  pong.Start();
+  ping.Join();
+  pong.Join();
+  double total_time_milliseconds = (TimeTicks::Now() - start).InMillisecondsF();
+
+  perf_test::PrintResult(
+      "condition_variable", "_ping_pong", trace_name,
+      PingPongRounds / total_time_milliseconds,
+      "rounds/ms", true);
+}
+
+TEST(LockPerfTest, ConditionVariablePingPong) {
+  runPingPongBenchmark<LockCondition>("lock");
+
+  #if OS(POSIX)
+  runPingPongBenchmark<PthreadCondition>("pthread_cond");
+  #endif
+}
+
+} // namespace stp
@@ -3,6 +3,7 @@
 
 #include "Base/Thread/Lock.h"
 
+#include "Base/Memory/OwnPtr.h"
 #include "Base/Test/GTest.h"
 #include "Base/Thread/Thread.h"
 
@@ -191,4 +192,43 @@ TEST(LockTest, MutexFourThreads) {
   EXPECT_EQ(4 * 40, value);
 }
 
+class ContendedLockTestThread : public Thread {
+ public:
+  ContendedLockTestThread(Lock* lock, int* value) : lock_(lock), value_(value) {}
+
+  int Main() override {
+    for (int i = 0; i < 10000; i++) {
+      lock_->acquire();
+      int v = *value_;
+      *value_ = v + 1;
+      lock_->release();
+    }
+    return 0;
+  }
+
+ private:
+  Lock* lock_;
+  int* value_;
+
+  DISALLOW_COPY_AND_ASSIGN(ContendedLockTestThread);
+};
+
+// Short critical sections with many threads exercise spinning and parking
+// paths of the lock.
+TEST(LockTest, HighContention) {
+  Lock lock;
+  int value = 0;
+
+  constexpr int NumThreads = 16;
+  OwnPtr<ContendedLockTestThread> threads[NumThreads];
+  for (int i = 0; i < NumThreads; ++i)
+    threads[i] = OwnPtr<ContendedLockTestThread>::create(&lock, &value);
+  for (int i = 0; i < NumThreads; ++i)
+    threads[i]->Start();
+  for (int i = 0; i < NumThreads; ++i)
+    threads[i]->Join();
+
+  EXPECT_EQ(NumThreads * 10000, value);
+}
+
 } // namespace stp
@@ -9,6 +9,8 @@
 
 #if OS(WIN)
 #include "Base/Win/WindowsHeader.h"
+#elif OS(LINUX)
+#include "Base/Thread/AtomicOps.h"
 #elif OS(POSIX)
 #include <errno.h>
 #include <pthread.h>
@@ -19,6 +21,9 @@ namespace stp {
 #if OS(WIN)
 // SRWLOCK is generally faster than CRITICAL_SECTION.
 using NativeLockObject = SRWLOCK;
+#elif OS(LINUX)
+// Futex word, see NativeLock::LockState.
+using NativeLockObject = subtle::Atomic32;
 #elif OS(POSIX)
 using NativeLockObject = pthread_mutex_t;
 #endif
@@ -31,6 +36,34 @@ class NativeLock {
   static bool tryAcquire(NativeLockObject* object);
   static void acquire(NativeLockObject* object);
   static void release(NativeLockObject* object);
+
+  #if OS(LINUX)
+  enum LockState : subtle::Atomic32 {
+    Unlocked = 0,
+    // Held by some thread, nobody sleeps on the futex.
+    Locked = 1,
+    // Held by some thread, others might sleep on the futex.
+    LockedWithWaiters = 2,
+  };
+
+  // Counters gathered on contended (slow) paths, process-wide.
+  struct ContentionStats {
+    // Number of acquisitions which missed the uncontended fast path.
+    int64_t slow_acquisitions;
+    // Number of acquisitions which succeeded while spinning.
+    int64_t spin_acquisitions;
+    // Number of times a thread went to sleep in kernel.
+    int64_t parks;
+    // Number of futex wake-ups issued by release().
+    int64_t wakes;
+  };
+
+  BASE_EXPORT static ContentionStats getContentionStats();
+  BASE_EXPORT static void resetContentionStats();
+
+  BASE_EXPORT static void acquireSlow(NativeLockObject* object);
+  BASE_EXPORT static void releaseSlow(NativeLockObject* object);
+  #endif
 };
 
 #if OS(WIN)
@@ -55,6 +88,37 @@ inline void NativeLock::release(NativeLockObject* object) {
   ::ReleaseSRWLockExclusive(object);
 }
 
+#elif OS(LINUX)
+
+// Adaptive futex-based mutex, see "Futexes Are Tricky" by Ulrich Drepper.
+// The uncontended paths are a single atomic instruction and never enter
+// the kernel. Contended acquisition spins for a short while before parking.
+
+#define NATIVE_LOCK_INITIALIZER 0
+
+inline void NativeLock::init(NativeLockObject* object) {
+  *object = Unlocked;
+}
+
+inline void NativeLock::fini(NativeLockObject* object) {
+  ASSERT(subtle::NoBarrier_Load(object) == Unlocked);
+}
+
+inline bool NativeLock::tryAcquire(NativeLockObject* object) {
+  return subtle::Acquire_CompareAndSwap(object, Unlocked, Locked) == Unlocked;
+}
+
+inline void NativeLock::acquire(NativeLockObject* object) {
+  if (UNLIKELY(!tryAcquire(object)))
+    acquireSlow(object);
+}
+
+inline void NativeLock::release(NativeLockObject* object) {
+  // Fast path: no waiters to wake up.
+  if (UNLIKELY(subtle::Release_CompareAndSwap(object, Locked, Unlocked) != Locked))
+    releaseSlow(object);
+}
+
 #elif OS(POSIX)
 
 #define NATIVE_LOCK_INITIALIZER PTHREAD_MUTEX_INITIALIZER
@@ -0,0 +1,98 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Thread/NativeLock.h"
+
+#include "Base/Thread/Futex.h"
+#include "Base/Thread/YieldProcessor.h"
+
+namespace stp {
+
+namespace {
+
+// Spinning pays off only for short critical sections - when the owner is
+// about to release the lock. The number of tries is roughly the cost of
+// a futex syscall pair (sleep + wake-up) expressed in pause instructions.
+constexpr int SpinTries = 100;
+
+// Counters are updated on slow paths only, so they do not disturb
+// uncontended acquisitions. Kept on their own cache line.
+struct alignas(64) ContentionCounters {
+  subtle::AtomicWord slow_acquisitions;
+  subtle::AtomicWord spin_acquisitions;
+  subtle::AtomicWord parks;
+  subtle::AtomicWord wakes;
+};
+
+ContentionCounters g_contention;
+
+inline void bumpCounter(subtle::AtomicWord* counter) {
+  subtle::NoBarrier_AtomicIncrement(counter, 1);
+}
+
+} // namespace
+
+void NativeLock::acquireSlow(NativeLockObject* object) {
+  bumpCounter(&g_contention.slow_acquisitions);
+
+  // Spin while the lock is held and nobody sleeps on it.
+  // Once there are sleepers the owner will hand the lock to one of them
+  // anyway, so further spinning would only burn CPU.
+  for (int i = 0; i < SpinTries; ++i) {
+    subtle::Atomic32 state = subtle::NoBarrier_Load(object);
+    if (state == Unlocked) {
+      if (tryAcquire(object)) {
+        bumpCounter(&g_contention.spin_acquisitions);
+        return;
+      }
+    } else if (state == LockedWithWaiters) {
+      break;
+    }
+    YIELD_PROCESSOR;
+  }
+
+  // Park until the lock is released. Whenever we take the lock from here on
+  // it is marked as contended since other threads might still sleep on it.
+  subtle::Atomic32 state = subtle::NoBarrier_Load(object);
+  for (;;) {
+    if (state == Unlocked) {
+      state = subtle::Acquire_CompareAndSwap(object, Unlocked, LockedWithWaiters);
+      if (state == Unlocked)
+        return;
+      continue;
+    }
+    if (state == Locked) {
+      state = subtle::NoBarrier_CompareAndSwap(object, Locked, LockedWithWaiters);
+      if (state != Locked)
+        continue;
+    }
+    bumpCounter(&g_contention.parks);
+    Futex::wait(object, LockedWithWaiters);
+    state = subtle::NoBarrier_Load(object);
+  }
+}
+
+void NativeLock::releaseSlow(NativeLockObject* object) {
+  ASSERT(subtle::NoBarrier_Load(object) == LockedWithWaiters);
+  subtle::Release_Store(object, Unlocked);
+  bumpCounter(&g_contention.wakes);
+  Futex::wakeOne(object);
+}
+
+NativeLock::ContentionStats NativeLock::getContentionStats() {
+  ContentionStats stats;
+  stats.slow_acquisitions = subtle::NoBarrier_Load(&g_contention.slow_acquisitions);
+  stats.spin_acquisitions = subtle::NoBarrier_Load(&g_contention.spin_acquisitions);
+  stats.parks = subtle::NoBarrier_Load(&g_contention.parks);
+  stats.wakes = subtle::NoBarrier_Load(&g_contention.wakes);
+  return stats;
+}
+
+void NativeLock::resetContentionStats() {
+  subtle::NoBarrier_Store(&g_contention.slow_acquisitions, 0);
+  subtle::NoBarrier_Store(&g_contention.spin_acquisitions, 0);
+  subtle::NoBarrier_Store(&g_contention.parks, 0);
+  subtle::NoBarrier_Store(&g_contention.wakes, 0);
+}
+
+} // namespace stp
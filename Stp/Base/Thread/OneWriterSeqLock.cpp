@@ -10,7 +10,8 @@ namespace stp {
 subtle::Atomic32 BasicOneWriterSeqLock::ReadBegin() {
   subtle::Atomic32 version;
   for (;;) {
-    version = subtle::NoBarrier_Load(&sequence_);
+    // Acquire so the reads of protected data are not hoisted above.
+    version = subtle::Acquire_Load(&sequence_);
 
     // If the counter is even, then the associated data might be in a
     // consistent state, so we can try to read.
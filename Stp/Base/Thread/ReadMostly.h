@@ -0,0 +1,82 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#ifndef STP_BASE_THREAD_READMOSTLY_H_
+#define STP_BASE_THREAD_READMOSTLY_H_
+
+#include "Base/Thread/Lock.h"
+#include "Base/Thread/OneWriterSeqLock.h"
+#include "Base/Type/Variable.h"
+
+namespace stp {
+
+// Holds a small value which is read very often and published rarely.
+//
+// Readers take a consistent snapshot (a copy) of the value without
+// writing to any shared memory, so they scale with the number of cores.
+// Writers publish a new value; they are serialized by an internal lock
+// and readers racing with a publication retry their copy.
+//
+// Since a reader may observe a half-written value (which is then discarded),
+// the type must be trivially copyable. Wrap larger data in a structure
+// with a version or use BigReaderLock.
+template<typename T>
+class ReadMostly {
+  static_assert(TIsTriviallyCopyable<T>, "ReadMostly requires trivially copyable type");
+ public:
+  ReadMostly() : value_() {}
+  explicit ReadMostly(const T& initial) : value_(initial) {}
+
+  // Returns a consistent copy of the most recently published value.
+  T snapshot() const;
+
+  // Replaces the value. Readers will see either old or new value, never a mix.
+  void publish(const T& value);
+
+  // Atomically (with respect to other writers) applies |updater| to a copy
+  // of current value and publishes the result.
+  template<typename TUpdater>
+  void update(TUpdater&& updater);
+
+ private:
+  mutable OneWriterSeqLock seqlock_;
+  Lock writer_lock_;
+  T value_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReadMostly);
+};
+
+template<typename T>
+inline T ReadMostly<T>::snapshot() const {
+  T copy;
+  subtle::Atomic32 version;
+  do {
+    version = seqlock_.ReadBegin();
+    copy = value_;
+  } while (seqlock_.ReadRetry(version));
+  return copy;
+}
+
+template<typename T>
+inline void ReadMostly<T>::publish(const T& value) {
+  AutoLock guard(borrow(writer_lock_));
+  seqlock_.WriteBegin();
+  value_ = value;
+  seqlock_.WriteEnd();
+}
+
+template<typename T>
+template<typename TUpdater>
+inline void ReadMostly<T>::update(TUpdater&& updater) {
+  AutoLock guard(borrow(writer_lock_));
+  // We are the only writer, so the value can be read without the seqlock.
+  T copy = value_;
+  updater(copy);
+  seqlock_.WriteBegin();
+  value_ = copy;
+  seqlock_.WriteEnd();
+}
+
+} // namespace stp
+
+#endif // STP_BASE_THREAD_READMOSTLY_H_
@@ -0,0 +1,83 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Thread/ReadMostly.h"
+
+#include "Base/Test/GTest.h"
+#include "Base/Thread/Thread.h"
+
+namespace stp {
+
+struct ReadMostlyTestData {
+  int a, b, c;
+};
+
+TEST(ReadMostlyTest, Basic) {
+  ReadMostly<ReadMostlyTestData> data(ReadMostlyTestData { 1, 2, 3 });
+
+  ReadMostlyTestData copy = data.snapshot();
+  EXPECT_EQ(1, copy.a);
+  EXPECT_EQ(2, copy.b);
+  EXPECT_EQ(3, copy.c);
+
+  data.publish(ReadMostlyTestData { 4, 5, 6 });
+  copy = data.snapshot();
+  EXPECT_EQ(4, copy.a);
+  EXPECT_EQ(6, copy.c);
+
+  data.update([](ReadMostlyTestData& value) { value.b = 10; });
+  copy = data.snapshot();
+  EXPECT_EQ(4, copy.a);
+  EXPECT_EQ(10, copy.b);
+}
+
+class ReadMostlyTestThread : public Thread {
+ public:
+  ReadMostlyTestThread(ReadMostly<ReadMostlyTestData>* data, bool writer)
+      : data_(data), writer_(writer) {}
+
+  int Main() override {
+    for (int i = 0; i < 1000; ++i) {
+      if (writer_) {
+        data_->update([](ReadMostlyTestData& value) {
+          value.a++;
+          value.b = value.a + 100;
+          value.c = value.b + value.a;
+        });
+      } else {
+        ReadMostlyTestData copy = data_->snapshot();
+        EXPECT_EQ(copy.a + 100, copy.b);
+        EXPECT_EQ(copy.c, copy.b + copy.a);
+      }
+    }
+    return 0;
+  }
+
+ private:
+  ReadMostly<ReadMostlyTestData>* data_;
+  bool writer_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReadMostlyTestThread);
+};
+
+TEST(ReadMostlyTest, ManyThreads) {
+  ReadMostly<ReadMostlyTestData> data(ReadMostlyTestData { 0, 100, 100 });
+
+  ReadMostlyTestThread reader1(&data, false);
+  ReadMostlyTestThread reader2(&data, false);
+  ReadMostlyTestThread writer1(&data, true);
+  ReadMostlyTestThread writer2(&data, true);
+  reader1.Start();
+  reader2.Start();
+  writer1.Start();
+  writer2.Start();
+
+  reader1.Join();
+  reader2.Join();
+  writer1.Join();
+  writer2.Join();
+
+  EXPECT_EQ(2000, data.snapshot().a);
+}
+
+} // namespace stp
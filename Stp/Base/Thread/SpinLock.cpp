@@ -6,33 +6,12 @@
 #include "Base/Thread/SpinLock.h"
 
 #include "Base/Thread/NativeThread.h"
+#include "Base/Thread/YieldProcessor.h"
 
-#if OS(WIN)
-#include "Base/Win/WindowsHeader.h"
-#elif OS(POSIX)
+#if OS(POSIX)
 #include <sched.h>
 #endif
 
-// The YIELD_PROCESSOR macro wraps an architecture specific-instruction that
-// informs the processor we're in a busy wait, so it can handle the branch more
-// intelligently and e.g. reduce power to our core or give more resources to the
-// other hyper-thread on this core. See the following for context:
-// https://software.intel.com/en-us/articles/benefitting-power-and-performance-sleep-loops
-#if OS(WIN)
-# define YIELD_PROCESSOR YieldProcessor()
-#elif COMPILER(GCC) || COMPILER(CLANG)
-# if CPU(X86_64) || CPU(X86_32)
-#  define YIELD_PROCESSOR __asm__ __volatile__("pause")
-# elif CPU(ARM32) || CPU(ARM64)
-#  define YIELD_PROCESSOR __asm__ __volatile__("yield")
-# endif
-#endif
-
-#ifndef YIELD_PROCESSOR
-# warning "Processor yield not supported on this architecture."
-# define YIELD_PROCESSOR ((void)0)
-#endif
-
 namespace stp {
 
 void BasicSpinLock::AcquireSlow() {
@@ -0,0 +1,115 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Geometry/Affine.h"
+
+#include "Base/Containers/List.h"
+#include "Base/Test/GTest.h"
+#include "Base/Test/PerfTest.h"
+#include "Base/Time/TimeTicks.h"
+#include "Base/Util/Random.h"
+#include "Base/Util/RandomUtil.h"
+#include "Geometry/Bounds2.h"
+
+namespace stp {
+
+namespace {
+
+constexpr int XformCount = 1024;
+constexpr int PointCount = 64 * 1024;
+constexpr int Iterations = 200;
+
+class AffinePerfTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    for (int i = 0; i < XformCount; ++i) {
+      Affine xform = Affine::Identity();
+      xform.SetRotate(nextFloat() * 6, nextFloat() * 100, nextFloat() * 100);
+      xform.Concat(Affine::MakeScale(nextFloat() + 0.5f, nextFloat() + 0.5f));
+      xforms_.add(xform);
+    }
+    for (int i = 0; i < PointCount; ++i) {
+      Point2 point(nextFloat() * 1000, nextFloat() * 1000);
+      points_.add(point);
+      bounds_.add(Bounds2(point, point + Vector2(nextFloat() * 50, nextFloat() * 50)));
+    }
+  }
+
+  float nextFloat() { return RandomUtil::NextUnitFloat(random_); }
+
+  List<Affine> xforms_;
+  List<Point2> points_;
+  List<Bounds2> bounds_;
+  Random random_;
+};
+
+} // namespace
+
+TEST_F(AffinePerfTest, Concat) {
+  Affine result = Affine::Identity();
+  TimeTicks start = TimeTicks::Now();
+  for (int n = 0; n < Iterations; ++n) {
+    for (int i = 0; i + 1 < XformCount; ++i)
+      result.SetConcat(xforms_[i], xforms_[i + 1]);
+  }
+  perf_test::PrintThroughput(
+      "concat", "", "affine", static_cast<double>(Iterations) * (XformCount - 1),
+      TimeTicks::Now() - start, "Mops/s", true);
+  EXPECT_FALSE(result.IsIdentity());
+}
+
+TEST_F(AffinePerfTest, Invert) {
+  Affine result = Affine::Identity();
+  int invertible = 0;
+  TimeTicks start = TimeTicks::Now();
+  for (int n = 0; n < Iterations; ++n) {
+    for (int i = 0; i < XformCount; ++i)
+      invertible += xforms_[i].GetInverted(result);
+  }
+  perf_test::PrintThroughput(
+      "invert", "", "affine", static_cast<double>(Iterations) * XformCount,
+      TimeTicks::Now() - start, "Mops/s", true);
+  EXPECT_EQ(Iterations * XformCount, invertible);
+}
+
+TEST_F(AffinePerfTest, MapPoints) {
+  List<Point2> output;
+  Point2* output_data = output.appendUninitialized(PointCount);
+
+  Affine translate = Affine::MakeTranslate(10, 20);
+  Affine scale_translate = Affine::Identity();
+  scale_translate.SetScaleTranslate(2, 3, 10, 20);
+  struct {
+    const char* trace;
+    const Affine& xform;
+  } cases[] = {
+    { "translate", translate },
+    { "scale_translate", scale_translate },
+    { "affine", xforms_[0] },
+  };
+
+  for (const auto& test_case : cases) {
+    TimeTicks start = TimeTicks::Now();
+    for (int n = 0; n < Iterations / 10; ++n)
+      test_case.xform.MapPoints(output_data, points_.data(), PointCount);
+    perf_test::PrintThroughput(
+        "map_points", "", test_case.trace, static_cast<double>(Iterations / 10) * PointCount,
+        TimeTicks::Now() - start, "Mops/s", true);
+  }
+}
+
+TEST_F(AffinePerfTest, MapBounds) {
+  float sum = 0;
+  TimeTicks start = TimeTicks::Now();
+  for (int n = 0; n < Iterations / 10; ++n) {
+    const Affine& xform = xforms_[n];
+    for (const Bounds2& bounds : bounds_)
+      sum += xform.MapBounds(bounds).min.x;
+  }
+  perf_test::PrintThroughput(
+      "map_bounds", "", "affine", static_cast<double>(Iterations / 10) * PointCount,
+      TimeTicks::Now() - start, "Mops/s", true);
+  EXPECT_NE(0, sum);
+}
+
+} // namespace stp
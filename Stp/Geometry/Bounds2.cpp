@@ -3,6 +3,8 @@
 
 #include "Geometry/Bounds2.h"
 
+#include "Base/Simd/Vnx.h"
+
 namespace stp {
 
 Bounds2 RoundOut(const Bounds2& b) {
@@ -124,6 +126,73 @@ Bounds2 Bounds2::Enclose(const Point2 points[], int count) {
   return OfPointsTemplate<Bounds2>(points, count);
 }
 
+// Bulk operations below see IntBounds2 as 4 consecutive integers.
+static_assert(sizeof(IntBounds2) == 4 * sizeof(int32_t), "!");
+
+static inline const int32_t* AsInts(const IntBounds2* bounds) {
+  return reinterpret_cast<const int32_t*>(bounds);
+}
+
+IntBounds2 IntBounds2::UniteAll(Span<IntBounds2> bounds) {
+  constexpr int32_t Max = Limits<int32_t>::Max;
+  constexpr int32_t Min = Limits<int32_t>::Min;
+
+  const IntBounds2* data = bounds.data();
+  int count = bounds.size();
+
+  // Process 4 bounds at once with each coordinate in separate vector.
+  // Empty bounds are replaced by neutral values.
+  Vec4i min_x(Max), min_y(Max), max_x(Min), max_y(Min);
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    Vec4i x0, y0, x1, y1;
+    Vec4i::load4(AsInts(data + i), &x0, &y0, &x1, &y1);
+    Vec4i non_empty = (x1 > x0) & (y1 > y0);
+    min_x = Vec4i::min(min_x, Vec4i::ternary(non_empty, x0, Max));
+    min_y = Vec4i::min(min_y, Vec4i::ternary(non_empty, y0, Max));
+    max_x = Vec4i::max(max_x, Vec4i::ternary(non_empty, x1, Min));
+    max_y = Vec4i::max(max_y, Vec4i::ternary(non_empty, y1, Min));
+  }
+
+  // Lanes which have seen no non-empty bounds are still empty and skipped by Unite().
+  IntBounds2 result(0, 0, 0, 0);
+  for (int k = 0; k < 4; ++k)
+    result.Unite(IntBounds2(min_x[k], min_y[k], max_x[k], max_y[k]));
+  for (; i < count; ++i)
+    result.Unite(data[i]);
+  return result;
+}
+
+IntBounds2 IntBounds2::IntersectAll(Span<IntBounds2> bounds) {
+  ASSERT(!bounds.isEmpty());
+  const IntBounds2* data = bounds.data();
+  int count = bounds.size();
+
+  // Minimum corner is in lower half of vector, maximum corner in upper half.
+  Vec4i lower = Vec4i::load(AsInts(data));
+  Vec4i upper = lower;
+  for (int i = 1; i < count; ++i) {
+    Vec4i v = Vec4i::load(AsInts(data + i));
+    lower = Vec4i::max(lower, v);
+    upper = Vec4i::min(upper, v);
+  }
+  return IntBounds2(lower[0], lower[1], upper[2], upper[3]);
+}
+
+void IntBounds2::ClipEach(Span<IntBounds2> bounds, const IntBounds2& clip, MutableSpan<IntBounds2> out) {
+  ASSERT(bounds.size() == out.size());
+  const IntBounds2* src = bounds.data();
+  int32_t* dst = reinterpret_cast<int32_t*>(out.data());
+  int count = bounds.size();
+
+  Vec4i clip_v = Vec4i::load(AsInts(&clip));
+  Vec4i lower_mask(-1, -1, 0, 0);
+  for (int i = 0; i < count; ++i) {
+    Vec4i v = Vec4i::load(AsInts(src + i));
+    Vec4i::ternary(lower_mask, Vec4i::max(v, clip_v), Vec4i::min(v, clip_v)).store(dst + i * 4);
+  }
+}
+
 void IntBounds2::ToFormat(TextWriter& out, const StringSpan& opts) const {
   out << min << max << ' ' << GetWidth() << 'x' << GetHeight();
 }
@@ -4,6 +4,7 @@
 #ifndef STP_BASE_GEOMETRY_BOUNDS2_H_
 #define STP_BASE_GEOMETRY_BOUNDS2_H_
 
+#include "Base/Containers/Span.h"
 #include "Base/Type/Variable.h"
 #include "Geometry/Vector2.h"
 
@@ -42,6 +43,18 @@ struct BASE_EXPORT IntBounds2 {
 
   static IntBounds2 Enclose(const IntPoint2 points[], int count);
 
+  // Returns union of all non-empty |bounds|, same as repeated Unite() would.
+  static IntBounds2 UniteAll(Span<IntBounds2> bounds);
+
+  // Returns common part of all |bounds| (at least one is required).
+  // Unlike TryIntersect() the result is given even if empty - check with isEmpty().
+  static IntBounds2 IntersectAll(Span<IntBounds2> bounds);
+
+  // Intersects each of |bounds| with |clip| and stores results in |out|.
+  // Bounds outside of |clip| become empty and possibly unsorted.
+  // |bounds| and |out| may be the same memory.
+  static void ClipEach(Span<IntBounds2> bounds, const IntBounds2& clip, MutableSpan<IntBounds2> out);
+
   void Inset(int dx, int dy);
   void Outset(int dx, int dy) { Inset(-dx, -dy); }
 
@@ -0,0 +1,99 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Geometry/Bounds2.h"
+
+#include "Base/Containers/List.h"
+#include "Base/Test/GTest.h"
+#include "Base/Test/PerfTest.h"
+#include "Base/Text/FormatMany.h"
+#include "Base/Time/TimeTicks.h"
+#include "Base/Util/Random.h"
+
+namespace stp {
+
+namespace {
+
+// Each measurement processes this many bounds in total, regardless of span size.
+constexpr int TotalCount = 16 * 1024 * 1024;
+
+class IntBounds2PerfTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    for (int i = 0; i < 1024 * 1024; ++i) {
+      IntPoint2 min(nextInt(4096) - 2048, nextInt(4096) - 2048);
+      // Some of bounds are empty.
+      bounds_.add(IntBounds2(min, min + IntVector2(nextInt(300) - 20, nextInt(300) - 20)));
+    }
+    out_.appendUninitialized(bounds_.size());
+  }
+
+  int nextInt(int range) { return static_cast<int>(random_.NextUInt32() % range); }
+
+  template<typename TBody>
+  void run(const char* operation, const char* trace, TBody body) {
+    for (int size = 64; size <= bounds_.size(); size *= 4) {
+      int iterations = TotalCount / size;
+      Span<IntBounds2> input = bounds_.slice(0, size);
+      MutableSpan<IntBounds2> output = out_.slice(0, size);
+
+      TimeTicks start = TimeTicks::Now();
+      for (int n = 0; n < iterations; ++n)
+        body(input, output);
+      perf_test::PrintThroughput(
+          operation, stringFormatMany("_{}", size), trace,
+          TotalCount, TimeTicks::Now() - start, "Mbounds/s", true);
+    }
+  }
+
+  List<IntBounds2> bounds_;
+  List<IntBounds2> out_;
+  Random random_;
+};
+
+} // namespace
+
+TEST_F(IntBounds2PerfTest, UniteAll) {
+  int sink = 0;
+  run("unite_all", "scalar", [&sink](Span<IntBounds2> input, MutableSpan<IntBounds2>) {
+    IntBounds2 result(0, 0, 0, 0);
+    for (const IntBounds2& bounds : input)
+      result.Unite(bounds);
+    sink += result.min.x;
+  });
+  run("unite_all", "simd", [&sink](Span<IntBounds2> input, MutableSpan<IntBounds2>) {
+    sink += IntBounds2::UniteAll(input).min.x;
+  });
+  EXPECT_NE(0, sink);
+}
+
+TEST_F(IntBounds2PerfTest, IntersectAll) {
+  int sink = 0;
+  run("intersect_all", "scalar", [&sink](Span<IntBounds2> input, MutableSpan<IntBounds2>) {
+    IntBounds2 result = input[0];
+    for (const IntBounds2& bounds : input) {
+      if (!result.TryIntersect(bounds))
+        result = IntBounds2(0, 0, 0, 0);
+    }
+    sink += result.max.x;
+  });
+  run("intersect_all", "simd", [&sink](Span<IntBounds2> input, MutableSpan<IntBounds2>) {
+    sink += IntBounds2::IntersectAll(input).max.x;
+  });
+}
+
+TEST_F(IntBounds2PerfTest, ClipEach) {
+  const IntBounds2 clip(-1000, -500, 1000, 500);
+  run("clip_each", "scalar", [&clip](Span<IntBounds2> input, MutableSpan<IntBounds2> output) {
+    for (int i = 0; i < input.size(); ++i) {
+      output[i] = input[i];
+      if (!output[i].TryIntersect(clip))
+        output[i] = IntBounds2(0, 0, 0, 0);
+    }
+  });
+  run("clip_each", "simd", [&clip](Span<IntBounds2> input, MutableSpan<IntBounds2> output) {
+    IntBounds2::ClipEach(input, clip, output);
+  });
+}
+
+} // namespace stp
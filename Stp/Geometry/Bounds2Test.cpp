@@ -0,0 +1,104 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Geometry/Bounds2.h"
+
+#include "Base/Containers/List.h"
+#include "Base/Test/GTest.h"
+#include "Base/Util/Random.h"
+
+namespace stp {
+
+namespace {
+
+// Random bounds with about quarter of them empty or unsorted.
+List<IntBounds2> MakeRandomBounds(int count, uint32_t seed) {
+  Random random(seed);
+  auto next = [&random](int range) {
+    return static_cast<int>(random.NextUInt32() % range) - range / 2;
+  };
+  List<IntBounds2> bounds;
+  for (int i = 0; i < count; ++i) {
+    IntPoint2 min(next(2000), next(2000));
+    IntPoint2 max = min + IntVector2(next(400) + 150, next(400) + 150);
+    bounds.add(IntBounds2(min, max));
+  }
+  return bounds;
+}
+
+} // namespace
+
+TEST(IntBounds2Test, UniteAll) {
+  EXPECT_TRUE(IntBounds2::UniteAll(Span<IntBounds2>()).isEmpty());
+
+  IntBounds2 single[] = { IntBounds2(1, 2, 5, 7) };
+  EXPECT_EQ(single[0], IntBounds2::UniteAll(single));
+
+  IntBounds2 with_empty[] = {
+    IntBounds2(0, 0, 10, 10),
+    IntBounds2(-100, -100, -100, 50),
+    IntBounds2(5, 5, 20, 15),
+    IntBounds2(50, 50, 40, 60),
+    IntBounds2(-3, 8, 1, 9),
+  };
+  EXPECT_EQ(IntBounds2(-3, 0, 20, 15), IntBounds2::UniteAll(with_empty));
+
+  for (int count : { 3, 4, 7, 64, 101 }) {
+    List<IntBounds2> bounds = MakeRandomBounds(count, count);
+    IntBounds2 expected(0, 0, 0, 0);
+    for (const IntBounds2& b : bounds)
+      expected.Unite(b);
+    EXPECT_EQ(expected, IntBounds2::UniteAll(bounds));
+  }
+}
+
+TEST(IntBounds2Test, IntersectAll) {
+  IntBounds2 overlapping[] = {
+    IntBounds2(0, 0, 10, 10),
+    IntBounds2(5, -5, 20, 8),
+    IntBounds2(-3, 2, 7, 9),
+  };
+  EXPECT_EQ(IntBounds2(5, 2, 7, 8), IntBounds2::IntersectAll(overlapping));
+
+  IntBounds2 disjoint[] = {
+    IntBounds2(0, 0, 10, 10),
+    IntBounds2(20, 0, 30, 10),
+  };
+  EXPECT_TRUE(IntBounds2::IntersectAll(disjoint).isEmpty());
+
+  for (int count : { 1, 2, 5, 64 }) {
+    List<IntBounds2> bounds = MakeRandomBounds(count, count);
+    IntBounds2 expected = bounds[0];
+    bool non_empty = !expected.isEmpty();
+    for (const IntBounds2& b : bounds)
+      non_empty = non_empty && expected.TryIntersect(b);
+
+    IntBounds2 actual = IntBounds2::IntersectAll(bounds);
+    EXPECT_EQ(non_empty, !actual.isEmpty());
+    if (non_empty)
+      EXPECT_EQ(expected, actual);
+  }
+}
+
+TEST(IntBounds2Test, ClipEach) {
+  IntBounds2 clip(0, 0, 100, 50);
+  List<IntBounds2> bounds = MakeRandomBounds(99, 7);
+  List<IntBounds2> clipped;
+  clipped.appendUninitialized(bounds.size());
+  IntBounds2::ClipEach(bounds, clip, clipped);
+
+  for (int i = 0; i < bounds.size(); ++i) {
+    IntBounds2 expected = bounds[i];
+    if (!bounds[i].isEmpty() && expected.TryIntersect(clip))
+      EXPECT_EQ(expected, clipped[i]);
+    else
+      EXPECT_TRUE(clipped[i].isEmpty());
+  }
+
+  // In-place.
+  IntBounds2::ClipEach(bounds, clip, bounds);
+  for (int i = 0; i < bounds.size(); ++i)
+    EXPECT_EQ(clipped[i], bounds[i]);
+}
+
+} // namespace stp
@@ -0,0 +1,497 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Geometry/Bvh3.h"
+
+#include "Base/Containers/Sorting.h"
+#include "Base/Simd/Vnx.h"
+#include "Geometry/Ray3.h"
+#include "Geometry/Triangle3.h"
+
+namespace stp {
+
+namespace {
+
+// Leaf holds single packet.
+constexpr int LeafSize = Bvh3::Width;
+// Number of bins for SAH evaluation.
+constexpr int BinCount = 16;
+// Deeper subtrees are split at object median. Guarantees logarithmic depth
+// for degenerate input, which bounds size of traversal stack.
+constexpr int MaxSahDepth = 40;
+// Each visited node pushes at most Width - 1 entries more than it pops.
+constexpr int TraversalStackSize = 256;
+
+struct Box {
+  void enclose(const Box& other) {
+    for (int a = 0; a < 3; ++a) {
+      min[a] = stp::min(min[a], other.min[a]);
+      max[a] = stp::max(max[a], other.max[a]);
+    }
+  }
+
+  void enclose(const float* point) {
+    for (int a = 0; a < 3; ++a) {
+      min[a] = stp::min(min[a], point[a]);
+      max[a] = stp::max(max[a], point[a]);
+    }
+  }
+
+  // Half of surface area, enough for comparisons.
+  float GetHalfArea() const {
+    float dx = max[0] - min[0];
+    float dy = max[1] - min[1];
+    float dz = max[2] - min[2];
+    return dx * dy + dy * dz + dz * dx;
+  }
+
+  static Box Empty() {
+    Box box;
+    for (int a = 0; a < 3; ++a) {
+      box.min[a] = Limits<float>::Infinity;
+      box.max[a] = -Limits<float>::Infinity;
+    }
+    return box;
+  }
+
+  float min[3];
+  float max[3];
+};
+
+struct BuildItem {
+  Box bounds;
+  float centroid[3];
+  int index;
+};
+
+// A range of build items which becomes a child of node.
+struct BuildRange {
+  int count() const { return end - begin; }
+
+  int begin;
+  int end;
+  Box bounds;
+};
+
+} // namespace
+
+class Bvh3::Builder {
+ public:
+  Builder(Bvh3& bvh, Span<Triangle3> triangles)
+      : bvh_(bvh), triangles_(triangles) {}
+
+  void Build();
+
+ private:
+  int BuildNode(const BuildRange& range, int depth);
+  int BuildLeaf(const BuildRange& range);
+
+  void Split(const BuildRange& range, int depth, BuildRange& left, BuildRange& right);
+  int PartitionBySah(const BuildRange& range, int axis, float centroid_min, float centroid_max);
+  int PartitionAtMedian(const BuildRange& range, int axis);
+
+  Box ComputeBounds(int begin, int end) const;
+
+  Bvh3& bvh_;
+  Span<Triangle3> triangles_;
+  List<BuildItem> items_;
+};
+
+void Bvh3::Builder::Build() {
+  int count = triangles_.size();
+  BuildItem* items = items_.appendUninitialized(count);
+  for (int i = 0; i < count; ++i) {
+    const Triangle3& triangle = triangles_[i];
+    BuildItem& item = items[i];
+    item.bounds = Box::Empty();
+    for (const Point3* vertex : { &triangle.p, &triangle.q, &triangle.r }) {
+      float point[3] = { vertex->x, vertex->y, vertex->z };
+      item.bounds.enclose(point);
+    }
+    for (int a = 0; a < 3; ++a)
+      item.centroid[a] = (item.bounds.min[a] + item.bounds.max[a]) * 0.5f;
+    item.index = i;
+  }
+
+  // Lower bounds, the tree is never smaller.
+  bvh_.packets_.ensureCapacity(count / LeafSize + 1);
+  bvh_.nodes_.ensureCapacity(count / (LeafSize * Width) + 1);
+
+  BuildRange root = { 0, count, ComputeBounds(0, count) };
+  bvh_.bounds_ = Bounds3(
+      Point3(root.bounds.min[0], root.bounds.min[1], root.bounds.min[2]),
+      Point3(root.bounds.max[0], root.bounds.max[1], root.bounds.max[2]));
+  BuildNode(root, 0);
+}
+
+int Bvh3::Builder::BuildNode(const BuildRange& range, int depth) {
+  // Reserve the slot, so parent precedes children in memory.
+  int node_index = bvh_.nodes_.size();
+  bvh_.nodes_.appendUninitialized(1);
+
+  // Split the child with largest area until node is full.
+  BuildRange ranges[Width];
+  ranges[0] = range;
+  int range_count = 1;
+  while (range_count < Width) {
+    int best = -1;
+    float best_area = -1;
+    for (int i = 0; i < range_count; ++i) {
+      if (ranges[i].count() <= LeafSize)
+        continue;
+      float area = ranges[i].bounds.GetHalfArea();
+      if (area > best_area) {
+        best_area = area;
+        best = i;
+      }
+    }
+    if (best < 0)
+      break;
+    BuildRange split_range = ranges[best];
+    Split(split_range, depth, ranges[best], ranges[range_count]);
+    ++range_count;
+  }
+
+  Node node;
+  for (int k = 0; k < Width; ++k) {
+    node.padding_[k] = 0;
+    if (k >= range_count) {
+      for (int a = 0; a < 3; ++a) {
+        node.bounds[a][k] = Limits<float>::Infinity;
+        node.bounds[a + 3][k] = -Limits<float>::Infinity;
+      }
+      node.children[k] = EmptyChild;
+      continue;
+    }
+    const BuildRange& child = ranges[k];
+    for (int a = 0; a < 3; ++a) {
+      node.bounds[a][k] = child.bounds.min[a];
+      node.bounds[a + 3][k] = child.bounds.max[a];
+    }
+    if (child.count() <= LeafSize)
+      node.children[k] = ~BuildLeaf(child);
+    else
+      node.children[k] = BuildNode(child, depth + 1);
+  }
+  bvh_.nodes_[node_index] = node;
+  return node_index;
+}
+
+int Bvh3::Builder::BuildLeaf(const BuildRange& range) {
+  ASSERT(0 < range.count() && range.count() <= LeafSize);
+  int packet_index = bvh_.packets_.size();
+  TrianglePacket& packet = *bvh_.packets_.appendUninitialized(1);
+
+  for (int k = 0; k < Width; ++k) {
+    if (k >= range.count()) {
+      for (int a = 0; a < 3; ++a)
+        packet.v0[a][k] = packet.e1[a][k] = packet.e2[a][k] = 0;
+      packet.indices[k] = -1;
+      continue;
+    }
+    int index = items_[range.begin + k].index;
+    const Triangle3& triangle = triangles_[index];
+    Vector3 e1 = triangle.q - triangle.p;
+    Vector3 e2 = triangle.r - triangle.p;
+    packet.v0[0][k] = triangle.p.x;
+    packet.v0[1][k] = triangle.p.y;
+    packet.v0[2][k] = triangle.p.z;
+    packet.e1[0][k] = e1.x;
+    packet.e1[1][k] = e1.y;
+    packet.e1[2][k] = e1.z;
+    packet.e2[0][k] = e2.x;
+    packet.e2[1][k] = e2.y;
+    packet.e2[2][k] = e2.z;
+    packet.indices[k] = index;
+  }
+  return packet_index;
+}
+
+void Bvh3::Builder::Split(
+    const BuildRange& range, int depth, BuildRange& left, BuildRange& right) {
+  Box centroid_bounds = Box::Empty();
+  for (int i = range.begin; i < range.end; ++i)
+    centroid_bounds.enclose(items_[i].centroid);
+
+  int axis = 0;
+  float extent = -1;
+  for (int a = 0; a < 3; ++a) {
+    float axis_extent = centroid_bounds.max[a] - centroid_bounds.min[a];
+    if (axis_extent > extent) {
+      extent = axis_extent;
+      axis = a;
+    }
+  }
+
+  int middle;
+  if (!(extent > 0)) {
+    // All centroids coincide, any split is as good as another.
+    middle = range.begin + range.count() / 2;
+  } else if (depth >= MaxSahDepth) {
+    middle = PartitionAtMedian(range, axis);
+  } else {
+    middle = PartitionBySah(range, axis, centroid_bounds.min[axis], centroid_bounds.max[axis]);
+  }
+  ASSERT(range.begin < middle && middle < range.end);
+
+  left = { range.begin, middle, ComputeBounds(range.begin, middle) };
+  right = { middle, range.end, ComputeBounds(middle, range.end) };
+}
+
+int Bvh3::Builder::PartitionBySah(
+    const BuildRange& range, int axis, float centroid_min, float centroid_max) {
+  Box bin_bounds[BinCount];
+  int bin_counts[BinCount];
+  for (int b = 0; b < BinCount; ++b) {
+    bin_bounds[b] = Box::Empty();
+    bin_counts[b] = 0;
+  }
+
+  float scale = BinCount / (centroid_max - centroid_min);
+  auto get_bin = [=](const BuildItem& item) {
+    int bin = static_cast<int>((item.centroid[axis] - centroid_min) * scale);
+    return min(max(bin, 0), BinCount - 1);
+  };
+
+  for (int i = range.begin; i < range.end; ++i) {
+    const BuildItem& item = items_[i];
+    int bin = get_bin(item);
+    bin_bounds[bin].enclose(item.bounds);
+    ++bin_counts[bin];
+  }
+
+  // Sweep from right to collect cost of right side for each split plane.
+  float right_costs[BinCount - 1];
+  Box accumulated = Box::Empty();
+  int accumulated_count = 0;
+  for (int b = BinCount - 1; b > 0; --b) {
+    accumulated.enclose(bin_bounds[b]);
+    accumulated_count += bin_counts[b];
+    right_costs[b - 1] = accumulated_count ? accumulated.GetHalfArea() * accumulated_count : 0;
+  }
+
+  int best_split = -1;
+  float best_cost = Limits<float>::Infinity;
+  accumulated = Box::Empty();
+  accumulated_count = 0;
+  for (int b = 0; b < BinCount - 1; ++b) {
+    accumulated.enclose(bin_bounds[b]);
+    accumulated_count += bin_counts[b];
+    if (accumulated_count == 0 || accumulated_count == range.count())
+      continue;
+    float cost = accumulated.GetHalfArea() * accumulated_count + right_costs[b];
+    if (cost < best_cost) {
+      best_cost = cost;
+      best_split = b;
+    }
+  }
+  if (best_split < 0)
+    return PartitionAtMedian(range, axis);
+
+  // Partition in place: items from bins up to |best_split| go left.
+  int i = range.begin;
+  int j = range.end - 1;
+  while (i <= j) {
+    if (get_bin(items_[i]) <= best_split) {
+      ++i;
+    } else {
+      swap(items_[i], items_[j]);
+      --j;
+    }
+  }
+  return i;
+}
+
+int Bvh3::Builder::PartitionAtMedian(const BuildRange& range, int axis) {
+  sortSpan(items_.slice(range.begin, range.count()), [axis](const BuildItem& l, const BuildItem& r) {
+    return compare(l.centroid[axis], r.centroid[axis]);
+  });
+  return range.begin + range.count() / 2;
+}
+
+Box Bvh3::Builder::ComputeBounds(int begin, int end) const {
+  Box bounds = Box::Empty();
+  for (int i = begin; i < end; ++i)
+    bounds.enclose(items_[i].bounds);
+  return bounds;
+}
+
+void Bvh3::Build(Span<Triangle3> triangles) {
+  clear();
+  if (triangles.isEmpty())
+    return;
+  triangle_count_ = triangles.size();
+  Builder(*this, triangles).Build();
+}
+
+void Bvh3::clear() {
+  nodes_.clear();
+  packets_.clear();
+  bounds_ = Bounds3();
+  triangle_count_ = 0;
+}
+
+struct Bvh3::RayData {
+  explicit RayData(const Ray3& ray, float max_distance) : max_distance(max_distance) {
+    float components[3] = { ray.direction.x, ray.direction.y, ray.direction.z };
+    origin[0] = ray.origin.x;
+    origin[1] = ray.origin.y;
+    origin[2] = ray.origin.z;
+    for (int a = 0; a < 3; ++a) {
+      float d = components[a];
+      direction[a] = d;
+      // Avoid infinities in slab test: zero times infinity gives NaN.
+      if (mathAbs(d) < 1E-20f)
+        d = d < 0 ? -1E-20f : 1E-20f;
+      inverse_direction[a] = 1 / d;
+      near_bounds[a] = d < 0 ? a + 3 : a;
+    }
+  }
+
+  float origin[3];
+  float direction[3];
+  float inverse_direction[3];
+  // Index of bounds array which ray enters for each axis.
+  int near_bounds[3];
+  float max_distance;
+};
+
+template<bool TAnyHit>
+bool Bvh3::Traverse(const RayData& ray, Hit* out_hit) const {
+  if (nodes_.isEmpty())
+    return false;
+
+  const Vec4f ox(ray.origin[0]), oy(ray.origin[1]), oz(ray.origin[2]);
+  const Vec4f dx(ray.direction[0]), dy(ray.direction[1]), dz(ray.direction[2]);
+  const Vec4f ix(ray.inverse_direction[0]);
+  const Vec4f iy(ray.inverse_direction[1]);
+  const Vec4f iz(ray.inverse_direction[2]);
+  const int near_x = ray.near_bounds[0], far_x = near_x < 3 ? near_x + 3 : near_x - 3;
+  const int near_y = ray.near_bounds[1], far_y = near_y < 3 ? near_y + 3 : near_y - 3;
+  const int near_z = ray.near_bounds[2], far_z = near_z < 3 ? near_z + 3 : near_z - 3;
+  const Vec4f zero(0.f);
+  const Vec4f one(1.f);
+  const Vec4f nan(Limits<float>::NaN);
+
+  float best = ray.max_distance;
+  bool found = false;
+
+  struct StackEntry {
+    int32_t child;
+    float distance;
+  };
+  StackEntry stack[TraversalStackSize];
+  int stack_size = 0;
+  stack[stack_size++] = { 0, 0 };
+
+  while (stack_size > 0) {
+    StackEntry entry = stack[--stack_size];
+    if (entry.distance > best)
+      continue;
+
+    if (entry.child >= 0) {
+      const Node& node = nodes_[entry.child];
+      Vec4f best_v(best);
+      Vec4f t_near = max(
+          max((Vec4f::load(node.bounds[near_x]) - ox) * ix,
+              (Vec4f::load(node.bounds[near_y]) - oy) * iy),
+          max((Vec4f::load(node.bounds[near_z]) - oz) * iz, zero));
+      Vec4f t_far = min(
+          min((Vec4f::load(node.bounds[far_x]) - ox) * ix,
+              (Vec4f::load(node.bounds[far_y]) - oy) * iy),
+          min((Vec4f::load(node.bounds[far_z]) - oz) * iz, best_v));
+      // Widen slightly to make up for rounding errors (conservative traversal).
+      Vec4f hit = t_near <= t_far * Vec4f(1.0000004f);
+      if (!hit.anyTrue())
+        continue;
+
+      // Missed children get NaN distance, which fails all comparisons.
+      float distances[Width];
+      VnxMath::ternary(hit, t_near, nan).store(distances);
+
+      // Push far children first, so the nearest one is visited next.
+      StackEntry hits[Width];
+      int hit_count = 0;
+      for (int k = 0; k < Width; ++k) {
+        if (!(distances[k] <= best))
+          continue;
+        StackEntry hit_entry = { node.children[k], distances[k] };
+        int j = hit_count++;
+        if (!TAnyHit) {
+          for (; j > 0 && hits[j - 1].distance < hit_entry.distance; --j)
+            hits[j] = hits[j - 1];
+        }
+        hits[j] = hit_entry;
+      }
+      ASSERT(stack_size + hit_count <= TraversalStackSize);
+      for (int k = 0; k < hit_count; ++k)
+        stack[stack_size++] = hits[k];
+      continue;
+    }
+
+    // Moller-Trumbore test on 4 triangles at once.
+    const TrianglePacket& packet = packets_[~entry.child];
+    Vec4f e1x = Vec4f::load(packet.e1[0]);
+    Vec4f e1y = Vec4f::load(packet.e1[1]);
+    Vec4f e1z = Vec4f::load(packet.e1[2]);
+    Vec4f e2x = Vec4f::load(packet.e2[0]);
+    Vec4f e2y = Vec4f::load(packet.e2[1]);
+    Vec4f e2z = Vec4f::load(packet.e2[2]);
+
+    Vec4f px = dy * e2z - dz * e2y;
+    Vec4f py = dz * e2x - dx * e2z;
+    Vec4f pz = dx * e2y - dy * e2x;
+    Vec4f det = e1x * px + e1y * py + e1z * pz;
+    Vec4f inv_det = one / det;
+
+    Vec4f tx = ox - Vec4f::load(packet.v0[0]);
+    Vec4f ty = oy - Vec4f::load(packet.v0[1]);
+    Vec4f tz = oz - Vec4f::load(packet.v0[2]);
+    Vec4f u = (tx * px + ty * py + tz * pz) * inv_det;
+
+    Vec4f qx = ty * e1z - tz * e1y;
+    Vec4f qy = tz * e1x - tx * e1z;
+    Vec4f qz = tx * e1y - ty * e1x;
+    Vec4f v = (dx * qx + dy * qy + dz * qz) * inv_det;
+    Vec4f t = (e2x * qx + e2y * qy + e2z * qz) * inv_det;
+
+    Vec4f hit =
+        (det != zero) & (u >= zero) & (v >= zero) & (u + v <= one) &
+        (t >= zero) & (t < Vec4f(best));
+    if (!hit.anyTrue())
+      continue;
+    if (TAnyHit)
+      return true;
+
+    float distances[Width];
+    VnxMath::ternary(hit, t, nan).store(distances);
+    int nearest = -1;
+    for (int k = 0; k < Width; ++k) {
+      if (distances[k] < best) {
+        best = distances[k];
+        nearest = k;
+      }
+    }
+    ASSERT(nearest >= 0);
+    out_hit->triangle_index = packet.indices[nearest];
+    out_hit->distance = best;
+    out_hit->u = u[nearest];
+    out_hit->v = v[nearest];
+    found = true;
+  }
+  return found;
+}
+
+bool Bvh3::FindNearestHit(const Ray3& ray, Hit& out_hit, float max_distance) const {
+  Hit hit;
+  if (!Traverse<false>(RayData(ray, max_distance), &hit))
+    return false;
+  out_hit = hit;
+  return true;
+}
+
+bool Bvh3::HasAnyHit(const Ray3& ray, float max_distance) const {
+  return Traverse<true>(RayData(ray, max_distance), nullptr);
+}
+
+} // namespace stp
@@ -0,0 +1,105 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#ifndef STP_BASE_GEOMETRY_BVH3_H_
+#define STP_BASE_GEOMETRY_BVH3_H_
+
+#include "Base/Containers/List.h"
+#include "Base/Containers/Span.h"
+#include "Base/Type/Limits.h"
+#include "Geometry/Bounds3.h"
+
+namespace stp {
+
+struct Ray3;
+struct Triangle3;
+
+// Bounding volume hierarchy over a static set of triangles.
+// Answers ray queries in logarithmic time instead of testing every triangle
+// with Ray3::IntersectsTriangle().
+//
+// The hierarchy is built with binned surface area heuristic (SAH).
+// Every node has up to 4 children and leaves hold packets of up to
+// 4 triangles, so both box and triangle tests run on 4-wide vectors.
+//
+// Triangles are hit from both sides. Degenerate triangles are never hit.
+class BASE_EXPORT Bvh3 {
+  DISALLOW_COPY_AND_ASSIGN(Bvh3);
+ public:
+  static constexpr int Width = 4;
+
+  struct Hit {
+    // Index of the triangle in array given to Build().
+    int triangle_index = -1;
+    // Distance from ray origin along its direction.
+    float distance = 0;
+    // Barycentric coordinates of the hit point, weights of q and r vertices.
+    float u = 0;
+    float v = 0;
+  };
+
+  Bvh3() {}
+  ~Bvh3() {}
+
+  Bvh3(Bvh3&& other) = default;
+  Bvh3& operator=(Bvh3&& other) = default;
+
+  // Replaces the hierarchy with one built for given |triangles|.
+  void Build(Span<Triangle3> triangles);
+
+  void clear();
+
+  bool isEmpty() const { return triangle_count_ == 0; }
+
+  int GetTriangleCount() const { return triangle_count_; }
+
+  // Returns bounds of all triangles. Not defined for empty hierarchy.
+  const Bounds3& GetBounds() const { return bounds_; }
+
+  // Finds the closest triangle hit by |ray| within |max_distance|.
+  // |out_hit| is altered only when true is returned.
+  bool FindNearestHit(
+      const Ray3& ray, Hit& out_hit,
+      float max_distance = Limits<float>::Infinity) const;
+
+  // Returns true if |ray| hits any triangle within |max_distance|.
+  // Faster than FindNearestHit(), good for occlusion tests.
+  bool HasAnyHit(const Ray3& ray, float max_distance = Limits<float>::Infinity) const;
+
+ private:
+  class Builder;
+  struct RayData;
+
+  // Bounds of children in structure of arrays (min x, y, z and max x, y, z).
+  // Non-negative children are indices of nodes, negative ones encode index
+  // of triangle packet with binary negation. Fits two cache lines.
+  struct Node {
+    float bounds[6][Width];
+    int32_t children[Width];
+    int32_t padding_[Width];
+  };
+
+  // Triangles stored as vertex and two edges, ready for Moller-Trumbore test.
+  // Unused slots hold zero edges and index -1.
+  struct TrianglePacket {
+    float v0[3][Width];
+    float e1[3][Width];
+    float e2[3][Width];
+    int32_t indices[Width];
+  };
+
+  // Marks unused child slot, its bounds are inverted so it is never hit.
+  static constexpr int32_t EmptyChild = Limits<int32_t>::Min;
+
+  template<bool TAnyHit>
+  bool Traverse(const RayData& ray, Hit* hit) const;
+
+  List<Node> nodes_;
+  List<TrianglePacket> packets_;
+  Bounds3 bounds_;
+  int triangle_count_ = 0;
+};
+
+} // namespace stp
+
+#endif // STP_BASE_GEOMETRY_BVH3_H_
@@ -0,0 +1,119 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Geometry/Bvh3.h"
+
+#include "Base/Containers/List.h"
+#include "Base/Math/Math.h"
+#include "Base/Test/GTest.h"
+#include "Base/Test/PerfTest.h"
+#include "Base/Time/TimeTicks.h"
+#include "Base/Util/Random.h"
+#include "Base/Util/RandomUtil.h"
+#include "Geometry/Ray3.h"
+#include "Geometry/Triangle3.h"
+
+#include <math.h>
+
+namespace stp {
+
+namespace {
+
+constexpr int RayCount = 256 * 1024;
+
+class Bvh3PerfTest : public testing::Test {
+ protected:
+  float nextFloat() { return RandomUtil::NextUnitFloat(random_); }
+
+  // Rolling terrain of |grid_size|^2 cells, two triangles each.
+  static List<Triangle3> makeTerrain(int grid_size) {
+    auto height = [grid_size](int x, int y) {
+      float fx = static_cast<float>(x) / grid_size;
+      float fy = static_cast<float>(y) / grid_size;
+      return 20 * sinf(fx * 13) * cosf(fy * 7) + 5 * sinf(fx * 71 + fy * 53);
+    };
+    List<Triangle3> triangles;
+    triangles.ensureCapacity(grid_size * grid_size * 2);
+    float cell = 1000.f / grid_size;
+    for (int y = 0; y < grid_size; ++y) {
+      for (int x = 0; x < grid_size; ++x) {
+        Point3 p00(x * cell, y * cell, height(x, y));
+        Point3 p10((x + 1) * cell, y * cell, height(x + 1, y));
+        Point3 p01(x * cell, (y + 1) * cell, height(x, y + 1));
+        Point3 p11((x + 1) * cell, (y + 1) * cell, height(x + 1, y + 1));
+        triangles.add(Triangle3(p00, p10, p11));
+        triangles.add(Triangle3(p00, p11, p01));
+      }
+    }
+    return triangles;
+  }
+
+  // Rays cast from above the terrain at random angles, like picking from
+  // a camera looking down.
+  List<Ray3> makeRays() {
+    List<Ray3> rays;
+    rays.ensureCapacity(RayCount);
+    for (int i = 0; i < RayCount; ++i) {
+      Point3 origin(nextFloat() * 1000, nextFloat() * 1000, 100);
+      float dx = nextFloat() - 0.5f;
+      float dy = nextFloat() - 0.5f;
+      float dz = -1;
+      float length = mathSqrt(dx * dx + dy * dy + dz * dz);
+      rays.add(Ray3(origin, Vector3(dx / length, dy / length, dz / length)));
+    }
+    return rays;
+  }
+
+  void runBenchmark(const char* trace, int grid_size) {
+    List<Triangle3> triangles = makeTerrain(grid_size);
+    List<Ray3> rays = makeRays();
+
+    Bvh3 bvh;
+    TimeTicks start = TimeTicks::Now();
+    bvh.Build(triangles);
+    TimeDelta build_time = TimeTicks::Now() - start;
+    perf_test::PrintResult("build", "", trace, build_time.InMillisecondsF(), "ms", true);
+    perf_test::PrintThroughput(
+        "build_rate", "", trace, triangles.size(), build_time, "Mtriangles/s", false);
+
+    int hit_count = 0;
+    start = TimeTicks::Now();
+    for (const Ray3& ray : rays) {
+      Bvh3::Hit hit;
+      if (bvh.FindNearestHit(ray, hit))
+        ++hit_count;
+    }
+    perf_test::PrintThroughput(
+        "nearest_hit", "", trace, RayCount, TimeTicks::Now() - start, "Mrays/s", true);
+
+    int any_count = 0;
+    start = TimeTicks::Now();
+    for (const Ray3& ray : rays) {
+      if (bvh.HasAnyHit(ray))
+        ++any_count;
+    }
+    perf_test::PrintThroughput(
+        "any_hit", "", trace, RayCount, TimeTicks::Now() - start, "Mrays/s", true);
+
+    EXPECT_EQ(hit_count, any_count);
+  }
+
+  Random random_;
+};
+
+} // namespace
+
+TEST_F(Bvh3PerfTest, Terrain100K) {
+  runBenchmark("100K", 224);
+}
+
+TEST_F(Bvh3PerfTest, Terrain1M) {
+  runBenchmark("1M", 708);
+}
+
+// Needs about 2 GB of memory, run explicitly.
+TEST_F(Bvh3PerfTest, DISABLED_Terrain10M) {
+  runBenchmark("10M", 2237);
+}
+
+} // namespace stp
@@ -0,0 +1,231 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Geometry/Bvh3.h"
+
+#include "Base/Containers/List.h"
+#include "Base/Test/GTest.h"
+#include "Base/Util/Random.h"
+#include "Base/Util/RandomUtil.h"
+#include "Geometry/Ray3.h"
+#include "Geometry/Triangle3.h"
+
+namespace stp {
+namespace {
+
+class Bvh3Test : public testing::Test {
+ protected:
+  // Deterministic pseudo-random value in range [-range, range).
+  float nextFloat(float range) { return (RandomUtil::NextUnitFloat(random_) * 2 - 1) * range; }
+
+  Point3 nextPoint(float range) {
+    return Point3(nextFloat(range), nextFloat(range), nextFloat(range));
+  }
+
+  void nextRay(float range, Ray3& out_ray) {
+    Point3 origin = nextPoint(range);
+    Vector3 direction = nextPoint(range * 0.5f) - origin;
+    ASSERT_TRUE(direction.TryNormalize());
+    out_ray = Ray3(origin, direction);
+  }
+
+  // Small triangles scattered in a cube.
+  List<Triangle3> makeTriangleSoup(int count) {
+    List<Triangle3> triangles;
+    for (int i = 0; i < count; ++i) {
+      Point3 p = nextPoint(50);
+      Vector3 e1(nextFloat(3), nextFloat(3), nextFloat(3));
+      Vector3 e2(nextFloat(3), nextFloat(3), nextFloat(3));
+      triangles.add(Triangle3(p, p + e1, p + e2));
+    }
+    return triangles;
+  }
+
+  Random random_;
+};
+
+// Reference implementation, tests every triangle in double precision.
+bool findNearestBruteForce(
+    Span<Triangle3> triangles, const Ray3& ray, float max_distance, Bvh3::Hit& out_hit) {
+  double best = max_distance;
+  bool found = false;
+  for (int i = 0; i < triangles.size(); ++i) {
+    const Triangle3& triangle = triangles[i];
+    double o[3] = { ray.origin.x, ray.origin.y, ray.origin.z };
+    double d[3] = { ray.direction.x, ray.direction.y, ray.direction.z };
+    double v0[3] = { triangle.p.x, triangle.p.y, triangle.p.z };
+    double e1[3] = { triangle.q.x - v0[0], triangle.q.y - v0[1], triangle.q.z - v0[2] };
+    double e2[3] = { triangle.r.x - v0[0], triangle.r.y - v0[1], triangle.r.z - v0[2] };
+
+    double p[3] = { d[1] * e2[2] - d[2] * e2[1], d[2] * e2[0] - d[0] * e2[2], d[0] * e2[1] - d[1] * e2[0] };
+    double det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+    if (det == 0)
+      continue;
+    double t_vec[3] = { o[0] - v0[0], o[1] - v0[1], o[2] - v0[2] };
+    double u = (t_vec[0] * p[0] + t_vec[1] * p[1] + t_vec[2] * p[2]) / det;
+    if (u < 0 || u > 1)
+      continue;
+    double q[3] = {
+      t_vec[1] * e1[2] - t_vec[2] * e1[1],
+      t_vec[2] * e1[0] - t_vec[0] * e1[2],
+      t_vec[0] * e1[1] - t_vec[1] * e1[0],
+    };
+    double v = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) / det;
+    if (v < 0 || u + v > 1)
+      continue;
+    double t = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) / det;
+    if (t < 0 || t >= best)
+      continue;
+    best = t;
+    out_hit.triangle_index = i;
+    out_hit.distance = static_cast<float>(t);
+    out_hit.u = static_cast<float>(u);
+    out_hit.v = static_cast<float>(v);
+    found = true;
+  }
+  return found;
+}
+
+TEST_F(Bvh3Test, Empty) {
+  Bvh3 bvh;
+  EXPECT_TRUE(bvh.isEmpty());
+
+  bvh.Build(Span<Triangle3>());
+  EXPECT_TRUE(bvh.isEmpty());
+
+  Bvh3::Hit hit;
+  Ray3 ray = Ray3(Point3(0, 0, 0), Vector3(0, 0, 1));
+  EXPECT_FALSE(bvh.FindNearestHit(ray, hit));
+  EXPECT_FALSE(bvh.HasAnyHit(ray));
+}
+
+TEST_F(Bvh3Test, SingleTriangle) {
+  Triangle3 triangle(Point3(0, 0, 5), Point3(4, 0, 5), Point3(0, 4, 5));
+  Bvh3 bvh;
+  bvh.Build(Span<Triangle3>(&triangle, 1));
+  EXPECT_EQ(1, bvh.GetTriangleCount());
+  EXPECT_EQ(Bounds3(Point3(0, 0, 5), Point3(4, 4, 5)), bvh.GetBounds());
+
+  Bvh3::Hit hit;
+  ASSERT_TRUE(bvh.FindNearestHit(Ray3(Point3(1, 2, 0), Vector3(0, 0, 1)), hit));
+  EXPECT_EQ(0, hit.triangle_index);
+  EXPECT_FLOAT_EQ(5, hit.distance);
+  EXPECT_FLOAT_EQ(0.25f, hit.u);
+  EXPECT_FLOAT_EQ(0.5f, hit.v);
+
+  // Back side is hit as well.
+  ASSERT_TRUE(bvh.FindNearestHit(Ray3(Point3(1, 1, 8), Vector3(0, 0, -1)), hit));
+  EXPECT_FLOAT_EQ(3, hit.distance);
+
+  // Pointing away.
+  EXPECT_FALSE(bvh.FindNearestHit(Ray3(Point3(1, 1, 0), Vector3(0, 0, -1)), hit));
+  // Outside of triangle.
+  EXPECT_FALSE(bvh.FindNearestHit(Ray3(Point3(3, 3, 0), Vector3(0, 0, 1)), hit));
+  // Too far.
+  EXPECT_FALSE(bvh.FindNearestHit(Ray3(Point3(1, 1, 0), Vector3(0, 0, 1)), hit, 4.5f));
+  EXPECT_FALSE(bvh.HasAnyHit(Ray3(Point3(1, 1, 0), Vector3(0, 0, 1)), 4.5f));
+  EXPECT_TRUE(bvh.HasAnyHit(Ray3(Point3(1, 1, 0), Vector3(0, 0, 1)), 5.5f));
+
+  // Parallel to the plane of triangle.
+  EXPECT_FALSE(bvh.HasAnyHit(Ray3(Point3(-1, 1, 5), Vector3(1, 0, 0))));
+}
+
+TEST_F(Bvh3Test, NearestOfStack) {
+  // Parallel layers, inserted in shuffled order.
+  const int Layers[] = { 7, 2, 9, 0, 4, 1, 8, 3, 6, 5 };
+  List<Triangle3> triangles;
+  for (int z : Layers)
+    triangles.add(Triangle3(Point3(-10, -10, z), Point3(10, -10, z), Point3(0, 10, z)));
+
+  Bvh3 bvh;
+  bvh.Build(triangles);
+
+  Bvh3::Hit hit;
+  ASSERT_TRUE(bvh.FindNearestHit(Ray3(Point3(0, 0, -1), Vector3(0, 0, 1)), hit));
+  EXPECT_EQ(3, hit.triangle_index);
+  EXPECT_FLOAT_EQ(1, hit.distance);
+
+  ASSERT_TRUE(bvh.FindNearestHit(Ray3(Point3(0, 0, 4.5f), Vector3(0, 0, 1)), hit));
+  EXPECT_EQ(9, hit.triangle_index);
+  EXPECT_FLOAT_EQ(0.5f, hit.distance);
+
+  ASSERT_TRUE(bvh.FindNearestHit(Ray3(Point3(0, 0, 20), Vector3(0, 0, -1)), hit));
+  EXPECT_EQ(2, hit.triangle_index);
+  EXPECT_FLOAT_EQ(11, hit.distance);
+}
+
+TEST_F(Bvh3Test, MatchesBruteForce) {
+  for (int count : { 1, 3, 4, 5, 17, 100, 2000 }) {
+    List<Triangle3> triangles = makeTriangleSoup(count);
+    Bvh3 bvh;
+    bvh.Build(triangles);
+    ASSERT_EQ(count, bvh.GetTriangleCount());
+
+    for (int i = 0; i < 500; ++i) {
+      Ray3 ray;
+      ASSERT_NO_FATAL_FAILURE(nextRay(80, ray));
+      float max_distance = (i & 1) ? Limits<float>::Infinity : 60;
+
+      Bvh3::Hit expected;
+      Bvh3::Hit actual;
+      bool expected_found = findNearestBruteForce(triangles, ray, max_distance, expected);
+      bool actual_found = bvh.FindNearestHit(ray, actual, max_distance);
+      ASSERT_EQ(expected_found, actual_found) << "count " << count << ", ray " << i;
+      EXPECT_EQ(expected_found, bvh.HasAnyHit(ray, max_distance));
+      if (!expected_found)
+        continue;
+
+      EXPECT_NEAR(expected.distance, actual.distance, 1e-3f);
+      // Triangles may intersect each other, so other one may win a tie.
+      if (expected.triangle_index == actual.triangle_index) {
+        EXPECT_NEAR(expected.u, actual.u, 1e-3f);
+        EXPECT_NEAR(expected.v, actual.v, 1e-3f);
+      }
+    }
+  }
+}
+
+TEST_F(Bvh3Test, DegenerateInput) {
+  // Coinciding centroids cannot be separated by any split plane.
+  List<Triangle3> triangles;
+  for (int i = 0; i < 1000; ++i) {
+    float size = 1 + i * 0.01f;
+    triangles.add(Triangle3(Point3(-size, -size, 0), Point3(size, -size, 0), Point3(0, size, 0)));
+  }
+  // Zero-area triangles are never hit.
+  for (int i = 0; i < 100; ++i)
+    triangles.add(Triangle3(Point3(0, 0, 1), Point3(0, 0, 1), Point3(0, 0, 1)));
+
+  Bvh3 bvh;
+  bvh.Build(triangles);
+
+  Bvh3::Hit hit;
+  ASSERT_TRUE(bvh.FindNearestHit(Ray3(Point3(0, 0, 5), Vector3(0, 0, -1)), hit));
+  EXPECT_FLOAT_EQ(5, hit.distance);
+  EXPECT_LT(hit.triangle_index, 1000);
+
+  // Only the largest triangle covers this point.
+  ASSERT_TRUE(bvh.FindNearestHit(Ray3(Point3(0, 10.985f, -3), Vector3(0, 0, 1)), hit));
+  EXPECT_EQ(999, hit.triangle_index);
+
+  EXPECT_FALSE(bvh.HasAnyHit(Ray3(Point3(0, 0, 2), Vector3(0, 0, 1))));
+}
+
+TEST_F(Bvh3Test, Rebuild) {
+  List<Triangle3> triangles = makeTriangleSoup(100);
+  Bvh3 bvh;
+  bvh.Build(triangles);
+  EXPECT_EQ(100, bvh.GetTriangleCount());
+
+  bvh.Build(triangles.slice(0, 10));
+  EXPECT_EQ(10, bvh.GetTriangleCount());
+
+  bvh.clear();
+  EXPECT_TRUE(bvh.isEmpty());
+  Ray3 ray;
+  ASSERT_NO_FATAL_FAILURE(nextRay(80, ray));
+  EXPECT_FALSE(bvh.HasAnyHit(ray));
+}
+
+} // namespace
+} // namespace stp
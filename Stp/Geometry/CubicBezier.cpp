@@ -6,7 +6,9 @@
 #include "Geometry/CubicBezier.h"
 
 #include "Base/Debug/Assert.h"
+#include "Base/Error/BasicExceptions.h"
 #include "Base/Math/Math.h"
+#include "Base/Simd/Vnx.h"
 
 namespace stp {
 
@@ -68,6 +70,168 @@ double CubicBezier::GetSlope(double x) const {
   return dy_dt / dx_dt;
 }
 
+// Bisection in single precision reaches resolution of t after this many steps.
+static const int MaxStepsBatched = 24;
+
+// Batched functions process eight samples at once. Even where vectors are
+// four lanes wide, two independent chains hide latency of bisection steps.
+static const int BatchSize = 8;
+
+// Vectorized variant of EvalBezier().
+template<typename TVec>
+static TVec EvalBezierNx(const TVec& p1, const TVec& p2, const TVec& t) {
+  TVec h3 = p1 * 3;
+  TVec h1 = h3 - p2 * 3 + 1;
+  TVec h2 = p2 * 3 - p1 * 6;
+  return t * (t * (t * h1 + h2) + h3);
+}
+
+// Vectorized variant of BezierInterp(). Runs fixed number of steps, so all
+// lanes finish at once and no branches are needed. Without early exit a lane
+// which hit the target keeps stepping, so t is kept within [0, 1] where
+// the curve is monotonic (it may turn back outside).
+template<typename TVec>
+static TVec BezierInterpNx(const TVec& x1, const TVec& x2, const TVec& x) {
+  TVec h3 = x1 * 3;
+  TVec h1 = h3 - x2 * 3 + 1;
+  TVec h2 = x2 * 3 - x1 * 6;
+  TVec zero(0);
+  TVec one(1);
+  TVec target = min(max(x, zero), one);
+
+  TVec t(0);
+  float step = 1;
+  for (int i = 0; i < MaxStepsBatched; ++i, step *= 0.5f) {
+    TVec error = t * (t * (t * h1 + h2) + h3) - target;
+    t = t + VnxMath::ternary(error > zero, TVec(-step), TVec(step));
+    t = min(max(t, zero), one);
+  }
+  return t;
+}
+
+void CubicBezier::SolveMany(Span<float> xs, MutableSpan<float> out_ys) const {
+  ASSERT(xs.size() == out_ys.size());
+  ASSERT(0.0 <= x1_ && x1_ <= 1.0);
+  ASSERT(0.0 <= x2_ && x2_ <= 1.0);
+
+  Vec8f x1(static_cast<float>(x1_));
+  Vec8f x2(static_cast<float>(x2_));
+  Vec8f y1(static_cast<float>(y1_));
+  Vec8f y2(static_cast<float>(y2_));
+
+  int count = xs.size();
+  int i = 0;
+  for (; i + BatchSize <= count; i += BatchSize) {
+    Vec8f t = BezierInterpNx(x1, x2, Vec8f::load(xs.data() + i));
+    EvalBezierNx(y1, y2, t).store(out_ys.data() + i);
+  }
+  if (i < count) {
+    float tail[BatchSize] = {};
+    for (int k = 0; i + k < count; ++k)
+      tail[k] = xs[i + k];
+    Vec8f t = BezierInterpNx(x1, x2, Vec8f::load(tail));
+    EvalBezierNx(y1, y2, t).store(tail);
+    for (int k = 0; i + k < count; ++k)
+      out_ys[i + k] = tail[k];
+  }
+}
+
+void CubicBezier::SolveEach(
+    Span<CubicBezier> curves, Span<float> xs, MutableSpan<float> out_ys) {
+  ASSERT(curves.size() == xs.size() && xs.size() == out_ys.size());
+
+  int count = curves.size();
+  for (int i = 0; i < count; i += BatchSize) {
+    // Transpose curves into vectors. Missing tail lanes replicate
+    // the last curve.
+    float p[4][BatchSize];
+    float x[BatchSize];
+    for (int k = 0; k < BatchSize; ++k) {
+      int at = min(i + k, count - 1);
+      const CubicBezier& curve = curves[at];
+      ASSERT(0.0 <= curve.x1_ && curve.x1_ <= 1.0);
+      ASSERT(0.0 <= curve.x2_ && curve.x2_ <= 1.0);
+      p[0][k] = static_cast<float>(curve.x1_);
+      p[1][k] = static_cast<float>(curve.x2_);
+      p[2][k] = static_cast<float>(curve.y1_);
+      p[3][k] = static_cast<float>(curve.y2_);
+      x[k] = xs[at];
+    }
+    Vec8f t = BezierInterpNx(Vec8f::load(p[0]), Vec8f::load(p[1]), Vec8f::load(x));
+    float y[BatchSize];
+    EvalBezierNx(Vec8f::load(p[2]), Vec8f::load(p[3]), t).store(y);
+    for (int k = 0; k < BatchSize && i + k < count; ++k)
+      out_ys[i + k] = y[k];
+  }
+}
+
+int CubicBezier::GetFlattenedPointCount(float tolerance) const {
+  ASSERT(tolerance > 0);
+  // Wang's formula bounds distance between the curve and polyline with
+  // uniformly distributed points by second differences of control points.
+  // Control points are (0, 0), (x1, y1), (x2, y2) and (1, 1).
+  double dd1x = x2_ - 2 * x1_;
+  double dd1y = y2_ - 2 * y1_;
+  double dd2x = 1 - 2 * x2_ + x1_;
+  double dd2y = 1 - 2 * y2_ + y1_;
+  double dd = mathSqrt(max(dd1x * dd1x + dd1y * dd1y, dd2x * dd2x + dd2y * dd2y));
+  double segments = mathCeil(mathSqrt(0.75 * dd / tolerance));
+  return static_cast<int>(min(max(segments, 1.0), static_cast<double>(MaxFlattenSegmentCount))) + 1;
+}
+
+// Writes |count| points of the curve at uniformly distributed t to |out|.
+static void FlattenUniform(const CubicBezier& curve, int count, Point2* out) {
+  ASSERT(count >= 2);
+  Vec4f x1(static_cast<float>(curve.x1()));
+  Vec4f x2(static_cast<float>(curve.x2()));
+  Vec4f y1(static_cast<float>(curve.y1()));
+  Vec4f y2(static_cast<float>(curve.y2()));
+
+  Vec4f dt(1.f / (count - 1));
+  Vec4f lanes(0, 1, 2, 3);
+  for (int i = 0; i < count; i += 4) {
+    Vec4f t = (Vec4f(static_cast<float>(i)) + lanes) * dt;
+    float x[4];
+    float y[4];
+    EvalBezierNx(x1, x2, t).store(x);
+    EvalBezierNx(y1, y2, t).store(y);
+    for (int k = 0; k < 4 && i + k < count; ++k)
+      out[i + k] = Point2(x[k], y[k]);
+  }
+  // Keep end points exact despite rounding.
+  out[0] = Point2(0, 0);
+  out[count - 1] = Point2(1, 1);
+}
+
+void CubicBezier::Flatten(float tolerance, List<Point2>& out_points) const {
+  int count = GetFlattenedPointCount(tolerance);
+  FlattenUniform(*this, count, out_points.appendUninitialized(count));
+}
+
+void CubicBezier::FlattenEach(
+    Span<CubicBezier> curves, float tolerance,
+    List<Point2>& out_points, List<int>& out_ends) {
+  // Both lists are left untouched if the total does not fit.
+  int64_t total = out_points.size();
+  for (int i = 0; i < curves.size(); ++i) {
+    total += curves[i].GetFlattenedPointCount(tolerance);
+    if (total > Limits<int>::Max)
+      throw LengthException();
+  }
+
+  int start = out_points.size();
+  out_ends.willGrow(curves.size());
+  Point2* points = out_points.appendUninitialized(static_cast<int>(total) - start);
+  int* ends = out_ends.appendUninitialized(curves.size());
+  for (int i = 0; i < curves.size(); ++i) {
+    int count = curves[i].GetFlattenedPointCount(tolerance);
+    FlattenUniform(curves[i], count, points);
+    points += count;
+    start += count;
+    ends[i] = start;
+  }
+}
+
 CubicBezier::Range CubicBezier::GetRange() const {
   if (0 <= y1_ && y1_ < 1 && 0 <= y2_ && y2_ <= 1)
     return Range { 0, 1 };
@@ -6,9 +6,13 @@
 #ifndef STP_BASE_GEOMETRY_CUBICBEZIER_H_
 #define STP_BASE_GEOMETRY_CUBICBEZIER_H_
 
+#include "Base/Containers/List.h"
+#include "Base/Containers/Span.h"
+#include "Geometry/Vector2.h"
+
 namespace stp {
 
-class CubicBezier {
+class BASE_EXPORT CubicBezier {
  public:
   CubicBezier(double x1, double y1, double x2, double y2)
       : x1_(x1), y1_(y1), x2_(x2), y2_(y2) {}
@@ -19,6 +23,26 @@ class CubicBezier {
   // Returns an approximation of dy/dx at the given x.
   double GetSlope(double x) const;
 
+  // Batched versions of Solve() in single precision, evaluated with SIMD.
+  // SolveMany() evaluates this curve at every x of |xs|, while SolveEach()
+  // evaluates i-th curve at i-th x.
+  void SolveMany(Span<float> xs, MutableSpan<float> out_ys) const;
+  static void SolveEach(Span<CubicBezier> curves, Span<float> xs, MutableSpan<float> out_ys);
+
+  // Appends polyline from (0, 0) to (1, 1) to |out_points| which is no
+  // further from the curve than |tolerance|. Number of segments depends on
+  // curvature, use GetFlattenedPointCount() to preallocate the list.
+  // The count is clamped to MaxFlattenSegmentCount, so very small
+  // tolerances are not honored.
+  void Flatten(float tolerance, List<Point2>& out_points) const;
+  int GetFlattenedPointCount(float tolerance) const;
+
+  // Flattens all |curves| into one list. Polyline of i-th curve ends
+  // before |out_ends[i]|, the list is grown only once.
+  static void FlattenEach(
+      Span<CubicBezier> curves, float tolerance,
+      List<Point2>& out_points, List<int>& out_ends);
+
   struct Range {
     double min;
     double max;
@@ -29,6 +53,9 @@ class CubicBezier {
   };
   Range GetRange() const;
 
+  // Flatten() never produces more segments than this.
+  static constexpr int MaxFlattenSegmentCount = 1024;
+
   double x1() const { return x1_; }
   double x2() const { return x2_; }
   double y1() const { return y1_; }
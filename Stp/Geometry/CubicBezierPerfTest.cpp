@@ -0,0 +1,93 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Geometry/CubicBezier.h"
+
+#include "Base/Containers/List.h"
+#include "Base/Test/GTest.h"
+#include "Base/Test/PerfTest.h"
+#include "Base/Time/TimeTicks.h"
+#include "Base/Util/Random.h"
+#include "Base/Util/RandomUtil.h"
+
+namespace stp {
+
+namespace {
+
+// Number of animated curves ticked at once.
+constexpr int CurveCount = 4096;
+constexpr int Iterations = 200;
+constexpr double SampleCount = static_cast<double>(CurveCount) * Iterations;
+
+class CubicBezierPerfTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    for (int i = 0; i < CurveCount; ++i) {
+      curves_.add(CubicBezier(nextFloat(), nextFloat() * 2 - 0.5f, nextFloat(), nextFloat() * 2 - 0.5f));
+      xs_.add(nextFloat());
+    }
+    ys_.appendUninitialized(CurveCount);
+  }
+
+  float nextFloat() { return RandomUtil::NextUnitFloat(random_); }
+
+  List<CubicBezier> curves_;
+  List<float> xs_;
+  List<float> ys_;
+  Random random_;
+};
+
+} // namespace
+
+TEST_F(CubicBezierPerfTest, Solve) {
+  // Scalar path in double precision, one curve at a time.
+  double sum = 0;
+  TimeTicks start = TimeTicks::Now();
+  for (int j = 0; j < Iterations; ++j) {
+    for (int i = 0; i < CurveCount; ++i)
+      sum += curves_[i].Solve(xs_[i]);
+  }
+  perf_test::PrintThroughput(
+      "solve", "", "scalar", SampleCount, TimeTicks::Now() - start, "Msamples/s", true);
+
+  start = TimeTicks::Now();
+  for (int j = 0; j < Iterations; ++j)
+    CubicBezier::SolveEach(curves_, xs_, ys_);
+  perf_test::PrintThroughput(
+      "solve", "", "each", SampleCount, TimeTicks::Now() - start, "Msamples/s", true);
+
+  // Many samples of single curve.
+  start = TimeTicks::Now();
+  for (int j = 0; j < Iterations; ++j)
+    curves_[j].SolveMany(xs_, ys_);
+  perf_test::PrintThroughput(
+      "solve", "", "many", SampleCount, TimeTicks::Now() - start, "Msamples/s", true);
+
+  EXPECT_GT(sum, 0);
+}
+
+TEST_F(CubicBezierPerfTest, Flatten) {
+  constexpr float Tolerance = 0.001f;
+
+  List<Point2> points;
+  List<int> ends;
+  CubicBezier::FlattenEach(curves_, Tolerance, points, ends);
+  int point_count = points.size();
+
+  TimeTicks start = TimeTicks::Now();
+  for (int j = 0; j < Iterations; ++j) {
+    points.clear();
+    ends.clear();
+    CubicBezier::FlattenEach(curves_, Tolerance, points, ends);
+  }
+  TimeDelta time = TimeTicks::Now() - start;
+
+  perf_test::PrintThroughput(
+      "flatten", "", "curves", static_cast<double>(CurveCount) * Iterations, time,
+      "Mcurves/s", true);
+  perf_test::PrintThroughput(
+      "flatten", "", "points", static_cast<double>(point_count) * Iterations, time,
+      "Mpoints/s", false);
+}
+
+} // namespace stp
@@ -4,6 +4,8 @@
 
 #include "Geometry/CubicBezier.h"
 
+#include "Base/Containers/List.h"
+#include "Base/Error/BasicExceptions.h"
 #include "Base/Memory/OwnPtr.h"
 #include "Base/Test/GTest.h"
 
@@ -165,5 +167,154 @@ TEST(CubicBezierTest, GetSlope) {
   EXPECT_NEAR(function.GetSlope(1.1), 0, epsilon);
 }
 
+TEST(CubicBezierTest, SolveMany) {
+  CubicBezier function(0.5, -1.0, 0.5, 2.0);
+
+  // Odd count exercises the tail.
+  List<float> xs;
+  for (int i = -2; i <= 104; ++i)
+    xs.add(i * 0.01f);
+  List<float> ys;
+  ys.appendUninitialized(xs.size());
+  function.SolveMany(xs, ys);
+
+  for (int i = 0; i < xs.size(); ++i)
+    EXPECT_NEAR(function.Solve(xs[i]), ys[i], 1e-5) << "x=" << xs[i];
+
+  // x(t) of this curve turns back after t=1, end point must not run past it.
+  CubicBezier ease_in_circ(0.6, 0.04, 0.98, 0.335);
+  float end_xs[] = { 0.99f, 1.0f, 1.0f };
+  float end_ys[3];
+  ease_in_circ.SolveMany(end_xs, end_ys);
+  for (int i = 0; i < 3; ++i)
+    EXPECT_NEAR(ease_in_circ.Solve(end_xs[i]), end_ys[i], 1e-5) << "x=" << end_xs[i];
+  EXPECT_NEAR(1.0, end_ys[1], 1e-5);
+}
+
+TEST(CubicBezierTest, SolveEach) {
+  CubicBezier functions[] = {
+    CubicBezier(0.25, 0.1, 0.25, 1.0),
+    CubicBezier(0.42, 0.0, 1.0, 1.0),
+    CubicBezier(0.0, 0.0, 0.58, 1.0),
+    CubicBezier(0.42, 0.0, 0.58, 1.0),
+    CubicBezier(0.25, -0.5, 0.75, 1.5),
+    CubicBezier(0.0, 1.0, 1.0, 0.0),
+    CubicBezier(1.0, 0.0, 0.0, 1.0),
+    CubicBezier(0.6, 0.04, 0.98, 0.335),
+  };
+  float xs[] = { 0.1f, 0.2f, 0.3f, 0.5f, 0.7f, 0.9f, 1.0f, 1.0f };
+  float ys[8];
+  CubicBezier::SolveEach(functions, xs, ys);
+
+  for (int i = 0; i < 8; ++i)
+    EXPECT_NEAR(functions[i].Solve(xs[i]), ys[i], 1e-5) << "i=" << i;
+}
+
+// Returns distance from |p| to segment |a|-|b|.
+double getDistanceToSegment(Point2 p, Point2 a, Point2 b) {
+  double dx = b.x - a.x;
+  double dy = b.y - a.y;
+  double length_squared = dx * dx + dy * dy;
+  double t = 0;
+  if (length_squared > 0)
+    t = min(max(((p.x - a.x) * dx + (p.y - a.y) * dy) / length_squared, 0.0), 1.0);
+  double ex = a.x + t * dx - p.x;
+  double ey = a.y + t * dy - p.y;
+  return mathSqrt(ex * ex + ey * ey);
+}
+
+// Checks that densely sampled curve stays within |tolerance| from polyline.
+void expectFlattenedWithin(const CubicBezier& curve, Span<Point2> polyline, float tolerance) {
+  ASSERT_GE(polyline.size(), 2);
+  EXPECT_EQ(Point2(0, 0), polyline.first());
+  EXPECT_EQ(Point2(1, 1), polyline.last());
+
+  for (int i = 0; i <= 1000; ++i) {
+    double t = i / 1000.0;
+    double mt = 1 - t;
+    double x = 3 * mt * mt * t * curve.x1() + 3 * mt * t * t * curve.x2() + t * t * t;
+    double y = 3 * mt * mt * t * curve.y1() + 3 * mt * t * t * curve.y2() + t * t * t;
+    Point2 p(static_cast<float>(x), static_cast<float>(y));
+
+    double distance = Limits<double>::Infinity;
+    for (int k = 1; k < polyline.size(); ++k)
+      distance = min(distance, getDistanceToSegment(p, polyline[k - 1], polyline[k]));
+    EXPECT_LE(distance, tolerance + 1e-6) << "t=" << t;
+  }
+}
+
+TEST(CubicBezierTest, Flatten) {
+  CubicBezier linear(1.0 / 3, 1.0 / 3, 2.0 / 3, 2.0 / 3);
+  List<Point2> points;
+  linear.Flatten(0.01f, points);
+  EXPECT_EQ(2, points.size());
+
+  CubicBezier functions[] = {
+    CubicBezier(0.25, 0.1, 0.25, 1.0),
+    CubicBezier(0.5, -1.0, 0.5, 2.0),
+    CubicBezier(0.0, 1.0, 1.0, 0.0),
+  };
+  for (const CubicBezier& function : functions) {
+    for (float tolerance : { 0.1f, 0.01f, 0.001f }) {
+      points.clear();
+      function.Flatten(tolerance, points);
+      EXPECT_EQ(function.GetFlattenedPointCount(tolerance), points.size());
+      expectFlattenedWithin(function, points, tolerance);
+    }
+  }
+
+  // Finer tolerance needs more segments.
+  const CubicBezier& curve = functions[1];
+  EXPECT_LT(curve.GetFlattenedPointCount(0.1f), curve.GetFlattenedPointCount(0.01f));
+  EXPECT_EQ(CubicBezier::MaxFlattenSegmentCount + 1, curve.GetFlattenedPointCount(1e-9f));
+}
+
+TEST(CubicBezierTest, FlattenEach) {
+  CubicBezier functions[] = {
+    CubicBezier(0.25, 0.1, 0.25, 1.0),
+    CubicBezier(1.0 / 3, 1.0 / 3, 2.0 / 3, 2.0 / 3),
+    CubicBezier(0.5, -1.0, 0.5, 2.0),
+  };
+  List<Point2> points;
+  points.add(Point2(5, 5));
+  List<int> ends;
+  CubicBezier::FlattenEach(functions, 0.005f, points, ends);
+
+  ASSERT_EQ(3, ends.size());
+  EXPECT_EQ(points.size(), ends[2]);
+  EXPECT_EQ(Point2(5, 5), points[0]);
+
+  int start = 1;
+  for (int i = 0; i < 3; ++i) {
+    List<Point2> expected;
+    functions[i].Flatten(0.005f, expected);
+    ASSERT_EQ(expected.size(), ends[i] - start);
+    for (int k = 0; k < expected.size(); ++k)
+      EXPECT_EQ(expected[k], points[start + k]);
+    start = ends[i];
+  }
+}
+
+TEST(CubicBezierTest, FlattenEachOverflow) {
+  // Enough maximally subdivided curves to overflow int point count.
+  int curve_count = Limits<int>::Max / (CubicBezier::MaxFlattenSegmentCount + 1) + 1;
+  List<CubicBezier> curves;
+  curves.ensureCapacity(curve_count);
+  for (int i = 0; i < curve_count; ++i)
+    curves.add(CubicBezier(0.5, -1.0, 0.5, 2.0));
+
+  List<Point2> points;
+  points.add(Point2(5, 5));
+  List<int> ends;
+  ends.add(7);
+  EXPECT_THROW(CubicBezier::FlattenEach(curves, 1e-9f, points, ends), LengthException);
+
+  // Neither list is touched.
+  ASSERT_EQ(1, points.size());
+  EXPECT_EQ(Point2(5, 5), points[0]);
+  ASSERT_EQ(1, ends.size());
+  EXPECT_EQ(7, ends[0]);
+}
+
 } // namespace
 } // namespace stp
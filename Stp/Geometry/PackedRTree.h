@@ -0,0 +1,249 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#ifndef STP_BASE_GEOMETRY_PACKEDRTREE_H_
+#define STP_BASE_GEOMETRY_PACKEDRTREE_H_
+
+#include "Base/Containers/Sorting.h"
+#include "Base/Containers/Span.h"
+#include "Geometry/RTreeImpl.h"
+
+namespace stp {
+
+// Static spatial index over bounds, bulk-loaded in a single pass.
+// Items are sorted along Hilbert curve and packed into full nodes of 16
+// entries level by level, so the tree has no pointers: children of a node
+// are found by arithmetic. Use RStarTree when items change over time.
+//
+// Queries report indices of items within array given to Build().
+// Intersection has the same semantics as Bounds2::Intersects(): touching
+// bounds intersect.
+template<typename TBounds>
+class PackedRTree {
+  DISALLOW_COPY_AND_ASSIGN(PackedRTree);
+ public:
+  typedef typename detail::RTreeTraits<TBounds>::PointType PointType;
+
+  static constexpr int NodeCapacity = detail::RTreeNodeCapacity;
+
+  PackedRTree() {}
+
+  PackedRTree(PackedRTree&& other) = default;
+  PackedRTree& operator=(PackedRTree&& other) = default;
+
+  // Replaces content of the tree with given |items|.
+  void Build(Span<TBounds> items);
+
+  void clear();
+
+  int size() const { return item_count_; }
+  bool isEmpty() const { return item_count_ == 0; }
+
+  // Returns union of all items. Not defined for empty tree.
+  TBounds GetBounds() const;
+
+  // Calls |visitor(index)| for every item intersecting |query|.
+  template<typename TVisitor>
+  void VisitIntersecting(const TBounds& query, TVisitor&& visitor) const;
+
+  // Appends indices of items intersecting |query| to |out_indices|.
+  void FindIntersecting(const TBounds& query, List<int>& out_indices) const {
+    VisitIntersecting(query, [&out_indices](int index) { out_indices.add(index); });
+  }
+
+  // Appends indices of items containing |point| to |out_indices|.
+  void FindContaining(const PointType& point, List<int>& out_indices) const {
+    FindIntersecting(TBounds(point, point), out_indices);
+  }
+
+  // Appends indices of up to |count| items nearest to |point| to
+  // |out_indices|, ordered by distance. Items containing |point| have
+  // zero distance.
+  void FindNearest(const PointType& point, int count, List<int>& out_indices) const;
+
+ private:
+  typedef detail::RTreeNodeBounds<TBounds> Node;
+
+  // 16^8 entries exceed the range of int.
+  static constexpr int MaxLevelCount = 8;
+
+  int GetEntryCount(int level, int node_in_level) const {
+    return min(NodeCapacity, level_sizes_[level] - node_in_level * NodeCapacity);
+  }
+
+  detail::RTreeNodeArray<Node> nodes_;
+  // Maps leaf entries to item indices.
+  List<int> indices_;
+  // Level 0 holds leaves, the last level holds single root node.
+  int level_offsets_[MaxLevelCount];
+  // Number of entries at given level.
+  int level_sizes_[MaxLevelCount];
+  int level_count_ = 0;
+  int item_count_ = 0;
+};
+
+typedef PackedRTree<Bounds2> PackedRTree2;
+typedef PackedRTree<IntBounds2> IntPackedRTree2;
+
+template<typename TBounds>
+void PackedRTree<TBounds>::Build(Span<TBounds> items) {
+  clear();
+  if (items.isEmpty())
+    return;
+  int count = items.size();
+
+  TBounds bounds = items[0];
+  for (const TBounds& item : items) {
+    bounds.min.x = min(bounds.min.x, item.min.x);
+    bounds.min.y = min(bounds.min.y, item.min.y);
+    bounds.max.x = max(bounds.max.x, item.max.x);
+    bounds.max.y = max(bounds.max.y, item.max.y);
+  }
+
+  // Sort items by position of their centers along Hilbert curve.
+  struct SortItem {
+    uint32_t hilbert;
+    int index;
+  };
+  List<SortItem> sorted;
+  SortItem* sorted_items = sorted.appendUninitialized(count);
+  double width = static_cast<double>(bounds.max.x) - bounds.min.x;
+  double height = static_cast<double>(bounds.max.y) - bounds.min.y;
+  double scale_x = width > 0 ? 0xFFFF / width : 0;
+  double scale_y = height > 0 ? 0xFFFF / height : 0;
+  for (int i = 0; i < count; ++i) {
+    const TBounds& item = items[i];
+    double center_x = (static_cast<double>(item.min.x) + item.max.x) * 0.5;
+    double center_y = (static_cast<double>(item.min.y) + item.max.y) * 0.5;
+    auto x = static_cast<uint32_t>((center_x - bounds.min.x) * scale_x);
+    auto y = static_cast<uint32_t>((center_y - bounds.min.y) * scale_y);
+    sorted_items[i].hilbert = detail::computeHilbertIndex(x, y);
+    sorted_items[i].index = i;
+  }
+  sortSpan(sorted.toSpan(), [](const SortItem& l, const SortItem& r) {
+    return compare(l.hilbert, r.hilbert);
+  });
+
+  // Compute shape of the tree.
+  int total_node_count = 0;
+  int level_size = count;
+  while (true) {
+    ASSERT(level_count_ < MaxLevelCount);
+    int node_count = (level_size + NodeCapacity - 1) / NodeCapacity;
+    level_offsets_[level_count_] = total_node_count;
+    level_sizes_[level_count_] = level_size;
+    ++level_count_;
+    total_node_count += node_count;
+    if (node_count == 1)
+      break;
+    level_size = node_count;
+  }
+  nodes_.ensureCapacity(total_node_count);
+  for (int i = 0; i < total_node_count; ++i)
+    nodes_.addUninitialized();
+
+  // Unused slots of the last node in each level are filled with copies
+  // of the first entry. They are never reported, but keep all lanes valid.
+  int leaf_count = (count + NodeCapacity - 1) / NodeCapacity;
+  int* indices = indices_.appendUninitialized(leaf_count * NodeCapacity);
+  for (int i = 0; i < leaf_count * NodeCapacity; ++i) {
+    int index = sorted_items[i < count ? i : 0].index;
+    indices[i] = i < count ? index : -1;
+    nodes_[i / NodeCapacity].SetEntry(i % NodeCapacity, items[index]);
+  }
+
+  for (int level = 1; level < level_count_; ++level) {
+    int child_offset = level_offsets_[level - 1];
+    int offset = level_offsets_[level];
+    int size = level_sizes_[level];
+    int padded_size = (size + NodeCapacity - 1) / NodeCapacity * NodeCapacity;
+    for (int i = 0; i < padded_size; ++i) {
+      int child = i < size ? i : 0;
+      TBounds child_bounds = nodes_[child_offset + child].GetUnion(GetEntryCount(level - 1, child));
+      nodes_[offset + i / NodeCapacity].SetEntry(i % NodeCapacity, child_bounds);
+    }
+  }
+  item_count_ = count;
+}
+
+template<typename TBounds>
+void PackedRTree<TBounds>::clear() {
+  nodes_.clear();
+  indices_.clear();
+  level_count_ = 0;
+  item_count_ = 0;
+}
+
+template<typename TBounds>
+TBounds PackedRTree<TBounds>::GetBounds() const {
+  ASSERT(!isEmpty());
+  int root_level = level_count_ - 1;
+  return nodes_[level_offsets_[root_level]].GetUnion(level_sizes_[root_level]);
+}
+
+template<typename TBounds>
+template<typename TVisitor>
+void PackedRTree<TBounds>::VisitIntersecting(const TBounds& query, TVisitor&& visitor) const {
+  if (isEmpty())
+    return;
+
+  struct StackEntry {
+    int level;
+    int node;
+  };
+  // Every level keeps at most 15 siblings on the stack.
+  StackEntry stack[MaxLevelCount * NodeCapacity];
+  int stack_size = 0;
+  stack[stack_size++] = { level_count_ - 1, 0 };
+
+  while (stack_size > 0) {
+    StackEntry entry = stack[--stack_size];
+    const Node& node = nodes_[level_offsets_[entry.level] + entry.node];
+    uint32_t mask = node.GetIntersectingMask(query, GetEntryCount(entry.level, entry.node));
+    int first_child = entry.node * NodeCapacity;
+    for (; mask; mask &= mask - 1) {
+      int k = findFirstOneBit(mask);
+      if (entry.level == 0)
+        visitor(indices_[first_child + k]);
+      else
+        stack[stack_size++] = { entry.level - 1, first_child + k };
+    }
+  }
+}
+
+template<typename TBounds>
+void PackedRTree<TBounds>::FindNearest(
+    const PointType& point, int count, List<int>& out_indices) const {
+  if (isEmpty() || count <= 0)
+    return;
+
+  double x = point.x;
+  double y = point.y;
+  detail::RTreeNearestQueue queue;
+  queue.push(0, 0, level_count_ - 1);
+
+  while (!queue.isEmpty()) {
+    auto candidate = queue.pop();
+    if (candidate.level < 0) {
+      out_indices.add(candidate.ref);
+      if (--count == 0)
+        break;
+      continue;
+    }
+    int level = candidate.level;
+    const Node& node = nodes_[level_offsets_[level] + candidate.ref];
+    int entry_count = GetEntryCount(level, candidate.ref);
+    int first_child = candidate.ref * NodeCapacity;
+    for (int k = 0; k < entry_count; ++k) {
+      double distance = node.GetDistanceSquared(k, x, y);
+      if (level == 0)
+        queue.push(distance, indices_[first_child + k], -1);
+      else
+        queue.push(distance, first_child + k, level - 1);
+    }
+  }
+}
+
+} // namespace stp
+
+#endif // STP_BASE_GEOMETRY_PACKEDRTREE_H_
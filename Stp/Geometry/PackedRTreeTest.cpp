@@ -0,0 +1,213 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Geometry/PackedRTree.h"
+
+#include "Base/Containers/List.h"
+#include "Base/Containers/Sorting.h"
+#include "Base/Test/GTest.h"
+#include "Base/Util/Random.h"
+#include "Base/Util/RandomUtil.h"
+
+namespace stp {
+namespace {
+
+class PackedRTreeTest : public testing::Test {
+ protected:
+  float nextFloat() { return RandomUtil::NextUnitFloat(random_); }
+  int nextInt(int range) { return static_cast<int>(random_.NextUInt32() % range); }
+
+  Bounds2 nextBounds(float range, float max_size) {
+    float x = nextFloat() * range;
+    float y = nextFloat() * range;
+    return Bounds2(x, y, x + nextFloat() * max_size, y + nextFloat() * max_size);
+  }
+
+  IntBounds2 nextIntBounds(int range, int max_size) {
+    int x = nextInt(range);
+    int y = nextInt(range);
+    return IntBounds2(x, y, x + nextInt(max_size), y + nextInt(max_size));
+  }
+
+  Random random_;
+};
+
+void sortIndices(List<int>& indices) {
+  sortSpan(indices.toSpan(), [](int l, int r) { return compare(l, r); });
+}
+
+template<typename TBounds>
+List<int> findIntersectingBruteForce(const List<TBounds>& items, const TBounds& query) {
+  List<int> result;
+  for (int i = 0; i < items.size(); ++i) {
+    if (TBounds::Intersects(items[i], query))
+      result.add(i);
+  }
+  return result;
+}
+
+template<typename TBounds>
+double getDistanceSquared(const TBounds& bounds, double x, double y) {
+  double dx = max(0.0, max(bounds.min.x - x, x - bounds.max.x));
+  double dy = max(0.0, max(bounds.min.y - y, y - bounds.max.y));
+  return dx * dx + dy * dy;
+}
+
+template<typename TTree, typename TBounds>
+void expectSameIntersecting(const TTree& tree, const List<TBounds>& items, const TBounds& query) {
+  List<int> expected = findIntersectingBruteForce(items, query);
+  List<int> actual;
+  tree.FindIntersecting(query, actual);
+  sortIndices(actual);
+  EXPECT_EQ(expected, actual);
+}
+
+// Ties in distance make order of results ambiguous, so compare distances.
+template<typename TTree, typename TBounds>
+void expectSameNearest(
+    const TTree& tree, const List<TBounds>& items, typename TTree::PointType point, int count) {
+  List<double> distances;
+  for (const TBounds& item : items)
+    distances.add(getDistanceSquared(item, point.x, point.y));
+  sortSpan(distances.toSpan(), [](double l, double r) {
+    return l < r ? -1 : (l > r ? 1 : 0);
+  });
+
+  List<int> actual;
+  tree.FindNearest(point, count, actual);
+  ASSERT_EQ(min(count, items.size()), actual.size());
+  for (int i = 0; i < actual.size(); ++i)
+    EXPECT_EQ(distances[i], getDistanceSquared(items[actual[i]], point.x, point.y));
+}
+
+TEST_F(PackedRTreeTest, Empty) {
+  PackedRTree2 tree;
+  EXPECT_TRUE(tree.isEmpty());
+
+  tree.Build(Span<Bounds2>());
+  EXPECT_TRUE(tree.isEmpty());
+
+  List<int> result;
+  tree.FindIntersecting(Bounds2(-100, -100, 100, 100), result);
+  tree.FindNearest(Point2(0, 0), 10, result);
+  EXPECT_TRUE(result.isEmpty());
+}
+
+TEST_F(PackedRTreeTest, SingleItem) {
+  Bounds2 items[] = { Bounds2(1, 2, 3, 4) };
+  PackedRTree2 tree;
+  tree.Build(items);
+  EXPECT_EQ(1, tree.size());
+  EXPECT_EQ(items[0], tree.GetBounds());
+
+  List<int> result;
+  tree.FindContaining(Point2(2, 3), result);
+  EXPECT_EQ(1, result.size());
+  result.clear();
+  tree.FindContaining(Point2(5, 3), result);
+  EXPECT_TRUE(result.isEmpty());
+  // Touching bounds intersect.
+  tree.FindIntersecting(Bounds2(3, 4, 5, 5), result);
+  EXPECT_EQ(1, result.size());
+}
+
+TEST_F(PackedRTreeTest, MatchesBruteForce) {
+  // Sizes around multiples of node capacity.
+  for (int count : { 15, 16, 17, 256, 257, 5000 }) {
+    List<Bounds2> items;
+    for (int i = 0; i < count; ++i)
+      items.add(nextBounds(1000, 30));
+
+    PackedRTree2 tree;
+    tree.Build(items);
+    ASSERT_EQ(count, tree.size());
+
+    Bounds2 bounds = tree.GetBounds();
+    for (const Bounds2& item : items)
+      EXPECT_TRUE(bounds.contains(item));
+
+    for (int i = 0; i < 50; ++i)
+      expectSameIntersecting(tree, items, nextBounds(1000, 200));
+    for (int i = 0; i < 20; ++i) {
+      Point2 point(nextFloat() * 1000, nextFloat() * 1000);
+      expectSameIntersecting(tree, items, Bounds2(point, point));
+      expectSameNearest(tree, items, point, 1 + nextInt(40));
+    }
+  }
+}
+
+TEST_F(PackedRTreeTest, IntBounds) {
+  List<IntBounds2> items;
+  for (int i = 0; i < 3000; ++i)
+    items.add(nextIntBounds(10000, 100));
+
+  IntPackedRTree2 tree;
+  tree.Build(items);
+  ASSERT_EQ(3000, tree.size());
+
+  for (int i = 0; i < 50; ++i)
+    expectSameIntersecting(tree, items, nextIntBounds(10000, 1000));
+  for (int i = 0; i < 20; ++i) {
+    IntPoint2 point(nextInt(10000), nextInt(10000));
+    expectSameIntersecting(tree, items, IntBounds2(point, point));
+    expectSameNearest(tree, items, point, 1 + nextInt(40));
+  }
+}
+
+TEST_F(PackedRTreeTest, CoincidentItems) {
+  // All centers map to the same Hilbert index.
+  List<Bounds2> items;
+  for (int i = 0; i < 100; ++i)
+    items.add(Bounds2(5, 5, 5, 5));
+
+  PackedRTree2 tree;
+  tree.Build(items);
+
+  List<int> result;
+  tree.FindContaining(Point2(5, 5), result);
+  sortIndices(result);
+  ASSERT_EQ(100, result.size());
+  for (int i = 0; i < 100; ++i)
+    EXPECT_EQ(i, result[i]);
+
+  result.clear();
+  tree.FindNearest(Point2(0, 0), 200, result);
+  EXPECT_EQ(100, result.size());
+}
+
+TEST_F(PackedRTreeTest, Rebuild) {
+  List<Bounds2> items;
+  for (int i = 0; i < 1000; ++i)
+    items.add(nextBounds(100, 5));
+
+  PackedRTree2 tree;
+  tree.Build(items);
+  items.removeRange(500, 500);
+  tree.Build(items);
+  EXPECT_EQ(500, tree.size());
+  expectSameIntersecting(tree, items, Bounds2(0, 0, 100, 100));
+}
+
+TEST_F(PackedRTreeTest, HilbertIndexIsBijective) {
+  // Consecutive indices within an aligned block are adjacent cells.
+  constexpr int Size = 64;
+  bool visited[Size * Size] = {};
+  uint32_t cells[Size * Size];
+  for (uint32_t y = 0; y < Size; ++y) {
+    for (uint32_t x = 0; x < Size; ++x) {
+      uint32_t index = detail::computeHilbertIndex(x, y);
+      ASSERT_LT(index, static_cast<uint32_t>(Size * Size));
+      ASSERT_FALSE(visited[index]);
+      visited[index] = true;
+      cells[index] = (y << 16) | x;
+    }
+  }
+  for (int i = 1; i < Size * Size; ++i) {
+    int dx = static_cast<int>(cells[i] & 0xFFFF) - static_cast<int>(cells[i - 1] & 0xFFFF);
+    int dy = static_cast<int>(cells[i] >> 16) - static_cast<int>(cells[i - 1] >> 16);
+    EXPECT_EQ(1, dx * dx + dy * dy);
+  }
+}
+
+} // namespace
+} // namespace stp
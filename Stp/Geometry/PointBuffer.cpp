@@ -0,0 +1,347 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Geometry/PointBuffer.h"
+
+#include "Base/Containers/ArrayOps.h"
+#include "Base/Error/BasicExceptions.h"
+#include "Base/Math/Alignment.h"
+#include "Base/Memory/AlignedMalloc.h"
+#include "Base/System/CpuInfo.h"
+#include "Geometry/Affine.h"
+#include "Geometry/Bounds2.h"
+#include "Geometry/Bounds3.h"
+#include "Geometry/PointBufferKernels.h"
+#include "Geometry/Xform2.h"
+#include "Geometry/Xform3.h"
+
+#include <string.h>
+
+namespace stp {
+
+namespace detail {
+
+PointBufferStorage::~PointBufferStorage() {
+  if (data_)
+    freeAlignedMemory(data_);
+}
+
+PointBufferStorage::PointBufferStorage(PointBufferStorage&& other) noexcept
+    : data_(exchange(other.data_, nullptr)),
+      size_(exchange(other.size_, 0)),
+      capacity_(exchange(other.capacity_, 0)),
+      component_count_(other.component_count_) {
+}
+
+PointBufferStorage& PointBufferStorage::operator=(PointBufferStorage&& other) noexcept {
+  ASSERT(component_count_ == other.component_count_);
+  if (this != &other) {
+    if (data_)
+      freeAlignedMemory(data_);
+    data_ = exchange(other.data_, nullptr);
+    size_ = exchange(other.size_, 0);
+    capacity_ = exchange(other.capacity_, 0);
+  }
+  return *this;
+}
+
+void PointBufferStorage::ensureCapacity(int request) {
+  ASSERT(request >= 0);
+  if (request > capacity_)
+    resizeStorage(request);
+}
+
+void PointBufferStorage::willGrow(int n) {
+  ASSERT(n >= 0);
+  if (Limits<int>::Max - size_ < n)
+    throw LengthException();
+  int request = size_ + n;
+  if (request > capacity_)
+    resizeStorage(max(request, capacity_ < Limits<int>::Max / 2 ? capacity_ * 2 : request));
+}
+
+void PointBufferStorage::resize(int size) {
+  ASSERT(size >= 0);
+  if (size > size_) {
+    ensureCapacity(size);
+    for (int i = 0; i < component_count_; ++i)
+      fillObjects(getComponent(i) + size_, size - size_, 0.f);
+  }
+  size_ = size;
+}
+
+void PointBufferStorage::resizeStorage(int new_capacity) {
+  int max_capacity = Limits<int>::Max / (component_count_ * isizeof(float)) / BatchSize * BatchSize;
+  if (new_capacity > max_capacity)
+    throw LengthException();
+  new_capacity = alignForward(new_capacity, BatchSize);
+
+  int new_size_in_bytes = component_count_ * new_capacity * isizeof(float);
+  auto* new_data = static_cast<float*>(tryAllocateAlignedMemory(new_size_in_bytes, Alignment));
+  if (!new_data)
+    throw OutOfMemoryException() << static_cast<size_t>(new_size_in_bytes);
+
+  // Padding is kept initialized, so kernels can process whole batches.
+  ::memset(new_data, 0, toUnsigned(new_size_in_bytes));
+  if (data_) {
+    for (int i = 0; i < component_count_; ++i)
+      ::memcpy(new_data + i * new_capacity, getComponent(i), toUnsigned(size_) * sizeof(float));
+    freeAlignedMemory(data_);
+  }
+  data_ = new_data;
+  capacity_ = new_capacity;
+}
+
+} // namespace detail
+
+namespace {
+
+// Number of points to process when whole batches are processed,
+// including padding.
+inline int getPaddedSize(int size) {
+  return alignForward(size, detail::PointBufferStorage::BatchSize);
+}
+
+// Number of points in whole batches, the rest needs scalar code.
+inline int getBatchedSize(int size) {
+  return size & ~(detail::PointBufferStorage::BatchSize - 1);
+}
+
+void findLaneRanges(const float* array, int count, float* lanes_min, float* lanes_max) {
+  #if CPU(X86_FAMILY) && !CPU_SIMD(AVX2)
+  if (CpuInfo::Supports(CpuFeature::Avx2)) {
+    detail::findRangeAvx2(array, count, lanes_min, lanes_max);
+    return;
+  }
+  #endif
+  FindRangeNx(array, count, lanes_min, lanes_max);
+}
+
+// Computes minimum and maximum of first |count| values in |array|.
+// |count| must be positive.
+void findRange(const float* array, int count, float& out_min, float& out_max) {
+  ASSERT(count > 0);
+  int batched = getBatchedSize(count);
+  float range_min = array[0];
+  float range_max = array[0];
+  if (batched) {
+    float lanes_min[8];
+    float lanes_max[8];
+    findLaneRanges(array, batched, lanes_min, lanes_max);
+    for (int i = 0; i < 8; ++i) {
+      range_min = min(range_min, lanes_min[i]);
+      range_max = max(range_max, lanes_max[i]);
+    }
+  }
+  for (int i = batched; i < count; ++i) {
+    range_min = min(range_min, array[i]);
+    range_max = max(range_max, array[i]);
+  }
+  out_min = range_min;
+  out_max = range_max;
+}
+
+void mapAffine2(float* xs, float* ys, int count, const float* matrix) {
+  #if CPU(X86_FAMILY) && !CPU_SIMD(AVX2)
+  if (CpuInfo::Supports(CpuFeature::Avx2)) {
+    detail::mapAffine2Avx2(xs, ys, count, matrix);
+    return;
+  }
+  #endif
+  MapAffine2Nx(xs, ys, count, matrix);
+}
+
+void mapPerspective2(float* xs, float* ys, int count, const float* matrix) {
+  #if CPU(X86_FAMILY) && !CPU_SIMD(AVX2)
+  if (CpuInfo::Supports(CpuFeature::Avx2)) {
+    detail::mapPerspective2Avx2(xs, ys, count, matrix);
+    return;
+  }
+  #endif
+  MapPerspective2Nx(xs, ys, count, matrix);
+}
+
+void mapAffine3(float* xs, float* ys, float* zs, int count, const float* matrix) {
+  #if CPU(X86_FAMILY) && !CPU_SIMD(AVX2)
+  if (CpuInfo::Supports(CpuFeature::Avx2)) {
+    detail::mapAffine3Avx2(xs, ys, zs, count, matrix);
+    return;
+  }
+  #endif
+  MapAffine3Nx(xs, ys, zs, count, matrix);
+}
+
+void mapPerspective3(float* xs, float* ys, float* zs, int count, const float* matrix) {
+  #if CPU(X86_FAMILY) && !CPU_SIMD(AVX2)
+  if (CpuInfo::Supports(CpuFeature::Avx2)) {
+    detail::mapPerspective3Avx2(xs, ys, zs, count, matrix);
+    return;
+  }
+  #endif
+  MapPerspective3Nx(xs, ys, zs, count, matrix);
+}
+
+void computeDistances2(
+    const float* xs, const float* ys, int count, const float* origin, float* distances) {
+  #if CPU(X86_FAMILY) && !CPU_SIMD(AVX2)
+  if (CpuInfo::Supports(CpuFeature::Avx2)) {
+    detail::computeDistances2Avx2(xs, ys, count, origin, distances);
+    return;
+  }
+  #endif
+  ComputeDistances2Nx(xs, ys, count, origin, distances);
+}
+
+void computeDistances3(
+    const float* xs, const float* ys, const float* zs, int count, const float* origin,
+    float* distances) {
+  #if CPU(X86_FAMILY) && !CPU_SIMD(AVX2)
+  if (CpuInfo::Supports(CpuFeature::Avx2)) {
+    detail::computeDistances3Avx2(xs, ys, zs, count, origin, distances);
+    return;
+  }
+  #endif
+  ComputeDistances3Nx(xs, ys, zs, count, origin, distances);
+}
+
+} // namespace
+
+void PointBuffer2::assign(const Point2* points, int count) {
+  ASSERT(count >= 0);
+  clear();
+  ensureCapacity(count);
+  resize(count);
+  float* xs = getXs();
+  float* ys = getYs();
+  for (int i = 0; i < count; ++i) {
+    xs[i] = points[i].x;
+    ys[i] = points[i].y;
+  }
+}
+
+void PointBuffer2::copyTo(Point2* points) const {
+  const float* xs = getXs();
+  const float* ys = getYs();
+  for (int i = 0; i < size(); ++i)
+    points[i] = Point2(xs[i], ys[i]);
+}
+
+void PointBuffer2::Transform(const Affine& affine) {
+  if (affine.IsIdentity())
+    return;
+  const float matrix[6] = {
+    affine.Get(Affine::EntryScaleX), affine.Get(Affine::EntryShearX), affine.Get(Affine::EntryTransX),
+    affine.Get(Affine::EntryShearY), affine.Get(Affine::EntryScaleY), affine.Get(Affine::EntryTransY),
+  };
+  mapAffine2(getXs(), getYs(), getPaddedSize(size()), matrix);
+}
+
+void PointBuffer2::Transform(const Xform2& xform) {
+  if (xform.IsIdentity())
+    return;
+
+  const float matrix[9] = {
+    xform.Get(Xform2::EntryScaleX), xform.Get(Xform2::EntryShearX), xform.Get(Xform2::EntryTransX),
+    xform.Get(Xform2::EntryShearY), xform.Get(Xform2::EntryScaleY), xform.Get(Xform2::EntryTransY),
+    xform.Get(Xform2::EntryPersp0), xform.Get(Xform2::EntryPersp1), xform.Get(Xform2::EntryLast),
+  };
+  int count = getPaddedSize(size());
+  if (!xform.HasPerspective())
+    mapAffine2(getXs(), getYs(), count, matrix);
+  else
+    mapPerspective2(getXs(), getYs(), count, matrix);
+}
+
+Bounds2 PointBuffer2::GetBounds() const {
+  if (isEmpty())
+    return Bounds2();
+  Bounds2 bounds;
+  findRange(getXs(), size(), bounds.min.x, bounds.max.x);
+  findRange(getYs(), size(), bounds.min.y, bounds.max.y);
+  return bounds;
+}
+
+void PointBuffer2::ComputeDistances(Point2 origin, float* distances) const {
+  const float* xs = getXs();
+  const float* ys = getYs();
+  int count = size();
+  int batched = getBatchedSize(count);
+
+  const float origin_array[2] = { origin.x, origin.y };
+  if (batched)
+    computeDistances2(xs, ys, batched, origin_array, distances);
+  for (int i = batched; i < count; ++i) {
+    float dx = xs[i] - origin.x;
+    float dy = ys[i] - origin.y;
+    distances[i] = mathSqrt(dx * dx + dy * dy);
+  }
+}
+
+void PointBuffer3::assign(const Point3* points, int count) {
+  ASSERT(count >= 0);
+  clear();
+  ensureCapacity(count);
+  resize(count);
+  float* xs = getXs();
+  float* ys = getYs();
+  float* zs = getZs();
+  for (int i = 0; i < count; ++i) {
+    xs[i] = points[i].x;
+    ys[i] = points[i].y;
+    zs[i] = points[i].z;
+  }
+}
+
+void PointBuffer3::copyTo(Point3* points) const {
+  const float* xs = getXs();
+  const float* ys = getYs();
+  const float* zs = getZs();
+  for (int i = 0; i < size(); ++i)
+    points[i] = Point3(xs[i], ys[i], zs[i]);
+}
+
+void PointBuffer3::Transform(const Xform3& xform) {
+  if (xform.IsIdentity())
+    return;
+
+  float matrix[16];
+  for (int row = 0; row < 4; ++row) {
+    for (int col = 0; col < 4; ++col)
+      matrix[row * 4 + col] = xform.Get(row, col);
+  }
+  int count = getPaddedSize(size());
+  if (!xform.HasPerspective())
+    mapAffine3(getXs(), getYs(), getZs(), count, matrix);
+  else
+    mapPerspective3(getXs(), getYs(), getZs(), count, matrix);
+}
+
+Bounds3 PointBuffer3::GetBounds() const {
+  if (isEmpty())
+    return Bounds3();
+  Bounds3 bounds;
+  findRange(getXs(), size(), bounds.min.x, bounds.max.x);
+  findRange(getYs(), size(), bounds.min.y, bounds.max.y);
+  findRange(getZs(), size(), bounds.min.z, bounds.max.z);
+  return bounds;
+}
+
+void PointBuffer3::ComputeDistances(Point3 origin, float* distances) const {
+  const float* xs = getXs();
+  const float* ys = getYs();
+  const float* zs = getZs();
+  int count = size();
+  int batched = getBatchedSize(count);
+
+  const float origin_array[3] = { origin.x, origin.y, origin.z };
+  if (batched)
+    computeDistances3(xs, ys, zs, batched, origin_array, distances);
+  for (int i = batched; i < count; ++i) {
+    float dx = xs[i] - origin.x;
+    float dy = ys[i] - origin.y;
+    float dz = zs[i] - origin.z;
+    distances[i] = mathSqrt(dx * dx + dy * dy + dz * dz);
+  }
+}
+
+} // namespace stp
@@ -0,0 +1,195 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#ifndef STP_BASE_GEOMETRY_POINTBUFFER_H_
+#define STP_BASE_GEOMETRY_POINTBUFFER_H_
+
+#include "Base/Debug/Assert.h"
+#include "Geometry/Vector2.h"
+#include "Geometry/Vector3.h"
+
+namespace stp {
+
+class Affine;
+class Xform2;
+class Xform3;
+struct Bounds2;
+struct Bounds3;
+
+namespace detail {
+
+// Aligned storage for a fixed number of float arrays of equal length.
+class BASE_EXPORT PointBufferStorage {
+  DISALLOW_COPY_AND_ASSIGN(PointBufferStorage);
+ public:
+  // Batch kernels process this many points at once. Capacity is always
+  // a multiple of this, so kernels never need a scalar tail to modify
+  // points in place.
+  static constexpr int BatchSize = 8;
+  // Enough for aligned loads of 256-bit vectors.
+  static constexpr int Alignment = 32;
+
+  explicit PointBufferStorage(int component_count) : component_count_(component_count) {}
+  ~PointBufferStorage();
+
+  PointBufferStorage(PointBufferStorage&& other) noexcept;
+  PointBufferStorage& operator=(PointBufferStorage&& other) noexcept;
+
+  ALWAYS_INLINE int size() const { return size_; }
+  ALWAYS_INLINE int capacity() const { return capacity_; }
+
+  ALWAYS_INLINE float* getComponent(int index) { return data_ + index * capacity_; }
+  ALWAYS_INLINE const float* getComponent(int index) const { return data_ + index * capacity_; }
+
+  void ensureCapacity(int request);
+  void willGrow(int n);
+  // New points have all coordinates set to zero.
+  void resize(int size);
+  void clear() { size_ = 0; }
+
+  // Returns index of the new point. Its coordinates are left for caller.
+  int addUninitialized() {
+    if (UNLIKELY(size_ == capacity_))
+      willGrow(1);
+    return size_++;
+  }
+
+ private:
+  void resizeStorage(int new_capacity);
+
+  float* data_ = nullptr;
+  int size_ = 0;
+  int capacity_ = 0;
+  int component_count_;
+};
+
+} // namespace detail
+
+// Holds 2D points as structure of arrays: all x coordinates in one array
+// and all y coordinates in another one. Unlike arrays of Point2 this layout
+// lets batch operations process 8 points per iteration without shuffles.
+//
+// Both arrays are aligned to 32 bytes and padded to a multiple of 8 points.
+class BASE_EXPORT PointBuffer2 {
+ public:
+  static constexpr int BatchSize = detail::PointBufferStorage::BatchSize;
+
+  PointBuffer2() : storage_(2) {}
+
+  ALWAYS_INLINE int size() const { return storage_.size(); }
+  ALWAYS_INLINE int capacity() const { return storage_.capacity(); }
+  ALWAYS_INLINE bool isEmpty() const { return size() == 0; }
+
+  void ensureCapacity(int request) { storage_.ensureCapacity(request); }
+  void willGrow(int n) { storage_.willGrow(n); }
+  void resize(int size) { storage_.resize(size); }
+  void clear() { storage_.clear(); }
+
+  ALWAYS_INLINE float* getXs() { return storage_.getComponent(0); }
+  ALWAYS_INLINE float* getYs() { return storage_.getComponent(1); }
+  ALWAYS_INLINE const float* getXs() const { return storage_.getComponent(0); }
+  ALWAYS_INLINE const float* getYs() const { return storage_.getComponent(1); }
+
+  Point2 get(int at) const;
+  void set(int at, Point2 point);
+  void add(Point2 point);
+
+  // Replaces content with |count| points from array of structs.
+  void assign(const Point2* points, int count);
+  // Copies all points out to array of structs.
+  void copyTo(Point2* points) const;
+
+  // Maps all points in place.
+  void Transform(const Affine& affine);
+  void Transform(const Xform2& xform);
+
+  // Returns smallest bounds containing all points (same as Bounds2::Enclose()).
+  Bounds2 GetBounds() const;
+
+  // Computes distance of each point to |origin| into |distances| (of size()).
+  void ComputeDistances(Point2 origin, float* distances) const;
+
+ private:
+  detail::PointBufferStorage storage_;
+};
+
+// Like PointBuffer2, but for 3D points.
+class BASE_EXPORT PointBuffer3 {
+ public:
+  static constexpr int BatchSize = detail::PointBufferStorage::BatchSize;
+
+  PointBuffer3() : storage_(3) {}
+
+  ALWAYS_INLINE int size() const { return storage_.size(); }
+  ALWAYS_INLINE int capacity() const { return storage_.capacity(); }
+  ALWAYS_INLINE bool isEmpty() const { return size() == 0; }
+
+  void ensureCapacity(int request) { storage_.ensureCapacity(request); }
+  void willGrow(int n) { storage_.willGrow(n); }
+  void resize(int size) { storage_.resize(size); }
+  void clear() { storage_.clear(); }
+
+  ALWAYS_INLINE float* getXs() { return storage_.getComponent(0); }
+  ALWAYS_INLINE float* getYs() { return storage_.getComponent(1); }
+  ALWAYS_INLINE float* getZs() { return storage_.getComponent(2); }
+  ALWAYS_INLINE const float* getXs() const { return storage_.getComponent(0); }
+  ALWAYS_INLINE const float* getYs() const { return storage_.getComponent(1); }
+  ALWAYS_INLINE const float* getZs() const { return storage_.getComponent(2); }
+
+  Point3 get(int at) const;
+  void set(int at, Point3 point);
+  void add(Point3 point);
+
+  void assign(const Point3* points, int count);
+  void copyTo(Point3* points) const;
+
+  // Maps all points in place, with the same semantics as Xform3::MapPoints().
+  void Transform(const Xform3& xform);
+
+  Bounds3 GetBounds() const;
+
+  void ComputeDistances(Point3 origin, float* distances) const;
+
+ private:
+  detail::PointBufferStorage storage_;
+};
+
+inline Point2 PointBuffer2::get(int at) const {
+  ASSERT(0 <= at && at < size());
+  return Point2(getXs()[at], getYs()[at]);
+}
+
+inline void PointBuffer2::set(int at, Point2 point) {
+  ASSERT(0 <= at && at < size());
+  getXs()[at] = point.x;
+  getYs()[at] = point.y;
+}
+
+inline void PointBuffer2::add(Point2 point) {
+  int at = storage_.addUninitialized();
+  getXs()[at] = point.x;
+  getYs()[at] = point.y;
+}
+
+inline Point3 PointBuffer3::get(int at) const {
+  ASSERT(0 <= at && at < size());
+  return Point3(getXs()[at], getYs()[at], getZs()[at]);
+}
+
+inline void PointBuffer3::set(int at, Point3 point) {
+  ASSERT(0 <= at && at < size());
+  getXs()[at] = point.x;
+  getYs()[at] = point.y;
+  getZs()[at] = point.z;
+}
+
+inline void PointBuffer3::add(Point3 point) {
+  int at = storage_.addUninitialized();
+  getXs()[at] = point.x;
+  getYs()[at] = point.y;
+  getZs()[at] = point.z;
+}
+
+} // namespace stp
+
+#endif // STP_BASE_GEOMETRY_POINTBUFFER_H_
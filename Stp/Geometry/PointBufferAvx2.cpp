@@ -0,0 +1,44 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+// This file is compiled with AVX2 enabled. Only reached after CpuInfo
+// reported AVX2 support, so nothing here may be called from elsewhere.
+
+#include "Geometry/PointBufferKernels.h"
+
+namespace stp {
+namespace detail {
+
+void findRangeAvx2(const float* array, int count, float* lanes_min, float* lanes_max) {
+  FindRangeNx(array, count, lanes_min, lanes_max);
+}
+
+void mapAffine2Avx2(float* xs, float* ys, int count, const float* matrix) {
+  MapAffine2Nx(xs, ys, count, matrix);
+}
+
+void mapPerspective2Avx2(float* xs, float* ys, int count, const float* matrix) {
+  MapPerspective2Nx(xs, ys, count, matrix);
+}
+
+void mapAffine3Avx2(float* xs, float* ys, float* zs, int count, const float* matrix) {
+  MapAffine3Nx(xs, ys, zs, count, matrix);
+}
+
+void mapPerspective3Avx2(float* xs, float* ys, float* zs, int count, const float* matrix) {
+  MapPerspective3Nx(xs, ys, zs, count, matrix);
+}
+
+void computeDistances2Avx2(
+    const float* xs, const float* ys, int count, const float* origin, float* distances) {
+  ComputeDistances2Nx(xs, ys, count, origin, distances);
+}
+
+void computeDistances3Avx2(
+    const float* xs, const float* ys, const float* zs, int count, const float* origin,
+    float* distances) {
+  ComputeDistances3Nx(xs, ys, zs, count, origin, distances);
+}
+
+} // namespace detail
+} // namespace stp
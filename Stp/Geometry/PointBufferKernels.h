@@ -0,0 +1,156 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#ifndef STP_BASE_GEOMETRY_POINTBUFFERKERNELS_H_
+#define STP_BASE_GEOMETRY_POINTBUFFERKERNELS_H_
+
+// Vectorized loops behind PointBuffer2 and PointBuffer3.
+//
+// Included by PointBuffer.cpp and by PointBufferAvx2.cpp, which is built with
+// AVX2 enabled and has Vec8f in a single 256-bit register. Everything here
+// has internal linkage and VecNx lives in a namespace specific to instruction
+// set, so the two instances never mix. Do not call inline functions from
+// other headers here: the linker might pick their AVX2 instances for use in
+// the rest of program. Scalar tails and lane reductions stay in
+// PointBuffer.cpp for the same reason.
+//
+// Each function processes |count| points, which must be a multiple of
+// PointBufferStorage::BatchSize. Arrays must be aligned to
+// PointBufferStorage::Alignment.
+
+#include "Base/Compiler/Simd.h"
+#include "Base/Simd/Vnx.h"
+
+namespace stp {
+
+namespace detail {
+
+#if CPU(X86_FAMILY)
+// Defined in translation unit built with AVX2 enabled.
+void findRangeAvx2(const float* array, int count, float* lanes_min, float* lanes_max);
+void mapAffine2Avx2(float* xs, float* ys, int count, const float* matrix);
+void mapPerspective2Avx2(float* xs, float* ys, int count, const float* matrix);
+void mapAffine3Avx2(float* xs, float* ys, float* zs, int count, const float* matrix);
+void mapPerspective3Avx2(float* xs, float* ys, float* zs, int count, const float* matrix);
+void computeDistances2Avx2(
+    const float* xs, const float* ys, int count, const float* origin, float* distances);
+void computeDistances3Avx2(
+    const float* xs, const float* ys, const float* zs, int count, const float* origin,
+    float* distances);
+#endif
+
+} // namespace detail
+
+// Stores per-lane minimum and maximum of |array| to |lanes_min| and
+// |lanes_max|, eight floats each.
+static void FindRangeNx(const float* array, int count, float* lanes_min, float* lanes_max) {
+  Vec8f vmin = Vec8f::load(array);
+  Vec8f vmax = vmin;
+  for (int i = 8; i < count; i += 8) {
+    Vec8f v = Vec8f::load(array + i);
+    vmin = min(vmin, v);
+    vmax = max(vmax, v);
+  }
+  vmin.store(lanes_min);
+  vmax.store(lanes_max);
+}
+
+// Maps points through affine matrix given as row-major 2x3 entries:
+//   x' = m[0] * x + m[1] * y + m[2]
+//   y' = m[3] * x + m[4] * y + m[5]
+static void MapAffine2Nx(float* xs, float* ys, int count, const float* m) {
+  Vec8f sx(m[0]), kx(m[1]), tx(m[2]);
+  Vec8f ky(m[3]), sy(m[4]), ty(m[5]);
+  for (int i = 0; i < count; i += 8) {
+    Vec8f x = Vec8f::load(xs + i);
+    Vec8f y = Vec8f::load(ys + i);
+    (sx * x + kx * y + tx).store(xs + i);
+    (ky * x + sy * y + ty).store(ys + i);
+  }
+}
+
+// Maps points through row-major 3x3 matrix with perspective.
+static void MapPerspective2Nx(float* xs, float* ys, int count, const float* m) {
+  Vec8f sx(m[0]), kx(m[1]), tx(m[2]);
+  Vec8f ky(m[3]), sy(m[4]), ty(m[5]);
+  Vec8f p0(m[6]), p1(m[7]), p2(m[8]);
+  Vec8f zero(0.f);
+  Vec8f one(1.f);
+  for (int i = 0; i < count; i += 8) {
+    Vec8f x = Vec8f::load(xs + i);
+    Vec8f y = Vec8f::load(ys + i);
+    Vec8f z = p0 * x + p1 * y + p2;
+    // Same as Xform2::MapPoints(): points at infinity collapse to zero.
+    z = VnxMath::ternary(z != zero, one / z, zero);
+    ((sx * x + kx * y + tx) * z).store(xs + i);
+    ((ky * x + sy * y + ty) * z).store(ys + i);
+  }
+}
+
+// Maps points through affine matrix given as row-major 3x4 entries.
+static void MapAffine3Nx(float* xs, float* ys, float* zs, int count, const float* m) {
+  Vec8f r[3][4];
+  for (int row = 0; row < 3; ++row) {
+    for (int col = 0; col < 4; ++col)
+      r[row][col] = Vec8f(m[row * 4 + col]);
+  }
+  for (int i = 0; i < count; i += 8) {
+    Vec8f x = Vec8f::load(xs + i);
+    Vec8f y = Vec8f::load(ys + i);
+    Vec8f z = Vec8f::load(zs + i);
+    (r[0][0] * x + r[0][1] * y + r[0][2] * z + r[0][3]).store(xs + i);
+    (r[1][0] * x + r[1][1] * y + r[1][2] * z + r[1][3]).store(ys + i);
+    (r[2][0] * x + r[2][1] * y + r[2][2] * z + r[2][3]).store(zs + i);
+  }
+}
+
+// Maps points through row-major 4x4 matrix with perspective.
+static void MapPerspective3Nx(float* xs, float* ys, float* zs, int count, const float* m) {
+  Vec8f r[4][4];
+  for (int row = 0; row < 4; ++row) {
+    for (int col = 0; col < 4; ++col)
+      r[row][col] = Vec8f(m[row * 4 + col]);
+  }
+  Vec8f zero(0.f);
+  Vec8f one(1.f);
+  for (int i = 0; i < count; i += 8) {
+    Vec8f x = Vec8f::load(xs + i);
+    Vec8f y = Vec8f::load(ys + i);
+    Vec8f z = Vec8f::load(zs + i);
+    Vec8f w = r[3][0] * x + r[3][1] * y + r[3][2] * z + r[3][3];
+    // Same as Xform3::MapPoint(): divide unless w is 0 or 1.
+    Vec8f w_inverse = VnxMath::ternary(w != zero, one / w, one);
+    ((r[0][0] * x + r[0][1] * y + r[0][2] * z + r[0][3]) * w_inverse).store(xs + i);
+    ((r[1][0] * x + r[1][1] * y + r[1][2] * z + r[1][3]) * w_inverse).store(ys + i);
+    ((r[2][0] * x + r[2][1] * y + r[2][2] * z + r[2][3]) * w_inverse).store(zs + i);
+  }
+}
+
+static void ComputeDistances2Nx(
+    const float* xs, const float* ys, int count, const float* origin, float* distances) {
+  Vec8f ox(origin[0]);
+  Vec8f oy(origin[1]);
+  for (int i = 0; i < count; i += 8) {
+    Vec8f dx = Vec8f::load(xs + i) - ox;
+    Vec8f dy = Vec8f::load(ys + i) - oy;
+    (dx * dx + dy * dy).mathSqrt().store(distances + i);
+  }
+}
+
+static void ComputeDistances3Nx(
+    const float* xs, const float* ys, const float* zs, int count, const float* origin,
+    float* distances) {
+  Vec8f ox(origin[0]);
+  Vec8f oy(origin[1]);
+  Vec8f oz(origin[2]);
+  for (int i = 0; i < count; i += 8) {
+    Vec8f dx = Vec8f::load(xs + i) - ox;
+    Vec8f dy = Vec8f::load(ys + i) - oy;
+    Vec8f dz = Vec8f::load(zs + i) - oz;
+    (dx * dx + dy * dy + dz * dz).mathSqrt().store(distances + i);
+  }
+}
+
+} // namespace stp
+
+#endif // STP_BASE_GEOMETRY_POINTBUFFERKERNELS_H_
@@ -0,0 +1,121 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Geometry/PointBuffer.h"
+
+#include "Base/Containers/List.h"
+#include "Base/Test/GTest.h"
+#include "Base/Test/PerfTest.h"
+#include "Base/Time/TimeTicks.h"
+#include "Base/Util/Random.h"
+#include "Base/Util/RandomUtil.h"
+#include "Geometry/Affine.h"
+#include "Geometry/Bounds2.h"
+#include "Geometry/Xform3.h"
+
+namespace stp {
+
+namespace {
+
+constexpr int PointCount = 1024 * 1024;
+constexpr int Iterations = 20;
+constexpr double TotalPointCount = static_cast<double>(PointCount) * Iterations;
+
+class PointBufferPerfTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    points2_.appendUninitialized(PointCount);
+    points3_.appendUninitialized(PointCount);
+    for (int i = 0; i < PointCount; ++i) {
+      points2_[i] = Point2(nextCoordinate(), nextCoordinate());
+      points3_[i] = Point3(nextCoordinate(), nextCoordinate(), nextCoordinate());
+    }
+    buffer2_.assign(points2_.data(), points2_.size());
+    buffer3_.assign(points3_.data(), points3_.size());
+  }
+
+  float nextCoordinate() { return (RandomUtil::NextUnitFloat(random_) * 2 - 1) * 1000; }
+
+  Random random_;
+  List<Point2> points2_;
+  List<Point3> points3_;
+  PointBuffer2 buffer2_;
+  PointBuffer3 buffer3_;
+};
+
+} // namespace
+
+TEST_F(PointBufferPerfTest, TransformAffine) {
+  // Scales down slightly, so values do not overflow over iterations.
+  Affine affine(0.9f, 0.1f, -0.1f, 0.9f, 1, 2);
+
+  TimeTicks start = TimeTicks::Now();
+  for (int i = 0; i < Iterations; ++i)
+    affine.MapPoints(points2_.data(), points2_.data(), points2_.size());
+  perf_test::PrintThroughput(
+      "transform_affine", "", "aos", TotalPointCount, TimeTicks::Now() - start, "Mpoints/s", true);
+
+  start = TimeTicks::Now();
+  for (int i = 0; i < Iterations; ++i)
+    buffer2_.Transform(affine);
+  perf_test::PrintThroughput(
+      "transform_affine", "", "soa", TotalPointCount, TimeTicks::Now() - start, "Mpoints/s", true);
+}
+
+TEST_F(PointBufferPerfTest, TransformXform3) {
+  Xform3 xform = Xform3::Identity();
+  xform.RotateAboutYAxis(0.1);
+  xform.Scale(0.9f, 0.9f, 0.9f);
+
+  TimeTicks start = TimeTicks::Now();
+  for (int i = 0; i < Iterations; ++i)
+    xform.MapPoints(points3_.data(), points3_.data(), points3_.size());
+  perf_test::PrintThroughput(
+      "transform_xform3", "", "aos", TotalPointCount, TimeTicks::Now() - start, "Mpoints/s", true);
+
+  start = TimeTicks::Now();
+  for (int i = 0; i < Iterations; ++i)
+    buffer3_.Transform(xform);
+  perf_test::PrintThroughput(
+      "transform_xform3", "", "soa", TotalPointCount, TimeTicks::Now() - start, "Mpoints/s", true);
+}
+
+TEST_F(PointBufferPerfTest, Bounds) {
+  Bounds2 aos_bounds;
+  TimeTicks start = TimeTicks::Now();
+  for (int i = 0; i < Iterations; ++i)
+    aos_bounds = Bounds2::Enclose(points2_.data(), points2_.size());
+  perf_test::PrintThroughput(
+      "bounds", "", "aos", TotalPointCount, TimeTicks::Now() - start, "Mpoints/s", true);
+
+  Bounds2 soa_bounds;
+  start = TimeTicks::Now();
+  for (int i = 0; i < Iterations; ++i)
+    soa_bounds = buffer2_.GetBounds();
+  perf_test::PrintThroughput(
+      "bounds", "", "soa", TotalPointCount, TimeTicks::Now() - start, "Mpoints/s", true);
+
+  EXPECT_EQ(aos_bounds, soa_bounds);
+}
+
+TEST_F(PointBufferPerfTest, Distances) {
+  List<float> distances;
+  float* output = distances.appendUninitialized(PointCount);
+  Point3 origin(1, 2, 3);
+
+  TimeTicks start = TimeTicks::Now();
+  for (int n = 0; n < Iterations; ++n) {
+    for (int i = 0; i < PointCount; ++i)
+      output[i] = static_cast<float>((points3_[i] - origin).GetLength());
+  }
+  perf_test::PrintThroughput(
+      "distances", "", "aos", TotalPointCount, TimeTicks::Now() - start, "Mpoints/s", true);
+
+  start = TimeTicks::Now();
+  for (int n = 0; n < Iterations; ++n)
+    buffer3_.ComputeDistances(origin, output);
+  perf_test::PrintThroughput(
+      "distances", "", "soa", TotalPointCount, TimeTicks::Now() - start, "Mpoints/s", true);
+}
+
+} // namespace stp
@@ -0,0 +1,213 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Geometry/PointBuffer.h"
+
+#include "Base/Containers/List.h"
+#include "Base/Math/Alignment.h"
+#include "Base/Test/GTest.h"
+#include "Base/Util/Random.h"
+#include "Base/Util/RandomUtil.h"
+#include "Geometry/Affine.h"
+#include "Geometry/Bounds2.h"
+#include "Geometry/Bounds3.h"
+#include "Geometry/Xform2.h"
+#include "Geometry/Xform3.h"
+
+namespace stp {
+namespace {
+
+class PointBufferTest : public testing::Test {
+ protected:
+  // Deterministic pseudo-random value in range [-range, range).
+  float nextFloat(float range) { return (RandomUtil::NextUnitFloat(random_) * 2 - 1) * range; }
+
+  List<Point2> makePoints2(int count) {
+    List<Point2> points;
+    for (int i = 0; i < count; ++i)
+      points.add(Point2(nextFloat(100), nextFloat(100)));
+    return points;
+  }
+
+  List<Point3> makePoints3(int count) {
+    List<Point3> points;
+    for (int i = 0; i < count; ++i)
+      points.add(Point3(nextFloat(100), nextFloat(100), nextFloat(100)));
+    return points;
+  }
+
+  Random random_;
+};
+
+// Odd sizes to exercise partial batches.
+const int TestSizes[] = { 0, 1, 7, 8, 9, 31, 100 };
+
+TEST_F(PointBufferTest, Storage) {
+  PointBuffer2 buffer;
+  EXPECT_TRUE(buffer.isEmpty());
+  EXPECT_EQ(0, buffer.capacity());
+
+  buffer.add(Point2(1, 2));
+  buffer.add(Point2(3, 4));
+  EXPECT_EQ(2, buffer.size());
+  EXPECT_EQ(0, buffer.capacity() % PointBuffer2::BatchSize);
+  EXPECT_TRUE(isAlignedTo(buffer.getXs(), 32));
+  EXPECT_TRUE(isAlignedTo(buffer.getYs(), 32));
+  EXPECT_EQ(Point2(3, 4), buffer.get(1));
+
+  for (int i = 0; i < 100; ++i)
+    buffer.add(Point2(i, -i));
+  EXPECT_EQ(102, buffer.size());
+  EXPECT_EQ(Point2(1, 2), buffer.get(0));
+  EXPECT_EQ(Point2(99, -99), buffer.get(101));
+
+  buffer.set(0, Point2(5, 6));
+  EXPECT_EQ(Point2(5, 6), buffer.get(0));
+
+  buffer.resize(1);
+  buffer.resize(3);
+  EXPECT_EQ(Point2(5, 6), buffer.get(0));
+  EXPECT_EQ(Point2(0, 0), buffer.get(2));
+
+  PointBuffer2 moved = move(buffer);
+  EXPECT_EQ(3, moved.size());
+  EXPECT_EQ(0, buffer.size());
+
+  moved.clear();
+  EXPECT_TRUE(moved.isEmpty());
+}
+
+TEST_F(PointBufferTest, AssignAndCopy) {
+  auto points = makePoints3(37);
+  PointBuffer3 buffer;
+  buffer.assign(points.data(), points.size());
+  ASSERT_EQ(points.size(), buffer.size());
+
+  List<Point3> copied;
+  buffer.copyTo(copied.appendUninitialized(buffer.size()));
+  for (int i = 0; i < points.size(); ++i) {
+    EXPECT_EQ(points[i], buffer.get(i));
+    EXPECT_EQ(points[i], copied[i]);
+  }
+}
+
+TEST_F(PointBufferTest, TransformAffine) {
+  Affine affine(1.5f, 0.25f, -0.5f, 2, 10, -20);
+  for (int size : TestSizes) {
+    auto points = makePoints2(size);
+    PointBuffer2 buffer;
+    buffer.assign(points.data(), points.size());
+
+    buffer.Transform(affine);
+    affine.MapPoints(points.data(), points.data(), points.size());
+    for (int i = 0; i < size; ++i)
+      EXPECT_TRUE(isNear(points[i], buffer.get(i), 1e-4f)) << "at " << i;
+  }
+}
+
+TEST_F(PointBufferTest, TransformXform2) {
+  const Xform2 xforms[] = {
+    Xform2(2, 0, 0, 3, 5, 7),
+    Xform2(1, 0.5f, 10, -0.5f, 1, 20, 0.001f, 0.002f, 1),
+    // Maps some points to infinity.
+    Xform2(1, 0, 0, 0, 1, 0, 1, 0, 0),
+  };
+  for (const Xform2& xform : xforms) {
+    for (int size : TestSizes) {
+      auto points = makePoints2(size);
+      if (size)
+        points[0] = Point2(0, 5);
+      PointBuffer2 buffer;
+      buffer.assign(points.data(), points.size());
+
+      buffer.Transform(xform);
+      xform.MapPoints(points.data(), points.data(), points.size());
+      for (int i = 0; i < size; ++i)
+        EXPECT_TRUE(isNear(points[i], buffer.get(i), 1e-3f)) << "at " << i;
+    }
+  }
+}
+
+TEST_F(PointBufferTest, TransformXform3) {
+  Xform3 affine = Xform3::Identity();
+  affine.Translate(1, 2, 3);
+  affine.Scale(2, 3, 4);
+  affine.RotateAboutZAxis(0.5);
+
+  Xform3 perspective(
+      1, 0, 0, 0,
+      0, 1, 0, 0,
+      0, 0, 1, 0,
+      0, 0, -0.01f, 1);
+
+  for (const Xform3& xform : { affine, perspective }) {
+    for (int size : TestSizes) {
+      auto points = makePoints3(size);
+      PointBuffer3 buffer;
+      buffer.assign(points.data(), points.size());
+
+      buffer.Transform(xform);
+      xform.MapPoints(points.data(), points.data(), points.size());
+      for (int i = 0; i < size; ++i) {
+        float tolerance = 1e-5f * max(1.f, static_cast<float>(points[i].GetLength()));
+        EXPECT_TRUE(isNear(points[i], buffer.get(i), tolerance)) << "at " << i;
+      }
+    }
+  }
+}
+
+TEST_F(PointBufferTest, GetBounds) {
+  for (int size : TestSizes) {
+    auto points2 = makePoints2(size);
+    PointBuffer2 buffer2;
+    buffer2.assign(points2.data(), points2.size());
+    EXPECT_EQ(Bounds2::Enclose(points2.data(), points2.size()), buffer2.GetBounds());
+
+    auto points3 = makePoints3(size);
+    PointBuffer3 buffer3;
+    buffer3.assign(points3.data(), points3.size());
+    Bounds3 expected;
+    if (size) {
+      expected = Bounds3(points3[0], points3[0]);
+      for (const Point3& p : points3) {
+        expected.min = Point3(min(expected.min.x, p.x), min(expected.min.y, p.y), min(expected.min.z, p.z));
+        expected.max = Point3(max(expected.max.x, p.x), max(expected.max.y, p.y), max(expected.max.z, p.z));
+      }
+    }
+    EXPECT_EQ(expected, buffer3.GetBounds());
+  }
+}
+
+TEST_F(PointBufferTest, GetBoundsIgnoresPadding) {
+  // Padding is zero, which must not extend bounds.
+  PointBuffer2 buffer;
+  for (int i = 0; i < 9; ++i)
+    buffer.add(Point2(10 + i, 20 + i));
+  EXPECT_EQ(Bounds2(10, 20, 18, 28), buffer.GetBounds());
+}
+
+TEST_F(PointBufferTest, ComputeDistances) {
+  Point2 origin2(3, -4);
+  Point3 origin3(3, -4, 5);
+  for (int size : TestSizes) {
+    auto points2 = makePoints2(size);
+    PointBuffer2 buffer2;
+    buffer2.assign(points2.data(), points2.size());
+    List<float> distances2;
+    buffer2.ComputeDistances(origin2, distances2.appendUninitialized(size));
+
+    auto points3 = makePoints3(size);
+    PointBuffer3 buffer3;
+    buffer3.assign(points3.data(), points3.size());
+    List<float> distances3;
+    buffer3.ComputeDistances(origin3, distances3.appendUninitialized(size));
+
+    for (int i = 0; i < size; ++i) {
+      EXPECT_FLOAT_EQ((points2[i] - origin2).GetLength(), distances2[i]);
+      EXPECT_FLOAT_EQ((points3[i] - origin3).GetLength(), distances3[i]);
+    }
+  }
+}
+
+} // namespace
+} // namespace stp
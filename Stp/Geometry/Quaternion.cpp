@@ -8,7 +8,9 @@
 #include "Base/Debug/Assert.h"
 #include "Base/Io/TextWriter.h"
 #include "Base/Math/Math.h"
+#include "Base/System/CpuInfo.h"
 #include "Base/Type/Limits.h"
+#include "Geometry/QuaternionBatch.h"
 
 namespace stp {
 
@@ -158,6 +160,32 @@ Quaternion Slerp(const Quaternion& q1, const Quaternion& q2, double t) {
   return q1 * scale1 + q2 * scale2;
 }
 
+void lerpEach(
+    Span<Quaternion> from, Span<Quaternion> to, Span<float> t,
+    MutableSpan<Quaternion> out) {
+  ASSERT(from.size() == to.size() && to.size() == t.size() && t.size() == out.size());
+  #if CPU(X86_FAMILY) && !CPU_SIMD(AVX2)
+  if (CpuInfo::Supports(CpuFeature::Avx2)) {
+    detail::lerpEachAvx2(from.data(), to.data(), t.data(), out.data(), out.size());
+    return;
+  }
+  #endif
+  InterpolateEach(from.data(), to.data(), t.data(), out.data(), out.size(), LerpNx);
+}
+
+void SlerpEach(
+    Span<Quaternion> from, Span<Quaternion> to, Span<float> t,
+    MutableSpan<Quaternion> out) {
+  ASSERT(from.size() == to.size() && to.size() == t.size() && t.size() == out.size());
+  #if CPU(X86_FAMILY) && !CPU_SIMD(AVX2)
+  if (CpuInfo::Supports(CpuFeature::Avx2)) {
+    detail::SlerpEachAvx2(from.data(), to.data(), t.data(), out.data(), out.size());
+    return;
+  }
+  #endif
+  InterpolateEach(from.data(), to.data(), t.data(), out.data(), out.size(), SlerpNx);
+}
+
 bool isNear(const Quaternion& lhs, const Quaternion& rhs, double tolerance) {
   return isNear(lhs.w, rhs.w, tolerance) &&
          isNear(lhs.x, rhs.x, tolerance) &&
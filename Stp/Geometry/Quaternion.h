@@ -4,6 +4,7 @@
 #ifndef STP_BASE_GEOMETRY_QUATERNION_H_
 #define STP_BASE_GEOMETRY_QUATERNION_H_
 
+#include "Base/Containers/Span.h"
 #include "Geometry/Angle.h"
 #include "Geometry/Vector3.h"
 
@@ -100,6 +101,16 @@ BASE_EXPORT Quaternion lerp(const Quaternion& q1, const Quaternion& q2, double t
 // Spherical linear interpolation between two quaternions
 BASE_EXPORT Quaternion Slerp(const Quaternion& q1, const Quaternion& q2, double t);
 
+// Batched versions of lerp() and Slerp(), interpolating |from[i]| to |to[i]|
+// by |t[i]|. Computed in single precision, eight quaternions at a time.
+// |out| may be the same span as |from| or |to|.
+BASE_EXPORT void lerpEach(
+    Span<Quaternion> from, Span<Quaternion> to, Span<float> t,
+    MutableSpan<Quaternion> out);
+BASE_EXPORT void SlerpEach(
+    Span<Quaternion> from, Span<Quaternion> to, Span<float> t,
+    MutableSpan<Quaternion> out);
+
 BASE_EXPORT bool isNear(const Quaternion& lhs, const Quaternion& rhs, double tolerance);
 
 BASE_EXPORT double DotProduct(const Quaternion& lhs, const Quaternion& rhs);
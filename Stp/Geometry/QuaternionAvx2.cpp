@@ -0,0 +1,25 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+// This file is compiled with AVX2 enabled. Only reached after CpuInfo
+// reported AVX2 support, so nothing here may be called from elsewhere.
+
+#include "Geometry/QuaternionBatch.h"
+
+namespace stp {
+namespace detail {
+
+void lerpEachAvx2(
+    const Quaternion* from, const Quaternion* to, const float* t,
+    Quaternion* out, int count) {
+  InterpolateEach(from, to, t, out, count, LerpNx);
+}
+
+void SlerpEachAvx2(
+    const Quaternion* from, const Quaternion* to, const float* t,
+    Quaternion* out, int count) {
+  InterpolateEach(from, to, t, out, count, SlerpNx);
+}
+
+} // namespace detail
+} // namespace stp
@@ -0,0 +1,163 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#ifndef STP_BASE_GEOMETRY_QUATERNIONBATCH_H_
+#define STP_BASE_GEOMETRY_QUATERNIONBATCH_H_
+
+// Batched interpolation behind lerpEach() and SlerpEach().
+//
+// Included by Quaternion.cpp and by QuaternionAvx2.cpp, which is built with
+// AVX2 enabled and has Vec8f in a single 256-bit register. Everything here
+// has internal linkage and VecNx lives in a namespace specific to instruction
+// set, so the two instances never mix. Do not call inline functions from
+// other headers here: the linker might pick their AVX2 instances for use in
+// the rest of program.
+
+#include "Base/Compiler/Simd.h"
+#include "Base/Math/Math.h"
+#include "Base/Simd/Vnx.h"
+#include "Base/Type/Limits.h"
+#include "Geometry/Quaternion.h"
+
+namespace stp {
+
+namespace detail {
+
+#if CPU(X86_FAMILY)
+// Defined in translation unit built with AVX2 enabled.
+void lerpEachAvx2(
+    const Quaternion* from, const Quaternion* to, const float* t,
+    Quaternion* out, int count);
+void SlerpEachAvx2(
+    const Quaternion* from, const Quaternion* to, const float* t,
+    Quaternion* out, int count);
+#endif
+
+} // namespace detail
+
+// Batched functions process eight quaternions at once. Each vector holds
+// single component of all quaternions in the batch.
+static const int BatchSize = 8;
+
+// Transposes up to BatchSize quaternions into vectors of components.
+// Missing tail lanes replicate the first quaternion.
+static void LoadBatch(const Quaternion* qs, int count, Vec8f out[4]) {
+  float components[4][BatchSize];
+  for (int k = 0; k < BatchSize; ++k) {
+    const Quaternion& q = qs[k < count ? k : 0];
+    components[0][k] = static_cast<float>(q.w);
+    components[1][k] = static_cast<float>(q.x);
+    components[2][k] = static_cast<float>(q.y);
+    components[3][k] = static_cast<float>(q.z);
+  }
+  for (int j = 0; j < 4; ++j)
+    out[j] = Vec8f::load(components[j]);
+}
+
+// Components are assigned one by one - see the file comment.
+static void StoreBatch(const Vec8f in[4], int count, Quaternion* qs) {
+  float components[4][BatchSize];
+  for (int j = 0; j < 4; ++j)
+    in[j].store(components[j]);
+  for (int k = 0; k < count; ++k) {
+    qs[k].w = components[0][k];
+    qs[k].x = components[1][k];
+    qs[k].y = components[2][k];
+    qs[k].z = components[3][k];
+  }
+}
+
+static Vec8f LoadProgress(const float* ts, int count) {
+  if (count == BatchSize)
+    return Vec8f::load(ts);
+  return Vec8f::loadMasked(ts, count);
+}
+
+// Cephes approximation of asin() on [0, 0.5].
+static Vec8f AsinPolyNx(const Vec8f& x) {
+  Vec8f z = x * x;
+  Vec8f p = (((z * 4.2163199048e-2f + 2.4181311049e-2f) * z + 4.5470025998e-2f) * z
+             + 7.4953002686e-2f) * z + 1.6666752422e-1f;
+  return x + x * z * p;
+}
+
+static Vec8f AcosNx(const Vec8f& x) {
+  constexpr float Pi = static_cast<float>(MathPi);
+
+  // Close to -1 and 1 use acos(|x|) = 2 * asin(sqrt((1 - |x|) / 2)),
+  // which keeps precision where derivative of acos() grows.
+  Vec8f a = x.mathAbs();
+  Vec8f outer = AsinPolyNx(((Vec8f(1) - a) * 0.5f).mathSqrt()) * 2;
+  outer = VnxMath::ternary(x < Vec8f(0), Vec8f(Pi) - outer, outer);
+  Vec8f inner = Vec8f(Pi * 0.5f) - AsinPolyNx(x);
+  return VnxMath::ternary(a > Vec8f(0.5f), outer, inner);
+}
+
+static Vec8f SinNx(const Vec8f& x) {
+  // Reduce argument to [-pi/2, pi/2] with sin(x) = (-1)^k * sin(x - k * pi).
+  // Pi is split into two parts to keep the reduction exact for small k.
+  constexpr float PiHi = 3.140625f;
+  constexpr float PiLo = static_cast<float>(MathPi - 3.140625);
+  Vec8f k = (x * static_cast<float>(1 / MathPi) + 0.5f).mathFloor();
+  Vec8f r = x - k * PiHi - k * PiLo;
+  Vec8f odd = k - (k * 0.5f).mathFloor() * 2;
+  Vec8f sign = Vec8f(1) - odd * 2;
+
+  // Taylor series up to 11th degree, error below 1e-7 on the reduced range.
+  Vec8f r2 = r * r;
+  Vec8f p = ((((r2 * (-1.f / 39916800) + 1.f / 362880) * r2 - 1.f / 5040) * r2
+              + 1.f / 120) * r2 - 1.f / 6) * r2 + 1;
+  return r * p * sign;
+}
+
+// Vectorized variant of Slerp().
+static void SlerpNx(const Vec8f q1[4], const Vec8f q2[4], const Vec8f& t, Vec8f out[4]) {
+  Vec8f dot = q1[0] * q2[0] + q1[1] * q2[1] + q1[2] * q2[2] + q1[3] * q2[3];
+  dot = min(max(dot, Vec8f(-1)), Vec8f(1));
+
+  Vec8f theta = AcosNx(dot);
+  Vec8f inv_denom = Vec8f(1) / (Vec8f(1) - dot * dot).mathSqrt();
+  Vec8f scale1 = SinNx((Vec8f(1) - t) * theta) * inv_denom;
+  Vec8f scale2 = SinNx(t * theta) * inv_denom;
+
+  // Like Slerp() return |q1| for parallel quaternions, where the denominator
+  // vanishes.
+  Vec8f parallel = dot.mathAbs() >= Vec8f(1 - Limits<float>::Epsilon);
+  scale1 = VnxMath::ternary(parallel, Vec8f(1), scale1);
+  scale2 = VnxMath::ternary(parallel, Vec8f(0), scale2);
+
+  for (int j = 0; j < 4; ++j)
+    out[j] = q1[j] * scale1 + q2[j] * scale2;
+}
+
+// Vectorized variant of lerp().
+static void LerpNx(const Vec8f q1[4], const Vec8f q2[4], const Vec8f& t, Vec8f out[4]) {
+  Vec8f s = Vec8f(1) - t;
+  for (int j = 0; j < 4; ++j)
+    out[j] = q1[j] * s + q2[j] * t;
+
+  Vec8f length_squared = out[0] * out[0] + out[1] * out[1] + out[2] * out[2] + out[3] * out[3];
+  Vec8f scale = VnxMath::ternary(
+      length_squared <= Vec8f(Limits<float>::Epsilon),
+      Vec8f(1), Vec8f(1) / length_squared.mathSqrt());
+  for (int j = 0; j < 4; ++j)
+    out[j] = out[j] * scale;
+}
+
+template<typename TKernel>
+static void InterpolateEach(
+    const Quaternion* from, const Quaternion* to, const float* t,
+    Quaternion* out, int count, TKernel kernel) {
+  for (int i = 0; i < count; i += BatchSize) {
+    int batch_count = count - i < BatchSize ? count - i : BatchSize;
+    Vec8f q1[4], q2[4], result[4];
+    LoadBatch(from + i, batch_count, q1);
+    LoadBatch(to + i, batch_count, q2);
+    kernel(q1, q2, LoadProgress(t + i, batch_count), result);
+    StoreBatch(result, batch_count, out + i);
+  }
+}
+
+} // namespace stp
+
+#endif // STP_BASE_GEOMETRY_QUATERNIONBATCH_H_
@@ -0,0 +1,95 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Geometry/Quaternion.h"
+
+#include "Base/Containers/List.h"
+#include "Base/Test/GTest.h"
+#include "Base/Test/PerfTest.h"
+#include "Base/Time/TimeTicks.h"
+#include "Base/Util/Random.h"
+#include "Base/Util/RandomUtil.h"
+
+namespace stp {
+
+namespace {
+
+constexpr int QuaternionCount = 64 * 1024;
+constexpr int Iterations = 20;
+constexpr double OperationCount = static_cast<double>(Iterations) * QuaternionCount;
+
+class QuaternionPerfTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    for (int i = 0; i < QuaternionCount; ++i) {
+      from_.add(Quaternion::FromEulerAngles(nextFloat() * 6, nextFloat() * 6, nextFloat() * 6));
+      to_.add(Quaternion::FromEulerAngles(nextFloat() * 6, nextFloat() * 6, nextFloat() * 6));
+      t_.add(nextFloat());
+    }
+    out_.appendUninitialized(QuaternionCount);
+  }
+
+  float nextFloat() { return RandomUtil::NextUnitFloat(random_); }
+
+  List<Quaternion> from_;
+  List<Quaternion> to_;
+  List<float> t_;
+  List<Quaternion> out_;
+  Random random_;
+};
+
+} // namespace
+
+TEST_F(QuaternionPerfTest, Concat) {
+  TimeTicks start = TimeTicks::Now();
+  for (int n = 0; n < Iterations; ++n) {
+    for (int i = 0; i < QuaternionCount; ++i)
+      out_[i].SetConcat(from_[i], to_[i]);
+  }
+  perf_test::PrintThroughput(
+      "concat", "", "scalar", OperationCount, TimeTicks::Now() - start, "Mops/s", true);
+}
+
+TEST_F(QuaternionPerfTest, FromEulerAngles) {
+  TimeTicks start = TimeTicks::Now();
+  for (int n = 0; n < Iterations; ++n) {
+    for (int i = 0; i < QuaternionCount; ++i)
+      out_[i] = Quaternion::FromEulerAngles(from_[i].x, from_[i].y, from_[i].z);
+  }
+  perf_test::PrintThroughput(
+      "from_euler_angles", "", "scalar", OperationCount, TimeTicks::Now() - start, "Mops/s", true);
+}
+
+TEST_F(QuaternionPerfTest, Lerp) {
+  TimeTicks start = TimeTicks::Now();
+  for (int n = 0; n < Iterations; ++n) {
+    for (int i = 0; i < QuaternionCount; ++i)
+      out_[i] = lerp(from_[i], to_[i], t_[i]);
+  }
+  perf_test::PrintThroughput(
+      "lerp", "", "scalar", OperationCount, TimeTicks::Now() - start, "Mops/s", true);
+
+  start = TimeTicks::Now();
+  for (int n = 0; n < Iterations; ++n)
+    lerpEach(from_, to_, t_, out_);
+  perf_test::PrintThroughput(
+      "lerp", "", "each", OperationCount, TimeTicks::Now() - start, "Mops/s", true);
+}
+
+TEST_F(QuaternionPerfTest, Slerp) {
+  TimeTicks start = TimeTicks::Now();
+  for (int n = 0; n < Iterations; ++n) {
+    for (int i = 0; i < QuaternionCount; ++i)
+      out_[i] = Slerp(from_[i], to_[i], t_[i]);
+  }
+  perf_test::PrintThroughput(
+      "slerp", "", "scalar", OperationCount, TimeTicks::Now() - start, "Mops/s", true);
+
+  start = TimeTicks::Now();
+  for (int n = 0; n < Iterations; ++n)
+    SlerpEach(from_, to_, t_, out_);
+  perf_test::PrintThroughput(
+      "slerp", "", "each", OperationCount, TimeTicks::Now() - start, "Mops/s", true);
+}
+
+} // namespace stp
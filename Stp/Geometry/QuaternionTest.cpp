@@ -5,6 +5,7 @@
 
 #include "Geometry/Quaternion.h"
 
+#include "Base/Containers/List.h"
 #include "Base/Test/GTest.h"
 
 namespace stp {
@@ -12,6 +13,16 @@ namespace {
 
 constexpr double TestEpsilon = 1E-7;
 
+// Batched interpolation runs in single precision.
+constexpr double BatchTestEpsilon = 1E-5;
+
+void ExpectNearQuaternions(const Quaternion& a, const Quaternion& b, double tolerance) {
+  EXPECT_NEAR(a.w, b.w, tolerance);
+  EXPECT_NEAR(a.x, b.x, tolerance);
+  EXPECT_NEAR(a.y, b.y, tolerance);
+  EXPECT_NEAR(a.z, b.z, tolerance);
+}
+
 void CompareQuaternions(const Quaternion& a, const Quaternion& b) {
   EXPECT_FLOAT_EQ(a.w, b.w);
   EXPECT_FLOAT_EQ(a.x, b.x);
@@ -143,5 +154,41 @@ TEST(QuaternionTest, SlerpOppositeAngles) {
   EXPECT_NEAR(expected.w, interpolated.w, TestEpsilon);
 }
 
+TEST(QuaternionTest, InterpolateEach) {
+  List<Quaternion> from;
+  List<Quaternion> to;
+  List<float> t;
+  // Angles between quaternions span whole range of dot product.
+  for (int i = 0; i < 37; ++i) {
+    from.add(Quaternion::FromAngleAxis(0.1 * i, Vector3(1, i % 5, 2)));
+    to.add(Quaternion::FromAngleAxis(1 - 0.15 * i, Vector3(i % 3, 1, -1)));
+    t.add(i * 1.5f / 36 - 0.25f);
+  }
+  // Parallel and opposite quaternions.
+  from.add(to[5]);
+  to.add(to[5]);
+  t.add(0.5f);
+  from.add(to[7] * -1);
+  to.add(to[7]);
+  t.add(0.5f);
+
+  List<Quaternion> slerped;
+  slerped.appendUninitialized(from.size());
+  SlerpEach(from, to, t, slerped);
+
+  List<Quaternion> lerped;
+  lerped.appendUninitialized(from.size());
+  lerpEach(from, to, t, lerped);
+
+  for (int i = 0; i < from.size(); ++i) {
+    ExpectNearQuaternions(Slerp(from[i], to[i], t[i]), slerped[i], BatchTestEpsilon);
+    ExpectNearQuaternions(lerp(from[i], to[i], t[i]), lerped[i], BatchTestEpsilon);
+  }
+
+  // Output may alias input.
+  SlerpEach(from, to, t, from);
+  EXPECT_EQ(slerped, from);
+}
+
 } // namespace
 } // namespace stp
@@ -0,0 +1,610 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#ifndef STP_BASE_GEOMETRY_RSTARTREE_H_
+#define STP_BASE_GEOMETRY_RSTARTREE_H_
+
+#include "Base/Containers/Sorting.h"
+#include "Geometry/RTreeImpl.h"
+
+namespace stp {
+
+// Dynamic spatial index over bounds (R*-tree by Beckmann et al.).
+// Insertion chooses subtrees minimizing overlap, overflowing nodes first
+// reinsert their outermost entries and only then split along the axis
+// with smallest margin. Nodes share the cache-line layout of PackedRTree.
+//
+// Items are identified by |id| given on insertion. Ids do not need to be
+// unique, Remove() removes any one item with matching id and bounds.
+// Intersection has the same semantics as Bounds2::Intersects().
+template<typename TBounds>
+class RStarTree {
+  DISALLOW_COPY_AND_ASSIGN(RStarTree);
+ public:
+  typedef typename detail::RTreeTraits<TBounds>::PointType PointType;
+
+  static constexpr int MaxEntries = detail::RTreeNodeCapacity;
+  // About 40% and 30% of capacity, as recommended by the paper.
+  static constexpr int MinEntries = 6;
+  static constexpr int ReinsertCount = 5;
+
+  RStarTree() {}
+
+  RStarTree(RStarTree&& other) = default;
+  RStarTree& operator=(RStarTree&& other) = default;
+
+  void Insert(const TBounds& bounds, int id);
+
+  // Returns false if no item with given |bounds| and |id| was found.
+  bool Remove(const TBounds& bounds, int id);
+
+  void clear();
+
+  int size() const { return size_; }
+  bool isEmpty() const { return size_ == 0; }
+
+  // Returns union of all items. Not defined for empty tree.
+  TBounds GetBounds() const;
+
+  // Calls |visitor(id)| for every item intersecting |query|.
+  // The tree must not be modified from within |visitor|.
+  template<typename TVisitor>
+  void VisitIntersecting(const TBounds& query, TVisitor&& visitor) const;
+
+  void FindIntersecting(const TBounds& query, List<int>& out_ids) const {
+    VisitIntersecting(query, [&out_ids](int id) { out_ids.add(id); });
+  }
+
+  void FindContaining(const PointType& point, List<int>& out_ids) const {
+    FindIntersecting(TBounds(point, point), out_ids);
+  }
+
+  // Appends ids of up to |count| items nearest to |point|, ordered by distance.
+  void FindNearest(const PointType& point, int count, List<int>& out_ids) const;
+
+  // Verifies structure of the tree: fill factor of nodes, bounds of
+  // subtrees and links between nodes.
+  bool IsValidForTesting() const;
+
+ private:
+  struct Node : detail::RTreeNodeBounds<TBounds> {
+    // Indices of child nodes, or ids of items in leaves.
+    int32_t children[MaxEntries];
+    int32_t count;
+    // Leaves are at level 0.
+    int32_t level;
+    int32_t parent;
+    int32_t padding_[13];
+  };
+
+  struct Entry {
+    TBounds bounds;
+    int32_t child;
+  };
+
+  // Subtrees deeper than this would need more than 2^31 items.
+  static constexpr int TraversalStackSize = 256;
+
+  int AllocateNode(int level, int parent);
+  void FreeNode(int node) { free_nodes_.add(node); }
+
+  void InsertEntry(const Entry& entry, int level);
+  int ChooseSubtree(int node, const TBounds& bounds) const;
+  void AddEntry(int node, const Entry& entry);
+  void HandleOverflow(int node, const Entry& extra);
+  void Reinsert(int node, Entry* entries);
+  void Split(int node, Entry* entries);
+
+  void SetEntries(int node, const Entry* entries, int count);
+  int FindSlotInParent(int node) const;
+  void UpdateBoundsUpward(int node);
+
+  bool FindLeaf(int node, const TBounds& bounds, int id, int& out_leaf, int& out_slot) const;
+  void CondenseTree(int leaf);
+  void ReinsertOrphan(const Entry& entry, int level);
+
+  bool IsNodeValid(int node, int& item_count) const;
+
+  detail::RTreeNodeArray<Node> nodes_;
+  List<int> free_nodes_;
+  int root_ = -1;
+  int size_ = 0;
+  // Bit set of levels where overflowing node reinserted its entries during
+  // current insertion. Reinsertion is done only once per level.
+  uint32_t reinserted_levels_ = 0;
+};
+
+typedef RStarTree<Bounds2> RStarTree2;
+typedef RStarTree<IntBounds2> IntRStarTree2;
+
+template<typename TBounds>
+void RStarTree<TBounds>::Insert(const TBounds& bounds, int id) {
+  if (root_ < 0)
+    root_ = AllocateNode(0, -1);
+  reinserted_levels_ = 0;
+  InsertEntry(Entry { bounds, id }, 0);
+  ++size_;
+}
+
+template<typename TBounds>
+bool RStarTree<TBounds>::Remove(const TBounds& bounds, int id) {
+  int leaf, slot;
+  if (isEmpty() || !FindLeaf(root_, bounds, id, leaf, slot))
+    return false;
+
+  Node& node = nodes_[leaf];
+  int last = node.count - 1;
+  node.SetEntry(slot, node.GetEntry(last));
+  node.children[slot] = node.children[last];
+  --node.count;
+  --size_;
+
+  CondenseTree(leaf);
+  return true;
+}
+
+template<typename TBounds>
+void RStarTree<TBounds>::clear() {
+  nodes_.clear();
+  free_nodes_.clear();
+  root_ = -1;
+  size_ = 0;
+}
+
+template<typename TBounds>
+TBounds RStarTree<TBounds>::GetBounds() const {
+  ASSERT(!isEmpty());
+  const Node& root = nodes_[root_];
+  return root.GetUnion(root.count);
+}
+
+template<typename TBounds>
+int RStarTree<TBounds>::AllocateNode(int level, int parent) {
+  int index;
+  if (!free_nodes_.isEmpty()) {
+    index = free_nodes_.last();
+    free_nodes_.removeLast();
+  } else {
+    index = nodes_.addUninitialized();
+  }
+  Node& node = nodes_[index];
+  ::memset(&node, 0, sizeof(Node));
+  node.level = level;
+  node.parent = parent;
+  return index;
+}
+
+template<typename TBounds>
+void RStarTree<TBounds>::InsertEntry(const Entry& entry, int level) {
+  int node = root_;
+  while (nodes_[node].level > level)
+    node = nodes_[node].children[ChooseSubtree(node, entry.bounds)];
+  AddEntry(node, entry);
+}
+
+template<typename TBounds>
+int RStarTree<TBounds>::ChooseSubtree(int node_index, const TBounds& bounds) const {
+  const Node& node = nodes_[node_index];
+  ASSERT(node.count > 0);
+
+  double enlargements[MaxEntries];
+  double areas[MaxEntries];
+  int best = 0;
+  for (int k = 0; k < node.count; ++k) {
+    TBounds entry = node.GetEntry(k);
+    areas[k] = detail::getRTreeBoundsArea(entry);
+    enlargements[k] = detail::getRTreeBoundsArea(detail::uniteRTreeBounds(entry, bounds)) - areas[k];
+    if (enlargements[k] < enlargements[best] ||
+        (enlargements[k] == enlargements[best] && areas[k] < areas[best])) {
+      best = k;
+    }
+  }
+
+  // Above leaves minimize overlap between children, elsewhere the cheaper
+  // area enlargement works equally well. Entry already covering |bounds|
+  // does not increase overlap at all.
+  if (node.level != 1 || enlargements[best] == 0)
+    return best;
+
+  double best_overlap = Limits<double>::Infinity;
+  for (int k = 0; k < node.count; ++k) {
+    TBounds entry = node.GetEntry(k);
+    TBounds enlarged = detail::uniteRTreeBounds(entry, bounds);
+    // Only siblings touching enlarged entry contribute to the overlap.
+    uint32_t mask = node.GetIntersectingMask(enlarged, node.count) & ~(1u << k);
+    double overlap = 0;
+    for (; mask; mask &= mask - 1) {
+      TBounds other = node.GetEntry(findFirstOneBit(mask));
+      overlap += detail::getRTreeOverlapArea(enlarged, other);
+      overlap -= detail::getRTreeOverlapArea(entry, other);
+    }
+    if (overlap < best_overlap ||
+        (overlap == best_overlap &&
+         (enlargements[k] < enlargements[best] ||
+          (enlargements[k] == enlargements[best] && areas[k] < areas[best])))) {
+      best = k;
+      best_overlap = overlap;
+    }
+  }
+  return best;
+}
+
+template<typename TBounds>
+void RStarTree<TBounds>::AddEntry(int node_index, const Entry& entry) {
+  Node& node = nodes_[node_index];
+  if (node.count == MaxEntries) {
+    HandleOverflow(node_index, entry);
+    return;
+  }
+  if (node.level > 0)
+    nodes_[entry.child].parent = node_index;
+  node.SetEntry(node.count, entry.bounds);
+  node.children[node.count] = entry.child;
+  ++node.count;
+  UpdateBoundsUpward(node_index);
+}
+
+template<typename TBounds>
+void RStarTree<TBounds>::HandleOverflow(int node_index, const Entry& extra) {
+  Entry entries[MaxEntries + 1];
+  const Node& node = nodes_[node_index];
+  for (int k = 0; k < MaxEntries; ++k)
+    entries[k] = Entry { node.GetEntry(k), node.children[k] };
+  entries[MaxEntries] = extra;
+
+  uint32_t level_bit = 1u << node.level;
+  if (node_index != root_ && !(reinserted_levels_ & level_bit)) {
+    reinserted_levels_ |= level_bit;
+    Reinsert(node_index, entries);
+  } else {
+    Split(node_index, entries);
+  }
+}
+
+template<typename TBounds>
+void RStarTree<TBounds>::Reinsert(int node_index, Entry* entries) {
+  constexpr int Count = MaxEntries + 1;
+  TBounds all = entries[0].bounds;
+  for (int i = 1; i < Count; ++i)
+    all = detail::uniteRTreeBounds(all, entries[i].bounds);
+  double center_x = (static_cast<double>(all.min.x) + all.max.x) * 0.5;
+  double center_y = (static_cast<double>(all.min.y) + all.max.y) * 0.5;
+
+  struct SortEntry {
+    double distance;
+    int index;
+  };
+  SortEntry order[Count];
+  for (int i = 0; i < Count; ++i) {
+    const TBounds& b = entries[i].bounds;
+    double dx = (static_cast<double>(b.min.x) + b.max.x) * 0.5 - center_x;
+    double dy = (static_cast<double>(b.min.y) + b.max.y) * 0.5 - center_y;
+    order[i] = SortEntry { dx * dx + dy * dy, i };
+  }
+  insertionSortSpan(MutableSpan<SortEntry>(order, Count), [](const SortEntry& l, const SortEntry& r) {
+    return l.distance < r.distance ? -1 : (l.distance > r.distance ? 1 : 0);
+  });
+
+  Entry sorted[Count];
+  for (int i = 0; i < Count; ++i)
+    sorted[i] = entries[order[i].index];
+
+  // Keep entries closest to the center, reinsert the farthest ones
+  // starting from the closest of them.
+  int level = nodes_[node_index].level;
+  SetEntries(node_index, sorted, Count - ReinsertCount);
+  UpdateBoundsUpward(node_index);
+  for (int i = Count - ReinsertCount; i < Count; ++i)
+    InsertEntry(sorted[i], level);
+}
+
+template<typename TBounds>
+void RStarTree<TBounds>::Split(int node_index, Entry* entries) {
+  constexpr int Count = MaxEntries + 1;
+  constexpr int DistributionCount = Count - 2 * MinEntries + 1;
+
+  // Four candidate orders: by lower and upper bound on each axis.
+  int orders[4][Count];
+  for (int s = 0; s < 4; ++s) {
+    for (int i = 0; i < Count; ++i)
+      orders[s][i] = i;
+    auto key = [entries, s](int i) {
+      const TBounds& b = entries[i].bounds;
+      switch (s) {
+        case 0: return b.min.x;
+        case 1: return b.max.x;
+        case 2: return b.min.y;
+        default: return b.max.y;
+      }
+    };
+    insertionSortSpan(MutableSpan<int>(orders[s], Count), [&key](int l, int r) {
+      return key(l) < key(r) ? -1 : (key(l) > key(r) ? 1 : 0);
+    });
+  }
+
+  // For each order, first group takes MinEntries + d entries.
+  TBounds lower[4][DistributionCount];
+  TBounds upper[4][DistributionCount];
+  double margins[4] = { 0, 0, 0, 0 };
+  for (int s = 0; s < 4; ++s) {
+    TBounds prefix[Count];
+    TBounds suffix[Count];
+    prefix[0] = entries[orders[s][0]].bounds;
+    for (int i = 1; i < Count; ++i)
+      prefix[i] = detail::uniteRTreeBounds(prefix[i - 1], entries[orders[s][i]].bounds);
+    suffix[Count - 1] = entries[orders[s][Count - 1]].bounds;
+    for (int i = Count - 2; i >= 0; --i)
+      suffix[i] = detail::uniteRTreeBounds(suffix[i + 1], entries[orders[s][i]].bounds);
+
+    for (int d = 0; d < DistributionCount; ++d) {
+      int split = MinEntries + d;
+      lower[s][d] = prefix[split - 1];
+      upper[s][d] = suffix[split];
+      margins[s] += detail::getRTreeBoundsMargin(lower[s][d]);
+      margins[s] += detail::getRTreeBoundsMargin(upper[s][d]);
+    }
+  }
+
+  // Choose axis with smallest total margin, then distribution with
+  // smallest overlap, then with smallest area.
+  int axis = margins[0] + margins[1] <= margins[2] + margins[3] ? 0 : 1;
+  int best_order = axis * 2;
+  int best_split = MinEntries;
+  double best_overlap = Limits<double>::Infinity;
+  double best_area = Limits<double>::Infinity;
+  for (int s = axis * 2; s < axis * 2 + 2; ++s) {
+    for (int d = 0; d < DistributionCount; ++d) {
+      double overlap = detail::getRTreeOverlapArea(lower[s][d], upper[s][d]);
+      double area =
+          detail::getRTreeBoundsArea(lower[s][d]) +
+          detail::getRTreeBoundsArea(upper[s][d]);
+      if (overlap < best_overlap || (overlap == best_overlap && area < best_area)) {
+        best_overlap = overlap;
+        best_area = area;
+        best_order = s;
+        best_split = MinEntries + d;
+      }
+    }
+  }
+
+  Entry sorted[Count];
+  for (int i = 0; i < Count; ++i)
+    sorted[i] = entries[orders[best_order][i]];
+
+  int level = nodes_[node_index].level;
+  int sibling = AllocateNode(level, nodes_[node_index].parent);
+  SetEntries(node_index, sorted, best_split);
+  SetEntries(sibling, sorted + best_split, Count - best_split);
+
+  TBounds node_bounds = nodes_[node_index].GetUnion(best_split);
+  TBounds sibling_bounds = nodes_[sibling].GetUnion(Count - best_split);
+
+  if (node_index == root_) {
+    int new_root = AllocateNode(level + 1, -1);
+    Entry root_entries[2] = {
+      Entry { node_bounds, node_index },
+      Entry { sibling_bounds, sibling },
+    };
+    SetEntries(new_root, root_entries, 2);
+    root_ = new_root;
+    return;
+  }
+
+  int parent = nodes_[node_index].parent;
+  nodes_[parent].SetEntry(FindSlotInParent(node_index), node_bounds);
+  AddEntry(parent, Entry { sibling_bounds, sibling });
+}
+
+template<typename TBounds>
+void RStarTree<TBounds>::SetEntries(int node_index, const Entry* entries, int count) {
+  Node& node = nodes_[node_index];
+  for (int k = 0; k < count; ++k) {
+    node.SetEntry(k, entries[k].bounds);
+    node.children[k] = entries[k].child;
+    if (node.level > 0)
+      nodes_[entries[k].child].parent = node_index;
+  }
+  node.count = count;
+}
+
+template<typename TBounds>
+int RStarTree<TBounds>::FindSlotInParent(int node_index) const {
+  const Node& parent = nodes_[nodes_[node_index].parent];
+  for (int k = 0; k < parent.count; ++k) {
+    if (parent.children[k] == node_index)
+      return k;
+  }
+  ASSERT(false, "node is not linked with its parent");
+  return -1;
+}
+
+template<typename TBounds>
+void RStarTree<TBounds>::UpdateBoundsUpward(int node_index) {
+  while (node_index != root_) {
+    const Node& node = nodes_[node_index];
+    int parent = node.parent;
+    int slot = FindSlotInParent(node_index);
+    TBounds bounds = node.GetUnion(node.count);
+    if (nodes_[parent].GetEntry(slot) == bounds)
+      break;
+    nodes_[parent].SetEntry(slot, bounds);
+    node_index = parent;
+  }
+}
+
+template<typename TBounds>
+bool RStarTree<TBounds>::FindLeaf(
+    int node_index, const TBounds& bounds, int id, int& out_leaf, int& out_slot) const {
+  const Node& node = nodes_[node_index];
+  for (int k = 0; k < node.count; ++k) {
+    TBounds entry = node.GetEntry(k);
+    if (node.level == 0) {
+      if (node.children[k] == id && entry == bounds) {
+        out_leaf = node_index;
+        out_slot = k;
+        return true;
+      }
+    } else if (entry.contains(bounds)) {
+      if (FindLeaf(node.children[k], bounds, id, out_leaf, out_slot))
+        return true;
+    }
+  }
+  return false;
+}
+
+template<typename TBounds>
+void RStarTree<TBounds>::CondenseTree(int node_index) {
+  struct Orphan {
+    Entry entry;
+    int level;
+  };
+  List<Orphan> orphans;
+
+  // Dissolve underfull nodes on the path to the root.
+  while (node_index != root_) {
+    Node& node = nodes_[node_index];
+    int parent_index = node.parent;
+    int slot = FindSlotInParent(node_index);
+    Node& parent = nodes_[parent_index];
+    if (node.count < MinEntries) {
+      for (int k = 0; k < node.count; ++k)
+        orphans.add(Orphan { Entry { node.GetEntry(k), node.children[k] }, node.level });
+      int last = parent.count - 1;
+      parent.SetEntry(slot, parent.GetEntry(last));
+      parent.children[slot] = parent.children[last];
+      --parent.count;
+      FreeNode(node_index);
+    } else {
+      parent.SetEntry(slot, node.GetUnion(node.count));
+    }
+    node_index = parent_index;
+  }
+
+  // Shorten the tree if root has single child.
+  while (nodes_[root_].level > 0 && nodes_[root_].count == 1) {
+    int child = nodes_[root_].children[0];
+    FreeNode(root_);
+    root_ = child;
+    nodes_[root_].parent = -1;
+  }
+  // All children of the root were dissolved, their entries are orphans.
+  if (nodes_[root_].count == 0)
+    nodes_[root_].level = 0;
+
+  for (const Orphan& orphan : orphans) {
+    reinserted_levels_ = 0;
+    ReinsertOrphan(orphan.entry, orphan.level);
+  }
+}
+
+template<typename TBounds>
+void RStarTree<TBounds>::ReinsertOrphan(const Entry& entry, int level) {
+  if (level <= nodes_[root_].level) {
+    InsertEntry(entry, level);
+    return;
+  }
+  // The tree became lower than the subtree, so reinsert its entries.
+  ASSERT(level > 0);
+  Entry children[MaxEntries];
+  const Node& node = nodes_[entry.child];
+  int count = node.count;
+  for (int k = 0; k < count; ++k)
+    children[k] = Entry { node.GetEntry(k), node.children[k] };
+  FreeNode(entry.child);
+  for (int k = 0; k < count; ++k)
+    ReinsertOrphan(children[k], level - 1);
+}
+
+template<typename TBounds>
+template<typename TVisitor>
+void RStarTree<TBounds>::VisitIntersecting(const TBounds& query, TVisitor&& visitor) const {
+  if (isEmpty())
+    return;
+
+  int stack[TraversalStackSize];
+  int stack_size = 0;
+  stack[stack_size++] = root_;
+
+  while (stack_size > 0) {
+    const Node& node = nodes_[stack[--stack_size]];
+    uint32_t mask = node.GetIntersectingMask(query, node.count);
+    if (node.level == 0) {
+      for (; mask; mask &= mask - 1)
+        visitor(node.children[findFirstOneBit(mask)]);
+    } else {
+      ASSERT(stack_size + countBitsPopulation(mask) <= TraversalStackSize);
+      for (; mask; mask &= mask - 1)
+        stack[stack_size++] = node.children[findFirstOneBit(mask)];
+    }
+  }
+}
+
+template<typename TBounds>
+void RStarTree<TBounds>::FindNearest(
+    const PointType& point, int count, List<int>& out_ids) const {
+  if (isEmpty() || count <= 0)
+    return;
+
+  double x = point.x;
+  double y = point.y;
+  detail::RTreeNearestQueue queue;
+  queue.push(0, root_, nodes_[root_].level);
+
+  while (!queue.isEmpty()) {
+    auto candidate = queue.pop();
+    if (candidate.level < 0) {
+      out_ids.add(candidate.ref);
+      if (--count == 0)
+        break;
+      continue;
+    }
+    const Node& node = nodes_[candidate.ref];
+    for (int k = 0; k < node.count; ++k) {
+      double distance = node.GetDistanceSquared(k, x, y);
+      queue.push(distance, node.children[k], node.level - 1);
+    }
+  }
+}
+
+template<typename TBounds>
+bool RStarTree<TBounds>::IsValidForTesting() const {
+  if (root_ < 0)
+    return size_ == 0;
+  if (nodes_[root_].parent != -1)
+    return false;
+  int item_count = 0;
+  return IsNodeValid(root_, item_count) && item_count == size_;
+}
+
+template<typename TBounds>
+bool RStarTree<TBounds>::IsNodeValid(int node_index, int& item_count) const {
+  const Node& node = nodes_[node_index];
+  if (node.count > MaxEntries)
+    return false;
+  if (node_index == root_) {
+    if (node.level > 0 && node.count < 2)
+      return false;
+  } else if (node.count < MinEntries) {
+    return false;
+  }
+
+  if (node.level == 0) {
+    item_count += node.count;
+    return true;
+  }
+  for (int k = 0; k < node.count; ++k) {
+    int child_index = node.children[k];
+    const Node& child = nodes_[child_index];
+    if (child.parent != node_index || child.level != node.level - 1)
+      return false;
+    if (child.count == 0 || child.GetUnion(child.count) != node.GetEntry(k))
+      return false;
+    if (!IsNodeValid(child_index, item_count))
+      return false;
+  }
+  return true;
+}
+
+} // namespace stp
+
+#endif // STP_BASE_GEOMETRY_RSTARTREE_H_
@@ -0,0 +1,207 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Geometry/RStarTree.h"
+
+#include "Base/Containers/List.h"
+#include "Base/Containers/Sorting.h"
+#include "Base/Test/GTest.h"
+#include "Base/Util/Random.h"
+#include "Base/Util/RandomUtil.h"
+
+namespace stp {
+namespace {
+
+class RStarTreeTest : public testing::Test {
+ protected:
+  float nextFloat() { return RandomUtil::NextUnitFloat(random_); }
+  int nextInt(int range) { return static_cast<int>(random_.NextUInt32() % range); }
+
+  Bounds2 nextBounds(float range, float max_size) {
+    float x = nextFloat() * range;
+    float y = nextFloat() * range;
+    return Bounds2(x, y, x + nextFloat() * max_size, y + nextFloat() * max_size);
+  }
+
+  IntBounds2 nextIntBounds(int range, int max_size) {
+    int x = nextInt(range);
+    int y = nextInt(range);
+    return IntBounds2(x, y, x + nextInt(max_size), y + nextInt(max_size));
+  }
+
+  Random random_;
+};
+
+// Items stored in the tree, id is index in the list, removed items are
+// marked by |alive|.
+template<typename TBounds>
+struct Item {
+  TBounds bounds;
+  bool alive;
+};
+
+template<typename TBounds>
+void expectSameIntersecting(
+    const RStarTree<TBounds>& tree, const List<Item<TBounds>>& items, const TBounds& query) {
+  List<int> expected;
+  for (int i = 0; i < items.size(); ++i) {
+    if (items[i].alive && TBounds::Intersects(items[i].bounds, query))
+      expected.add(i);
+  }
+  List<int> actual;
+  tree.FindIntersecting(query, actual);
+  sortSpan(actual.toSpan(), [](int l, int r) { return compare(l, r); });
+  EXPECT_EQ(expected, actual);
+}
+
+template<typename TBounds>
+double getDistanceSquared(const TBounds& bounds, double x, double y) {
+  double dx = max(0.0, max(bounds.min.x - x, x - bounds.max.x));
+  double dy = max(0.0, max(bounds.min.y - y, y - bounds.max.y));
+  return dx * dx + dy * dy;
+}
+
+template<typename TBounds>
+void expectSameNearest(
+    const RStarTree<TBounds>& tree, const List<Item<TBounds>>& items,
+    typename RStarTree<TBounds>::PointType point, int count) {
+  List<double> distances;
+  for (const auto& item : items) {
+    if (item.alive)
+      distances.add(getDistanceSquared(item.bounds, point.x, point.y));
+  }
+  sortSpan(distances.toSpan(), [](double l, double r) {
+    return l < r ? -1 : (l > r ? 1 : 0);
+  });
+
+  List<int> actual;
+  tree.FindNearest(point, count, actual);
+  ASSERT_EQ(min(count, distances.size()), actual.size());
+  for (int i = 0; i < actual.size(); ++i) {
+    ASSERT_TRUE(items[actual[i]].alive);
+    EXPECT_EQ(distances[i], getDistanceSquared(items[actual[i]].bounds, point.x, point.y));
+  }
+}
+
+TEST_F(RStarTreeTest, Empty) {
+  RStarTree2 tree;
+  EXPECT_TRUE(tree.isEmpty());
+  EXPECT_TRUE(tree.IsValidForTesting());
+  EXPECT_FALSE(tree.Remove(Bounds2(0, 0, 1, 1), 0));
+
+  List<int> result;
+  tree.FindIntersecting(Bounds2(-100, -100, 100, 100), result);
+  tree.FindNearest(Point2(0, 0), 10, result);
+  EXPECT_TRUE(result.isEmpty());
+}
+
+TEST_F(RStarTreeTest, InsertAndRemoveSingle) {
+  RStarTree2 tree;
+  tree.Insert(Bounds2(1, 2, 3, 4), 7);
+  EXPECT_EQ(1, tree.size());
+  EXPECT_EQ(Bounds2(1, 2, 3, 4), tree.GetBounds());
+
+  List<int> result;
+  tree.FindContaining(Point2(2, 3), result);
+  ASSERT_EQ(1, result.size());
+  EXPECT_EQ(7, result[0]);
+
+  EXPECT_FALSE(tree.Remove(Bounds2(1, 2, 3, 4), 8));
+  EXPECT_FALSE(tree.Remove(Bounds2(1, 2, 3, 5), 7));
+  EXPECT_TRUE(tree.Remove(Bounds2(1, 2, 3, 4), 7));
+  EXPECT_TRUE(tree.isEmpty());
+  EXPECT_TRUE(tree.IsValidForTesting());
+
+  tree.Insert(Bounds2(5, 5, 6, 6), 1);
+  EXPECT_EQ(Bounds2(5, 5, 6, 6), tree.GetBounds());
+}
+
+TEST_F(RStarTreeTest, InsertMatchesBruteForce) {
+  List<Item<Bounds2>> items;
+  RStarTree2 tree;
+  for (int i = 0; i < 5000; ++i) {
+    items.add(Item<Bounds2> { nextBounds(1000, 20), true });
+    tree.Insert(items.last().bounds, i);
+    if (i % 500 == 0)
+      ASSERT_TRUE(tree.IsValidForTesting());
+  }
+  ASSERT_TRUE(tree.IsValidForTesting());
+  EXPECT_EQ(5000, tree.size());
+
+  for (int i = 0; i < 50; ++i)
+    expectSameIntersecting(tree, items, nextBounds(1000, 200));
+  for (int i = 0; i < 20; ++i) {
+    Point2 point(nextFloat() * 1000, nextFloat() * 1000);
+    expectSameIntersecting(tree, items, Bounds2(point, point));
+    expectSameNearest(tree, items, point, 1 + nextInt(40));
+  }
+}
+
+TEST_F(RStarTreeTest, RandomInsertAndRemove) {
+  List<Item<IntBounds2>> items;
+  IntRStarTree2 tree;
+  int alive_count = 0;
+  for (int step = 0; step < 20000; ++step) {
+    // Grow first, then shrink.
+    bool insert = alive_count == 0 || nextInt(100) < (step < 10000 ? 70 : 30);
+    if (insert) {
+      items.add(Item<IntBounds2> { nextIntBounds(5000, 50), true });
+      tree.Insert(items.last().bounds, items.size() - 1);
+      ++alive_count;
+    } else {
+      int id = nextInt(items.size());
+      while (!items[id].alive)
+        id = (id + 1) % items.size();
+      ASSERT_TRUE(tree.Remove(items[id].bounds, id));
+      items[id].alive = false;
+      --alive_count;
+    }
+    if (step % 1000 == 0) {
+      ASSERT_TRUE(tree.IsValidForTesting());
+      expectSameIntersecting(tree, items, nextIntBounds(5000, 1000));
+    }
+  }
+  ASSERT_TRUE(tree.IsValidForTesting());
+  EXPECT_EQ(alive_count, tree.size());
+
+  for (int i = 0; i < 20; ++i) {
+    IntPoint2 point(nextInt(5000), nextInt(5000));
+    expectSameNearest(tree, items, point, 1 + nextInt(40));
+  }
+
+  // Drain the tree.
+  for (int i = 0; i < items.size(); ++i) {
+    if (items[i].alive) {
+      ASSERT_TRUE(tree.Remove(items[i].bounds, i));
+      items[i].alive = false;
+    }
+  }
+  EXPECT_TRUE(tree.isEmpty());
+  EXPECT_TRUE(tree.IsValidForTesting());
+}
+
+TEST_F(RStarTreeTest, DuplicateItems) {
+  RStarTree2 tree;
+  for (int i = 0; i < 200; ++i)
+    tree.Insert(Bounds2(5, 5, 5, 5), i % 2);
+  ASSERT_TRUE(tree.IsValidForTesting());
+
+  List<int> result;
+  tree.FindContaining(Point2(5, 5), result);
+  EXPECT_EQ(200, result.size());
+
+  for (int i = 0; i < 100; ++i)
+    ASSERT_TRUE(tree.Remove(Bounds2(5, 5, 5, 5), 1));
+  EXPECT_FALSE(tree.Remove(Bounds2(5, 5, 5, 5), 1));
+  ASSERT_TRUE(tree.IsValidForTesting());
+  EXPECT_EQ(100, tree.size());
+
+  result.clear();
+  tree.FindNearest(Point2(0, 0), 1000, result);
+  EXPECT_EQ(100, result.size());
+  for (int id : result)
+    EXPECT_EQ(0, id);
+}
+
+} // namespace
+} // namespace stp
@@ -0,0 +1,100 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Geometry/RTreeImpl.h"
+
+namespace stp {
+namespace detail {
+
+void RTreeNearestQueue::push(double distance, int32_t ref, int32_t level) {
+  int at = heap_.size();
+  heap_.add(Candidate { distance, ref, level });
+  Candidate* h = heap_.data();
+  while (at > 0) {
+    int parent = (at - 1) / 2;
+    if (h[parent].distance <= distance)
+      break;
+    h[at] = h[parent];
+    at = parent;
+  }
+  h[at] = Candidate { distance, ref, level };
+}
+
+RTreeNearestQueue::Candidate RTreeNearestQueue::pop() {
+  ASSERT(!heap_.isEmpty());
+  Candidate* h = heap_.data();
+  Candidate top = h[0];
+  Candidate last = h[heap_.size() - 1];
+  heap_.removeLast();
+
+  int size = heap_.size();
+  int at = 0;
+  while (true) {
+    int child = at * 2 + 1;
+    if (child >= size)
+      break;
+    if (child + 1 < size && h[child + 1].distance < h[child].distance)
+      ++child;
+    if (last.distance <= h[child].distance)
+      break;
+    h[at] = h[child];
+    at = child;
+  }
+  if (size > 0)
+    h[at] = last;
+  return top;
+}
+
+// Based on public domain "Fast Hilbert curve generation" by rawrunprotected,
+// computes index without iterating over curve levels.
+uint32_t computeHilbertIndex(uint32_t x, uint32_t y) {
+  ASSERT(x <= 0xFFFF && y <= 0xFFFF);
+
+  uint32_t a = x ^ y;
+  uint32_t b = 0xFFFF ^ a;
+  uint32_t c = 0xFFFF ^ (x | y);
+  uint32_t d = x & (y ^ 0xFFFF);
+
+  uint32_t A = a | (b >> 1);
+  uint32_t B = (a >> 1) ^ a;
+  uint32_t C = ((c >> 1) ^ (b & (d >> 1))) ^ c;
+  uint32_t D = ((a & (c >> 1)) ^ (d >> 1)) ^ d;
+
+  a = A; b = B; c = C; d = D;
+  A = (a & (a >> 2)) ^ (b & (b >> 2));
+  B = (a & (b >> 2)) ^ (b & ((a ^ b) >> 2));
+  C ^= (a & (c >> 2)) ^ (b & (d >> 2));
+  D ^= (b & (c >> 2)) ^ ((a ^ b) & (d >> 2));
+
+  a = A; b = B; c = C; d = D;
+  A = (a & (a >> 4)) ^ (b & (b >> 4));
+  B = (a & (b >> 4)) ^ (b & ((a ^ b) >> 4));
+  C ^= (a & (c >> 4)) ^ (b & (d >> 4));
+  D ^= (b & (c >> 4)) ^ ((a ^ b) & (d >> 4));
+
+  a = A; b = B; c = C; d = D;
+  C ^= (a & (c >> 8)) ^ (b & (d >> 8));
+  D ^= (b & (c >> 8)) ^ ((a ^ b) & (d >> 8));
+
+  a = C ^ (C >> 1);
+  b = D ^ (D >> 1);
+
+  uint32_t i0 = x ^ y;
+  uint32_t i1 = b | (0xFFFF ^ (i0 | a));
+
+  // Interleave bits.
+  i0 = (i0 | (i0 << 8)) & 0x00FF00FF;
+  i0 = (i0 | (i0 << 4)) & 0x0F0F0F0F;
+  i0 = (i0 | (i0 << 2)) & 0x33333333;
+  i0 = (i0 | (i0 << 1)) & 0x55555555;
+
+  i1 = (i1 | (i1 << 8)) & 0x00FF00FF;
+  i1 = (i1 | (i1 << 4)) & 0x0F0F0F0F;
+  i1 = (i1 | (i1 << 2)) & 0x33333333;
+  i1 = (i1 | (i1 << 1)) & 0x55555555;
+
+  return (i1 << 1) | i0;
+}
+
+} // namespace detail
+} // namespace stp
@@ -0,0 +1,222 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#ifndef STP_BASE_GEOMETRY_RTREEIMPL_H_
+#define STP_BASE_GEOMETRY_RTREEIMPL_H_
+
+#include "Base/Containers/List.h"
+#include "Base/Error/BasicExceptions.h"
+#include "Base/Math/Bits.h"
+#include "Base/Memory/AlignedMalloc.h"
+#include "Geometry/Bounds2.h"
+
+#include <string.h>
+
+namespace stp {
+namespace detail {
+
+template<typename TBounds>
+struct RTreeTraits;
+
+template<>
+struct RTreeTraits<Bounds2> {
+  typedef float Coordinate;
+  typedef Point2 PointType;
+};
+
+template<>
+struct RTreeTraits<IntBounds2> {
+  typedef int Coordinate;
+  typedef IntPoint2 PointType;
+};
+
+constexpr int RTreeNodeCapacity = 16;
+
+// Bounds of node entries as structure of arrays. Each array of 16 32-bit
+// coordinates fills exactly one cache line, so scanning a node touches
+// four lines and the loops vectorize well.
+template<typename TBounds>
+struct RTreeNodeBounds {
+  typedef typename RTreeTraits<TBounds>::Coordinate Coordinate;
+  static constexpr int Capacity = RTreeNodeCapacity;
+
+  TBounds GetEntry(int k) const {
+    return TBounds(min_x[k], min_y[k], max_x[k], max_y[k]);
+  }
+
+  void SetEntry(int k, const TBounds& bounds) {
+    min_x[k] = bounds.min.x;
+    min_y[k] = bounds.min.y;
+    max_x[k] = bounds.max.x;
+    max_y[k] = bounds.max.y;
+  }
+
+  // Returns union of first |count| entries.
+  TBounds GetUnion(int count) const {
+    ASSERT(count > 0);
+    TBounds result = GetEntry(0);
+    for (int k = 1; k < count; ++k) {
+      result.min.x = min(result.min.x, min_x[k]);
+      result.min.y = min(result.min.y, min_y[k]);
+      result.max.x = max(result.max.x, max_x[k]);
+      result.max.y = max(result.max.y, max_y[k]);
+    }
+    return result;
+  }
+
+  // Returns bit mask of first |count| entries intersecting |query|
+  // (with the same semantics as Bounds2::Intersects()).
+  uint32_t GetIntersectingMask(const TBounds& query, int count) const {
+    // Fixed trip count lets compiler vectorize the loop.
+    uint32_t mask = 0;
+    for (int k = 0; k < Capacity; ++k) {
+      bool hit =
+          (min_x[k] <= query.max.x) & (query.min.x <= max_x[k]) &
+          (min_y[k] <= query.max.y) & (query.min.y <= max_y[k]);
+      mask |= static_cast<uint32_t>(hit) << k;
+    }
+    return mask & ((1u << count) - 1);
+  }
+
+  // Returns squared distance from (x, y) to entry |k|, zero if inside.
+  double GetDistanceSquared(int k, double x, double y) const {
+    double dx = max(0.0, max(min_x[k] - x, x - max_x[k]));
+    double dy = max(0.0, max(min_y[k] - y, y - max_y[k]));
+    return dx * dx + dy * dy;
+  }
+
+  Coordinate min_x[Capacity];
+  Coordinate min_y[Capacity];
+  Coordinate max_x[Capacity];
+  Coordinate max_y[Capacity];
+};
+
+// Unlike Bounds2::Unite() these do not treat degenerate bounds as empty,
+// bounds of points are valid items too.
+template<typename TBounds>
+inline TBounds uniteRTreeBounds(const TBounds& a, const TBounds& b) {
+  return TBounds(
+      min(a.min.x, b.min.x), min(a.min.y, b.min.y),
+      max(a.max.x, b.max.x), max(a.max.y, b.max.y));
+}
+
+template<typename TBounds>
+inline double getRTreeBoundsArea(const TBounds& b) {
+  return (static_cast<double>(b.max.x) - b.min.x) * (static_cast<double>(b.max.y) - b.min.y);
+}
+
+template<typename TBounds>
+inline double getRTreeBoundsMargin(const TBounds& b) {
+  return (static_cast<double>(b.max.x) - b.min.x) + (static_cast<double>(b.max.y) - b.min.y);
+}
+
+template<typename TBounds>
+inline double getRTreeOverlapArea(const TBounds& a, const TBounds& b) {
+  double w = static_cast<double>(min(a.max.x, b.max.x)) - max(a.min.x, b.min.x);
+  double h = static_cast<double>(min(a.max.y, b.max.y)) - max(a.min.y, b.min.y);
+  return w > 0 && h > 0 ? w * h : 0;
+}
+
+// Growable array of trivially copyable nodes aligned to cache lines.
+template<typename TNode>
+class RTreeNodeArray {
+  DISALLOW_COPY_AND_ASSIGN(RTreeNodeArray);
+ public:
+  static constexpr int Alignment = 64;
+  static_assert(sizeof(TNode) % Alignment == 0, "node must fill whole cache lines");
+
+  RTreeNodeArray() {}
+  ~RTreeNodeArray() { if (data_) freeAlignedMemory(data_); }
+
+  RTreeNodeArray(RTreeNodeArray&& other) noexcept
+      : data_(exchange(other.data_, nullptr)),
+        size_(exchange(other.size_, 0)),
+        capacity_(exchange(other.capacity_, 0)) {}
+
+  RTreeNodeArray& operator=(RTreeNodeArray&& other) noexcept {
+    if (this != &other) {
+      if (data_)
+        freeAlignedMemory(data_);
+      data_ = exchange(other.data_, nullptr);
+      size_ = exchange(other.size_, 0);
+      capacity_ = exchange(other.capacity_, 0);
+    }
+    return *this;
+  }
+
+  ALWAYS_INLINE int size() const { return size_; }
+  ALWAYS_INLINE bool isEmpty() const { return size_ == 0; }
+
+  ALWAYS_INLINE TNode& operator[](int at) {
+    ASSERT(0 <= at && at < size_);
+    return data_[at];
+  }
+  ALWAYS_INLINE const TNode& operator[](int at) const {
+    ASSERT(0 <= at && at < size_);
+    return data_[at];
+  }
+
+  void clear() { size_ = 0; }
+
+  void ensureCapacity(int request) {
+    if (request > capacity_)
+      resizeStorage(request);
+  }
+
+  // Returns index of the new node. Its content is left for caller.
+  int addUninitialized() {
+    if (UNLIKELY(size_ == capacity_)) {
+      if (capacity_ >= Limits<int>::Max / 2)
+        throw LengthException();
+      resizeStorage(max(capacity_ * 2, 8));
+    }
+    return size_++;
+  }
+
+ private:
+  void resizeStorage(int new_capacity) {
+    if (new_capacity > Limits<int>::Max / isizeof(TNode))
+      throw LengthException();
+    int size_in_bytes = new_capacity * isizeof(TNode);
+    auto* new_data = static_cast<TNode*>(tryAllocateAlignedMemory(size_in_bytes, Alignment));
+    if (!new_data)
+      throw OutOfMemoryException() << static_cast<size_t>(size_in_bytes);
+    if (data_) {
+      ::memcpy(new_data, data_, toUnsigned(size_) * sizeof(TNode));
+      freeAlignedMemory(data_);
+    }
+    data_ = new_data;
+    capacity_ = new_capacity;
+  }
+
+  TNode* data_ = nullptr;
+  int size_ = 0;
+  int capacity_ = 0;
+};
+
+// Min-heap of candidates for k-nearest queries.
+class BASE_EXPORT RTreeNearestQueue {
+ public:
+  struct Candidate {
+    double distance;
+    // Index of node, or index of item if |level| is negative.
+    int32_t ref;
+    int32_t level;
+  };
+
+  bool isEmpty() const { return heap_.isEmpty(); }
+
+  void push(double distance, int32_t ref, int32_t level);
+  Candidate pop();
+
+ private:
+  List<Candidate> heap_;
+};
+
+// Maps point on 2^16 x 2^16 grid to its index along Hilbert curve.
+BASE_EXPORT uint32_t computeHilbertIndex(uint32_t x, uint32_t y);
+
+} // namespace detail
+} // namespace stp
+
+#endif // STP_BASE_GEOMETRY_RTREEIMPL_H_
@@ -0,0 +1,144 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Geometry/PackedRTree.h"
+#include "Geometry/RStarTree.h"
+
+#include "Base/Containers/List.h"
+#include "Base/Math/Math.h"
+#include "Base/Test/GTest.h"
+#include "Base/Test/PerfTest.h"
+#include "Base/Time/TimeTicks.h"
+#include "Base/Util/Random.h"
+#include "Base/Util/RandomUtil.h"
+
+namespace stp {
+
+namespace {
+
+constexpr int QueryCount = 10000;
+constexpr int NearestCount = 10;
+
+class RTreePerfTest : public testing::Test {
+ protected:
+  float nextFloat() { return RandomUtil::NextUnitFloat(random_); }
+
+  // Small boxes scattered over a square with about 4 boxes per unit of area
+  // regardless of count, like features on a map.
+  List<Bounds2> makeBoxes(int count) {
+    float extent = mathSqrt(static_cast<float>(count));
+    List<Bounds2> boxes;
+    boxes.ensureCapacity(count);
+    for (int i = 0; i < count; ++i) {
+      float x = nextFloat() * extent;
+      float y = nextFloat() * extent;
+      boxes.add(Bounds2(x, y, x + nextFloat() * 0.5f, y + nextFloat() * 0.5f));
+    }
+    return boxes;
+  }
+
+  // Windows returning a few dozen boxes each.
+  List<Bounds2> makeQueries(int box_count) {
+    float extent = mathSqrt(static_cast<float>(box_count));
+    List<Bounds2> queries;
+    queries.ensureCapacity(QueryCount);
+    for (int i = 0; i < QueryCount; ++i) {
+      float x = nextFloat() * extent;
+      float y = nextFloat() * extent;
+      queries.add(Bounds2(x, y, x + 3, y + 3));
+    }
+    return queries;
+  }
+
+  void runBenchmark(const char* trace, int count) {
+    List<Bounds2> boxes = makeBoxes(count);
+    List<Bounds2> queries = makeQueries(count);
+
+    PackedRTree2 packed;
+    TimeTicks start = TimeTicks::Now();
+    packed.Build(boxes);
+    TimeDelta time = TimeTicks::Now() - start;
+    perf_test::PrintResult("packed_build", "", trace, time.InMillisecondsF(), "ms", true);
+
+    RStarTree2 rstar;
+    start = TimeTicks::Now();
+    for (int i = 0; i < count; ++i)
+      rstar.Insert(boxes[i], i);
+    time = TimeTicks::Now() - start;
+    perf_test::PrintResult("rstar_insert", "", trace, time.InMillisecondsF(), "ms", true);
+
+    int64_t packed_hits = 0;
+    start = TimeTicks::Now();
+    for (const Bounds2& query : queries)
+      packed.VisitIntersecting(query, [&packed_hits](int) { ++packed_hits; });
+    perf_test::PrintThroughput(
+        "packed_intersecting", "", trace, QueryCount, TimeTicks::Now() - start, "Mqueries/s", true);
+
+    int64_t rstar_hits = 0;
+    start = TimeTicks::Now();
+    for (const Bounds2& query : queries)
+      rstar.VisitIntersecting(query, [&rstar_hits](int) { ++rstar_hits; });
+    perf_test::PrintThroughput(
+        "rstar_intersecting", "", trace, QueryCount, TimeTicks::Now() - start, "Mqueries/s", true);
+
+    // Linear scan is too slow to run all queries on large inputs.
+    int brute_count = max(10, min(QueryCount, 1000000000 / count / 10));
+    int64_t brute_hits = 0;
+    int64_t packed_subset_hits = 0;
+    start = TimeTicks::Now();
+    for (int i = 0; i < brute_count; ++i) {
+      for (const Bounds2& box : boxes) {
+        if (Bounds2::Intersects(box, queries[i]))
+          ++brute_hits;
+      }
+    }
+    perf_test::PrintThroughput(
+        "brute_intersecting", "", trace, brute_count, TimeTicks::Now() - start, "Mqueries/s", true);
+    for (int i = 0; i < brute_count; ++i)
+      packed.VisitIntersecting(queries[i], [&packed_subset_hits](int) { ++packed_subset_hits; });
+
+    List<int> nearest;
+    nearest.ensureCapacity(NearestCount);
+    start = TimeTicks::Now();
+    for (const Bounds2& query : queries) {
+      nearest.clear();
+      packed.FindNearest(query.min, NearestCount, nearest);
+    }
+    perf_test::PrintThroughput(
+        "packed_nearest", "", trace, QueryCount, TimeTicks::Now() - start, "Mqueries/s", true);
+
+    start = TimeTicks::Now();
+    for (const Bounds2& query : queries) {
+      nearest.clear();
+      rstar.FindNearest(query.min, NearestCount, nearest);
+    }
+    perf_test::PrintThroughput(
+        "rstar_nearest", "", trace, QueryCount, TimeTicks::Now() - start, "Mqueries/s", true);
+
+    EXPECT_EQ(packed_hits, rstar_hits);
+    EXPECT_EQ(brute_hits, packed_subset_hits);
+  }
+
+  Random random_;
+};
+
+} // namespace
+
+TEST_F(RTreePerfTest, Boxes10K) {
+  runBenchmark("10K", 10000);
+}
+
+TEST_F(RTreePerfTest, Boxes100K) {
+  runBenchmark("100K", 100000);
+}
+
+TEST_F(RTreePerfTest, Boxes1M) {
+  runBenchmark("1M", 1000000);
+}
+
+// Takes a minute and over 1 GB of memory, run explicitly.
+TEST_F(RTreePerfTest, DISABLED_Boxes10M) {
+  runBenchmark("10M", 10000000);
+}
+
+} // namespace stp
@@ -0,0 +1,79 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Geometry/Ray3.h"
+
+#include "Base/Containers/List.h"
+#include "Base/Test/GTest.h"
+#include "Base/Test/PerfTest.h"
+#include "Base/Time/TimeTicks.h"
+#include "Base/Util/Random.h"
+#include "Base/Util/RandomUtil.h"
+#include "Geometry/Triangle3.h"
+
+namespace stp {
+
+namespace {
+
+constexpr int RayCount = 1024;
+constexpr int TriangleCount = 1024;
+
+class Ray3PerfTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    // Rays shot from around origin through a cloud of triangles in front of
+    // it, so both hits and misses are measured.
+    for (int i = 0; i < RayCount; ++i) {
+      Vector3 direction(nextFloat() - 0.5f, nextFloat() - 0.5f, 1);
+      ASSERT_TRUE(direction.TryNormalize());
+      rays_.add(Ray3(Point3(nextFloat(), nextFloat(), 0), direction));
+    }
+    for (int i = 0; i < TriangleCount; ++i) {
+      Point3 p((nextFloat() - 0.5f) * 10, (nextFloat() - 0.5f) * 10, nextFloat() * 10 + 1);
+      triangles_.add(Triangle3(
+          p,
+          p + Vector3(nextFloat() * 10, nextFloat(), nextFloat()),
+          p + Vector3(nextFloat(), nextFloat() * 10, nextFloat())));
+    }
+  }
+
+  float nextFloat() { return RandomUtil::NextUnitFloat(random_); }
+
+  List<Ray3> rays_;
+  List<Triangle3> triangles_;
+  Random random_;
+};
+
+} // namespace
+
+TEST_F(Ray3PerfTest, IntersectsTriangle) {
+  for (bool culling : { false, true }) {
+    int hit_count = 0;
+    float distance;
+    Vector3 normal;
+    TimeTicks start = TimeTicks::Now();
+    for (const Ray3& ray : rays_) {
+      for (const Triangle3& triangle : triangles_)
+        hit_count += ray.IntersectsTriangle(triangle, culling, &distance, &normal);
+    }
+    perf_test::PrintThroughput(
+        "intersects_triangle", "", culling ? "culling" : "two_sided",
+        static_cast<double>(RayCount) * TriangleCount, TimeTicks::Now() - start, "Mops/s", true);
+    EXPECT_NE(0, hit_count);
+  }
+}
+
+TEST_F(Ray3PerfTest, GetClosestPoint) {
+  float sum = 0;
+  TimeTicks start = TimeTicks::Now();
+  for (const Ray3& ray : rays_) {
+    for (const Ray3& other : rays_)
+      sum += ray.GetClosestPoint(other).z;
+  }
+  perf_test::PrintThroughput(
+      "closest_point", "", "ray", static_cast<double>(RayCount) * RayCount,
+      TimeTicks::Now() - start, "Mops/s", true);
+  EXPECT_NE(0, sum);
+}
+
+} // namespace stp
@@ -0,0 +1,107 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Geometry/Xform2.h"
+
+#include "Base/Containers/List.h"
+#include "Base/Test/GTest.h"
+#include "Base/Test/PerfTest.h"
+#include "Base/Time/TimeTicks.h"
+#include "Base/Util/Random.h"
+#include "Base/Util/RandomUtil.h"
+#include "Geometry/Quad2.h"
+
+namespace stp {
+
+namespace {
+
+constexpr int XformCount = 1024;
+constexpr int PointCount = 64 * 1024;
+constexpr int Iterations = 200;
+
+class Xform2PerfTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    for (int i = 0; i < XformCount; ++i) {
+      // Keep half of transforms affine.
+      float persp_0 = (i & 1) ? 0 : nextFloat() * 0.001f;
+      float persp_1 = (i & 1) ? 0 : nextFloat() * 0.001f;
+      xforms_.add(Xform2(
+          nextFloat() + 0.5f, nextFloat() - 0.5f, nextFloat() * 100,
+          nextFloat() - 0.5f, nextFloat() + 0.5f, nextFloat() * 100,
+          persp_0, persp_1, 1));
+    }
+    for (int i = 0; i < PointCount; ++i)
+      points_.add(Point2(nextFloat() * 1000, nextFloat() * 1000));
+  }
+
+  float nextFloat() { return RandomUtil::NextUnitFloat(random_); }
+
+  List<Xform2> xforms_;
+  List<Point2> points_;
+  Random random_;
+};
+
+} // namespace
+
+TEST_F(Xform2PerfTest, Concat) {
+  Xform2 result = Xform2::Identity();
+  TimeTicks start = TimeTicks::Now();
+  for (int n = 0; n < Iterations; ++n) {
+    for (int i = 0; i + 1 < XformCount; ++i)
+      result.SetConcat(xforms_[i], xforms_[i + 1]);
+  }
+  perf_test::PrintThroughput(
+      "concat", "", "mixed", static_cast<double>(Iterations) * (XformCount - 1),
+      TimeTicks::Now() - start, "Mops/s", true);
+  EXPECT_FALSE(result.IsIdentity());
+}
+
+TEST_F(Xform2PerfTest, Invert) {
+  Xform2 result = Xform2::Identity();
+  int invertible = 0;
+  TimeTicks start = TimeTicks::Now();
+  for (int n = 0; n < Iterations; ++n) {
+    for (int i = 0; i < XformCount; ++i)
+      invertible += xforms_[i].GetInverted(result);
+  }
+  perf_test::PrintThroughput(
+      "invert", "", "mixed", static_cast<double>(Iterations) * XformCount, TimeTicks::Now() - start,
+      "Mops/s", true);
+  EXPECT_NE(0, invertible);
+}
+
+TEST_F(Xform2PerfTest, MapPoints) {
+  List<Point2> output;
+  Point2* output_data = output.appendUninitialized(PointCount);
+
+  // Odd transforms are affine, even ones have perspective.
+  for (int i = 0; i < 2; ++i) {
+    const Xform2& xform = xforms_[i];
+    TimeTicks start = TimeTicks::Now();
+    for (int n = 0; n < Iterations / 10; ++n)
+      xform.MapPoints(output_data, points_.data(), PointCount);
+    perf_test::PrintThroughput(
+        "map_points", "", i ? "affine" : "perspective",
+        static_cast<double>(Iterations / 10) * PointCount, TimeTicks::Now() - start,
+        "Mops/s", true);
+  }
+}
+
+TEST_F(Xform2PerfTest, MapQuad) {
+  float sum = 0;
+  TimeTicks start = TimeTicks::Now();
+  for (int n = 0; n < Iterations / 10; ++n) {
+    const Xform2& xform = xforms_[n];
+    for (int i = 0; i + 3 < PointCount; i += 4) {
+      Quad2 quad(points_[i], points_[i + 1], points_[i + 2], points_[i + 3]);
+      sum += xform.MapQuad(quad).p[0].x;
+    }
+  }
+  perf_test::PrintThroughput(
+      "map_quad", "", "mixed", static_cast<double>(Iterations / 10) * (PointCount / 4),
+      TimeTicks::Now() - start, "Mops/s", true);
+  EXPECT_NE(0, sum);
+}
+
+} // namespace stp
@@ -6,10 +6,13 @@
 #include "Geometry/Xform3.h"
 
 #include "Base/Containers/ArrayOps.h"
+#include "Base/Containers/InlineList.h"
+#include "Base/Simd/Vnx.h"
 #include "Geometry/Affine.h"
 #include "Geometry/Bounds2.h"
 #include "Geometry/Quad2.h"
 #include "Geometry/Quaternion.h"
+#include "Geometry/Xform3Kernels.h"
 #include "Geometry/Xform2.h"
 
 namespace stp {
@@ -766,7 +769,7 @@ void Xform3::SetConcat(const Xform3& a, const Xform3& b) {
   float storage[EntryCount];
   float* result = use_storage ? storage : &d_[0][0];
 
-  if (((a_mask | b_mask) & (TypeMaskTranslate | TypeMaskScale)) == 0) {
+  if (((a_mask | b_mask) & ~(TypeMaskTranslate | TypeMaskScale)) == 0) {
     // Both matrices are at most scale+translate
     result[0] = a.d_[0][0] * b.d_[0][0];
     result[1] = result[2] = result[3] = result[4] = 0;
@@ -780,15 +783,7 @@ void Xform3::SetConcat(const Xform3& a, const Xform3& b) {
     result[15] = 1;
     SetDirtyTypeMask(TypeMaskTranslate | TypeMaskScale);
   } else {
-    for (int j = 0; j < 4; j++) {
-      for (int i = 0; i < 4; i++) {
-        double value = 0;
-        for (int k = 0; k < 4; k++) {
-          value += static_cast<double>(a.d_[k][i]) * b.d_[j][k];
-        }
-        *result++ = value;
-      }
-    }
+    Xform3KernelSelector::getBest().concat(result, &a.d_[0][0], &b.d_[0][0]);
     DirtyTypeMask();
   }
 
@@ -946,8 +941,7 @@ Point3 Xform3::MapPoint(Point3 point) const {
 }
 
 void Xform3::MapPoints(Point3 dst[], const Point3 src[], int count) const {
-  for (int i = 0; i < count; ++i)
-    dst[i] = MapPoint(src[i]);
+  Xform3KernelSelector::getBest().mapPoints(dst, src, count, &d_[0][0]);
 }
 
 void Xform3::MapMatrix4x1(float dst[4], const float src[4]) const {
@@ -972,38 +966,7 @@ double Xform3::GetDeterminant() const {
       return 1;
     return d_[0][0] * d_[1][1] * d_[2][2] * d_[3][3];
   }
-
-  double a00 = d_[0][0];
-  double a01 = d_[0][1];
-  double a02 = d_[0][2];
-  double a03 = d_[0][3];
-  double a10 = d_[1][0];
-  double a11 = d_[1][1];
-  double a12 = d_[1][2];
-  double a13 = d_[1][3];
-  double a20 = d_[2][0];
-  double a21 = d_[2][1];
-  double a22 = d_[2][2];
-  double a23 = d_[2][3];
-  double a30 = d_[3][0];
-  double a31 = d_[3][1];
-  double a32 = d_[3][2];
-  double a33 = d_[3][3];
-
-  double b00 = a00 * a11 - a01 * a10;
-  double b01 = a00 * a12 - a02 * a10;
-  double b02 = a00 * a13 - a03 * a10;
-  double b03 = a01 * a12 - a02 * a11;
-  double b04 = a01 * a13 - a03 * a11;
-  double b05 = a02 * a13 - a03 * a12;
-  double b06 = a20 * a31 - a21 * a30;
-  double b07 = a20 * a32 - a22 * a30;
-  double b08 = a20 * a33 - a23 * a30;
-  double b09 = a21 * a32 - a22 * a31;
-  double b10 = a21 * a33 - a23 * a31;
-  double b11 = a22 * a33 - a23 * a32;
-
-  return b00 * b11 - b01 * b10 + b02 * b09 + b03 * b08 - b04 * b07 + b05 * b06;
+  return Xform3KernelSelector::getBest().getDeterminant(&d_[0][0]);
 }
 
 bool Xform3::GetInverted(Xform3& out) const {
@@ -1047,140 +1010,21 @@ bool Xform3::GetInverted(Xform3& out) const {
     return isFinite(out);
   }
 
-  double a00 = d_[0][0];
-  double a01 = d_[0][1];
-  double a02 = d_[0][2];
-  double a03 = d_[0][3];
-  double a10 = d_[1][0];
-  double a11 = d_[1][1];
-  double a12 = d_[1][2];
-  double a13 = d_[1][3];
-  double a20 = d_[2][0];
-  double a21 = d_[2][1];
-  double a22 = d_[2][2];
-  double a23 = d_[2][3];
-  double a30 = d_[3][0];
-  double a31 = d_[3][1];
-  double a32 = d_[3][2];
-  double a33 = d_[3][3];
+  float inverse[EntryCount];
+  if (!Xform3KernelSelector::getBest().invert(inverse, &d_[0][0]))
+    return false;
+  copyObjectsNonOverlapping(&out.d_[0][0], inverse, EntryCount);
 
   if (!HasPerspective()) {
-    // If we know the matrix has no perspective, then the perspective
-    // component is (0, 0, 0, 1). We can use this information to save a lot
-    // of arithmetic that would otherwise be spent to compute the inverse
-    // of a general matrix.
-
-    ASSERT(a03 == 0);
-    ASSERT(a13 == 0);
-    ASSERT(a23 == 0);
-    ASSERT(a33 == 1);
-
-    double b00 = a00 * a11 - a01 * a10;
-    double b01 = a00 * a12 - a02 * a10;
-    double b03 = a01 * a12 - a02 * a11;
-    double b06 = a20 * a31 - a21 * a30;
-    double b07 = a20 * a32 - a22 * a30;
-    double b08 = a20;
-    double b09 = a21 * a32 - a22 * a31;
-    double b10 = a21;
-    double b11 = a22;
-
-    // Calculate the determinant
-    double det = b00 * b11 - b01 * b10 + b03 * b08;
-
-    double invdet = 1 / det;
-    // If det is zero, we want to return false. However, we also want to return false
-    // if 1/det overflows to infinity (i.e. det is denormalized). Both of these are
-    // handled by checking that 1/det is finite.
-    if (!isFinite(invdet))
-      return false;
-
-    b00 *= invdet;
-    b01 *= invdet;
-    b03 *= invdet;
-    b06 *= invdet;
-    b07 *= invdet;
-    b08 *= invdet;
-    b09 *= invdet;
-    b10 *= invdet;
-    b11 *= invdet;
-
-    out.d_[0][0] = a11 * b11 - a12 * b10;
-    out.d_[0][1] = a02 * b10 - a01 * b11;
-    out.d_[0][2] = b03;
+    // Inverse of affine matrix is affine. Avoid rounding errors sneaking
+    // into perspective component.
     out.d_[0][3] = 0;
-    out.d_[1][0] = a12 * b08 - a10 * b11;
-    out.d_[1][1] = a00 * b11 - a02 * b08;
-    out.d_[1][2] = -b01;
     out.d_[1][3] = 0;
-    out.d_[2][0] = a10 * b10 - a11 * b08;
-    out.d_[2][1] = a01 * b08 - a00 * b10;
-    out.d_[2][2] = b00;
     out.d_[2][3] = 0;
-    out.d_[3][0] = a11 * b07 - a10 * b09 - a12 * b06;
-    out.d_[3][1] = a00 * b09 - a01 * b07 + a02 * b06;
-    out.d_[3][2] = a31 * b01 - a30 * b03 - a32 * b00;
     out.d_[3][3] = 1;
-
-    out.type_mask_ = type_mask_;
-    return isFinite(out);
   }
 
-  double b00 = a00 * a11 - a01 * a10;
-  double b01 = a00 * a12 - a02 * a10;
-  double b02 = a00 * a13 - a03 * a10;
-  double b03 = a01 * a12 - a02 * a11;
-  double b04 = a01 * a13 - a03 * a11;
-  double b05 = a02 * a13 - a03 * a12;
-  double b06 = a20 * a31 - a21 * a30;
-  double b07 = a20 * a32 - a22 * a30;
-  double b08 = a20 * a33 - a23 * a30;
-  double b09 = a21 * a32 - a22 * a31;
-  double b10 = a21 * a33 - a23 * a31;
-  double b11 = a22 * a33 - a23 * a32;
-
-  // Calculate the determinant
-  double det = b00 * b11 - b01 * b10 + b02 * b09 + b03 * b08 - b04 * b07 + b05 * b06;
-
-  double invdet = 1 / det;
-  // If det is zero, we want to return false. However, we also want to return false
-  // if 1/det overflows to infinity (i.e. det is denormalized). Both of these are
-  // handled by checking that 1/det is finite.
-  if (!isFinite(invdet))
-    return false;
-
-  b00 *= invdet;
-  b01 *= invdet;
-  b02 *= invdet;
-  b03 *= invdet;
-  b04 *= invdet;
-  b05 *= invdet;
-  b06 *= invdet;
-  b07 *= invdet;
-  b08 *= invdet;
-  b09 *= invdet;
-  b10 *= invdet;
-  b11 *= invdet;
-
-  out.d_[0][0] = a11 * b11 - a12 * b10 + a13 * b09;
-  out.d_[0][1] = a02 * b10 - a01 * b11 - a03 * b09;
-  out.d_[0][2] = a31 * b05 - a32 * b04 + a33 * b03;
-  out.d_[0][3] = a22 * b04 - a21 * b05 - a23 * b03;
-  out.d_[1][0] = a12 * b08 - a10 * b11 - a13 * b07;
-  out.d_[1][1] = a00 * b11 - a02 * b08 + a03 * b07;
-  out.d_[1][2] = a32 * b02 - a30 * b05 - a33 * b01;
-  out.d_[1][3] = a20 * b05 - a22 * b02 + a23 * b01;
-  out.d_[2][0] = a10 * b10 - a11 * b08 + a13 * b06;
-  out.d_[2][1] = a01 * b08 - a00 * b10 - a03 * b06;
-  out.d_[2][2] = a30 * b04 - a31 * b02 + a33 * b00;
-  out.d_[2][3] = a21 * b02 - a20 * b04 - a23 * b00;
-  out.d_[3][0] = a11 * b07 - a10 * b09 - a12 * b06;
-  out.d_[3][1] = a00 * b09 - a01 * b07 + a02 * b06;
-  out.d_[3][2] = a31 * b01 - a30 * b03 - a32 * b00;
-  out.d_[3][3] = a20 * b03 - a21 * b01 + a22 * b00;
-
   out.type_mask_ = type_mask_;
-
   return isFinite(out);
 }
 
@@ -1464,6 +1308,131 @@ DecomposedXform3 lerp(
   return out;
 }
 
+// Batched functions process eight transforms at once.
+static const int BatchSize = 8;
+
+static void LerpBatch(
+    const DecomposedXform3* from, const DecomposedXform3* to, const float* progress,
+    int count, DecomposedXform3* out) {
+  // Gather quaternions before writing |out| which may be equal to |from| or |to|.
+  InlineList<Quaternion, BatchSize> from_quaternions;
+  InlineList<Quaternion, BatchSize> to_quaternions;
+  for (int k = 0; k < count; ++k) {
+    from_quaternions.add(from[k].quaternion);
+    to_quaternions.add(to[k].quaternion);
+  }
+  SlerpEach(from_quaternions, to_quaternions, Span<float>(progress, count), from_quaternions);
+
+  for (int k = 0; k < count; ++k) {
+    double scalea = 1.0 - progress[k];
+    double scaleb = progress[k];
+    out[k].translate = lerp(from[k].translate, to[k].translate, progress[k]);
+    Combine<3>(out[k].scale, from[k].scale, to[k].scale, scalea, scaleb);
+    Combine<3>(out[k].shear, from[k].shear, to[k].shear, scalea, scaleb);
+    Combine<4>(out[k].perspective, from[k].perspective, to[k].perspective, scalea, scaleb);
+    out[k].quaternion = from_quaternions[k];
+  }
+}
+
+// Vectorized variant of Recompose(). Each vector holds single component of
+// all transforms in the batch. Missing tail lanes replicate the first transform.
+static void RecomposeBatch(const DecomposedXform3* decomps, int count, Xform3* out) {
+  float components[17][BatchSize];
+  for (int k = 0; k < BatchSize; ++k) {
+    const DecomposedXform3& decomp = decomps[k < count ? k : 0];
+    components[0][k] = static_cast<float>(decomp.quaternion.w);
+    components[1][k] = static_cast<float>(decomp.quaternion.x);
+    components[2][k] = static_cast<float>(decomp.quaternion.y);
+    components[3][k] = static_cast<float>(decomp.quaternion.z);
+    components[4][k] = decomp.translate.x;
+    components[5][k] = decomp.translate.y;
+    components[6][k] = decomp.translate.z;
+    for (int j = 0; j < 3; ++j) {
+      components[7 + j][k] = decomp.scale[j];
+      components[10 + j][k] = decomp.shear[j];
+    }
+    for (int j = 0; j < 4; ++j)
+      components[13 + j][k] = decomp.perspective[j];
+  }
+  Vec8f c[17];
+  for (int j = 0; j < 17; ++j)
+    c[j] = Vec8f::load(components[j]);
+
+  Vec8f w = c[0], x = c[1], y = c[2], z = c[3];
+
+  // Columns of rotation matrix, same as in SetRotate().
+  Vec8f r[3][3] = {
+    { Vec8f(1) - (y * y + z * z) * 2, (x * y + z * w) * 2, (x * z - y * w) * 2 },
+    { (x * y - z * w) * 2, Vec8f(1) - (x * x + z * z) * 2, (y * z + x * w) * 2 },
+    { (x * z + y * w) * 2, (y * z - x * w) * 2, Vec8f(1) - (x * x + y * y) * 2 },
+  };
+
+  // Rotation concatenated with shear matrix built by ApplyShear():
+  //   [ 1  shear[0]  shear[1] ]
+  //   [ 0     1      shear[2] ]
+  //   [ 0     0         1     ]
+  // and with scale.
+  Vec8f m[4][4];
+  for (int row = 0; row < 3; ++row) {
+    m[0][row] = r[0][row] * c[7];
+    m[1][row] = (r[0][row] * c[10] + r[1][row]) * c[8];
+    m[2][row] = (r[0][row] * c[11] + r[1][row] * c[12] + r[2][row]) * c[9];
+    m[3][row] = c[4 + row];
+  }
+  // Perspective matrix is applied last, only the bottom row is affected.
+  for (int col = 0; col < 4; ++col)
+    m[col][3] = c[13] * m[col][0] + c[14] * m[col][1] + c[15] * m[col][2];
+  m[3][3] = m[3][3] + c[16];
+
+  float entries[4][4][BatchSize];
+  for (int col = 0; col < 4; ++col) {
+    for (int row = 0; row < 4; ++row)
+      m[col][row].store(entries[col][row]);
+  }
+  for (int k = 0; k < count; ++k) {
+    out[k] = Xform3(
+        entries[0][0][k], entries[1][0][k], entries[2][0][k], entries[3][0][k],
+        entries[0][1][k], entries[1][1][k], entries[2][1][k], entries[3][1][k],
+        entries[0][2][k], entries[1][2][k], entries[2][2][k], entries[3][2][k],
+        entries[0][3][k], entries[1][3][k], entries[2][3][k], entries[3][3][k]);
+  }
+}
+
+void lerpEach(
+    Span<DecomposedXform3> from, Span<DecomposedXform3> to, Span<float> progress,
+    MutableSpan<DecomposedXform3> out) {
+  ASSERT(from.size() == to.size() && to.size() == progress.size() && progress.size() == out.size());
+
+  int count = from.size();
+  for (int i = 0; i < count; i += BatchSize) {
+    int batch_count = min(BatchSize, count - i);
+    LerpBatch(&from[i], &to[i], &progress[i], batch_count, &out[i]);
+  }
+}
+
+void lerpEach(
+    Span<DecomposedXform3> from, Span<DecomposedXform3> to, Span<float> progress,
+    MutableSpan<Xform3> out) {
+  ASSERT(from.size() == to.size() && to.size() == progress.size() && progress.size() == out.size());
+
+  int count = from.size();
+  for (int i = 0; i < count; i += BatchSize) {
+    int batch_count = min(BatchSize, count - i);
+    InlineList<DecomposedXform3, BatchSize> decomps;
+    DecomposedXform3* decomps_data = decomps.appendUninitialized(batch_count);
+    LerpBatch(&from[i], &to[i], &progress[i], batch_count, decomps_data);
+    RecomposeBatch(decomps_data, batch_count, &out[i]);
+  }
+}
+
+void RecomposeEach(Span<DecomposedXform3> decomps, MutableSpan<Xform3> out) {
+  ASSERT(decomps.size() == out.size());
+
+  int count = decomps.size();
+  for (int i = 0; i < count; i += BatchSize)
+    RecomposeBatch(&decomps[i], min(BatchSize, count - i), &out[i]);
+}
+
 static void StreamFloats(TextWriter& out, StringSpan name, const float* fv, int size) {
   out.WriteAscii(name);
   out.WriteAscii(": ");
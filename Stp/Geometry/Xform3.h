@@ -6,6 +6,7 @@
 #ifndef STP_BASE_GEOMETRY_XFORM3_H_
 #define STP_BASE_GEOMETRY_XFORM3_H_
 
+#include "Base/Containers/Span.h"
 #include "Base/Debug/Assert.h"
 #include "Geometry/Angle.h"
 #include "Geometry/Limits.h"
@@ -401,8 +402,8 @@ class BASE_EXPORT Xform3 {
 //
 // Note: this call is expensive since we need to decompose the transform. If
 // you're going to be calling this rapidly (e.g., in an animation) you should
-// decompose once using DecomposeTransforms and reuse your
-// DecomposedTransform.
+// decompose once using decompose() and reuse your DecomposedXform3,
+// see lerpEach().
 BASE_EXPORT bool Trylerp(Xform3& out, const Xform3& x, const Xform3& y, double t);
 
 BASE_EXPORT bool isNear(const Xform3& lhs, const Xform3& rhs, float tolerance = 0.1f);
@@ -440,6 +441,23 @@ BASE_EXPORT DecomposedXform3 lerp(
     const DecomposedXform3& from, const DecomposedXform3& to,
     double progress);
 
+// Batched version of lerp() above, interpolating |from[i]| to |to[i]| by
+// |progress[i]|. Quaternions are interpolated in single precision, eight
+// transforms at a time. |out| may be the same span as |from| or |to|.
+BASE_EXPORT void lerpEach(
+    Span<DecomposedXform3> from, Span<DecomposedXform3> to, Span<float> progress,
+    MutableSpan<DecomposedXform3> out);
+
+// Same as above, but recomposes the results into |out| matrices.
+// Animations should decompose their keyframes once and call this every frame
+// instead of Trylerp() which decomposes both transforms on each call.
+BASE_EXPORT void lerpEach(
+    Span<DecomposedXform3> from, Span<DecomposedXform3> to, Span<float> progress,
+    MutableSpan<Xform3> out);
+
+// Batched version of Xform3::Recompose(), eight transforms at a time.
+BASE_EXPORT void RecomposeEach(Span<DecomposedXform3> decomps, MutableSpan<Xform3> out);
+
 constexpr Xform3::Xform3(InitWithIdentityTag)
     : d_ { { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 0 }, { 0, 0, 0, 1 } },
       type_mask_(TypeMaskIdentity) {
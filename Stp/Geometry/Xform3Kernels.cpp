@@ -0,0 +1,419 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Geometry/Xform3Kernels.h"
+
+#include "Base/Math/Math.h"
+#include "Base/Simd/Vnx.h"
+#include "Base/System/CpuInfo.h"
+
+namespace stp {
+
+namespace {
+
+// Element at |row| and |col| in column-major 4x4 matrix.
+inline float at(const float* m, int row, int col) {
+  return m[col * 4 + row];
+}
+
+void concatScalar(float* dst, const float* a, const float* b) {
+  for (int j = 0; j < 4; j++) {
+    for (int i = 0; i < 4; i++) {
+      double value = 0;
+      for (int k = 0; k < 4; k++)
+        value += static_cast<double>(at(a, i, k)) * at(b, k, j);
+      *dst++ = static_cast<float>(value);
+    }
+  }
+}
+
+bool invertScalar(float* dst, const float* m) {
+  double a00 = m[0];
+  double a01 = m[1];
+  double a02 = m[2];
+  double a03 = m[3];
+  double a10 = m[4];
+  double a11 = m[5];
+  double a12 = m[6];
+  double a13 = m[7];
+  double a20 = m[8];
+  double a21 = m[9];
+  double a22 = m[10];
+  double a23 = m[11];
+  double a30 = m[12];
+  double a31 = m[13];
+  double a32 = m[14];
+  double a33 = m[15];
+
+  if (a03 == 0 && a13 == 0 && a23 == 0 && a33 == 1) {
+    // If we know the matrix has no perspective, then the perspective
+    // component is (0, 0, 0, 1). We can use this information to save a lot
+    // of arithmetic that would otherwise be spent to compute the inverse
+    // of a general matrix.
+    double b00 = a00 * a11 - a01 * a10;
+    double b01 = a00 * a12 - a02 * a10;
+    double b03 = a01 * a12 - a02 * a11;
+    double b06 = a20 * a31 - a21 * a30;
+    double b07 = a20 * a32 - a22 * a30;
+    double b08 = a20;
+    double b09 = a21 * a32 - a22 * a31;
+    double b10 = a21;
+    double b11 = a22;
+
+    // Calculate the determinant
+    double det = b00 * b11 - b01 * b10 + b03 * b08;
+
+    double invdet = 1 / det;
+    // If det is zero, we want to return false. However, we also want to return false
+    // if 1/det overflows to infinity (i.e. det is denormalized). Both of these are
+    // handled by checking that 1/det is finite.
+    if (!isFinite(invdet))
+      return false;
+
+    b00 *= invdet;
+    b01 *= invdet;
+    b03 *= invdet;
+    b06 *= invdet;
+    b07 *= invdet;
+    b08 *= invdet;
+    b09 *= invdet;
+    b10 *= invdet;
+    b11 *= invdet;
+
+    dst[0] = a11 * b11 - a12 * b10;
+    dst[1] = a02 * b10 - a01 * b11;
+    dst[2] = b03;
+    dst[3] = 0;
+    dst[4] = a12 * b08 - a10 * b11;
+    dst[5] = a00 * b11 - a02 * b08;
+    dst[6] = -b01;
+    dst[7] = 0;
+    dst[8] = a10 * b10 - a11 * b08;
+    dst[9] = a01 * b08 - a00 * b10;
+    dst[10] = b00;
+    dst[11] = 0;
+    dst[12] = a11 * b07 - a10 * b09 - a12 * b06;
+    dst[13] = a00 * b09 - a01 * b07 + a02 * b06;
+    dst[14] = a31 * b01 - a30 * b03 - a32 * b00;
+    dst[15] = 1;
+    return true;
+  }
+
+  double b00 = a00 * a11 - a01 * a10;
+  double b01 = a00 * a12 - a02 * a10;
+  double b02 = a00 * a13 - a03 * a10;
+  double b03 = a01 * a12 - a02 * a11;
+  double b04 = a01 * a13 - a03 * a11;
+  double b05 = a02 * a13 - a03 * a12;
+  double b06 = a20 * a31 - a21 * a30;
+  double b07 = a20 * a32 - a22 * a30;
+  double b08 = a20 * a33 - a23 * a30;
+  double b09 = a21 * a32 - a22 * a31;
+  double b10 = a21 * a33 - a23 * a31;
+  double b11 = a22 * a33 - a23 * a32;
+
+  // Calculate the determinant
+  double det = b00 * b11 - b01 * b10 + b02 * b09 + b03 * b08 - b04 * b07 + b05 * b06;
+
+  double invdet = 1 / det;
+  if (!isFinite(invdet))
+    return false;
+
+  b00 *= invdet;
+  b01 *= invdet;
+  b02 *= invdet;
+  b03 *= invdet;
+  b04 *= invdet;
+  b05 *= invdet;
+  b06 *= invdet;
+  b07 *= invdet;
+  b08 *= invdet;
+  b09 *= invdet;
+  b10 *= invdet;
+  b11 *= invdet;
+
+  dst[0] = a11 * b11 - a12 * b10 + a13 * b09;
+  dst[1] = a02 * b10 - a01 * b11 - a03 * b09;
+  dst[2] = a31 * b05 - a32 * b04 + a33 * b03;
+  dst[3] = a22 * b04 - a21 * b05 - a23 * b03;
+  dst[4] = a12 * b08 - a10 * b11 - a13 * b07;
+  dst[5] = a00 * b11 - a02 * b08 + a03 * b07;
+  dst[6] = a32 * b02 - a30 * b05 - a33 * b01;
+  dst[7] = a20 * b05 - a22 * b02 + a23 * b01;
+  dst[8] = a10 * b10 - a11 * b08 + a13 * b06;
+  dst[9] = a01 * b08 - a00 * b10 - a03 * b06;
+  dst[10] = a30 * b04 - a31 * b02 + a33 * b00;
+  dst[11] = a21 * b02 - a20 * b04 - a23 * b00;
+  dst[12] = a11 * b07 - a10 * b09 - a12 * b06;
+  dst[13] = a00 * b09 - a01 * b07 + a02 * b06;
+  dst[14] = a31 * b01 - a30 * b03 - a32 * b00;
+  dst[15] = a20 * b03 - a21 * b01 + a22 * b00;
+  return true;
+}
+
+double getDeterminantScalar(const float* m) {
+  double a00 = m[0];
+  double a01 = m[1];
+  double a02 = m[2];
+  double a03 = m[3];
+  double a10 = m[4];
+  double a11 = m[5];
+  double a12 = m[6];
+  double a13 = m[7];
+  double a20 = m[8];
+  double a21 = m[9];
+  double a22 = m[10];
+  double a23 = m[11];
+  double a30 = m[12];
+  double a31 = m[13];
+  double a32 = m[14];
+  double a33 = m[15];
+
+  double b00 = a00 * a11 - a01 * a10;
+  double b01 = a00 * a12 - a02 * a10;
+  double b02 = a00 * a13 - a03 * a10;
+  double b03 = a01 * a12 - a02 * a11;
+  double b04 = a01 * a13 - a03 * a11;
+  double b05 = a02 * a13 - a03 * a12;
+  double b06 = a20 * a31 - a21 * a30;
+  double b07 = a20 * a32 - a22 * a30;
+  double b08 = a20 * a33 - a23 * a30;
+  double b09 = a21 * a32 - a22 * a31;
+  double b10 = a21 * a33 - a23 * a31;
+  double b11 = a22 * a33 - a23 * a32;
+
+  return b00 * b11 - b01 * b10 + b02 * b09 + b03 * b08 - b04 * b07 + b05 * b06;
+}
+
+void mapPointsScalar(Point3* dst, const Point3* src, int count, const float* m) {
+  for (int i = 0; i < count; ++i) {
+    const float in[4] = { src[i].x, src[i].y, src[i].z, 1 };
+    float out[4];
+    for (int row = 0; row < 4; ++row) {
+      float value = 0;
+      for (int col = 0; col < 4; ++col)
+        value += at(m, row, col) * in[col];
+      out[row] = value;
+    }
+    if (out[3] != 1 && out[3] != 0.f) {
+      float w_inverse = 1 / out[3];
+      dst[i] = Point3(out[0] * w_inverse, out[1] * w_inverse, out[2] * w_inverse);
+    } else {
+      dst[i] = Point3(out[0], out[1], out[2]);
+    }
+  }
+}
+
+#if CPU_SIMD(SSE2) || CPU_SIMD(NEON)
+
+// Returns lanes A, B, C, D of |v|.
+template<int A, int B, int C, int D>
+inline Vec4f swizzle(const Vec4f& v) {
+  #if CPU_SIMD(SSE2)
+  return _mm_shuffle_ps(v.vec_, v.vec_, _MM_SHUFFLE(D, C, B, A));
+  #else
+  return VnxMath::shuffle<A, B, C, D>(v);
+  #endif
+}
+
+// Returns lanes A and B of |x| followed by lanes C and D of |y|.
+template<int A, int B, int C, int D>
+inline Vec4f shuffle2(const Vec4f& x, const Vec4f& y) {
+  #if CPU_SIMD(SSE2)
+  return _mm_shuffle_ps(x.vec_, y.vec_, _MM_SHUFFLE(D, C, B, A));
+  #else
+  return Vec4f(x[A], x[B], y[C], y[D]);
+  #endif
+}
+
+// 2x2 matrices below are stored in vectors in row-major order.
+
+// Returns |l| * |r|.
+inline Vec4f mul2x2(const Vec4f& l, const Vec4f& r) {
+  return l * swizzle<0, 3, 0, 3>(r) + swizzle<1, 0, 3, 2>(l) * swizzle<2, 1, 2, 1>(r);
+}
+
+// Returns adjugate(|l|) * |r|.
+inline Vec4f adjMul2x2(const Vec4f& l, const Vec4f& r) {
+  return swizzle<3, 3, 0, 0>(l) * r - swizzle<1, 1, 2, 2>(l) * swizzle<2, 3, 0, 1>(r);
+}
+
+// Returns |l| * adjugate(|r|).
+inline Vec4f mulAdj2x2(const Vec4f& l, const Vec4f& r) {
+  return l * swizzle<3, 0, 3, 0>(r) - swizzle<1, 0, 3, 2>(l) * swizzle<2, 1, 2, 1>(r);
+}
+
+inline float sumLanes(const Vec4f& v) {
+  Vec4f sum = v + swizzle<2, 3, 0, 1>(v);
+  sum = sum + swizzle<1, 0, 3, 2>(sum);
+  return sum[0];
+}
+
+// Single precision is enough when columns are far from being linearly
+// dependent. Measured by ratio of determinant to the product of column
+// lengths (which is its upper bound).
+constexpr float MinDeterminantRatio = 1e-3f;
+
+bool isWellConditioned(const Vec4f* columns, float det) {
+  float volume = 1;
+  for (int i = 0; i < 4; ++i)
+    volume *= sumLanes(columns[i] * columns[i]);
+  volume = mathSqrt(volume);
+  // Also catches infinities and NaNs.
+  return mathAbs(det) >= MinDeterminantRatio * volume &&
+         volume >= Limits<float>::SmallestNormal && volume <= Limits<float>::Max;
+}
+
+// Computes adjugate of matrix (with columns |m|) and its determinant
+// with block-wise inversion, see:
+// https://lxjk.github.io/2017/09/03/Fast-4x4-Matrix-Inverse-with-SSE-SIMD-Explained.html
+// The algorithm works on rows, but since transposition commutes with
+// inversion, it can be applied to columns just as well.
+inline float computeAdjugate(const Vec4f* m, Vec4f* adj) {
+  // 2x2 blocks.
+  Vec4f a = shuffle2<0, 1, 0, 1>(m[0], m[1]);
+  Vec4f b = shuffle2<2, 3, 2, 3>(m[0], m[1]);
+  Vec4f c = shuffle2<0, 1, 0, 1>(m[2], m[3]);
+  Vec4f d = shuffle2<2, 3, 2, 3>(m[2], m[3]);
+
+  // Determinants of the blocks.
+  Vec4f det_sub =
+      shuffle2<0, 2, 0, 2>(m[0], m[2]) * shuffle2<1, 3, 1, 3>(m[1], m[3]) -
+      shuffle2<1, 3, 1, 3>(m[0], m[2]) * shuffle2<0, 2, 0, 2>(m[1], m[3]);
+  Vec4f det_a = swizzle<0, 0, 0, 0>(det_sub);
+  Vec4f det_b = swizzle<1, 1, 1, 1>(det_sub);
+  Vec4f det_c = swizzle<2, 2, 2, 2>(det_sub);
+  Vec4f det_d = swizzle<3, 3, 3, 3>(det_sub);
+
+  Vec4f d_c = adjMul2x2(d, c);
+  Vec4f a_b = adjMul2x2(a, b);
+  Vec4f x = det_d * a - mul2x2(b, d_c);
+  Vec4f w = det_a * d - mul2x2(c, a_b);
+  Vec4f y = det_b * c - mulAdj2x2(d, a_b);
+  Vec4f z = det_c * b - mulAdj2x2(a, d_c);
+
+  float det = det_sub[0] * det_sub[3] + det_sub[1] * det_sub[2] -
+      sumLanes(a_b * swizzle<0, 2, 1, 3>(d_c));
+
+  // Blocks of adjugate need sign adjustments.
+  const Vec4f sign(1, -1, -1, 1);
+  x = x * sign;
+  y = y * sign;
+  z = z * sign;
+  w = w * sign;
+
+  adj[0] = shuffle2<3, 1, 3, 1>(x, y);
+  adj[1] = shuffle2<2, 0, 2, 0>(x, y);
+  adj[2] = shuffle2<3, 1, 3, 1>(z, w);
+  adj[3] = shuffle2<2, 0, 2, 0>(z, w);
+  return det;
+}
+
+void concatSimd128(float* dst, const float* a, const float* b) {
+  Vec4f a0 = Vec4f::load(a + 0);
+  Vec4f a1 = Vec4f::load(a + 4);
+  Vec4f a2 = Vec4f::load(a + 8);
+  Vec4f a3 = Vec4f::load(a + 12);
+  for (int j = 0; j < 4; ++j) {
+    const float* bj = b + j * 4;
+    Vec4f column = a0 * Vec4f(bj[0]) + a1 * Vec4f(bj[1]) + a2 * Vec4f(bj[2]) + a3 * Vec4f(bj[3]);
+    column.store(dst + j * 4);
+  }
+}
+
+bool invertSimd128(float* dst, const float* src) {
+  Vec4f m[4];
+  for (int i = 0; i < 4; ++i)
+    m[i] = Vec4f::load(src + i * 4);
+
+  Vec4f adj[4];
+  float det = computeAdjugate(m, adj);
+  if (!isWellConditioned(m, det))
+    return invertScalar(dst, src);
+
+  Vec4f inv_det(1 / det);
+  for (int i = 0; i < 4; ++i)
+    (adj[i] * inv_det).store(dst + i * 4);
+  return true;
+}
+
+void mapPointsSimd128(Point3* dst, const Point3* src, int count, const float* m) {
+  Vec4f m0 = Vec4f::load(m + 0);
+  Vec4f m1 = Vec4f::load(m + 4);
+  Vec4f m2 = Vec4f::load(m + 8);
+  Vec4f m3 = Vec4f::load(m + 12);
+  for (int i = 0; i < count; ++i) {
+    Point3 p = src[i];
+    Vec4f r = m0 * Vec4f(p.x) + m1 * Vec4f(p.y) + m2 * Vec4f(p.z) + m3;
+    float w = r[3];
+    if (w != 1 && w != 0.f)
+      r = r * Vec4f(1 / w);
+    float out[4];
+    r.store(out);
+    dst[i] = Point3(out[0], out[1], out[2]);
+  }
+}
+
+#endif // CPU_SIMD(*)
+
+} // namespace
+
+namespace detail {
+
+const Xform3Kernels Xform3ScalarKernels = {
+  concatScalar,
+  invertScalar,
+  getDeterminantScalar,
+  mapPointsScalar,
+};
+
+#if CPU_SIMD(SSE2) || CPU_SIMD(NEON)
+const Xform3Kernels Xform3Simd128Kernels = {
+  concatSimd128,
+  invertSimd128,
+  // Determinant alone is cheaper to compute in scalar code.
+  getDeterminantScalar,
+  mapPointsSimd128,
+};
+#endif
+
+} // namespace detail
+
+const Xform3Kernels* Xform3KernelSelector::tryGet(Xform3KernelSet set) {
+  switch (set) {
+    case Xform3KernelSet::Scalar:
+      return &detail::Xform3ScalarKernels;
+    case Xform3KernelSet::Simd128:
+      #if CPU_SIMD(SSE2) || CPU_SIMD(NEON)
+      return &detail::Xform3Simd128Kernels;
+      #else
+      return nullptr;
+      #endif
+    case Xform3KernelSet::Avx:
+      #if CPU(X86_FAMILY)
+      if (CpuInfo::Supports(CpuFeature::Avx))
+        return &detail::Xform3AvxKernels;
+      #endif
+      return nullptr;
+  }
+  return nullptr;
+}
+
+static const Xform3Kernels* chooseBestXform3Kernels() {
+  const Xform3KernelSet Preferred[] = {
+    Xform3KernelSet::Avx,
+    Xform3KernelSet::Simd128,
+  };
+  for (Xform3KernelSet set : Preferred) {
+    if (const Xform3Kernels* kernels = Xform3KernelSelector::tryGet(set))
+      return kernels;
+  }
+  return &detail::Xform3ScalarKernels;
+}
+
+const Xform3Kernels& Xform3KernelSelector::getBest() {
+  static const Xform3Kernels* g_best = chooseBestXform3Kernels();
+  return *g_best;
+}
+
+} // namespace stp
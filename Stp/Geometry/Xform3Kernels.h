@@ -0,0 +1,69 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#ifndef STP_BASE_GEOMETRY_XFORM3KERNELS_H_
+#define STP_BASE_GEOMETRY_XFORM3KERNELS_H_
+
+#include "Base/Compiler/Simd.h"
+#include "Geometry/Vector3.h"
+
+namespace stp {
+
+// Low-level routines behind Xform3 operating on 4x4 matrices stored
+// in column-major order (the layout of Xform3).
+//
+// Several sets are built for x86 (SSE2 and AVX) and ARM (NEON); the best one
+// supported by running CPU is chosen with CpuInfo on first use.
+// SIMD sets compute in single precision. Whenever that is not accurate enough
+// (nearly singular or badly scaled matrix) they defer to scalar code computing
+// in double precision, so results match within isNear() tolerance.
+struct Xform3Kernels {
+  // Computes |dst| = |a| * |b|. |dst| must not alias |a| or |b|.
+  void (*concat)(float* dst, const float* a, const float* b);
+
+  // Computes inverse of |src| into |dst|. Returns false and leaves |dst|
+  // untouched if |src| is singular.
+  bool (*invert)(float* dst, const float* src);
+
+  double (*getDeterminant)(const float* m);
+
+  // Maps |count| points through |m|, dividing by w when it is not 0 or 1.
+  // |dst| may be equal to |src|.
+  void (*mapPoints)(Point3* dst, const Point3* src, int count, const float* m);
+};
+
+enum class Xform3KernelSet {
+  Scalar,
+  // 128-bit vectors: SSE2 on x86, NEON on ARM.
+  Simd128,
+  // 256-bit AVX on x86.
+  Avx,
+};
+
+class BASE_EXPORT Xform3KernelSelector {
+  STATIC_ONLY(Xform3KernelSelector);
+ public:
+  // Returns the best kernels for running CPU.
+  static const Xform3Kernels& getBest();
+
+  // Returns given set or null if it is not built in or not supported by
+  // running CPU. Useful for testing and benchmarking.
+  static const Xform3Kernels* tryGet(Xform3KernelSet set);
+};
+
+namespace detail {
+
+extern const Xform3Kernels Xform3ScalarKernels;
+#if CPU_SIMD(SSE2) || CPU_SIMD(NEON)
+extern const Xform3Kernels Xform3Simd128Kernels;
+#endif
+#if CPU(X86_FAMILY)
+// Defined in translation unit built with AVX enabled.
+extern const Xform3Kernels Xform3AvxKernels;
+#endif
+
+} // namespace detail
+
+} // namespace stp
+
+#endif // STP_BASE_GEOMETRY_XFORM3KERNELS_H_
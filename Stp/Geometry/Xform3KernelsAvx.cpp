@@ -0,0 +1,131 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+// This file is compiled with AVX enabled. Only reached after CpuInfo
+// reported AVX support, so nothing here may be called from elsewhere.
+// Do not use inline functions from headers here: the linker might pick
+// their AVX instances for use in the rest of program.
+
+#include "Geometry/Xform3Kernels.h"
+
+#include <immintrin.h>
+
+namespace stp {
+
+namespace {
+
+static_assert(sizeof(Point3) == 3 * sizeof(float), "Point3 must be tightly packed");
+
+void concatAvx(float* dst, const float* a, const float* b) {
+  __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 0));
+  __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 4));
+  __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 8));
+  __m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 12));
+
+  // Two columns of result at once.
+  for (int j = 0; j < 4; j += 2) {
+    __m256 bj = _mm256_loadu_ps(b + j * 4);
+    __m256 column = _mm256_mul_ps(a0, _mm256_permute_ps(bj, 0x00));
+    column = _mm256_add_ps(column, _mm256_mul_ps(a1, _mm256_permute_ps(bj, 0x55)));
+    column = _mm256_add_ps(column, _mm256_mul_ps(a2, _mm256_permute_ps(bj, 0xAA)));
+    column = _mm256_add_ps(column, _mm256_mul_ps(a3, _mm256_permute_ps(bj, 0xFF)));
+    _mm256_storeu_ps(dst + j * 4, column);
+  }
+}
+
+// A single 4x4 matrix fits 128-bit vectors perfectly, wider ones do not help.
+bool invertAvx(float* dst, const float* src) {
+  #if CPU_SIMD(SSE2)
+  return detail::Xform3Simd128Kernels.invert(dst, src);
+  #else
+  return detail::Xform3ScalarKernels.invert(dst, src);
+  #endif
+}
+
+double getDeterminantAvx(const float* m) {
+  return detail::Xform3ScalarKernels.getDeterminant(m);
+}
+
+void mapPointsAvx(Point3* dst_points, const Point3* src_points, int count, const float* m) {
+  // Point3 is accessed through floats to avoid its inline functions.
+  float* dst = reinterpret_cast<float*>(dst_points);
+  const float* src = reinterpret_cast<const float*>(src_points);
+
+  __m256 m0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m + 0));
+  __m256 m1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m + 4));
+  __m256 m2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m + 8));
+  __m256 m3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m + 12));
+  __m256 zero = _mm256_setzero_ps();
+  __m256 one = _mm256_set1_ps(1);
+
+  // Two points at once, each one in a half of vector. Four floats are loaded
+  // per point, so the last point is left for the tail.
+  int i = 0;
+  for (; i + 2 < count; i += 2) {
+    const float* p = src + i * 3;
+    __m256 v = _mm256_insertf128_ps(
+        _mm256_castps128_ps256(_mm_loadu_ps(p)), _mm_loadu_ps(p + 3), 1);
+
+    __m256 r = _mm256_mul_ps(m0, _mm256_permute_ps(v, 0x00));
+    r = _mm256_add_ps(r, _mm256_mul_ps(m1, _mm256_permute_ps(v, 0x55)));
+    r = _mm256_add_ps(r, _mm256_mul_ps(m2, _mm256_permute_ps(v, 0xAA)));
+    r = _mm256_add_ps(r, m3);
+
+    // Divide by w only if it is neither 1 nor 0.
+    __m256 w = _mm256_permute_ps(r, 0xFF);
+    __m256 divide = _mm256_and_ps(
+        _mm256_cmp_ps(w, one, _CMP_NEQ_UQ),
+        _mm256_cmp_ps(w, zero, _CMP_NEQ_UQ));
+    // Division is slow, skip it for affine transforms.
+    if (_mm256_movemask_ps(divide)) {
+      __m256 projected = _mm256_mul_ps(r, _mm256_div_ps(one, w));
+      // Select with bitwise operations, GCC lowers blendv here to branches.
+      r = _mm256_or_ps(_mm256_and_ps(divide, projected), _mm256_andnot_ps(divide, r));
+    }
+
+    // The fourth lane of first point is overwritten by the second one.
+    // Next point must be left intact since |dst| may be equal to |src|.
+    float* q = dst + i * 3;
+    __m128 second = _mm256_extractf128_ps(r, 1);
+    _mm_storeu_ps(q, _mm256_castps256_ps128(r));
+    _mm_storel_pi(reinterpret_cast<__m64*>(q + 3), second);
+    _mm_store_ss(q + 5, _mm_movehl_ps(second, second));
+  }
+
+  for (; i < count; ++i) {
+    const float* p = src + i * 3;
+    __m128 r = _mm_mul_ps(_mm256_castps256_ps128(m0), _mm_set1_ps(p[0]));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm256_castps256_ps128(m1), _mm_set1_ps(p[1])));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm256_castps256_ps128(m2), _mm_set1_ps(p[2])));
+    r = _mm_add_ps(r, _mm256_castps256_ps128(m3));
+
+    float out[4];
+    _mm_storeu_ps(out, r);
+    float w = out[3];
+    if (w != 1 && w != 0.f) {
+      float w_inverse = 1 / w;
+      out[0] *= w_inverse;
+      out[1] *= w_inverse;
+      out[2] *= w_inverse;
+    }
+    float* q = dst + i * 3;
+    q[0] = out[0];
+    q[1] = out[1];
+    q[2] = out[2];
+  }
+}
+
+} // namespace
+
+namespace detail {
+
+const Xform3Kernels Xform3AvxKernels = {
+  concatAvx,
+  invertAvx,
+  getDeterminantAvx,
+  mapPointsAvx,
+};
+
+} // namespace detail
+
+} // namespace stp
@@ -0,0 +1,190 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Geometry/Xform3Kernels.h"
+
+#include "Base/Math/Math.h"
+#include "Base/Test/GTest.h"
+#include "Base/Util/Random.h"
+#include "Base/Util/RandomUtil.h"
+
+namespace stp {
+namespace {
+
+class Xform3KernelsTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    scalar_ = Xform3KernelSelector::tryGet(Xform3KernelSet::Scalar);
+    ASSERT_NE(nullptr, scalar_);
+  }
+
+  // Deterministic pseudo-random value in range [-range, range).
+  float nextFloat(float range) { return (RandomUtil::NextUnitFloat(random_) * 2 - 1) * range; }
+
+  void fillRandom(float* m, bool perspective) {
+    for (int i = 0; i < 16; ++i)
+      m[i] = nextFloat(4);
+    if (!perspective) {
+      m[3] = 0;
+      m[7] = 0;
+      m[11] = 0;
+      m[15] = 1;
+    }
+  }
+
+  // Calls |test| for every kernel set available on running CPU except scalar.
+  template<typename TTest>
+  void forEachSet(TTest test) {
+    for (auto set : { Xform3KernelSet::Simd128, Xform3KernelSet::Avx }) {
+      const Xform3Kernels* kernels = Xform3KernelSelector::tryGet(set);
+      if (!kernels)
+        continue;
+      SCOPED_TRACE(static_cast<int>(set));
+      test(*kernels);
+    }
+  }
+
+  const Xform3Kernels* scalar_ = nullptr;
+  Random random_;
+};
+
+void expectMatrixNear(const float* expected, const float* actual, float tolerance) {
+  for (int i = 0; i < 16; ++i) {
+    float scale = max(1.f, mathAbs(expected[i]));
+    EXPECT_NEAR(expected[i], actual[i], tolerance * scale) << "at " << i;
+  }
+}
+
+TEST_F(Xform3KernelsTest, GetBest) {
+  const Xform3Kernels& best = Xform3KernelSelector::getBest();
+  EXPECT_EQ(&best, &Xform3KernelSelector::getBest());
+  EXPECT_NE(nullptr, best.concat);
+  EXPECT_NE(nullptr, best.invert);
+  EXPECT_NE(nullptr, best.getDeterminant);
+  EXPECT_NE(nullptr, best.mapPoints);
+}
+
+TEST_F(Xform3KernelsTest, Concat) {
+  forEachSet([this](const Xform3Kernels& kernels) {
+    for (int iteration = 0; iteration < 100; ++iteration) {
+      float a[16], b[16];
+      fillRandom(a, iteration & 1);
+      fillRandom(b, iteration & 2);
+
+      float expected[16], actual[16];
+      scalar_->concat(expected, a, b);
+      kernels.concat(actual, a, b);
+      expectMatrixNear(expected, actual, 1e-5f);
+    }
+  });
+}
+
+TEST_F(Xform3KernelsTest, Invert) {
+  forEachSet([this](const Xform3Kernels& kernels) {
+    for (int iteration = 0; iteration < 100; ++iteration) {
+      float m[16];
+      fillRandom(m, iteration & 1);
+
+      float expected[16], actual[16];
+      bool expected_invertible = scalar_->invert(expected, m);
+      ASSERT_EQ(expected_invertible, kernels.invert(actual, m));
+      if (expected_invertible)
+        expectMatrixNear(expected, actual, 1e-3f);
+
+      EXPECT_NEAR(scalar_->getDeterminant(m), kernels.getDeterminant(m),
+                  1e-4 * max(1.0, mathAbs(scalar_->getDeterminant(m))));
+    }
+  });
+}
+
+TEST_F(Xform3KernelsTest, InvertSingular) {
+  // Third column is sum of first two.
+  const float singular[16] = {
+    1, 2, 3, 0,
+    4, 5, 6, 0,
+    5, 7, 9, 0,
+    1, 1, 1, 1,
+  };
+  const float zero[16] = {};
+
+  forEachSet([&](const Xform3Kernels& kernels) {
+    float dst[16] = {};
+    EXPECT_FALSE(kernels.invert(dst, singular));
+    EXPECT_FALSE(kernels.invert(dst, zero));
+    EXPECT_EQ(0, kernels.getDeterminant(singular));
+    EXPECT_EQ(0, kernels.getDeterminant(zero));
+  });
+}
+
+TEST_F(Xform3KernelsTest, InvertIllConditioned) {
+  // Columns are nearly linearly dependent and differ in scale a lot,
+  // single precision is not enough here.
+  const float m[16] = {
+    1e4f, 2, 3, 0,
+    1e4f, 2.0001f, 3, 0,
+    0, 0, 1e-4f, 0,
+    7, 8, 9, 1,
+  };
+
+  float expected[16];
+  ASSERT_TRUE(scalar_->invert(expected, m));
+  forEachSet([&](const Xform3Kernels& kernels) {
+    float actual[16];
+    ASSERT_TRUE(kernels.invert(actual, m));
+    expectMatrixNear(expected, actual, 1e-5f);
+    EXPECT_DOUBLE_EQ(scalar_->getDeterminant(m), kernels.getDeterminant(m));
+  });
+}
+
+TEST_F(Xform3KernelsTest, MapPoints) {
+  forEachSet([this](const Xform3Kernels& kernels) {
+    for (int iteration = 0; iteration < 20; ++iteration) {
+      float m[16];
+      fillRandom(m, iteration & 1);
+
+      // Odd count to exercise tails.
+      constexpr int Count = 37;
+      Point3 src[Count];
+      for (int i = 0; i < Count; ++i)
+        src[i] = Point3(nextFloat(100), nextFloat(100), nextFloat(100));
+
+      Point3 expected[Count], actual[Count];
+      scalar_->mapPoints(expected, src, Count, m);
+      kernels.mapPoints(actual, src, Count, m);
+
+      // In place.
+      Point3 in_place[Count];
+      for (int i = 0; i < Count; ++i)
+        in_place[i] = src[i];
+      kernels.mapPoints(in_place, in_place, Count, m);
+
+      for (int i = 0; i < Count; ++i) {
+        float tolerance = 1e-4f * max(1.f, mathAbs(expected[i].x) + mathAbs(expected[i].y) + mathAbs(expected[i].z));
+        EXPECT_TRUE(isNear(expected[i], actual[i], tolerance)) << "at " << i;
+        EXPECT_TRUE(isNear(actual[i], in_place[i], 0)) << "at " << i;
+      }
+    }
+  });
+}
+
+TEST_F(Xform3KernelsTest, MapPointsZeroW) {
+  // Projects everything to w = 0, points must be left undivided.
+  const float m[16] = {
+    1, 0, 0, 0,
+    0, 1, 0, 0,
+    0, 0, 1, 1,
+    0, 0, 0, 0,
+  };
+  Point3 src[3] = { Point3(1, 2, 0), Point3(3, 4, 0), Point3(5, 6, 2) };
+
+  forEachSet([&](const Xform3Kernels& kernels) {
+    Point3 dst[3];
+    kernels.mapPoints(dst, src, 3, m);
+    EXPECT_TRUE(isNear(Point3(1, 2, 0), dst[0], 0));
+    EXPECT_TRUE(isNear(Point3(3, 4, 0), dst[1], 0));
+    EXPECT_TRUE(isNear(Point3(2.5f, 3, 1), dst[2], 0));
+  });
+}
+
+} // namespace
+} // namespace stp
@@ -0,0 +1,250 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Geometry/Xform3.h"
+#include "Geometry/Xform3Kernels.h"
+
+#include "Base/Containers/List.h"
+#include "Base/Test/GTest.h"
+#include "Base/Test/PerfTest.h"
+#include "Base/Time/TimeTicks.h"
+#include "Base/Util/Random.h"
+#include "Base/Util/RandomUtil.h"
+
+namespace stp {
+
+namespace {
+
+constexpr int MatrixCount = 1024;
+constexpr int PointCount = 64 * 1024;
+constexpr int Iterations = 200;
+
+const char* getKernelSetName(Xform3KernelSet set) {
+  switch (set) {
+    case Xform3KernelSet::Scalar: return "scalar";
+    case Xform3KernelSet::Simd128: return "simd128";
+    case Xform3KernelSet::Avx: return "avx";
+  }
+  return nullptr;
+}
+
+class Xform3PerfTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    Random random;
+    auto next = [&random]() { return RandomUtil::NextUnitFloat(random) * 2 - 1; };
+    matrices_.appendUninitialized(MatrixCount * 16);
+    for (int i = 0; i < MatrixCount; ++i) {
+      float* m = &matrices_[i * 16];
+      for (int j = 0; j < 16; ++j)
+        m[j] = next() * 4;
+      // Keep half of matrices affine.
+      if (i & 1) {
+        m[3] = m[7] = m[11] = 0;
+        m[15] = 1;
+      }
+    }
+    points_.appendUninitialized(PointCount);
+    for (int i = 0; i < PointCount; ++i)
+      points_[i] = Point3(next() * 100, next() * 100, next() * 100);
+  }
+
+  template<typename TBody>
+  void runForEachSet(const char* operation, double operation_count, TBody body) {
+    for (auto set : { Xform3KernelSet::Scalar, Xform3KernelSet::Simd128, Xform3KernelSet::Avx }) {
+      const Xform3Kernels* kernels = Xform3KernelSelector::tryGet(set);
+      if (!kernels)
+        continue;
+      TimeTicks start = TimeTicks::Now();
+      body(*kernels);
+      perf_test::PrintThroughput(
+          operation, "", getKernelSetName(set), operation_count, TimeTicks::Now() - start,
+          "Mops/s", true);
+    }
+  }
+
+  // Matrices in |matrices_| wrapped in Xform3 to include type mask
+  // bookkeeping of the class.
+  List<Xform3> makeXforms() const {
+    List<Xform3> xforms;
+    for (int i = 0; i < MatrixCount; ++i) {
+      const float* m = &matrices_[i * 16];
+      xforms.add(Xform3(
+          m[0], m[4], m[8], m[12],
+          m[1], m[5], m[9], m[13],
+          m[2], m[6], m[10], m[14],
+          m[3], m[7], m[11], m[15]));
+    }
+    return xforms;
+  }
+
+  List<float> matrices_;
+  List<Point3> points_;
+};
+
+} // namespace
+
+TEST_F(Xform3PerfTest, Concat) {
+  float result[16];
+  float sink = 0;
+  runForEachSet("concat", static_cast<double>(Iterations) * MatrixCount,
+                [&](const Xform3Kernels& kernels) {
+    for (int n = 0; n < Iterations; ++n) {
+      for (int i = 0; i + 1 < MatrixCount; ++i) {
+        kernels.concat(result, &matrices_[i * 16], &matrices_[i * 16 + 16]);
+        sink += result[n & 15];
+      }
+    }
+  });
+  EXPECT_NE(0, sink);
+}
+
+TEST_F(Xform3PerfTest, Invert) {
+  float result[16];
+  int invertible = 0;
+  runForEachSet("invert", static_cast<double>(Iterations) * MatrixCount,
+                [&](const Xform3Kernels& kernels) {
+    for (int n = 0; n < Iterations; ++n) {
+      for (int i = 0; i < MatrixCount; ++i)
+        invertible += kernels.invert(result, &matrices_[i * 16]);
+    }
+  });
+  EXPECT_NE(0, invertible);
+}
+
+TEST_F(Xform3PerfTest, Determinant) {
+  double sum = 0;
+  runForEachSet("determinant", static_cast<double>(Iterations) * MatrixCount,
+                [&](const Xform3Kernels& kernels) {
+    for (int n = 0; n < Iterations; ++n) {
+      for (int i = 0; i < MatrixCount; ++i)
+        sum += kernels.getDeterminant(&matrices_[i * 16]);
+    }
+  });
+  EXPECT_NE(0, sum);
+}
+
+TEST_F(Xform3PerfTest, MapPoints) {
+  List<Point3> output;
+  Point3* output_data = output.appendUninitialized(PointCount);
+  // Both affine and perspective matrix.
+  for (int i = 0; i < 2; ++i) {
+    const float* m = &matrices_[i * 16];
+    runForEachSet(i ? "map_points_affine" : "map_points_perspective",
+                  static_cast<double>(Iterations) * PointCount / 10,
+                  [&](const Xform3Kernels& kernels) {
+      for (int n = 0; n < Iterations / 10; ++n)
+        kernels.mapPoints(output_data, points_.data(), PointCount, m);
+    });
+  }
+}
+
+TEST_F(Xform3PerfTest, XformConcat) {
+  List<Xform3> xforms = makeXforms();
+  Xform3 result = Xform3::Identity();
+  TimeTicks start = TimeTicks::Now();
+  for (int n = 0; n < Iterations; ++n) {
+    for (int i = 0; i + 1 < MatrixCount; ++i)
+      result.SetConcat(xforms[i], xforms[i + 1]);
+  }
+  perf_test::PrintThroughput(
+      "concat", "", "xform3", static_cast<double>(Iterations) * (MatrixCount - 1),
+      TimeTicks::Now() - start, "Mops/s", true);
+  EXPECT_FALSE(result.IsIdentity());
+}
+
+TEST_F(Xform3PerfTest, XformInvert) {
+  List<Xform3> xforms = makeXforms();
+  Xform3 result = Xform3::Identity();
+  int invertible = 0;
+  TimeTicks start = TimeTicks::Now();
+  for (int n = 0; n < Iterations; ++n) {
+    for (int i = 0; i < MatrixCount; ++i)
+      invertible += xforms[i].GetInverted(result);
+  }
+  perf_test::PrintThroughput(
+      "invert", "", "xform3", static_cast<double>(Iterations) * MatrixCount,
+      TimeTicks::Now() - start, "Mops/s", true);
+  EXPECT_NE(0, invertible);
+}
+
+TEST_F(Xform3PerfTest, XformMapPoints) {
+  List<Xform3> xforms = makeXforms();
+  List<Point3> output;
+  Point3* output_data = output.appendUninitialized(PointCount);
+  // Both perspective and affine matrix.
+  for (int i = 0; i < 2; ++i) {
+    TimeTicks start = TimeTicks::Now();
+    for (int n = 0; n < Iterations / 10; ++n)
+      xforms[i].MapPoints(output_data, points_.data(), PointCount);
+    perf_test::PrintThroughput(
+        i ? "map_points_affine" : "map_points_perspective", "", "xform3",
+        static_cast<double>(Iterations / 10) * PointCount, TimeTicks::Now() - start,
+        "Mops/s", true);
+  }
+}
+
+// Animation blending of many objects, each interpolated between its own pair
+// of keyframes.
+TEST(Xform3BlendPerfTest, Blend) {
+  constexpr int XformCount = 100000;
+  constexpr int BlendIterations = 10;
+
+  List<Xform3> from_xforms;
+  List<Xform3> to_xforms;
+  List<float> progress;
+  for (int i = 0; i < XformCount; ++i) {
+    Xform3 from = Xform3::Identity();
+    from.Translate(i % 100, i % 37, 0);
+    from.RotateAbout(Vector3(0, 0, 1), Angle::DegreesToRadians(i % 360));
+    Xform3 to = Xform3::Identity();
+    to.Translate(i % 23, 50, i % 7);
+    to.RotateAbout(Vector3(1, i % 3, 1), Angle::DegreesToRadians(i % 170));
+    to.Scale(1 + (i % 10) * 0.1f, 1, 2);
+    from_xforms.add(from);
+    to_xforms.add(to);
+    progress.add((i % 1000) * 0.001f);
+  }
+  List<Xform3> results;
+  results.appendUninitialized(XformCount);
+
+  auto report = [](const char* trace, TimeDelta time, int iterations) {
+    perf_test::PrintThroughput(
+        "blend", "", trace, static_cast<double>(XformCount) * iterations, time,
+        "Mxforms/s", true);
+  };
+
+  // Decomposes both transforms every time.
+  TimeTicks start = TimeTicks::Now();
+  for (int n = 0; n < BlendIterations; ++n) {
+    for (int i = 0; i < XformCount; ++i)
+      ASSERT_TRUE(Trylerp(results[i], from_xforms[i], to_xforms[i], progress[i]));
+  }
+  report("trylerp", TimeTicks::Now() - start, BlendIterations);
+
+  List<DecomposedXform3> from_decomps;
+  List<DecomposedXform3> to_decomps;
+  start = TimeTicks::Now();
+  for (int i = 0; i < XformCount; ++i) {
+    from_decomps.add(DecomposedXform3(DecomposedXform3::SkipInit));
+    to_decomps.add(DecomposedXform3(DecomposedXform3::SkipInit));
+    ASSERT_TRUE(from_xforms[i].decompose(from_decomps[i]));
+    ASSERT_TRUE(to_xforms[i].decompose(to_decomps[i]));
+  }
+  report("decompose", TimeTicks::Now() - start, 1);
+
+  // Cached decompositions, one object at a time.
+  start = TimeTicks::Now();
+  for (int n = 0; n < BlendIterations; ++n) {
+    for (int i = 0; i < XformCount; ++i)
+      results[i].Recompose(lerp(from_decomps[i], to_decomps[i], progress[i]));
+  }
+  report("cached_scalar", TimeTicks::Now() - start, BlendIterations);
+
+  start = TimeTicks::Now();
+  for (int n = 0; n < BlendIterations; ++n)
+    lerpEach(from_decomps, to_decomps, progress, results);
+  report("cached_batched", TimeTicks::Now() - start, BlendIterations);
+}
+
+} // namespace stp
@@ -5,6 +5,7 @@
 
 #include "Geometry/Xform3.h"
 
+#include "Base/Containers/List.h"
 #include "Base/Test/GTest.h"
 #include "Geometry/Quad2.h"
 
@@ -559,6 +560,59 @@ TEST(Xform3Test, CannotBlendSingularMatrix) {
   EXPECT_FALSE(Trylerp(res, from, to, 0.5));
 }
 
+TEST(Xform3Test, LerpEachMatchesTrylerp) {
+  // Count not divisible by batch size.
+  constexpr int Count = 21;
+  List<Xform3> from_xforms;
+  List<Xform3> to_xforms;
+  List<float> progress;
+  for (int i = 0; i < Count; ++i) {
+    Xform3 from = Xform3::Identity();
+    from.Translate(i, -2.f * i, 3);
+    from.RotateAbout(Vector3(1, i, 2), Angle::DegreesToRadians(10.0 * i));
+    from.Scale(1 + i * 0.1f, 2, 0.5f);
+
+    Xform3 to = Xform3::Identity();
+    if (i % 3 == 0)
+      to.ApplyPerspectiveDepth(500 + i);
+    to.RotateAbout(Vector3(0, 1, i), Angle::DegreesToRadians(-7.0 * i));
+    to.Skew(i, 5);
+
+    from_xforms.add(from);
+    to_xforms.add(to);
+    progress.add(i * 1.4f / (Count - 1) - 0.2f);
+  }
+
+  List<DecomposedXform3> from_decomps;
+  List<DecomposedXform3> to_decomps;
+  for (int i = 0; i < Count; ++i) {
+    from_decomps.add(DecomposedXform3(DecomposedXform3::SkipInit));
+    to_decomps.add(DecomposedXform3(DecomposedXform3::SkipInit));
+    ASSERT_TRUE(from_xforms[i].decompose(from_decomps[i]));
+    ASSERT_TRUE(to_xforms[i].decompose(to_decomps[i]));
+  }
+
+  List<Xform3> results;
+  results.appendUninitialized(Count);
+  lerpEach(from_decomps, to_decomps, progress, results);
+
+  // Interpolate in place, then recompose separately.
+  List<Xform3> recomposed;
+  recomposed.appendUninitialized(Count);
+  lerpEach(from_decomps, to_decomps, progress, from_decomps);
+  RecomposeEach(from_decomps, recomposed);
+
+  for (int i = 0; i < Count; ++i) {
+    Xform3 expected(Xform3::SkipInit);
+    ASSERT_TRUE(Trylerp(expected, from_xforms[i], to_xforms[i], progress[i]));
+    EXPECT_TRUE(MatricesAreNearlyEqual(expected, results[i]));
+    EXPECT_EQ(results[i], recomposed[i]);
+
+    expected.Recompose(from_decomps[i]);
+    EXPECT_TRUE(MatricesAreNearlyEqual(expected, recomposed[i]));
+  }
+}
+
 TEST(Xform3Test, VerifyBlendForTranslation) {
   Xform3 from = Xform3::Identity();
   from.Translate(100.0, 200.0, 100.0);
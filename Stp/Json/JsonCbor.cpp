@@ -0,0 +1,545 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Json/JsonCbor.h"
+
+#include "Base/Io/BinaryReader.h"
+#include "Base/Io/BinaryWriter.h"
+#include "Base/Io/IoException.h"
+#include "Base/Math/Half.h"
+#include "Base/Math/Math.h"
+#include "Base/Text/Utf.h"
+
+namespace stp {
+
+// Major type is stored in high 3 bits of initial byte.
+static constexpr uint8_t MajorTypeMask = 0xE0;
+static constexpr uint8_t UnsignedIntegerType = 0 << 5;
+static constexpr uint8_t NegativeIntegerType = 1 << 5;
+static constexpr uint8_t ByteStringType = 2 << 5;
+static constexpr uint8_t TextStringType = 3 << 5;
+static constexpr uint8_t ArrayType = 4 << 5;
+static constexpr uint8_t MapType = 5 << 5;
+static constexpr uint8_t TagType = 6 << 5;
+static constexpr uint8_t SimpleType = 7 << 5;
+
+// Additional information is stored in low 5 bits.
+static constexpr uint8_t AdditionalInfoMask = 0x1F;
+static constexpr uint8_t OneByteArgument = 24;
+static constexpr uint8_t EightByteArgument = 27;
+static constexpr uint8_t IndefiniteLength = 31;
+
+static constexpr uint8_t FalseValue = SimpleType | 20;
+static constexpr uint8_t TrueValue = SimpleType | 21;
+static constexpr uint8_t NullValue = SimpleType | 22;
+static constexpr uint8_t UndefinedValue = SimpleType | 23;
+static constexpr uint8_t HalfValue = SimpleType | 25;
+static constexpr uint8_t FloatValue = SimpleType | 26;
+static constexpr uint8_t DoubleValue = SimpleType | 27;
+static constexpr uint8_t Break = SimpleType | IndefiniteLength;
+
+// Items of definite length arrays and objects read from a stream are
+// reserved up to this count. Corrupted input cannot make the parser allocate
+// a lot of memory before the data actually arrives.
+static constexpr int MaxStreamReserve = 1024;
+static constexpr int StreamTextChunkSize = 64 << 10;
+
+static void StoreBigEndian(byte_t* out, uint64_t x, int size) {
+  for (int i = size - 1; i >= 0; --i) {
+    out[i] = static_cast<byte_t>(x);
+    x >>= 8;
+  }
+}
+
+static uint64_t LoadBigEndian(const byte_t* data, int size) {
+  uint64_t x = 0;
+  for (int i = 0; i < size; ++i)
+    x = (x << 8) | data[i];
+  return x;
+}
+
+static bool IsValidUtf8(const char* it, const char* end) {
+  while (it < end) {
+    if (unicode::IsDecodeError(Utf8::TryDecode(it, end)))
+      return false;
+  }
+  return true;
+}
+
+bool JsonCborFormatter::Write(const JsonValue& root) {
+  error_ = JsonError();
+  return WriteValue(root) && error_.code == JsonError::Ok;
+}
+
+bool JsonCborFormatter::WriteValue(const JsonValue& node) {
+  switch (node.type()) {
+    case JsonValue::Type::Null:
+      out_.writeUInt8(NullValue);
+      return true;
+
+    case JsonValue::Type::Boolean:
+      out_.writeUInt8(node.AsBool() ? TrueValue : FalseValue);
+      return true;
+
+    case JsonValue::Type::Integer: {
+      int64_t x = node.AsInteger();
+      if (x >= 0)
+        WriteHead(UnsignedIntegerType, static_cast<uint64_t>(x));
+      else
+        WriteHead(NegativeIntegerType, ~static_cast<uint64_t>(x));
+      return true;
+    }
+
+    case JsonValue::Type::Double:
+      return WriteDouble(node.AsDouble());
+
+    case JsonValue::Type::String:
+      WriteString(node.AsString());
+      return true;
+
+    case JsonValue::Type::Array: {
+      const JsonArray& array = node.AsArray();
+      WriteHead(ArrayType, static_cast<uint64_t>(array.size()));
+      for (const auto& item : array) {
+        if (!WriteValue(item))
+          return false;
+      }
+      return true;
+    }
+
+    case JsonValue::Type::Object: {
+      const JsonObject& object = node.AsObject();
+      WriteHead(MapType, static_cast<uint64_t>(object.size()));
+      for (const auto& iter : object) {
+        WriteString(iter.key);
+        if (!WriteValue(iter.value))
+          return false;
+      }
+      return true;
+    }
+  }
+  UNREACHABLE(return false);
+}
+
+void JsonCborFormatter::WriteHead(uint8_t major_type, uint64_t argument) {
+  if (argument < OneByteArgument) {
+    out_.writeUInt8(static_cast<uint8_t>(major_type | argument));
+    return;
+  }
+  int size;
+  uint8_t info;
+  if (argument <= 0xFF) {
+    size = 1;
+    info = OneByteArgument;
+  } else if (argument <= 0xFFFF) {
+    size = 2;
+    info = OneByteArgument + 1;
+  } else if (argument <= 0xFFFFFFFF) {
+    size = 4;
+    info = OneByteArgument + 2;
+  } else {
+    size = 8;
+    info = EightByteArgument;
+  }
+  byte_t bytes[9];
+  bytes[0] = major_type | info;
+  StoreBigEndian(bytes + 1, argument, size);
+  out_.writeBytes(BufferSpan(bytes, size + 1));
+}
+
+bool JsonCborFormatter::WriteDouble(double x) {
+  if (!isFinite(x) && !options_.Has(JsonOptions::EnableInfNaN)) {
+    if (RaiseError(JsonError::InvalidNumber))
+      return false;
+    x = 0;
+  }
+
+  byte_t bytes[9];
+  int size;
+  if (isNaN(x)) {
+    // Canonical NaN, payload is not preserved.
+    bytes[0] = HalfValue;
+    size = 2;
+    StoreBigEndian(bytes + 1, 0x7E00, size);
+  } else if (mathAbs(x) <= Limits<float>::Max && static_cast<float>(x) == x) {
+    float f = static_cast<float>(x);
+    Half h(f);
+    if (static_cast<float>(h) == f) {
+      bytes[0] = HalfValue;
+      size = 2;
+      StoreBigEndian(bytes + 1, h.toBits(), size);
+    } else {
+      bytes[0] = FloatValue;
+      size = 4;
+      StoreBigEndian(bytes + 1, bitCast<uint32_t>(f), size);
+    }
+  } else if (isInfinity(x)) {
+    bytes[0] = HalfValue;
+    size = 2;
+    StoreBigEndian(bytes + 1, x > 0 ? 0x7C00 : 0xFC00, size);
+  } else {
+    bytes[0] = DoubleValue;
+    size = 8;
+    StoreBigEndian(bytes + 1, bitCast<uint64_t>(x), size);
+  }
+  out_.writeBytes(BufferSpan(bytes, size + 1));
+  return true;
+}
+
+void JsonCborFormatter::WriteString(StringSpan str) {
+  WriteHead(TextStringType, static_cast<uint64_t>(str.length()));
+  out_.writeBytes(BufferSpan(str.data(), str.length()));
+}
+
+bool JsonCborFormatter::RaiseError(JsonError::Code code) {
+  if (error_.code == JsonError::Ok)
+    error_ = JsonError(code);
+  return options_.Has(JsonOptions::BreakOnError);
+}
+
+bool JsonCborParser::Parse(BufferSpan input, JsonValue& output) {
+  pos_ = static_cast<const byte_t*>(input.data());
+  end_ = pos_ + input.size();
+  reader_ = nullptr;
+  error_ = JsonError();
+
+  JsonValue root;
+  if (!ParseItem(root, 0))
+    return false;
+  if (pos_ != end_)
+    return ReportError(JsonError::UnexpectedDataAfterRoot);
+  output = move(root);
+  return true;
+}
+
+bool JsonCborParser::Parse(BinaryReader& input, JsonValue& output) {
+  pos_ = nullptr;
+  end_ = nullptr;
+  reader_ = &input;
+  error_ = JsonError();
+
+  JsonValue root;
+  bool ok;
+  try {
+    ok = ParseItem(root, 0);
+  } catch (EndOfStreamException&) {
+    ok = ReportError(JsonError::UnexpectedEndOfInput);
+  }
+  reader_ = nullptr;
+  if (!ok)
+    return false;
+  output = move(root);
+  return true;
+}
+
+inline bool JsonCborParser::ReadUInt8(uint8_t& out) {
+  if (reader_) {
+    out = reader_->readUInt8();
+    return true;
+  }
+  if (UNLIKELY(pos_ == end_))
+    return ReportError(JsonError::UnexpectedEndOfInput);
+  out = *pos_++;
+  return true;
+}
+
+bool JsonCborParser::ReadSmall(int size, const byte_t*& out) {
+  ASSERT(size <= isizeof(scratch_));
+  if (reader_) {
+    reader_->readBytes(MutableBufferSpan(scratch_, size));
+    out = scratch_;
+    return true;
+  }
+  if (UNLIKELY(end_ - pos_ < size))
+    return ReportError(JsonError::UnexpectedEndOfInput);
+  out = pos_;
+  pos_ += size;
+  return true;
+}
+
+bool JsonCborParser::ReadArgument(uint8_t initial, uint64_t& out) {
+  uint8_t info = initial & AdditionalInfoMask;
+  if (info < OneByteArgument) {
+    out = info;
+    return true;
+  }
+  // Reserved values or indefinite length where not allowed.
+  if (info > EightByteArgument)
+    return ReportError(JsonError::SyntaxError);
+
+  int size = 1 << (info - OneByteArgument);
+  const byte_t* data;
+  if (!ReadSmall(size, data))
+    return false;
+  out = LoadBigEndian(data, size);
+  return true;
+}
+
+bool JsonCborParser::ReadLength(uint8_t initial, int& out) {
+  uint64_t length;
+  if (!ReadArgument(initial, length))
+    return false;
+  if (length > static_cast<uint64_t>(Limits<int>::Max))
+    return ReportError(JsonError::UnsupportedDataItem);
+  out = static_cast<int>(length);
+  return true;
+}
+
+bool JsonCborParser::ReadText(int length, JsonStringBuilder& out) {
+  if (!reader_) {
+    if (UNLIKELY(end_ - pos_ < length))
+      return ReportError(JsonError::UnexpectedEndOfInput);
+    const char* text = reinterpret_cast<const char*>(pos_);
+    if (!IsValidUtf8(text, text + length))
+      return ReportError(JsonError::UnsupportedEncoding);
+    if (out.OwnsData())
+      out.appendString(StringSpan(text, length));
+    else
+      out.appendInPlace(text, length);
+    pos_ += length;
+    return true;
+  }
+
+  // Grow the string as the data arrives.
+  ASSERT(out.OwnsData());
+  int start = out.size();
+  for (int remaining = length; remaining > 0;) {
+    int chunk_size = min(remaining, StreamTextChunkSize);
+    char* dst = out.appendUninitialized(chunk_size);
+    reader_->readBytes(MutableBufferSpan(dst, chunk_size));
+    remaining -= chunk_size;
+  }
+  if (!IsValidUtf8(out.data() + start, out.data() + out.size()))
+    return ReportError(JsonError::UnsupportedEncoding);
+  return true;
+}
+
+bool JsonCborParser::ParseItem(JsonValue& out, int depth) {
+  uint8_t initial;
+  if (!ReadUInt8(initial))
+    return false;
+  return ParseItem(initial, out, depth);
+}
+
+bool JsonCborParser::ParseItem(uint8_t initial, JsonValue& out, int depth) {
+  switch (initial & MajorTypeMask) {
+    case UnsignedIntegerType: {
+      uint64_t x;
+      if (!ReadArgument(initial, x))
+        return false;
+      out = JsonValue(static_cast<unsigned long long>(x));
+      return true;
+    }
+    case NegativeIntegerType: {
+      uint64_t x;
+      if (!ReadArgument(initial, x))
+        return false;
+      if (x <= static_cast<uint64_t>(Limits<int64_t>::Max))
+        out = JsonValue(-1 - static_cast<int64_t>(x));
+      else
+        out = JsonValue(-1.0 - static_cast<double>(x));
+      return true;
+    }
+    case ByteStringType:
+      return ReportError(JsonError::UnsupportedDataItem);
+
+    case TextStringType: {
+      JsonStringBuilder string;
+      if (!ParseString(initial, options_.Has(JsonOptions::ReferenceInput), string))
+        return false;
+      out = move(string);
+      return true;
+    }
+    case ArrayType:
+      return ParseArray(initial, out, depth);
+
+    case MapType:
+      return ParseObject(initial, out, depth);
+
+    case TagType: {
+      uint64_t tag;
+      if (!ReadArgument(initial, tag))
+        return false;
+      // Tags can be nested.
+      if (depth >= options_.GetDepthLimit())
+        return ReportError(JsonError::TooMuchNesting);
+      return ParseItem(out, depth + 1);
+    }
+    case SimpleType:
+      return ParseSimple(initial, out);
+  }
+  UNREACHABLE(return false);
+}
+
+bool JsonCborParser::ParseString(uint8_t initial, bool reference, JsonStringBuilder& out) {
+  JsonStringBuilder string;
+  if ((initial & AdditionalInfoMask) != IndefiniteLength) {
+    int length;
+    if (!ReadLength(initial, length))
+      return false;
+    if (reference && !reader_)
+      string = JsonStringBuilder(reinterpret_cast<const char*>(pos_));
+    else
+      string.Convert();
+    if (!ReadText(length, string))
+      return false;
+    swap(out, string);
+    return true;
+  }
+
+  // Indefinite length string is a sequence of definite length chunks.
+  string.Convert();
+  while (true) {
+    uint8_t chunk_initial;
+    if (!ReadUInt8(chunk_initial))
+      return false;
+    if (chunk_initial == Break)
+      break;
+    if ((chunk_initial & MajorTypeMask) != TextStringType ||
+        (chunk_initial & AdditionalInfoMask) == IndefiniteLength)
+      return ReportError(JsonError::SyntaxError);
+
+    int length;
+    if (!ReadLength(chunk_initial, length))
+      return false;
+    if (!ReadText(length, string))
+      return false;
+  }
+  swap(out, string);
+  return true;
+}
+
+bool JsonCborParser::ParseArray(uint8_t initial, JsonValue& out, int depth) {
+  if (depth >= options_.GetDepthLimit())
+    return ReportError(JsonError::TooMuchNesting);
+
+  JsonArray array;
+  if ((initial & AdditionalInfoMask) == IndefiniteLength) {
+    while (true) {
+      uint8_t item_initial;
+      if (!ReadUInt8(item_initial))
+        return false;
+      if (item_initial == Break)
+        break;
+      JsonValue item;
+      if (!ParseItem(item_initial, item, depth + 1))
+        return false;
+      array.add(move(item));
+    }
+  } else {
+    int count;
+    if (!ReadLength(initial, count))
+      return false;
+    // Each item takes at least one byte.
+    if (!reader_ && count > end_ - pos_)
+      return ReportError(JsonError::UnexpectedEndOfInput);
+    array.willGrow(reader_ ? min(count, MaxStreamReserve) : count);
+
+    for (int i = 0; i < count; ++i) {
+      JsonValue item;
+      if (!ParseItem(item, depth + 1))
+        return false;
+      array.add(move(item));
+    }
+  }
+  out = move(array);
+  return true;
+}
+
+bool JsonCborParser::ParseObject(uint8_t initial, JsonValue& out, int depth) {
+  if (depth >= options_.GetDepthLimit())
+    return ReportError(JsonError::TooMuchNesting);
+
+  bool indefinite = (initial & AdditionalInfoMask) == IndefiniteLength;
+  int count = 0;
+  if (!indefinite) {
+    if (!ReadLength(initial, count))
+      return false;
+    // Each pair takes at least two bytes.
+    if (!reader_ && count > (end_ - pos_) / 2)
+      return ReportError(JsonError::UnexpectedEndOfInput);
+  }
+
+  JsonObject object;
+  object.willGrow(reader_ ? min(count, MaxStreamReserve) : count);
+
+  for (int i = 0; indefinite || i < count; ++i) {
+    uint8_t key_initial;
+    if (!ReadUInt8(key_initial))
+      return false;
+    if (indefinite && key_initial == Break)
+      break;
+    if ((key_initial & MajorTypeMask) != TextStringType)
+      return ReportError(JsonError::UnsupportedDataItem);
+
+    // Key is copied into the object, no need to own it here.
+    JsonStringBuilder key;
+    if (!ParseString(key_initial, true, key))
+      return false;
+
+    JsonValue value;
+    if (!ParseItem(value, depth + 1))
+      return false;
+
+    if (options_.Has(JsonOptions::UniqueKeys)) {
+      if (!object.tryAdd(key.toSpan(), move(value)))
+        return ReportError(JsonError::KeyAlreadyAssigned);
+    } else {
+      object.Set(key.toSpan(), move(value));
+    }
+  }
+  out = move(object);
+  return true;
+}
+
+bool JsonCborParser::ParseSimple(uint8_t initial, JsonValue& out) {
+  const byte_t* data;
+  switch (initial) {
+    case FalseValue:
+      out = JsonValue(false);
+      return true;
+
+    case TrueValue:
+      out = JsonValue(true);
+      return true;
+
+    case NullValue:
+    case UndefinedValue:
+      out = JsonValue();
+      return true;
+
+    case HalfValue:
+      if (!ReadSmall(2, data))
+        return false;
+      return ParseDouble(static_cast<float>(Half::fromBits(static_cast<uint16_t>(LoadBigEndian(data, 2)))), out);
+
+    case FloatValue:
+      if (!ReadSmall(4, data))
+        return false;
+      return ParseDouble(bitCast<float>(static_cast<uint32_t>(LoadBigEndian(data, 4))), out);
+
+    case DoubleValue:
+      if (!ReadSmall(8, data))
+        return false;
+      return ParseDouble(bitCast<double>(LoadBigEndian(data, 8)), out);
+
+    case Break:
+      // Break outside of indefinite length item.
+      return ReportError(JsonError::SyntaxError);
+  }
+  return ReportError(JsonError::UnsupportedDataItem);
+}
+
+bool JsonCborParser::ParseDouble(double x, JsonValue& out) {
+  if (!isFinite(x) && !options_.Has(JsonOptions::EnableInfNaN))
+    return ReportError(JsonError::InvalidNumber);
+  out = JsonValue(x);
+  return true;
+}
+
+bool JsonCborParser::ReportError(JsonError::Code code) {
+  error_ = JsonError(code);
+  return false;
+}
+
+} // namespace stp
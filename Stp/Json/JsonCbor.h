@@ -0,0 +1,119 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#ifndef STP_BASE_JSON_JSONCBOR_H_
+#define STP_BASE_JSON_JSONCBOR_H_
+
+#include "Base/Containers/BufferSpan.h"
+#include "Json/JsonArray.h"
+#include "Json/JsonError.h"
+#include "Json/JsonObject.h"
+
+namespace stp {
+
+class BinaryReader;
+class BinaryWriter;
+
+// Writes JSON values in CBOR (RFC 8949) binary format.
+//
+// Uses preferred serialization: shortest form of integer arguments and
+// the shortest floating-point type representing given double exactly.
+// Arrays, objects and strings are written with definite length.
+// Strings are assumed to be valid UTF-8.
+class BASE_EXPORT JsonCborFormatter {
+ public:
+  explicit JsonCborFormatter(BinaryWriter& out) : out_(out) {}
+
+  // The output is buffered by BinaryWriter, flush it when done.
+  bool Write(const JsonValue& root);
+
+  void SetOptions(const JsonOptions& options) { options_ = options; }
+
+  ALWAYS_INLINE const JsonError& GetError() const { return error_; }
+
+ private:
+  // Unlike Write(root) this one returns false when formatting was stopped
+  // (not when an error occurred).
+  bool WriteValue(const JsonValue& node);
+
+  void WriteHead(uint8_t major_type, uint64_t argument);
+  bool WriteDouble(double x);
+  void WriteString(StringSpan str);
+
+  // Returns true if formatting should be stopped.
+  bool RaiseError(JsonError::Code code);
+
+  BinaryWriter& out_;
+
+  JsonOptions options_;
+
+  JsonError error_;
+
+  DISALLOW_COPY_AND_ASSIGN(JsonCborFormatter);
+};
+
+// Reads JSON values from CBOR (RFC 8949) binary format.
+//
+// Accepts both definite and indefinite length items. Tags are skipped
+// (content of tagged item is decoded as if not tagged). Byte strings,
+// non-string object keys and simple values other than false, true, null
+// and undefined (decoded as null) are rejected since they have no JSON
+// equivalent.
+//
+// Integers out of int64_t range are decoded as doubles, same as with
+// JsonParser.
+class BASE_EXPORT JsonCborParser {
+ public:
+  JsonCborParser() {}
+
+  // Parses a single data item spanning whole |input|.
+  // With JsonOptions::ReferenceInput string values reference |input| instead
+  // of owning a copy, so |input| must outlive |output|.
+  bool Parse(BufferSpan input, JsonValue& output);
+
+  // Parses next data item from |input|.
+  // Call repeatedly to read a CBOR sequence (RFC 8742).
+  bool Parse(BinaryReader& input, JsonValue& output);
+
+  void SetOptions(const JsonOptions& options) { options_ = options; }
+
+  ALWAYS_INLINE const JsonError& GetError() const { return error_; }
+
+ private:
+  bool ReadUInt8(uint8_t& out);
+  // Returns a pointer to next |size| bytes of input, |size| up to 8.
+  bool ReadSmall(int size, const byte_t*& out);
+  bool ReadArgument(uint8_t initial, uint64_t& out);
+  bool ReadLength(uint8_t initial, int& out);
+  // Appends a string chunk of given |length| to |out|.
+  bool ReadText(int length, JsonStringBuilder& out);
+
+  bool ParseItem(JsonValue& out, int depth);
+  bool ParseItem(uint8_t initial, JsonValue& out, int depth);
+  // If |reference| is true the string may point to the input.
+  bool ParseString(uint8_t initial, bool reference, JsonStringBuilder& out);
+  bool ParseArray(uint8_t initial, JsonValue& out, int depth);
+  bool ParseObject(uint8_t initial, JsonValue& out, int depth);
+  bool ParseSimple(uint8_t initial, JsonValue& out);
+  bool ParseDouble(double x, JsonValue& out);
+
+  bool ReportError(JsonError::Code code);
+
+  // Set when parsing from memory.
+  const byte_t* pos_ = nullptr;
+  const byte_t* end_ = nullptr;
+
+  // Set when parsing from a stream.
+  BinaryReader* reader_ = nullptr;
+  byte_t scratch_[8];
+
+  JsonOptions options_;
+
+  JsonError error_;
+
+  DISALLOW_COPY_AND_ASSIGN(JsonCborParser);
+};
+
+} // namespace stp
+
+#endif // STP_BASE_JSON_JSONCBOR_H_
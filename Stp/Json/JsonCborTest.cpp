@@ -0,0 +1,361 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Json/JsonCbor.h"
+
+#include "Base/Io/BinaryReader.h"
+#include "Base/Io/BinaryWriter.h"
+#include "Base/Io/MemoryStream.h"
+#include "Base/Test/GTest.h"
+#include "Base/Type/Limits.h"
+
+namespace stp {
+
+namespace {
+
+class JsonCborTest : public testing::Test {
+ protected:
+  static JsonOptions withInfNaN() {
+    JsonOptions options;
+    options.add(JsonOptions::EnableInfNaN);
+    return options;
+  }
+
+  static List<byte_t> fromHex(StringSpan hex) {
+    auto digit = [](char c) { return c <= '9' ? c - '0' : c - 'a' + 10; };
+    List<byte_t> bytes;
+    for (int i = 0; i + 1 < hex.length(); i += 2)
+      bytes.add(static_cast<byte_t>(digit(hex[i]) << 4 | digit(hex[i + 1])));
+    return bytes;
+  }
+
+  static List<byte_t> encode(const JsonValue& value) {
+    MemoryStream stream;
+    stream.openNewBytes();
+    BinaryWriter writer(&stream);
+    JsonCborFormatter formatter(writer);
+    formatter.SetOptions(withInfNaN());
+    EXPECT_TRUE(formatter.Write(value));
+    writer.flush();
+
+    int size = static_cast<int>(stream.getLength());
+    List<byte_t> output;
+    stream.positionalRead(0, MutableBufferSpan(output.appendUninitialized(size), size));
+    return output;
+  }
+
+  void expectEncoded(StringSpan hex, const JsonValue& value) {
+    EXPECT_EQ(fromHex(hex), encode(value)) << "for " << hex;
+  }
+
+  bool decode(StringSpan hex, JsonValue& output, JsonOptions options = withInfNaN()) {
+    bytes_ = fromHex(hex);
+    parser_.SetOptions(options);
+    return parser_.Parse(BufferSpan(bytes_.data(), bytes_.size()), output);
+  }
+
+  void expectDecoded(const JsonValue& expected, StringSpan hex) {
+    JsonValue value;
+    ASSERT_TRUE(decode(hex, value)) << "for " << hex;
+    EXPECT_EQ(expected, value) << "for " << hex;
+  }
+
+  JsonError::Code decodeError(StringSpan hex, JsonOptions options = JsonOptions()) {
+    JsonValue value;
+    EXPECT_FALSE(decode(hex, value, options)) << "for " << hex;
+    return parser_.GetError().code;
+  }
+
+  JsonCborParser parser_;
+  List<byte_t> bytes_;
+};
+
+} // namespace
+
+// Examples are from Appendix A of RFC 8949.
+TEST_F(JsonCborTest, Integers) {
+  const struct {
+    int64_t value;
+    StringSpan hex;
+  } Examples[] = {
+    { 0, "00" },
+    { 1, "01" },
+    { 10, "0a" },
+    { 23, "17" },
+    { 24, "1818" },
+    { 25, "1819" },
+    { 100, "1864" },
+    { 1000, "1903e8" },
+    { 1000000, "1a000f4240" },
+    { INT64_C(1000000000000), "1b000000e8d4a51000" },
+    { -1, "20" },
+    { -10, "29" },
+    { -100, "3863" },
+    { -1000, "3903e7" },
+    { Limits<int64_t>::Max, "1b7fffffffffffffff" },
+    { Limits<int64_t>::Min, "3b7fffffffffffffff" },
+  };
+  for (const auto& example : Examples) {
+    expectEncoded(example.hex, JsonValue(example.value));
+    expectDecoded(JsonValue(example.value), example.hex);
+  }
+
+  // Out of int64_t range.
+  expectDecoded(JsonValue(18446744073709551615.0), "1bffffffffffffffff");
+  expectDecoded(JsonValue(-18446744073709551616.0), "3bffffffffffffffff");
+}
+
+TEST_F(JsonCborTest, Doubles) {
+  const struct {
+    double value;
+    StringSpan hex;
+  } Examples[] = {
+    { 0.0, "f90000" },
+    { -0.0, "f98000" },
+    { 1.0, "f93c00" },
+    { 1.1, "fb3ff199999999999a" },
+    { 1.5, "f93e00" },
+    { 65504.0, "f97bff" },
+    { 100000.0, "fa47c35000" },
+    { 3.4028234663852886e+38, "fa7f7fffff" },
+    { 1.0e+300, "fb7e37e43c8800759c" },
+    { 5.960464477539063e-8, "f90001" },
+    { 0.00006103515625, "f90400" },
+    { -4.0, "f9c400" },
+    { -4.1, "fbc010666666666666" },
+    { Limits<double>::Infinity, "f97c00" },
+    { -Limits<double>::Infinity, "f9fc00" },
+  };
+  for (const auto& example : Examples) {
+    expectEncoded(example.hex, JsonValue(example.value));
+    expectDecoded(JsonValue(example.value), example.hex);
+  }
+
+  expectEncoded("f97e00", JsonValue(Limits<double>::NaN));
+  JsonValue nan;
+  ASSERT_TRUE(decode("fa7fc00000", nan));
+  EXPECT_TRUE(isNaN(nan.AsDouble()));
+
+  // Wider than needed is accepted.
+  expectDecoded(JsonValue(1.0), "fb3ff0000000000000");
+}
+
+TEST_F(JsonCborTest, Simple) {
+  expectEncoded("f4", JsonValue(false));
+  expectEncoded("f5", JsonValue(true));
+  expectEncoded("f6", JsonValue());
+
+  expectDecoded(JsonValue(false), "f4");
+  expectDecoded(JsonValue(true), "f5");
+  expectDecoded(JsonValue(), "f6");
+  // Undefined.
+  expectDecoded(JsonValue(), "f7");
+}
+
+TEST_F(JsonCborTest, Strings) {
+  const struct {
+    StringSpan value;
+    StringSpan hex;
+  } Examples[] = {
+    { "", "60" },
+    { "a", "6161" },
+    { "IETF", "6449455446" },
+    { "\"\\", "62225c" },
+    { "\xC3\xBC", "62c3bc" },
+    { "\xE6\xB0\xB4", "63e6b0b4" },
+    { "\xF0\x90\x85\x91", "64f0908591" },
+  };
+  for (const auto& example : Examples) {
+    expectEncoded(example.hex, JsonValue(example.value));
+    expectDecoded(JsonValue(example.value), example.hex);
+  }
+
+  // Indefinite length.
+  expectDecoded(JsonValue("streaming"), "7f657374726561646d696e67ff");
+  expectDecoded(JsonValue(""), "7fff");
+}
+
+TEST_F(JsonCborTest, Arrays) {
+  JsonArray empty;
+  expectEncoded("80", empty);
+  expectDecoded(empty, "80");
+  expectDecoded(empty, "9fff");
+
+  JsonArray flat;
+  flat.add(1);
+  flat.add(2);
+  flat.add(3);
+  expectEncoded("83010203", flat);
+  expectDecoded(flat, "83010203");
+
+  JsonArray nested;
+  nested.add(1);
+  JsonArray inner1;
+  inner1.add(2);
+  inner1.add(3);
+  nested.add(move(inner1));
+  JsonArray inner2;
+  inner2.add(4);
+  inner2.add(5);
+  nested.add(move(inner2));
+  expectEncoded("8301820203820405", nested);
+  expectDecoded(nested, "8301820203820405");
+  expectDecoded(nested, "9f018202039f0405ffff");
+  expectDecoded(nested, "9f01820203820405ff");
+  expectDecoded(nested, "83018202039f0405ff");
+
+  JsonArray long_array;
+  for (int i = 1; i <= 25; ++i)
+    long_array.add(i);
+  expectEncoded("98190102030405060708090a0b0c0d0e0f101112131415161718181819", long_array);
+  expectDecoded(long_array, "98190102030405060708090a0b0c0d0e0f101112131415161718181819");
+}
+
+TEST_F(JsonCborTest, Objects) {
+  JsonObject empty;
+  expectEncoded("a0", empty);
+  expectDecoded(empty, "a0");
+
+  JsonObject object;
+  object.Set("a", 1);
+  JsonArray array;
+  array.add(2);
+  array.add(3);
+  object.Set("b", move(array));
+  expectEncoded("a26161016162820203", object);
+  expectDecoded(object, "a26161016162820203");
+  expectDecoded(object, "bf61610161629f0203ffff");
+}
+
+TEST_F(JsonCborTest, Tags) {
+  // Standard date/time string.
+  expectDecoded(JsonValue("2013-03-21T20:04:00Z"), "c074323031332d30332d32315432303a30343a30305a");
+  // Epoch-based date/time.
+  expectDecoded(JsonValue(1363896240), "c11a514b67b0");
+}
+
+TEST_F(JsonCborTest, ReferenceInput) {
+  JsonOptions options;
+  options.add(JsonOptions::ReferenceInput);
+
+  JsonValue value;
+  ASSERT_TRUE(decode("82616163636465", value, options));
+  const char* begin = reinterpret_cast<const char*>(bytes_.data());
+  const char* end = begin + bytes_.size();
+  StringSpan first = value.AsArray()[0].AsString();
+  StringSpan second = value.AsArray()[1].AsString();
+  EXPECT_EQ("a", first);
+  EXPECT_EQ("cde", second);
+  EXPECT_TRUE(first.data() >= begin && first.data() < end);
+  EXPECT_TRUE(second.data() >= begin && second.data() < end);
+
+  // Copied by default.
+  ASSERT_TRUE(decode("82616163636465", value, JsonOptions()));
+  first = value.AsArray()[0].AsString();
+  EXPECT_FALSE(first.data() >= begin && first.data() < end);
+}
+
+TEST_F(JsonCborTest, Stream) {
+  JsonObject object;
+  object.Set("name", "stream");
+  object.Set("size", 1 << 20);
+  object.Set("ratio", 0.1);
+  // Longer than reader's buffer.
+  List<char> long_string;
+  char* long_string_data = long_string.appendUninitialized(100000);
+  for (int i = 0; i < long_string.size(); ++i)
+    long_string_data[i] = static_cast<char>('a' + i % 26);
+  object.Set("data", StringSpan(long_string.data(), long_string.size()));
+
+  MemoryStream stream;
+  stream.openNewBytes();
+  BinaryWriter writer(&stream);
+  JsonCborFormatter formatter(writer);
+  // CBOR sequence.
+  ASSERT_TRUE(formatter.Write(object));
+  ASSERT_TRUE(formatter.Write(JsonValue(42)));
+  writer.flush();
+
+  stream.setPosition(0);
+  BinaryReader reader(&stream);
+  JsonCborParser parser;
+  JsonValue value;
+  ASSERT_TRUE(parser.Parse(reader, value));
+  EXPECT_EQ(object, value);
+  ASSERT_TRUE(parser.Parse(reader, value));
+  EXPECT_EQ(JsonValue(42), value);
+  EXPECT_TRUE(reader.isAtEnd());
+
+  EXPECT_FALSE(parser.Parse(reader, value));
+  EXPECT_EQ(JsonError::UnexpectedEndOfInput, parser.GetError().code);
+}
+
+TEST_F(JsonCborTest, Errors) {
+  // Truncated.
+  EXPECT_EQ(JsonError::UnexpectedEndOfInput, decodeError(""));
+  EXPECT_EQ(JsonError::UnexpectedEndOfInput, decodeError("19"));
+  EXPECT_EQ(JsonError::UnexpectedEndOfInput, decodeError("6461"));
+  EXPECT_EQ(JsonError::UnexpectedEndOfInput, decodeError("830102"));
+  EXPECT_EQ(JsonError::UnexpectedEndOfInput, decodeError("9f01"));
+  EXPECT_EQ(JsonError::UnexpectedEndOfInput, decodeError("9a7fffffff"));
+
+  EXPECT_EQ(JsonError::UnexpectedDataAfterRoot, decodeError("0102"));
+
+  // Reserved additional information.
+  EXPECT_EQ(JsonError::SyntaxError, decodeError("1c"));
+  // Indefinite length integer.
+  EXPECT_EQ(JsonError::SyntaxError, decodeError("1f"));
+  // Break outside of indefinite length item.
+  EXPECT_EQ(JsonError::SyntaxError, decodeError("ff"));
+  EXPECT_EQ(JsonError::SyntaxError, decodeError("81ff"));
+  // Nested indefinite length string chunk.
+  EXPECT_EQ(JsonError::SyntaxError, decodeError("7f7f6161ffff"));
+
+  EXPECT_EQ(JsonError::UnsupportedEncoding, decodeError("62c328"));
+  EXPECT_EQ(JsonError::UnsupportedEncoding, decodeError("61ff"));
+
+  // Byte string.
+  EXPECT_EQ(JsonError::UnsupportedDataItem, decodeError("4401020304"));
+  // Non-string key.
+  EXPECT_EQ(JsonError::UnsupportedDataItem, decodeError("a10102"));
+  // Unassigned simple value.
+  EXPECT_EQ(JsonError::UnsupportedDataItem, decodeError("f0"));
+
+  EXPECT_EQ(JsonError::InvalidNumber, decodeError("f97c00"));
+
+  JsonOptions unique_keys;
+  unique_keys.add(JsonOptions::UniqueKeys);
+  EXPECT_EQ(JsonError::KeyAlreadyAssigned, decodeError("a2616101616102", unique_keys));
+}
+
+TEST_F(JsonCborTest, TooMuchNesting) {
+  // 200 nested single item arrays.
+  List<char> hex;
+  for (int i = 0; i < 200; ++i) {
+    hex.add('8');
+    hex.add('1');
+  }
+  hex.add('0');
+  hex.add('1');
+  StringSpan nested(hex.data(), hex.size());
+  EXPECT_EQ(JsonError::TooMuchNesting, decodeError(nested));
+
+  JsonOptions options;
+  options.SetDepthLimit(300);
+  JsonValue value;
+  EXPECT_TRUE(decode(nested, value, options));
+}
+
+TEST_F(JsonCborTest, NonFiniteWithoutOption) {
+  MemoryStream stream;
+  stream.openNewBytes();
+  BinaryWriter writer(&stream);
+  JsonCborFormatter formatter(writer);
+  EXPECT_FALSE(formatter.Write(JsonValue(Limits<double>::NaN)));
+  EXPECT_EQ(JsonError::InvalidNumber, formatter.GetError().code);
+  writer.flush();
+  // Written as zero.
+  EXPECT_EQ(3, stream.getLength());
+}
+
+} // namespace stp
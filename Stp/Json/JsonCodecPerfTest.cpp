@@ -0,0 +1,337 @@
+// Copyright 2017 Polonite Authors. All rights reserved.
+// Distributed under MIT license that can be found in the LICENSE file.
+
+#include "Base/Io/BinaryReader.h"
+#include "Base/Io/BinaryWriter.h"
+#include "Base/Io/MemoryStream.h"
+#include "Base/Io/StringWriter.h"
+#include "Base/Test/GTest.h"
+#include "Base/Test/PerfTest.h"
+#include "Base/Text/StringFormatMany.h"
+#include "Base/Time/TimeTicks.h"
+#include "Json/JsonArray.h"
+#include "Json/JsonCbor.h"
+#include "Json/JsonFormatter.h"
+#include "Json/JsonObject.h"
+#include "Json/JsonParser.h"
+
+namespace stp {
+
+static const int RecordCount = 100000;
+static const int TagCount = 8;
+
+static const int DocumentEventCount = 20000;
+static const int DocumentIterationCount = 10;
+
+namespace {
+
+struct Record {
+  int64_t id;
+  double position[3];
+  String name;
+  int32_t tags[TagCount];
+};
+
+class JsonCodecPerfTest : public testing::Test {
+ protected:
+  enum class Method {
+    // JsonValue tree written with JsonFormatter and read with JsonParser.
+    Json,
+    // Field by field with BinaryWriter/BinaryReader, tags as varints.
+    BinaryVarInt,
+    // Same as above, but fixed-width tags written with writeSpan().
+    BinarySpan,
+  };
+
+  static const char* getMethodName(Method method) {
+    switch (method) {
+      case Method::Json: return "json";
+      case Method::BinaryVarInt: return "binary_varint";
+      case Method::BinarySpan: return "binary_span";
+    }
+    return nullptr;
+  }
+
+  void SetUp() override {
+    records_.willGrow(RecordCount);
+    for (int i = 0; i < RecordCount; ++i) {
+      Record record;
+      record.id = static_cast<int64_t>(i) * 7919;
+      for (int j = 0; j < 3; ++j)
+        record.position[j] = i * 0.25 + j;
+      record.name = String(stringFormatMany("record_{}", i));
+      for (int j = 0; j < TagCount; ++j)
+        record.tags[j] = (i + j) % 1000 - 500;
+      records_.add(move(record));
+    }
+  }
+
+  void encodeJson(String& output);
+  void decodeJson(StringSpan input, List<Record>& output);
+  void encodeBinary(Method method, MemoryStream& output);
+  void decodeBinary(Method method, MemoryStream& input, List<Record>& output);
+
+  void run(Method method);
+
+  List<Record> records_;
+};
+
+void JsonCodecPerfTest::encodeJson(String& output) {
+  JsonArray root;
+  root.willGrow(RecordCount);
+  for (const Record& record : records_) {
+    JsonObject object;
+    object.Set("id", record.id);
+    JsonArray position;
+    for (double x : record.position)
+      position.add(x);
+    object.Set("position", move(position));
+    object.Set("name", record.name.toSpan());
+    JsonArray tags;
+    for (int32_t tag : record.tags)
+      tags.add(tag);
+    object.Set("tags", move(tags));
+    root.add(move(object));
+  }
+  StringWriter writer(&output);
+  JsonFormatter(writer).Write(root);
+}
+
+void JsonCodecPerfTest::decodeJson(StringSpan input, List<Record>& output) {
+  JsonValue root;
+  JsonParser parser;
+  ASSERT_TRUE(parser.Parse(input, root));
+  const JsonArray* array = root.TryCastToArray();
+  ASSERT_TRUE(array);
+  output.willGrow(array->size());
+  for (const JsonValue& value : *array) {
+    const JsonObject* object = value.TryCastToObject();
+    Record record;
+    StringSpan name;
+    object->tryGet("id", record.id);
+    const JsonArray* position = object->tryGetArray("position");
+    for (int j = 0; j < 3; ++j)
+      position->tryGet(j, record.position[j]);
+    object->tryGet("name", name);
+    record.name = String(name);
+    const JsonArray* tags = object->tryGetArray("tags");
+    for (int j = 0; j < TagCount; ++j)
+      tags->tryGet(j, record.tags[j]);
+    output.add(move(record));
+  }
+}
+
+void JsonCodecPerfTest::encodeBinary(Method method, MemoryStream& output) {
+  BinaryWriter writer(&output);
+  writer.writeVarUInt32(static_cast<uint32_t>(records_.size()));
+  for (const Record& record : records_) {
+    writer.writeVarInt64(record.id);
+    writer.writeSpan(makeSpan(record.position));
+    writer.writeString(record.name);
+    if (method == Method::BinarySpan) {
+      writer.writeSpan(makeSpan(record.tags));
+    } else {
+      for (int32_t tag : record.tags)
+        writer.writeVarInt32(tag);
+    }
+  }
+  writer.flush();
+}
+
+void JsonCodecPerfTest::decodeBinary(Method method, MemoryStream& input, List<Record>& output) {
+  BinaryReader reader(&input);
+  int count = static_cast<int>(reader.readVarUInt32());
+  output.willGrow(count);
+  for (int i = 0; i < count; ++i) {
+    Record record;
+    record.id = reader.readVarInt64();
+    reader.readSpan(makeSpan(record.position));
+    record.name = reader.readString();
+    if (method == Method::BinarySpan) {
+      reader.readSpan(makeSpan(record.tags));
+    } else {
+      for (int32_t& tag : record.tags)
+        tag = reader.readVarInt32();
+    }
+    output.add(move(record));
+  }
+}
+
+void JsonCodecPerfTest::run(Method method) {
+  String json;
+  MemoryStream stream;
+  stream.openNewBytes();
+  List<Record> decoded;
+
+  TimeTicks encode_start = TimeTicks::Now();
+  if (method == Method::Json)
+    encodeJson(json);
+  else
+    encodeBinary(method, stream);
+  TimeDelta encode_time = TimeTicks::Now() - encode_start;
+
+  int64_t encoded_size;
+  TimeTicks decode_start = TimeTicks::Now();
+  if (method == Method::Json) {
+    encoded_size = json.length();
+    decodeJson(json, decoded);
+  } else {
+    encoded_size = stream.getLength();
+    stream.setPosition(0);
+    decodeBinary(method, stream, decoded);
+  }
+  TimeDelta decode_time = TimeTicks::Now() - decode_start;
+
+  ASSERT_EQ(records_.size(), decoded.size());
+  EXPECT_EQ(records_.last().name, decoded.last().name);
+  EXPECT_EQ(records_.last().tags[TagCount - 1], decoded.last().tags[TagCount - 1]);
+
+  const char* method_name = getMethodName(method);
+  perf_test::PrintResult(
+      "encode", "", method_name,
+      RecordCount / encode_time.InMillisecondsF(), "records/ms", true);
+  perf_test::PrintResult(
+      "decode", "", method_name,
+      RecordCount / decode_time.InMillisecondsF(), "records/ms", true);
+  perf_test::PrintResult(
+      "encoded_size", "", method_name,
+      static_cast<double>(encoded_size) / RecordCount, "bytes/record", true);
+}
+
+class JsonDocumentPerfTest : public testing::Test {
+ protected:
+  enum class Method {
+    Json,
+    Cbor,
+    // Strings reference the input instead of being copied.
+    CborReferenceInput,
+  };
+
+  static const char* getMethodName(Method method) {
+    switch (method) {
+      case Method::Json: return "json";
+      case Method::Cbor: return "cbor";
+      case Method::CborReferenceInput: return "cbor_reference_input";
+    }
+    return nullptr;
+  }
+
+  // Resembles a page of events returned by a web API: nested objects,
+  // short strings, integers, doubles, booleans and nulls.
+  void SetUp() override {
+    JsonArray events;
+    events.willGrow(DocumentEventCount);
+    for (int i = 0; i < DocumentEventCount; ++i) {
+      JsonObject actor;
+      actor.Set("id", 1000000 + i * 37);
+      actor.Set("login", String(stringFormatMany("user{}", i % 1500)).toSpan());
+      actor.Set("url", String(stringFormatMany("https://example.com/users/user{}", i % 1500)).toSpan());
+      actor.Set("site_admin", i % 97 == 0);
+
+      JsonObject payload;
+      payload.Set("size", i % 5);
+      payload.Set("ref", "refs/heads/master");
+      payload.Set("score", i * 0.001 + 0.5);
+      payload.Set("description", i % 3 == 0 ? JsonValue() : JsonValue("Fix formatting of long lines"));
+
+      JsonObject event;
+      event.Set("id", String(stringFormatMany("{}", INT64_C(5000000000) + i)).toSpan());
+      event.Set("type", i % 4 == 0 ? "PushEvent" : "WatchEvent");
+      event.Set("public", true);
+      event.Set("created_at", "2017-05-01T12:34:56Z");
+      event.Set("actor", move(actor));
+      event.Set("payload", move(payload));
+      events.add(move(event));
+    }
+    document_.Set("total_count", DocumentEventCount);
+    document_.Set("events", move(events));
+  }
+
+  void run(Method method);
+
+  JsonObject document_;
+};
+
+void JsonDocumentPerfTest::run(Method method) {
+  List<byte_t> cbor;
+  TimeDelta encode_time;
+  TimeDelta decode_time;
+  int64_t encoded_size = 0;
+
+  for (int iteration = 0; iteration < DocumentIterationCount; ++iteration) {
+    String json;
+    MemoryStream stream;
+    stream.openNewBytes();
+
+    TimeTicks encode_start = TimeTicks::Now();
+    if (method == Method::Json) {
+      StringWriter writer(&json);
+      ASSERT_TRUE(JsonFormatter(writer).Write(document_));
+    } else {
+      BinaryWriter writer(&stream);
+      ASSERT_TRUE(JsonCborFormatter(writer).Write(document_));
+      writer.flush();
+    }
+    encode_time += TimeTicks::Now() - encode_start;
+
+    if (method != Method::Json) {
+      int size = static_cast<int>(stream.getLength());
+      cbor.clear();
+      stream.positionalRead(0, MutableBufferSpan(cbor.appendUninitialized(size), size));
+    }
+
+    JsonValue decoded;
+    TimeTicks decode_start = TimeTicks::Now();
+    if (method == Method::Json) {
+      JsonParser parser;
+      ASSERT_TRUE(parser.Parse(json, decoded));
+      encoded_size = json.length();
+    } else {
+      JsonCborParser parser;
+      if (method == Method::CborReferenceInput) {
+        JsonOptions options;
+        options.add(JsonOptions::ReferenceInput);
+        parser.SetOptions(options);
+      }
+      ASSERT_TRUE(parser.Parse(BufferSpan(cbor.data(), cbor.size()), decoded));
+      encoded_size = cbor.size();
+    }
+    decode_time += TimeTicks::Now() - decode_start;
+
+    ASSERT_TRUE(decoded.IsObject());
+  }
+
+  const char* method_name = getMethodName(method);
+  double total_megabytes = static_cast<double>(encoded_size) * DocumentIterationCount / (1 << 20);
+  perf_test::PrintResult(
+      "document_encode", "", method_name,
+      total_megabytes / encode_time.InSecondsF(), "MiB/s", true);
+  perf_test::PrintResult(
+      "document_decode", "", method_name,
+      total_megabytes / decode_time.InSecondsF(), "MiB/s", true);
+  perf_test::PrintResult(
+      "document_encode", "_time", method_name,
+      encode_time.InMillisecondsF() / DocumentIterationCount, "ms", true);
+  perf_test::PrintResult(
+      "document_decode", "_time", method_name,
+      decode_time.InMillisecondsF() / DocumentIterationCount, "ms", true);
+  perf_test::PrintResult(
+      "document_size", "", method_name,
+      static_cast<size_t>(encoded_size), "bytes", true);
+}
+
+} // namespace
+
+TEST_F(JsonCodecPerfTest, Records) {
+  run(Method::Json);
+  run(Method::BinaryVarInt);
+  run(Method::BinarySpan);
+}
+
+TEST_F(JsonDocumentPerfTest, Document) {
+  run(Method::Json);
+  run(Method::Cbor);
+  run(Method::CborReferenceInput);
+}
+
+} // namespace stp
@@ -33,6 +33,8 @@ static constexpr StringSpan Messages[] = {
   "loss of precision",
   "invalid number",
   "key already assigned",
+  "unexpected end of input",
+  "data item has no JSON equivalent",
 };
 static_assert(isizeofArray(Messages) == JsonError::CodeCount, "!");
 
@@ -22,8 +22,10 @@ struct BASE_EXPORT JsonError {
     LossOfPrecision,
     InvalidNumber,
     KeyAlreadyAssigned,
+    UnexpectedEndOfInput,
+    UnsupportedDataItem,
   };
-  static constexpr int CodeCount = KeyAlreadyAssigned + 1;
+  static constexpr int CodeCount = UnsupportedDataItem + 1;
 
   JsonError() : code(Ok) {}
   explicit JsonError(Code code) : code(code) {}